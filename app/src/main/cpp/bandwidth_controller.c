@@ -0,0 +1,168 @@
+/**
+ * bandwidth_controller.c - Adaptive choice between a source's full and proxy streams
+ *
+ * Streaks are kept as the time of their first sample (-1 when not running); a sample that is
+ * neither degraded nor healthy ends both.
+ */
+
+#include "bandwidth_controller.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct BandwidthController {
+    pthread_mutex_t lock;
+    BandwidthControllerStats stats;
+    int64_t degraded_since_ns;
+    int64_t healthy_since_ns;
+    int64_t last_upgrade_ns;   /* -1 until the first upgrade. */
+};
+
+static const char* const kReasonNames[BANDWIDTH_REASON_COUNT] = {
+    "none", "drops", "queue", "backlog", "recovered"
+};
+
+/* Returns the reason the sample is degraded, or BANDWIDTH_REASON_NONE. */
+static BandwidthReason degraded_reason(const BandwidthSample* s, double drop_ratio, bool ratio_valid) {
+    if (ratio_valid && drop_ratio >= BANDWIDTH_DEGRADED_DROP_RATIO) {
+        return BANDWIDTH_REASON_DROPS;
+    }
+    if (s->queue_max >= BANDWIDTH_DEGRADED_QUEUE) {
+        return BANDWIDTH_REASON_QUEUE;
+    }
+    if (s->backlog >= BANDWIDTH_DEGRADED_BACKLOG) {
+        return BANDWIDTH_REASON_BACKLOG;
+    }
+    return BANDWIDTH_REASON_NONE;
+}
+
+/* Healthy needs frames flowing: a stalled source says nothing about the link. */
+static bool is_healthy(const BandwidthSample* s, double drop_ratio, bool ratio_valid) {
+    return ratio_valid &&
+           drop_ratio <= BANDWIDTH_HEALTHY_DROP_RATIO &&
+           s->queue_max <= BANDWIDTH_HEALTHY_QUEUE &&
+           s->backlog <= BANDWIDTH_HEALTHY_BACKLOG;
+}
+
+BandwidthController* bandwidth_controller_create(void) {
+    BandwidthController* bc = (BandwidthController*)calloc(1, sizeof(BandwidthController));
+    if (bc == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&bc->lock, NULL) != 0) {
+        free(bc);
+        return NULL;
+    }
+    bc->stats.level = BANDWIDTH_LEVEL_HIGHEST;
+    bc->stats.pending_level = BANDWIDTH_LEVEL_HIGHEST;
+    bc->stats.recover_hold_ns = BANDWIDTH_RECOVER_HOLD_NS;
+    bc->degraded_since_ns = -1;
+    bc->healthy_since_ns = -1;
+    bc->last_upgrade_ns = -1;
+    return bc;
+}
+
+void bandwidth_controller_destroy(BandwidthController* bc) {
+    if (bc == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&bc->lock);
+    free(bc);
+}
+
+int bandwidth_controller_update(BandwidthController* bc, const BandwidthSample* sample, int64_t now_ns) {
+    const uint64_t offered = sample->frames + sample->dropped;
+    const bool ratio_valid = offered >= BANDWIDTH_MIN_SAMPLE_FRAMES;
+    const double drop_ratio = (offered > 0) ? (double)sample->dropped / (double)offered : 0.0;
+    const BandwidthReason reason = degraded_reason(sample, drop_ratio, ratio_valid);
+    int target = -1;
+
+    pthread_mutex_lock(&bc->lock);
+    BandwidthControllerStats* st = &bc->stats;
+    st->samples++;
+    st->last_drop_ratio = drop_ratio;
+    if (reason != BANDWIDTH_REASON_NONE) {
+        st->degraded_samples++;
+    }
+
+    if (!st->pending) {
+        if (reason != BANDWIDTH_REASON_NONE) {
+            bc->healthy_since_ns = -1;
+            if (bc->degraded_since_ns < 0) {
+                bc->degraded_since_ns = now_ns;
+            }
+            if (st->level == BANDWIDTH_LEVEL_HIGHEST &&
+                now_ns - bc->degraded_since_ns >= BANDWIDTH_DEGRADE_HOLD_NS) {
+                target = BANDWIDTH_LEVEL_LOWEST;
+                st->last_reason = reason;
+            }
+        } else if (is_healthy(sample, drop_ratio, ratio_valid)) {
+            bc->degraded_since_ns = -1;
+            if (bc->healthy_since_ns < 0) {
+                bc->healthy_since_ns = now_ns;
+            }
+            if (st->level == BANDWIDTH_LEVEL_LOWEST &&
+                now_ns - bc->healthy_since_ns >= st->recover_hold_ns) {
+                target = BANDWIDTH_LEVEL_HIGHEST;
+                st->last_reason = BANDWIDTH_REASON_RECOVERED;
+            }
+        } else {
+            bc->degraded_since_ns = -1;
+            bc->healthy_since_ns = -1;
+        }
+
+        if (target >= 0) {
+            st->pending = true;
+            st->pending_level = (BandwidthLevel)target;
+        }
+    }
+    pthread_mutex_unlock(&bc->lock);
+    return target;
+}
+
+void bandwidth_controller_switched(BandwidthController* bc, bool ok, int64_t now_ns) {
+    pthread_mutex_lock(&bc->lock);
+    BandwidthControllerStats* st = &bc->stats;
+    if (st->pending) {
+        st->pending = false;
+        if (!ok) {
+            st->failed_switches++;
+        } else if (st->pending_level == BANDWIDTH_LEVEL_LOWEST) {
+            /* Falling back soon after an upgrade: the full stream needs a longer proof next time. */
+            if (bc->last_upgrade_ns >= 0 && now_ns - bc->last_upgrade_ns < 2 * st->recover_hold_ns) {
+                st->recover_hold_ns *= 2;
+                if (st->recover_hold_ns > BANDWIDTH_RECOVER_HOLD_MAX_NS) {
+                    st->recover_hold_ns = BANDWIDTH_RECOVER_HOLD_MAX_NS;
+                }
+            } else {
+                st->recover_hold_ns = BANDWIDTH_RECOVER_HOLD_NS;
+            }
+            st->level = BANDWIDTH_LEVEL_LOWEST;
+            st->downgrades++;
+            st->last_switch_ns = now_ns;
+        } else {
+            st->level = BANDWIDTH_LEVEL_HIGHEST;
+            st->upgrades++;
+            st->last_switch_ns = now_ns;
+            bc->last_upgrade_ns = now_ns;
+        }
+        /* Samples of the old stream do not count towards the next decision. */
+        bc->degraded_since_ns = -1;
+        bc->healthy_since_ns = -1;
+    }
+    pthread_mutex_unlock(&bc->lock);
+}
+
+void bandwidth_controller_get_stats(BandwidthController* bc, BandwidthControllerStats* stats) {
+    pthread_mutex_lock(&bc->lock);
+    memcpy(stats, &bc->stats, sizeof(*stats));
+    pthread_mutex_unlock(&bc->lock);
+}
+
+const char* bandwidth_reason_name(BandwidthReason reason) {
+    if ((int)reason < 0 || reason >= BANDWIDTH_REASON_COUNT) {
+        return "unknown";
+    }
+    return kReasonNames[reason];
+}
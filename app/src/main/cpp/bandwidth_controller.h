@@ -0,0 +1,95 @@
+/**
+ * bandwidth_controller.h - Adaptive choice between a source's full and proxy streams
+ *
+ * The controller never reads a clock: sample times are passed in.
+ *
+ * The caller feeds one sample about once a second: video frames received and dropped by the
+ * SDK since the previous sample, the deepest SDK video queue seen, and the frames waiting in the
+ * decoder or renderer. A sample is degraded when any of them crosses its DEGRADED threshold and
+ * healthy when all are at or below their (lower) HEALTHY thresholds; anything in between keeps
+ * neither streak going. The controller asks for the lowest stream after BANDWIDTH_DEGRADE_HOLD_NS
+ * of degraded samples, and for the highest again after a healthy streak of recover_hold_ns. That
+ * hold starts at BANDWIDTH_RECOVER_HOLD_NS and doubles (up to BANDWIDTH_RECOVER_HOLD_MAX_NS)
+ * whenever the stream has to fall back soon after an upgrade, so a link that only just fails at
+ * full bandwidth does not flap.
+ *
+ * A requested switch stays pending, and further samples are ignored, until the caller reports
+ * whether it completed (bandwidth_controller_switched).
+ */
+
+#ifndef NDI_BANDWIDTH_CONTROLLER_H
+#define NDI_BANDWIDTH_CONTROLLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BANDWIDTH_DEGRADED_DROP_RATIO 0.05     /* Dropped / (received + dropped). */
+#define BANDWIDTH_HEALTHY_DROP_RATIO 0.01
+#define BANDWIDTH_DEGRADED_QUEUE 3             /* SDK video queue depth. */
+#define BANDWIDTH_HEALTHY_QUEUE 1
+#define BANDWIDTH_DEGRADED_BACKLOG 4           /* Frames waiting to be decoded or drawn. */
+#define BANDWIDTH_HEALTHY_BACKLOG 1
+#define BANDWIDTH_MIN_SAMPLE_FRAMES 5          /* Fewer frames say nothing about the drop ratio. */
+
+#define BANDWIDTH_DEGRADE_HOLD_NS 3000000000LL        /* 3 s */
+#define BANDWIDTH_RECOVER_HOLD_NS 10000000000LL       /* 10 s */
+#define BANDWIDTH_RECOVER_HOLD_MAX_NS 160000000000LL  /* 160 s */
+
+typedef enum BandwidthLevel {
+    BANDWIDTH_LEVEL_HIGHEST = 0,
+    BANDWIDTH_LEVEL_LOWEST = 1
+} BandwidthLevel;
+
+/* Why the last switch was requested. */
+typedef enum BandwidthReason {
+    BANDWIDTH_REASON_NONE = 0,
+    BANDWIDTH_REASON_DROPS,
+    BANDWIDTH_REASON_QUEUE,
+    BANDWIDTH_REASON_BACKLOG,
+    BANDWIDTH_REASON_RECOVERED,
+    BANDWIDTH_REASON_COUNT
+} BandwidthReason;
+
+typedef struct BandwidthSample {
+    uint64_t frames;    /* Video frames received since the previous sample. */
+    uint64_t dropped;   /* Video frames dropped since the previous sample. */
+    int queue_max;      /* Deepest SDK video queue since the previous sample. */
+    int backlog;        /* Frames waiting in the decoder or renderer now. */
+} BandwidthSample;
+
+typedef struct BandwidthControllerStats {
+    BandwidthLevel level;
+    bool pending;                 /* A switch to pending_level was requested and not yet reported. */
+    BandwidthLevel pending_level;
+    BandwidthReason last_reason;
+    uint64_t samples;
+    uint64_t degraded_samples;
+    uint64_t downgrades;          /* Completed switches to the lowest stream. */
+    uint64_t upgrades;            /* Completed switches back to the highest stream. */
+    uint64_t failed_switches;
+    int64_t recover_hold_ns;      /* Healthy time the next upgrade needs. */
+    int64_t last_switch_ns;       /* Time of the last completed switch, or 0. */
+    double last_drop_ratio;
+} BandwidthControllerStats;
+
+typedef struct BandwidthController BandwidthController;
+
+/* Starts at the highest stream. */
+BandwidthController* bandwidth_controller_create(void);
+void bandwidth_controller_destroy(BandwidthController* bc);
+
+/*
+ * Feed the sample taken at now_ns. Returns the level to switch to (the switch is then pending),
+ * or -1 to stay.
+ */
+int bandwidth_controller_update(BandwidthController* bc, const BandwidthSample* sample, int64_t now_ns);
+
+/* The pending switch completed (ok) or was abandoned at now_ns. */
+void bandwidth_controller_switched(BandwidthController* bc, bool ok, int64_t now_ns);
+
+void bandwidth_controller_get_stats(BandwidthController* bc, BandwidthControllerStats* stats);
+
+/* Short name of reason for logs, e.g. "drops". */
+const char* bandwidth_reason_name(BandwidthReason reason);
+
+#endif /* NDI_BANDWIDTH_CONTROLLER_H */
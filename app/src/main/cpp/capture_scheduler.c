@@ -0,0 +1,352 @@
+/**
+ * capture_scheduler.c - Shared worker pool servicing many receivers
+ *
+ * One lock guards the source table. Workers drop it while a service runs; the slot is marked
+ * busy meanwhile, which keeps other workers off it and makes remove wait.
+ */
+
+#include "capture_scheduler.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct SchedSource {
+    void* context;              /* NULL for a free slot. */
+    CaptureServiceFn service;
+    CaptureDueFn due;
+    bool busy;                  /* A worker is servicing it. */
+    bool removing;              /* Not serviced again; remove is waiting for the worker. */
+    int64_t next_ns;            /* Due for service at this time. */
+    int64_t idle_ns;            /* Current backoff; 0 after a service that captured frames. */
+    uint64_t services;
+    uint64_t idle_services;
+    uint64_t frames;
+    int64_t lag_total_ns;
+    int64_t lag_max_ns;
+} SchedSource;
+
+typedef struct WorkerArg {
+    CaptureScheduler* cs;
+    int index;
+} WorkerArg;
+
+struct CaptureScheduler {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;    /* Workers: a source may be due earlier, or stop. */
+    pthread_cond_t ready_cond;   /* Consumers: frames were captured, or stop. */
+    pthread_cond_t idle_cond;    /* remove: a service returned. */
+    SchedSource sources[CAPTURE_SCHEDULER_MAX_SOURCES];
+    void* focus;
+    int focus_streak;            /* Services of the focused source in a row while others were due. */
+    bool stopping;
+    CaptureWorkerStartFn on_start;
+    void* start_context;
+    int worker_count;
+    pthread_t workers[CAPTURE_SCHEDULER_MAX_WORKERS];
+    WorkerArg worker_args[CAPTURE_SCHEDULER_MAX_WORKERS];
+};
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+
+/* Caller holds cs->lock. INT64_MAX waits until signalled. */
+static void wait_until(CaptureScheduler* cs, pthread_cond_t* cond, int64_t wake_ns) {
+    if (wake_ns == INT64_MAX) {
+        pthread_cond_wait(cond, &cs->lock);
+        return;
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)(wake_ns / 1000000000LL);
+    ts.tv_nsec = (long)(wake_ns % 1000000000LL);
+    pthread_cond_timedwait(cond, &cs->lock, &ts);
+}
+
+static SchedSource* find_source(CaptureScheduler* cs, void* context) {
+    for (int i = 0; i < CAPTURE_SCHEDULER_MAX_SOURCES; i++) {
+        if (cs->sources[i].context == context) {
+            return &cs->sources[i];
+        }
+    }
+    return NULL;
+}
+
+static int64_t idle_cap_ns(const CaptureScheduler* cs, const SchedSource* s) {
+    return (s->context == cs->focus) ? CAPTURE_SCHEDULER_FOCUS_IDLE_MAX_NS : CAPTURE_SCHEDULER_IDLE_MAX_NS;
+}
+
+/*
+ * Caller holds cs->lock. Returns the source to service now, or NULL with *wake lowered to the
+ * time the next idle source comes due.
+ */
+static SchedSource* pick_source(CaptureScheduler* cs, int64_t now_ns, int64_t* wake) {
+    SchedSource* focused = NULL;
+    SchedSource* oldest = NULL;
+    for (int i = 0; i < CAPTURE_SCHEDULER_MAX_SOURCES; i++) {
+        SchedSource* s = &cs->sources[i];
+        if (s->context == NULL || s->busy || s->removing) {
+            continue;
+        }
+        if (s->next_ns > now_ns) {
+            if (s->next_ns < *wake) {
+                *wake = s->next_ns;
+            }
+            continue;
+        }
+        if (s->context == cs->focus) {
+            focused = s;
+        } else if (oldest == NULL || s->next_ns < oldest->next_ns) {
+            oldest = s;
+        }
+    }
+
+    if (focused != NULL && (oldest == NULL || cs->focus_streak < CAPTURE_SCHEDULER_FOCUS_BURST)) {
+        cs->focus_streak = (oldest != NULL) ? cs->focus_streak + 1 : 0;
+        return focused;
+    }
+    cs->focus_streak = 0;
+    return oldest;
+}
+
+static void* worker_main(void* arg) {
+    const WorkerArg* wa = (const WorkerArg*)arg;
+    CaptureScheduler* cs = wa->cs;
+    if (cs->on_start != NULL) {
+        cs->on_start(wa->index, cs->start_context);
+    }
+
+    pthread_mutex_lock(&cs->lock);
+    while (!cs->stopping) {
+        const int64_t now = monotonic_ns();
+        int64_t wake = INT64_MAX;
+        SchedSource* s = pick_source(cs, now, &wake);
+        if (s == NULL) {
+            wait_until(cs, &cs->work_cond, wake);
+            continue;
+        }
+
+        const int64_t lag = now - s->next_ns;
+        s->busy = true;
+        pthread_mutex_unlock(&cs->lock);
+        const int frames = s->service(s->context);
+        pthread_mutex_lock(&cs->lock);
+        s->busy = false;
+
+        s->services++;
+        s->lag_total_ns += lag;
+        if (lag > s->lag_max_ns) {
+            s->lag_max_ns = lag;
+        }
+        if (frames > 0) {
+            s->frames += (uint64_t)frames;
+            s->idle_ns = 0;
+            s->next_ns = monotonic_ns();
+            pthread_cond_broadcast(&cs->ready_cond);
+        } else {
+            s->idle_services++;
+            s->idle_ns = (s->idle_ns == 0) ? CAPTURE_SCHEDULER_IDLE_MIN_NS : s->idle_ns * 2;
+            const int64_t cap = idle_cap_ns(cs, s);
+            if (s->idle_ns > cap) {
+                s->idle_ns = cap;
+            }
+            s->next_ns = monotonic_ns() + s->idle_ns;
+        }
+        if (s->removing) {
+            pthread_cond_broadcast(&cs->idle_cond);
+        }
+    }
+    pthread_mutex_unlock(&cs->lock);
+    return NULL;
+}
+
+int capture_scheduler_default_workers(int cpu_count) {
+    int workers = cpu_count / 4;
+    if (workers < 1) {
+        workers = 1;
+    }
+    if (workers > CAPTURE_SCHEDULER_MAX_WORKERS) {
+        workers = CAPTURE_SCHEDULER_MAX_WORKERS;
+    }
+    return workers;
+}
+
+CaptureScheduler* capture_scheduler_create(int workers, CaptureWorkerStartFn on_start, void* start_context) {
+    if (workers < 1) {
+        workers = 1;
+    }
+    if (workers > CAPTURE_SCHEDULER_MAX_WORKERS) {
+        workers = CAPTURE_SCHEDULER_MAX_WORKERS;
+    }
+
+    CaptureScheduler* cs = (CaptureScheduler*)calloc(1, sizeof(CaptureScheduler));
+    if (cs == NULL) {
+        return NULL;
+    }
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    const bool ok = pthread_mutex_init(&cs->lock, NULL) == 0 &&
+                    pthread_cond_init(&cs->work_cond, &attr) == 0 &&
+                    pthread_cond_init(&cs->ready_cond, &attr) == 0 &&
+                    pthread_cond_init(&cs->idle_cond, &attr) == 0;
+    pthread_condattr_destroy(&attr);
+    if (!ok) {
+        free(cs);
+        return NULL;
+    }
+    cs->on_start = on_start;
+    cs->start_context = start_context;
+
+    for (int i = 0; i < workers; i++) {
+        cs->worker_args[i].cs = cs;
+        cs->worker_args[i].index = i;
+        if (pthread_create(&cs->workers[i], NULL, worker_main, &cs->worker_args[i]) != 0) {
+            break;
+        }
+        cs->worker_count++;
+    }
+    if (cs->worker_count == 0) {
+        capture_scheduler_destroy(cs);
+        return NULL;
+    }
+    return cs;
+}
+
+void capture_scheduler_destroy(CaptureScheduler* cs) {
+    if (cs == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&cs->lock);
+    cs->stopping = true;
+    pthread_cond_broadcast(&cs->work_cond);
+    pthread_cond_broadcast(&cs->ready_cond);
+    pthread_mutex_unlock(&cs->lock);
+    for (int i = 0; i < cs->worker_count; i++) {
+        pthread_join(cs->workers[i], NULL);
+    }
+    pthread_cond_destroy(&cs->idle_cond);
+    pthread_cond_destroy(&cs->ready_cond);
+    pthread_cond_destroy(&cs->work_cond);
+    pthread_mutex_destroy(&cs->lock);
+    free(cs);
+}
+
+int capture_scheduler_worker_count(CaptureScheduler* cs) {
+    return cs->worker_count;
+}
+
+bool capture_scheduler_add(CaptureScheduler* cs, void* context, CaptureServiceFn service, CaptureDueFn due) {
+    if (context == NULL || service == NULL || due == NULL) {
+        return false;
+    }
+    pthread_mutex_lock(&cs->lock);
+    SchedSource* s = (find_source(cs, context) == NULL) ? find_source(cs, NULL) : NULL;
+    if (s != NULL) {
+        memset(s, 0, sizeof(*s));
+        s->context = context;
+        s->service = service;
+        s->due = due;
+        s->next_ns = monotonic_ns();
+        pthread_cond_broadcast(&cs->work_cond);
+    }
+    pthread_mutex_unlock(&cs->lock);
+    return s != NULL;
+}
+
+bool capture_scheduler_remove(CaptureScheduler* cs, void* context) {
+    if (context == NULL) {
+        return false;
+    }
+    pthread_mutex_lock(&cs->lock);
+    SchedSource* s = find_source(cs, context);
+    if (s != NULL) {
+        s->removing = true;
+        while (s->busy) {
+            pthread_cond_wait(&cs->idle_cond, &cs->lock);
+        }
+        if (cs->focus == context) {
+            cs->focus = NULL;
+        }
+        memset(s, 0, sizeof(*s));
+    }
+    pthread_mutex_unlock(&cs->lock);
+    return s != NULL;
+}
+
+void capture_scheduler_set_focus(CaptureScheduler* cs, void* context) {
+    pthread_mutex_lock(&cs->lock);
+    SchedSource* s = (context != NULL) ? find_source(cs, context) : NULL;
+    cs->focus = (s != NULL && !s->removing) ? context : NULL;
+    cs->focus_streak = 0;
+    if (cs->focus != NULL) {
+        /* Serviced now, at the focused source's backoff from here on. */
+        const int64_t now = monotonic_ns();
+        if (s->idle_ns > CAPTURE_SCHEDULER_FOCUS_IDLE_MAX_NS) {
+            s->idle_ns = CAPTURE_SCHEDULER_FOCUS_IDLE_MAX_NS;
+        }
+        if (s->next_ns > now) {
+            s->next_ns = now;
+        }
+        pthread_cond_broadcast(&cs->work_cond);
+    }
+    pthread_mutex_unlock(&cs->lock);
+}
+
+void* capture_scheduler_wait_ready(CaptureScheduler* cs, int64_t timeout_ns) {
+    const int64_t deadline = monotonic_ns() + ((timeout_ns > 0) ? timeout_ns : 0);
+    void* ready = NULL;
+
+    pthread_mutex_lock(&cs->lock);
+    for (;;) {
+        const int64_t now = monotonic_ns();
+        int64_t ready_due = INT64_MAX;
+        int64_t next_due = INT64_MAX;
+        for (int i = 0; i < CAPTURE_SCHEDULER_MAX_SOURCES; i++) {
+            const SchedSource* s = &cs->sources[i];
+            if (s->context == NULL || s->removing) {
+                continue;
+            }
+            const int64_t due = s->due(s->context);
+            if (due > now) {
+                if (due < next_due) {
+                    next_due = due;
+                }
+            } else if (s->context == cs->focus) {
+                ready = s->context;
+                break;
+            } else if (due < ready_due) {
+                ready = s->context;
+                ready_due = due;
+            }
+        }
+        if (ready != NULL || cs->stopping || now >= deadline) {
+            break;
+        }
+        wait_until(cs, &cs->ready_cond, (next_due < deadline) ? next_due : deadline);
+    }
+    pthread_mutex_unlock(&cs->lock);
+    return ready;
+}
+
+bool capture_scheduler_get_stats(CaptureScheduler* cs, void* context, CaptureSourceStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (context == NULL) {
+        return false;
+    }
+    pthread_mutex_lock(&cs->lock);
+    const SchedSource* s = find_source(cs, context);
+    if (s != NULL) {
+        stats->focused = (cs->focus == context);
+        stats->services = s->services;
+        stats->idle_services = s->idle_services;
+        stats->frames = s->frames;
+        stats->lag_avg_ns = (s->services > 0) ? s->lag_total_ns / (int64_t)s->services : 0;
+        stats->lag_max_ns = s->lag_max_ns;
+    }
+    pthread_mutex_unlock(&cs->lock);
+    return s != NULL;
+}
@@ -0,0 +1,91 @@
+/**
+ * capture_scheduler.h - Shared worker pool servicing many receivers
+ *
+ * Sources are opaque contexts with two callbacks: service captures whatever the source has
+ * queued without blocking and returns the frames it captured, and due reports when the
+ * source's output next has a frame ready for the consumer.
+ *
+ * A fixed pool of workers services every source, so adding sources adds no threads. A source is
+ * serviced by one worker at a time. One that had nothing waits before its next service, doubling
+ * from CAPTURE_SCHEDULER_IDLE_MIN_NS up to its cap, and one that captured frames is due again at
+ * once; this bounds the polling cost of idle sources without delaying busy ones. Among due
+ * sources the one waiting longest goes first, except that the focused source goes ahead of the
+ * others (up to CAPTURE_SCHEDULER_FOCUS_BURST times in a row while others wait) and backs off to
+ * a lower cap.
+ *
+ * Unlike the pacer this reads CLOCK_MONOTONIC itself, since its workers sleep on it.
+ */
+
+#ifndef NDI_CAPTURE_SCHEDULER_H
+#define NDI_CAPTURE_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CAPTURE_SCHEDULER_MAX_SOURCES 8
+#define CAPTURE_SCHEDULER_MAX_WORKERS 4
+#define CAPTURE_SCHEDULER_IDLE_MIN_NS 1000000LL        /* 1 ms */
+#define CAPTURE_SCHEDULER_IDLE_MAX_NS 8000000LL        /* 8 ms */
+#define CAPTURE_SCHEDULER_FOCUS_IDLE_MAX_NS 2000000LL  /* 2 ms */
+#define CAPTURE_SCHEDULER_FOCUS_BURST 4
+
+/* Capture without blocking. Returns the frames captured (0 when the source had nothing). */
+typedef int (*CaptureServiceFn)(void* context);
+
+/*
+ * CLOCK_MONOTONIC time the source's next frame is ready for the consumer, or INT64_MAX. Called
+ * with the scheduler's lock held, so it must not call into the scheduler.
+ */
+typedef int64_t (*CaptureDueFn)(void* context);
+
+/* Called on each worker thread before it services anything (e.g. to place the thread). */
+typedef void (*CaptureWorkerStartFn)(int worker, void* context);
+
+typedef struct CaptureSourceStats {
+    bool focused;
+    uint64_t services;
+    uint64_t idle_services;   /* Services that captured nothing. */
+    uint64_t frames;
+    int64_t lag_avg_ns;       /* Time a due source waited for a worker. */
+    int64_t lag_max_ns;
+} CaptureSourceStats;
+
+typedef struct CaptureScheduler CaptureScheduler;
+
+/* Default pool size for cpu_count cores: a quarter of them, 1..CAPTURE_SCHEDULER_MAX_WORKERS. */
+int capture_scheduler_default_workers(int cpu_count);
+
+/*
+ * Start workers (clamped to 1..CAPTURE_SCHEDULER_MAX_WORKERS) threads. on_start may be NULL.
+ * Returns NULL if no worker could be started.
+ */
+CaptureScheduler* capture_scheduler_create(int workers, CaptureWorkerStartFn on_start, void* start_context);
+
+/* Stops and joins the workers. Sources still added are dropped without a last service. */
+void capture_scheduler_destroy(CaptureScheduler* cs);
+
+int capture_scheduler_worker_count(CaptureScheduler* cs);
+
+/* Add a source, due for service at once. Returns false if it is already added or the table is full. */
+bool capture_scheduler_add(CaptureScheduler* cs, void* context, CaptureServiceFn service, CaptureDueFn due);
+
+/*
+ * Remove a source, waiting for a service in progress to return, so the context may be freed
+ * afterwards. Returns false if it was not added.
+ */
+bool capture_scheduler_remove(CaptureScheduler* cs, void* context);
+
+/* Give context priority (NULL for none). A context that is not added clears the focus. */
+void capture_scheduler_set_focus(CaptureScheduler* cs, void* context);
+
+/*
+ * Wait up to timeout_ns for a source whose output has a frame due, and return its context
+ * (the focused one first, then the earliest due), or NULL. The frame stays in the source's
+ * output until the consumer takes it.
+ */
+void* capture_scheduler_wait_ready(CaptureScheduler* cs, int64_t timeout_ns);
+
+/* Returns false if context is not added. */
+bool capture_scheduler_get_stats(CaptureScheduler* cs, void* context, CaptureSourceStats* stats);
+
+#endif /* NDI_CAPTURE_SCHEDULER_H */
@@ -0,0 +1,455 @@
+/**
+ * deinterlace.c - Deinterlacer for field-based NDI video
+ *
+ * See deinterlace.h.
+ */
+
+#include "deinterlace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DEINTERLACE_HAVE_NEON 1
+#else
+#define DEINTERLACE_HAVE_NEON 0
+#endif
+
+#define DI_FOURCC(a, b, c, d) \
+    ((uint32_t)(uint8_t)(a) | ((uint32_t)(uint8_t)(b) << 8) | ((uint32_t)(uint8_t)(c) << 16) | ((uint32_t)(uint8_t)(d) << 24))
+
+#define DI_MAX_PLANES 3
+
+/* Interleaved frames keep field 1: it is the later of the two in time. */
+#define DI_INTERLEAVED_KEEP_PARITY 1
+
+typedef struct DiPlane {
+    size_t offset;
+    int stride;
+    int row_bytes;
+    int rows;
+} DiPlane;
+
+typedef struct DiLayout {
+    int count;
+    DiPlane planes[DI_MAX_PLANES];
+    size_t size;
+} DiLayout;
+
+struct Deinterlacer {
+    volatile int mode;
+    volatile int mode_applied;
+    volatile uint8_t threshold;
+
+    /* Format the buffers below were sized for. */
+    uint32_t fourcc;
+    int width;
+    int frame_height;
+    int stride;
+    DiLayout layout;
+
+    uint8_t* out[2];
+    int next_out;
+
+    uint8_t* history;     /* Previous interleaved input (motion-adaptive only). */
+    bool history_valid;
+
+    uint8_t* assembly;    /* Full-height frame rebuilt from single fields. */
+    int fields_seen;      /* Bit per field parity written into assembly. */
+
+    volatile uint64_t frames;
+    volatile uint64_t last_ns;
+    volatile uint64_t total_ns;
+};
+
+/* ============================================================================
+ * Layout
+ * ========================================================================== */
+
+static bool layout_for(uint32_t fourcc, int width, int height, int stride, DiLayout* layout) {
+    memset(layout, 0, sizeof(*layout));
+    if (width <= 0 || height <= 0 || stride <= 0) {
+        return false;
+    }
+
+    const size_t luma_size = (size_t)stride * (size_t)height;
+    const int chroma_rows = (height + 1) / 2;
+
+    if (fourcc == DI_FOURCC('U', 'Y', 'V', 'Y') || fourcc == DI_FOURCC('U', 'Y', 'V', 'A')) {
+        if (stride < width * 2) {
+            return false;
+        }
+        layout->planes[0] = (DiPlane){ 0, stride, width * 2, height };
+        layout->count = 1;
+        layout->size = luma_size;
+        if (fourcc == DI_FOURCC('U', 'Y', 'V', 'A')) {
+            /* Alpha plane of width bytes per line follows the packed plane. */
+            layout->planes[1] = (DiPlane){ luma_size, width, width, height };
+            layout->count = 2;
+            layout->size += (size_t)width * (size_t)height;
+        }
+        return true;
+    }
+
+    if (fourcc == DI_FOURCC('B', 'G', 'R', 'A') || fourcc == DI_FOURCC('B', 'G', 'R', 'X') ||
+        fourcc == DI_FOURCC('R', 'G', 'B', 'A') || fourcc == DI_FOURCC('R', 'G', 'B', 'X')) {
+        if (stride < width * 4) {
+            return false;
+        }
+        layout->planes[0] = (DiPlane){ 0, stride, width * 4, height };
+        layout->count = 1;
+        layout->size = luma_size;
+        return true;
+    }
+
+    if (fourcc == DI_FOURCC('N', 'V', '1', '2')) {
+        const int uv_bytes = ((width + 1) / 2) * 2;
+        if (stride < uv_bytes) {
+            return false;
+        }
+        layout->planes[0] = (DiPlane){ 0, stride, width, height };
+        layout->planes[1] = (DiPlane){ luma_size, stride, uv_bytes, chroma_rows };
+        layout->count = 2;
+        layout->size = luma_size + ((size_t)stride * (size_t)chroma_rows);
+        return true;
+    }
+
+    if (fourcc == DI_FOURCC('I', '4', '2', '0') || fourcc == DI_FOURCC('Y', 'V', '1', '2')) {
+        const int chroma_stride = stride / 2;
+        const int chroma_bytes = (width + 1) / 2;
+        if (stride < width || chroma_stride < chroma_bytes) {
+            return false;
+        }
+        const size_t chroma_size = (size_t)chroma_stride * (size_t)chroma_rows;
+        layout->planes[0] = (DiPlane){ 0, stride, width, height };
+        layout->planes[1] = (DiPlane){ luma_size, chroma_stride, chroma_bytes, chroma_rows };
+        layout->planes[2] = (DiPlane){ luma_size + chroma_size, chroma_stride, chroma_bytes, chroma_rows };
+        layout->count = 3;
+        layout->size = luma_size + (chroma_size * 2);
+        return true;
+    }
+
+    return false;
+}
+
+bool deinterlace_supports_fourcc(uint32_t fourcc) {
+    DiLayout layout;
+    return layout_for(fourcc, 2, 2, 8, &layout);
+}
+
+/* ============================================================================
+ * Row Kernels
+ * ========================================================================== */
+
+static void row_bob(const uint8_t* above, const uint8_t* below, uint8_t* dst, int count) {
+    int x = 0;
+#if DEINTERLACE_HAVE_NEON
+    for (; x + 16 <= count; x += 16) {
+        vst1q_u8(dst + x, vrhaddq_u8(vld1q_u8(above + x), vld1q_u8(below + x)));
+    }
+#endif
+    for (; x < count; x++) {
+        dst[x] = (uint8_t)(((unsigned)above[x] + (unsigned)below[x] + 1u) >> 1);
+    }
+}
+
+static inline uint8_t abs_diff_u8(uint8_t a, uint8_t b) {
+    return (uint8_t)((a > b) ? (a - b) : (b - a));
+}
+
+/*
+ * Motion is the largest change since the previous input among the two kept-field neighbours and
+ * the woven sample itself. Static samples keep the woven value (full vertical resolution);
+ * moving ones take the bob interpolation (no combing).
+ */
+static void row_motion_adaptive(
+        const uint8_t* above,
+        const uint8_t* below,
+        const uint8_t* woven,
+        const uint8_t* prev_above,
+        const uint8_t* prev_below,
+        const uint8_t* prev_woven,
+        uint8_t* dst,
+        int count,
+        uint8_t threshold) {
+    int x = 0;
+#if DEINTERLACE_HAVE_NEON
+    const uint8x16_t limit = vdupq_n_u8(threshold);
+    for (; x + 16 <= count; x += 16) {
+        const uint8x16_t a = vld1q_u8(above + x);
+        const uint8x16_t b = vld1q_u8(below + x);
+        const uint8x16_t w = vld1q_u8(woven + x);
+        uint8x16_t motion = vabdq_u8(a, vld1q_u8(prev_above + x));
+        motion = vmaxq_u8(motion, vabdq_u8(b, vld1q_u8(prev_below + x)));
+        motion = vmaxq_u8(motion, vabdq_u8(w, vld1q_u8(prev_woven + x)));
+        const uint8x16_t moving = vcgtq_u8(motion, limit);
+        vst1q_u8(dst + x, vbslq_u8(moving, vrhaddq_u8(a, b), w));
+    }
+#endif
+    for (; x < count; x++) {
+        uint8_t motion = abs_diff_u8(above[x], prev_above[x]);
+        const uint8_t mb = abs_diff_u8(below[x], prev_below[x]);
+        const uint8_t mw = abs_diff_u8(woven[x], prev_woven[x]);
+        if (mb > motion) motion = mb;
+        if (mw > motion) motion = mw;
+        dst[x] = (motion > threshold)
+            ? (uint8_t)(((unsigned)above[x] + (unsigned)below[x] + 1u) >> 1)
+            : woven[x];
+    }
+}
+
+void deinterlace_plane(
+        const uint8_t* cur,
+        const uint8_t* prev,
+        uint8_t* dst,
+        int stride,
+        int row_bytes,
+        int rows,
+        int keep_parity,
+        DeinterlaceMode mode,
+        uint8_t threshold) {
+    for (int y = 0; y < rows; y++) {
+        uint8_t* out = dst + ((size_t)y * (size_t)stride);
+        const uint8_t* row = cur + ((size_t)y * (size_t)stride);
+
+        if ((y & 1) == keep_parity || mode == DEINTERLACE_WEAVE || mode == DEINTERLACE_OFF || rows < 2) {
+            memcpy(out, row, (size_t)row_bytes);
+            continue;
+        }
+
+        /* Edge lines mirror their only kept-field neighbour. */
+        const int ya = (y > 0) ? (y - 1) : (y + 1);
+        const int yb = (y + 1 < rows) ? (y + 1) : (y - 1);
+        const uint8_t* above = cur + ((size_t)ya * (size_t)stride);
+        const uint8_t* below = cur + ((size_t)yb * (size_t)stride);
+
+        if (mode == DEINTERLACE_MOTION_ADAPTIVE && prev != NULL) {
+            row_motion_adaptive(
+                above,
+                below,
+                row,
+                prev + ((size_t)ya * (size_t)stride),
+                prev + ((size_t)yb * (size_t)stride),
+                prev + ((size_t)y * (size_t)stride),
+                out,
+                row_bytes,
+                threshold);
+        } else {
+            row_bob(above, below, out, row_bytes);
+        }
+    }
+}
+
+/* ============================================================================
+ * Deinterlacer
+ * ========================================================================== */
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+static void release_buffers(Deinterlacer* d) {
+    free(d->out[0]);
+    free(d->out[1]);
+    free(d->history);
+    free(d->assembly);
+    d->out[0] = NULL;
+    d->out[1] = NULL;
+    d->history = NULL;
+    d->assembly = NULL;
+    d->history_valid = false;
+    d->fields_seen = 0;
+    d->layout.size = 0;
+}
+
+Deinterlacer* deinterlacer_create(void) {
+    Deinterlacer* d = (Deinterlacer*)calloc(1, sizeof(Deinterlacer));
+    if (d == NULL) {
+        return NULL;
+    }
+    d->mode = DEINTERLACE_OFF;
+    d->mode_applied = DEINTERLACE_OFF;
+    d->threshold = DEINTERLACE_DEFAULT_MOTION_THRESHOLD;
+    return d;
+}
+
+void deinterlacer_destroy(Deinterlacer* d) {
+    if (d == NULL) {
+        return;
+    }
+    release_buffers(d);
+    free(d);
+}
+
+void deinterlacer_set_mode(Deinterlacer* d, DeinterlaceMode mode) {
+    if (d == NULL) {
+        return;
+    }
+    if (mode < DEINTERLACE_OFF || mode > DEINTERLACE_MOTION_ADAPTIVE) {
+        mode = DEINTERLACE_OFF;
+    }
+    d->mode = (int)mode;
+}
+
+DeinterlaceMode deinterlacer_get_mode(const Deinterlacer* d) {
+    return (d != NULL) ? (DeinterlaceMode)d->mode : DEINTERLACE_OFF;
+}
+
+void deinterlacer_set_motion_threshold(Deinterlacer* d, uint8_t threshold) {
+    if (d != NULL) {
+        d->threshold = threshold;
+    }
+}
+
+void deinterlacer_get_stats(const Deinterlacer* d, DeinterlaceStats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (d == NULL) {
+        return;
+    }
+    stats->frames = d->frames;
+    stats->last_ns = d->last_ns;
+    stats->total_ns = d->total_ns;
+}
+
+/* (Re)allocate buffers when the format changes. History is dropped on any change. */
+static bool ensure_format(Deinterlacer* d, uint32_t fourcc, int width, int frame_height, int stride, bool fields) {
+    if (d->out[0] != NULL && d->fourcc == fourcc && d->width == width &&
+        d->frame_height == frame_height && d->stride == stride) {
+        if (fields && d->assembly == NULL) {
+            d->assembly = (uint8_t*)calloc(1, d->layout.size);
+            d->fields_seen = 0;
+            return d->assembly != NULL;
+        }
+        return true;
+    }
+
+    release_buffers(d);
+
+    DiLayout layout;
+    if (!layout_for(fourcc, width, frame_height, stride, &layout)) {
+        return false;
+    }
+
+    d->out[0] = (uint8_t*)malloc(layout.size);
+    d->out[1] = (uint8_t*)malloc(layout.size);
+    d->history = (uint8_t*)malloc(layout.size);
+    d->assembly = fields ? (uint8_t*)calloc(1, layout.size) : NULL;
+    if (d->out[0] == NULL || d->out[1] == NULL || d->history == NULL || (fields && d->assembly == NULL)) {
+        release_buffers(d);
+        return false;
+    }
+
+    d->fourcc = fourcc;
+    d->width = width;
+    d->frame_height = frame_height;
+    d->stride = stride;
+    d->layout = layout;
+    d->next_out = 0;
+    return true;
+}
+
+/* Copy a single field into the even or odd lines of the assembly frame. */
+static bool weave_field(Deinterlacer* d, const DeinterlaceInput* in, int parity) {
+    DiLayout field_layout;
+    if (!layout_for(in->fourcc, in->width, in->height, in->stride, &field_layout) ||
+        field_layout.count != d->layout.count) {
+        return false;
+    }
+
+    for (int p = 0; p < field_layout.count; p++) {
+        const DiPlane* src = &field_layout.planes[p];
+        const DiPlane* dst = &d->layout.planes[p];
+        for (int y = 0; y < src->rows; y++) {
+            const int dst_row = (y * 2) + parity;
+            if (dst_row >= dst->rows) {
+                break;
+            }
+            memcpy(
+                d->assembly + dst->offset + ((size_t)dst_row * (size_t)dst->stride),
+                in->data + src->offset + ((size_t)y * (size_t)src->stride),
+                (size_t)src->row_bytes);
+        }
+    }
+    d->fields_seen |= (1 << parity);
+    return true;
+}
+
+bool deinterlacer_process(Deinterlacer* d, const DeinterlaceInput* in, DeinterlaceOutput* out) {
+    if (d == NULL || in == NULL || out == NULL || in->data == NULL) {
+        return false;
+    }
+
+    const DeinterlaceMode mode = (DeinterlaceMode)d->mode;
+    if (mode != (DeinterlaceMode)d->mode_applied) {
+        d->history_valid = false;
+        d->mode_applied = (int)mode;
+    }
+
+    const bool is_field = (in->field == DEINTERLACE_FIELD_0 || in->field == DEINTERLACE_FIELD_1);
+    if (mode == DEINTERLACE_OFF || (mode == DEINTERLACE_WEAVE && !is_field)) {
+        return false;
+    }
+
+    const uint64_t start = now_ns();
+    const int frame_height = is_field ? (in->height * 2) : in->height;
+    if (!ensure_format(d, in->fourcc, in->width, frame_height, in->stride, is_field)) {
+        return false;
+    }
+
+    const uint8_t* cur = in->data;
+    int keep_parity = DI_INTERLEAVED_KEEP_PARITY;
+    DeinterlaceMode effective = mode;
+    if (is_field) {
+        keep_parity = (in->field == DEINTERLACE_FIELD_1) ? 1 : 0;
+        if (!weave_field(d, in, keep_parity)) {
+            return false;
+        }
+        cur = d->assembly;
+        /* Until both parities have arrived the other lines are empty: interpolate them. */
+        if (d->fields_seen != 3) {
+            effective = DEINTERLACE_BOB;
+        }
+    }
+
+    const uint8_t* prev = (effective == DEINTERLACE_MOTION_ADAPTIVE && d->history_valid) ? d->history : NULL;
+    uint8_t* dst = d->out[d->next_out];
+
+    for (int p = 0; p < d->layout.count; p++) {
+        const DiPlane* plane = &d->layout.planes[p];
+        deinterlace_plane(
+            cur + plane->offset,
+            (prev != NULL) ? (prev + plane->offset) : NULL,
+            dst + plane->offset,
+            plane->stride,
+            plane->row_bytes,
+            plane->rows,
+            keep_parity,
+            effective,
+            d->threshold);
+    }
+
+    if (mode == DEINTERLACE_MOTION_ADAPTIVE) {
+        memcpy(d->history, cur, d->layout.size);
+        d->history_valid = true;
+    }
+
+    d->next_out ^= 1;
+
+    out->data = dst;
+    out->height = frame_height;
+    out->stride = in->stride;
+    out->size = d->layout.size;
+
+    const uint64_t elapsed = now_ns() - start;
+    d->last_ns = elapsed;
+    d->total_ns += elapsed;
+    d->frames++;
+    return true;
+}
@@ -0,0 +1,96 @@
+/**
+ * deinterlace.h - Deinterlacer for field-based NDI video
+ *
+ * Operates on 8-bit-per-sample layouts (UYVY, UYVA, BGRA/BGRX/RGBA/RGBX, NV12, I420, YV12);
+ * other FourCCs are left to the caller untouched.
+ *
+ * Input is either an interleaved frame (both fields, field 0 on even lines) or a single
+ * field, which is woven with the most recent opposite field into a full-height frame.
+ * One progressive frame is produced per input; the field rate is not doubled.
+ */
+
+#ifndef NDI_DEINTERLACE_H
+#define NDI_DEINTERLACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Values match NdiNative.DeinterlaceMode on the Kotlin side. */
+typedef enum DeinterlaceMode {
+    DEINTERLACE_OFF = 0,              /* Pass frames and fields through untouched. */
+    DEINTERLACE_WEAVE = 1,            /* Keep both fields as-is (single fields are still woven). */
+    DEINTERLACE_BOB = 2,              /* Keep one field, interpolate the other's lines. */
+    DEINTERLACE_MOTION_ADAPTIVE = 3,  /* Weave where static, bob where the picture moved. */
+} DeinterlaceMode;
+
+typedef enum DeinterlaceField {
+    DEINTERLACE_INTERLEAVED = 0,  /* Both fields in one frame. */
+    DEINTERLACE_FIELD_0 = 1,      /* Single field holding the even lines. */
+    DEINTERLACE_FIELD_1 = 2,      /* Single field holding the odd lines. */
+} DeinterlaceField;
+
+typedef struct DeinterlaceInput {
+    const uint8_t* data;
+    uint32_t fourcc;
+    int width;
+    int height;   /* Lines in data: frame height, or field height for single fields. */
+    int stride;   /* Bytes per line of the first plane; must be positive. */
+    DeinterlaceField field;
+} DeinterlaceInput;
+
+typedef struct DeinterlaceOutput {
+    const uint8_t* data;  /* Owned by the deinterlacer; valid until the next-but-one process call. */
+    int height;           /* Full frame height (twice the field height for single fields). */
+    int stride;           /* Same as the input stride. */
+    size_t size;
+} DeinterlaceOutput;
+
+typedef struct DeinterlaceStats {
+    uint64_t frames;    /* Inputs that produced an output. */
+    uint64_t last_ns;   /* Wall time of the most recent one. */
+    uint64_t total_ns;  /* Summed wall time, for averaging. */
+} DeinterlaceStats;
+
+/* Motion threshold (per-sample absolute difference) used by DEINTERLACE_MOTION_ADAPTIVE. */
+#define DEINTERLACE_DEFAULT_MOTION_THRESHOLD 12
+
+typedef struct Deinterlacer Deinterlacer;
+
+Deinterlacer* deinterlacer_create(void);
+void deinterlacer_destroy(Deinterlacer* d);
+
+/* Safe to call from any thread; takes effect on the next process call and resets history. */
+void deinterlacer_set_mode(Deinterlacer* d, DeinterlaceMode mode);
+DeinterlaceMode deinterlacer_get_mode(const Deinterlacer* d);
+
+void deinterlacer_set_motion_threshold(Deinterlacer* d, uint8_t threshold);
+
+/*
+ * Deinterlace one input. Returns false when the input should be used as delivered: mode is
+ * OFF, the FourCC is unsupported, weave was requested for an interleaved frame (a no-op),
+ * or a buffer could not be allocated. Not thread-safe; call from the capture thread.
+ */
+bool deinterlacer_process(Deinterlacer* d, const DeinterlaceInput* in, DeinterlaceOutput* out);
+
+void deinterlacer_get_stats(const Deinterlacer* d, DeinterlaceStats* stats);
+
+bool deinterlace_supports_fourcc(uint32_t fourcc);
+
+/*
+ * Deinterlace a single plane of rows (exposed for tests). Rows whose parity equals keep_parity
+ * are copied; the others are rebuilt according to mode. prev is the previous interleaved input
+ * with the same layout, or NULL, in which case motion-adaptive falls back to bob.
+ */
+void deinterlace_plane(
+    const uint8_t* cur,
+    const uint8_t* prev,
+    uint8_t* dst,
+    int stride,
+    int row_bytes,
+    int rows,
+    int keep_parity,
+    DeinterlaceMode mode,
+    uint8_t threshold);
+
+#endif /* NDI_DEINTERLACE_H */
@@ -0,0 +1,289 @@
+/**
+ * frame_arena.c - Budgeted frame-buffer arena shared by every frame consumer
+ */
+
+#include "frame_arena.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#define BLOCK_MAGIC 0x4652414du  /* 'FRAM' */
+#define LARGE_GRANULE 4096
+
+/*
+ * Size classes, with the frames that land in each:
+ *   64 KiB / 256 KiB  audio buffers, typical compressed frames
+ *   1 MiB             compressed keyframes, 640x360 RGBA
+ *   2 MiB             1280x720 NV12
+ *   4 MiB             1280x720 RGBA, 1920x1080 NV12/UYVY
+ *   8 MiB             1920x1080 RGBA/P216
+ *   16 MiB            1920x1080 PA16, 2560x1440 RGBA
+ *   32 MiB            3840x2160 RGBA
+ * Larger requests get an exact-size block that is not cached.
+ */
+static const size_t kClassBytes[FRAME_ARENA_CLASS_COUNT] = {
+    64u << 10, 256u << 10, 1u << 20, 2u << 20, 4u << 20, 8u << 20, 16u << 20, 32u << 20,
+};
+
+/* Precedes every block; sized to keep the payload aligned. */
+typedef union BlockHeader {
+    struct {
+        union BlockHeader* next;  /* Free list link while cached. */
+        size_t capacity;
+        int size_class;           /* -1 for large blocks. */
+        int consumer;
+        uint32_t magic;
+    } h;
+    uint8_t pad[FRAME_ARENA_ALIGNMENT];
+} BlockHeader;
+
+struct FrameArena {
+    pthread_mutex_t lock;
+    BlockHeader* free_lists[FRAME_ARENA_CLASS_COUNT];
+    int cached_count[FRAME_ARENA_CLASS_COUNT];
+    FrameArenaStats stats;
+};
+
+/* ============================================================================
+ * Internal helpers (caller holds the lock)
+ * ========================================================================== */
+
+static int class_for(size_t size) {
+    for (int i = 0; i < FRAME_ARENA_CLASS_COUNT; i++) {
+        if (size <= kClassBytes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool valid_consumer(int consumer) {
+    return consumer >= 0 && consumer < FRAME_ARENA_MAX_CONSUMERS;
+}
+
+static void charge(FrameArena* arena, int consumer, int64_t bytes) {
+    FrameArenaStats* s = &arena->stats;
+    FrameArenaConsumerStats* c = &s->consumers[consumer];
+    s->used_bytes += bytes;
+    if (s->used_bytes > s->peak_used_bytes) {
+        s->peak_used_bytes = s->used_bytes;
+    }
+    s->allocs++;
+    c->current_bytes += bytes;
+    if (c->current_bytes > c->peak_bytes) {
+        c->peak_bytes = c->current_bytes;
+    }
+    c->allocs++;
+}
+
+static void reject(FrameArena* arena, int consumer) {
+    arena->stats.rejected++;
+    arena->stats.consumers[consumer].rejected++;
+}
+
+/*
+ * Unlink cached blocks, largest first, until used + cached + extra fits the budget.
+ * Returns them as a list for the caller to free after unlocking.
+ */
+static BlockHeader* evict_cached(FrameArena* arena, int64_t extra) {
+    BlockHeader* evicted = NULL;
+    FrameArenaStats* s = &arena->stats;
+    for (int i = FRAME_ARENA_CLASS_COUNT - 1; i >= 0; i--) {
+        while (arena->free_lists[i] != NULL && s->used_bytes + s->cached_bytes + extra > s->budget_bytes) {
+            BlockHeader* block = arena->free_lists[i];
+            arena->free_lists[i] = block->h.next;
+            arena->cached_count[i]--;
+            s->cached_bytes -= (int64_t)block->h.capacity;
+            block->h.next = evicted;
+            evicted = block;
+        }
+    }
+    return evicted;
+}
+
+static void free_list(BlockHeader* list) {
+    while (list != NULL) {
+        BlockHeader* next = list->h.next;
+        free(list);
+        list = next;
+    }
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+FrameArena* frame_arena_create(int64_t budget_bytes) {
+    FrameArena* arena = (FrameArena*)calloc(1, sizeof(FrameArena));
+    if (arena == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&arena->lock, NULL) != 0) {
+        free(arena);
+        return NULL;
+    }
+    arena->stats.budget_bytes = budget_bytes > 0 ? budget_bytes : 0;
+    return arena;
+}
+
+void frame_arena_destroy(FrameArena* arena) {
+    if (arena == NULL) {
+        return;
+    }
+    for (int i = 0; i < FRAME_ARENA_CLASS_COUNT; i++) {
+        free_list(arena->free_lists[i]);
+    }
+    pthread_mutex_destroy(&arena->lock);
+    free(arena);
+}
+
+void frame_arena_set_budget(FrameArena* arena, int64_t budget_bytes) {
+    pthread_mutex_lock(&arena->lock);
+    arena->stats.budget_bytes = budget_bytes > 0 ? budget_bytes : 0;
+    BlockHeader* evicted = evict_cached(arena, 0);
+    pthread_mutex_unlock(&arena->lock);
+    free_list(evicted);
+}
+
+size_t frame_arena_block_size(size_t size) {
+    const int cls = class_for(size);
+    if (cls >= 0) {
+        return kClassBytes[cls];
+    }
+    return (size + LARGE_GRANULE - 1) & ~(size_t)(LARGE_GRANULE - 1);
+}
+
+void* frame_arena_alloc(FrameArena* arena, int consumer, size_t size) {
+    if (!valid_consumer(consumer) || size == 0) {
+        return NULL;
+    }
+    const int cls = class_for(size);
+    const size_t capacity = frame_arena_block_size(size);
+
+    pthread_mutex_lock(&arena->lock);
+    if (arena->stats.used_bytes + (int64_t)capacity > arena->stats.budget_bytes) {
+        reject(arena, consumer);
+        pthread_mutex_unlock(&arena->lock);
+        return NULL;
+    }
+
+    BlockHeader* block = NULL;
+    BlockHeader* evicted = NULL;
+    if (cls >= 0 && arena->free_lists[cls] != NULL) {
+        block = arena->free_lists[cls];
+        arena->free_lists[cls] = block->h.next;
+        arena->cached_count[cls]--;
+        arena->stats.cached_bytes -= (int64_t)capacity;
+        arena->stats.reuses++;
+    } else {
+        evicted = evict_cached(arena, (int64_t)capacity);
+    }
+    /* Charge before allocating so concurrent requests cannot overshoot the budget. */
+    charge(arena, consumer, (int64_t)capacity);
+    pthread_mutex_unlock(&arena->lock);
+
+    free_list(evicted);
+    if (block == NULL) {
+        void* mem = NULL;
+        if (posix_memalign(&mem, FRAME_ARENA_ALIGNMENT, sizeof(BlockHeader) + capacity) != 0) {
+            pthread_mutex_lock(&arena->lock);
+            arena->stats.used_bytes -= (int64_t)capacity;
+            arena->stats.consumers[consumer].current_bytes -= (int64_t)capacity;
+            arena->stats.allocs--;
+            arena->stats.consumers[consumer].allocs--;
+            reject(arena, consumer);
+            pthread_mutex_unlock(&arena->lock);
+            return NULL;
+        }
+        block = (BlockHeader*)mem;
+        block->h.capacity = capacity;
+        block->h.size_class = cls;
+        block->h.magic = BLOCK_MAGIC;
+    }
+    block->h.next = NULL;
+    block->h.consumer = consumer;
+    return (uint8_t*)block + sizeof(BlockHeader);
+}
+
+void frame_arena_free(FrameArena* arena, void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    BlockHeader* block = (BlockHeader*)((uint8_t*)ptr - sizeof(BlockHeader));
+    if (block->h.magic != BLOCK_MAGIC) {
+        return;
+    }
+    const int64_t capacity = (int64_t)block->h.capacity;
+    const int cls = block->h.size_class;
+
+    pthread_mutex_lock(&arena->lock);
+    FrameArenaStats* s = &arena->stats;
+    s->used_bytes -= capacity;
+    s->consumers[block->h.consumer].current_bytes -= capacity;
+
+    bool cached = false;
+    if (cls >= 0 && arena->cached_count[cls] < FRAME_ARENA_MAX_CACHED_PER_CLASS &&
+            s->used_bytes + s->cached_bytes + capacity <= s->budget_bytes) {
+        block->h.next = arena->free_lists[cls];
+        arena->free_lists[cls] = block;
+        arena->cached_count[cls]++;
+        s->cached_bytes += capacity;
+        cached = true;
+    }
+    pthread_mutex_unlock(&arena->lock);
+
+    if (!cached) {
+        block->h.magic = 0;
+        free(block);
+    }
+}
+
+bool frame_arena_reserve(FrameArena* arena, int consumer, int64_t bytes) {
+    if (!valid_consumer(consumer) || bytes < 0) {
+        return false;
+    }
+    pthread_mutex_lock(&arena->lock);
+    if (arena->stats.used_bytes + bytes > arena->stats.budget_bytes) {
+        reject(arena, consumer);
+        pthread_mutex_unlock(&arena->lock);
+        return false;
+    }
+    charge(arena, consumer, bytes);
+    BlockHeader* evicted = evict_cached(arena, 0);
+    pthread_mutex_unlock(&arena->lock);
+    free_list(evicted);
+    return true;
+}
+
+void frame_arena_unreserve(FrameArena* arena, int consumer, int64_t bytes) {
+    if (!valid_consumer(consumer) || bytes <= 0) {
+        return;
+    }
+    pthread_mutex_lock(&arena->lock);
+    arena->stats.used_bytes -= bytes;
+    arena->stats.consumers[consumer].current_bytes -= bytes;
+    pthread_mutex_unlock(&arena->lock);
+}
+
+void frame_arena_trim(FrameArena* arena) {
+    BlockHeader* evicted = NULL;
+    pthread_mutex_lock(&arena->lock);
+    for (int i = 0; i < FRAME_ARENA_CLASS_COUNT; i++) {
+        while (arena->free_lists[i] != NULL) {
+            BlockHeader* block = arena->free_lists[i];
+            arena->free_lists[i] = block->h.next;
+            block->h.next = evicted;
+            evicted = block;
+        }
+        arena->cached_count[i] = 0;
+    }
+    arena->stats.cached_bytes = 0;
+    pthread_mutex_unlock(&arena->lock);
+    free_list(evicted);
+}
+
+void frame_arena_get_stats(FrameArena* arena, FrameArenaStats* stats) {
+    pthread_mutex_lock(&arena->lock);
+    *stats = arena->stats;
+    pthread_mutex_unlock(&arena->lock);
+}
@@ -0,0 +1,84 @@
+/**
+ * frame_arena.h - Budgeted frame-buffer arena shared by every frame consumer
+ *
+ * Blocks come from a fixed set of size classes chosen around common frame sizes and are
+ * recycled through per-class free lists. Every byte handed out is charged to a consumer and
+ * to a global budget; a request that would exceed the budget fails instead of growing, so
+ * producers see back-pressure and drop or skip work. Memory the arena does not own (Bitmaps,
+ * Java arrays) can be charged with frame_arena_reserve() so it counts against the same budget.
+ *
+ * Cached free blocks count toward the budget too and are released first when room is needed.
+ */
+
+#ifndef NDI_FRAME_ARENA_H
+#define NDI_FRAME_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_ARENA_ALIGNMENT 64
+#define FRAME_ARENA_CLASS_COUNT 8
+#define FRAME_ARENA_MAX_CACHED_PER_CLASS 4
+#define FRAME_ARENA_MAX_CONSUMERS 8
+#define FRAME_ARENA_DEFAULT_BUDGET (512LL * 1024 * 1024)
+
+/* Values match NdiNative.ArenaConsumer on the Kotlin side. */
+typedef enum FrameArenaConsumer {
+    FRAME_ARENA_RENDERER = 0,   /* Uncompressed renderer conversion buffers and bitmaps. */
+    FRAME_ARENA_RECORDER = 1,   /* Frames queued for recording. */
+    FRAME_ARENA_CONVERTER = 2,  /* Encoder input produced by color conversion. */
+    FRAME_ARENA_DECODER = 3,    /* Compressed frames queued for MediaCodec. */
+    FRAME_ARENA_AUDIO = 4,      /* Interleaved audio handed to Java. */
+} FrameArenaConsumer;
+
+typedef struct FrameArenaConsumerStats {
+    int64_t current_bytes;  /* Blocks and reservations currently held. */
+    int64_t peak_bytes;
+    uint64_t allocs;        /* Successful allocations and reservations. */
+    uint64_t rejected;      /* Requests refused by the budget. */
+} FrameArenaConsumerStats;
+
+typedef struct FrameArenaStats {
+    int64_t budget_bytes;
+    int64_t used_bytes;     /* Charged to consumers (block capacity, not requested size). */
+    int64_t cached_bytes;   /* Free blocks kept for reuse. */
+    int64_t peak_used_bytes;
+    uint64_t allocs;
+    uint64_t reuses;        /* Allocations served from a free list. */
+    uint64_t rejected;
+    FrameArenaConsumerStats consumers[FRAME_ARENA_MAX_CONSUMERS];
+} FrameArenaStats;
+
+typedef struct FrameArena FrameArena;
+
+FrameArena* frame_arena_create(int64_t budget_bytes);
+
+/* All blocks must have been freed. */
+void frame_arena_destroy(FrameArena* arena);
+
+/* Lowering the budget releases cached blocks; blocks in use stay valid until freed. */
+void frame_arena_set_budget(FrameArena* arena, int64_t budget_bytes);
+
+/* Byte capacity of the block that serves a request of size bytes. */
+size_t frame_arena_block_size(size_t size);
+
+/*
+ * Allocate at least size bytes, FRAME_ARENA_ALIGNMENT aligned. Returns NULL when the budget
+ * would be exceeded (back-pressure), the consumer is out of range, or memory is exhausted.
+ */
+void* frame_arena_alloc(FrameArena* arena, int consumer, size_t size);
+
+/* Return a block from frame_arena_alloc(). NULL is ignored. */
+void frame_arena_free(FrameArena* arena, void* ptr);
+
+/* Charge memory allocated elsewhere. Returns false, charging nothing, if it does not fit. */
+bool frame_arena_reserve(FrameArena* arena, int consumer, int64_t bytes);
+void frame_arena_unreserve(FrameArena* arena, int consumer, int64_t bytes);
+
+/* Release every cached free block. */
+void frame_arena_trim(FrameArena* arena);
+
+void frame_arena_get_stats(FrameArena* arena, FrameArenaStats* stats);
+
+#endif /* NDI_FRAME_ARENA_H */
@@ -0,0 +1,311 @@
+/**
+ * frame_pacer.c - Vsync-aligned presentation scheduling for uncompressed video
+ *
+ * Timeline: due_ns = sender_timestamp_ns + offset_ns. The offset is anchored on the first
+ * frame so that it is due delay_ns after arrival, slewed slowly so the average wait stays at
+ * delay_ns (sender and receiver clocks drift apart), and re-anchored when a frame lands
+ * further than resync_ns from where it should.
+ *
+ * Decision at a vsync V with period P: frames due by V + P/2 would be closer to V than to
+ * the next refresh. The newest of them is presented, the older ones are dropped. With none
+ * due the picture is held; that counts as a repeat only when the queue ran dry after the
+ * presented frame's duration elapsed, not when the content is simply slower than the display.
+ */
+
+#include "frame_pacer.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#define DEFAULT_VSYNC_PERIOD_NS 16666667LL
+#define MIN_VSYNC_PERIOD_NS 2000000LL     /* 500 Hz */
+#define MAX_VSYNC_PERIOD_NS 100000000LL   /* 10 Hz */
+#define DRIFT_SLEW_SHIFT 8                /* Correct 1/256 of each frame's wait error. */
+
+typedef struct PacerEntry {
+    int64_t id;
+    int64_t due_ns;
+    int64_t duration_ns;
+} PacerEntry;
+
+struct FramePacer {
+    pthread_mutex_t lock;
+
+    PacerEntry queue[FRAME_PACER_MAX_CAPACITY];
+    int capacity;
+    int head;
+    int count;
+
+    int64_t delay_ns;
+    int64_t resync_ns;
+    bool anchored;
+    int64_t offset_ns;
+    bool has_last_timestamp;
+    int64_t last_timestamp_ns;
+
+    bool has_presented;
+    int64_t next_expected_ns;   /* Due time of the frame after the presented one, if known. */
+    int64_t presented_duration_ns;
+
+    int64_t last_vsync_ns;
+    int64_t measured_period_ns;
+
+    FramePacerStats stats;
+};
+
+/* ============================================================================
+ * Internal helpers (caller holds the lock)
+ * ========================================================================== */
+
+static PacerEntry* entry_at(FramePacer* pacer, int index) {
+    return &pacer->queue[(pacer->head + index) % FRAME_PACER_MAX_CAPACITY];
+}
+
+static PacerEntry pop_front(FramePacer* pacer) {
+    const PacerEntry entry = pacer->queue[pacer->head];
+    pacer->head = (pacer->head + 1) % FRAME_PACER_MAX_CAPACITY;
+    pacer->count--;
+    return entry;
+}
+
+static void anchor(FramePacer* pacer, int64_t timestamp_ns, int64_t now_ns) {
+    pacer->offset_ns = now_ns + pacer->delay_ns - timestamp_ns;
+    pacer->anchored = true;
+}
+
+static int64_t update_period(FramePacer* pacer, int64_t vsync_ns, int64_t period_ns) {
+    if (pacer->last_vsync_ns != 0 && vsync_ns > pacer->last_vsync_ns) {
+        const int64_t delta = vsync_ns - pacer->last_vsync_ns;
+        const int64_t measured = pacer->measured_period_ns;
+        if (measured == 0) {
+            if (delta >= MIN_VSYNC_PERIOD_NS && delta <= MAX_VSYNC_PERIOD_NS) {
+                pacer->measured_period_ns = delta;
+            }
+        } else if (delta > measured / 2 && delta < measured + (measured / 2)) {
+            /* Skip intervals that span missed callbacks. */
+            pacer->measured_period_ns = measured + ((delta - measured) / 8);
+        }
+    }
+    pacer->last_vsync_ns = vsync_ns;
+
+    if (period_ns > 0) {
+        return period_ns;
+    }
+    return pacer->measured_period_ns > 0 ? pacer->measured_period_ns : DEFAULT_VSYNC_PERIOD_NS;
+}
+
+static void record_error(FramePacerStats* stats, int64_t error_ns) {
+    if (stats->presented == 0 || error_ns < stats->error_min_ns) {
+        stats->error_min_ns = error_ns;
+    }
+    if (stats->presented == 0 || error_ns > stats->error_max_ns) {
+        stats->error_max_ns = error_ns;
+    }
+    stats->error_sum_ns += error_ns;
+    stats->presented++;
+
+    int bucket = 0;
+    const int64_t offset = error_ns - FRAME_PACER_HISTOGRAM_ORIGIN_NS;
+    if (offset > 0) {
+        const int64_t index = offset / FRAME_PACER_HISTOGRAM_BUCKET_NS;
+        bucket = index >= FRAME_PACER_HISTOGRAM_BUCKETS ? FRAME_PACER_HISTOGRAM_BUCKETS - 1 : (int)index;
+    }
+    stats->histogram[bucket]++;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+FramePacer* frame_pacer_create(int capacity) {
+    FramePacer* pacer = (FramePacer*)calloc(1, sizeof(FramePacer));
+    if (pacer == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&pacer->lock, NULL) != 0) {
+        free(pacer);
+        return NULL;
+    }
+    if (capacity < 1) {
+        capacity = 1;
+    } else if (capacity > FRAME_PACER_MAX_CAPACITY) {
+        capacity = FRAME_PACER_MAX_CAPACITY;
+    }
+    pacer->capacity = capacity;
+    pacer->delay_ns = FRAME_PACER_DEFAULT_DELAY_NS;
+    pacer->resync_ns = FRAME_PACER_DEFAULT_RESYNC_NS;
+    return pacer;
+}
+
+void frame_pacer_destroy(FramePacer* pacer) {
+    if (pacer == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&pacer->lock);
+    free(pacer);
+}
+
+void frame_pacer_reset(FramePacer* pacer) {
+    pthread_mutex_lock(&pacer->lock);
+    pacer->head = 0;
+    pacer->count = 0;
+    pacer->anchored = false;
+    pacer->has_last_timestamp = false;
+    pacer->has_presented = false;
+    pacer->next_expected_ns = 0;
+    pthread_mutex_unlock(&pacer->lock);
+}
+
+void frame_pacer_set_delay(FramePacer* pacer, int64_t delay_ns) {
+    pthread_mutex_lock(&pacer->lock);
+    if (delay_ns < 0) {
+        delay_ns = 0;
+    }
+    if (pacer->anchored) {
+        pacer->offset_ns += delay_ns - pacer->delay_ns;
+    }
+    pacer->delay_ns = delay_ns;
+    pthread_mutex_unlock(&pacer->lock);
+}
+
+int64_t frame_pacer_enqueue(FramePacer* pacer, int64_t id, int64_t timestamp_100ns, int64_t duration_ns, int64_t now_ns) {
+    pthread_mutex_lock(&pacer->lock);
+
+    /* Without sender timestamps, pace by arrival. */
+    const int64_t timestamp_ns = timestamp_100ns == FRAME_PACER_TIMESTAMP_UNDEFINED ? now_ns : timestamp_100ns * 100;
+
+    bool resync = !pacer->anchored;
+    if (pacer->has_last_timestamp && timestamp_ns <= pacer->last_timestamp_ns) {
+        if (pacer->last_timestamp_ns - timestamp_ns <= pacer->resync_ns) {
+            /* Duplicate or reordered frame: the caller gets it straight back. */
+            pacer->stats.rejected++;
+            pthread_mutex_unlock(&pacer->lock);
+            return id;
+        }
+        resync = true;  /* Sender restarted or its clock stepped back. */
+    }
+
+    if (!resync) {
+        const int64_t wait_ns = timestamp_ns + pacer->offset_ns - now_ns;
+        if (wait_ns < -pacer->resync_ns || wait_ns > pacer->delay_ns + pacer->resync_ns) {
+            resync = true;
+        } else {
+            pacer->offset_ns -= (wait_ns - pacer->delay_ns) / (1 << DRIFT_SLEW_SHIFT);
+        }
+    }
+    if (resync) {
+        if (pacer->anchored) {
+            pacer->stats.resyncs++;
+        }
+        anchor(pacer, timestamp_ns, now_ns);
+    }
+    pacer->last_timestamp_ns = timestamp_ns;
+    pacer->has_last_timestamp = true;
+
+    int64_t evicted = -1;
+    if (pacer->count == pacer->capacity) {
+        evicted = pop_front(pacer).id;
+        pacer->stats.dropped++;
+    }
+    PacerEntry* entry = entry_at(pacer, pacer->count);
+    entry->id = id;
+    entry->due_ns = timestamp_ns + pacer->offset_ns;
+    entry->duration_ns = duration_ns > 0 ? duration_ns : 0;
+    pacer->count++;
+    pacer->stats.enqueued++;
+
+    pthread_mutex_unlock(&pacer->lock);
+    return evicted;
+}
+
+int64_t frame_pacer_on_vsync(
+    FramePacer* pacer,
+    int64_t vsync_ns,
+    int64_t period_ns,
+    int64_t* dropped,
+    int dropped_capacity,
+    int* dropped_count) {
+    pthread_mutex_lock(&pacer->lock);
+
+    const int64_t period = update_period(pacer, vsync_ns, period_ns);
+    const int64_t deadline = vsync_ns + (period / 2);
+
+    int due = 0;
+    while (due < pacer->count && entry_at(pacer, due)->due_ns <= deadline) {
+        due++;
+    }
+
+    int drops = 0;
+    int64_t present = -1;
+    if (due == 0) {
+        if (pacer->has_presented && pacer->count == 0 &&
+            pacer->next_expected_ns != 0 && pacer->next_expected_ns <= deadline) {
+            /* The next frame should be on screen by now but has not arrived. */
+            pacer->stats.repeated++;
+            pacer->next_expected_ns += pacer->presented_duration_ns;
+        }
+    } else {
+        /* Ids that cannot be handed back stay queued rather than leaking. */
+        drops = due - 1;
+        if (drops > dropped_capacity) {
+            drops = dropped_capacity;
+        }
+        for (int i = 0; i < drops; i++) {
+            dropped[i] = pop_front(pacer).id;
+        }
+        pacer->stats.dropped += (uint64_t)drops;
+
+        const PacerEntry entry = pop_front(pacer);
+        present = entry.id;
+        record_error(&pacer->stats, vsync_ns - entry.due_ns);
+        pacer->has_presented = true;
+        pacer->presented_duration_ns = entry.duration_ns;
+        pacer->next_expected_ns = entry.duration_ns > 0 ? entry.due_ns + entry.duration_ns : 0;
+    }
+
+    if (dropped_count != NULL) {
+        *dropped_count = drops;
+    }
+    pthread_mutex_unlock(&pacer->lock);
+    return present;
+}
+
+void frame_pacer_get_stats(FramePacer* pacer, FramePacerStats* stats) {
+    pthread_mutex_lock(&pacer->lock);
+    *stats = pacer->stats;
+    stats->queue_depth = pacer->count;
+    stats->vsync_period_ns = pacer->measured_period_ns;
+    pthread_mutex_unlock(&pacer->lock);
+}
+
+int64_t frame_pacer_error_percentile_ns(const FramePacerStats* stats, double percentile) {
+    if (stats->presented == 0) {
+        return 0;
+    }
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    uint64_t target = (uint64_t)((percentile / 100.0) * (double)stats->presented);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < FRAME_PACER_HISTOGRAM_BUCKETS; i++) {
+        seen += stats->histogram[i];
+        if (seen >= target) {
+            if (i == 0) {
+                return stats->error_min_ns;
+            }
+            if (i == FRAME_PACER_HISTOGRAM_BUCKETS - 1) {
+                return stats->error_max_ns;
+            }
+            /* Upper edge of the bucket, clamped to what was actually observed. */
+            const int64_t edge = FRAME_PACER_HISTOGRAM_ORIGIN_NS + ((int64_t)(i + 1) * FRAME_PACER_HISTOGRAM_BUCKET_NS);
+            return edge < stats->error_max_ns ? edge : stats->error_max_ns;
+        }
+    }
+    return stats->error_max_ns;
+}
@@ -0,0 +1,85 @@
+/**
+ * frame_pacer.h - Vsync-aligned presentation scheduling for uncompressed video
+ *
+ * The pacer never reads a clock: arrival and vsync times are passed in (CLOCK_MONOTONIC
+ * nanoseconds on device, i.e. System.nanoTime() and Choreographer frame times), so the
+ * scheduling is deterministic.
+ *
+ * Frames are queued with their NDI timestamps. The first frame anchors the sender timeline
+ * to the local clock plus a presentation delay; every frame then has a local due time. On
+ * each vsync the newest frame due by the middle of the refresh interval is presented, older
+ * ones are dropped, and when nothing is due the previous frame stays on screen.
+ */
+
+#ifndef NDI_FRAME_PACER_H
+#define NDI_FRAME_PACER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* NDIlib_recv_timestamp_undefined: the sender did not provide a timestamp. */
+#define FRAME_PACER_TIMESTAMP_UNDEFINED INT64_MAX
+
+#define FRAME_PACER_MAX_CAPACITY 16
+#define FRAME_PACER_DEFAULT_DELAY_NS 20000000LL        /* 20 ms */
+#define FRAME_PACER_DEFAULT_RESYNC_NS 250000000LL      /* 250 ms */
+
+/* Present-time error histogram: 1 ms buckets from -16 ms; first and last buckets are open-ended. */
+#define FRAME_PACER_HISTOGRAM_BUCKETS 64
+#define FRAME_PACER_HISTOGRAM_BUCKET_NS 1000000LL
+#define FRAME_PACER_HISTOGRAM_ORIGIN_NS (-16000000LL)
+
+typedef struct FramePacerStats {
+    uint64_t enqueued;
+    uint64_t presented;
+    uint64_t dropped;     /* Skipped at vsync because a newer frame was due, or evicted when full. */
+    uint64_t repeated;    /* Vsyncs that held the previous frame although the next one was due. */
+    uint64_t rejected;    /* Arrived with a timestamp not after the previous frame's. */
+    uint64_t resyncs;     /* Timeline re-anchored after a timestamp jump or sustained drift. */
+    int queue_depth;
+    int64_t vsync_period_ns;
+    int64_t error_min_ns; /* Present time minus due time over presented frames. */
+    int64_t error_max_ns;
+    int64_t error_sum_ns;
+    uint64_t histogram[FRAME_PACER_HISTOGRAM_BUCKETS];
+} FramePacerStats;
+
+typedef struct FramePacer FramePacer;
+
+/* capacity is clamped to 1..FRAME_PACER_MAX_CAPACITY queued frames. */
+FramePacer* frame_pacer_create(int capacity);
+void frame_pacer_destroy(FramePacer* pacer);
+
+/* Drop all queued frames and the timeline anchor (statistics are kept). */
+void frame_pacer_reset(FramePacer* pacer);
+
+/* Delay between a frame's anchored arrival and its presentation; absorbs arrival jitter. */
+void frame_pacer_set_delay(FramePacer* pacer, int64_t delay_ns);
+
+/*
+ * Queue frame id for presentation. duration_ns is the nominal frame period (0 if unknown).
+ * Returns the id of a frame the caller gets back because it was evicted or rejected (possibly
+ * id itself), or -1 if none.
+ */
+int64_t frame_pacer_enqueue(FramePacer* pacer, int64_t id, int64_t timestamp_100ns, int64_t duration_ns, int64_t now_ns);
+
+/*
+ * Pick the frame to show at the vsync at vsync_ns. period_ns <= 0 lets the pacer use the
+ * interval it measured between calls. Ids of frames dropped by this decision are written to
+ * dropped (up to dropped_capacity) and counted in *dropped_count.
+ * Returns the id to present, or -1 to keep the current picture.
+ */
+int64_t frame_pacer_on_vsync(
+    FramePacer* pacer,
+    int64_t vsync_ns,
+    int64_t period_ns,
+    int64_t* dropped,
+    int dropped_capacity,
+    int* dropped_count);
+
+void frame_pacer_get_stats(FramePacer* pacer, FramePacerStats* stats);
+
+/* Error at the given percentile (0..100) from the histogram, at bucket resolution. */
+int64_t frame_pacer_error_percentile_ns(const FramePacerStats* stats, double percentile);
+
+#endif /* NDI_FRAME_PACER_H */
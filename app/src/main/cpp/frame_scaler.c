@@ -0,0 +1,523 @@
+/**
+ * frame_scaler.c - Converting and scaling received frames to RGBA in one pass
+ *
+ * See frame_scaler.h. Horizontal results are kept in Q8 (8-bit value << 8), so no precision
+ * is lost between the passes.
+ *
+ * Intermediate rows are cached in a ring of as many slots as the vertical filter has taps.
+ * The source rows a destination row needs are consecutive and never move backwards, so each
+ * source row is unpacked and filtered once per frame.
+ */
+
+#include "frame_scaler.h"
+#include "ndi_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SCALER_HAVE_NEON 1
+#else
+#define SCALER_HAVE_NEON 0
+#endif
+
+#define WEIGHT_BITS 14
+#define WEIGHT_ONE (1 << WEIGHT_BITS)
+
+/* BT.709 limited range to full-range RGB, Q8 (as thumbnail.c). */
+#define YUV_Y_SCALE 298
+#define YUV_RV 459
+#define YUV_GU 55
+#define YUV_GV 136
+#define YUV_BU 541
+
+typedef struct AxisFilter {
+    int src_size;
+    int dst_size;
+    ScalerFilter filter;     /* AREA or BILINEAR; AUTO is resolved before building. */
+    int stride;              /* Weights stored per destination index. */
+    int taps;                /* Largest count; weights past an index's count are zero. */
+    int* start;              /* First source index per destination index. */
+    int* count;              /* Taps per destination index. */
+    uint16_t* weights;       /* stride Q14 weights per destination index. */
+} AxisFilter;
+
+struct FrameScaler {
+    AxisFilter h;
+    AxisFilter v;
+    int src_width;           /* Row buffers are sized for these. */
+    int dst_width;
+    int pad;
+    int slots;
+    uint8_t* unpacked;       /* One source row as 4-channel pixels, then pad zero pixels. */
+    uint16_t* rows;          /* slots horizontally filtered rows of dst_width * 4. */
+    int* row_index;          /* Source row held by each slot, -1 for none. */
+    const uint16_t** taps;   /* Rows combined into the current destination row. */
+    uint8_t* out_row;        /* YUVA destination row before conversion. */
+};
+
+/* ============================================================================
+ * Filter Tables
+ * ========================================================================== */
+
+static void axis_free(AxisFilter* a) {
+    free(a->start);
+    free(a->count);
+    free(a->weights);
+    memset(a, 0, sizeof(*a));
+}
+
+/* Make the weights of one destination index sum to exactly WEIGHT_ONE. */
+static void normalize_weights(uint16_t* w, int count) {
+    int sum = 0;
+    int largest = 0;
+    for (int t = 0; t < count; t++) {
+        sum += w[t];
+        if (w[t] > w[largest]) {
+            largest = t;
+        }
+    }
+    w[largest] = (uint16_t)(w[largest] + (WEIGHT_ONE - sum));
+}
+
+/*
+ * Area: destination index i covers [i * src, (i + 1) * src) and source index j covers
+ * [j * dst, (j + 1) * dst), both in units of 1 / (src * dst) of the axis.
+ */
+static void build_area(AxisFilter* a) {
+    const int64_t src = a->src_size;
+    const int64_t dst = a->dst_size;
+    for (int i = 0; i < a->dst_size; i++) {
+        const int64_t begin = (int64_t)i * src;
+        const int64_t end = begin + src;
+        const int first = (int)(begin / dst);
+        const int last = (int)((end - 1) / dst);
+        uint16_t* w = a->weights + (size_t)i * (size_t)a->stride;
+        a->start[i] = first;
+        a->count[i] = last - first + 1;
+        for (int j = first; j <= last; j++) {
+            const int64_t lo = ((int64_t)j * dst > begin) ? (int64_t)j * dst : begin;
+            const int64_t hi = ((int64_t)(j + 1) * dst < end) ? (int64_t)(j + 1) * dst : end;
+            w[j - first] = (uint16_t)(((hi - lo) * WEIGHT_ONE + src / 2) / src);
+        }
+        normalize_weights(w, a->count[i]);
+    }
+}
+
+/* Bilinear: destination centers mapped onto source centers, clamped at the edges. */
+static void build_bilinear(AxisFilter* a) {
+    const int64_t src = a->src_size;
+    const int64_t dst = a->dst_size;
+    for (int i = 0; i < a->dst_size; i++) {
+        /* Position (i + 0.5) * src / dst - 0.5 in Q14. */
+        int64_t pos = (((int64_t)(2 * i + 1) * src - dst) * WEIGHT_ONE) / (2 * dst);
+        if (pos < 0) {
+            pos = 0;
+        }
+        int j = (int)(pos >> WEIGHT_BITS);
+        int frac = (int)(pos & (WEIGHT_ONE - 1));
+        if (j >= a->src_size - 1) {
+            j = a->src_size - 1;
+            frac = 0;
+        }
+        uint16_t* w = a->weights + (size_t)i * (size_t)a->stride;
+        a->start[i] = j;
+        if (frac == 0) {
+            a->count[i] = 1;
+            w[0] = WEIGHT_ONE;
+        } else {
+            a->count[i] = 2;
+            w[0] = (uint16_t)(WEIGHT_ONE - frac);
+            w[1] = (uint16_t)frac;
+        }
+    }
+}
+
+static bool axis_build(AxisFilter* a, int src_size, int dst_size, ScalerFilter filter) {
+    if (a->weights != NULL && a->src_size == src_size && a->dst_size == dst_size && a->filter == filter) {
+        return true;
+    }
+    axis_free(a);
+
+    /* A destination pixel overlaps at most ceil(src / dst) + 1 source pixels. */
+    const int stride = (filter == SCALER_FILTER_AREA) ? (src_size + dst_size - 1) / dst_size + 1 : 2;
+    a->start = (int*)malloc(sizeof(int) * (size_t)dst_size);
+    a->count = (int*)malloc(sizeof(int) * (size_t)dst_size);
+    a->weights = (uint16_t*)calloc((size_t)dst_size * (size_t)stride, sizeof(uint16_t));
+    if (a->start == NULL || a->count == NULL || a->weights == NULL) {
+        axis_free(a);
+        return false;
+    }
+    a->src_size = src_size;
+    a->dst_size = dst_size;
+    a->filter = filter;
+    a->stride = stride;
+    if (filter == SCALER_FILTER_AREA) {
+        build_area(a);
+    } else {
+        build_bilinear(a);
+    }
+    a->taps = 1;
+    for (int i = 0; i < dst_size; i++) {
+        a->taps = (a->count[i] > a->taps) ? a->count[i] : a->taps;
+    }
+    return true;
+}
+
+/*
+ * The horizontal pass reads h.taps pixels from every start, so the unpacked row is followed by
+ * that many zero pixels (with zero weights) instead of the pass checking its count per pixel.
+ */
+static bool ensure_buffers(FrameScaler* fs, int src_width, int dst_width) {
+    const int pad = fs->h.taps;
+    const int slots = fs->v.taps;
+    if (fs->unpacked != NULL && fs->src_width == src_width && fs->dst_width == dst_width && fs->pad == pad &&
+        fs->slots == slots) {
+        return true;
+    }
+    free(fs->unpacked);
+    free(fs->rows);
+    free(fs->row_index);
+    free(fs->taps);
+    free(fs->out_row);
+    fs->unpacked = (uint8_t*)calloc((size_t)(src_width + pad), 4);
+    fs->rows = (uint16_t*)malloc((size_t)slots * (size_t)dst_width * 4 * sizeof(uint16_t));
+    fs->row_index = (int*)malloc(sizeof(int) * (size_t)slots);
+    fs->taps = (const uint16_t**)malloc(sizeof(uint16_t*) * (size_t)slots);
+    fs->out_row = (uint8_t*)malloc((size_t)dst_width * 4);
+    if (fs->unpacked == NULL || fs->rows == NULL || fs->row_index == NULL || fs->taps == NULL ||
+        fs->out_row == NULL) {
+        free(fs->unpacked);
+        free(fs->rows);
+        free(fs->row_index);
+        free(fs->taps);
+        free(fs->out_row);
+        fs->unpacked = NULL;
+        fs->rows = NULL;
+        fs->row_index = NULL;
+        fs->taps = NULL;
+        fs->out_row = NULL;
+        return false;
+    }
+    fs->src_width = src_width;
+    fs->dst_width = dst_width;
+    fs->pad = pad;
+    fs->slots = slots;
+    return true;
+}
+
+/* ============================================================================
+ * Row Stages
+ * ========================================================================== */
+
+/* U Y0 V Y1 -> Y U V A per pixel; each pixel takes the chroma of its pair. */
+static void unpack_uyvy(const uint8_t* src, uint8_t* dst, int width) {
+    int x = 0;
+#if SCALER_HAVE_NEON
+    const uint8x16_t opaque = vdupq_n_u8(0xFF);
+    for (; x + 32 <= width; x += 32) {
+        const uint8x16x4_t pairs = vld4q_u8(src + (size_t)x * 2);
+        const uint8x16x2_t y = vzipq_u8(pairs.val[1], pairs.val[3]);
+        const uint8x16x2_t u = vzipq_u8(pairs.val[0], pairs.val[0]);
+        const uint8x16x2_t v = vzipq_u8(pairs.val[2], pairs.val[2]);
+        uint8x16x4_t lo = { { y.val[0], u.val[0], v.val[0], opaque } };
+        uint8x16x4_t hi = { { y.val[1], u.val[1], v.val[1], opaque } };
+        vst4q_u8(dst + (size_t)x * 4, lo);
+        vst4q_u8(dst + (size_t)x * 4 + 64, hi);
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t* pair = src + (size_t)(x & ~1) * 2;
+        uint8_t* p = dst + (size_t)x * 4;
+        p[0] = pair[(x & 1) ? 3 : 1];
+        p[1] = pair[0];
+        p[2] = pair[2];
+        p[3] = 0xFF;
+    }
+}
+
+/* Four bytes per pixel to RGBA; red_index is 0 for RGBA order and 2 for BGRA. */
+static void unpack_rgba(const uint8_t* src, uint8_t* dst, int width, int red_index, bool opaque) {
+    if (red_index == 0 && !opaque) {
+        memcpy(dst, src, (size_t)width * 4);
+        return;
+    }
+    const int blue_index = 2 - red_index;
+    int x = 0;
+#if SCALER_HAVE_NEON
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x4_t in = vld4q_u8(src + (size_t)x * 4);
+        uint8x16x4_t out = { { in.val[red_index], in.val[1], in.val[blue_index],
+                               opaque ? vdupq_n_u8(0xFF) : in.val[3] } };
+        vst4q_u8(dst + (size_t)x * 4, out);
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t* s = src + (size_t)x * 4;
+        uint8_t* d = dst + (size_t)x * 4;
+        d[0] = s[red_index];
+        d[1] = s[1];
+        d[2] = s[blue_index];
+        d[3] = opaque ? 0xFF : s[3];
+    }
+}
+
+/* Horizontal pass: 4-channel pixels to dst_size Q8 pixels, h->taps taps each. */
+static void filter_row_h(const AxisFilter* h, const uint8_t* pixels, uint16_t* out) {
+    const int n = h->taps;
+    if (n == 2) {
+        /* Bilinear, and area down to half size or more. */
+        for (int x = 0; x < h->dst_size; x++) {
+            const uint8_t* p = pixels + (size_t)h->start[x] * 4;
+            const uint16_t* w = h->weights + (size_t)x * (size_t)h->stride;
+#if SCALER_HAVE_NEON
+            const uint16x8_t c = vmovl_u8(vld1_u8(p));
+            uint32x4_t acc = vmull_n_u16(vget_low_u16(c), w[0]);
+            acc = vmlal_n_u16(acc, vget_high_u16(c), w[1]);
+            vst1_u16(out + (size_t)x * 4, vrshrn_n_u32(acc, WEIGHT_BITS - 8));
+#else
+            for (int c = 0; c < 4; c++) {
+                const uint32_t acc = (uint32_t)p[c] * w[0] + (uint32_t)p[4 + c] * w[1];
+                out[(size_t)x * 4 + (size_t)c] = (uint16_t)((acc + (1u << (WEIGHT_BITS - 9))) >> (WEIGHT_BITS - 8));
+            }
+#endif
+        }
+        return;
+    }
+
+    for (int x = 0; x < h->dst_size; x++) {
+        const uint8_t* p = pixels + (size_t)h->start[x] * 4;
+        const uint16_t* w = h->weights + (size_t)x * (size_t)h->stride;
+#if SCALER_HAVE_NEON
+        uint32x4_t acc = vdupq_n_u32(0);
+        for (int t = 0; t < n; t++) {
+            uint32_t packed;
+            memcpy(&packed, p + (size_t)t * 4, sizeof(packed));
+            const uint16x4_t c = vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed))));
+            acc = vmlal_n_u16(acc, c, w[t]);
+        }
+        vst1_u16(out + (size_t)x * 4, vrshrn_n_u32(acc, WEIGHT_BITS - 8));
+#else
+        uint32_t acc[4] = { 0, 0, 0, 0 };
+        for (int t = 0; t < n; t++) {
+            for (int c = 0; c < 4; c++) {
+                acc[c] += (uint32_t)p[(size_t)t * 4 + (size_t)c] * w[t];
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            out[(size_t)x * 4 + (size_t)c] = (uint16_t)((acc[c] + (1u << (WEIGHT_BITS - 9))) >> (WEIGHT_BITS - 8));
+        }
+#endif
+    }
+}
+
+/* Vertical pass: n Q8 rows of count values, weighted, to 8-bit values. */
+static void filter_rows_v(const uint16_t* const* rows, const uint16_t* w, int n, int count, uint8_t* out) {
+    const int shift = WEIGHT_BITS + 8;
+    int i = 0;
+#if SCALER_HAVE_NEON
+    for (; i + 8 <= count; i += 8) {
+        uint32x4_t lo = vdupq_n_u32(0);
+        uint32x4_t hi = vdupq_n_u32(0);
+        for (int t = 0; t < n; t++) {
+            const uint16x8_t v = vld1q_u16(rows[t] + i);
+            lo = vmlal_n_u16(lo, vget_low_u16(v), w[t]);
+            hi = vmlal_n_u16(hi, vget_high_u16(v), w[t]);
+        }
+        const uint16x8_t narrowed = vcombine_u16(vmovn_u32(vrshrq_n_u32(lo, WEIGHT_BITS + 8)),
+                                                 vmovn_u32(vrshrq_n_u32(hi, WEIGHT_BITS + 8)));
+        vst1_u8(out + i, vqmovn_u16(narrowed));
+    }
+#endif
+    if (n == 2) {
+        /* Separate loop so the compiler can vectorize it where NEON is not available. */
+        const uint16_t* r0 = rows[0];
+        const uint16_t* r1 = rows[1];
+        for (; i < count; i++) {
+            const uint32_t v = ((uint32_t)r0[i] * w[0] + (uint32_t)r1[i] * w[1] + (1u << (shift - 1))) >> shift;
+            out[i] = (uint8_t)(v > 255u ? 255u : v);
+        }
+        return;
+    }
+    for (; i < count; i++) {
+        uint32_t acc = 0;
+        for (int t = 0; t < n; t++) {
+            acc += (uint32_t)rows[t][i] * w[t];
+        }
+        const uint32_t v = (acc + (1u << (shift - 1))) >> shift;
+        out[i] = (uint8_t)(v > 255u ? 255u : v);
+    }
+}
+
+static inline uint8_t clamp_u8(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static void yuva_to_rgba_row(const uint8_t* src, uint8_t* dst, int width) {
+    int x = 0;
+#if SCALER_HAVE_NEON
+    /* Same arithmetic in 32-bit lanes; vqmovun clamps like clamp_u8. */
+    const int16x8_t y_offset = vdupq_n_s16(16);
+    const int16x8_t uv_offset = vdupq_n_s16(128);
+    const int32x4_t round = vdupq_n_s32(128);
+    for (; x + 8 <= width; x += 8) {
+        const uint8x8x4_t in = vld4_u8(src + (size_t)x * 4);
+        const int16x8_t y = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(in.val[0])), y_offset);
+        const int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(in.val[1])), uv_offset);
+        const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(in.val[2])), uv_offset);
+        const int32x4_t c_lo = vmlaq_n_s32(round, vmovl_s16(vget_low_s16(y)), YUV_Y_SCALE);
+        const int32x4_t c_hi = vmlaq_n_s32(round, vmovl_s16(vget_high_s16(y)), YUV_Y_SCALE);
+
+        const int32x4_t r_lo = vmlal_n_s16(c_lo, vget_low_s16(v), YUV_RV);
+        const int32x4_t r_hi = vmlal_n_s16(c_hi, vget_high_s16(v), YUV_RV);
+        const int32x4_t g_lo = vmlsl_n_s16(vmlsl_n_s16(c_lo, vget_low_s16(u), YUV_GU), vget_low_s16(v), YUV_GV);
+        const int32x4_t g_hi = vmlsl_n_s16(vmlsl_n_s16(c_hi, vget_high_s16(u), YUV_GU), vget_high_s16(v), YUV_GV);
+        const int32x4_t b_lo = vmlal_n_s16(c_lo, vget_low_s16(u), YUV_BU);
+        const int32x4_t b_hi = vmlal_n_s16(c_hi, vget_high_s16(u), YUV_BU);
+
+        uint8x8x4_t out;
+        out.val[0] = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(r_lo, 8)), vqmovn_s32(vshrq_n_s32(r_hi, 8))));
+        out.val[1] = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(g_lo, 8)), vqmovn_s32(vshrq_n_s32(g_hi, 8))));
+        out.val[2] = vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(b_lo, 8)), vqmovn_s32(vshrq_n_s32(b_hi, 8))));
+        out.val[3] = in.val[3];
+        vst4_u8(dst + (size_t)x * 4, out);
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t* s = src + (size_t)x * 4;
+        uint8_t* d = dst + (size_t)x * 4;
+        const int c = (s[0] - 16) * YUV_Y_SCALE;
+        const int u = s[1] - 128;
+        const int v = s[2] - 128;
+        d[0] = clamp_u8((c + YUV_RV * v + 128) >> 8);
+        d[1] = clamp_u8((c - YUV_GU * u - YUV_GV * v + 128) >> 8);
+        d[2] = clamp_u8((c + YUV_BU * u + 128) >> 8);
+        d[3] = s[3];
+    }
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+FrameScaler* frame_scaler_create(void) {
+    return (FrameScaler*)calloc(1, sizeof(FrameScaler));
+}
+
+void frame_scaler_destroy(FrameScaler* fs) {
+    if (fs == NULL) {
+        return;
+    }
+    axis_free(&fs->h);
+    axis_free(&fs->v);
+    free(fs->unpacked);
+    free(fs->rows);
+    free(fs->row_index);
+    free(fs->taps);
+    free(fs->out_row);
+    free(fs);
+}
+
+static bool valid_size(int size) {
+    return size > 0 && size <= FRAME_SCALER_MAX_DIMENSION;
+}
+
+static ScalerFilter resolve_filter(ScalerFilter filter, int src_size, int dst_size) {
+    if (filter == SCALER_FILTER_AUTO) {
+        return (dst_size < src_size) ? SCALER_FILTER_AREA : SCALER_FILTER_BILINEAR;
+    }
+    return filter;
+}
+
+bool frame_scaler_scale(FrameScaler* fs,
+                        const uint8_t* src, int src_stride, int src_width, int src_height, ScalerFormat format,
+                        uint8_t* dst, int dst_stride, int dst_width, int dst_height, ScalerFilter filter) {
+    if (fs == NULL || src == NULL || dst == NULL || !valid_size(src_width) || !valid_size(src_height) ||
+        !valid_size(dst_width) || !valid_size(dst_height) || dst_stride < dst_width * 4) {
+        return false;
+    }
+    if (filter != SCALER_FILTER_AUTO && filter != SCALER_FILTER_AREA && filter != SCALER_FILTER_BILINEAR) {
+        return false;
+    }
+    switch (format) {
+        case SCALER_UYVY:
+            if ((src_width % 2) != 0 || src_stride < src_width * 2) {
+                return false;
+            }
+            break;
+        case SCALER_BGRA:
+        case SCALER_BGRX:
+        case SCALER_RGBA:
+        case SCALER_RGBX:
+            if (src_stride < src_width * 4) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    if (!axis_build(&fs->h, src_width, dst_width, resolve_filter(filter, src_width, dst_width)) ||
+        !axis_build(&fs->v, src_height, dst_height, resolve_filter(filter, src_height, dst_height)) ||
+        !ensure_buffers(fs, src_width, dst_width)) {
+        return false;
+    }
+
+    NDI_TRACE_BEGIN("scale to rgba");
+    const int red_index = (format == SCALER_RGBA || format == SCALER_RGBX) ? 0 : 2;
+    const bool opaque = (format == SCALER_BGRX || format == SCALER_RGBX);
+
+    /* Same size: both filters are the identity, so only unpack (and convert). */
+    if (src_width == dst_width && src_height == dst_height) {
+        for (int y = 0; y < dst_height; y++) {
+            const uint8_t* src_row = src + (size_t)y * (size_t)src_stride;
+            uint8_t* dst_row = dst + (size_t)y * (size_t)dst_stride;
+            if (format == SCALER_UYVY) {
+                unpack_uyvy(src_row, fs->unpacked, src_width);
+                yuva_to_rgba_row(fs->unpacked, dst_row, dst_width);
+            } else {
+                unpack_rgba(src_row, dst_row, src_width, red_index, opaque);
+            }
+        }
+        NDI_TRACE_END();
+        return true;
+    }
+
+    const size_t row_values = (size_t)dst_width * 4;
+    for (int s = 0; s < fs->slots; s++) {
+        fs->row_index[s] = -1;
+    }
+
+    for (int dy = 0; dy < dst_height; dy++) {
+        const int first = fs->v.start[dy];
+        const int n = fs->v.count[dy];
+        for (int t = 0; t < n; t++) {
+            const int row = first + t;
+            const int slot = row % fs->slots;
+            uint16_t* filtered = fs->rows + (size_t)slot * row_values;
+            if (fs->row_index[slot] != row) {
+                const uint8_t* src_row = src + (size_t)row * (size_t)src_stride;
+                if (format == SCALER_UYVY) {
+                    unpack_uyvy(src_row, fs->unpacked, src_width);
+                } else {
+                    unpack_rgba(src_row, fs->unpacked, src_width, red_index, opaque);
+                }
+                filter_row_h(&fs->h, fs->unpacked, filtered);
+                fs->row_index[slot] = row;
+            }
+            fs->taps[t] = filtered;
+        }
+
+        uint8_t* dst_row = dst + (size_t)dy * (size_t)dst_stride;
+        const uint16_t* w = fs->v.weights + (size_t)dy * (size_t)fs->v.stride;
+        if (format == SCALER_UYVY) {
+            filter_rows_v(fs->taps, w, n, (int)row_values, fs->out_row);
+            yuva_to_rgba_row(fs->out_row, dst_row, dst_width);
+        } else {
+            filter_rows_v(fs->taps, w, n, (int)row_values, dst_row);
+        }
+    }
+    NDI_TRACE_END();
+    return true;
+}
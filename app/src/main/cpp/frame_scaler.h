@@ -0,0 +1,54 @@
+/**
+ * frame_scaler.h - Converting and scaling received frames to RGBA in one pass
+ *
+ * Scaling is separable. Each source row is unpacked to four 8-bit channels (RGBA, or YUVA for
+ * UYVY, so chroma is filtered before conversion) and filtered horizontally to 16-bit
+ * intermediates; destination rows then combine the intermediates of the source rows they
+ * cover. The area filter weights every source pixel by how much of it a destination pixel
+ * covers; bilinear interpolates between the two nearest. Filter weights are Q14 fixed point
+ * and each destination pixel's weights sum to exactly one, so flat areas stay flat.
+ *
+ * A frame scaled to its own size is only converted. A scaler keeps its filter tables and row
+ * buffers between calls, so scaling a stream of same-sized frames allocates nothing after the
+ * first.
+ */
+
+#ifndef NDI_FRAME_SCALER_H
+#define NDI_FRAME_SCALER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FRAME_SCALER_MAX_DIMENSION 8192
+
+typedef enum ScalerFormat {
+    SCALER_UYVY = 0,   /* 4:2:2 limited range, BT.709. */
+    SCALER_BGRA = 1,
+    SCALER_BGRX = 2,   /* As BGRA with the fourth byte ignored (output alpha is opaque). */
+    SCALER_RGBA = 3,
+    SCALER_RGBX = 4
+} ScalerFormat;
+
+typedef enum ScalerFilter {
+    SCALER_FILTER_AUTO = 0,       /* Area on an axis that shrinks, bilinear on one that grows. */
+    SCALER_FILTER_AREA = 1,
+    SCALER_FILTER_BILINEAR = 2
+} ScalerFilter;
+
+typedef struct FrameScaler FrameScaler;
+
+FrameScaler* frame_scaler_create(void);
+void frame_scaler_destroy(FrameScaler* fs);
+
+/*
+ * Scale a whole src_width x src_height frame into dst_width x dst_height RGBA pixels (bytes in
+ * R, G, B, A order) at dst, dst_stride bytes per row, so dst may be a region of a larger
+ * buffer. The aspect ratio is not preserved. Returns false, writing nothing, for an unknown
+ * format or filter, sizes outside 1..FRAME_SCALER_MAX_DIMENSION, a stride too small for its
+ * width, an odd UYVY width, or out of memory.
+ */
+bool frame_scaler_scale(FrameScaler* fs,
+                        const uint8_t* src, int src_stride, int src_width, int src_height, ScalerFormat format,
+                        uint8_t* dst, int dst_stride, int dst_width, int dst_height, ScalerFilter filter);
+
+#endif /* NDI_FRAME_SCALER_H */
@@ -0,0 +1,322 @@
+/**
+ * jitter_buffer.c - Timestamp-ordered video jitter buffer with a latency budget
+ *
+ * Playout offset (added to sender timestamps) = window minimum transit + delay, where
+ * delay = min(target, jitter + margin). The offset is slewed by 1/8 of the difference per
+ * frame so a change in measured jitter stretches or compresses playout gradually instead of
+ * stalling or bursting.
+ *
+ * Decoding order is taken to be timestamp order, so every held frame is newer than a lost
+ * one: the held deltas before the first held key are the ones that referenced it.
+ */
+
+#include "jitter_buffer.h"
+#include "ndi_trace.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define OFFSET_SLEW_SHIFT 3
+
+typedef struct JitterEntry {
+    void* item;
+    JitterFrameKind kind;
+    int64_t timestamp_ns;
+    int64_t due_ns;
+} JitterEntry;
+
+struct JitterBuffer {
+    pthread_mutex_t lock;
+
+    JitterEntry entries[JITTER_BUFFER_MAX_CAPACITY];  /* Sorted by timestamp, oldest first. */
+    int capacity;
+    int count;
+
+    int64_t target_ns;
+
+    int64_t transits[JITTER_BUFFER_WINDOW];
+    int window_count;
+    int window_next;
+
+    bool has_offset;
+    int64_t offset_ns;
+
+    bool has_released;
+    int64_t last_released_ns;
+
+    bool awaiting_key;   /* A compressed frame was lost and no random access point followed. */
+
+    JitterBufferStats stats;
+};
+
+/* ============================================================================
+ * Internal helpers (caller holds the lock)
+ * ========================================================================== */
+
+static void window_bounds(const JitterBuffer* jb, int64_t* min_out, int64_t* max_out) {
+    int64_t lo = jb->transits[0];
+    int64_t hi = jb->transits[0];
+    for (int i = 1; i < jb->window_count; i++) {
+        const int64_t t = jb->transits[i];
+        if (t < lo) lo = t;
+        if (t > hi) hi = t;
+    }
+    *min_out = lo;
+    *max_out = hi;
+}
+
+static void window_add(JitterBuffer* jb, int64_t transit) {
+    jb->transits[jb->window_next] = transit;
+    jb->window_next = (jb->window_next + 1) % JITTER_BUFFER_WINDOW;
+    if (jb->window_count < JITTER_BUFFER_WINDOW) {
+        jb->window_count++;
+    }
+}
+
+static void* remove_at(JitterBuffer* jb, int index) {
+    void* item = jb->entries[index].item;
+    for (int i = index; i < jb->count - 1; i++) {
+        jb->entries[i] = jb->entries[i + 1];
+    }
+    jb->count--;
+    return item;
+}
+
+static void count_drop(JitterBuffer* jb) {
+    jb->stats.dropped++;
+    NDI_TRACE_INSTANT("jitter drop");
+}
+
+/* A frame of this kind was lost: discard the held frames that referenced it. */
+static void lose(JitterBuffer* jb, JitterFrameKind kind, void** discarded, int* n) {
+    if (kind == JITTER_FRAME_INDEPENDENT) {
+        return;
+    }
+    while (jb->count > 0 && jb->entries[0].kind == JITTER_FRAME_DELTA) {
+        discarded[(*n)++] = remove_at(jb, 0);
+        count_drop(jb);
+    }
+    jb->awaiting_key = (jb->count == 0);
+}
+
+/* Whether a new frame of this kind lost its reference; a key or uncompressed frame starts over. */
+static bool orphaned(JitterBuffer* jb, JitterFrameKind kind) {
+    if (kind != JITTER_FRAME_DELTA) {
+        jb->awaiting_key = false;
+    }
+    return kind == JITTER_FRAME_DELTA && jb->awaiting_key;
+}
+
+/* Index at which a frame with this timestamp goes; arrivals are nearly always in order. */
+static int insert_position(const JitterBuffer* jb, int64_t timestamp_ns) {
+    int pos = jb->count;
+    while (pos > 0 && jb->entries[pos - 1].timestamp_ns > timestamp_ns) {
+        pos--;
+    }
+    return pos;
+}
+
+/* Measure this arrival and return the playout offset to apply to it. */
+static int64_t update_offset(JitterBuffer* jb, int64_t transit) {
+    if (jb->window_count > 0) {
+        int64_t lo;
+        int64_t hi;
+        window_bounds(jb, &lo, &hi);
+        if (transit < lo - JITTER_BUFFER_RESYNC_NS || transit > hi + JITTER_BUFFER_RESYNC_NS) {
+            jb->window_count = 0;
+            jb->window_next = 0;
+            jb->has_offset = false;
+            jb->has_released = false;  /* Older timestamps are a new timeline, not stragglers. */
+            jb->stats.resyncs++;
+        } else if (transit < lo - JITTER_BUFFER_TOLERANCE_NS) {
+            jb->stats.early++;
+        }
+    }
+    window_add(jb, transit);
+
+    int64_t lo;
+    int64_t hi;
+    window_bounds(jb, &lo, &hi);
+    jb->stats.jitter_ns = hi - lo;
+
+    int64_t delay = jb->stats.jitter_ns + JITTER_BUFFER_MARGIN_NS;
+    if (delay > jb->target_ns) {
+        delay = jb->target_ns;
+    }
+    jb->stats.delay_ns = delay;
+
+    const int64_t desired = lo + delay;
+    if (!jb->has_offset) {
+        jb->offset_ns = desired;
+        jb->has_offset = true;
+    } else {
+        jb->offset_ns += (desired - jb->offset_ns) / (1 << OFFSET_SLEW_SHIFT);
+    }
+    return jb->offset_ns;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+JitterBuffer* jitter_buffer_create(int capacity) {
+    JitterBuffer* jb = (JitterBuffer*)calloc(1, sizeof(JitterBuffer));
+    if (jb == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&jb->lock, NULL) != 0) {
+        free(jb);
+        return NULL;
+    }
+    if (capacity < 1) {
+        capacity = 1;
+    } else if (capacity > JITTER_BUFFER_MAX_CAPACITY) {
+        capacity = JITTER_BUFFER_MAX_CAPACITY;
+    }
+    jb->capacity = capacity;
+    return jb;
+}
+
+void jitter_buffer_destroy(JitterBuffer* jb) {
+    if (jb == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&jb->lock);
+    free(jb);
+}
+
+void jitter_buffer_set_target(JitterBuffer* jb, int64_t target_ns) {
+    if (target_ns < 0) {
+        target_ns = 0;
+    } else if (target_ns > JITTER_BUFFER_MAX_TARGET_NS) {
+        target_ns = JITTER_BUFFER_MAX_TARGET_NS;
+    }
+    pthread_mutex_lock(&jb->lock);
+    jb->target_ns = target_ns;
+    jb->stats.target_ns = target_ns;
+    pthread_mutex_unlock(&jb->lock);
+}
+
+int64_t jitter_buffer_get_target(JitterBuffer* jb) {
+    pthread_mutex_lock(&jb->lock);
+    const int64_t target = jb->target_ns;
+    pthread_mutex_unlock(&jb->lock);
+    return target;
+}
+
+int jitter_buffer_push(JitterBuffer* jb, void* item, JitterFrameKind kind, int64_t timestamp_100ns,
+                       int64_t now_ns, void** discarded) {
+    int n = 0;
+    pthread_mutex_lock(&jb->lock);
+    jb->stats.pushed++;
+
+    /* Without sender timestamps, frames play out in arrival order with zero transit. */
+    const int64_t timestamp_ns = timestamp_100ns == JITTER_BUFFER_TIMESTAMP_UNDEFINED ? now_ns : timestamp_100ns * 100;
+    const int64_t offset = update_offset(jb, now_ns - timestamp_ns);
+
+    if (orphaned(jb, kind)) {
+        count_drop(jb);
+        discarded[n++] = item;
+        pthread_mutex_unlock(&jb->lock);
+        return n;
+    }
+
+    if (jb->has_released && timestamp_ns <= jb->last_released_ns) {
+        /* A newer frame was already handed out. */
+        count_drop(jb);
+        discarded[n++] = item;
+        lose(jb, kind, discarded, &n);
+        pthread_mutex_unlock(&jb->lock);
+        return n;
+    }
+
+    int pos = insert_position(jb, timestamp_ns);
+    if (pos > 0 && jb->entries[pos - 1].timestamp_ns == timestamp_ns) {
+        /* The frame itself is held, so nothing that references it is lost. */
+        count_drop(jb);
+        discarded[n++] = item;
+        pthread_mutex_unlock(&jb->lock);
+        return n;
+    }
+
+    if (jb->count == jb->capacity) {
+        if (pos == 0) {
+            /* Older than everything held: it would be evicted straight away. */
+            count_drop(jb);
+            discarded[n++] = item;
+            lose(jb, kind, discarded, &n);
+            pthread_mutex_unlock(&jb->lock);
+            return n;
+        }
+        const JitterFrameKind evicted_kind = jb->entries[0].kind;
+        discarded[n++] = remove_at(jb, 0);
+        count_drop(jb);
+        lose(jb, evicted_kind, discarded, &n);
+        if (orphaned(jb, kind)) {
+            count_drop(jb);
+            discarded[n++] = item;
+            pthread_mutex_unlock(&jb->lock);
+            return n;
+        }
+        pos = insert_position(jb, timestamp_ns);
+    }
+
+    int64_t due = timestamp_ns + offset;
+    if (due > now_ns + jb->target_ns) {
+        due = now_ns + jb->target_ns;
+    }
+    if (due < now_ns - JITTER_BUFFER_TOLERANCE_NS) {
+        jb->stats.late++;
+    }
+
+    for (int i = jb->count; i > pos; i--) {
+        jb->entries[i] = jb->entries[i - 1];
+    }
+    jb->entries[pos].item = item;
+    jb->entries[pos].kind = kind;
+    jb->entries[pos].timestamp_ns = timestamp_ns;
+    jb->entries[pos].due_ns = due;
+    jb->count++;
+    NDI_TRACE_INSTANT("jitter push");
+    NDI_TRACE_COUNTER("jitter depth", jb->count);
+
+    pthread_mutex_unlock(&jb->lock);
+    return n;
+}
+
+void* jitter_buffer_pop(JitterBuffer* jb, int64_t now_ns) {
+    pthread_mutex_lock(&jb->lock);
+    void* item = NULL;
+    if (jb->count > 0 && jb->entries[0].due_ns <= now_ns) {
+        jb->last_released_ns = jb->entries[0].timestamp_ns;
+        jb->has_released = true;
+        item = remove_at(jb, 0);
+        jb->stats.released++;
+        NDI_TRACE_INSTANT("jitter pop");
+        NDI_TRACE_COUNTER("jitter depth", jb->count);
+    }
+    pthread_mutex_unlock(&jb->lock);
+    return item;
+}
+
+void* jitter_buffer_drain(JitterBuffer* jb) {
+    pthread_mutex_lock(&jb->lock);
+    void* item = jb->count > 0 ? remove_at(jb, 0) : NULL;
+    pthread_mutex_unlock(&jb->lock);
+    return item;
+}
+
+int64_t jitter_buffer_next_due_ns(JitterBuffer* jb) {
+    pthread_mutex_lock(&jb->lock);
+    const int64_t due = jb->count > 0 ? jb->entries[0].due_ns : INT64_MAX;
+    pthread_mutex_unlock(&jb->lock);
+    return due;
+}
+
+void jitter_buffer_get_stats(JitterBuffer* jb, JitterBufferStats* stats) {
+    pthread_mutex_lock(&jb->lock);
+    *stats = jb->stats;
+    stats->depth = jb->count;
+    pthread_mutex_unlock(&jb->lock);
+}
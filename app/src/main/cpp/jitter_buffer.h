@@ -0,0 +1,87 @@
+/**
+ * jitter_buffer.h - Timestamp-ordered video jitter buffer with a latency budget
+ *
+ * Items are opaque pointers and all times are passed in (CLOCK_MONOTONIC nanoseconds on
+ * device), so it can be driven by a fake clock.
+ *
+ * Each frame's transit (arrival minus sender timestamp) is tracked over a sliding window. The
+ * fastest transit in the window is the network floor and the spread above it is the arrival
+ * jitter. A frame plays out at timestamp + floor + delay, where delay covers the measured jitter
+ * but never exceeds the caller's target latency; no frame waits longer than the target after
+ * it arrived. Frames are released in timestamp order.
+ *
+ * Compressed frames depend on the ones before them back to a random access point. When one is
+ * lost (stale, or evicted from a full buffer), the frames that referenced it are discarded too,
+ * held or still to come, until the next random access point, so the decoder is never fed a
+ * broken reference chain.
+ */
+
+#ifndef NDI_JITTER_BUFFER_H
+#define NDI_JITTER_BUFFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* NDIlib_recv_timestamp_undefined: the sender did not provide a timestamp. */
+#define JITTER_BUFFER_TIMESTAMP_UNDEFINED INT64_MAX
+
+#define JITTER_BUFFER_MAX_CAPACITY 32
+#define JITTER_BUFFER_MAX_TARGET_NS 500000000LL   /* 500 ms */
+#define JITTER_BUFFER_WINDOW 128                  /* Frames of transit history. */
+#define JITTER_BUFFER_MARGIN_NS 2000000LL         /* Headroom added to the measured jitter. */
+#define JITTER_BUFFER_TOLERANCE_NS 1000000LL      /* Late/early threshold. */
+#define JITTER_BUFFER_RESYNC_NS 1000000000LL      /* Transit step treated as a new timeline. */
+#define JITTER_BUFFER_MAX_DISCARDS (JITTER_BUFFER_MAX_CAPACITY + 1)
+
+typedef enum JitterFrameKind {
+    JITTER_FRAME_INDEPENDENT,   /* Uncompressed: stands alone. */
+    JITTER_FRAME_KEY,           /* Compressed random access point. */
+    JITTER_FRAME_DELTA          /* Compressed frame referencing earlier ones. */
+} JitterFrameKind;
+
+typedef struct JitterBufferStats {
+    uint64_t pushed;
+    uint64_t released;
+    uint64_t late;      /* Arrived after their playout time (the jitter exceeded the delay). */
+    uint64_t early;     /* Arrived faster than any frame in the window (the network floor dropped). */
+    uint64_t dropped;   /* Stale, duplicates, evicted when full, or compressed with a lost reference. */
+    uint64_t resyncs;   /* Transit history reset after a sender timestamp jump. */
+    int depth;          /* Frames currently held. */
+    int64_t target_ns;  /* Latency budget set by the caller. */
+    int64_t delay_ns;   /* Buffering currently applied on top of the network floor (<= target). */
+    int64_t jitter_ns;  /* Peak-to-peak transit spread over the window. */
+} JitterBufferStats;
+
+typedef struct JitterBuffer JitterBuffer;
+
+/* capacity is clamped to 1..JITTER_BUFFER_MAX_CAPACITY frames. */
+JitterBuffer* jitter_buffer_create(int capacity);
+
+/* Frames still held are not released; drain them first. */
+void jitter_buffer_destroy(JitterBuffer* jb);
+
+/* Latency budget, clamped to 0..JITTER_BUFFER_MAX_TARGET_NS. 0 releases frames as they arrive. */
+void jitter_buffer_set_target(JitterBuffer* jb, int64_t target_ns);
+int64_t jitter_buffer_get_target(JitterBuffer* jb);
+
+/*
+ * Add a frame. Items the caller must discard (this one if it is stale, a duplicate or lost its
+ * reference, the oldest held frame if the buffer was full, and held frames that referenced a
+ * lost one) are stored in discarded, which has room for JITTER_BUFFER_MAX_DISCARDS. Returns
+ * their number.
+ */
+int jitter_buffer_push(JitterBuffer* jb, void* item, JitterFrameKind kind, int64_t timestamp_100ns,
+                       int64_t now_ns, void** discarded);
+
+/* Remove and return the oldest frame if its playout time has come, else NULL. */
+void* jitter_buffer_pop(JitterBuffer* jb, int64_t now_ns);
+
+/* Remove and return the oldest frame regardless of its playout time (for teardown). */
+void* jitter_buffer_drain(JitterBuffer* jb);
+
+/* Playout time of the oldest frame, or INT64_MAX when empty. */
+int64_t jitter_buffer_next_due_ns(JitterBuffer* jb);
+
+void jitter_buffer_get_stats(JitterBuffer* jb, JitterBufferStats* stats);
+
+#endif /* NDI_JITTER_BUFFER_H */
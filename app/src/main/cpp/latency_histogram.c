@@ -0,0 +1,152 @@
+/**
+ * latency_histogram.c - Glass-to-glass latency per pipeline stage in HDR histograms
+ *
+ * Values are stored in microseconds. Bucket b below 2 * SUB_BUCKETS holds exactly b; above
+ * that, a value whose highest set bit is m goes to shift = m - SUB_BITS, and its top
+ * SUB_BITS + 1 bits (SUB_BUCKETS to 2 * SUB_BUCKETS - 1) pick the bucket within the shift.
+ */
+
+#include "latency_histogram.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct LatencyTracker {
+    pthread_mutex_t lock;
+    LatencyHistogram stages[LATENCY_STAGE_COUNT];
+    bool started;
+    int64_t start_ns;
+};
+
+/* ============================================================================
+ * Histogram
+ * ========================================================================== */
+
+static int highest_bit(uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+static int bucket_of(int64_t value_us) {
+    if (value_us < 2 * LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return (int)value_us;
+    }
+    const int shift = highest_bit((uint64_t)value_us) - LATENCY_HISTOGRAM_SUB_BITS;
+    return (shift * LATENCY_HISTOGRAM_SUB_BUCKETS) + (int)(value_us >> shift);
+}
+
+/* Highest value that lands in bucket. */
+static int64_t bucket_upper_us(int bucket) {
+    if (bucket < 2 * LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    const int shift = (bucket / LATENCY_HISTOGRAM_SUB_BUCKETS) - 1;
+    const int64_t top = bucket - ((int64_t)shift * LATENCY_HISTOGRAM_SUB_BUCKETS);
+    return ((top + 1) << shift) - 1;
+}
+
+void latency_histogram_reset(LatencyHistogram* h) {
+    memset(h, 0, sizeof(*h));
+}
+
+void latency_histogram_record(LatencyHistogram* h, int64_t value_ns) {
+    int64_t value_us = value_ns > 0 ? value_ns / 1000 : 0;
+    if (value_us > LATENCY_HISTOGRAM_MAX_US) {
+        value_us = LATENCY_HISTOGRAM_MAX_US;
+    }
+    h->counts[bucket_of(value_us)]++;
+    h->total++;
+    if (value_us > h->max_us) {
+        h->max_us = value_us;
+    }
+}
+
+int64_t latency_histogram_percentile(const LatencyHistogram* h, double percentile) {
+    if (h->total == 0) {
+        return 0;
+    }
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    /* Rank of the value, 1-based: the smallest count covering percentile of the values. */
+    uint64_t rank = (uint64_t)((percentile / 100.0) * (double)h->total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > h->total) {
+        rank = h->total;
+    }
+
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_HISTOGRAM_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) {
+            const int64_t upper = bucket_upper_us(b);
+            return (upper < h->max_us ? upper : h->max_us) * 1000;
+        }
+    }
+    return h->max_us * 1000;
+}
+
+/* ============================================================================
+ * Tracker
+ * ========================================================================== */
+
+LatencyTracker* latency_tracker_create(void) {
+    LatencyTracker* lt = (LatencyTracker*)calloc(1, sizeof(LatencyTracker));
+    if (lt == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&lt->lock, NULL);
+    return lt;
+}
+
+void latency_tracker_destroy(LatencyTracker* lt) {
+    if (lt == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&lt->lock);
+    free(lt);
+}
+
+void latency_tracker_reset(LatencyTracker* lt) {
+    pthread_mutex_lock(&lt->lock);
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        latency_histogram_reset(&lt->stages[i]);
+    }
+    lt->started = false;
+    lt->start_ns = 0;
+    pthread_mutex_unlock(&lt->lock);
+}
+
+void latency_tracker_record(LatencyTracker* lt, LatencyStage stage, int64_t capture_ns, int64_t now_ns) {
+    if ((int)stage < 0 || stage >= LATENCY_STAGE_COUNT || capture_ns <= 0) {
+        return;
+    }
+    pthread_mutex_lock(&lt->lock);
+    if (!lt->started) {
+        lt->started = true;
+        lt->start_ns = now_ns;
+    }
+    latency_histogram_record(&lt->stages[stage], now_ns - capture_ns);
+    pthread_mutex_unlock(&lt->lock);
+}
+
+void latency_tracker_get_stats(LatencyTracker* lt, int64_t now_ns, LatencyStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    pthread_mutex_lock(&lt->lock);
+    stats->elapsed_ns = lt->started ? now_ns - lt->start_ns : 0;
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        const LatencyHistogram* h = &lt->stages[i];
+        LatencyStageStats* out = &stats->stages[i];
+        out->count = h->total;
+        out->p50_ns = latency_histogram_percentile(h, 50.0);
+        out->p95_ns = latency_histogram_percentile(h, 95.0);
+        out->p99_ns = latency_histogram_percentile(h, 99.0);
+        out->max_ns = h->max_us * 1000;
+    }
+    pthread_mutex_unlock(&lt->lock);
+}
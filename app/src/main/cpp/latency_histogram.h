@@ -0,0 +1,79 @@
+/**
+ * latency_histogram.h - Glass-to-glass latency per pipeline stage in HDR histograms
+ *
+ * Every video frame is stamped with CLOCK_MONOTONIC when NDIlib_recv_capture_v2 returns it.
+ * As the frame passes each later stage (consumer dequeue, convert or decode submit, decoder
+ * output, present) the time since that stamp is recorded in the stage's histogram.
+ *
+ * The histograms are log-linear in the style of HdrHistogram: values below
+ * 2 * LATENCY_HISTOGRAM_SUB_BUCKETS microseconds are counted exactly, and every power of two
+ * above that is split into LATENCY_HISTOGRAM_SUB_BUCKETS linear buckets, so any percentile is
+ * within 1 / LATENCY_HISTOGRAM_SUB_BUCKETS (about 3%) of the true value, up to
+ * LATENCY_HISTOGRAM_MAX_US, in a fixed few kilobytes and with O(1) recording.
+ */
+
+#ifndef NDI_LATENCY_HISTOGRAM_H
+#define NDI_LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+#define LATENCY_HISTOGRAM_SUB_BITS 5
+#define LATENCY_HISTOGRAM_SUB_BUCKETS (1 << LATENCY_HISTOGRAM_SUB_BITS)
+#define LATENCY_HISTOGRAM_MAX_BITS 25   /* Values up to 2^25 us (33 s); longer ones are clamped. */
+#define LATENCY_HISTOGRAM_MAX_US ((1LL << LATENCY_HISTOGRAM_MAX_BITS) - 1)
+#define LATENCY_HISTOGRAM_BUCKETS \
+    ((LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BITS + 1) * LATENCY_HISTOGRAM_SUB_BUCKETS)
+
+/* Values match NdiNative.LatencyStage on the Kotlin side. Each is measured from capture. */
+typedef enum LatencyStage {
+    LATENCY_STAGE_DEQUEUE = 0,    /* The consumer took the frame (decoder input thread or renderer). */
+    LATENCY_STAGE_SUBMIT = 1,     /* Queued to MediaCodec, or converted and handed to the pacer. */
+    LATENCY_STAGE_DECODED = 2,    /* MediaCodec returned the decoded frame (compressed video only). */
+    LATENCY_STAGE_PRESENT = 3,    /* Posted to the surface. */
+    LATENCY_STAGE_COUNT = 4,
+} LatencyStage;
+
+typedef struct LatencyHistogram {
+    uint64_t counts[LATENCY_HISTOGRAM_BUCKETS];
+    uint64_t total;
+    int64_t max_us;
+} LatencyHistogram;
+
+typedef struct LatencyStageStats {
+    uint64_t count;
+    int64_t p50_ns;
+    int64_t p95_ns;
+    int64_t p99_ns;
+    int64_t max_ns;
+} LatencyStageStats;
+
+typedef struct LatencyStats {
+    int64_t elapsed_ns;   /* Time since the first recording after a reset (0 if none). */
+    LatencyStageStats stages[LATENCY_STAGE_COUNT];
+} LatencyStats;
+
+void latency_histogram_reset(LatencyHistogram* h);
+
+/* Count one value. Negative values count as 0. */
+void latency_histogram_record(LatencyHistogram* h, int64_t value_ns);
+
+/*
+ * The value at percentile (0 to 100): the highest value in the bucket holding it, capped at
+ * the largest value recorded. 0 for an empty histogram.
+ */
+int64_t latency_histogram_percentile(const LatencyHistogram* h, double percentile);
+
+typedef struct LatencyTracker LatencyTracker;
+
+LatencyTracker* latency_tracker_create(void);
+void latency_tracker_destroy(LatencyTracker* lt);
+
+/* Forget every stage's recordings, e.g. when the receiver connects to another source. */
+void latency_tracker_reset(LatencyTracker* lt);
+
+/* Record that a frame captured at capture_ns reached stage at now_ns (both monotonic). */
+void latency_tracker_record(LatencyTracker* lt, LatencyStage stage, int64_t capture_ns, int64_t now_ns);
+
+void latency_tracker_get_stats(LatencyTracker* lt, int64_t now_ns, LatencyStats* stats);
+
+#endif /* NDI_LATENCY_HISTOGRAM_H */
@@ -0,0 +1,70 @@
+/**
+ * latest_frame.c - Frame selection for the low-latency (latest-frame-wins) capture mode
+ */
+
+#include "latest_frame.h"
+
+/* H.264 nal_unit_type (ITU-T H.264 Table 7-1). */
+#define H264_NAL_SLICE_FIRST 1
+#define H264_NAL_SLICE_LAST 5
+#define H264_NAL_IDR 5
+
+/* HEVC nal_unit_type (ITU-T H.265 Table 7-1): 0..31 are slices, 16..21 are IRAP. */
+#define HEVC_NAL_VCL_LAST 31
+#define HEVC_NAL_IRAP_FIRST 16
+#define HEVC_NAL_IRAP_LAST 21
+
+/* Offset of the first NAL header byte after a 00 00 01 start code at or after pos, or size. */
+static size_t next_nal(const uint8_t* data, size_t size, size_t pos) {
+    while (pos + 3 <= size) {
+        if (data[pos + 2] > 1) {
+            pos += 3;
+        } else if (data[pos] == 0 && data[pos + 1] == 0 && data[pos + 2] == 1) {
+            return pos + 3;
+        } else {
+            pos++;
+        }
+    }
+    return size;
+}
+
+bool latest_frame_is_random_access(const uint8_t* data, size_t size, bool is_hevc) {
+    if (data == NULL) {
+        return false;
+    }
+    for (size_t pos = next_nal(data, size, 0); pos < size; pos = next_nal(data, size, pos)) {
+        if (is_hevc) {
+            const int type = (data[pos] >> 1) & 0x3F;
+            if (type <= HEVC_NAL_VCL_LAST) {
+                return type >= HEVC_NAL_IRAP_FIRST && type <= HEVC_NAL_IRAP_LAST;
+            }
+        } else {
+            const int type = data[pos] & 0x1F;
+            if (type >= H264_NAL_SLICE_FIRST && type <= H264_NAL_SLICE_LAST) {
+                return type == H264_NAL_IDR;
+            }
+        }
+    }
+    return false;
+}
+
+LatestFramePlan latest_frame_plan(const bool* is_random_access, int count, bool compressed) {
+    LatestFramePlan plan = { .first_kept = 0, .flush_held = false };
+    if (count <= 0) {
+        return plan;
+    }
+    if (!compressed) {
+        plan.first_kept = count - 1;
+        plan.flush_held = true;
+        return plan;
+    }
+    /* Without a random access point every frame is a reference for the next: keep them all. */
+    for (int i = count - 1; i >= 0; i--) {
+        if (is_random_access[i]) {
+            plan.first_kept = i;
+            plan.flush_held = true;
+            break;
+        }
+    }
+    return plan;
+}
@@ -0,0 +1,37 @@
+/**
+ * latest_frame.h - Frame selection for the low-latency (latest-frame-wins) capture mode
+ *
+ * When the receiver falls behind, the frames queued in the SDK are drained in one go and only
+ * the newest usable ones are kept: the newest frame for uncompressed video, and everything from
+ * the newest random access point for compressed video, since later frames reference it.
+ */
+
+#ifndef NDI_LATEST_FRAME_H
+#define NDI_LATEST_FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Most frames drained from the SDK queue in one capture. */
+#define LATEST_FRAME_MAX_RUN 16
+
+typedef struct LatestFramePlan {
+    int first_kept;   /* Frames before this index in the run are skipped. */
+    bool flush_held;  /* Frames captured earlier and still held are stale too. */
+} LatestFramePlan;
+
+/*
+ * True if an Annex B H.264/HEVC access unit starts with a random access point
+ * (H.264 IDR; HEVC IDR, CRA or BLA). Only parameter sets and SEI before the first
+ * slice are scanned, so the cost does not grow with the frame size.
+ */
+bool latest_frame_is_random_access(const uint8_t* data, size_t size, bool is_hevc);
+
+/*
+ * Decide which frames of a drained run (oldest first, count >= 1) to keep.
+ * is_random_access is only read for compressed runs.
+ */
+LatestFramePlan latest_frame_plan(const bool* is_random_access, int count, bool compressed);
+
+#endif /* NDI_LATEST_FRAME_H */
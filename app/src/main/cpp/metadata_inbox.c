@@ -0,0 +1,259 @@
+/**
+ * metadata_inbox.c - Subscribed-element extraction and queueing for NDI metadata frames
+ *
+ * Events are built in a scratch slot and copied into the ring under the lock, so a consumer
+ * popping concurrently never sees a half-built event.
+ */
+
+#include "metadata_inbox.h"
+
+#include "xml_tokenizer.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct MetadataInbox {
+    pthread_mutex_t lock;
+
+    char subscriptions[METADATA_MAX_SUBSCRIPTIONS][METADATA_NAME_MAX];
+    bool prefix[METADATA_MAX_SUBSCRIPTIONS];
+    int subscription_count;
+
+    MetadataEvent events[METADATA_INBOX_CAPACITY];
+    int head;   /* Oldest queued event. */
+    int count;
+
+    MetadataEvent scratch;   /* Only touched by the feeding thread. */
+
+    MetadataInboxStats stats;
+};
+
+/* ============================================================================
+ * Internal helpers
+ * ========================================================================== */
+
+/* Caller holds the lock. */
+static bool matches(const MetadataInbox* inbox, XmlSlice name) {
+    for (int i = 0; i < inbox->subscription_count; i++) {
+        const char* sub = inbox->subscriptions[i];
+        const size_t n = strlen(sub);
+        if (inbox->prefix[i] ? name.len >= n && memcmp(name.data, sub, n) == 0
+                             : name.len == n && memcmp(name.data, sub, n) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Copy a name verbatim (names have no entities). Returns false if it was cut. */
+static bool copy_name(XmlSlice name, char* out, size_t cap) {
+    const size_t n = name.len < cap - 1 ? name.len : cap - 1;
+    memcpy(out, name.data, n);
+    out[n] = '\0';
+    return n == name.len;
+}
+
+/* Append character data to the scratch event's text. */
+static void append_text(MetadataEvent* ev, const XmlToken* token) {
+    const size_t used = strlen(ev->text);
+    char* out = ev->text + used;
+    const size_t cap = METADATA_TEXT_MAX - used;
+    bool cut = false;
+    if (token->raw) {
+        const size_t n = token->value.len < cap - 1 ? token->value.len : cap - 1;
+        memcpy(out, token->value.data, n);
+        out[n] = '\0';
+        cut = n < token->value.len;
+    } else {
+        xml_unescape(token->value.data, token->value.len, out, cap, &cut);
+    }
+    ev->truncated |= cut;
+}
+
+static void trim_text(char* text) {
+    size_t len = strlen(text);
+    while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t' ||
+                       text[len - 1] == '\n' || text[len - 1] == '\r')) {
+        text[--len] = '\0';
+    }
+    size_t start = 0;
+    while (text[start] == ' ' || text[start] == '\t' || text[start] == '\n' || text[start] == '\r') {
+        start++;
+    }
+    if (start > 0) {
+        memmove(text, text + start, len - start + 1);
+    }
+}
+
+static void enqueue(MetadataInbox* inbox, const MetadataEvent* ev) {
+    pthread_mutex_lock(&inbox->lock);
+    if (inbox->count == METADATA_INBOX_CAPACITY) {
+        inbox->head = (inbox->head + 1) % METADATA_INBOX_CAPACITY;
+        inbox->count--;
+        inbox->stats.dropped++;
+    }
+    inbox->events[(inbox->head + inbox->count) % METADATA_INBOX_CAPACITY] = *ev;
+    inbox->count++;
+    inbox->stats.events++;
+    pthread_mutex_unlock(&inbox->lock);
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+MetadataInbox* metadata_inbox_create(void) {
+    MetadataInbox* inbox = (MetadataInbox*)calloc(1, sizeof(MetadataInbox));
+    if (inbox == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&inbox->lock, NULL) != 0) {
+        free(inbox);
+        return NULL;
+    }
+    return inbox;
+}
+
+void metadata_inbox_destroy(MetadataInbox* inbox) {
+    if (inbox == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&inbox->lock);
+    free(inbox);
+}
+
+bool metadata_inbox_subscribe(MetadataInbox* inbox, const char* const* names, int count) {
+    if (inbox == NULL || count < 0 || count > METADATA_MAX_SUBSCRIPTIONS ||
+        (count > 0 && names == NULL)) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        const size_t len = names[i] != NULL ? strlen(names[i]) : 0;
+        if (len == 0 || len >= METADATA_NAME_MAX || (len == 1 && names[i][0] == '*')) {
+            return false;
+        }
+    }
+
+    pthread_mutex_lock(&inbox->lock);
+    for (int i = 0; i < count; i++) {
+        size_t len = strlen(names[i]);
+        inbox->prefix[i] = names[i][len - 1] == '*';
+        if (inbox->prefix[i]) {
+            len--;
+        }
+        memcpy(inbox->subscriptions[i], names[i], len);
+        inbox->subscriptions[i][len] = '\0';
+    }
+    inbox->subscription_count = count;
+    pthread_mutex_unlock(&inbox->lock);
+    return true;
+}
+
+int metadata_inbox_feed(MetadataInbox* inbox, const char* xml, size_t len, int64_t timecode) {
+    if (inbox == NULL || xml == NULL) {
+        return 0;
+    }
+
+    MetadataEvent* ev = &inbox->scratch;
+    XmlTokenizer tokenizer;
+    XmlToken token;
+    int capture_depth = 0;   /* Tokenizer depth of the element being captured; 0 if none. */
+    bool in_start_tag = false;
+    int queued = 0;
+
+    xml_tokenizer_init(&tokenizer, xml, len);
+    while (xml_tokenizer_next(&tokenizer, &token)) {
+        switch (token.type) {
+            case XML_TOKEN_ELEMENT_START: {
+                in_start_tag = false;
+                if (capture_depth != 0) {
+                    break;
+                }
+                pthread_mutex_lock(&inbox->lock);
+                const bool wanted = matches(inbox, token.name);
+                pthread_mutex_unlock(&inbox->lock);
+                if (!wanted) {
+                    break;
+                }
+                memset(ev, 0, sizeof(*ev));
+                ev->timecode = timecode;
+                ev->truncated = !copy_name(token.name, ev->element, METADATA_NAME_MAX);
+                capture_depth = tokenizer.depth;
+                in_start_tag = true;
+                break;
+            }
+
+            case XML_TOKEN_ATTRIBUTE:
+                if (!in_start_tag) {
+                    break;
+                }
+                if (ev->attribute_count == METADATA_MAX_ATTRIBUTES) {
+                    ev->truncated = true;
+                    break;
+                }
+                {
+                    const int i = ev->attribute_count++;
+                    bool cut = false;
+                    ev->truncated |= !copy_name(token.name, ev->attribute_names[i], METADATA_NAME_MAX);
+                    xml_unescape(token.value.data, token.value.len,
+                                 ev->attribute_values[i], METADATA_VALUE_MAX, &cut);
+                    ev->truncated |= cut;
+                }
+                break;
+
+            case XML_TOKEN_TEXT:
+                in_start_tag = false;
+                if (capture_depth != 0 && tokenizer.depth == capture_depth) {
+                    append_text(ev, &token);
+                }
+                break;
+
+            case XML_TOKEN_ELEMENT_END:
+                in_start_tag = false;
+                if (capture_depth != 0 && tokenizer.depth < capture_depth) {
+                    trim_text(ev->text);
+                    enqueue(inbox, ev);
+                    queued++;
+                    capture_depth = 0;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    pthread_mutex_lock(&inbox->lock);
+    inbox->stats.frames++;
+    if (token.type == XML_TOKEN_ERROR) {
+        inbox->stats.malformed++;
+    }
+    pthread_mutex_unlock(&inbox->lock);
+    return queued;
+}
+
+bool metadata_inbox_pop(MetadataInbox* inbox, MetadataEvent* out) {
+    if (inbox == NULL || out == NULL) {
+        return false;
+    }
+    pthread_mutex_lock(&inbox->lock);
+    const bool have = inbox->count > 0;
+    if (have) {
+        *out = inbox->events[inbox->head];
+        inbox->head = (inbox->head + 1) % METADATA_INBOX_CAPACITY;
+        inbox->count--;
+    }
+    pthread_mutex_unlock(&inbox->lock);
+    return have;
+}
+
+void metadata_inbox_get_stats(MetadataInbox* inbox, MetadataInboxStats* stats) {
+    if (inbox == NULL || stats == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&inbox->lock);
+    *stats = inbox->stats;
+    stats->queued = inbox->count;
+    pthread_mutex_unlock(&inbox->lock);
+}
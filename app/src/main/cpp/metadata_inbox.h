@@ -0,0 +1,69 @@
+/**
+ * metadata_inbox.h - Subscribed-element extraction and queueing for NDI metadata frames
+ *
+ * Metadata frames are tokenized in place (xml_tokenizer.h) as they are captured, and only
+ * elements whose names match a subscription are turned into fixed-size events in a bounded
+ * queue, so feeding a frame never allocates. The queue drops its oldest event when full: a
+ * consumer that stops polling loses stale tally or PTZ state, never video.
+ */
+
+#ifndef NDI_METADATA_INBOX_H
+#define NDI_METADATA_INBOX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define METADATA_MAX_SUBSCRIPTIONS 16
+#define METADATA_NAME_MAX 48
+#define METADATA_MAX_ATTRIBUTES 8
+#define METADATA_VALUE_MAX 128
+#define METADATA_TEXT_MAX 256
+#define METADATA_INBOX_CAPACITY 64
+
+/*
+ * One subscribed element with its attributes and direct text (entities decoded, surrounding
+ * whitespace trimmed). Child elements are not reported separately; subscribe to them by name.
+ */
+typedef struct MetadataEvent {
+    char element[METADATA_NAME_MAX];
+    int attribute_count;
+    char attribute_names[METADATA_MAX_ATTRIBUTES][METADATA_NAME_MAX];
+    char attribute_values[METADATA_MAX_ATTRIBUTES][METADATA_VALUE_MAX];
+    char text[METADATA_TEXT_MAX];
+    int64_t timecode;
+    bool truncated;   /* A name, value, the text or the attribute list did not fit. */
+} MetadataEvent;
+
+typedef struct MetadataInboxStats {
+    uint64_t frames;      /* Metadata frames fed. */
+    uint64_t malformed;   /* Frames whose XML could not be tokenized to the end. */
+    uint64_t events;      /* Subscribed elements extracted. */
+    uint64_t dropped;     /* Events discarded unread because the queue was full. */
+    int queued;
+} MetadataInboxStats;
+
+typedef struct MetadataInbox MetadataInbox;
+
+MetadataInbox* metadata_inbox_create(void);
+void metadata_inbox_destroy(MetadataInbox* inbox);
+
+/*
+ * Replace the subscriptions. A name ending in '*' matches by prefix ("ntk_ptz*").
+ * Returns false, leaving the subscriptions unchanged, if there are more than
+ * METADATA_MAX_SUBSCRIPTIONS or a name is empty or too long.
+ */
+bool metadata_inbox_subscribe(MetadataInbox* inbox, const char* const* names, int count);
+
+/*
+ * Extract subscribed elements from one metadata frame and queue them. Events completed before
+ * a syntax error are kept. Returns the number of events queued.
+ */
+int metadata_inbox_feed(MetadataInbox* inbox, const char* xml, size_t len, int64_t timecode);
+
+/* Pop the oldest queued event. Returns false if the queue is empty. */
+bool metadata_inbox_pop(MetadataInbox* inbox, MetadataEvent* out);
+
+void metadata_inbox_get_stats(MetadataInbox* inbox, MetadataInboxStats* stats);
+
+#endif /* NDI_METADATA_INBOX_H */
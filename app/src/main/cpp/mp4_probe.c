@@ -0,0 +1,502 @@
+/**
+ * mp4_probe.c - Duration and picture size of an MP4 file from its box headers
+ *
+ * See mp4_probe.h. Boxes are located by reading their 8- or 16-byte headers and jumping to the
+ * next sibling; a box is only read into memory for the handful of fields taken from it, so a
+ * probe costs a few dozen small reads whatever the file's length. Box sizes are checked against
+ * the parent and the file, so truncated or corrupt files end the walk rather than read past it.
+ */
+
+#include "mp4_probe.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MP4_MAX_TRACKS 8
+#define TRUN_CHUNK_BYTES 4096
+
+#define TYPE_MOOV MP4_FOURCC('m', 'o', 'o', 'v')
+#define TYPE_MVHD MP4_FOURCC('m', 'v', 'h', 'd')
+#define TYPE_TRAK MP4_FOURCC('t', 'r', 'a', 'k')
+#define TYPE_TKHD MP4_FOURCC('t', 'k', 'h', 'd')
+#define TYPE_MDIA MP4_FOURCC('m', 'd', 'i', 'a')
+#define TYPE_MDHD MP4_FOURCC('m', 'd', 'h', 'd')
+#define TYPE_HDLR MP4_FOURCC('h', 'd', 'l', 'r')
+#define TYPE_MINF MP4_FOURCC('m', 'i', 'n', 'f')
+#define TYPE_STBL MP4_FOURCC('s', 't', 'b', 'l')
+#define TYPE_STSD MP4_FOURCC('s', 't', 's', 'd')
+#define TYPE_MVEX MP4_FOURCC('m', 'v', 'e', 'x')
+#define TYPE_MEHD MP4_FOURCC('m', 'e', 'h', 'd')
+#define TYPE_TREX MP4_FOURCC('t', 'r', 'e', 'x')
+#define TYPE_MOOF MP4_FOURCC('m', 'o', 'o', 'f')
+#define TYPE_TRAF MP4_FOURCC('t', 'r', 'a', 'f')
+#define TYPE_TFHD MP4_FOURCC('t', 'f', 'h', 'd')
+#define TYPE_TFDT MP4_FOURCC('t', 'f', 'd', 't')
+#define TYPE_TRUN MP4_FOURCC('t', 'r', 'u', 'n')
+#define HANDLER_VIDE MP4_FOURCC('v', 'i', 'd', 'e')
+
+/* tfhd and trun flags. */
+#define TFHD_BASE_DATA_OFFSET 0x000001u
+#define TFHD_SAMPLE_DESCRIPTION_INDEX 0x000002u
+#define TFHD_DEFAULT_SAMPLE_DURATION 0x000008u
+#define TRUN_DATA_OFFSET 0x000001u
+#define TRUN_FIRST_SAMPLE_FLAGS 0x000004u
+#define TRUN_SAMPLE_DURATION 0x000100u
+#define TRUN_SAMPLE_SIZE 0x000200u
+#define TRUN_SAMPLE_FLAGS 0x000400u
+#define TRUN_SAMPLE_CTO 0x000800u
+
+typedef struct Reader {
+    int fd;
+    uint64_t file_size;
+    uint32_t reads;
+} Reader;
+
+typedef struct Box {
+    uint32_t type;
+    uint64_t body;   /* Payload offset. */
+    uint64_t end;    /* Offset just past the box. */
+} Box;
+
+typedef struct Track {
+    uint32_t id;
+    uint32_t handler;
+    uint32_t timescale;
+    uint32_t codec;
+    int entry_width;        /* stsd visual sample entry. */
+    int entry_height;
+    int header_width;       /* tkhd, integer part of 16.16. */
+    int header_height;
+    uint32_t default_sample_duration;   /* trex */
+    uint64_t fragment_end;  /* Decode time just past the last fragment seen. */
+} Track;
+
+typedef struct Movie {
+    uint32_t timescale;
+    uint64_t duration;
+    uint64_t fragment_duration;   /* mehd */
+    bool fragmented;
+    int track_count;
+    Track tracks[MP4_MAX_TRACKS];
+} Movie;
+
+/* ============================================================================
+ * Reading
+ * ========================================================================== */
+
+static inline uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline uint64_t be64(const uint8_t* p) {
+    return ((uint64_t)be32(p) << 32) | be32(p + 4);
+}
+
+static inline uint16_t be16(const uint8_t* p) {
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static bool read_at(Reader* r, uint64_t offset, void* buf, size_t len) {
+    if (offset > r->file_size || len > r->file_size - offset) {
+        return false;
+    }
+    r->reads++;
+    size_t done = 0;
+    while (done < len) {
+        const ssize_t n = pread(r->fd, (uint8_t*)buf + done, len - done, (off_t)(offset + done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += (size_t)n;
+    }
+    return true;
+}
+
+/* Read up to cap bytes of a box payload; returns the number read, or 0 on failure. */
+static size_t read_body(Reader* r, const Box* box, uint8_t* buf, size_t cap) {
+    const uint64_t available = box->end - box->body;
+    const size_t len = available < cap ? (size_t)available : cap;
+    return (len > 0 && read_at(r, box->body, buf, len)) ? len : 0;
+}
+
+/* The box starting at pos, which must lie within [pos, limit). */
+static bool read_box(Reader* r, uint64_t pos, uint64_t limit, Box* box) {
+    if (pos >= limit || limit - pos < 8) {
+        return false;
+    }
+    uint8_t header[16];
+    const size_t len = (limit - pos < sizeof(header)) ? (size_t)(limit - pos) : sizeof(header);
+    if (!read_at(r, pos, header, len)) {
+        return false;
+    }
+
+    uint64_t size = be32(header);
+    uint64_t header_size = 8;
+    if (size == 1) {
+        if (len < 16) {
+            return false;
+        }
+        size = be64(header + 8);
+        header_size = 16;
+    } else if (size == 0) {
+        /* Extends to the end of the enclosing box (or file). */
+        size = limit - pos;
+    }
+    if (size < header_size || size > limit - pos) {
+        return false;
+    }
+    box->type = be32(header + 4);
+    box->body = pos + header_size;
+    box->end = pos + size;
+    return true;
+}
+
+/* First child of parent with the given type. */
+static bool find_child(Reader* r, const Box* parent, uint32_t type, Box* child) {
+    uint64_t pos = parent->body;
+    while (read_box(r, pos, parent->end, child)) {
+        if (child->type == type) {
+            return true;
+        }
+        pos = child->end;
+    }
+    return false;
+}
+
+/* ============================================================================
+ * moov
+ * ========================================================================== */
+
+static void parse_mvhd(Reader* r, const Box* box, Movie* movie) {
+    uint8_t b[32];
+    const size_t n = read_body(r, box, b, sizeof(b));
+    if (n >= 32 && b[0] == 1) {
+        movie->timescale = be32(b + 20);
+        movie->duration = be64(b + 24);
+    } else if (n >= 20 && b[0] == 0) {
+        movie->timescale = be32(b + 12);
+        movie->duration = be32(b + 16);
+    }
+}
+
+static void parse_tkhd(Reader* r, const Box* box, Track* track) {
+    uint8_t b[96];
+    const size_t n = read_body(r, box, b, sizeof(b));
+    if (n >= 96 && b[0] == 1) {
+        track->id = be32(b + 20);
+        track->header_width = (int)(be32(b + 88) >> 16);
+        track->header_height = (int)(be32(b + 92) >> 16);
+    } else if (n >= 84 && b[0] == 0) {
+        track->id = be32(b + 12);
+        track->header_width = (int)(be32(b + 76) >> 16);
+        track->header_height = (int)(be32(b + 80) >> 16);
+    }
+}
+
+static void parse_mdhd(Reader* r, const Box* box, Track* track) {
+    uint8_t b[24];
+    const size_t n = read_body(r, box, b, sizeof(b));
+    if (n >= 24 && b[0] == 1) {
+        track->timescale = be32(b + 20);
+    } else if (n >= 16 && b[0] == 0) {
+        track->timescale = be32(b + 12);
+    }
+}
+
+/* First sample entry type, and for video its coded size (VisualSampleEntry width/height). */
+static void parse_stsd(Reader* r, const Box* box, Track* track) {
+    uint8_t b[44];
+    const size_t n = read_body(r, box, b, sizeof(b));
+    if (n < 16 || be32(b + 4) == 0) {
+        return;
+    }
+    track->codec = be32(b + 12);
+    if (n >= 44 && track->handler == HANDLER_VIDE) {
+        track->entry_width = be16(b + 40);
+        track->entry_height = be16(b + 42);
+    }
+}
+
+static void parse_trak(Reader* r, const Box* trak, Movie* movie) {
+    if (movie->track_count >= MP4_MAX_TRACKS) {
+        return;
+    }
+    Track* track = &movie->tracks[movie->track_count];
+    memset(track, 0, sizeof(*track));
+
+    Box box;
+    if (find_child(r, trak, TYPE_TKHD, &box)) {
+        parse_tkhd(r, &box, track);
+    }
+
+    Box mdia;
+    if (find_child(r, trak, TYPE_MDIA, &mdia)) {
+        uint8_t b[12];
+        if (find_child(r, &mdia, TYPE_HDLR, &box) && read_body(r, &box, b, sizeof(b)) == sizeof(b)) {
+            track->handler = be32(b + 8);
+        }
+        if (find_child(r, &mdia, TYPE_MDHD, &box)) {
+            parse_mdhd(r, &box, track);
+        }
+        Box minf, stbl;
+        if (find_child(r, &mdia, TYPE_MINF, &minf) && find_child(r, &minf, TYPE_STBL, &stbl) &&
+            find_child(r, &stbl, TYPE_STSD, &box)) {
+            parse_stsd(r, &box, track);
+        }
+    }
+    movie->track_count++;
+}
+
+static Track* track_by_id(Movie* movie, uint32_t id) {
+    for (int i = 0; i < movie->track_count; i++) {
+        if (movie->tracks[i].id == id) {
+            return &movie->tracks[i];
+        }
+    }
+    return NULL;
+}
+
+static void parse_mvex(Reader* r, const Box* mvex, Movie* movie) {
+    movie->fragmented = true;
+    uint64_t pos = mvex->body;
+    Box box;
+    while (read_box(r, pos, mvex->end, &box)) {
+        uint8_t b[16];
+        const size_t n = read_body(r, &box, b, sizeof(b));
+        if (box.type == TYPE_MEHD) {
+            if (n >= 12 && b[0] == 1) {
+                movie->fragment_duration = be64(b + 4);
+            } else if (n >= 8) {
+                movie->fragment_duration = be32(b + 4);
+            }
+        } else if (box.type == TYPE_TREX && n >= 16) {
+            Track* track = track_by_id(movie, be32(b + 4));
+            if (track != NULL) {
+                track->default_sample_duration = be32(b + 12);
+            }
+        }
+        pos = box.end;
+    }
+}
+
+static void parse_moov(Reader* r, const Box* moov, Movie* movie) {
+    /* Tracks first: trex entries in mvex refer to them by id. */
+    Box box;
+    bool has_mvex = false;
+    Box mvex = {0, 0, 0};
+    uint64_t pos = moov->body;
+    while (read_box(r, pos, moov->end, &box)) {
+        if (box.type == TYPE_MVHD) {
+            parse_mvhd(r, &box, movie);
+        } else if (box.type == TYPE_TRAK) {
+            parse_trak(r, &box, movie);
+        } else if (box.type == TYPE_MVEX) {
+            mvex = box;
+            has_mvex = true;
+        }
+        pos = box.end;
+    }
+    if (has_mvex) {
+        parse_mvex(r, &mvex, movie);
+    }
+}
+
+/* ============================================================================
+ * moof
+ * ========================================================================== */
+
+/* Sum of the sample durations in a trun. */
+static uint64_t trun_duration(Reader* r, const Box* trun, uint32_t default_duration) {
+    uint8_t b[TRUN_CHUNK_BYTES];
+    if (read_body(r, trun, b, 8) != 8) {
+        return 0;
+    }
+    const uint32_t flags = be32(b) & 0xFFFFFFu;
+    const uint32_t count = be32(b + 4);
+    if (!(flags & TRUN_SAMPLE_DURATION)) {
+        return (uint64_t)count * default_duration;
+    }
+
+    uint64_t offset = trun->body + 8;
+    if (flags & TRUN_DATA_OFFSET) {
+        offset += 4;
+    }
+    if (flags & TRUN_FIRST_SAMPLE_FLAGS) {
+        offset += 4;
+    }
+    const size_t entry = 4 * (size_t)(1 + ((flags & TRUN_SAMPLE_SIZE) != 0) + ((flags & TRUN_SAMPLE_FLAGS) != 0) +
+                                      ((flags & TRUN_SAMPLE_CTO) != 0));
+    const size_t per_chunk = sizeof(b) / entry;
+
+    uint64_t total = 0;
+    uint32_t remaining = count;
+    while (remaining > 0) {
+        const size_t samples = remaining < per_chunk ? remaining : per_chunk;
+        if (offset > trun->end || samples * entry > trun->end - offset ||
+            !read_at(r, offset, b, samples * entry)) {
+            break;
+        }
+        for (size_t i = 0; i < samples; i++) {
+            total += be32(b + i * entry);
+        }
+        offset += samples * entry;
+        remaining -= (uint32_t)samples;
+    }
+    return total;
+}
+
+static void parse_traf(Reader* r, const Box* traf, Movie* movie, const Track* wanted) {
+    Box tfhd;
+    uint8_t b[24];
+    if (!find_child(r, traf, TYPE_TFHD, &tfhd) || read_body(r, &tfhd, b, sizeof(b)) < 8) {
+        return;
+    }
+    Track* track = track_by_id(movie, be32(b + 4));
+    if (track == NULL || track != wanted) {
+        return;
+    }
+
+    const uint32_t flags = be32(b) & 0xFFFFFFu;
+    uint32_t default_duration = track->default_sample_duration;
+    size_t field = 8;
+    if (flags & TFHD_BASE_DATA_OFFSET) {
+        field += 8;
+    }
+    if (flags & TFHD_SAMPLE_DESCRIPTION_INDEX) {
+        field += 4;
+    }
+    if ((flags & TFHD_DEFAULT_SAMPLE_DURATION) && tfhd.end - tfhd.body >= field + 4) {
+        default_duration = be32(b + field);
+    }
+
+    /* Decode time from tfdt when present, else continuing from the previous fragment. */
+    uint64_t time = track->fragment_end;
+    uint64_t pos = traf->body;
+    Box box;
+    while (read_box(r, pos, traf->end, &box)) {
+        if (box.type == TYPE_TFDT) {
+            const size_t n = read_body(r, &box, b, 12);
+            if (n >= 12 && b[0] == 1) {
+                time = be64(b + 4);
+            } else if (n >= 8) {
+                time = be32(b + 4);
+            }
+        } else if (box.type == TYPE_TRUN) {
+            time += trun_duration(r, &box, default_duration);
+        }
+        pos = box.end;
+    }
+    if (time > track->fragment_end) {
+        track->fragment_end = time;
+    }
+}
+
+static void parse_moof(Reader* r, const Box* moof, Movie* movie, const Track* wanted) {
+    uint64_t pos = moof->body;
+    Box box;
+    while (read_box(r, pos, moof->end, &box)) {
+        if (box.type == TYPE_TRAF) {
+            parse_traf(r, &box, movie, wanted);
+        }
+        pos = box.end;
+    }
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+static int64_t to_ms(uint64_t duration, uint32_t timescale) {
+    if (timescale == 0) {
+        return 0;
+    }
+    return (int64_t)((duration / timescale) * 1000 + (duration % timescale) * 1000 / timescale);
+}
+
+bool mp4_probe_fd(int fd, Mp4Info* info) {
+    if (info == NULL) {
+        return false;
+    }
+    memset(info, 0, sizeof(*info));
+
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) {
+        return false;
+    }
+    Reader r = {fd, (uint64_t)st.st_size, 0};
+    Movie movie;
+    memset(&movie, 0, sizeof(movie));
+
+    /* Top level: moov (before or after mdat), then moof boxes if the file is fragmented. */
+    bool have_moov = false;
+    const Track* wanted = NULL;
+    uint64_t pos = 0;
+    Box box;
+    while (read_box(&r, pos, r.file_size, &box)) {
+        if (box.type == TYPE_MOOV && !have_moov) {
+            parse_moov(&r, &box, &movie);
+            have_moov = true;
+            for (int i = 0; i < movie.track_count && wanted == NULL; i++) {
+                if (movie.tracks[i].handler == HANDLER_VIDE) {
+                    wanted = &movie.tracks[i];
+                }
+            }
+            if (wanted == NULL && movie.track_count > 0) {
+                wanted = &movie.tracks[0];
+            }
+            if (!movie.fragmented) {
+                break;
+            }
+        } else if (box.type == TYPE_MOOF && have_moov) {
+            parse_moof(&r, &box, &movie, wanted);
+        }
+        pos = box.end;
+    }
+    info->reads = r.reads;
+    if (!have_moov) {
+        return false;
+    }
+
+    info->fragmented = movie.fragmented;
+    int64_t duration_ms = to_ms(movie.duration, movie.timescale);
+    const int64_t fragment_ms = to_ms(movie.fragment_duration, movie.timescale);
+    if (fragment_ms > duration_ms) {
+        duration_ms = fragment_ms;
+    }
+    if (wanted != NULL) {
+        const int64_t end_ms = to_ms(wanted->fragment_end, wanted->timescale);
+        if (end_ms > duration_ms) {
+            duration_ms = end_ms;
+        }
+        if (wanted->handler == HANDLER_VIDE) {
+            info->video_codec = wanted->codec;
+            const bool has_entry_size = wanted->entry_width > 0 && wanted->entry_height > 0;
+            info->width = has_entry_size ? wanted->entry_width : wanted->header_width;
+            info->height = has_entry_size ? wanted->entry_height : wanted->header_height;
+        }
+    }
+    info->duration_ms = duration_ms;
+    return true;
+}
+
+bool mp4_probe_path(const char* path, Mp4Info* info) {
+    if (path == NULL) {
+        return false;
+    }
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (info != NULL) {
+            memset(info, 0, sizeof(*info));
+        }
+        return false;
+    }
+    const bool ok = mp4_probe_fd(fd, info);
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,39 @@
+/**
+ * mp4_probe.h - Duration and picture size of an MP4 file from its box headers
+ *
+ * The recordings list needs only a file's duration and size. Opening each file with a media
+ * extractor parses every sample table; this walks the ISO-BMFF box tree instead, reading box
+ * headers and the few fixed-size fields it needs (mvhd, tkhd, mdhd, hdlr, stsd, mvex) with
+ * positioned reads, and skips everything else, including the sample tables and media data.
+ * Fragmented files take their duration from mehd when present, otherwise from the decode time
+ * and sample durations in each moof.
+ */
+
+#ifndef NDI_MP4_PROBE_H
+#define NDI_MP4_PROBE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MP4_FOURCC(a, b, c, d) \
+    (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+typedef struct Mp4Info {
+    int64_t duration_ms;    /* Movie duration; for fragmented files the end of the last fragment. */
+    int width;              /* Coded size from the video sample entry (tkhd size if it has none). */
+    int height;
+    uint32_t video_codec;   /* Video sample entry type, e.g. 'avc1' or 'hvc1'; 0 without video. */
+    bool fragmented;        /* moov has mvex: samples are described by moof boxes. */
+    uint32_t reads;         /* Positioned reads the probe made. */
+} Mp4Info;
+
+/*
+ * Probe the MP4 open on fd (only pread is used, so the file offset is unchanged). Returns false
+ * if the file has no complete moov box, e.g. a recording that was never finalized.
+ */
+bool mp4_probe_fd(int fd, Mp4Info* info);
+
+/* As mp4_probe_fd, opening path read-only. */
+bool mp4_probe_path(const char* path, Mp4Info* info);
+
+#endif /* NDI_MP4_PROBE_H */
@@ -0,0 +1,364 @@
+/**
+ * multiview.c - Compositing several sources into one grid of tiles
+ *
+ * See multiview.h. Tile regions partition the canvas exactly (column c spans
+ * width * c / columns to width * (c + 1) / columns), so a present copies each pixel under the
+ * lock of the one tile that owns it.
+ */
+
+#include "multiview.h"
+#include "ndi_trace.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct MultiviewTile {
+    pthread_mutex_t lock;
+    MultiviewRect rect;
+    MultiviewRect fit;       /* Where the last frame went; empty when there is none. */
+    FrameScaler* scaler;
+    bool dirty;              /* Changed since it was last presented. */
+    bool has_frame;
+    int src_width;
+    int src_height;
+    uint64_t frames;
+    uint64_t superseded;
+    int64_t updated_ns;
+    int64_t compose_total_ns;
+    int64_t compose_max_ns;
+} MultiviewTile;
+
+struct Multiview {
+    int width;
+    int height;
+    int tile_count;
+    uint8_t* canvas;
+    MultiviewTile tiles[MULTIVIEW_MAX_TILES];
+
+    pthread_mutex_t lock;    /* Present stats. */
+    uint64_t presents;
+    uint64_t idle_presents;
+    uint64_t dirty_tiles_total;
+    int64_t present_total_ns;
+    int64_t present_max_ns;
+};
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+
+static bool rect_empty(const MultiviewRect* r) {
+    return r->right <= r->left || r->bottom <= r->top;
+}
+
+static bool rect_equal(const MultiviewRect* a, const MultiviewRect* b) {
+    return a->left == b->left && a->top == b->top && a->right == b->right && a->bottom == b->bottom;
+}
+
+static void fill_black(Multiview* mv, const MultiviewRect* r) {
+    if (rect_empty(r)) {
+        return;
+    }
+    const size_t stride = (size_t)mv->width * 4;
+    for (int y = r->top; y < r->bottom; y++) {
+        uint8_t* p = mv->canvas + (size_t)y * stride + (size_t)r->left * 4;
+        for (int x = r->left; x < r->right; x++, p += 4) {
+            p[0] = 0;
+            p[1] = 0;
+            p[2] = 0;
+            p[3] = 0xFF;
+        }
+    }
+}
+
+/* Largest rectangle of the source's aspect ratio centred in the tile. */
+static MultiviewRect fit_rect(const MultiviewRect* tile, int src_width, int src_height) {
+    const int tile_width = tile->right - tile->left;
+    const int tile_height = tile->bottom - tile->top;
+    int width = tile_width;
+    int height = (int)((int64_t)tile_width * src_height / src_width);
+    if (height > tile_height) {
+        height = tile_height;
+        width = (int)((int64_t)tile_height * src_width / src_height);
+    }
+    if (width < 1) {
+        width = 1;
+    }
+    if (height < 1) {
+        height = 1;
+    }
+    MultiviewRect fit;
+    fit.left = tile->left + (tile_width - width) / 2;
+    fit.top = tile->top + (tile_height - height) / 2;
+    fit.right = fit.left + width;
+    fit.bottom = fit.top + height;
+    return fit;
+}
+
+/* Black out the parts of the tile around fit. */
+static void fill_bars(Multiview* mv, const MultiviewRect* tile, const MultiviewRect* fit) {
+    const MultiviewRect top = { tile->left, tile->top, tile->right, fit->top };
+    const MultiviewRect bottom = { tile->left, fit->bottom, tile->right, tile->bottom };
+    const MultiviewRect left = { tile->left, fit->top, fit->left, fit->bottom };
+    const MultiviewRect right = { fit->right, fit->top, tile->right, fit->bottom };
+    fill_black(mv, &top);
+    fill_black(mv, &bottom);
+    fill_black(mv, &left);
+    fill_black(mv, &right);
+}
+
+/* ============================================================================
+ * Lifecycle
+ * ========================================================================== */
+
+Multiview* multiview_create(int width, int height, int columns, int rows) {
+    if (columns < 1 || rows < 1 || columns * rows > MULTIVIEW_MAX_TILES || width < columns ||
+        height < rows || width > FRAME_SCALER_MAX_DIMENSION || height > FRAME_SCALER_MAX_DIMENSION) {
+        return NULL;
+    }
+    Multiview* mv = (Multiview*)calloc(1, sizeof(Multiview));
+    if (mv == NULL) {
+        return NULL;
+    }
+    mv->canvas = (uint8_t*)malloc((size_t)width * (size_t)height * 4);
+    if (mv->canvas == NULL) {
+        free(mv);
+        return NULL;
+    }
+    mv->width = width;
+    mv->height = height;
+    pthread_mutex_init(&mv->lock, NULL);
+
+    for (int i = 0; i < columns * rows; i++) {
+        MultiviewTile* t = &mv->tiles[i];
+        const int column = i % columns;
+        const int row = i / columns;
+        t->scaler = frame_scaler_create();
+        if (t->scaler == NULL) {
+            multiview_destroy(mv);
+            return NULL;
+        }
+        pthread_mutex_init(&t->lock, NULL);
+        mv->tile_count = i + 1;
+        t->rect.left = width * column / columns;
+        t->rect.right = width * (column + 1) / columns;
+        t->rect.top = height * row / rows;
+        t->rect.bottom = height * (row + 1) / rows;
+        t->dirty = true;
+    }
+
+    const MultiviewRect all = { 0, 0, width, height };
+    fill_black(mv, &all);
+    return mv;
+}
+
+void multiview_destroy(Multiview* mv) {
+    if (mv == NULL) {
+        return;
+    }
+    for (int i = 0; i < mv->tile_count; i++) {
+        frame_scaler_destroy(mv->tiles[i].scaler);
+        pthread_mutex_destroy(&mv->tiles[i].lock);
+    }
+    pthread_mutex_destroy(&mv->lock);
+    free(mv->canvas);
+    free(mv);
+}
+
+int multiview_tile_count(Multiview* mv) {
+    return (mv != NULL) ? mv->tile_count : 0;
+}
+
+bool multiview_tile_rect(Multiview* mv, int tile, MultiviewRect* rect) {
+    if (mv == NULL || tile < 0 || tile >= mv->tile_count) {
+        return false;
+    }
+    *rect = mv->tiles[tile].rect;
+    return true;
+}
+
+/* ============================================================================
+ * Composing
+ * ========================================================================== */
+
+bool multiview_submit(Multiview* mv, int tile, const uint8_t* src, int src_stride,
+                      int src_width, int src_height, ScalerFormat format) {
+    if (mv == NULL || tile < 0 || tile >= mv->tile_count || src_width < 1 || src_height < 1) {
+        return false;
+    }
+    MultiviewTile* t = &mv->tiles[tile];
+    const int64_t start_ns = monotonic_ns();
+    const MultiviewRect fit = fit_rect(&t->rect, src_width, src_height);
+    const size_t stride = (size_t)mv->width * 4;
+
+    pthread_mutex_lock(&t->lock);
+    NDI_TRACE_BEGIN("multiview compose");
+    uint8_t* dst = mv->canvas + (size_t)fit.top * stride + (size_t)fit.left * 4;
+    const bool scaled = frame_scaler_scale(t->scaler, src, src_stride, src_width, src_height, format,
+                                           dst, (int)stride, fit.right - fit.left, fit.bottom - fit.top,
+                                           SCALER_FILTER_AUTO);
+    if (scaled) {
+        /* Bars only need painting when the frame moved within the tile. */
+        if (!rect_equal(&fit, &t->fit)) {
+            fill_bars(mv, &t->rect, &fit);
+            t->fit = fit;
+        }
+        const int64_t end_ns = monotonic_ns();
+        const int64_t compose_ns = end_ns - start_ns;
+        if (t->dirty && t->has_frame) {
+            t->superseded++;
+        }
+        t->dirty = true;
+        t->has_frame = true;
+        t->src_width = src_width;
+        t->src_height = src_height;
+        t->frames++;
+        t->updated_ns = end_ns;
+        t->compose_total_ns += compose_ns;
+        if (compose_ns > t->compose_max_ns) {
+            t->compose_max_ns = compose_ns;
+        }
+    }
+    NDI_TRACE_END();
+    pthread_mutex_unlock(&t->lock);
+    return scaled;
+}
+
+void multiview_clear_tile(Multiview* mv, int tile) {
+    if (mv == NULL || tile < 0 || tile >= mv->tile_count) {
+        return;
+    }
+    MultiviewTile* t = &mv->tiles[tile];
+    pthread_mutex_lock(&t->lock);
+    fill_black(mv, &t->rect);
+    memset(&t->fit, 0, sizeof(t->fit));
+    t->dirty = true;
+    t->has_frame = false;
+    t->updated_ns = monotonic_ns();
+    pthread_mutex_unlock(&t->lock);
+}
+
+void multiview_invalidate(Multiview* mv) {
+    if (mv == NULL) {
+        return;
+    }
+    for (int i = 0; i < mv->tile_count; i++) {
+        pthread_mutex_lock(&mv->tiles[i].lock);
+        mv->tiles[i].dirty = true;
+        pthread_mutex_unlock(&mv->tiles[i].lock);
+    }
+}
+
+/* ============================================================================
+ * Presenting
+ * ========================================================================== */
+
+bool multiview_begin_present(Multiview* mv, MultiviewRect* dirty) {
+    if (mv == NULL) {
+        return false;
+    }
+    MultiviewRect bounds = { mv->width, mv->height, 0, 0 };
+    for (int i = 0; i < mv->tile_count; i++) {
+        MultiviewTile* t = &mv->tiles[i];
+        pthread_mutex_lock(&t->lock);
+        if (t->dirty) {
+            bounds.left = (t->rect.left < bounds.left) ? t->rect.left : bounds.left;
+            bounds.top = (t->rect.top < bounds.top) ? t->rect.top : bounds.top;
+            bounds.right = (t->rect.right > bounds.right) ? t->rect.right : bounds.right;
+            bounds.bottom = (t->rect.bottom > bounds.bottom) ? t->rect.bottom : bounds.bottom;
+        }
+        pthread_mutex_unlock(&t->lock);
+    }
+    if (rect_empty(&bounds)) {
+        pthread_mutex_lock(&mv->lock);
+        mv->idle_presents++;
+        pthread_mutex_unlock(&mv->lock);
+        return false;
+    }
+    *dirty = bounds;
+    return true;
+}
+
+void multiview_present(Multiview* mv, uint8_t* dst, int dst_stride, const MultiviewRect* bounds) {
+    if (mv == NULL || dst == NULL || bounds == NULL) {
+        return;
+    }
+    const int64_t start_ns = monotonic_ns();
+    const size_t stride = (size_t)mv->width * 4;
+    int copied = 0;
+
+    NDI_TRACE_BEGIN("multiview present");
+    for (int i = 0; i < mv->tile_count; i++) {
+        MultiviewTile* t = &mv->tiles[i];
+        MultiviewRect r;
+        r.left = (t->rect.left > bounds->left) ? t->rect.left : bounds->left;
+        r.top = (t->rect.top > bounds->top) ? t->rect.top : bounds->top;
+        r.right = (t->rect.right < bounds->right) ? t->rect.right : bounds->right;
+        r.bottom = (t->rect.bottom < bounds->bottom) ? t->rect.bottom : bounds->bottom;
+        if (rect_empty(&r)) {
+            continue;
+        }
+        pthread_mutex_lock(&t->lock);
+        const size_t bytes = (size_t)(r.right - r.left) * 4;
+        for (int y = r.top; y < r.bottom; y++) {
+            memcpy(dst + (size_t)y * (size_t)dst_stride + (size_t)r.left * 4,
+                   mv->canvas + (size_t)y * stride + (size_t)r.left * 4, bytes);
+        }
+        if (t->dirty && rect_equal(&r, &t->rect)) {
+            t->dirty = false;
+            copied++;
+        }
+        pthread_mutex_unlock(&t->lock);
+    }
+    NDI_TRACE_END();
+
+    const int64_t present_ns = monotonic_ns() - start_ns;
+    pthread_mutex_lock(&mv->lock);
+    mv->presents++;
+    mv->dirty_tiles_total += (uint64_t)copied;
+    mv->present_total_ns += present_ns;
+    if (present_ns > mv->present_max_ns) {
+        mv->present_max_ns = present_ns;
+    }
+    pthread_mutex_unlock(&mv->lock);
+}
+
+/* ============================================================================
+ * Stats
+ * ========================================================================== */
+
+bool multiview_get_tile_stats(Multiview* mv, int tile, MultiviewTileStats* stats) {
+    if (mv == NULL || stats == NULL || tile < 0 || tile >= mv->tile_count) {
+        return false;
+    }
+    MultiviewTile* t = &mv->tiles[tile];
+    const int64_t now_ns = monotonic_ns();
+    pthread_mutex_lock(&t->lock);
+    stats->has_frame = t->has_frame;
+    stats->src_width = t->src_width;
+    stats->src_height = t->src_height;
+    stats->frames = t->frames;
+    stats->superseded = t->superseded;
+    stats->age_ns = t->has_frame ? now_ns - t->updated_ns : 0;
+    stats->compose_avg_ns = (t->frames > 0) ? t->compose_total_ns / (int64_t)t->frames : 0;
+    stats->compose_max_ns = t->compose_max_ns;
+    pthread_mutex_unlock(&t->lock);
+    return true;
+}
+
+void multiview_get_stats(Multiview* mv, MultiviewStats* stats) {
+    if (mv == NULL || stats == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&mv->lock);
+    stats->presents = mv->presents;
+    stats->idle_presents = mv->idle_presents;
+    stats->dirty_tiles_avg = (mv->presents > 0) ? (double)mv->dirty_tiles_total / (double)mv->presents : 0.0;
+    stats->present_avg_ns = (mv->presents > 0) ? mv->present_total_ns / (int64_t)mv->presents : 0;
+    stats->present_max_ns = mv->present_max_ns;
+    pthread_mutex_unlock(&mv->lock);
+}
@@ -0,0 +1,96 @@
+/**
+ * multiview.h - Compositing several sources into one grid of tiles
+ *
+ * The output is an RGBA canvas split into columns x rows tiles. Submitting a frame to a tile
+ * scales it (frame_scaler.c, letterboxed to keep its aspect ratio) straight into the tile's
+ * region of the canvas and marks the tile dirty; presenting copies only the region covering
+ * the dirty tiles to the output, so a 3x3 wall where one source changes costs one tile per
+ * vsync rather than nine.
+ *
+ * Each tile has its own lock, so a submit only holds up presents that copy the same tile and
+ * submits to different tiles can run on different threads. Like the capture scheduler this
+ * reads CLOCK_MONOTONIC itself to time its own work.
+ */
+
+#ifndef NDI_MULTIVIEW_H
+#define NDI_MULTIVIEW_H
+
+#include "frame_scaler.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MULTIVIEW_MAX_TILES 16
+
+/* Pixel rectangle, right and bottom exclusive. */
+typedef struct MultiviewRect {
+    int left;
+    int top;
+    int right;
+    int bottom;
+} MultiviewRect;
+
+typedef struct MultiviewTileStats {
+    bool has_frame;
+    int src_width;            /* Last submitted frame. */
+    int src_height;
+    uint64_t frames;          /* Frames composed into the tile. */
+    uint64_t superseded;      /* Composed frames replaced before a present showed them. */
+    int64_t age_ns;           /* Since the tile last changed; 0 without a frame. */
+    int64_t compose_avg_ns;   /* Scale and convert time per frame. */
+    int64_t compose_max_ns;
+} MultiviewTileStats;
+
+typedef struct MultiviewStats {
+    uint64_t presents;        /* Presents that copied changed tiles. */
+    uint64_t idle_presents;   /* Vsyncs with nothing changed. */
+    double dirty_tiles_avg;   /* Tiles copied per present. */
+    int64_t present_avg_ns;   /* Copy time per present. */
+    int64_t present_max_ns;
+} MultiviewStats;
+
+typedef struct Multiview Multiview;
+
+/*
+ * Create a width x height canvas of columns x rows tiles (at most MULTIVIEW_MAX_TILES, each at
+ * least one pixel), filled opaque black. Returns NULL for other sizes or out of memory.
+ */
+Multiview* multiview_create(int width, int height, int columns, int rows);
+void multiview_destroy(Multiview* mv);
+
+int multiview_tile_count(Multiview* mv);
+
+/* Canvas region of a tile. Returns false for a tile out of range. */
+bool multiview_tile_rect(Multiview* mv, int tile, MultiviewRect* rect);
+
+/*
+ * Scale a frame into its tile; the bars around a letterboxed frame are black. Returns false
+ * for a tile out of range or a frame frame_scaler_scale() rejects, leaving the tile as it was.
+ */
+bool multiview_submit(Multiview* mv, int tile, const uint8_t* src, int src_stride,
+                      int src_width, int src_height, ScalerFormat format);
+
+/* Fill a tile with black (e.g. its source went away). */
+void multiview_clear_tile(Multiview* mv, int tile);
+
+/* Mark every tile dirty, e.g. when the output's contents were lost. */
+void multiview_invalidate(Multiview* mv);
+
+/*
+ * Start a present: the bounding rectangle of the dirty tiles. Returns false, counting an idle
+ * vsync, if no tile changed since the last present.
+ */
+bool multiview_begin_present(Multiview* mv, MultiviewRect* dirty);
+
+/*
+ * Copy the canvas within bounds (at least the rectangle multiview_begin_present() returned;
+ * the output may ask for more) to dst, a canvas-sized RGBA buffer of dst_stride bytes per row.
+ * Tiles wholly inside bounds are clean afterwards.
+ */
+void multiview_present(Multiview* mv, uint8_t* dst, int dst_stride, const MultiviewRect* bounds);
+
+/* Returns false for a tile out of range. */
+bool multiview_get_tile_stats(Multiview* mv, int tile, MultiviewTileStats* stats);
+void multiview_get_stats(Multiview* mv, MultiviewStats* stats);
+
+#endif /* NDI_MULTIVIEW_H */
@@ -0,0 +1,213 @@
+/**
+ * ndi_relay.c - Republishing received frames as a local NDI source
+ *
+ * The SDK is done with an async frame once the next send_video_async_v2 call (or a NULL flush)
+ * returns, so exactly one owner is in flight at a time. It is swapped under the lock and
+ * released after it, keeping the callback free to take its own locks.
+ *
+ * The sender only exists while the stream is uncompressed. It is created under the lock by
+ * the first frame it can carry and destroyed by the first compressed one, after a flush.
+ */
+
+#include "ndi_relay.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct NdiRelay {
+    pthread_mutex_t lock;
+    const NDIlib_v6* api;
+    char* name;
+    NDIlib_send_instance_t sender;   /* NULL until advertised. */
+    bool create_failed;              /* send_create failed; not retried for this relay. */
+    NdiRelayReleaseFn release;
+    void* release_context;
+    void* in_flight;   /* Owner of the frame the SDK may still be reading, or NULL. */
+    NdiRelayStats stats;
+};
+
+/* ============================================================================
+ * Internal helpers
+ * ========================================================================== */
+
+/* Uncompressed formats send_video_async_v2 accepts; compressed (HX) video needs the advanced SDK. */
+static bool is_sendable_fourcc(NDIlib_FourCC_video_type_e fourcc) {
+    switch (fourcc) {
+        case NDIlib_FourCC_video_type_UYVY:
+        case NDIlib_FourCC_video_type_UYVA:
+        case NDIlib_FourCC_video_type_P216:
+        case NDIlib_FourCC_video_type_PA16:
+        case NDIlib_FourCC_video_type_YV12:
+        case NDIlib_FourCC_video_type_I420:
+        case NDIlib_FourCC_video_type_NV12:
+        case NDIlib_FourCC_video_type_BGRA:
+        case NDIlib_FourCC_video_type_BGRX:
+        case NDIlib_FourCC_video_type_RGBA:
+        case NDIlib_FourCC_video_type_RGBX:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Caller holds the lock. Refreshes the connection count and returns it. */
+static int poll_connections(NdiRelay* relay) {
+    const int connections =
+        relay->sender != NULL ? relay->api->send_get_no_connections(relay->sender, 0) : 0;
+    relay->stats.connections = connections > 0 ? connections : 0;
+    return relay->stats.connections;
+}
+
+/* Caller holds the lock. Waits for the SDK to finish with the frame in flight; returns its owner. */
+static void* flush_locked(NdiRelay* relay) {
+    void* owner = relay->in_flight;
+    if (owner != NULL) {
+        relay->api->send_send_video_async_v2(relay->sender, NULL);
+        relay->in_flight = NULL;
+    }
+    return owner;
+}
+
+/* Caller holds the lock. Creates the sender if needed; returns whether it exists. */
+static bool advertise_locked(NdiRelay* relay) {
+    if (relay->sender == NULL && !relay->create_failed) {
+        NDIlib_send_create_t settings;
+        memset(&settings, 0, sizeof(settings));
+        settings.p_ndi_name = relay->name;
+        settings.p_groups = NULL;
+        settings.clock_video = false;
+        settings.clock_audio = false;
+        relay->sender = relay->api->send_create(&settings);
+        relay->create_failed = (relay->sender == NULL);
+    }
+    relay->stats.advertising = (relay->sender != NULL);
+    return relay->stats.advertising;
+}
+
+/* Caller holds the lock. Stops advertising; returns the owner of the frame in flight. */
+static void* withdraw_locked(NdiRelay* relay) {
+    void* owner = flush_locked(relay);
+    if (relay->sender != NULL) {
+        relay->api->send_destroy(relay->sender);
+        relay->sender = NULL;
+    }
+    relay->stats.advertising = false;
+    relay->stats.connections = 0;
+    return owner;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+bool ndi_relay_supported(const NDIlib_v6* api) {
+    return api != NULL && api->send_create != NULL && api->send_destroy != NULL &&
+           api->send_send_video_async_v2 != NULL && api->send_send_audio_v2 != NULL &&
+           api->send_get_no_connections != NULL;
+}
+
+NdiRelay* ndi_relay_create(const NDIlib_v6* api, const char* name, NdiRelayReleaseFn release, void* context) {
+    if (!ndi_relay_supported(api) || name == NULL || name[0] == '\0' || release == NULL) {
+        return NULL;
+    }
+
+    NdiRelay* relay = (NdiRelay*)calloc(1, sizeof(NdiRelay));
+    if (relay == NULL) {
+        return NULL;
+    }
+    const size_t name_size = strlen(name) + 1;
+    relay->name = (char*)malloc(name_size);
+    if (relay->name == NULL || pthread_mutex_init(&relay->lock, NULL) != 0) {
+        free(relay->name);
+        free(relay);
+        return NULL;
+    }
+
+    memcpy(relay->name, name, name_size);
+    relay->api = api;
+    relay->release = release;
+    relay->release_context = context;
+    return relay;
+}
+
+void ndi_relay_destroy(NdiRelay* relay) {
+    if (relay == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&relay->lock);
+    void* owner = withdraw_locked(relay);
+    pthread_mutex_unlock(&relay->lock);
+    if (owner != NULL) {
+        relay->release(owner, relay->release_context);
+    }
+
+    pthread_mutex_destroy(&relay->lock);
+    free(relay->name);
+    free(relay);
+}
+
+bool ndi_relay_send_video(NdiRelay* relay, const NDIlib_video_frame_v2_t* frame, void* owner) {
+    if (relay == NULL || frame == NULL || owner == NULL) {
+        return false;
+    }
+
+    void* previous = NULL;
+    bool sent = false;
+    pthread_mutex_lock(&relay->lock);
+    if (frame->p_data == NULL) {
+        relay->stats.video_skipped++;
+    } else if (!is_sendable_fourcc(frame->FourCC)) {
+        /* Receivers of a relay that can only send black are better off not finding it. */
+        previous = withdraw_locked(relay);
+        relay->stats.compressed = true;
+        relay->stats.video_skipped++;
+    } else {
+        relay->stats.compressed = false;
+        if (!advertise_locked(relay)) {
+            relay->stats.video_skipped++;
+        } else if (poll_connections(relay) == 0) {
+            /* Nobody is watching: don't keep a received frame pinned for the SDK. */
+            previous = flush_locked(relay);
+            relay->stats.video_unwatched++;
+        } else {
+            relay->api->send_send_video_async_v2(relay->sender, frame);
+            previous = relay->in_flight;
+            relay->in_flight = owner;
+            relay->stats.video_sent++;
+            sent = true;
+        }
+    }
+    pthread_mutex_unlock(&relay->lock);
+
+    if (previous != NULL) {
+        relay->release(previous, relay->release_context);
+    }
+    return sent;
+}
+
+bool ndi_relay_send_audio(NdiRelay* relay, const NDIlib_audio_frame_v2_t* frame) {
+    if (relay == NULL || frame == NULL || frame->p_data == NULL) {
+        return false;
+    }
+
+    bool sent = false;
+    pthread_mutex_lock(&relay->lock);
+    if (relay->sender != NULL && poll_connections(relay) > 0) {
+        relay->api->send_send_audio_v2(relay->sender, frame);
+        relay->stats.audio_sent++;
+        sent = true;
+    }
+    pthread_mutex_unlock(&relay->lock);
+    return sent;
+}
+
+void ndi_relay_get_stats(NdiRelay* relay, NdiRelayStats* stats) {
+    if (relay == NULL || stats == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&relay->lock);
+    poll_connections(relay);
+    *stats = relay->stats;
+    pthread_mutex_unlock(&relay->lock);
+}
@@ -0,0 +1,73 @@
+/**
+ * ndi_relay.h - Republishing received frames as a local NDI source
+ *
+ * No JNI dependency; calls the SDK only through the NDIlib_v6 table (ndi_runtime.h), so it
+ * builds and is tested on the host against the stub library's loopback sender.
+ *
+ * A relay lets one device pull a stream from a sender on a slow link and serve the other
+ * receivers itself. Video goes out with send_video_async_v2, which returns before the SDK has
+ * read the buffer: the relay keeps a reference to the frame's owner until the next send (or a
+ * flush) proves the SDK is done with it, and hands it back through the release callback, so
+ * received frames are republished without a copy. Nothing is sent while no receiver is
+ * connected.
+ *
+ * The source is only advertised while there is video the send API can carry: the sender is
+ * created by the first uncompressed frame and withdrawn again if compressed (HX) frames
+ * follow, so an HX stream never shows up on the network as a black relay.
+ */
+
+#ifndef NDI_RELAY_H
+#define NDI_RELAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Processing.NDI.Lib.h"
+
+/*
+ * Called once the SDK no longer reads the frame submitted with owner. May be called from
+ * ndi_relay_send_video (for the previous frame) or ndi_relay_destroy, never with the relay's
+ * lock held.
+ */
+typedef void (*NdiRelayReleaseFn)(void* owner, void* context);
+
+typedef struct NdiRelayStats {
+    uint64_t video_sent;
+    uint64_t video_skipped;     /* Compressed or empty frames the send API cannot carry. */
+    uint64_t video_unwatched;   /* Frames not sent because no receiver was connected. */
+    uint64_t audio_sent;
+    int connections;            /* Receivers currently connected to the relay. */
+    bool advertising;           /* The relay source exists on the network. */
+    bool compressed;            /* The last video frame was compressed: nothing to advertise. */
+} NdiRelayStats;
+
+typedef struct NdiRelay NdiRelay;
+
+/* True if api has every send entry the relay uses (they are optional for the receiver). */
+bool ndi_relay_supported(const NDIlib_v6* api);
+
+/*
+ * Prepare to advertise name as an NDI source once the first uncompressed frame arrives. Frames
+ * are sent unclocked: the relay runs at the rate frames are received. Returns NULL if the api
+ * lacks the send entries.
+ */
+NdiRelay* ndi_relay_create(const NDIlib_v6* api, const char* name, NdiRelayReleaseFn release, void* context);
+
+/* Release the frame in flight and stop advertising. */
+void ndi_relay_destroy(NdiRelay* relay);
+
+/*
+ * Republish frame. Returns true if it was sent, in which case owner is referenced until the
+ * release callback is called for it; on false nothing is retained.
+ */
+bool ndi_relay_send_video(NdiRelay* relay, const NDIlib_video_frame_v2_t* frame, void* owner);
+
+/*
+ * Republish audio while the source is advertised. The SDK copies it before returning. Returns
+ * true if it was sent.
+ */
+bool ndi_relay_send_audio(NdiRelay* relay, const NDIlib_audio_frame_v2_t* frame);
+
+void ndi_relay_get_stats(NdiRelay* relay, NdiRelayStats* stats);
+
+#endif /* NDI_RELAY_H */
@@ -0,0 +1,112 @@
+/**
+ * ndi_runtime.c - Runtime loading of the NDI SDK through its dynamic-load function table
+ */
+
+#include "ndi_runtime.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef const NDIlib_v6* (*NdiLoadFn)(void);
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+
+static void set_error(char* error, size_t error_cap, const char* what, const char* detail) {
+    if (error != NULL && error_cap > 0) {
+        snprintf(error, error_cap, "%s%s%s", what, detail != NULL ? ": " : "", detail != NULL ? detail : "");
+    }
+}
+
+/* Name of the first table entry the wrapper calls that the library left NULL, or NULL. */
+static const char* missing_entry(const NDIlib_v6* api) {
+#define REQUIRE(entry) if (api->entry == NULL) return #entry
+    REQUIRE(initialize);
+    REQUIRE(destroy);
+    REQUIRE(version);
+    REQUIRE(find_create_v2);
+    REQUIRE(find_destroy);
+    REQUIRE(find_get_current_sources);
+    REQUIRE(find_wait_for_sources);
+    REQUIRE(recv_create_v3);
+    REQUIRE(recv_destroy);
+    REQUIRE(recv_connect);
+    REQUIRE(recv_capture_v2);
+    REQUIRE(recv_free_video_v2);
+    REQUIRE(recv_free_audio_v2);
+    REQUIRE(recv_free_metadata);
+    REQUIRE(recv_get_performance);
+    REQUIRE(recv_get_queue);
+    REQUIRE(recv_get_no_connections);
+#undef REQUIRE
+    return NULL;
+}
+
+const char* ndi_runtime_resolve_path(const char* path) {
+    if (path != NULL && path[0] != '\0') {
+        return path;
+    }
+    const char* env = getenv(NDI_RUNTIME_PATH_ENV);
+    if (env != NULL && env[0] != '\0') {
+        return env;
+    }
+    return NDI_RUNTIME_DEFAULT_LIBRARY;
+}
+
+bool ndi_runtime_open(NdiRuntime* rt, const char* path, char* error, size_t error_cap) {
+    if (rt == NULL) {
+        return false;
+    }
+    memset(rt, 0, sizeof(*rt));
+    path = ndi_runtime_resolve_path(path);
+
+    const int64_t start = monotonic_ns();
+    void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    const int64_t opened = monotonic_ns();
+    if (handle == NULL) {
+        set_error(error, error_cap, "dlopen failed", dlerror());
+        return false;
+    }
+
+    NdiLoadFn load = NULL;
+    /* Object to function pointer conversion goes through memcpy to stay within ISO C. */
+    void* symbol = dlsym(handle, "NDIlib_v6_load");
+    if (symbol != NULL) {
+        memcpy(&load, &symbol, sizeof(load));
+    }
+    const NDIlib_v6* api = (load != NULL) ? load() : NULL;
+    const int64_t resolved = monotonic_ns();
+
+    const char* missing = (api != NULL) ? missing_entry(api) : NULL;
+    if (api == NULL || missing != NULL) {
+        if (load == NULL) {
+            set_error(error, error_cap, "NDIlib_v6_load not exported", path);
+        } else if (api == NULL) {
+            set_error(error, error_cap, "NDIlib_v6_load returned NULL", path);
+        } else {
+            set_error(error, error_cap, "Function table entry missing", missing);
+        }
+        dlclose(handle);
+        return false;
+    }
+
+    rt->handle = handle;
+    rt->api = api;
+    rt->open_ns = opened - start;
+    rt->resolve_ns = resolved - opened;
+    return true;
+}
+
+void ndi_runtime_close(NdiRuntime* rt) {
+    if (rt == NULL || rt->handle == NULL) {
+        return;
+    }
+    dlclose(rt->handle);
+    memset(rt, 0, sizeof(*rt));
+}
@@ -0,0 +1,48 @@
+/**
+ * ndi_runtime.h - Runtime loading of the NDI SDK through its dynamic-load function table
+ *
+ * No JNI dependency; needs only the SDK headers and dlopen, so it builds and is tested on the
+ * host against a stub library. The SDK is opened with dlopen and entered through the
+ * NDIlib_v6 table that NDIlib_v6_load returns, so nothing links against libndi and its
+ * static initializers run when the runtime is first needed rather than at library load.
+ */
+
+#ifndef NDI_RUNTIME_H
+#define NDI_RUNTIME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Processing.NDI.Lib.h"
+
+/* Library opened when no path is given: the copy packaged with the app. */
+#define NDI_RUNTIME_DEFAULT_LIBRARY "libndi.so"
+
+/* Environment variable overriding the default library (e.g. a stub on the host). */
+#define NDI_RUNTIME_PATH_ENV "NDI_RUNTIME_PATH"
+
+typedef struct NdiRuntime {
+    void* handle;
+    const NDIlib_v6* api;
+    int64_t open_ns;      /* dlopen, including the SDK's static initializers. */
+    int64_t resolve_ns;   /* NDIlib_v6_load. */
+} NdiRuntime;
+
+/*
+ * Library to open: path if non-empty, else $NDI_RUNTIME_PATH if set, else
+ * NDI_RUNTIME_DEFAULT_LIBRARY.
+ */
+const char* ndi_runtime_resolve_path(const char* path);
+
+/*
+ * Open the SDK at path (see ndi_runtime_resolve_path) and fetch its function table. Fails if
+ * the library or NDIlib_v6_load is missing, or the table lacks an entry the receiver uses;
+ * error (if non-NULL) then describes why. rt is left zeroed on failure.
+ */
+bool ndi_runtime_open(NdiRuntime* rt, const char* path, char* error, size_t error_cap);
+
+/* Close a runtime opened by ndi_runtime_open. The SDK must have been destroyed first. */
+void ndi_runtime_close(NdiRuntime* rt);
+
+#endif /* NDI_RUNTIME_H */
@@ -0,0 +1,201 @@
+/**
+ * ndi_trace.c - Per-thread trace event buffers written as Chrome trace JSON
+ *
+ * A thread's buffer is allocated on its first event and pushed onto a global list with a
+ * compare-and-swap. Only the owning thread writes a buffer; it stores the event and then
+ * publishes it by a release store of the count, so a dump reads every counted event whole.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "ndi_trace.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#define THREAD_NAME_LEN 16
+
+typedef struct TraceEvent {
+    const char* name;
+    int64_t ts_ns;
+    int64_t value;
+    char phase;   /* Chrome trace phase: 'B', 'E', 'i' or 'C'. */
+} TraceEvent;
+
+typedef struct TraceBuffer {
+    struct TraceBuffer* next;
+    uint32_t tid;
+    char thread_name[THREAD_NAME_LEN];
+    atomic_size_t count;
+    atomic_size_t dropped;
+    TraceEvent events[NDI_TRACE_BUFFER_EVENTS];
+} TraceBuffer;
+
+static _Atomic(TraceBuffer*) g_buffers = NULL;
+#if !defined(__linux__)
+static atomic_uint g_next_tid = 1;
+#endif
+static atomic_bool g_exit_dump_registered = false;
+static _Thread_local TraceBuffer* t_buffer = NULL;
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+static void dump_at_exit(void) {
+    const char* path = getenv(NDI_TRACE_FILE_ENV);
+    if (path != NULL && path[0] != '\0') {
+        ndi_trace_write_json(path);
+    }
+}
+
+static TraceBuffer* thread_buffer(void) {
+    if (t_buffer != NULL) {
+        return t_buffer;
+    }
+    TraceBuffer* buffer = (TraceBuffer*)calloc(1, sizeof(TraceBuffer));
+    if (buffer == NULL) {
+        return NULL;
+    }
+#if defined(__linux__)
+    buffer->tid = (uint32_t)syscall(SYS_gettid);
+    pthread_getname_np(pthread_self(), buffer->thread_name, sizeof(buffer->thread_name));
+#else
+    buffer->tid = atomic_fetch_add(&g_next_tid, 1);
+#endif
+
+    TraceBuffer* head = atomic_load(&g_buffers);
+    do {
+        buffer->next = head;
+    } while (!atomic_compare_exchange_weak(&g_buffers, &head, buffer));
+    t_buffer = buffer;
+
+    if (!atomic_exchange(&g_exit_dump_registered, true) && getenv(NDI_TRACE_FILE_ENV) != NULL) {
+        atexit(dump_at_exit);
+    }
+    return buffer;
+}
+
+static void record(char phase, const char* name, int64_t value) {
+    TraceBuffer* buffer = thread_buffer();
+    if (buffer == NULL) {
+        return;
+    }
+    const size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    if (count >= NDI_TRACE_BUFFER_EVENTS) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    TraceEvent* event = &buffer->events[count];
+    event->name = name;
+    event->ts_ns = monotonic_ns();
+    event->value = value;
+    event->phase = phase;
+    atomic_store_explicit(&buffer->count, count + 1, memory_order_release);
+}
+
+/* Write text as a JSON string, quotes included. */
+static void write_json_string(FILE* f, const char* text) {
+    fputc('"', f);
+    for (const unsigned char* p = (const unsigned char*)text; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', f);
+            fputc(*p, f);
+        } else if (*p < 0x20) {
+            fprintf(f, "\\u%04x", *p);
+        } else {
+            fputc(*p, f);
+        }
+    }
+    fputc('"', f);
+}
+
+void ndi_trace_begin(const char* name) {
+    record('B', name, 0);
+}
+
+void ndi_trace_end(void) {
+    record('E', NULL, 0);
+}
+
+void ndi_trace_instant(const char* name) {
+    record('i', name, 0);
+}
+
+void ndi_trace_counter(const char* name, int64_t value) {
+    record('C', name, value);
+}
+
+size_t ndi_trace_event_count(void) {
+    size_t total = 0;
+    for (TraceBuffer* b = atomic_load(&g_buffers); b != NULL; b = b->next) {
+        total += atomic_load_explicit(&b->count, memory_order_acquire);
+    }
+    return total;
+}
+
+size_t ndi_trace_dropped_count(void) {
+    size_t total = 0;
+    for (TraceBuffer* b = atomic_load(&g_buffers); b != NULL; b = b->next) {
+        total += atomic_load_explicit(&b->dropped, memory_order_relaxed);
+    }
+    return total;
+}
+
+void ndi_trace_reset(void) {
+    for (TraceBuffer* b = atomic_load(&g_buffers); b != NULL; b = b->next) {
+        atomic_store(&b->count, 0);
+        atomic_store(&b->dropped, 0);
+    }
+}
+
+bool ndi_trace_write_json(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        return false;
+    }
+    const int pid = (int)getpid();
+    bool first = true;
+    fputs("{\"traceEvents\":[\n", f);
+    for (TraceBuffer* b = atomic_load(&g_buffers); b != NULL; b = b->next) {
+        if (b->thread_name[0] != '\0') {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+                    first ? "" : ",\n", pid, b->tid);
+            write_json_string(f, b->thread_name);
+            fputs("}}", f);
+            first = false;
+        }
+        const size_t count = atomic_load_explicit(&b->count, memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const TraceEvent* e = &b->events[i];
+            /* Microseconds with nanosecond digits. */
+            fprintf(f, "%s{\"ph\":\"%c\",\"ts\":%lld.%03lld,\"pid\":%d,\"tid\":%u",
+                    first ? "" : ",\n", e->phase,
+                    (long long)(e->ts_ns / 1000), (long long)(e->ts_ns % 1000), pid, b->tid);
+            first = false;
+            if (e->name != NULL) {
+                fputs(",\"name\":", f);
+                write_json_string(f, e->name);
+            }
+            if (e->phase == 'i') {
+                fputs(",\"s\":\"t\"", f);
+            } else if (e->phase == 'C') {
+                fprintf(f, ",\"args\":{\"value\":%lld}", (long long)e->value);
+            }
+            fputc('}', f);
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+    return fclose(f) == 0;
+}
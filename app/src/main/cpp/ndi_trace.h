@@ -0,0 +1,76 @@
+/**
+ * ndi_trace.h - Compile-time trace points for the native receive pipeline
+ *
+ * Trace points are compiled in only when NDI_TRACE is defined (CMake option NDI_TRACE). Without
+ * it every macro expands to ((void)0) and its arguments are not evaluated, so instrumented code
+ * is unchanged. With it:
+ *   - on Android they are ATrace sections and counters, shown by Perfetto or systrace next to
+ *     the Java sections of the app and the SDK's own threads;
+ *   - on the host they go to a per-thread event buffer and are written as Chrome trace JSON
+ *     (chrome://tracing, ui.perfetto.dev) by ndi_trace_write_json(), or at exit to the file
+ *     named by the NDI_TRACE_FILE environment variable.
+ *
+ * Names must be string literals (only the pointer is kept) without quotes or backslashes.
+ * Sections nest and must begin and end on the same thread.
+ */
+
+#ifndef NDI_TRACE_H
+#define NDI_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NDI_TRACE_BUFFER_EVENTS 16384   /* Per thread; events past this are counted and dropped. */
+#define NDI_TRACE_FILE_ENV "NDI_TRACE_FILE"
+
+#if defined(NDI_TRACE) && defined(__ANDROID__)
+
+#include <android/trace.h>
+
+#define NDI_TRACE_BEGIN(name) ATrace_beginSection(name)
+#define NDI_TRACE_END() ATrace_endSection()
+#define NDI_TRACE_INSTANT(name) (ATrace_beginSection(name), ATrace_endSection())
+#if __ANDROID_API__ >= 29
+#define NDI_TRACE_COUNTER(name, value) ATrace_setCounter((name), (int64_t)(value))
+#else
+#define NDI_TRACE_COUNTER(name, value) ((void)0)
+#endif
+
+#elif defined(NDI_TRACE)
+
+#define NDI_TRACE_BEGIN(name) ndi_trace_begin(name)
+#define NDI_TRACE_END() ndi_trace_end()
+#define NDI_TRACE_INSTANT(name) ndi_trace_instant(name)
+#define NDI_TRACE_COUNTER(name, value) ndi_trace_counter((name), (int64_t)(value))
+
+#else
+
+#define NDI_TRACE_BEGIN(name) ((void)0)
+#define NDI_TRACE_END() ((void)0)
+#define NDI_TRACE_INSTANT(name) ((void)0)
+#define NDI_TRACE_COUNTER(name, value) ((void)0)
+
+#endif
+
+/*
+ * Host event buffer behind the macros. Recording is lock-free: each thread appends to its own
+ * buffer, which is published once on a global list and kept until exit so a dump still sees
+ * threads that have finished.
+ */
+void ndi_trace_begin(const char* name);
+void ndi_trace_end(void);
+void ndi_trace_instant(const char* name);
+void ndi_trace_counter(const char* name, int64_t value);
+
+/* Events recorded and still buffered, and events dropped because a buffer was full. */
+size_t ndi_trace_event_count(void);
+size_t ndi_trace_dropped_count(void);
+
+/* Forget all buffered events. Only while no thread is recording. */
+void ndi_trace_reset(void);
+
+/* Write every buffered event as Chrome trace JSON. Returns false if the file can't be written. */
+bool ndi_trace_write_json(const char* path);
+
+#endif /* NDI_TRACE_H */
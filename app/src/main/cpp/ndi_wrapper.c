@@ -13,14 +13,43 @@
 #include <android/log.h>
 #include <android/native_window.h>
 #include <android/native_window_jni.h>
+#include <errno.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/system_properties.h>
+#include <time.h>
 
 #include "Processing.NDI.Lib.h"
+#include "bandwidth_controller.h"
+#include "capture_scheduler.h"
+#include "deinterlace.h"
+#include "frame_arena.h"
+#include "frame_pacer.h"
+#include "frame_scaler.h"
+#include "jitter_buffer.h"
+#include "latency_histogram.h"
+#include "latest_frame.h"
+#include "metadata_inbox.h"
+#include "mp4_probe.h"
+#include "multiview.h"
+#include "ndi_relay.h"
+#include "ndi_runtime.h"
+#include "ndi_trace.h"
+#include "pixel_convert.h"
+#include "receiver_stats.h"
+#include "source_cache.h"
+#include "source_list.h"
+#include "stage_profiler.h"
+#include "thread_placement.h"
+#include "thumbnail.h"
+#include "transport_probe.h"
+#include "transport_profile.h"
 
 /* Logging Macros */
 #define LOG_TAG "NdiNative"
@@ -40,29 +69,141 @@ static const uint32_t FOURCC_HEVC = 0x43564548; /* 'HEVC' */
 static pthread_mutex_t g_init_mutex = PTHREAD_MUTEX_INITIALIZER;
 static volatile int g_initialized = 0;
 
+/*
+ * Finders, receivers, previews and transport probes each count as a user of the SDK from create
+ * to destroy. destroy() refuses while there are users, since their instances would be torn
+ * down under them. Guarded by g_init_mutex.
+ */
+static int g_sdk_users = 0;
+
+/* The transport configuration directory, set in the environment once before initializing. */
+static char* g_config_dir = NULL;
+
+/*
+ * The SDK is opened by initialize() and called through its function table, so loading this
+ * wrapper does not load libndi. It stays open after destroy() so re-initializing is cheap.
+ */
+#define RUNTIME_PATH_PROPERTY "debug.ndi.runtime_path"
+static NdiRuntime g_runtime;
+static const NDIlib_v6* g_ndi = NULL;
+
 static pthread_mutex_t g_jni_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int g_jni_cache_initialized = 0;
+static jclass g_class_String = NULL;
 static jclass g_class_VideoFrame = NULL;
 static jmethodID g_ctor_VideoFrame = NULL;
 static jclass g_class_AudioFrame = NULL;
 static jmethodID g_ctor_AudioFrame = NULL;
 static jclass g_class_ReceiverPerformance = NULL;
 static jmethodID g_ctor_ReceiverPerformance = NULL;
+static jclass g_class_PacerStats = NULL;
+static jmethodID g_ctor_PacerStats = NULL;
+static jclass g_class_ArenaStats = NULL;
+static jmethodID g_ctor_ArenaStats = NULL;
+static jclass g_class_PlacedThread = NULL;
+static jmethodID g_ctor_PlacedThread = NULL;
+static jclass g_class_ThreadPlacementStats = NULL;
+static jmethodID g_ctor_ThreadPlacementStats = NULL;
+static jclass g_class_ThreadCpu = NULL;
+static jmethodID g_ctor_ThreadCpu = NULL;
+static jclass g_class_StageStats = NULL;
+static jmethodID g_ctor_StageStats = NULL;
+static jclass g_class_MetadataEvent = NULL;
+static jmethodID g_ctor_MetadataEvent = NULL;
+static jclass g_class_RelayStats = NULL;
+static jmethodID g_ctor_RelayStats = NULL;
+static jclass g_class_TransportProbeResult = NULL;
+static jmethodID g_ctor_TransportProbeResult = NULL;
+static jclass g_class_Mp4Info = NULL;
+static jmethodID g_ctor_Mp4Info = NULL;
+static jclass g_class_LatencyStats = NULL;
+static jmethodID g_ctor_LatencyStats = NULL;
+static jclass g_class_ReceiverStats = NULL;
+static jmethodID g_ctor_ReceiverStats = NULL;
+static jclass g_class_BandwidthStats = NULL;
+static jmethodID g_ctor_BandwidthStats = NULL;
+static jclass g_class_SchedulerSourceStats = NULL;
+static jmethodID g_ctor_SchedulerSourceStats = NULL;
+static jclass g_class_MultiviewStats = NULL;
+static jmethodID g_ctor_MultiviewStats = NULL;
+static jclass g_class_MultiviewTileStats = NULL;
+static jmethodID g_ctor_MultiviewTileStats = NULL;
+static jclass g_class_SourceChange = NULL;
+static jmethodID g_ctor_SourceChange = NULL;
+static jclass g_class_CachedSource = NULL;
+static jmethodID g_ctor_CachedSource = NULL;
+
+/* Process-wide frame memory arena shared by every receiver and Java consumer. */
+static pthread_once_t g_arena_once = PTHREAD_ONCE_INIT;
+static FrameArena* g_arena = NULL;
+
+/* Process-wide pipeline thread placement; threads register themselves by role. */
+#define CORE_MAP_PROPERTY "debug.ndi.core_map"
+static pthread_once_t g_placement_once = PTHREAD_ONCE_INIT;
+static ThreadPlacement* g_placement = NULL;
+static CpuTopology g_topology;
+static volatile bool g_placement_enabled = false;
+
+/* Process-wide stage timing; marks are per thread so stages on different threads can overlap. */
+#define STAGE_STATS_MAX_THREADS 16
+static pthread_once_t g_profiler_once = PTHREAD_ONCE_INIT;
+static StageProfiler* g_profiler = NULL;
+static _Thread_local StageMark g_stage_marks[PIPELINE_STAGE_COUNT];
+#if defined(NDI_TRACE)
+static const char* const g_stage_trace_names[PIPELINE_STAGE_COUNT] = {
+    "capture", "convert", "render", "decode submit", "mux",
+};
+#endif
+
+/* Process-wide glass-to-glass latency, measured from each frame's capture stamp. */
+static pthread_once_t g_latency_once = PTHREAD_ONCE_INIT;
+static LatencyTracker* g_latency = NULL;
+
+/*
+ * Known sources and their URL addresses, kept across runs; NULL until sourceCacheOpen. Once
+ * opened it stays open for the life of the process.
+ */
+static pthread_mutex_t g_source_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static SourceCache* g_source_cache = NULL;
+
+/* A receiver connected by cached URL falls back to resolving the name after this long without a connection. */
+#define URL_CONNECT_TIMEOUT_NS (3000LL * 1000000LL)
 
 typedef struct NdiFinderWrapper {
     NDIlib_find_instance_t finder;
     pthread_mutex_t mutex;
+    SourceList* reported;   /* What finderWaitForChanges last returned, diffed against. */
+    bool primed;            /* reported was filled at least once. */
 } NdiFinderWrapper;
 
 typedef struct NdiReceiverWrapper {
     NDIlib_recv_instance_t recv;
     pthread_mutex_t mutex;
     ANativeWindow* surface_window;
+    jint color_format;                    /* Kotlin ColorFormat requested at create time. */
+    volatile uint32_t last_video_fourcc;  /* FourCC of the most recent captured video frame. */
+    Deinterlacer* deinterlacer;           /* Used on the capture thread only (mode may be set anywhere). */
+    JitterBuffer* jitter;                 /* Holds NdiVideoFrameHandle* until their playout time. */
+    int64_t target_latency_ns;            /* Requested jitter budget; not applied in low-latency mode. */
+    volatile bool low_latency;            /* Drain the SDK queue and keep only the newest frames. */
+    uint64_t skipped_frames;              /* Stale frames discarded by low-latency mode (under mutex). */
+    int queue_depth;                      /* SDK video queue depth after the last capture (under mutex). */
+    ReceiverStats* stats;                 /* Rolling stream statistics (has its own lock). */
+    CaptureScheduler* scheduler;          /* Captures for this receiver, or NULL (see schedulerAdd). */
+    MetadataInbox* metadata;              /* Subscribed elements of metadata captured with video. */
+    pthread_mutex_t relay_mutex;          /* Guards relay; taken before mutex, never after. */
+    NdiRelay* relay;                      /* Republishes captured frames, or NULL. */
+    char* source_name;                    /* Source of the last connect, or NULL (under mutex). */
+    char* source_url;                     /* Cached URL address it was connected at, or NULL (under mutex). */
+    int64_t connect_ns;                   /* When it was connected (under mutex). */
+    volatile bool awaiting_video;         /* Connected, and no video captured since. */
 } NdiReceiverWrapper;
 
 typedef struct NdiVideoFrameHandle {
     NDIlib_recv_instance_t recv;
     NDIlib_video_frame_v2_t frame;
+    int64_t captured_ns;   /* CLOCK_MONOTONIC when recv_capture_v2 returned the frame. */
+    int refs;   /* The capturer's, plus the relay's while the SDK sends from it (under mutex). */
 } NdiVideoFrameHandle;
 
 typedef struct NdiAudioFrameHandle {
@@ -134,6 +275,532 @@ static NDIlib_recv_color_format_e map_color_format(jint colorFormat) {
     }
 }
 
+/*
+ * Size of the pixel data behind p_data for uncompressed frames. Planar formats carry
+ * additional planes after the first one, all sharing (a fraction of) line_stride_in_bytes.
+ */
+static jlong uncompressed_frame_size(const NDIlib_video_frame_v2_t* frame) {
+    const jlong stride = (jlong)frame->line_stride_in_bytes;
+    const jlong abs_stride = (stride < 0) ? -stride : stride;
+    const jlong yres = (jlong)frame->yres;
+    const jlong plane = abs_stride * yres;
+
+    switch (frame->FourCC) {
+        case NDIlib_FourCC_video_type_NV12:
+        case NDIlib_FourCC_video_type_I420:
+        case NDIlib_FourCC_video_type_YV12:
+            /* Full-size luma plus 4:2:0 chroma (one interleaved or two half-stride planes). */
+            return plane + (abs_stride * ((yres + 1) / 2));
+        case NDIlib_FourCC_video_type_UYVA:
+            /* Packed UYVY followed by an 8-bit alpha plane of xres bytes per line. */
+            return plane + ((jlong)frame->xres * yres);
+        case NDIlib_FourCC_video_type_P216:
+            /* 16-bit Y plane followed by a full-height interleaved 16-bit UV plane. */
+            return plane * 2;
+        case NDIlib_FourCC_video_type_PA16:
+            /* P216 plus a 16-bit alpha plane. */
+            return plane * 3;
+        default:
+            return plane;
+    }
+}
+
+/*
+ * Run an interlaced or single-field frame through the receiver's deinterlacer.
+ * Returns false when the frame should be handed out as captured.
+ */
+static bool deinterlace_frame(
+        NdiReceiverWrapper* wrapper,
+        const NDIlib_video_frame_v2_t* frame,
+        DeinterlaceOutput* out) {
+    if (wrapper->deinterlacer == NULL || frame->line_stride_in_bytes <= 0) {
+        return false;
+    }
+
+    DeinterlaceField field;
+    switch (frame->frame_format_type) {
+        case NDIlib_frame_format_type_interleaved:
+            field = DEINTERLACE_INTERLEAVED;
+            break;
+        case NDIlib_frame_format_type_field_0:
+            field = DEINTERLACE_FIELD_0;
+            break;
+        case NDIlib_frame_format_type_field_1:
+            field = DEINTERLACE_FIELD_1;
+            break;
+        default:
+            return false;
+    }
+
+    const DeinterlaceInput in = {
+        .data = frame->p_data,
+        .fourcc = (uint32_t)frame->FourCC,
+        .width = frame->xres,
+        .height = frame->yres,
+        .stride = frame->line_stride_in_bytes,
+        .field = field,
+    };
+    NDI_TRACE_BEGIN("deinterlace");
+    const bool processed = deinterlacer_process(wrapper->deinterlacer, &in, out);
+    NDI_TRACE_END();
+    return processed;
+}
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+static int64_t wall_clock_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+static SourceCache* get_source_cache(void) {
+    pthread_mutex_lock(&g_source_cache_mutex);
+    SourceCache* cache = g_source_cache;
+    pthread_mutex_unlock(&g_source_cache_mutex);
+    return cache;
+}
+
+static void create_arena(void) {
+    g_arena = frame_arena_create(FRAME_ARENA_DEFAULT_BUDGET);
+    if (g_arena == NULL) {
+        LOGE("Failed to create frame arena");
+    }
+}
+
+/* The arena lives for the whole process; NULL only if it could not be created. */
+static FrameArena* get_arena(void) {
+    pthread_once(&g_arena_once, create_arena);
+    return g_arena;
+}
+
+static void create_placement(void) {
+    if (!cpu_topology_detect(THREAD_PLACEMENT_SYSFS_CPU, &g_topology)) {
+        LOGW("Could not read CPU topology; thread placement unavailable");
+        return;
+    }
+    ThreadPlacementConfig config;
+    thread_placement_default_config(&g_topology, &config);
+    g_placement = thread_placement_create(&g_topology, &config);
+    if (g_placement == NULL) {
+        LOGE("Failed to create thread placement");
+        return;
+    }
+    LOGI("CPU topology: %d cpus, big 0x%" PRIx64 ", little 0x%" PRIx64,
+         g_topology.cpu_count, g_topology.big_mask, g_topology.little_mask);
+}
+
+static ThreadPlacement* get_placement(void) {
+    pthread_once(&g_placement_once, create_placement);
+    return g_placement;
+}
+
+static void create_profiler(void) {
+    g_profiler = stage_profiler_create();
+    if (g_profiler == NULL) {
+        LOGE("Failed to create stage profiler");
+    }
+}
+
+static StageProfiler* get_profiler(void) {
+    pthread_once(&g_profiler_once, create_profiler);
+    return g_profiler;
+}
+
+static void create_latency(void) {
+    g_latency = latency_tracker_create();
+    if (g_latency == NULL) {
+        LOGE("Failed to create latency tracker");
+    }
+}
+
+static LatencyTracker* get_latency(void) {
+    pthread_once(&g_latency_once, create_latency);
+    return g_latency;
+}
+
+/* Caller holds wrapper->mutex. The frame goes back to the SDK with its last reference. */
+static void unref_video_handle_locked(NdiVideoFrameHandle* handle) {
+    if (--handle->refs > 0) {
+        return;
+    }
+    NDI_TRACE_BEGIN("recv_free_video");
+    g_ndi->recv_free_video_v2(handle->recv, &handle->frame);
+    NDI_TRACE_END();
+    free(handle);
+}
+
+static void free_video_handle(NdiReceiverWrapper* wrapper, NdiVideoFrameHandle* handle) {
+    pthread_mutex_lock(&wrapper->mutex);
+    unref_video_handle_locked(handle);
+    pthread_mutex_unlock(&wrapper->mutex);
+}
+
+/*
+ * Metadata frames arrive from the same capture call as video. They are tokenized straight out
+ * of the SDK's buffer into the inbox and released, so only subscribed events outlive the call.
+ */
+static void consume_metadata(NdiReceiverWrapper* wrapper, NDIlib_metadata_frame_t* metadata) {
+    if (metadata->p_data != NULL) {
+        const size_t length = (metadata->length > 0) ? (size_t)metadata->length : strlen(metadata->p_data);
+        metadata_inbox_feed(wrapper->metadata, metadata->p_data, length, metadata->timecode);
+    }
+    pthread_mutex_lock(&wrapper->mutex);
+    g_ndi->recv_free_metadata(wrapper->recv, metadata);
+    pthread_mutex_unlock(&wrapper->mutex);
+}
+
+static bool is_compressed_fourcc(uint32_t fourcc) {
+    return (fourcc == FOURCC_H264) || (fourcc == FOURCC_HEVC);
+}
+
+static bool is_random_access(const NDIlib_video_frame_v2_t* frame) {
+    return latest_frame_is_random_access(frame->p_data, (size_t)frame->data_size_in_bytes,
+                                         (uint32_t)frame->FourCC == FOURCC_HEVC);
+}
+
+/* Hand the frame to the jitter buffer, which drops compressed frames whose reference was lost. */
+static void push_video_handle(NdiReceiverWrapper* wrapper, NdiVideoFrameHandle* handle) {
+    const NDIlib_video_frame_v2_t* frame = &handle->frame;
+    JitterFrameKind kind = JITTER_FRAME_INDEPENDENT;
+    if (is_compressed_fourcc((uint32_t)frame->FourCC)) {
+        kind = is_random_access(frame) ? JITTER_FRAME_KEY : JITTER_FRAME_DELTA;
+    }
+    void* discarded[JITTER_BUFFER_MAX_DISCARDS];
+    const int count = jitter_buffer_push(wrapper->jitter, handle, kind, frame->timestamp,
+                                         handle->captured_ns, discarded);
+    for (int i = 0; i < count; i++) {
+        free_video_handle(wrapper, (NdiVideoFrameHandle*)discarded[i]);
+    }
+}
+
+/* Bytes of video payload the SDK delivered with the frame. */
+static size_t video_payload_bytes(const NDIlib_video_frame_v2_t* frame) {
+    const jlong size = is_compressed_fourcc((uint32_t)frame->FourCC)
+        ? (jlong)frame->data_size_in_bytes
+        : uncompressed_frame_size(frame);
+    return (size > 0) ? (size_t)size : 0;
+}
+
+/* A capture call that began at call_start_ns returned the frame in handle. */
+static void record_video_arrival(NdiReceiverWrapper* wrapper, const NdiVideoFrameHandle* handle,
+                                 int64_t call_start_ns) {
+    receiver_stats_capture_call(wrapper->stats, handle->captured_ns - call_start_ns, handle->captured_ns);
+    receiver_stats_frame(wrapper->stats, handle->captured_ns, video_payload_bytes(&handle->frame));
+}
+
+/* Sample the SDK queue depths after a capture. Returns the video frames still queued. */
+static int sample_queue(NdiReceiverWrapper* wrapper) {
+    NDIlib_recv_queue_t queue;
+    memset(&queue, 0, sizeof(queue));
+    pthread_mutex_lock(&wrapper->mutex);
+    g_ndi->recv_get_queue(wrapper->recv, &queue);
+    wrapper->queue_depth = queue.video_frames;
+    pthread_mutex_unlock(&wrapper->mutex);
+    receiver_stats_queue(wrapper->stats, queue.video_frames, queue.audio_frames, queue.metadata_frames,
+                         monotonic_ns());
+    return queue.video_frames;
+}
+
+/*
+ * Low-latency mode: after a capture, drain the video frames the SDK has queued behind it
+ * and keep only the newest usable ones (latest frame for uncompressed video, everything
+ * from the newest random access point for compressed video). Kept frames go through the
+ * jitter buffer, which has a zero target in this mode, so they are returned in order.
+ */
+static void drain_to_latest(NdiReceiverWrapper* wrapper, NdiVideoFrameHandle* first) {
+    NdiVideoFrameHandle* run[LATEST_FRAME_MAX_RUN];
+    bool random_access[LATEST_FRAME_MAX_RUN];
+    int count = 0;
+    run[count++] = first;
+
+    for (int queued = sample_queue(wrapper); queued > 0 && count < LATEST_FRAME_MAX_RUN; queued--) {
+        NdiVideoFrameHandle* handle = (NdiVideoFrameHandle*)calloc(1, sizeof(NdiVideoFrameHandle));
+        if (handle == NULL) {
+            break;
+        }
+        handle->recv = wrapper->recv;
+        handle->refs = 1;
+
+        NDIlib_metadata_frame_t metadata;
+        const int64_t call_start = monotonic_ns();
+        NDI_TRACE_BEGIN("recv_capture drain");
+        pthread_mutex_lock(&wrapper->mutex);
+        const NDIlib_frame_type_e frame_type = g_ndi->recv_capture_v2(wrapper->recv, &handle->frame, NULL, &metadata, 0);
+        pthread_mutex_unlock(&wrapper->mutex);
+        NDI_TRACE_END();
+        handle->captured_ns = monotonic_ns();
+
+        if (frame_type == NDIlib_frame_type_metadata) {
+            /* Interleaved metadata does not end the run, but counts against its bound. */
+            consume_metadata(wrapper, &metadata);
+            free(handle);
+            continue;
+        }
+        if (frame_type != NDIlib_frame_type_video) {
+            free(handle);
+            break;
+        }
+        if (handle->frame.p_data == NULL) {
+            free_video_handle(wrapper, handle);
+            continue;
+        }
+        /* Frames skipped below still arrived, so they count towards rate and bitrate. */
+        record_video_arrival(wrapper, handle, call_start);
+        run[count++] = handle;
+    }
+
+    /* A format change inside the run (e.g. the sender switched codecs) only keeps the newest. */
+    const uint32_t fourcc = (uint32_t)run[count - 1]->frame.FourCC;
+    bool compressed = is_compressed_fourcc(fourcc);
+    for (int i = 0; i < count; i++) {
+        const NDIlib_video_frame_v2_t* frame = &run[i]->frame;
+        if ((uint32_t)frame->FourCC != fourcc) {
+            compressed = false;
+        }
+        random_access[i] = compressed && is_random_access(frame);
+    }
+
+    const LatestFramePlan plan = latest_frame_plan(random_access, count, compressed);
+    uint64_t skipped = (uint64_t)plan.first_kept;
+    if (plan.flush_held) {
+        NdiVideoFrameHandle* held;
+        while ((held = (NdiVideoFrameHandle*)jitter_buffer_drain(wrapper->jitter)) != NULL) {
+            free_video_handle(wrapper, held);
+            skipped++;
+        }
+    }
+    for (int i = 0; i < plan.first_kept; i++) {
+        free_video_handle(wrapper, run[i]);
+    }
+    for (int i = plan.first_kept; i < count; i++) {
+        push_video_handle(wrapper, run[i]);
+    }
+
+    if (skipped > 0) {
+        pthread_mutex_lock(&wrapper->mutex);
+        wrapper->skipped_frames += skipped;
+        pthread_mutex_unlock(&wrapper->mutex);
+    }
+}
+
+static NdiVideoFrameHandle* new_video_handle(NdiReceiverWrapper* wrapper) {
+    NdiVideoFrameHandle* handle = (NdiVideoFrameHandle*)calloc(1, sizeof(NdiVideoFrameHandle));
+    if (handle != NULL) {
+        handle->recv = wrapper->recv;
+        handle->refs = 1;
+    }
+    return handle;
+}
+
+/*
+ * Follow a new connection after a capture: the first video marks the source as connected in
+ * the source cache, and a cached URL address that has not connected in time is given up for
+ * name resolution (and forgotten, unless discovery has replaced it meanwhile).
+ */
+static void track_connection(NdiReceiverWrapper* wrapper, bool got_video) {
+    if (!wrapper->awaiting_video) {
+        return;
+    }
+    SourceCache* cache = get_source_cache();
+
+    pthread_mutex_lock(&wrapper->mutex);
+    if (!wrapper->awaiting_video || wrapper->source_name == NULL) {
+        pthread_mutex_unlock(&wrapper->mutex);
+        return;
+    }
+    if (got_video) {
+        wrapper->awaiting_video = false;
+        if (cache != NULL) {
+            source_cache_connected(cache, wrapper->source_name, wall_clock_ms());
+        }
+    } else if (wrapper->source_url != NULL &&
+               monotonic_ns() - wrapper->connect_ns >= URL_CONNECT_TIMEOUT_NS &&
+               g_ndi->recv_get_no_connections(wrapper->recv) == 0) {
+        LOGW("No connection to %s at %s, resolving its name instead", wrapper->source_name, wrapper->source_url);
+        NDIlib_source_t source;
+        memset(&source, 0, sizeof(source));
+        source.p_ndi_name = wrapper->source_name;
+        g_ndi->recv_connect(wrapper->recv, &source);
+        if (cache != NULL) {
+            source_cache_url_failed(cache, wrapper->source_name, wrapper->source_url);
+        }
+        free(wrapper->source_url);
+        wrapper->source_url = NULL;
+    }
+    pthread_mutex_unlock(&wrapper->mutex);
+}
+
+/*
+ * Capture once into handle, waiting up to wait_ms, and put a video frame into the jitter buffer
+ * (through drain_to_latest in low-latency mode). Metadata goes to the inbox. Returns the frame
+ * type; handle is consumed only for NDIlib_frame_type_video.
+ */
+static NDIlib_frame_type_e capture_into_jitter(NdiReceiverWrapper* wrapper, NdiVideoFrameHandle* handle,
+                                               uint32_t wait_ms) {
+    NDIlib_metadata_frame_t metadata;
+    const int64_t call_start = monotonic_ns();
+    NDI_TRACE_BEGIN("recv_capture");
+    pthread_mutex_lock(&wrapper->mutex);
+    const NDIlib_frame_type_e frame_type = g_ndi->recv_capture_v2(
+        wrapper->recv,
+        &handle->frame,
+        NULL,
+        &metadata,
+        wait_ms
+    );
+    pthread_mutex_unlock(&wrapper->mutex);
+    NDI_TRACE_END();
+    handle->captured_ns = monotonic_ns();
+    track_connection(wrapper, frame_type == NDIlib_frame_type_video);
+
+    if (frame_type == NDIlib_frame_type_metadata) {
+        consume_metadata(wrapper, &metadata);
+        return frame_type;
+    }
+    if (frame_type != NDIlib_frame_type_video) {
+        return frame_type;
+    }
+    if (handle->frame.p_data == NULL) {
+        LOGW("receiverCaptureVideo: Video frame had NULL p_data");
+        free_video_handle(wrapper, handle);
+        return frame_type;
+    }
+    record_video_arrival(wrapper, handle, call_start);
+
+    if (wrapper->low_latency) {
+        drain_to_latest(wrapper, handle);
+    } else {
+        sample_queue(wrapper);
+        push_video_handle(wrapper, handle);
+    }
+    return frame_type;
+}
+
+/*
+ * Capture video through the receiver's jitter buffer: frames are captured into it and the
+ * oldest is returned once its playout time comes. Waits at most timeout_ms in total, but
+ * always polls NDI at least once. Metadata captured along the way goes to the inbox without
+ * ending the wait, so a metadata burst neither returns early nor extends the deadline.
+ *
+ * A scheduled receiver is captured by the scheduler's workers, so this only takes a frame that
+ * is due and never waits (the consumer waits in schedulerWaitReady).
+ */
+static NdiVideoFrameHandle* capture_video_buffered(NdiReceiverWrapper* wrapper, uint32_t timeout_ms) {
+    if (wrapper->scheduler != NULL) {
+        return (NdiVideoFrameHandle*)jitter_buffer_pop(wrapper->jitter, monotonic_ns());
+    }
+
+    const int64_t deadline = monotonic_ns() + ((int64_t)timeout_ms * 1000000LL);
+    bool polled = false;
+    NdiVideoFrameHandle* handle = NULL;   /* Reused across non-video captures. */
+
+    for (;;) {
+        const int64_t now = monotonic_ns();
+        NdiVideoFrameHandle* ready = (NdiVideoFrameHandle*)jitter_buffer_pop(wrapper->jitter, now);
+        if (ready != NULL) {
+            free(handle);
+            return ready;
+        }
+        if (polled && now >= deadline) {
+            free(handle);
+            return NULL;
+        }
+        polled = true;
+
+        /* Wake up for whichever comes first: the held frame's playout time or the deadline. */
+        int64_t wake = jitter_buffer_next_due_ns(wrapper->jitter);
+        if (wake > deadline) {
+            wake = deadline;
+        }
+        const int64_t wait_ns = wake > now ? wake - now : 0;
+        const uint32_t wait_ms = (uint32_t)((wait_ns + 999999LL) / 1000000LL);
+
+        if (handle == NULL) {
+            handle = new_video_handle(wrapper);
+            if (handle == NULL) {
+                LOGE("receiverCaptureVideo: Out of memory");
+                return NULL;
+            }
+        }
+        if (capture_into_jitter(wrapper, handle, wait_ms) == NDIlib_frame_type_video) {
+            handle = NULL;
+        }
+    }
+}
+
+/* Bounds one scheduled service, so a busy source cannot keep its worker from the others. */
+#define SCHEDULED_MAX_CAPTURES 16
+
+/* CaptureScheduler service: capture what the SDK has queued without waiting. */
+static int scheduled_capture(void* context) {
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)context;
+    int frames = 0;
+    NdiVideoFrameHandle* handle = NULL;   /* Reused across non-video captures. */
+
+    for (int i = 0; i < SCHEDULED_MAX_CAPTURES; i++) {
+        if (handle == NULL) {
+            handle = new_video_handle(wrapper);
+            if (handle == NULL) {
+                LOGE("scheduledCapture: Out of memory");
+                break;
+            }
+        }
+        const NDIlib_frame_type_e frame_type = capture_into_jitter(wrapper, handle, 0);
+        if (frame_type == NDIlib_frame_type_video) {
+            handle = NULL;
+            frames++;
+        } else if (frame_type != NDIlib_frame_type_metadata) {
+            break;
+        }
+    }
+    free(handle);
+    return frames;
+}
+
+/* CaptureScheduler due callback: when the receiver's oldest held frame plays out. */
+static int64_t scheduled_due(void* context) {
+    return jitter_buffer_next_due_ns(((NdiReceiverWrapper*)context)->jitter);
+}
+
+/* Relay release callback: the SDK has finished sending from the frame. */
+static void release_relayed_video(void* owner, void* context) {
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)context;
+    free_video_handle(wrapper, (NdiVideoFrameHandle*)owner);
+}
+
+/*
+ * Republish a captured frame through the receiver's relay, if any. The relay takes its own
+ * reference, so the frame outlives receiverFreeVideo until the SDK has sent it.
+ */
+static void relay_video(NdiReceiverWrapper* wrapper, NdiVideoFrameHandle* handle) {
+    pthread_mutex_lock(&wrapper->relay_mutex);
+    if (wrapper->relay != NULL) {
+        pthread_mutex_lock(&wrapper->mutex);
+        handle->refs++;
+        pthread_mutex_unlock(&wrapper->mutex);
+        if (!ndi_relay_send_video(wrapper->relay, &handle->frame, handle)) {
+            free_video_handle(wrapper, handle);
+        }
+    }
+    pthread_mutex_unlock(&wrapper->relay_mutex);
+}
+
+/* Stop relaying; the frame in flight is released before the relay goes. */
+static void stop_relay(NdiReceiverWrapper* wrapper) {
+    pthread_mutex_lock(&wrapper->relay_mutex);
+    if (wrapper->relay != NULL) {
+        ndi_relay_destroy(wrapper->relay);
+        wrapper->relay = NULL;
+        LOGI("Relay stopped");
+    }
+    pthread_mutex_unlock(&wrapper->relay_mutex);
+}
+
 static int ensure_jni_cache(JNIEnv* env) {
     if (g_jni_cache_initialized) {
         return 1;
@@ -145,6 +812,20 @@ static int ensure_jni_cache(JNIEnv* env) {
         return 1;
     }
 
+    jclass localString = (*env)->FindClass(env, "java/lang/String");
+    if (localString == NULL) {
+        LOGE("Failed to find class String");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_String = (jclass)(*env)->NewGlobalRef(env, localString);
+    (*env)->DeleteLocalRef(env, localString);
+    if (g_class_String == NULL) {
+        LOGE("Failed to create global ref for String");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
     jclass localVideoFrame = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$VideoFrame");
     if (localVideoFrame == NULL) {
         LOGE("Failed to find class NdiNative$VideoFrame");
@@ -162,7 +843,7 @@ static int ensure_jni_cache(JNIEnv* env) {
         env,
         g_class_VideoFrame,
         "<init>",
-        "(JIIIIIIJLjava/nio/ByteBuffer;Z)V"
+        "(JIIIIIIJLjava/nio/ByteBuffer;ZJ)V"
     );
     if (g_ctor_VideoFrame == NULL) {
         LOGE("Failed to find VideoFrame constructor");
@@ -203,66 +884,485 @@ static int ensure_jni_cache(JNIEnv* env) {
         pthread_mutex_unlock(&g_jni_cache_mutex);
         return 0;
     }
-    g_ctor_ReceiverPerformance = (*env)->GetMethodID(env, g_class_ReceiverPerformance, "<init>", "(JJJJJI)V");
+    g_ctor_ReceiverPerformance = (*env)->GetMethodID(env, g_class_ReceiverPerformance, "<init>", "(JJJJJIIIIJJJIJJJJJIZJIJJ)V");
     if (g_ctor_ReceiverPerformance == NULL) {
         LOGE("Failed to find ReceiverPerformance constructor");
         pthread_mutex_unlock(&g_jni_cache_mutex);
         return 0;
     }
 
-    g_jni_cache_initialized = 1;
-    pthread_mutex_unlock(&g_jni_cache_mutex);
-    return 1;
-}
-
-/* ============================================================================
- * JNI Exports - Library Initialization
- * ========================================================================== */
-
-JNIEXPORT jboolean JNICALL
-Java_com_example_ndireceiver_ndi_NdiNative_initialize(JNIEnv* env, jobject thiz) {
-    (void)env;
-    (void)thiz;
-
-    pthread_mutex_lock(&g_init_mutex);
-
-    if (g_initialized) {
-        pthread_mutex_unlock(&g_init_mutex);
-        LOGW("NDI SDK already initialized");
-        return JNI_TRUE;
+    jclass localPacerStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$PacerStats");
+    if (localPacerStats == NULL) {
+        LOGE("Failed to find class NdiNative$PacerStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
     }
-
-    LOGI("Initializing NDI SDK...");
-    if (!NDIlib_initialize()) {
-        pthread_mutex_unlock(&g_init_mutex);
-        LOGE("Failed to initialize NDI SDK");
-        return JNI_FALSE;
+    g_class_PacerStats = (jclass)(*env)->NewGlobalRef(env, localPacerStats);
+    (*env)->DeleteLocalRef(env, localPacerStats);
+    if (g_class_PacerStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$PacerStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_PacerStats = (*env)->GetMethodID(env, g_class_PacerStats, "<init>", "(JJJJJJIJJJJJJJ[J)V");
+    if (g_ctor_PacerStats == NULL) {
+        LOGE("Failed to find PacerStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
     }
 
-    g_initialized = 1;
-    pthread_mutex_unlock(&g_init_mutex);
-    LOGI("NDI SDK initialized successfully");
-    return JNI_TRUE;
-}
-
-JNIEXPORT void JNICALL
-Java_com_example_ndireceiver_ndi_NdiNative_destroy(JNIEnv* env, jobject thiz) {
-    (void)env;
-    (void)thiz;
+    jclass localArenaStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$ArenaStats");
+    if (localArenaStats == NULL) {
+        LOGE("Failed to find class NdiNative$ArenaStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_ArenaStats = (jclass)(*env)->NewGlobalRef(env, localArenaStats);
+    (*env)->DeleteLocalRef(env, localArenaStats);
+    if (g_class_ArenaStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$ArenaStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_ArenaStats = (*env)->GetMethodID(env, g_class_ArenaStats, "<init>", "(JJJJJJJ[J[J[J)V");
+    if (g_ctor_ArenaStats == NULL) {
+        LOGE("Failed to find ArenaStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
 
-    pthread_mutex_lock(&g_init_mutex);
+    jclass localPlacedThread = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$PlacedThread");
+    if (localPlacedThread == NULL) {
+        LOGE("Failed to find class NdiNative$PlacedThread");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_PlacedThread = (jclass)(*env)->NewGlobalRef(env, localPlacedThread);
+    (*env)->DeleteLocalRef(env, localPlacedThread);
+    if (g_class_PlacedThread == NULL) {
+        LOGE("Failed to create global ref for NdiNative$PlacedThread");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_PlacedThread = (*env)->GetMethodID(env, g_class_PlacedThread, "<init>", "(IIJJIIIJJJI)V");
+    if (g_ctor_PlacedThread == NULL) {
+        LOGE("Failed to find PlacedThread constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
 
-    if (!g_initialized) {
-        pthread_mutex_unlock(&g_init_mutex);
-        LOGW("NDI SDK not initialized, nothing to destroy");
-        return;
+    jclass localPlacementStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$ThreadPlacementStats");
+    if (localPlacementStats == NULL) {
+        LOGE("Failed to find class NdiNative$ThreadPlacementStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_ThreadPlacementStats = (jclass)(*env)->NewGlobalRef(env, localPlacementStats);
+    (*env)->DeleteLocalRef(env, localPlacementStats);
+    if (g_class_ThreadPlacementStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$ThreadPlacementStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_ThreadPlacementStats = (*env)->GetMethodID(
+        env,
+        g_class_ThreadPlacementStats,
+        "<init>",
+        "(ZIJJ[Lcom/example/ndireceiver/ndi/NdiNative$PlacedThread;)V"
+    );
+    if (g_ctor_ThreadPlacementStats == NULL) {
+        LOGE("Failed to find ThreadPlacementStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
     }
 
-    LOGI("Destroying NDI SDK...");
-    NDIlib_destroy();
+    jclass localThreadCpu = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$ThreadCpu");
+    if (localThreadCpu == NULL) {
+        LOGE("Failed to find class NdiNative$ThreadCpu");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_ThreadCpu = (jclass)(*env)->NewGlobalRef(env, localThreadCpu);
+    (*env)->DeleteLocalRef(env, localThreadCpu);
+    if (g_class_ThreadCpu == NULL) {
+        LOGE("Failed to create global ref for NdiNative$ThreadCpu");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_ThreadCpu = (*env)->GetMethodID(env, g_class_ThreadCpu, "<init>", "(ILjava/lang/String;JJ)V");
+    if (g_ctor_ThreadCpu == NULL) {
+        LOGE("Failed to find ThreadCpu constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localStageStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$StageStats");
+    if (localStageStats == NULL) {
+        LOGE("Failed to find class NdiNative$StageStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_StageStats = (jclass)(*env)->NewGlobalRef(env, localStageStats);
+    (*env)->DeleteLocalRef(env, localStageStats);
+    if (g_class_StageStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$StageStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_StageStats = (*env)->GetMethodID(
+        env,
+        g_class_StageStats,
+        "<init>",
+        "(JJ[J[J[J[J[Lcom/example/ndireceiver/ndi/NdiNative$ThreadCpu;)V"
+    );
+    if (g_ctor_StageStats == NULL) {
+        LOGE("Failed to find StageStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localMetadataEvent = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$MetadataEvent");
+    if (localMetadataEvent == NULL) {
+        LOGE("Failed to find class NdiNative$MetadataEvent");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_MetadataEvent = (jclass)(*env)->NewGlobalRef(env, localMetadataEvent);
+    (*env)->DeleteLocalRef(env, localMetadataEvent);
+    if (g_class_MetadataEvent == NULL) {
+        LOGE("Failed to create global ref for NdiNative$MetadataEvent");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_MetadataEvent = (*env)->GetMethodID(
+        env,
+        g_class_MetadataEvent,
+        "<init>",
+        "(Ljava/lang/String;[Ljava/lang/String;Ljava/lang/String;JZ)V"
+    );
+    if (g_ctor_MetadataEvent == NULL) {
+        LOGE("Failed to find MetadataEvent constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localRelayStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$RelayStats");
+    if (localRelayStats == NULL) {
+        LOGE("Failed to find class NdiNative$RelayStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_RelayStats = (jclass)(*env)->NewGlobalRef(env, localRelayStats);
+    (*env)->DeleteLocalRef(env, localRelayStats);
+    if (g_class_RelayStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$RelayStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_RelayStats = (*env)->GetMethodID(env, g_class_RelayStats, "<init>", "(JJJJIZZ)V");
+    if (g_ctor_RelayStats == NULL) {
+        LOGE("Failed to find RelayStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localTransportProbeResult = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$TransportProbeResult");
+    if (localTransportProbeResult == NULL) {
+        LOGE("Failed to find class NdiNative$TransportProbeResult");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_TransportProbeResult = (jclass)(*env)->NewGlobalRef(env, localTransportProbeResult);
+    (*env)->DeleteLocalRef(env, localTransportProbeResult);
+    if (g_class_TransportProbeResult == NULL) {
+        LOGE("Failed to create global ref for NdiNative$TransportProbeResult");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_TransportProbeResult = (*env)->GetMethodID(env, g_class_TransportProbeResult, "<init>", "(JJDJJJ)V");
+    if (g_ctor_TransportProbeResult == NULL) {
+        LOGE("Failed to find TransportProbeResult constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localMp4Info = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$Mp4Info");
+    if (localMp4Info == NULL) {
+        LOGE("Failed to find class NdiNative$Mp4Info");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_Mp4Info = (jclass)(*env)->NewGlobalRef(env, localMp4Info);
+    (*env)->DeleteLocalRef(env, localMp4Info);
+    if (g_class_Mp4Info == NULL) {
+        LOGE("Failed to create global ref for NdiNative$Mp4Info");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_Mp4Info = (*env)->GetMethodID(env, g_class_Mp4Info, "<init>", "(JIIIZ)V");
+    if (g_ctor_Mp4Info == NULL) {
+        LOGE("Failed to find Mp4Info constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localLatencyStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$LatencyStats");
+    if (localLatencyStats == NULL) {
+        LOGE("Failed to find class NdiNative$LatencyStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_LatencyStats = (jclass)(*env)->NewGlobalRef(env, localLatencyStats);
+    (*env)->DeleteLocalRef(env, localLatencyStats);
+    if (g_class_LatencyStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$LatencyStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_LatencyStats = (*env)->GetMethodID(env, g_class_LatencyStats, "<init>", "(J[J[J[J[J[J)V");
+    if (g_ctor_LatencyStats == NULL) {
+        LOGE("Failed to find LatencyStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localReceiverStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$ReceiverStats");
+    if (localReceiverStats == NULL) {
+        LOGE("Failed to find class NdiNative$ReceiverStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_ReceiverStats = (jclass)(*env)->NewGlobalRef(env, localReceiverStats);
+    (*env)->DeleteLocalRef(env, localReceiverStats);
+    if (g_class_ReceiverStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$ReceiverStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_ReceiverStats = (*env)->GetMethodID(env, g_class_ReceiverStats, "<init>", "(JJJDJJJJJJJDIIIIIIIII)V");
+    if (g_ctor_ReceiverStats == NULL) {
+        LOGE("Failed to find ReceiverStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localBandwidthStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$BandwidthStats");
+    if (localBandwidthStats == NULL) {
+        LOGE("Failed to find class NdiNative$BandwidthStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_BandwidthStats = (jclass)(*env)->NewGlobalRef(env, localBandwidthStats);
+    (*env)->DeleteLocalRef(env, localBandwidthStats);
+    if (g_class_BandwidthStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$BandwidthStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_BandwidthStats = (*env)->GetMethodID(env, g_class_BandwidthStats, "<init>", "(IZIIJJJJJJJD)V");
+    if (g_ctor_BandwidthStats == NULL) {
+        LOGE("Failed to find BandwidthStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localSchedulerSourceStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$SchedulerSourceStats");
+    if (localSchedulerSourceStats == NULL) {
+        LOGE("Failed to find class NdiNative$SchedulerSourceStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_SchedulerSourceStats = (jclass)(*env)->NewGlobalRef(env, localSchedulerSourceStats);
+    (*env)->DeleteLocalRef(env, localSchedulerSourceStats);
+    if (g_class_SchedulerSourceStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$SchedulerSourceStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_SchedulerSourceStats = (*env)->GetMethodID(env, g_class_SchedulerSourceStats, "<init>", "(ZJJJJJ)V");
+    if (g_ctor_SchedulerSourceStats == NULL) {
+        LOGE("Failed to find SchedulerSourceStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localMultiviewStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$MultiviewStats");
+    if (localMultiviewStats == NULL) {
+        LOGE("Failed to find class NdiNative$MultiviewStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_MultiviewStats = (jclass)(*env)->NewGlobalRef(env, localMultiviewStats);
+    (*env)->DeleteLocalRef(env, localMultiviewStats);
+    if (g_class_MultiviewStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$MultiviewStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_MultiviewStats = (*env)->GetMethodID(env, g_class_MultiviewStats, "<init>", "(JJDJJ)V");
+    if (g_ctor_MultiviewStats == NULL) {
+        LOGE("Failed to find MultiviewStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localMultiviewTileStats = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$MultiviewTileStats");
+    if (localMultiviewTileStats == NULL) {
+        LOGE("Failed to find class NdiNative$MultiviewTileStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_MultiviewTileStats = (jclass)(*env)->NewGlobalRef(env, localMultiviewTileStats);
+    (*env)->DeleteLocalRef(env, localMultiviewTileStats);
+    if (g_class_MultiviewTileStats == NULL) {
+        LOGE("Failed to create global ref for NdiNative$MultiviewTileStats");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_MultiviewTileStats = (*env)->GetMethodID(env, g_class_MultiviewTileStats, "<init>", "(ZIIJJJJJ)V");
+    if (g_ctor_MultiviewTileStats == NULL) {
+        LOGE("Failed to find MultiviewTileStats constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localSourceChange = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$SourceChange");
+    if (localSourceChange == NULL) {
+        LOGE("Failed to find class NdiNative$SourceChange");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_SourceChange = (jclass)(*env)->NewGlobalRef(env, localSourceChange);
+    (*env)->DeleteLocalRef(env, localSourceChange);
+    if (g_class_SourceChange == NULL) {
+        LOGE("Failed to create global ref for NdiNative$SourceChange");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_SourceChange = (*env)->GetMethodID(env, g_class_SourceChange, "<init>", "(ILjava/lang/String;Ljava/lang/String;)V");
+    if (g_ctor_SourceChange == NULL) {
+        LOGE("Failed to find SourceChange constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    jclass localCachedSource = (*env)->FindClass(env, "com/example/ndireceiver/ndi/NdiNative$CachedSource");
+    if (localCachedSource == NULL) {
+        LOGE("Failed to find class NdiNative$CachedSource");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_class_CachedSource = (jclass)(*env)->NewGlobalRef(env, localCachedSource);
+    (*env)->DeleteLocalRef(env, localCachedSource);
+    if (g_class_CachedSource == NULL) {
+        LOGE("Failed to create global ref for NdiNative$CachedSource");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+    g_ctor_CachedSource = (*env)->GetMethodID(env, g_class_CachedSource, "<init>", "(Ljava/lang/String;Ljava/lang/String;JJ)V");
+    if (g_ctor_CachedSource == NULL) {
+        LOGE("Failed to find CachedSource constructor");
+        pthread_mutex_unlock(&g_jni_cache_mutex);
+        return 0;
+    }
+
+    g_jni_cache_initialized = 1;
+    pthread_mutex_unlock(&g_jni_cache_mutex);
+    return 1;
+}
+
+/* Count a new user of the SDK, or fail when it is not initialized. */
+static bool sdk_acquire(const char* caller) {
+    pthread_mutex_lock(&g_init_mutex);
+    const bool ok = g_initialized;
+    if (ok) {
+        g_sdk_users++;
+    }
+    pthread_mutex_unlock(&g_init_mutex);
+    if (!ok) {
+        LOGE("%s: NDI SDK not initialized", caller);
+    }
+    return ok;
+}
+
+static void sdk_release(void) {
+    pthread_mutex_lock(&g_init_mutex);
+    g_sdk_users--;
+    pthread_mutex_unlock(&g_init_mutex);
+}
+
+/* ============================================================================
+ * JNI Exports - Library Initialization
+ * ========================================================================== */
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_initialize(JNIEnv* env, jobject thiz) {
+    (void)env;
+    (void)thiz;
+
+    pthread_mutex_lock(&g_init_mutex);
+
+    if (g_initialized) {
+        pthread_mutex_unlock(&g_init_mutex);
+        LOGW("NDI SDK already initialized");
+        return JNI_TRUE;
+    }
+
+    if (g_ndi == NULL) {
+        /* The debug property lets a stub or alternative build of the SDK be swapped in. */
+        char property[PROP_VALUE_MAX] = { 0 };
+        const char* path = (__system_property_get(RUNTIME_PATH_PROPERTY, property) > 0) ? property : NULL;
+        char error[256] = { 0 };
+        if (!ndi_runtime_open(&g_runtime, path, error, sizeof(error))) {
+            pthread_mutex_unlock(&g_init_mutex);
+            LOGE("Failed to load NDI runtime: %s", error);
+            return JNI_FALSE;
+        }
+        g_ndi = g_runtime.api;
+        LOGI("NDI runtime loaded from %s (dlopen %.1f ms, NDIlib_v6_load %.1f ms)",
+             ndi_runtime_resolve_path(path),
+             (double)g_runtime.open_ns / 1e6,
+             (double)g_runtime.resolve_ns / 1e6);
+    }
+
+    LOGI("Initializing NDI SDK...");
+    if (!g_ndi->initialize()) {
+        pthread_mutex_unlock(&g_init_mutex);
+        LOGE("Failed to initialize NDI SDK");
+        return JNI_FALSE;
+    }
+
+    g_initialized = 1;
+    pthread_mutex_unlock(&g_init_mutex);
+    LOGI("NDI SDK initialized successfully");
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_destroy(JNIEnv* env, jobject thiz) {
+    (void)env;
+    (void)thiz;
+
+    pthread_mutex_lock(&g_init_mutex);
+
+    if (!g_initialized) {
+        pthread_mutex_unlock(&g_init_mutex);
+        LOGW("NDI SDK not initialized, nothing to destroy");
+        return JNI_TRUE;
+    }
+    if (g_sdk_users > 0) {
+        const int users = g_sdk_users;
+        pthread_mutex_unlock(&g_init_mutex);
+        LOGW("NDI SDK still has %d finders, receivers or probes; not destroyed", users);
+        return JNI_FALSE;
+    }
+
+    LOGI("Destroying NDI SDK...");
+    g_ndi->destroy();
     g_initialized = 0;
     pthread_mutex_unlock(&g_init_mutex);
     LOGI("NDI SDK destroyed");
+    return JNI_TRUE;
 }
 
 JNIEXPORT jboolean JNICALL
@@ -275,7 +1375,7 @@ Java_com_example_ndireceiver_ndi_NdiNative_isInitialized(JNIEnv* env, jobject th
 JNIEXPORT jstring JNICALL
 Java_com_example_ndireceiver_ndi_NdiNative_getVersion(JNIEnv* env, jobject thiz) {
     (void)thiz;
-    const char* version = NDIlib_version();
+    const char* version = (g_ndi != NULL) ? g_ndi->version() : "not loaded";
     return cstring_to_jstring(env, version ? version : "unknown");
 }
 
@@ -293,8 +1393,7 @@ Java_com_example_ndireceiver_ndi_NdiNative_finderCreate(
 
     (void)thiz;
 
-    if (!g_initialized) {
-        LOGE("finderCreate: NDI SDK not initialized");
+    if (!sdk_acquire("finderCreate")) {
         return 0;
     }
 
@@ -312,27 +1411,39 @@ Java_com_example_ndireceiver_ndi_NdiNative_finderCreate(
     settings.p_groups = is_empty_string(groups_str) ? NULL : groups_str;
     settings.p_extra_ips = is_empty_string(extra_ips_str) ? NULL : extra_ips_str;
 
-    NDIlib_find_instance_t finder = NDIlib_find_create_v2(&settings);
+    NDIlib_find_instance_t finder = g_ndi->find_create_v2(&settings);
     free(groups_str);
     free(extra_ips_str);
 
     if (finder == NULL) {
         LOGE("finderCreate: NDIlib_find_create_v2 failed");
+        sdk_release();
         return 0;
     }
 
     NdiFinderWrapper* wrapper = (NdiFinderWrapper*)calloc(1, sizeof(NdiFinderWrapper));
     if (wrapper == NULL) {
         LOGE("finderCreate: Out of memory");
-        NDIlib_find_destroy(finder);
+        g_ndi->find_destroy(finder);
+        sdk_release();
         return 0;
     }
 
     wrapper->finder = finder;
+    wrapper->reported = source_list_create();
+    if (wrapper->reported == NULL) {
+        LOGE("finderCreate: Out of memory");
+        g_ndi->find_destroy(finder);
+        free(wrapper);
+        sdk_release();
+        return 0;
+    }
     if (pthread_mutex_init(&wrapper->mutex, NULL) != 0) {
         LOGE("finderCreate: pthread_mutex_init failed");
-        NDIlib_find_destroy(finder);
+        source_list_destroy(wrapper->reported);
+        g_ndi->find_destroy(finder);
         free(wrapper);
+        sdk_release();
         return 0;
     }
 
@@ -360,13 +1471,15 @@ Java_com_example_ndireceiver_ndi_NdiNative_finderDestroy(
     LOGD("Destroying NDI finder");
     pthread_mutex_lock(&wrapper->mutex);
     if (wrapper->finder != NULL) {
-        NDIlib_find_destroy(wrapper->finder);
+        g_ndi->find_destroy(wrapper->finder);
         wrapper->finder = NULL;
     }
     pthread_mutex_unlock(&wrapper->mutex);
 
     pthread_mutex_destroy(&wrapper->mutex);
+    source_list_destroy(wrapper->reported);
     free(wrapper);
+    sdk_release();
 }
 
 JNIEXPORT jboolean JNICALL
@@ -389,7 +1502,7 @@ Java_com_example_ndireceiver_ndi_NdiNative_finderWaitForSources(
     }
 
     pthread_mutex_lock(&wrapper->mutex);
-    const bool changed = NDIlib_find_wait_for_sources(wrapper->finder, (uint32_t)timeoutMs);
+    const bool changed = g_ndi->find_wait_for_sources(wrapper->finder, (uint32_t)timeoutMs);
     pthread_mutex_unlock(&wrapper->mutex);
     return changed ? JNI_TRUE : JNI_FALSE;
 }
@@ -411,18 +1524,16 @@ Java_com_example_ndireceiver_ndi_NdiNative_finderGetSources(
         return NULL;
     }
 
+    if (!ensure_jni_cache(env)) {
+        return NULL;
+    }
+
     pthread_mutex_lock(&wrapper->mutex);
 
     uint32_t no_sources = 0;
-    const NDIlib_source_t* sources = NDIlib_find_get_current_sources(wrapper->finder, &no_sources);
-
-    jclass stringClass = (*env)->FindClass(env, "java/lang/String");
-    if (stringClass == NULL) {
-        pthread_mutex_unlock(&wrapper->mutex);
-        return NULL;
-    }
+    const NDIlib_source_t* sources = g_ndi->find_get_current_sources(wrapper->finder, &no_sources);
 
-    jobjectArray result = (*env)->NewObjectArray(env, (jsize)no_sources, stringClass, NULL);
+    jobjectArray result = (*env)->NewObjectArray(env, (jsize)no_sources, g_class_String, NULL);
     if (result == NULL) {
         pthread_mutex_unlock(&wrapper->mutex);
         return NULL;
@@ -441,27 +1552,216 @@ Java_com_example_ndireceiver_ndi_NdiNative_finderGetSources(
     return result;
 }
 
-/* ============================================================================
- * JNI Exports - NDI Receiver
- * ========================================================================== */
+/* Diff the finder's current sources against what was last reported. Caller holds wrapper->mutex. */
+static int update_reported_sources(NdiFinderWrapper* wrapper, const SourceChange** changes) {
+    uint32_t no_sources = 0;
+    const NDIlib_source_t* sources = g_ndi->find_get_current_sources(wrapper->finder, &no_sources);
+    if (sources == NULL) {
+        no_sources = 0;
+    }
 
-JNIEXPORT jlong JNICALL
-Java_com_example_ndireceiver_ndi_NdiNative_receiverCreate(
-        JNIEnv* env,
-        jobject thiz,
-        jstring receiverName,
-        jint bandwidth,
-        jint colorFormat,
-        jboolean allowVideoFields) {
+    SourceInfo* infos = (SourceInfo*)malloc(((size_t)no_sources + 1) * sizeof(SourceInfo));
+    if (infos == NULL) {
+        LOGE("finderWaitForChanges: Out of memory");
+        return -1;
+    }
+    for (uint32_t i = 0; i < no_sources; i++) {
+        infos[i].name = sources[i].p_ndi_name;
+        infos[i].url = sources[i].p_url_address;
+    }
 
-    (void)thiz;
+    const int count = source_list_update(wrapper->reported, infos, (int)no_sources, changes);
+    free(infos);
+    if (count < 0) {
+        LOGE("finderWaitForChanges: Out of memory");
+        return -1;
+    }
+    wrapper->primed = true;
+
+    SourceCache* cache = get_source_cache();
+    if (cache != NULL) {
+        const int64_t now_ms = wall_clock_ms();
+        for (int i = 0; i < count; i++) {
+            if ((*changes)[i].kind != SOURCE_REMOVED) {
+                source_cache_seen(cache, (*changes)[i].source.name, (*changes)[i].source.url, now_ms);
+            }
+        }
+    }
+    return count;
+}
 
-    if (!g_initialized) {
-        LOGE("receiverCreate: NDI SDK not initialized");
-        return 0;
+static jobjectArray new_source_changes(JNIEnv* env, const SourceChange* changes, int count) {
+    jobjectArray result = (*env)->NewObjectArray(env, count, g_class_SourceChange, NULL);
+    for (int i = 0; result != NULL && i < count; i++) {
+        jstring name = (*env)->NewStringUTF(env, changes[i].source.name);
+        jstring url = (*env)->NewStringUTF(env, changes[i].source.url);
+        jobject change = NULL;
+        if (name != NULL && url != NULL) {
+            change = (*env)->NewObject(env, g_class_SourceChange, g_ctor_SourceChange,
+                                       (jint)changes[i].kind, name, url);
+        }
+        if (name != NULL) {
+            (*env)->DeleteLocalRef(env, name);
+        }
+        if (url != NULL) {
+            (*env)->DeleteLocalRef(env, url);
+        }
+        if (change == NULL) {
+            (*env)->DeleteLocalRef(env, result);
+            return NULL;
+        }
+        (*env)->SetObjectArrayElement(env, result, i, change);
+        (*env)->DeleteLocalRef(env, change);
     }
+    return result;
+}
 
-    char* name_str = jstring_to_cstring(env, receiverName);
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_finderWaitForChanges(
+        JNIEnv* env,
+        jobject thiz,
+        jlong finderPtr,
+        jint timeoutMs) {
+
+    (void)thiz;
+
+    if (finderPtr == 0) {
+        return NULL;
+    }
+
+    NdiFinderWrapper* wrapper = (NdiFinderWrapper*)(intptr_t)finderPtr;
+    if (wrapper == NULL || wrapper->finder == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&wrapper->mutex);
+
+    const int64_t deadline = monotonic_ns() + (int64_t)(timeoutMs > 0 ? timeoutMs : 0) * 1000000LL;
+    const SourceChange* changes = NULL;
+    int change_count = 0;
+
+    /*
+     * The SDK wakes on any discovery traffic, and a Discovery Server re-announcing an
+     * unchanged list wakes it too: keep waiting until the list really differs.
+     */
+    bool fetch = !wrapper->primed;
+    for (;;) {
+        if (fetch) {
+            change_count = update_reported_sources(wrapper, &changes);
+            if (change_count != 0) {
+                break;
+            }
+        }
+        const int64_t remaining_ms = (deadline - monotonic_ns()) / 1000000LL;
+        if (remaining_ms <= 0) {
+            break;
+        }
+        fetch = g_ndi->find_wait_for_sources(wrapper->finder, (uint32_t)remaining_ms);
+    }
+
+    jobjectArray result = NULL;
+    if (change_count > 0) {
+        result = new_source_changes(env, changes, change_count);
+    }
+    pthread_mutex_unlock(&wrapper->mutex);
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - Source Cache
+ * ========================================================================== */
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_sourceCacheOpen(
+        JNIEnv* env,
+        jobject thiz,
+        jstring path) {
+
+    (void)thiz;
+
+    pthread_mutex_lock(&g_source_cache_mutex);
+    if (g_source_cache != NULL) {
+        pthread_mutex_unlock(&g_source_cache_mutex);
+        return JNI_TRUE;
+    }
+    char* path_str = jstring_to_cstring(env, path);
+    g_source_cache = source_cache_open(path_str);
+    const bool opened = g_source_cache != NULL;
+    pthread_mutex_unlock(&g_source_cache_mutex);
+
+    if (!opened) {
+        LOGE("sourceCacheOpen: Cannot open '%s'", path_str ? path_str : "");
+    }
+    free(path_str);
+    return opened ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_sourceCacheGetSources(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)thiz;
+
+    SourceCache* cache = get_source_cache();
+    if (cache == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    SourceCacheEntry* entries = (SourceCacheEntry*)malloc(SOURCE_CACHE_CAPACITY * sizeof(SourceCacheEntry));
+    if (entries == NULL) {
+        LOGE("sourceCacheGetSources: Out of memory");
+        return NULL;
+    }
+    const int count = source_cache_entries(cache, entries, SOURCE_CACHE_CAPACITY);
+
+    jobjectArray result = (*env)->NewObjectArray(env, count, g_class_CachedSource, NULL);
+    for (int i = 0; result != NULL && i < count; i++) {
+        jstring name = (*env)->NewStringUTF(env, entries[i].name);
+        jstring url = (*env)->NewStringUTF(env, entries[i].url);
+        jobject source = NULL;
+        if (name != NULL && url != NULL) {
+            source = (*env)->NewObject(env, g_class_CachedSource, g_ctor_CachedSource, name, url,
+                                       (jlong)entries[i].last_seen_ms, (jlong)entries[i].last_success_ms);
+        }
+        if (name != NULL) {
+            (*env)->DeleteLocalRef(env, name);
+        }
+        if (url != NULL) {
+            (*env)->DeleteLocalRef(env, url);
+        }
+        if (source == NULL) {
+            (*env)->DeleteLocalRef(env, result);
+            result = NULL;
+            break;
+        }
+        (*env)->SetObjectArrayElement(env, result, i, source);
+        (*env)->DeleteLocalRef(env, source);
+    }
+    free(entries);
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - NDI Receiver
+ * ========================================================================== */
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverCreate(
+        JNIEnv* env,
+        jobject thiz,
+        jstring receiverName,
+        jint bandwidth,
+        jint colorFormat,
+        jboolean allowVideoFields) {
+
+    (void)thiz;
+
+    if (!sdk_acquire("receiverCreate")) {
+        return 0;
+    }
+
+    char* name_str = jstring_to_cstring(env, receiverName);
     LOGD("Creating NDI receiver '%s' (bandwidth=%d, colorFormat=%d, allowFields=%d)",
          name_str ? name_str : "",
          bandwidth,
@@ -472,12 +1772,22 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCreate(
     if (wrapper == NULL) {
         free(name_str);
         LOGE("receiverCreate: Out of memory");
+        sdk_release();
         return 0;
     }
     if (pthread_mutex_init(&wrapper->mutex, NULL) != 0) {
         free(name_str);
         free(wrapper);
         LOGE("receiverCreate: pthread_mutex_init failed");
+        sdk_release();
+        return 0;
+    }
+    if (pthread_mutex_init(&wrapper->relay_mutex, NULL) != 0) {
+        pthread_mutex_destroy(&wrapper->mutex);
+        free(name_str);
+        free(wrapper);
+        LOGE("receiverCreate: pthread_mutex_init failed");
+        sdk_release();
         return 0;
     }
 
@@ -490,15 +1800,31 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCreate(
     settings.allow_video_fields = (allowVideoFields == JNI_TRUE);
     settings.p_ndi_recv_name = is_empty_string(name_str) ? NULL : name_str;
 
-    wrapper->recv = NDIlib_recv_create_v3(&settings);
+    wrapper->recv = g_ndi->recv_create_v3(&settings);
     wrapper->surface_window = NULL;
+    wrapper->color_format = colorFormat;
+    wrapper->last_video_fourcc = 0;
+    wrapper->deinterlacer = deinterlacer_create();
+    wrapper->jitter = jitter_buffer_create(JITTER_BUFFER_MAX_CAPACITY);
+    wrapper->metadata = metadata_inbox_create();
+    wrapper->stats = receiver_stats_create();
 
     free(name_str);
 
-    if (wrapper->recv == NULL) {
-        LOGE("receiverCreate: NDIlib_recv_create_v3 failed");
+    if (wrapper->recv == NULL || wrapper->deinterlacer == NULL || wrapper->jitter == NULL ||
+        wrapper->metadata == NULL || wrapper->stats == NULL) {
+        LOGE("receiverCreate: %s", (wrapper->recv == NULL) ? "NDIlib_recv_create_v3 failed" : "Out of memory");
+        if (wrapper->recv != NULL) {
+            g_ndi->recv_destroy(wrapper->recv);
+        }
+        deinterlacer_destroy(wrapper->deinterlacer);
+        jitter_buffer_destroy(wrapper->jitter);
+        metadata_inbox_destroy(wrapper->metadata);
+        receiver_stats_destroy(wrapper->stats);
+        pthread_mutex_destroy(&wrapper->relay_mutex);
         pthread_mutex_destroy(&wrapper->mutex);
         free(wrapper);
+        sdk_release();
         return 0;
     }
 
@@ -525,19 +1851,47 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverDestroy(
 
     LOGD("Destroying NDI receiver");
 
+    /* A scheduler worker may be capturing for it; that has to finish first. */
+    if (wrapper->scheduler != NULL) {
+        capture_scheduler_remove(wrapper->scheduler, wrapper);
+        wrapper->scheduler = NULL;
+    }
+
+    /* The relay's frame in flight belongs to the receiver. */
+    stop_relay(wrapper);
+
     pthread_mutex_lock(&wrapper->mutex);
     if (wrapper->surface_window != NULL) {
         ANativeWindow_release(wrapper->surface_window);
         wrapper->surface_window = NULL;
     }
+    /* Frames still held for playout belong to the receiver and must go back before it does. */
+    NdiVideoFrameHandle* held;
+    while ((held = (NdiVideoFrameHandle*)jitter_buffer_drain(wrapper->jitter)) != NULL) {
+        unref_video_handle_locked(held);
+    }
     if (wrapper->recv != NULL) {
-        NDIlib_recv_destroy(wrapper->recv);
+        g_ndi->recv_destroy(wrapper->recv);
         wrapper->recv = NULL;
     }
+    deinterlacer_destroy(wrapper->deinterlacer);
+    wrapper->deinterlacer = NULL;
+    jitter_buffer_destroy(wrapper->jitter);
+    wrapper->jitter = NULL;
+    metadata_inbox_destroy(wrapper->metadata);
+    wrapper->metadata = NULL;
+    receiver_stats_destroy(wrapper->stats);
+    wrapper->stats = NULL;
+    free(wrapper->source_name);
+    wrapper->source_name = NULL;
+    free(wrapper->source_url);
+    wrapper->source_url = NULL;
     pthread_mutex_unlock(&wrapper->mutex);
 
+    pthread_mutex_destroy(&wrapper->relay_mutex);
     pthread_mutex_destroy(&wrapper->mutex);
     free(wrapper);
+    sdk_release();
 }
 
 JNIEXPORT jboolean JNICALL
@@ -567,18 +1921,36 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverConnect(
         return JNI_FALSE;
     }
 
-    LOGD("Connecting to NDI source: %s", source_str);
+    /* A source known from the cache is connected at its URL address, skipping name resolution. */
+    char url[SOURCE_CACHE_URL_MAX];
+    SourceCache* cache = get_source_cache();
+    char* url_str = NULL;
+    if (cache != NULL && source_cache_url(cache, source_str, url, sizeof(url))) {
+        url_str = c_strdup(url);
+    }
+
+    if (url_str != NULL) {
+        LOGD("Connecting to NDI source: %s at cached %s", source_str, url_str);
+    } else {
+        LOGD("Connecting to NDI source: %s", source_str);
+    }
 
     NDIlib_source_t source;
     memset(&source, 0, sizeof(source));
     source.p_ndi_name = source_str;
-    source.p_url_address = NULL;
+    source.p_url_address = url_str;
 
     pthread_mutex_lock(&wrapper->mutex);
-    NDIlib_recv_connect(wrapper->recv, &source);
+    g_ndi->recv_connect(wrapper->recv, &source);
+    free(wrapper->source_name);
+    free(wrapper->source_url);
+    wrapper->source_name = source_str;
+    wrapper->source_url = url_str;
+    wrapper->connect_ns = monotonic_ns();
+    wrapper->awaiting_video = true;
     pthread_mutex_unlock(&wrapper->mutex);
+    receiver_stats_reset(wrapper->stats);
 
-    free(source_str);
     return JNI_TRUE;
 }
 
@@ -602,7 +1974,10 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverDisconnect(
 
     LOGD("Disconnecting NDI receiver");
     pthread_mutex_lock(&wrapper->mutex);
-    NDIlib_recv_connect(wrapper->recv, NULL);
+    g_ndi->recv_connect(wrapper->recv, NULL);
+    wrapper->awaiting_video = false;
+    free(wrapper->source_url);
+    wrapper->source_url = NULL;
     pthread_mutex_unlock(&wrapper->mutex);
 }
 
@@ -628,73 +2003,62 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCaptureVideo(
         return NULL;
     }
 
-    NdiVideoFrameHandle* handle = (NdiVideoFrameHandle*)calloc(1, sizeof(NdiVideoFrameHandle));
+    NdiVideoFrameHandle* handle = capture_video_buffered(wrapper, (uint32_t)timeoutMs);
     if (handle == NULL) {
-        LOGE("receiverCaptureVideo: Out of memory");
         return NULL;
     }
-    handle->recv = wrapper->recv;
-    memset(&handle->frame, 0, sizeof(handle->frame));
-
-    pthread_mutex_lock(&wrapper->mutex);
-    const NDIlib_frame_type_e frame_type = NDIlib_recv_capture_v2(
-        wrapper->recv,
-        &handle->frame,
-        NULL,
-        NULL,
-        (uint32_t)timeoutMs
-    );
-    pthread_mutex_unlock(&wrapper->mutex);
 
-    if (frame_type != NDIlib_frame_type_video) {
-        free(handle);
-        return NULL;
-    }
+    /* Timed from hand-off: waiting for the frame is not work. */
+    StageMark capture_mark;
+    stage_mark_begin(&capture_mark);
+    NDI_TRACE_BEGIN("capture hand-off");
 
     const uint32_t fourcc = (uint32_t)handle->frame.FourCC;
-    const bool is_compressed = (fourcc == FOURCC_H264) || (fourcc == FOURCC_HEVC);
-
-    if (handle->frame.p_data == NULL) {
-        LOGW("receiverCaptureVideo: Video frame had NULL p_data");
-        pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_video_v2(wrapper->recv, &handle->frame);
-        pthread_mutex_unlock(&wrapper->mutex);
-        free(handle);
-        return NULL;
-    }
+    const bool is_compressed = is_compressed_fourcc(fourcc);
+    wrapper->last_video_fourcc = fourcc;
 
     jlong buffer_size = 0;
     if (is_compressed) {
         buffer_size = (jlong)handle->frame.data_size_in_bytes;
     } else {
-        const jlong stride = (jlong)handle->frame.line_stride_in_bytes;
-        const jlong abs_stride = (stride < 0) ? -stride : stride;
-        buffer_size = abs_stride * (jlong)handle->frame.yres;
+        buffer_size = uncompressed_frame_size(&handle->frame);
     }
 
     if (buffer_size <= 0) {
         LOGW("receiverCaptureVideo: Invalid buffer size (fourcc=0x%08x size=%" PRId64 ")",
              fourcc,
              (int64_t)buffer_size);
-        pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_video_v2(wrapper->recv, &handle->frame);
-        pthread_mutex_unlock(&wrapper->mutex);
-        free(handle);
+        free_video_handle(wrapper, handle);
+        NDI_TRACE_END();
         return NULL;
     }
 
-    jobject byteBuffer = (*env)->NewDirectByteBuffer(env, handle->frame.p_data, buffer_size);
+    /* Relayed as received: fields stay fields for the relay's receivers to deinterlace. */
+    relay_video(wrapper, handle);
+
+    void* out_data = handle->frame.p_data;
+    jint out_yres = (jint)handle->frame.yres;
+    jboolean is_progressive =
+        (handle->frame.frame_format_type == NDIlib_frame_format_type_progressive) ? JNI_TRUE : JNI_FALSE;
+
+    if (!is_compressed && !is_progressive) {
+        DeinterlaceOutput deinterlaced;
+        if (deinterlace_frame(wrapper, &handle->frame, &deinterlaced)) {
+            out_data = (void*)deinterlaced.data;
+            out_yres = (jint)deinterlaced.height;
+            buffer_size = (jlong)deinterlaced.size;
+            is_progressive = JNI_TRUE;
+        }
+    }
+
+    jobject byteBuffer = (*env)->NewDirectByteBuffer(env, out_data, buffer_size);
     if (byteBuffer == NULL) {
         LOGE("receiverCaptureVideo: NewDirectByteBuffer failed");
-        pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_video_v2(wrapper->recv, &handle->frame);
-        pthread_mutex_unlock(&wrapper->mutex);
-        free(handle);
+        free_video_handle(wrapper, handle);
+        NDI_TRACE_END();
         return NULL;
     }
 
-    const jboolean is_progressive =
-        (handle->frame.frame_format_type == NDIlib_frame_format_type_progressive) ? JNI_TRUE : JNI_FALSE;
     const jint out_stride = is_compressed ? 0 : (jint)handle->frame.line_stride_in_bytes;
 
     jobject videoObj = (*env)->NewObject(
@@ -703,25 +2067,29 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCaptureVideo(
         g_ctor_VideoFrame,
         (jlong)(intptr_t)handle,
         (jint)handle->frame.xres,
-        (jint)handle->frame.yres,
+        out_yres,
         out_stride,
         (jint)handle->frame.frame_rate_N,
         (jint)handle->frame.frame_rate_D,
         (jint)fourcc,
         (jlong)handle->frame.timestamp,
         byteBuffer,
-        is_progressive
+        is_progressive,
+        (jlong)handle->captured_ns
     );
 
     if (videoObj == NULL) {
         LOGE("receiverCaptureVideo: Failed to create VideoFrame object");
-        pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_video_v2(wrapper->recv, &handle->frame);
-        pthread_mutex_unlock(&wrapper->mutex);
-        free(handle);
+        free_video_handle(wrapper, handle);
+        NDI_TRACE_END();
         return NULL;
     }
 
+    StageProfiler* profiler = get_profiler();
+    if (profiler != NULL) {
+        stage_mark_end(profiler, PIPELINE_STAGE_CAPTURE, &capture_mark);
+    }
+    NDI_TRACE_END();
     return videoObj;
 }
 
@@ -740,20 +2108,14 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverFreeVideo(
     }
 
     NdiVideoFrameHandle* handle = (NdiVideoFrameHandle*)(intptr_t)framePtr;
-    if (handle == NULL) {
-        return;
-    }
-
     NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
-    if (wrapper != NULL) {
-        pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_video_v2(handle->recv, &handle->frame);
-        pthread_mutex_unlock(&wrapper->mutex);
-    } else {
-        NDIlib_recv_free_video_v2(handle->recv, &handle->frame);
+    if (handle == NULL || wrapper == NULL) {
+        /* Its references are counted under the receiver's mutex: without it, leave it alone. */
+        LOGE("receiverFreeVideo: Frame freed without its receiver");
+        return;
     }
 
-    free(handle);
+    free_video_handle(wrapper, handle);
 }
 
 JNIEXPORT jobject JNICALL
@@ -787,7 +2149,7 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCaptureAudio(
     memset(&handle->frame, 0, sizeof(handle->frame));
 
     pthread_mutex_lock(&wrapper->mutex);
-    const NDIlib_frame_type_e frame_type = NDIlib_recv_capture_v2(
+    const NDIlib_frame_type_e frame_type = g_ndi->recv_capture_v2(
         wrapper->recv,
         NULL,
         &handle->frame,
@@ -812,21 +2174,29 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCaptureAudio(
              channels,
              samples_per_channel);
         pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_audio_v2(wrapper->recv, &handle->frame);
+        g_ndi->recv_free_audio_v2(wrapper->recv, &handle->frame);
         pthread_mutex_unlock(&wrapper->mutex);
         free(handle);
         return NULL;
     }
 
+    pthread_mutex_lock(&wrapper->relay_mutex);
+    if (wrapper->relay != NULL) {
+        ndi_relay_send_audio(wrapper->relay, &handle->frame);
+    }
+    pthread_mutex_unlock(&wrapper->relay_mutex);
+
     const size_t total_samples = (size_t)channels * (size_t)samples_per_channel;
     const size_t bytes = total_samples * sizeof(float);
 
-    handle->interleaved_data = (float*)malloc(bytes);
+    FrameArena* arena = get_arena();
+    handle->interleaved_data = (arena != NULL) ? (float*)frame_arena_alloc(arena, FRAME_ARENA_AUDIO, bytes) : NULL;
     handle->interleaved_bytes = bytes;
     if (handle->interleaved_data == NULL) {
-        LOGE("receiverCaptureAudio: Out of memory for interleaved buffer (%zu bytes)", bytes);
+        /* Over the frame memory budget: drop this buffer rather than grow. */
+        LOGW("receiverCaptureAudio: No frame memory for interleaved buffer (%zu bytes)", bytes);
         pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_audio_v2(wrapper->recv, &handle->frame);
+        g_ndi->recv_free_audio_v2(wrapper->recv, &handle->frame);
         pthread_mutex_unlock(&wrapper->mutex);
         free(handle);
         return NULL;
@@ -845,9 +2215,9 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCaptureAudio(
     if (byteBuffer == NULL) {
         LOGE("receiverCaptureAudio: NewDirectByteBuffer failed");
         pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_audio_v2(wrapper->recv, &handle->frame);
+        g_ndi->recv_free_audio_v2(wrapper->recv, &handle->frame);
         pthread_mutex_unlock(&wrapper->mutex);
-        free(handle->interleaved_data);
+        frame_arena_free(g_arena, handle->interleaved_data);
         free(handle);
         return NULL;
     }
@@ -867,9 +2237,9 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverCaptureAudio(
     if (audioObj == NULL) {
         LOGE("receiverCaptureAudio: Failed to create AudioFrame object");
         pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_audio_v2(wrapper->recv, &handle->frame);
+        g_ndi->recv_free_audio_v2(wrapper->recv, &handle->frame);
         pthread_mutex_unlock(&wrapper->mutex);
-        free(handle->interleaved_data);
+        frame_arena_free(g_arena, handle->interleaved_data);
         free(handle);
         return NULL;
     }
@@ -899,13 +2269,13 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverFreeAudio(
     NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
     if (wrapper != NULL) {
         pthread_mutex_lock(&wrapper->mutex);
-        NDIlib_recv_free_audio_v2(handle->recv, &handle->frame);
+        g_ndi->recv_free_audio_v2(handle->recv, &handle->frame);
         pthread_mutex_unlock(&wrapper->mutex);
     } else {
-        NDIlib_recv_free_audio_v2(handle->recv, &handle->frame);
+        g_ndi->recv_free_audio_v2(handle->recv, &handle->frame);
     }
 
-    free(handle->interleaved_data);
+    frame_arena_free(g_arena, handle->interleaved_data);
     free(handle);
 }
 
@@ -936,8 +2306,10 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverGetPerformance(
     memset(&dropped, 0, sizeof(dropped));
 
     pthread_mutex_lock(&wrapper->mutex);
-    NDIlib_recv_get_performance(wrapper->recv, &total, &dropped);
-    const int connections = NDIlib_recv_get_no_connections(wrapper->recv);
+    g_ndi->recv_get_performance(wrapper->recv, &total, &dropped);
+    const int connections = g_ndi->recv_get_no_connections(wrapper->recv);
+    const uint64_t skipped_frames = wrapper->skipped_frames;
+    const int queue_depth = wrapper->queue_depth;
     pthread_mutex_unlock(&wrapper->mutex);
 
     int quality = 0;
@@ -953,6 +2325,18 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverGetPerformance(
         }
     }
 
+    DeinterlaceStats deinterlace_stats;
+    deinterlacer_get_stats(wrapper->deinterlacer, &deinterlace_stats);
+    const uint64_t deinterlace_avg_ns = (deinterlace_stats.frames > 0)
+        ? (deinterlace_stats.total_ns / deinterlace_stats.frames)
+        : 0;
+
+    JitterBufferStats jitter_stats;
+    jitter_buffer_get_stats(wrapper->jitter, &jitter_stats);
+
+    MetadataInboxStats metadata_stats;
+    metadata_inbox_get_stats(wrapper->metadata, &metadata_stats);
+
     return (*env)->NewObject(
         env,
         g_class_ReceiverPerformance,
@@ -962,41 +2346,107 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverGetPerformance(
         (jlong)total.audio_frames,
         (jlong)dropped.audio_frames,
         (jlong)total.metadata_frames,
-        (jint)quality
+        (jint)quality,
+        wrapper->color_format,
+        (jint)wrapper->last_video_fourcc,
+        (jint)deinterlacer_get_mode(wrapper->deinterlacer),
+        (jlong)deinterlace_stats.frames,
+        (jlong)deinterlace_stats.last_ns,
+        (jlong)deinterlace_avg_ns,
+        (jint)(jitter_stats.target_ns / 1000000LL),
+        (jlong)jitter_stats.delay_ns,
+        (jlong)jitter_stats.jitter_ns,
+        (jlong)jitter_stats.late,
+        (jlong)jitter_stats.early,
+        (jlong)jitter_stats.dropped,
+        (jint)jitter_stats.depth,
+        (jboolean)(wrapper->low_latency ? JNI_TRUE : JNI_FALSE),
+        (jlong)skipped_frames,
+        (jint)queue_depth,
+        (jlong)metadata_stats.events,
+        (jlong)metadata_stats.dropped
     );
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_example_ndireceiver_ndi_NdiNative_receiverIsConnected(
+/*
+ * Rolling-window stream statistics. The connection count is sampled here rather than per frame,
+ * so its range reflects how often stats are polled.
+ */
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverGetStats(
         JNIEnv* env,
         jobject thiz,
         jlong receiverPtr) {
 
-    (void)env;
     (void)thiz;
 
     if (receiverPtr == 0) {
-        return JNI_FALSE;
+        return NULL;
     }
 
     NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
-    if (wrapper == NULL || wrapper->recv == NULL) {
-        return JNI_FALSE;
+    if (wrapper == NULL || wrapper->recv == NULL || wrapper->stats == NULL) {
+        return NULL;
+    }
+
+    if (!ensure_jni_cache(env)) {
+        return NULL;
     }
 
     pthread_mutex_lock(&wrapper->mutex);
-    const int connections = NDIlib_recv_get_no_connections(wrapper->recv);
+    const int connections = g_ndi->recv_get_no_connections(wrapper->recv);
     pthread_mutex_unlock(&wrapper->mutex);
-    return (connections > 0) ? JNI_TRUE : JNI_FALSE;
+
+    const int64_t now = monotonic_ns();
+    receiver_stats_connections(wrapper->stats, connections, now);
+    ReceiverStatsSnapshot stats;
+    receiver_stats_get(wrapper->stats, now, &stats);
+
+    return (*env)->NewObject(
+        env,
+        g_class_ReceiverStats,
+        g_ctor_ReceiverStats,
+        (jlong)stats.window_ns,
+        (jlong)stats.video_frames,
+        (jlong)stats.video_bytes,
+        (jdouble)stats.fps,
+        (jlong)stats.bitrate_bps,
+        (jlong)stats.interval_avg_ns,
+        (jlong)stats.interval_max_ns,
+        (jlong)stats.jitter_ns,
+        (jlong)stats.capture_calls,
+        (jlong)stats.capture_avg_ns,
+        (jlong)stats.capture_max_ns,
+        (jdouble)stats.queue_video_avg,
+        (jint)stats.queue_video_max,
+        (jint)stats.queue_audio_max,
+        (jint)stats.queue_metadata_max,
+        (jint)stats.queue_video,
+        (jint)stats.queue_audio,
+        (jint)stats.queue_metadata,
+        (jint)stats.connections,
+        (jint)stats.connections_min,
+        (jint)stats.connections_max
+    );
 }
 
+/* Captures one receiverPreroll call makes at most, frames already queued included. */
+#define PREROLL_MAX_CAPTURES 64
+
+/*
+ * Bring a newly connected receiver to a frame its stream can start on, without returning it:
+ * uncompressed video can start anywhere, compressed video only at a random access point (the
+ * frames before it are released). The frame is held in the jitter buffer for the next
+ * receiverCaptureVideo, so a caller can switch to this receiver without a gap.
+ */
 JNIEXPORT jboolean JNICALL
-Java_com_example_ndireceiver_ndi_NdiNative_receiverSetSurface(
+Java_com_example_ndireceiver_ndi_NdiNative_receiverPreroll(
         JNIEnv* env,
         jobject thiz,
         jlong receiverPtr,
-        jobject surface) {
+        jint timeoutMs) {
 
+    (void)env;
     (void)thiz;
 
     if (receiverPtr == 0) {
@@ -1004,36 +2454,2417 @@ Java_com_example_ndireceiver_ndi_NdiNative_receiverSetSurface(
     }
 
     NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
-    if (wrapper == NULL) {
+    if (wrapper == NULL || wrapper->recv == NULL) {
         return JNI_FALSE;
     }
 
-    pthread_mutex_lock(&wrapper->mutex);
+    JitterBufferStats jitter_stats;
+    jitter_buffer_get_stats(wrapper->jitter, &jitter_stats);
+    if (jitter_stats.depth > 0) {
+        return JNI_TRUE;
+    }
 
-    if (surface == NULL) {
-        LOGD("Clearing surface (used by app-side MediaCodec decoder)");
-        if (wrapper->surface_window != NULL) {
-            ANativeWindow_release(wrapper->surface_window);
-            wrapper->surface_window = NULL;
+    const int64_t deadline = monotonic_ns() + ((int64_t)(timeoutMs > 0 ? timeoutMs : 0) * 1000000LL);
+    /* Frames already queued are looked at even past the deadline, up to a bound. */
+    for (int captures = 0; captures < PREROLL_MAX_CAPTURES; captures++) {
+        NdiVideoFrameHandle* handle = (NdiVideoFrameHandle*)calloc(1, sizeof(NdiVideoFrameHandle));
+        if (handle == NULL) {
+            LOGE("receiverPreroll: Out of memory");
+            return JNI_FALSE;
         }
+        handle->recv = wrapper->recv;
+        handle->refs = 1;
+
+        const int64_t call_start = monotonic_ns();
+        const int64_t wait_ns = (deadline > call_start) ? deadline - call_start : 0;
+        NDIlib_metadata_frame_t metadata;
+        pthread_mutex_lock(&wrapper->mutex);
+        const NDIlib_frame_type_e frame_type = g_ndi->recv_capture_v2(
+            wrapper->recv, &handle->frame, NULL, &metadata, (uint32_t)((wait_ns + 999999LL) / 1000000LL));
         pthread_mutex_unlock(&wrapper->mutex);
-        return JNI_TRUE;
+        handle->captured_ns = monotonic_ns();
+        const int64_t now = handle->captured_ns;
+        track_connection(wrapper, frame_type == NDIlib_frame_type_video);
+
+        if (frame_type == NDIlib_frame_type_metadata) {
+            consume_metadata(wrapper, &metadata);
+            free(handle);
+            continue;
+        }
+        if (frame_type != NDIlib_frame_type_video) {
+            free(handle);
+            if (now >= deadline) {
+                return JNI_FALSE;
+            }
+            continue;
+        }
+        const NDIlib_video_frame_v2_t* frame = &handle->frame;
+        if (frame->p_data != NULL && (!is_compressed_fourcc((uint32_t)frame->FourCC) || is_random_access(frame))) {
+            record_video_arrival(wrapper, handle, call_start);
+            push_video_handle(wrapper, handle);
+            return JNI_TRUE;
+        }
+        free_video_handle(wrapper, handle);
     }
+    return JNI_FALSE;
+}
 
-    ANativeWindow* window = ANativeWindow_fromSurface(env, surface);
-    if (window == NULL) {
-        pthread_mutex_unlock(&wrapper->mutex);
-        LOGE("Failed to get ANativeWindow from Surface");
-        return JNI_FALSE;
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverSetDeinterlaceMode(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr,
+        jint mode) {
+
+    (void)env;
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return;
     }
 
-    if (wrapper->surface_window != NULL) {
-        ANativeWindow_release(wrapper->surface_window);
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL || wrapper->deinterlacer == NULL) {
+        return;
     }
-    wrapper->surface_window = window;
 
-    LOGD("Surface set (ANativeWindow=%p)", (void*)window);
+    LOGD("Deinterlace mode set to %d", mode);
+    deinterlacer_set_mode(wrapper->deinterlacer, (DeinterlaceMode)mode);
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverSetTargetLatency(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr,
+        jint latencyMs) {
+
+    (void)env;
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL || wrapper->jitter == NULL) {
+        return;
+    }
+
+    LOGD("Target latency set to %d ms", latencyMs);
+    pthread_mutex_lock(&wrapper->mutex);
+    wrapper->target_latency_ns = (int64_t)latencyMs * 1000000LL;
+    if (!wrapper->low_latency) {
+        jitter_buffer_set_target(wrapper->jitter, wrapper->target_latency_ns);
+    }
     pthread_mutex_unlock(&wrapper->mutex);
-    return JNI_TRUE;
 }
 
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverSetLowLatency(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr,
+        jboolean enabled) {
+
+    (void)env;
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL || wrapper->jitter == NULL) {
+        return;
+    }
+
+    LOGD("Low-latency mode %s", enabled ? "enabled" : "disabled");
+    pthread_mutex_lock(&wrapper->mutex);
+    wrapper->low_latency = (enabled == JNI_TRUE);
+    /* Latest-frame-wins and a jitter budget pull in opposite directions: buffering is off here. */
+    jitter_buffer_set_target(wrapper->jitter, wrapper->low_latency ? 0 : wrapper->target_latency_ns);
+    pthread_mutex_unlock(&wrapper->mutex);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverIsConnected(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return JNI_FALSE;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL || wrapper->recv == NULL) {
+        return JNI_FALSE;
+    }
+
+    pthread_mutex_lock(&wrapper->mutex);
+    const int connections = g_ndi->recv_get_no_connections(wrapper->recv);
+    pthread_mutex_unlock(&wrapper->mutex);
+    return (connections > 0) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverSetSurface(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr,
+        jobject surface) {
+
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return JNI_FALSE;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL) {
+        return JNI_FALSE;
+    }
+
+    pthread_mutex_lock(&wrapper->mutex);
+
+    if (surface == NULL) {
+        LOGD("Clearing surface (used by app-side MediaCodec decoder)");
+        if (wrapper->surface_window != NULL) {
+            ANativeWindow_release(wrapper->surface_window);
+            wrapper->surface_window = NULL;
+        }
+        pthread_mutex_unlock(&wrapper->mutex);
+        return JNI_TRUE;
+    }
+
+    ANativeWindow* window = ANativeWindow_fromSurface(env, surface);
+    if (window == NULL) {
+        pthread_mutex_unlock(&wrapper->mutex);
+        LOGE("Failed to get ANativeWindow from Surface");
+        return JNI_FALSE;
+    }
+
+    if (wrapper->surface_window != NULL) {
+        ANativeWindow_release(wrapper->surface_window);
+    }
+    wrapper->surface_window = window;
+
+    LOGD("Surface set (ANativeWindow=%p)", (void*)window);
+    pthread_mutex_unlock(&wrapper->mutex);
+    return JNI_TRUE;
+}
+
+/* ============================================================================
+ * JNI Exports - Receiver Metadata
+ * ========================================================================== */
+
+/* Most subscribed events returned by one receiverPollMetadata call. */
+#define METADATA_POLL_MAX 16
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverSetMetadataSubscriptions(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr,
+        jobjectArray elements) {
+
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return JNI_FALSE;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL || wrapper->metadata == NULL) {
+        return JNI_FALSE;
+    }
+
+    const jsize count = (elements != NULL) ? (*env)->GetArrayLength(env, elements) : 0;
+    if (count > METADATA_MAX_SUBSCRIPTIONS) {
+        LOGE("receiverSetMetadataSubscriptions: %d subscriptions, at most %d supported",
+             (int)count, METADATA_MAX_SUBSCRIPTIONS);
+        return JNI_FALSE;
+    }
+
+    char* names[METADATA_MAX_SUBSCRIPTIONS];
+    bool ok = true;
+    for (jsize i = 0; i < count; i++) {
+        jstring element = (jstring)(*env)->GetObjectArrayElement(env, elements, i);
+        names[i] = jstring_to_cstring(env, element);
+        (*env)->DeleteLocalRef(env, element);
+        ok = ok && (names[i] != NULL);
+    }
+
+    if (ok) {
+        ok = metadata_inbox_subscribe(wrapper->metadata, (const char* const*)names, (int)count);
+        if (!ok) {
+            LOGE("receiverSetMetadataSubscriptions: Invalid element name");
+        }
+    }
+    for (jsize i = 0; i < count; i++) {
+        free(names[i]);
+    }
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+static jobject new_metadata_event(JNIEnv* env, jclass stringClass, const MetadataEvent* event) {
+    jstring element = (*env)->NewStringUTF(env, event->element);
+    jstring text = (*env)->NewStringUTF(env, event->text);
+    jobjectArray attributes = (*env)->NewObjectArray(env, event->attribute_count * 2, stringClass, NULL);
+    jobject result = NULL;
+
+    if (element != NULL && text != NULL && attributes != NULL) {
+        bool ok = true;
+        for (int i = 0; ok && i < event->attribute_count; i++) {
+            jstring name = (*env)->NewStringUTF(env, event->attribute_names[i]);
+            jstring value = (*env)->NewStringUTF(env, event->attribute_values[i]);
+            ok = (name != NULL && value != NULL);
+            if (ok) {
+                (*env)->SetObjectArrayElement(env, attributes, i * 2, name);
+                (*env)->SetObjectArrayElement(env, attributes, i * 2 + 1, value);
+            }
+            (*env)->DeleteLocalRef(env, name);
+            (*env)->DeleteLocalRef(env, value);
+        }
+        if (ok) {
+            result = (*env)->NewObject(
+                env,
+                g_class_MetadataEvent,
+                g_ctor_MetadataEvent,
+                element,
+                attributes,
+                text,
+                (jlong)event->timecode,
+                (jboolean)(event->truncated ? JNI_TRUE : JNI_FALSE)
+            );
+        }
+    }
+    (*env)->DeleteLocalRef(env, element);
+    (*env)->DeleteLocalRef(env, text);
+    (*env)->DeleteLocalRef(env, attributes);
+    return result;
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverPollMetadata(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr) {
+
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return NULL;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL || wrapper->metadata == NULL) {
+        return NULL;
+    }
+
+    /* Popped into a fixed batch first so nothing is allocated when there is nothing to deliver. */
+    MetadataEvent events[METADATA_POLL_MAX];
+    int count = 0;
+    while (count < METADATA_POLL_MAX && metadata_inbox_pop(wrapper->metadata, &events[count])) {
+        count++;
+    }
+    if (count == 0) {
+        return NULL;
+    }
+
+    if (!ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    jobjectArray result = (*env)->NewObjectArray(env, count, g_class_MetadataEvent, NULL);
+    for (int i = 0; result != NULL && i < count; i++) {
+        jobject event = new_metadata_event(env, g_class_String, &events[i]);
+        if (event == NULL) {
+            (*env)->DeleteLocalRef(env, result);
+            result = NULL;
+            break;
+        }
+        (*env)->SetObjectArrayElement(env, result, i, event);
+        (*env)->DeleteLocalRef(env, event);
+    }
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - Relay
+ * ========================================================================== */
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverStartRelay(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr,
+        jstring sourceName) {
+
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return JNI_FALSE;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL || wrapper->recv == NULL) {
+        return JNI_FALSE;
+    }
+
+    if (!ndi_relay_supported(g_ndi)) {
+        LOGE("receiverStartRelay: NDI runtime has no send support");
+        return JNI_FALSE;
+    }
+
+    char* name_str = jstring_to_cstring(env, sourceName);
+    if (is_empty_string(name_str)) {
+        free(name_str);
+        LOGE("receiverStartRelay: Source name is empty");
+        return JNI_FALSE;
+    }
+
+    /* A new name means a new sender: receivers of the old one reconnect by name. */
+    stop_relay(wrapper);
+    pthread_mutex_lock(&wrapper->relay_mutex);
+    wrapper->relay = ndi_relay_create(g_ndi, name_str, release_relayed_video, wrapper);
+    const bool started = (wrapper->relay != NULL);
+    pthread_mutex_unlock(&wrapper->relay_mutex);
+
+    if (started) {
+        LOGI("Relaying as '%s' from the first uncompressed frame", name_str);
+    } else {
+        LOGE("receiverStartRelay: Failed to create relay '%s'", name_str);
+    }
+    free(name_str);
+    return started ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverStopRelay(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL) {
+        return;
+    }
+    stop_relay(wrapper);
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_receiverGetRelayStats(
+        JNIEnv* env,
+        jobject thiz,
+        jlong receiverPtr) {
+
+    (void)thiz;
+
+    if (receiverPtr == 0) {
+        return NULL;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper == NULL) {
+        return NULL;
+    }
+
+    if (!ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    NdiRelayStats stats;
+    bool relaying = false;
+    pthread_mutex_lock(&wrapper->relay_mutex);
+    if (wrapper->relay != NULL) {
+        ndi_relay_get_stats(wrapper->relay, &stats);
+        relaying = true;
+    }
+    pthread_mutex_unlock(&wrapper->relay_mutex);
+
+    if (!relaying) {
+        return NULL;
+    }
+
+    return (*env)->NewObject(
+        env,
+        g_class_RelayStats,
+        g_ctor_RelayStats,
+        (jlong)stats.video_sent,
+        (jlong)stats.video_skipped,
+        (jlong)stats.video_unwatched,
+        (jlong)stats.audio_sent,
+        (jint)stats.connections,
+        stats.advertising ? JNI_TRUE : JNI_FALSE,
+        stats.compressed ? JNI_TRUE : JNI_FALSE
+    );
+}
+
+/* ============================================================================
+ * JNI Exports - Transport
+ * ========================================================================== */
+
+/* Loopback source for transportProbe: small UYVY frames, clocked by the SDK at 29.97 fps. */
+#define PROBE_SENDER_NAME "Transport Probe"
+#define PROBE_WIDTH 320
+#define PROBE_HEIGHT 180
+#define PROBE_FRAME_RATE_N 30000
+#define PROBE_FRAME_RATE_D 1001
+/* How long the probe waits for the first frame before measuring. */
+#define PROBE_CONNECT_TIMEOUT_MS 5000
+#define PROBE_CAPTURE_TIMEOUT_MS 100
+
+typedef struct ProbeSender {
+    NDIlib_send_instance_t send;
+    pthread_t thread;
+    volatile bool running;
+    uint8_t* pixels;
+} ProbeSender;
+
+static void* probe_sender_main(void* arg) {
+    ProbeSender* sender = (ProbeSender*)arg;
+
+    NDIlib_video_frame_v2_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.xres = PROBE_WIDTH;
+    frame.yres = PROBE_HEIGHT;
+    frame.FourCC = NDIlib_FourCC_video_type_UYVY;
+    frame.frame_rate_N = PROBE_FRAME_RATE_N;
+    frame.frame_rate_D = PROBE_FRAME_RATE_D;
+    frame.picture_aspect_ratio = 16.0f / 9.0f;
+    frame.frame_format_type = NDIlib_frame_format_type_progressive;
+    frame.timecode = NDIlib_send_timecode_synthesize;
+    frame.p_data = sender->pixels;
+    frame.line_stride_in_bytes = PROBE_WIDTH * 2;
+
+    while (sender->running) {
+        /* Clocked sender: returns once it is time for the next frame. */
+        g_ndi->send_send_video_v2(sender->send, &frame);
+    }
+    return NULL;
+}
+
+static bool probe_sender_start(ProbeSender* sender) {
+    memset(sender, 0, sizeof(*sender));
+    if (g_ndi->send_create == NULL || g_ndi->send_destroy == NULL || g_ndi->send_send_video_v2 == NULL ||
+        g_ndi->send_get_source_name == NULL) {
+        LOGE("transportProbe: NDI runtime has no send support for a loopback source");
+        return false;
+    }
+
+    const size_t size = (size_t)PROBE_WIDTH * 2 * PROBE_HEIGHT;
+    sender->pixels = (uint8_t*)malloc(size);
+    if (sender->pixels == NULL) {
+        LOGE("transportProbe: Out of memory");
+        return false;
+    }
+    /* Mid-grey UYVY. */
+    memset(sender->pixels, 0x80, size);
+
+    NDIlib_send_create_t settings;
+    memset(&settings, 0, sizeof(settings));
+    settings.p_ndi_name = PROBE_SENDER_NAME;
+    settings.clock_video = true;
+    settings.clock_audio = false;
+    sender->send = g_ndi->send_create(&settings);
+    if (sender->send == NULL) {
+        LOGE("transportProbe: NDIlib_send_create failed");
+        free(sender->pixels);
+        return false;
+    }
+
+    sender->running = true;
+    if (pthread_create(&sender->thread, NULL, probe_sender_main, sender) != 0) {
+        LOGE("transportProbe: pthread_create failed");
+        g_ndi->send_destroy(sender->send);
+        free(sender->pixels);
+        return false;
+    }
+    return true;
+}
+
+static void probe_sender_stop(ProbeSender* sender) {
+    sender->running = false;
+    pthread_join(sender->thread, NULL);
+    g_ndi->send_destroy(sender->send);
+    free(sender->pixels);
+}
+
+/*
+ * Point the SDK at dir through the environment, once and before it is first initialized: SDK
+ * threads read the environment, and setenv() is not safe against them. Later profiles are
+ * written into the directory set then. Returns that directory, or NULL if it cannot be set.
+ */
+static const char* claim_config_dir(const char* dir) {
+    pthread_mutex_lock(&g_init_mutex);
+    if (g_config_dir == NULL && g_ndi == NULL) {
+        char* copy = strdup(dir);
+        if (copy != NULL && setenv(TRANSPORT_CONFIG_DIR_ENV, copy, 1) == 0) {
+            g_config_dir = copy;
+        } else {
+            free(copy);
+        }
+    }
+    const char* claimed = g_config_dir;
+    pthread_mutex_unlock(&g_init_mutex);
+
+    if (claimed == NULL) {
+        LOGE("setTransportProfile: %s was not set before the SDK was loaded", TRANSPORT_CONFIG_DIR_ENV);
+    } else if (strcmp(claimed, dir) != 0) {
+        LOGW("setTransportProfile: Using %s, set for this process, instead of %s", claimed, dir);
+    }
+    return claimed;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_setTransportProfile(
+        JNIEnv* env,
+        jobject thiz,
+        jstring configDir,
+        jint mode,
+        jstring multicastPrefix,
+        jstring multicastMask,
+        jint multicastTtl) {
+
+    (void)thiz;
+
+    char* dir_str = jstring_to_cstring(env, configDir);
+    char* prefix_str = jstring_to_cstring(env, multicastPrefix);
+    char* mask_str = jstring_to_cstring(env, multicastMask);
+
+    TransportProfile profile;
+    transport_profile_init(&profile, (TransportMode)mode);
+    char json[512];
+    int length = -1;
+    if (is_empty_string(dir_str)) {
+        LOGE("setTransportProfile: Configuration directory is empty");
+    } else if (!transport_profile_set_multicast(&profile, prefix_str, mask_str, (int)multicastTtl)) {
+        LOGE("setTransportProfile: Invalid multicast group %s/%s ttl %d",
+             prefix_str ? prefix_str : "", mask_str ? mask_str : "", (int)multicastTtl);
+    } else {
+        length = transport_profile_to_json(&profile, json, sizeof(json));
+        if (length < 0) {
+            LOGE("setTransportProfile: Invalid transport mode %d", (int)mode);
+        }
+    }
+    free(prefix_str);
+    free(mask_str);
+
+    bool ok = false;
+    const char* config_dir = (length >= 0) ? claim_config_dir(dir_str) : NULL;
+    if (config_dir != NULL) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", config_dir, TRANSPORT_CONFIG_FILE);
+        if (length == 0) {
+            /* Automatic: no file, so the SDK uses its own defaults. */
+            ok = (remove(path) == 0 || errno == ENOENT);
+        } else {
+            FILE* file = fopen(path, "w");
+            if (file != NULL) {
+                ok = (fwrite(json, 1, (size_t)length, file) == (size_t)length);
+                ok = (fclose(file) == 0) && ok;
+            }
+        }
+        if (!ok) {
+            LOGE("setTransportProfile: Failed to write %s (errno=%d)", path, errno);
+        } else {
+            /* The SDK reads its configuration when it initializes. */
+            LOGI("Transport profile %d written to %s%s", (int)mode, path,
+                 g_initialized ? "; applies at the next initialize" : "");
+        }
+    }
+    free(dir_str);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_transportProbe(
+        JNIEnv* env,
+        jobject thiz,
+        jstring sourceName,
+        jint durationMs) {
+
+    (void)thiz;
+
+    if (!ensure_jni_cache(env) || !sdk_acquire("transportProbe")) {
+        return NULL;
+    }
+
+    char* name_str = jstring_to_cstring(env, sourceName);
+    const bool loopback = is_empty_string(name_str);
+    ProbeSender sender;
+    if (loopback && !probe_sender_start(&sender)) {
+        free(name_str);
+        sdk_release();
+        return NULL;
+    }
+
+    NDIlib_recv_create_v3_t settings;
+    memset(&settings, 0, sizeof(settings));
+    const NDIlib_source_t* own = loopback ? g_ndi->send_get_source_name(sender.send) : NULL;
+    if (own != NULL) {
+        settings.source_to_connect_to = *own;
+    } else if (loopback) {
+        settings.source_to_connect_to.p_ndi_name = PROBE_SENDER_NAME;
+    } else {
+        settings.source_to_connect_to.p_ndi_name = name_str;
+    }
+    settings.color_format = NDIlib_recv_color_format_fastest;
+    settings.bandwidth = NDIlib_recv_bandwidth_highest;
+    settings.allow_video_fields = true;
+    settings.p_ndi_recv_name = PROBE_SENDER_NAME;
+
+    NDIlib_recv_instance_t recv = g_ndi->recv_create_v3(&settings);
+    if (recv == NULL) {
+        LOGE("transportProbe: NDIlib_recv_create_v3 failed");
+        if (loopback) {
+            probe_sender_stop(&sender);
+        }
+        free(name_str);
+        sdk_release();
+        return NULL;
+    }
+
+    TransportProbe probe;
+    transport_probe_init(&probe);
+    const int64_t start = monotonic_ns();
+    int64_t first_frame = 0;
+    int64_t deadline = start + (int64_t)PROBE_CONNECT_TIMEOUT_MS * 1000000LL;
+
+    while (monotonic_ns() < deadline) {
+        NDIlib_video_frame_v2_t frame;
+        if (g_ndi->recv_capture_v2(recv, &frame, NULL, NULL, PROBE_CAPTURE_TIMEOUT_MS) != NDIlib_frame_type_video) {
+            continue;
+        }
+        const int64_t arrival = monotonic_ns();
+        if (first_frame == 0) {
+            /* Measure for the requested duration from the first frame on. */
+            first_frame = arrival;
+            deadline = arrival + (int64_t)durationMs * 1000000LL;
+        }
+        const int64_t interval_ns = (frame.frame_rate_N > 0)
+            ? (int64_t)frame.frame_rate_D * 1000000000LL / frame.frame_rate_N
+            : 0;
+        /* Sender timestamps are in 100 ns units. */
+        const int64_t sent = (frame.timestamp != NDIlib_recv_timestamp_undefined) ? frame.timestamp : frame.timecode;
+        transport_probe_add(&probe, sent * 100LL, arrival, interval_ns);
+        g_ndi->recv_free_video_v2(recv, &frame);
+    }
+
+    g_ndi->recv_destroy(recv);
+    if (loopback) {
+        probe_sender_stop(&sender);
+    }
+    sdk_release();
+
+    TransportProbeResult result;
+    transport_probe_result(&probe, &result);
+    LOGI("transportProbe %s: %" PRIu64 " frames, %" PRIu64 " lost, jitter %.2f ms",
+         loopback ? "(loopback)" : name_str, result.frames, result.lost, (double)result.jitter_ns / 1e6);
+    free(name_str);
+
+    return (*env)->NewObject(
+        env,
+        g_class_TransportProbeResult,
+        g_ctor_TransportProbeResult,
+        (jlong)result.frames,
+        (jlong)result.lost,
+        (jdouble)result.loss_rate,
+        (jlong)result.jitter_ns,
+        (jlong)result.max_deviation_ns,
+        (jlong)(first_frame != 0 ? (first_frame - start) / 1000000LL : -1)
+    );
+}
+
+/* ============================================================================
+ * JNI Exports - Source Preview
+ * ========================================================================== */
+
+/*
+ * Preview receivers pull the lowest-bandwidth stream of a source for a list thumbnail. They do
+ * not go through the frame arena, jitter buffer or stage profiler, so previews never take
+ * budget or timing from a playing receiver. Only the preview worker uses them.
+ */
+#define PREVIEW_RECEIVER_NAME "Preview"
+
+typedef struct NdiPreviewWrapper {
+    NDIlib_recv_instance_t recv;
+} NdiPreviewWrapper;
+
+static bool thumbnail_format_for(NDIlib_FourCC_video_type_e fourcc, ThumbnailFormat* format) {
+    switch (fourcc) {
+        case NDIlib_FourCC_video_type_UYVY:
+        case NDIlib_FourCC_video_type_UYVA:   /* UYVY plane first; the alpha plane is ignored. */
+            *format = THUMBNAIL_UYVY;
+            return true;
+        case NDIlib_FourCC_video_type_BGRA:
+            *format = THUMBNAIL_BGRA;
+            return true;
+        case NDIlib_FourCC_video_type_BGRX:
+            *format = THUMBNAIL_BGRX;
+            return true;
+        case NDIlib_FourCC_video_type_RGBA:
+            *format = THUMBNAIL_RGBA;
+            return true;
+        case NDIlib_FourCC_video_type_RGBX:
+            *format = THUMBNAIL_RGBX;
+            return true;
+        default:
+            return false;
+    }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_previewCreate(
+        JNIEnv* env,
+        jobject thiz,
+        jstring sourceName) {
+
+    (void)thiz;
+
+    char* name_str = jstring_to_cstring(env, sourceName);
+    if (is_empty_string(name_str)) {
+        free(name_str);
+        LOGE("previewCreate: Source name is empty");
+        return 0;
+    }
+    if (!sdk_acquire("previewCreate")) {
+        free(name_str);
+        return 0;
+    }
+
+    NdiPreviewWrapper* wrapper = (NdiPreviewWrapper*)calloc(1, sizeof(NdiPreviewWrapper));
+    if (wrapper == NULL) {
+        free(name_str);
+        LOGE("previewCreate: Out of memory");
+        sdk_release();
+        return 0;
+    }
+
+    /* Lowest bandwidth is the sender's proxy stream; UYVY needs no conversion by the SDK. */
+    NDIlib_recv_create_v3_t settings;
+    memset(&settings, 0, sizeof(settings));
+    settings.source_to_connect_to.p_ndi_name = name_str;
+    settings.source_to_connect_to.p_url_address = NULL;
+    settings.color_format = NDIlib_recv_color_format_UYVY_BGRA;
+    settings.bandwidth = NDIlib_recv_bandwidth_lowest;
+    settings.allow_video_fields = false;
+    settings.p_ndi_recv_name = PREVIEW_RECEIVER_NAME;
+
+    wrapper->recv = g_ndi->recv_create_v3(&settings);
+    if (wrapper->recv == NULL) {
+        LOGE("previewCreate: NDIlib_recv_create_v3 failed for '%s'", name_str);
+        free(name_str);
+        free(wrapper);
+        sdk_release();
+        return 0;
+    }
+
+    LOGD("Preview receiver created for '%s'", name_str);
+    free(name_str);
+    return (jlong)(intptr_t)wrapper;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_previewDestroy(
+        JNIEnv* env,
+        jobject thiz,
+        jlong previewPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    NdiPreviewWrapper* wrapper = (NdiPreviewWrapper*)(intptr_t)previewPtr;
+    if (wrapper == NULL) {
+        return;
+    }
+    g_ndi->recv_destroy(wrapper->recv);
+    free(wrapper);
+    sdk_release();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_previewCapture(
+        JNIEnv* env,
+        jobject thiz,
+        jlong previewPtr,
+        jintArray pixels,
+        jint width,
+        jint height,
+        jint timeoutMs) {
+
+    (void)thiz;
+
+    NdiPreviewWrapper* wrapper = (NdiPreviewWrapper*)(intptr_t)previewPtr;
+    if (wrapper == NULL || pixels == NULL || width <= 0 || height <= 0 ||
+        (*env)->GetArrayLength(env, pixels) < width * height) {
+        LOGE("previewCapture: Invalid arguments (%dx%d)", width, height);
+        return JNI_FALSE;
+    }
+    if (!g_initialized) {
+        return JNI_FALSE;
+    }
+
+    /* Only the newest frame matters: free whatever queued since the last refresh. */
+    NDIlib_video_frame_v2_t frame;
+    NDIlib_video_frame_v2_t newer;
+    bool have_frame = false;
+    while (g_ndi->recv_capture_v2(wrapper->recv, &newer, NULL, NULL, 0) == NDIlib_frame_type_video) {
+        if (have_frame) {
+            g_ndi->recv_free_video_v2(wrapper->recv, &frame);
+        }
+        frame = newer;
+        have_frame = true;
+    }
+    if (!have_frame) {
+        have_frame = g_ndi->recv_capture_v2(wrapper->recv, &frame, NULL, NULL, (uint32_t)timeoutMs) ==
+                     NDIlib_frame_type_video;
+    }
+    if (!have_frame) {
+        return JNI_FALSE;
+    }
+
+    ThumbnailFormat format;
+    bool ok = false;
+    if (!thumbnail_format_for(frame.FourCC, &format)) {
+        LOGW("previewCapture: Unsupported FourCC 0x%08x", (unsigned)frame.FourCC);
+    } else {
+        uint32_t* dst = (uint32_t*)(*env)->GetPrimitiveArrayCritical(env, pixels, NULL);
+        if (dst != NULL) {
+            ok = thumbnail_scale(frame.p_data, frame.line_stride_in_bytes, frame.xres, frame.yres, format,
+                                 dst, width, height);
+            (*env)->ReleasePrimitiveArrayCritical(env, pixels, dst, ok ? 0 : JNI_ABORT);
+        }
+    }
+    g_ndi->recv_free_video_v2(wrapper->recv, &frame);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+/* ============================================================================
+ * JNI Exports - Frame Pacing
+ * ========================================================================== */
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_pacerCreate(
+        JNIEnv* env,
+        jobject thiz,
+        jint capacity) {
+
+    (void)env;
+    (void)thiz;
+
+    FramePacer* pacer = frame_pacer_create(capacity);
+    if (pacer == NULL) {
+        LOGE("Failed to create frame pacer (out of memory)");
+        return 0;
+    }
+    LOGD("Frame pacer created (capacity=%d)", capacity);
+    return (jlong)(intptr_t)pacer;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_pacerDestroy(
+        JNIEnv* env,
+        jobject thiz,
+        jlong pacerPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (pacerPtr == 0) {
+        return;
+    }
+    frame_pacer_destroy((FramePacer*)(intptr_t)pacerPtr);
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_pacerReset(
+        JNIEnv* env,
+        jobject thiz,
+        jlong pacerPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (pacerPtr == 0) {
+        return;
+    }
+    frame_pacer_reset((FramePacer*)(intptr_t)pacerPtr);
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_pacerSetDelay(
+        JNIEnv* env,
+        jobject thiz,
+        jlong pacerPtr,
+        jlong delayNs) {
+
+    (void)env;
+    (void)thiz;
+
+    if (pacerPtr == 0) {
+        return;
+    }
+    frame_pacer_set_delay((FramePacer*)(intptr_t)pacerPtr, delayNs);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_pacerEnqueue(
+        JNIEnv* env,
+        jobject thiz,
+        jlong pacerPtr,
+        jint frameId,
+        jlong timestamp,
+        jlong durationNs,
+        jlong nowNs) {
+
+    (void)env;
+    (void)thiz;
+
+    if (pacerPtr == 0) {
+        return frameId;
+    }
+    return (jint)frame_pacer_enqueue((FramePacer*)(intptr_t)pacerPtr, frameId, timestamp, durationNs, nowNs);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_pacerOnVsync(
+        JNIEnv* env,
+        jobject thiz,
+        jlong pacerPtr,
+        jlong vsyncNs,
+        jlong periodNs,
+        jintArray dropped) {
+
+    (void)thiz;
+
+    if (pacerPtr == 0 || dropped == NULL) {
+        return -1;
+    }
+
+    int64_t ids[FRAME_PACER_MAX_CAPACITY];
+    jint out[FRAME_PACER_MAX_CAPACITY];
+    int capacity = (int)(*env)->GetArrayLength(env, dropped);
+    if (capacity > FRAME_PACER_MAX_CAPACITY) {
+        capacity = FRAME_PACER_MAX_CAPACITY;
+    }
+
+    int count = 0;
+    const int64_t present = frame_pacer_on_vsync(
+        (FramePacer*)(intptr_t)pacerPtr, vsyncNs, periodNs, ids, capacity, &count);
+
+    /* Dropped ids first, then -1 to terminate when there is room. */
+    for (int i = 0; i < count; i++) {
+        out[i] = (jint)ids[i];
+    }
+    int written = count;
+    if (count < capacity) {
+        out[written++] = -1;
+    }
+    (*env)->SetIntArrayRegion(env, dropped, 0, written, out);
+    return (jint)present;
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_pacerGetStats(
+        JNIEnv* env,
+        jobject thiz,
+        jlong pacerPtr) {
+
+    (void)thiz;
+
+    if (pacerPtr == 0) {
+        return NULL;
+    }
+
+    if (!ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    FramePacerStats stats;
+    frame_pacer_get_stats((FramePacer*)(intptr_t)pacerPtr, &stats);
+
+    jlongArray histogram = (*env)->NewLongArray(env, FRAME_PACER_HISTOGRAM_BUCKETS);
+    if (histogram == NULL) {
+        return NULL;
+    }
+    jlong buckets[FRAME_PACER_HISTOGRAM_BUCKETS];
+    for (int i = 0; i < FRAME_PACER_HISTOGRAM_BUCKETS; i++) {
+        buckets[i] = (jlong)stats.histogram[i];
+    }
+    (*env)->SetLongArrayRegion(env, histogram, 0, FRAME_PACER_HISTOGRAM_BUCKETS, buckets);
+
+    const int64_t mean = (stats.presented > 0) ? (stats.error_sum_ns / (int64_t)stats.presented) : 0;
+
+    jobject result = (*env)->NewObject(
+        env,
+        g_class_PacerStats,
+        g_ctor_PacerStats,
+        (jlong)stats.enqueued,
+        (jlong)stats.presented,
+        (jlong)stats.dropped,
+        (jlong)stats.repeated,
+        (jlong)stats.rejected,
+        (jlong)stats.resyncs,
+        (jint)stats.queue_depth,
+        (jlong)stats.vsync_period_ns,
+        (jlong)stats.error_min_ns,
+        (jlong)stats.error_max_ns,
+        (jlong)mean,
+        (jlong)frame_pacer_error_percentile_ns(&stats, 50.0),
+        (jlong)frame_pacer_error_percentile_ns(&stats, 99.0),
+        (jlong)FRAME_PACER_HISTOGRAM_BUCKET_NS,
+        histogram
+    );
+    (*env)->DeleteLocalRef(env, histogram);
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - Frame Arena
+ * ========================================================================== */
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_arenaSetBudget(
+        JNIEnv* env,
+        jobject thiz,
+        jlong budgetBytes) {
+
+    (void)env;
+    (void)thiz;
+
+    FrameArena* arena = get_arena();
+    if (arena == NULL) {
+        return;
+    }
+    LOGD("Frame memory budget set to %" PRId64 " bytes", (int64_t)budgetBytes);
+    frame_arena_set_budget(arena, (int64_t)budgetBytes);
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_arenaAlloc(
+        JNIEnv* env,
+        jobject thiz,
+        jint consumer,
+        jint size) {
+
+    (void)thiz;
+
+    FrameArena* arena = get_arena();
+    if (arena == NULL || size <= 0) {
+        return NULL;
+    }
+
+    void* data = frame_arena_alloc(arena, (int)consumer, (size_t)size);
+    if (data == NULL) {
+        return NULL;
+    }
+
+    jobject byteBuffer = (*env)->NewDirectByteBuffer(env, data, (jlong)size);
+    if (byteBuffer == NULL) {
+        LOGE("arenaAlloc: NewDirectByteBuffer failed");
+        frame_arena_free(arena, data);
+        return NULL;
+    }
+    return byteBuffer;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_arenaFree(
+        JNIEnv* env,
+        jobject thiz,
+        jobject buffer) {
+
+    (void)thiz;
+
+    if (buffer == NULL || g_arena == NULL) {
+        return;
+    }
+    frame_arena_free(g_arena, (*env)->GetDirectBufferAddress(env, buffer));
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_arenaReserve(
+        JNIEnv* env,
+        jobject thiz,
+        jint consumer,
+        jlong bytes) {
+
+    (void)env;
+    (void)thiz;
+
+    FrameArena* arena = get_arena();
+    if (arena == NULL) {
+        /* No arena means no budget to enforce. */
+        return JNI_TRUE;
+    }
+    return frame_arena_reserve(arena, (int)consumer, (int64_t)bytes) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_arenaUnreserve(
+        JNIEnv* env,
+        jobject thiz,
+        jint consumer,
+        jlong bytes) {
+
+    (void)env;
+    (void)thiz;
+
+    if (g_arena == NULL) {
+        return;
+    }
+    frame_arena_unreserve(g_arena, (int)consumer, (int64_t)bytes);
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_arenaTrim(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)env;
+    (void)thiz;
+
+    if (g_arena == NULL) {
+        return;
+    }
+    frame_arena_trim(g_arena);
+}
+
+static jlongArray new_long_array(JNIEnv* env, const jlong* values, jsize count) {
+    jlongArray array = (*env)->NewLongArray(env, count);
+    if (array != NULL) {
+        (*env)->SetLongArrayRegion(env, array, 0, count, values);
+    }
+    return array;
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_arenaGetStats(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)thiz;
+
+    FrameArena* arena = get_arena();
+    if (arena == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+
+    jlong current[FRAME_ARENA_MAX_CONSUMERS];
+    jlong peak[FRAME_ARENA_MAX_CONSUMERS];
+    jlong rejected[FRAME_ARENA_MAX_CONSUMERS];
+    for (int i = 0; i < FRAME_ARENA_MAX_CONSUMERS; i++) {
+        current[i] = (jlong)stats.consumers[i].current_bytes;
+        peak[i] = (jlong)stats.consumers[i].peak_bytes;
+        rejected[i] = (jlong)stats.consumers[i].rejected;
+    }
+
+    jlongArray currentArray = new_long_array(env, current, FRAME_ARENA_MAX_CONSUMERS);
+    jlongArray peakArray = new_long_array(env, peak, FRAME_ARENA_MAX_CONSUMERS);
+    jlongArray rejectedArray = new_long_array(env, rejected, FRAME_ARENA_MAX_CONSUMERS);
+    jobject result = NULL;
+    if (currentArray != NULL && peakArray != NULL && rejectedArray != NULL) {
+        result = (*env)->NewObject(
+            env,
+            g_class_ArenaStats,
+            g_ctor_ArenaStats,
+            (jlong)stats.budget_bytes,
+            (jlong)stats.used_bytes,
+            (jlong)stats.cached_bytes,
+            (jlong)stats.peak_used_bytes,
+            (jlong)stats.allocs,
+            (jlong)stats.reuses,
+            (jlong)stats.rejected,
+            currentArray,
+            peakArray,
+            rejectedArray
+        );
+    }
+    (*env)->DeleteLocalRef(env, currentArray);
+    (*env)->DeleteLocalRef(env, peakArray);
+    (*env)->DeleteLocalRef(env, rejectedArray);
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - Thread Placement
+ * ========================================================================== */
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_threadPlacementConfigure(
+        JNIEnv* env,
+        jobject thiz,
+        jboolean enabled,
+        jstring coreMap) {
+
+    (void)thiz;
+
+    ThreadPlacement* tp = get_placement();
+    if (tp == NULL) {
+        return JNI_FALSE;
+    }
+
+    g_placement_enabled = enabled == JNI_TRUE;
+    if (!g_placement_enabled) {
+        /* Threads keep their current placement until they next start. */
+        LOGI("Thread placement disabled");
+        return JNI_TRUE;
+    }
+
+    /* An explicit core map wins; otherwise the debug property lets a device be tuned without a rebuild. */
+    char property[PROP_VALUE_MAX] = { 0 };
+    const char* spec = NULL;
+    if (coreMap != NULL) {
+        spec = (*env)->GetStringUTFChars(env, coreMap, NULL);
+    }
+    const char* effective = spec;
+    if ((effective == NULL || effective[0] == '\0') && __system_property_get(CORE_MAP_PROPERTY, property) > 0) {
+        effective = property;
+    }
+
+    ThreadPlacementConfig config;
+    thread_placement_default_config(&g_topology, &config);
+    const bool ok = thread_placement_parse(effective, &g_topology, &config);
+    if (ok) {
+        LOGI("Thread placement enabled (core map: %s)", (effective != NULL && effective[0] != '\0') ? effective : "default");
+        thread_placement_configure(tp, &config);
+    } else {
+        LOGW("Invalid core map \"%s\"; keeping the previous placement", effective);
+    }
+
+    if (spec != NULL) {
+        (*env)->ReleaseStringUTFChars(env, coreMap, spec);
+    }
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_threadPlacementApply(
+        JNIEnv* env,
+        jobject thiz,
+        jint role) {
+
+    (void)env;
+    (void)thiz;
+
+    ThreadPlacement* tp = get_placement();
+    if (tp == NULL || !g_placement_enabled) {
+        return 0;
+    }
+
+    const pid_t tid = thread_placement_gettid();
+    const int error = thread_placement_apply(tp, (ThreadRole)role, tid);
+    if (error != 0) {
+        LOGW("Thread %d (role %d) placement failed: %s", (int)tid, (int)role, strerror(error));
+    }
+    return (jint)error;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_threadPlacementRelease(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)env;
+    (void)thiz;
+
+    if (g_placement == NULL) {
+        return;
+    }
+    thread_placement_unregister(g_placement, thread_placement_gettid());
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_threadPlacementGetStats(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)thiz;
+
+    ThreadPlacement* tp = get_placement();
+    if (tp == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    /* Each call is one verification sample; migrations are counted between calls. */
+    thread_placement_sample(tp);
+    ThreadPlacementInfo info[THREAD_PLACEMENT_MAX_THREADS];
+    const int count = thread_placement_get_threads(tp, info, THREAD_PLACEMENT_MAX_THREADS);
+
+    jobjectArray threads = (*env)->NewObjectArray(env, count, g_class_PlacedThread, NULL);
+    if (threads == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        jobject thread = (*env)->NewObject(
+            env,
+            g_class_PlacedThread,
+            g_ctor_PlacedThread,
+            (jint)info[i].role,
+            (jint)info[i].tid,
+            (jlong)info[i].requested_mask,
+            (jlong)info[i].actual_mask,
+            (jint)(info[i].nice_set ? info[i].requested_nice : info[i].nice),
+            (jint)info[i].nice,
+            (jint)info[i].cpu,
+            (jlong)info[i].samples,
+            (jlong)info[i].off_mask_samples,
+            (jlong)info[i].migrations,
+            (jint)info[i].error
+        );
+        if (thread == NULL) {
+            (*env)->DeleteLocalRef(env, threads);
+            return NULL;
+        }
+        (*env)->SetObjectArrayElement(env, threads, i, thread);
+        (*env)->DeleteLocalRef(env, thread);
+    }
+
+    jobject result = (*env)->NewObject(
+        env,
+        g_class_ThreadPlacementStats,
+        g_ctor_ThreadPlacementStats,
+        g_placement_enabled ? JNI_TRUE : JNI_FALSE,
+        (jint)g_topology.cpu_count,
+        (jlong)g_topology.big_mask,
+        (jlong)g_topology.little_mask,
+        threads
+    );
+    (*env)->DeleteLocalRef(env, threads);
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - Stage Profiling
+ * ========================================================================== */
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_stageBegin(
+        JNIEnv* env,
+        jobject thiz,
+        jint stage) {
+
+    (void)env;
+    (void)thiz;
+
+    if (stage < 0 || stage >= PIPELINE_STAGE_COUNT) {
+        return;
+    }
+    NDI_TRACE_BEGIN(g_stage_trace_names[stage]);
+    stage_mark_begin(&g_stage_marks[stage]);
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_stageEnd(
+        JNIEnv* env,
+        jobject thiz,
+        jint stage) {
+
+    (void)env;
+    (void)thiz;
+
+    if (stage < 0 || stage >= PIPELINE_STAGE_COUNT) {
+        return;
+    }
+    NDI_TRACE_END();
+    StageProfiler* profiler = get_profiler();
+    if (profiler == NULL) {
+        return;
+    }
+    stage_mark_end(profiler, (PipelineStage)stage, &g_stage_marks[stage]);
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_getStageStats(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)thiz;
+
+    StageProfiler* profiler = get_profiler();
+    if (profiler == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    const int64_t now = monotonic_ns();
+    StageProfilerStats stats;
+    stage_profiler_get_stats(profiler, now, &stats);
+    ThreadCpuUsage threads[STAGE_STATS_MAX_THREADS];
+    int64_t interval_ns = 0;
+    const int thread_count = stage_profiler_sample_threads(
+        profiler, STAGE_PROFILER_TASK_DIR, now, threads, STAGE_STATS_MAX_THREADS, &interval_ns);
+
+    jlong count[PIPELINE_STAGE_COUNT];
+    jlong wall_total[PIPELINE_STAGE_COUNT];
+    jlong wall_max[PIPELINE_STAGE_COUNT];
+    jlong cpu_total[PIPELINE_STAGE_COUNT];
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        count[i] = (jlong)stats.stages[i].count;
+        wall_total[i] = (jlong)stats.stages[i].wall_total_ns;
+        wall_max[i] = (jlong)stats.stages[i].wall_max_ns;
+        cpu_total[i] = (jlong)stats.stages[i].cpu_total_ns;
+    }
+
+    jobjectArray threadArray = (*env)->NewObjectArray(env, thread_count, g_class_ThreadCpu, NULL);
+    if (threadArray == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < thread_count; i++) {
+        jstring name = (*env)->NewStringUTF(env, threads[i].name);
+        if (name == NULL) {
+            (*env)->DeleteLocalRef(env, threadArray);
+            return NULL;
+        }
+        jobject thread = (*env)->NewObject(
+            env,
+            g_class_ThreadCpu,
+            g_ctor_ThreadCpu,
+            (jint)threads[i].tid,
+            name,
+            (jlong)threads[i].cpu_ns,
+            (jlong)threads[i].total_cpu_ns
+        );
+        (*env)->DeleteLocalRef(env, name);
+        if (thread == NULL) {
+            (*env)->DeleteLocalRef(env, threadArray);
+            return NULL;
+        }
+        (*env)->SetObjectArrayElement(env, threadArray, i, thread);
+        (*env)->DeleteLocalRef(env, thread);
+    }
+
+    jlongArray countArray = new_long_array(env, count, PIPELINE_STAGE_COUNT);
+    jlongArray wallTotalArray = new_long_array(env, wall_total, PIPELINE_STAGE_COUNT);
+    jlongArray wallMaxArray = new_long_array(env, wall_max, PIPELINE_STAGE_COUNT);
+    jlongArray cpuTotalArray = new_long_array(env, cpu_total, PIPELINE_STAGE_COUNT);
+    jobject result = NULL;
+    if (countArray != NULL && wallTotalArray != NULL && wallMaxArray != NULL && cpuTotalArray != NULL) {
+        result = (*env)->NewObject(
+            env,
+            g_class_StageStats,
+            g_ctor_StageStats,
+            (jlong)stats.window_ns,
+            (jlong)interval_ns,
+            countArray,
+            wallTotalArray,
+            wallMaxArray,
+            cpuTotalArray,
+            threadArray
+        );
+    }
+    (*env)->DeleteLocalRef(env, countArray);
+    (*env)->DeleteLocalRef(env, wallTotalArray);
+    (*env)->DeleteLocalRef(env, wallMaxArray);
+    (*env)->DeleteLocalRef(env, cpuTotalArray);
+    (*env)->DeleteLocalRef(env, threadArray);
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - Latency
+ * ========================================================================== */
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_latencyMark(
+        JNIEnv* env,
+        jobject thiz,
+        jint stage,
+        jlong captureNs) {
+
+    (void)env;
+    (void)thiz;
+
+    LatencyTracker* latency = get_latency();
+    if (latency == NULL || stage < 0 || stage >= LATENCY_STAGE_COUNT) {
+        return;
+    }
+    latency_tracker_record(latency, (LatencyStage)stage, (int64_t)captureNs, monotonic_ns());
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_latencyReset(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)env;
+    (void)thiz;
+
+    LatencyTracker* latency = get_latency();
+    if (latency != NULL) {
+        latency_tracker_reset(latency);
+    }
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_getLatencyStats(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)thiz;
+
+    LatencyTracker* latency = get_latency();
+    if (latency == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    LatencyStats stats;
+    latency_tracker_get_stats(latency, monotonic_ns(), &stats);
+
+    jlong count[LATENCY_STAGE_COUNT];
+    jlong p50[LATENCY_STAGE_COUNT];
+    jlong p95[LATENCY_STAGE_COUNT];
+    jlong p99[LATENCY_STAGE_COUNT];
+    jlong max[LATENCY_STAGE_COUNT];
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        count[i] = (jlong)stats.stages[i].count;
+        p50[i] = (jlong)stats.stages[i].p50_ns;
+        p95[i] = (jlong)stats.stages[i].p95_ns;
+        p99[i] = (jlong)stats.stages[i].p99_ns;
+        max[i] = (jlong)stats.stages[i].max_ns;
+    }
+
+    jlongArray countArray = new_long_array(env, count, LATENCY_STAGE_COUNT);
+    jlongArray p50Array = new_long_array(env, p50, LATENCY_STAGE_COUNT);
+    jlongArray p95Array = new_long_array(env, p95, LATENCY_STAGE_COUNT);
+    jlongArray p99Array = new_long_array(env, p99, LATENCY_STAGE_COUNT);
+    jlongArray maxArray = new_long_array(env, max, LATENCY_STAGE_COUNT);
+    jobject result = NULL;
+    if (countArray != NULL && p50Array != NULL && p95Array != NULL && p99Array != NULL && maxArray != NULL) {
+        result = (*env)->NewObject(
+            env,
+            g_class_LatencyStats,
+            g_ctor_LatencyStats,
+            (jlong)stats.elapsed_ns,
+            countArray,
+            p50Array,
+            p95Array,
+            p99Array,
+            maxArray
+        );
+    }
+    (*env)->DeleteLocalRef(env, countArray);
+    (*env)->DeleteLocalRef(env, p50Array);
+    (*env)->DeleteLocalRef(env, p95Array);
+    (*env)->DeleteLocalRef(env, p99Array);
+    (*env)->DeleteLocalRef(env, maxArray);
+    return result;
+}
+
+/* ============================================================================
+ * JNI Exports - Pixel Conversion
+ * ========================================================================== */
+
+#define P216_TARGET_P010 0
+#define P216_TARGET_NV12_DITHERED 1
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_convertP216(
+        JNIEnv* env,
+        jobject thiz,
+        jobject src,
+        jint width,
+        jint height,
+        jint strideBytes,
+        jbyteArray dst,
+        jint target) {
+
+    (void)thiz;
+
+    if (src == NULL || dst == NULL || width <= 0 || height <= 0 || strideBytes < width * 2) {
+        LOGE("convertP216: Invalid arguments (%dx%d stride=%d)", width, height, strideBytes);
+        return JNI_FALSE;
+    }
+
+    const uint8_t* src_data = (const uint8_t*)(*env)->GetDirectBufferAddress(env, src);
+    const jlong src_capacity = (*env)->GetDirectBufferCapacity(env, src);
+    if (src_data == NULL || src_capacity < (jlong)strideBytes * height * 2) {
+        LOGE("convertP216: Source must be a direct buffer of at least %" PRId64 " bytes",
+             (int64_t)strideBytes * height * 2);
+        return JNI_FALSE;
+    }
+
+    size_t required = 0;
+    switch (target) {
+        case P216_TARGET_P010:
+            required = pixel_p010_size(width, height);
+            break;
+        case P216_TARGET_NV12_DITHERED:
+            required = pixel_nv12_size(width, height);
+            break;
+        default:
+            LOGE("convertP216: Unknown target %d", target);
+            return JNI_FALSE;
+    }
+
+    if ((size_t)(*env)->GetArrayLength(env, dst) < required) {
+        LOGE("convertP216: Destination too small (need %zu bytes)", required);
+        return JNI_FALSE;
+    }
+
+    uint8_t* dst_data = (uint8_t*)(*env)->GetPrimitiveArrayCritical(env, dst, NULL);
+    if (dst_data == NULL) {
+        LOGE("convertP216: Failed to pin destination array");
+        return JNI_FALSE;
+    }
+
+    const bool ok = (target == P216_TARGET_P010)
+        ? pixel_p216_to_p010(src_data, strideBytes, width, height, dst_data)
+        : pixel_p216_to_nv12_dithered(src_data, strideBytes, width, height, dst_data);
+
+    (*env)->ReleasePrimitiveArrayCritical(env, dst, dst_data, ok ? 0 : JNI_ABORT);
+
+    if (!ok) {
+        LOGE("convertP216: Conversion rejected (%dx%d stride=%d)", width, height, strideBytes);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+static bool scaler_format_for(NDIlib_FourCC_video_type_e fourcc, ScalerFormat* format) {
+    switch (fourcc) {
+        case NDIlib_FourCC_video_type_UYVY:
+        case NDIlib_FourCC_video_type_UYVA:   /* UYVY plane first; the alpha plane is ignored. */
+            *format = SCALER_UYVY;
+            return true;
+        case NDIlib_FourCC_video_type_BGRA:
+            *format = SCALER_BGRA;
+            return true;
+        case NDIlib_FourCC_video_type_BGRX:
+            *format = SCALER_BGRX;
+            return true;
+        case NDIlib_FourCC_video_type_RGBA:
+            *format = SCALER_RGBA;
+            return true;
+        case NDIlib_FourCC_video_type_RGBX:
+            *format = SCALER_RGBX;
+            return true;
+        default:
+            return false;
+    }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_scalerCreate(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)env;
+    (void)thiz;
+
+    FrameScaler* fs = frame_scaler_create();
+    if (fs == NULL) {
+        LOGE("Failed to create frame scaler (out of memory)");
+        return 0;
+    }
+    return (jlong)(intptr_t)fs;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_scalerDestroy(
+        JNIEnv* env,
+        jobject thiz,
+        jlong scalerPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    frame_scaler_destroy((FrameScaler*)(intptr_t)scalerPtr);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_scalerScale(
+        JNIEnv* env,
+        jobject thiz,
+        jlong scalerPtr,
+        jobject src,
+        jint srcStrideBytes,
+        jint srcWidth,
+        jint srcHeight,
+        jint fourCC,
+        jobject dst,
+        jint dstStrideBytes,
+        jint dstWidth,
+        jint dstHeight,
+        jint filter) {
+
+    (void)thiz;
+
+    if (scalerPtr == 0 || src == NULL || dst == NULL || srcStrideBytes <= 0 || srcHeight <= 0 ||
+        dstStrideBytes <= 0 || dstHeight <= 0) {
+        LOGE("scalerScale: Invalid arguments (%dx%d stride=%d -> %dx%d stride=%d)",
+             srcWidth, srcHeight, srcStrideBytes, dstWidth, dstHeight, dstStrideBytes);
+        return JNI_FALSE;
+    }
+
+    ScalerFormat format;
+    if (!scaler_format_for((NDIlib_FourCC_video_type_e)fourCC, &format)) {
+        LOGW("scalerScale: Unsupported FourCC 0x%08x", (unsigned)fourCC);
+        return JNI_FALSE;
+    }
+
+    const uint8_t* src_data = (const uint8_t*)(*env)->GetDirectBufferAddress(env, src);
+    const jlong src_capacity = (*env)->GetDirectBufferCapacity(env, src);
+    uint8_t* dst_data = (uint8_t*)(*env)->GetDirectBufferAddress(env, dst);
+    const jlong dst_capacity = (*env)->GetDirectBufferCapacity(env, dst);
+    if (src_data == NULL || src_capacity < (jlong)srcStrideBytes * srcHeight ||
+        dst_data == NULL || dst_capacity < (jlong)dstStrideBytes * dstHeight) {
+        LOGE("scalerScale: Source and destination must be direct buffers of %" PRId64 " and %" PRId64 " bytes",
+             (int64_t)srcStrideBytes * srcHeight, (int64_t)dstStrideBytes * dstHeight);
+        return JNI_FALSE;
+    }
+
+    if (!frame_scaler_scale((FrameScaler*)(intptr_t)scalerPtr, src_data, srcStrideBytes, srcWidth, srcHeight,
+                            format, dst_data, dstStrideBytes, dstWidth, dstHeight, (ScalerFilter)filter)) {
+        LOGE("scalerScale: Scale rejected (%dx%d stride=%d -> %dx%d, filter %d)",
+             srcWidth, srcHeight, srcStrideBytes, dstWidth, dstHeight, filter);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+/* ============================================================================
+ * JNI Exports - Recording Metadata
+ * ========================================================================== */
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_probeMp4(
+        JNIEnv* env,
+        jobject thiz,
+        jstring path) {
+
+    (void)thiz;
+
+    if (!ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    char* path_str = jstring_to_cstring(env, path);
+    if (is_empty_string(path_str)) {
+        free(path_str);
+        LOGE("probeMp4: Path is empty");
+        return NULL;
+    }
+
+    Mp4Info info;
+    const bool ok = mp4_probe_path(path_str, &info);
+    if (!ok) {
+        LOGD("probeMp4: No complete moov in %s", path_str);
+    }
+    free(path_str);
+    if (!ok) {
+        return NULL;
+    }
+
+    return (*env)->NewObject(
+        env,
+        g_class_Mp4Info,
+        g_ctor_Mp4Info,
+        (jlong)info.duration_ms,
+        (jint)info.width,
+        (jint)info.height,
+        (jint)info.video_codec,
+        info.fragmented ? JNI_TRUE : JNI_FALSE
+    );
+}
+
+/* ============================================================================
+ * JNI Exports - Adaptive Bandwidth
+ * ========================================================================== */
+
+/* NdiNative.Bandwidth value of a controller level. */
+static jint bandwidth_level_to_java(BandwidthLevel level) {
+    return (level == BANDWIDTH_LEVEL_LOWEST) ? 2 : 3;
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_bandwidthCreate(
+        JNIEnv* env,
+        jobject thiz) {
+
+    (void)env;
+    (void)thiz;
+
+    BandwidthController* bc = bandwidth_controller_create();
+    if (bc == NULL) {
+        LOGE("Failed to create bandwidth controller (out of memory)");
+        return 0;
+    }
+    return (jlong)(intptr_t)bc;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_bandwidthDestroy(
+        JNIEnv* env,
+        jobject thiz,
+        jlong controllerPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (controllerPtr == 0) {
+        return;
+    }
+    bandwidth_controller_destroy((BandwidthController*)(intptr_t)controllerPtr);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_bandwidthUpdate(
+        JNIEnv* env,
+        jobject thiz,
+        jlong controllerPtr,
+        jlong frames,
+        jlong dropped,
+        jint queueMax,
+        jint backlog,
+        jlong nowNs) {
+
+    (void)env;
+    (void)thiz;
+
+    if (controllerPtr == 0) {
+        return -1;
+    }
+
+    BandwidthSample sample;
+    sample.frames = (frames > 0) ? (uint64_t)frames : 0;
+    sample.dropped = (dropped > 0) ? (uint64_t)dropped : 0;
+    sample.queue_max = queueMax;
+    sample.backlog = backlog;
+
+    BandwidthController* bc = (BandwidthController*)(intptr_t)controllerPtr;
+    const int target = bandwidth_controller_update(bc, &sample, nowNs);
+    if (target < 0) {
+        return -1;
+    }
+
+    BandwidthControllerStats stats;
+    bandwidth_controller_get_stats(bc, &stats);
+    LOGI("Bandwidth: switching to %s (%s, drop ratio %.3f, queue %d, backlog %d)",
+         (target == BANDWIDTH_LEVEL_LOWEST) ? "lowest" : "highest",
+         bandwidth_reason_name(stats.last_reason),
+         stats.last_drop_ratio,
+         queueMax,
+         backlog);
+    return bandwidth_level_to_java((BandwidthLevel)target);
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_bandwidthSwitched(
+        JNIEnv* env,
+        jobject thiz,
+        jlong controllerPtr,
+        jboolean ok,
+        jlong nowNs) {
+
+    (void)env;
+    (void)thiz;
+
+    if (controllerPtr == 0) {
+        return;
+    }
+    bandwidth_controller_switched((BandwidthController*)(intptr_t)controllerPtr, ok == JNI_TRUE, nowNs);
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_bandwidthGetStats(
+        JNIEnv* env,
+        jobject thiz,
+        jlong controllerPtr) {
+
+    (void)thiz;
+
+    if (controllerPtr == 0 || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    BandwidthControllerStats stats;
+    bandwidth_controller_get_stats((BandwidthController*)(intptr_t)controllerPtr, &stats);
+
+    return (*env)->NewObject(
+        env,
+        g_class_BandwidthStats,
+        g_ctor_BandwidthStats,
+        bandwidth_level_to_java(stats.level),
+        stats.pending ? JNI_TRUE : JNI_FALSE,
+        bandwidth_level_to_java(stats.pending_level),
+        (jint)stats.last_reason,
+        (jlong)stats.samples,
+        (jlong)stats.degraded_samples,
+        (jlong)stats.downgrades,
+        (jlong)stats.upgrades,
+        (jlong)stats.failed_switches,
+        (jlong)stats.recover_hold_ns,
+        (jlong)stats.last_switch_ns,
+        (jdouble)stats.last_drop_ratio
+    );
+}
+
+/* ============================================================================
+ * JNI Exports - Capture Scheduler
+ *
+ * Receivers added to a scheduler are captured by its worker pool instead of in
+ * receiverCaptureVideo; one consumer thread waits in schedulerWaitReady for any of them.
+ * ========================================================================== */
+
+/* Worker start: name the thread and place it like the receive thread it stands in for. */
+static void scheduler_worker_start(int worker, void* context) {
+    (void)context;
+    char name[16];
+    snprintf(name, sizeof(name), "NDI-Capture-%d", worker);
+    pthread_setname_np(pthread_self(), name);
+
+    ThreadPlacement* tp = get_placement();
+    if (tp != NULL && g_placement_enabled) {
+        const pid_t tid = thread_placement_gettid();
+        const int error = thread_placement_apply(tp, THREAD_ROLE_RECEIVE, tid);
+        if (error != 0) {
+            LOGW("Capture worker %d placement failed: %s", worker, strerror(error));
+        }
+    }
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_schedulerCreate(
+        JNIEnv* env,
+        jobject thiz,
+        jint workers) {
+
+    (void)env;
+    (void)thiz;
+
+    if (workers <= 0) {
+        get_placement();
+        workers = capture_scheduler_default_workers(g_topology.cpu_count);
+    }
+    CaptureScheduler* cs = capture_scheduler_create(workers, scheduler_worker_start, NULL);
+    if (cs == NULL) {
+        LOGE("Failed to create capture scheduler");
+        return 0;
+    }
+    LOGI("Capture scheduler started with %d workers", capture_scheduler_worker_count(cs));
+    return (jlong)(intptr_t)cs;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_schedulerDestroy(
+        JNIEnv* env,
+        jobject thiz,
+        jlong schedulerPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (schedulerPtr == 0) {
+        return;
+    }
+    capture_scheduler_destroy((CaptureScheduler*)(intptr_t)schedulerPtr);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_schedulerAdd(
+        JNIEnv* env,
+        jobject thiz,
+        jlong schedulerPtr,
+        jlong receiverPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (schedulerPtr == 0 || receiverPtr == 0) {
+        LOGE("schedulerAdd: Invalid pointer");
+        return JNI_FALSE;
+    }
+
+    CaptureScheduler* cs = (CaptureScheduler*)(intptr_t)schedulerPtr;
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper->scheduler != NULL) {
+        LOGE("schedulerAdd: Receiver is already scheduled");
+        return JNI_FALSE;
+    }
+
+    /* Set first: from the first service on, receiverCaptureVideo must no longer capture. */
+    wrapper->scheduler = cs;
+    if (!capture_scheduler_add(cs, wrapper, scheduled_capture, scheduled_due)) {
+        wrapper->scheduler = NULL;
+        LOGE("schedulerAdd: Scheduler is full (%d receivers)", CAPTURE_SCHEDULER_MAX_SOURCES);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_schedulerRemove(
+        JNIEnv* env,
+        jobject thiz,
+        jlong schedulerPtr,
+        jlong receiverPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (schedulerPtr == 0 || receiverPtr == 0) {
+        return;
+    }
+
+    NdiReceiverWrapper* wrapper = (NdiReceiverWrapper*)(intptr_t)receiverPtr;
+    if (wrapper->scheduler != (CaptureScheduler*)(intptr_t)schedulerPtr) {
+        return;
+    }
+    capture_scheduler_remove(wrapper->scheduler, wrapper);
+    wrapper->scheduler = NULL;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_schedulerSetFocus(
+        JNIEnv* env,
+        jobject thiz,
+        jlong schedulerPtr,
+        jlong receiverPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    if (schedulerPtr == 0) {
+        return;
+    }
+    capture_scheduler_set_focus((CaptureScheduler*)(intptr_t)schedulerPtr, (void*)(intptr_t)receiverPtr);
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_schedulerWaitReady(
+        JNIEnv* env,
+        jobject thiz,
+        jlong schedulerPtr,
+        jint timeoutMs) {
+
+    (void)env;
+    (void)thiz;
+
+    if (schedulerPtr == 0) {
+        return 0;
+    }
+    void* ready = capture_scheduler_wait_ready(
+        (CaptureScheduler*)(intptr_t)schedulerPtr, (int64_t)timeoutMs * 1000000LL);
+    return (jlong)(intptr_t)ready;
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_schedulerGetSourceStats(
+        JNIEnv* env,
+        jobject thiz,
+        jlong schedulerPtr,
+        jlong receiverPtr) {
+
+    (void)thiz;
+
+    if (schedulerPtr == 0 || receiverPtr == 0) {
+        return NULL;
+    }
+    if (!ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    CaptureSourceStats stats;
+    if (!capture_scheduler_get_stats((CaptureScheduler*)(intptr_t)schedulerPtr,
+                                     (void*)(intptr_t)receiverPtr, &stats)) {
+        return NULL;
+    }
+    return (*env)->NewObject(
+        env,
+        g_class_SchedulerSourceStats,
+        g_ctor_SchedulerSourceStats,
+        stats.focused ? JNI_TRUE : JNI_FALSE,
+        (jlong)stats.services,
+        (jlong)stats.idle_services,
+        (jlong)stats.frames,
+        (jlong)stats.lag_avg_ns,
+        (jlong)stats.lag_max_ns
+    );
+}
+
+/* ============================================================================
+ * JNI Exports - Multiview
+ *
+ * Sources are scaled into tiles of one native canvas as they arrive (multiviewSubmit, on the
+ * delivery thread) and the changed tiles are copied to the surface once per vsync
+ * (multiviewPresent, on the renderer's Choreographer thread).
+ * ========================================================================== */
+
+typedef struct NdiMultiviewWrapper {
+    Multiview* mv;
+    int width;
+    int height;
+    pthread_mutex_t mutex;     /* Guards window. */
+    ANativeWindow* window;
+} NdiMultiviewWrapper;
+
+JNIEXPORT jlong JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewCreate(
+        JNIEnv* env,
+        jobject thiz,
+        jint width,
+        jint height,
+        jint columns,
+        jint rows) {
+
+    (void)env;
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)calloc(1, sizeof(NdiMultiviewWrapper));
+    if (wrapper == NULL) {
+        LOGE("multiviewCreate: Out of memory");
+        return 0;
+    }
+    wrapper->mv = multiview_create(width, height, columns, rows);
+    if (wrapper->mv == NULL) {
+        LOGE("multiviewCreate: Cannot create %dx%d canvas of %dx%d tiles", width, height, columns, rows);
+        free(wrapper);
+        return 0;
+    }
+    wrapper->width = width;
+    wrapper->height = height;
+    pthread_mutex_init(&wrapper->mutex, NULL);
+
+    LOGI("Multiview created (%dx%d, %dx%d tiles)", width, height, columns, rows);
+    return (jlong)(intptr_t)wrapper;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewDestroy(
+        JNIEnv* env,
+        jobject thiz,
+        jlong multiviewPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)(intptr_t)multiviewPtr;
+    if (wrapper == NULL) {
+        return;
+    }
+    if (wrapper->window != NULL) {
+        ANativeWindow_release(wrapper->window);
+    }
+    multiview_destroy(wrapper->mv);
+    pthread_mutex_destroy(&wrapper->mutex);
+    free(wrapper);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewSetSurface(
+        JNIEnv* env,
+        jobject thiz,
+        jlong multiviewPtr,
+        jobject surface) {
+
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)(intptr_t)multiviewPtr;
+    if (wrapper == NULL) {
+        return JNI_FALSE;
+    }
+
+    ANativeWindow* window = NULL;
+    if (surface != NULL) {
+        window = ANativeWindow_fromSurface(env, surface);
+        if (window == NULL) {
+            LOGE("multiviewSetSurface: Failed to get ANativeWindow from Surface");
+            return JNI_FALSE;
+        }
+        /* Buffers are canvas-sized; the compositor scales them to the view. */
+        if (ANativeWindow_setBuffersGeometry(window, wrapper->width, wrapper->height,
+                                             WINDOW_FORMAT_RGBA_8888) != 0) {
+            LOGE("multiviewSetSurface: setBuffersGeometry failed");
+            ANativeWindow_release(window);
+            return JNI_FALSE;
+        }
+    }
+
+    pthread_mutex_lock(&wrapper->mutex);
+    if (wrapper->window != NULL) {
+        ANativeWindow_release(wrapper->window);
+    }
+    wrapper->window = window;
+    pthread_mutex_unlock(&wrapper->mutex);
+
+    /* A new surface starts with nothing on it. */
+    multiview_invalidate(wrapper->mv);
+    return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewSubmit(
+        JNIEnv* env,
+        jobject thiz,
+        jlong multiviewPtr,
+        jint tile,
+        jobject data,
+        jint strideBytes,
+        jint width,
+        jint height,
+        jint fourCC) {
+
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)(intptr_t)multiviewPtr;
+    if (wrapper == NULL || data == NULL || width <= 0 || height <= 0 || strideBytes <= 0) {
+        return JNI_FALSE;
+    }
+
+    ScalerFormat format;
+    if (!scaler_format_for((NDIlib_FourCC_video_type_e)fourCC, &format)) {
+        LOGW("multiviewSubmit: Unsupported FourCC 0x%08x", (unsigned)fourCC);
+        return JNI_FALSE;
+    }
+
+    const uint8_t* src = (const uint8_t*)(*env)->GetDirectBufferAddress(env, data);
+    const jlong capacity = (*env)->GetDirectBufferCapacity(env, data);
+    if (src == NULL || capacity < (jlong)strideBytes * height) {
+        LOGE("multiviewSubmit: Frame must be a direct buffer of at least %" PRId64 " bytes",
+             (int64_t)strideBytes * height);
+        return JNI_FALSE;
+    }
+
+    return multiview_submit(wrapper->mv, tile, src, strideBytes, width, height, format) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewClearTile(
+        JNIEnv* env,
+        jobject thiz,
+        jlong multiviewPtr,
+        jint tile) {
+
+    (void)env;
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)(intptr_t)multiviewPtr;
+    if (wrapper == NULL) {
+        return;
+    }
+    multiview_clear_tile(wrapper->mv, tile);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewPresent(
+        JNIEnv* env,
+        jobject thiz,
+        jlong multiviewPtr) {
+
+    (void)env;
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)(intptr_t)multiviewPtr;
+    if (wrapper == NULL) {
+        return JNI_FALSE;
+    }
+
+    pthread_mutex_lock(&wrapper->mutex);
+    MultiviewRect dirty;
+    if (wrapper->window == NULL || !multiview_begin_present(wrapper->mv, &dirty)) {
+        pthread_mutex_unlock(&wrapper->mutex);
+        return JNI_FALSE;
+    }
+
+    /* The window may widen the dirty rectangle (e.g. when it cannot keep the last buffer). */
+    ARect bounds = { dirty.left, dirty.top, dirty.right, dirty.bottom };
+    ANativeWindow_Buffer buffer;
+    if (ANativeWindow_lock(wrapper->window, &buffer, &bounds) != 0) {
+        pthread_mutex_unlock(&wrapper->mutex);
+        LOGW("multiviewPresent: ANativeWindow_lock failed");
+        return JNI_FALSE;
+    }
+
+    const bool fits = buffer.width == wrapper->width && buffer.height == wrapper->height &&
+                      buffer.format == WINDOW_FORMAT_RGBA_8888;
+    if (fits) {
+        const MultiviewRect copy = { bounds.left, bounds.top, bounds.right, bounds.bottom };
+        multiview_present(wrapper->mv, (uint8_t*)buffer.bits, buffer.stride * 4, &copy);
+    }
+    ANativeWindow_unlockAndPost(wrapper->window);
+    pthread_mutex_unlock(&wrapper->mutex);
+
+    if (!fits) {
+        LOGW("multiviewPresent: Buffer is %dx%d format %d, expected %dx%d RGBA",
+             buffer.width, buffer.height, buffer.format, wrapper->width, wrapper->height);
+        multiview_invalidate(wrapper->mv);
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewGetStats(
+        JNIEnv* env,
+        jobject thiz,
+        jlong multiviewPtr) {
+
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)(intptr_t)multiviewPtr;
+    if (wrapper == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    MultiviewStats stats;
+    multiview_get_stats(wrapper->mv, &stats);
+    return (*env)->NewObject(
+        env,
+        g_class_MultiviewStats,
+        g_ctor_MultiviewStats,
+        (jlong)stats.presents,
+        (jlong)stats.idle_presents,
+        (jdouble)stats.dirty_tiles_avg,
+        (jlong)stats.present_avg_ns,
+        (jlong)stats.present_max_ns
+    );
+}
+
+JNIEXPORT jobject JNICALL
+Java_com_example_ndireceiver_ndi_NdiNative_multiviewGetTileStats(
+        JNIEnv* env,
+        jobject thiz,
+        jlong multiviewPtr,
+        jint tile) {
+
+    (void)thiz;
+
+    NdiMultiviewWrapper* wrapper = (NdiMultiviewWrapper*)(intptr_t)multiviewPtr;
+    if (wrapper == NULL || !ensure_jni_cache(env)) {
+        return NULL;
+    }
+
+    MultiviewTileStats stats;
+    if (!multiview_get_tile_stats(wrapper->mv, tile, &stats)) {
+        return NULL;
+    }
+    return (*env)->NewObject(
+        env,
+        g_class_MultiviewTileStats,
+        g_ctor_MultiviewTileStats,
+        stats.has_frame ? JNI_TRUE : JNI_FALSE,
+        (jint)stats.src_width,
+        (jint)stats.src_height,
+        (jlong)stats.frames,
+        (jlong)stats.superseded,
+        (jlong)stats.age_ns,
+        (jlong)stats.compose_avg_ns,
+        (jlong)stats.compose_max_ns
+    );
+}
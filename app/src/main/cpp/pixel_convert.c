@@ -0,0 +1,219 @@
+/**
+ * pixel_convert.c - Pixel format conversion kernels for the receive pipeline
+ *
+ * See pixel_convert.h.
+ */
+
+#include "pixel_convert.h"
+#include "ndi_trace.h"
+
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXEL_HAVE_NEON 1
+#else
+#define PIXEL_HAVE_NEON 0
+#endif
+
+/* 4x4 Bayer matrix (0..15). */
+static const uint8_t k_bayer4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+/* Rounding offset that takes a 16-bit sample to 10 bits (low 6 bits dropped). */
+#define P010_ROUND 32u
+#define P010_MASK 0xFFC0u
+
+/* ============================================================================
+ * Helpers
+ * ========================================================================== */
+
+size_t pixel_p010_size(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    const size_t row_bytes = (size_t)width * 2;
+    return (row_bytes * (size_t)height) + (row_bytes * (size_t)((height + 1) / 2));
+}
+
+size_t pixel_nv12_size(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    return ((size_t)width * (size_t)height) + ((size_t)width * (size_t)((height + 1) / 2));
+}
+
+static bool valid_p216_args(const uint8_t* src, int src_stride, int width, int height, const uint8_t* dst) {
+    return src != NULL && dst != NULL && width > 0 && height > 0 && (width % 2) == 0 &&
+           src_stride >= width * 2 && (src_stride % 2) == 0;
+}
+
+static inline uint16_t round_to_p010(uint32_t v) {
+    v += P010_ROUND;
+    if (v > 0xFFFFu) {
+        v = 0xFFFFu;
+    }
+    return (uint16_t)(v & P010_MASK);
+}
+
+static inline uint8_t dither_to_8bit(uint32_t v, uint32_t offset) {
+    v += offset;
+    if (v > 0xFFFFu) {
+        v = 0xFFFFu;
+    }
+    return (uint8_t)(v >> 8);
+}
+
+/* Dither offset in 16-bit units for a Bayer cell: spreads the threshold over 8..248. */
+static inline uint16_t bayer_offset(int row, int col) {
+    return (uint16_t)((k_bayer4[row & 3][col & 3] * 16u) + 8u);
+}
+
+/* ============================================================================
+ * P216 -> P010
+ * ========================================================================== */
+
+static void p010_luma_row(const uint16_t* src, uint16_t* dst, int count) {
+    int x = 0;
+#if PIXEL_HAVE_NEON
+    const uint16x8_t round = vdupq_n_u16((uint16_t)P010_ROUND);
+    const uint16x8_t mask = vdupq_n_u16((uint16_t)P010_MASK);
+    for (; x + 8 <= count; x += 8) {
+        const uint16x8_t v = vld1q_u16(src + x);
+        vst1q_u16(dst + x, vandq_u16(vqaddq_u16(v, round), mask));
+    }
+#endif
+    for (; x < count; x++) {
+        dst[x] = round_to_p010(src[x]);
+    }
+}
+
+/* Averages two full-height UV rows into one 4:2:0 row. */
+static void p010_chroma_row(const uint16_t* row0, const uint16_t* row1, uint16_t* dst, int count) {
+    int x = 0;
+#if PIXEL_HAVE_NEON
+    const uint16x8_t round = vdupq_n_u16((uint16_t)P010_ROUND);
+    const uint16x8_t mask = vdupq_n_u16((uint16_t)P010_MASK);
+    for (; x + 8 <= count; x += 8) {
+        const uint16x8_t avg = vrhaddq_u16(vld1q_u16(row0 + x), vld1q_u16(row1 + x));
+        vst1q_u16(dst + x, vandq_u16(vqaddq_u16(avg, round), mask));
+    }
+#endif
+    for (; x < count; x++) {
+        const uint32_t avg = ((uint32_t)row0[x] + (uint32_t)row1[x] + 1u) >> 1;
+        dst[x] = round_to_p010(avg);
+    }
+}
+
+bool pixel_p216_to_p010(const uint8_t* src, int src_stride, int width, int height, uint8_t* dst) {
+    if (!valid_p216_args(src, src_stride, width, height, dst)) {
+        return false;
+    }
+
+    NDI_TRACE_BEGIN("convert p216 to p010");
+    const size_t dst_row_bytes = (size_t)width * 2;
+    const uint8_t* src_uv = src + ((size_t)src_stride * (size_t)height);
+    uint8_t* dst_uv = dst + (dst_row_bytes * (size_t)height);
+
+    for (int y = 0; y < height; y++) {
+        p010_luma_row(
+            (const uint16_t*)(src + ((size_t)y * (size_t)src_stride)),
+            (uint16_t*)(dst + ((size_t)y * dst_row_bytes)),
+            width);
+    }
+
+    for (int y = 0; y < height; y += 2) {
+        const int y1 = (y + 1 < height) ? (y + 1) : y;
+        p010_chroma_row(
+            (const uint16_t*)(src_uv + ((size_t)y * (size_t)src_stride)),
+            (const uint16_t*)(src_uv + ((size_t)y1 * (size_t)src_stride)),
+            (uint16_t*)(dst_uv + ((size_t)(y / 2) * dst_row_bytes)),
+            width);
+    }
+
+    NDI_TRACE_END();
+    return true;
+}
+
+/* ============================================================================
+ * P216 -> NV12 (ordered dither)
+ * ========================================================================== */
+
+static void nv12_luma_row_dithered(const uint16_t* src, uint8_t* dst, int count, int row) {
+    int x = 0;
+#if PIXEL_HAVE_NEON
+    /* The Bayer row repeats every 4 pixels, so one 8-lane vector covers any aligned block. */
+    const uint16_t pattern[8] = {
+        bayer_offset(row, 0), bayer_offset(row, 1), bayer_offset(row, 2), bayer_offset(row, 3),
+        bayer_offset(row, 0), bayer_offset(row, 1), bayer_offset(row, 2), bayer_offset(row, 3),
+    };
+    const uint16x8_t dither = vld1q_u16(pattern);
+    for (; x + 16 <= count; x += 16) {
+        const uint8x8_t lo = vshrn_n_u16(vqaddq_u16(vld1q_u16(src + x), dither), 8);
+        const uint8x8_t hi = vshrn_n_u16(vqaddq_u16(vld1q_u16(src + x + 8), dither), 8);
+        vst1q_u8(dst + x, vcombine_u8(lo, hi));
+    }
+#endif
+    for (; x < count; x++) {
+        dst[x] = dither_to_8bit(src[x], bayer_offset(row, x));
+    }
+}
+
+/*
+ * Averages two full-height UV rows and dithers to 8 bits. count is in samples (U and V
+ * interleaved); both samples of a pair share the Bayer cell of their chroma column.
+ */
+static void nv12_chroma_row_dithered(const uint16_t* row0, const uint16_t* row1, uint8_t* dst, int count, int row) {
+    int x = 0;
+#if PIXEL_HAVE_NEON
+    const uint16_t pattern[8] = {
+        bayer_offset(row, 0), bayer_offset(row, 0), bayer_offset(row, 1), bayer_offset(row, 1),
+        bayer_offset(row, 2), bayer_offset(row, 2), bayer_offset(row, 3), bayer_offset(row, 3),
+    };
+    const uint16x8_t dither = vld1q_u16(pattern);
+    for (; x + 8 <= count; x += 8) {
+        const uint16x8_t avg = vrhaddq_u16(vld1q_u16(row0 + x), vld1q_u16(row1 + x));
+        vst1_u8(dst + x, vshrn_n_u16(vqaddq_u16(avg, dither), 8));
+    }
+#endif
+    for (; x < count; x++) {
+        const uint32_t avg = ((uint32_t)row0[x] + (uint32_t)row1[x] + 1u) >> 1;
+        dst[x] = dither_to_8bit(avg, bayer_offset(row, x / 2));
+    }
+}
+
+bool pixel_p216_to_nv12_dithered(const uint8_t* src, int src_stride, int width, int height, uint8_t* dst) {
+    if (!valid_p216_args(src, src_stride, width, height, dst)) {
+        return false;
+    }
+
+    NDI_TRACE_BEGIN("convert p216 to nv12");
+    const size_t dst_row_bytes = (size_t)width;
+    const uint8_t* src_uv = src + ((size_t)src_stride * (size_t)height);
+    uint8_t* dst_uv = dst + (dst_row_bytes * (size_t)height);
+
+    for (int y = 0; y < height; y++) {
+        nv12_luma_row_dithered(
+            (const uint16_t*)(src + ((size_t)y * (size_t)src_stride)),
+            dst + ((size_t)y * dst_row_bytes),
+            width,
+            y);
+    }
+
+    for (int y = 0; y < height; y += 2) {
+        const int y1 = (y + 1 < height) ? (y + 1) : y;
+        nv12_chroma_row_dithered(
+            (const uint16_t*)(src_uv + ((size_t)y * (size_t)src_stride)),
+            (const uint16_t*)(src_uv + ((size_t)y1 * (size_t)src_stride)),
+            dst_uv + ((size_t)(y / 2) * dst_row_bytes),
+            width,
+            y / 2);
+    }
+
+    NDI_TRACE_END();
+    return true;
+}
@@ -0,0 +1,37 @@
+/**
+ * pixel_convert.h - Pixel format conversion kernels for the receive pipeline
+ *
+ * 16-bit 4:2:2 (P216/PA16) frames are reduced to 4:2:0: P010 for Main10 recording, and NV12
+ * with an ordered dither for 8-bit recording and rendering.
+ */
+
+#ifndef NDI_PIXEL_CONVERT_H
+#define NDI_PIXEL_CONVERT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Size of a tightly packed P010 frame: 16-bit Y plane plus 16-bit interleaved 4:2:0 UV plane. */
+size_t pixel_p010_size(int width, int height);
+
+/* Size of a tightly packed NV12 frame: 8-bit Y plane plus 8-bit interleaved 4:2:0 UV plane. */
+size_t pixel_nv12_size(int width, int height);
+
+/*
+ * P216 -> P010.
+ *
+ * P216 (and the first two planes of PA16) is a 16-bit Y plane followed by a full-height
+ * interleaved 16-bit UV plane, both src_stride bytes per line. Samples are rounded to 10 bits
+ * and kept MSB-aligned as P010 requires; chroma line pairs are averaged for 4:2:0.
+ * dst must hold pixel_p010_size(width, height) bytes. width must be even.
+ */
+bool pixel_p216_to_p010(const uint8_t* src, int src_stride, int width, int height, uint8_t* dst);
+
+/*
+ * P216 -> NV12 with a 4x4 ordered dither, so that truncating to 8 bits does not band
+ * smooth gradients. dst must hold pixel_nv12_size(width, height) bytes. width must be even.
+ */
+bool pixel_p216_to_nv12_dithered(const uint8_t* src, int src_stride, int width, int height, uint8_t* dst);
+
+#endif /* NDI_PIXEL_CONVERT_H */
@@ -0,0 +1,272 @@
+/**
+ * receiver_stats.c - Rolling-window statistics of one receiver's video stream
+ *
+ * Buckets are keyed by epoch (now / bucket length); a bucket whose epoch is stale is cleared
+ * when it is next written, and ignored when read. Only the previous arrival time and the most
+ * recent samples live outside the buckets.
+ */
+
+#include "receiver_stats.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct StatsBucket {
+    int64_t epoch;
+
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t intervals;
+    double interval_sum;
+    double interval_sq_sum;
+    int64_t interval_max;
+
+    uint64_t captures;
+    int64_t capture_sum;
+    int64_t capture_max;
+
+    uint64_t queue_samples;
+    uint64_t queue_video_sum;
+    int queue_video_max;
+    int queue_audio_max;
+    int queue_metadata_max;
+
+    bool has_connections;
+    int connections_min;
+    int connections_max;
+} StatsBucket;
+
+struct ReceiverStats {
+    pthread_mutex_t lock;
+    StatsBucket buckets[RECEIVER_STATS_BUCKETS];
+    bool started;
+    int64_t start_ns;
+
+    int64_t last_arrival_ns;   /* 0 before the first frame. */
+    int queue_video;
+    int queue_audio;
+    int queue_metadata;
+    int connections;
+};
+
+/* ============================================================================
+ * Buckets (caller holds the lock)
+ * ========================================================================== */
+
+static void clear_locked(ReceiverStats* rs) {
+    for (int i = 0; i < RECEIVER_STATS_BUCKETS; i++) {
+        memset(&rs->buckets[i], 0, sizeof(rs->buckets[i]));
+        rs->buckets[i].epoch = -1;
+    }
+    rs->started = false;
+    rs->start_ns = 0;
+    rs->last_arrival_ns = 0;
+    rs->queue_video = 0;
+    rs->queue_audio = 0;
+    rs->queue_metadata = 0;
+    rs->connections = 0;
+}
+
+static StatsBucket* bucket_locked(ReceiverStats* rs, int64_t now_ns) {
+    if (!rs->started) {
+        rs->started = true;
+        rs->start_ns = now_ns;
+    }
+    const int64_t epoch = now_ns / RECEIVER_STATS_BUCKET_NS;
+    StatsBucket* bucket = &rs->buckets[epoch % RECEIVER_STATS_BUCKETS];
+    if (bucket->epoch != epoch) {
+        memset(bucket, 0, sizeof(*bucket));
+        bucket->epoch = epoch;
+    }
+    return bucket;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+ReceiverStats* receiver_stats_create(void) {
+    ReceiverStats* rs = (ReceiverStats*)calloc(1, sizeof(ReceiverStats));
+    if (rs == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&rs->lock, NULL) != 0) {
+        free(rs);
+        return NULL;
+    }
+    clear_locked(rs);
+    return rs;
+}
+
+void receiver_stats_destroy(ReceiverStats* rs) {
+    if (rs == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&rs->lock);
+    free(rs);
+}
+
+void receiver_stats_reset(ReceiverStats* rs) {
+    pthread_mutex_lock(&rs->lock);
+    clear_locked(rs);
+    pthread_mutex_unlock(&rs->lock);
+}
+
+void receiver_stats_frame(ReceiverStats* rs, int64_t arrival_ns, size_t bytes) {
+    if (arrival_ns <= 0) {
+        return;
+    }
+    pthread_mutex_lock(&rs->lock);
+    StatsBucket* bucket = bucket_locked(rs, arrival_ns);
+    bucket->frames++;
+    bucket->bytes += bytes;
+    if (rs->last_arrival_ns > 0 && arrival_ns >= rs->last_arrival_ns) {
+        const int64_t interval = arrival_ns - rs->last_arrival_ns;
+        bucket->intervals++;
+        bucket->interval_sum += (double)interval;
+        bucket->interval_sq_sum += (double)interval * (double)interval;
+        if (interval > bucket->interval_max) {
+            bucket->interval_max = interval;
+        }
+    }
+    rs->last_arrival_ns = arrival_ns;
+    pthread_mutex_unlock(&rs->lock);
+}
+
+void receiver_stats_capture_call(ReceiverStats* rs, int64_t duration_ns, int64_t now_ns) {
+    if (duration_ns < 0) {
+        duration_ns = 0;
+    }
+    pthread_mutex_lock(&rs->lock);
+    StatsBucket* bucket = bucket_locked(rs, now_ns);
+    bucket->captures++;
+    bucket->capture_sum += duration_ns;
+    if (duration_ns > bucket->capture_max) {
+        bucket->capture_max = duration_ns;
+    }
+    pthread_mutex_unlock(&rs->lock);
+}
+
+void receiver_stats_queue(ReceiverStats* rs, int video, int audio, int metadata, int64_t now_ns) {
+    pthread_mutex_lock(&rs->lock);
+    StatsBucket* bucket = bucket_locked(rs, now_ns);
+    bucket->queue_samples++;
+    bucket->queue_video_sum += (uint64_t)(video > 0 ? video : 0);
+    if (video > bucket->queue_video_max) {
+        bucket->queue_video_max = video;
+    }
+    if (audio > bucket->queue_audio_max) {
+        bucket->queue_audio_max = audio;
+    }
+    if (metadata > bucket->queue_metadata_max) {
+        bucket->queue_metadata_max = metadata;
+    }
+    rs->queue_video = video;
+    rs->queue_audio = audio;
+    rs->queue_metadata = metadata;
+    pthread_mutex_unlock(&rs->lock);
+}
+
+void receiver_stats_connections(ReceiverStats* rs, int connections, int64_t now_ns) {
+    pthread_mutex_lock(&rs->lock);
+    StatsBucket* bucket = bucket_locked(rs, now_ns);
+    if (!bucket->has_connections) {
+        bucket->has_connections = true;
+        bucket->connections_min = connections;
+        bucket->connections_max = connections;
+    } else if (connections < bucket->connections_min) {
+        bucket->connections_min = connections;
+    } else if (connections > bucket->connections_max) {
+        bucket->connections_max = connections;
+    }
+    rs->connections = connections;
+    pthread_mutex_unlock(&rs->lock);
+}
+
+void receiver_stats_get(ReceiverStats* rs, int64_t now_ns, ReceiverStatsSnapshot* out) {
+    memset(out, 0, sizeof(*out));
+    const int64_t epoch = now_ns / RECEIVER_STATS_BUCKET_NS;
+
+    uint64_t intervals = 0;
+    double interval_sum = 0.0;
+    double interval_sq_sum = 0.0;
+    int64_t capture_sum = 0;
+    uint64_t queue_samples = 0;
+    uint64_t queue_video_sum = 0;
+    bool has_connections = false;
+
+    pthread_mutex_lock(&rs->lock);
+    for (int i = 0; i < RECEIVER_STATS_BUCKETS; i++) {
+        const StatsBucket* b = &rs->buckets[i];
+        if (b->epoch < 0 || b->epoch > epoch || b->epoch <= epoch - RECEIVER_STATS_BUCKETS) {
+            continue;
+        }
+        out->video_frames += b->frames;
+        out->video_bytes += b->bytes;
+        intervals += b->intervals;
+        interval_sum += b->interval_sum;
+        interval_sq_sum += b->interval_sq_sum;
+        if (b->interval_max > out->interval_max_ns) {
+            out->interval_max_ns = b->interval_max;
+        }
+        out->capture_calls += b->captures;
+        capture_sum += b->capture_sum;
+        if (b->capture_max > out->capture_max_ns) {
+            out->capture_max_ns = b->capture_max;
+        }
+        queue_samples += b->queue_samples;
+        queue_video_sum += b->queue_video_sum;
+        if (b->queue_video_max > out->queue_video_max) {
+            out->queue_video_max = b->queue_video_max;
+        }
+        if (b->queue_audio_max > out->queue_audio_max) {
+            out->queue_audio_max = b->queue_audio_max;
+        }
+        if (b->queue_metadata_max > out->queue_metadata_max) {
+            out->queue_metadata_max = b->queue_metadata_max;
+        }
+        if (b->has_connections) {
+            if (!has_connections || b->connections_min < out->connections_min) {
+                out->connections_min = b->connections_min;
+            }
+            if (!has_connections || b->connections_max > out->connections_max) {
+                out->connections_max = b->connections_max;
+            }
+            has_connections = true;
+        }
+    }
+
+    /* The oldest bucket starts at (epoch - BUCKETS + 1); the current one is partial. */
+    int64_t window = now_ns - (epoch - RECEIVER_STATS_BUCKETS + 1) * RECEIVER_STATS_BUCKET_NS;
+    if (!rs->started) {
+        window = 0;
+    } else if (now_ns - rs->start_ns < window) {
+        window = now_ns - rs->start_ns;
+    }
+    out->window_ns = window > 0 ? window : 0;
+    out->queue_video = rs->queue_video;
+    out->queue_audio = rs->queue_audio;
+    out->queue_metadata = rs->queue_metadata;
+    out->connections = rs->connections;
+    pthread_mutex_unlock(&rs->lock);
+
+    if (intervals > 0) {
+        const double mean = interval_sum / (double)intervals;
+        const double variance = (interval_sq_sum / (double)intervals) - (mean * mean);
+        out->interval_avg_ns = (int64_t)(mean + 0.5);
+        out->jitter_ns = variance > 0.0 ? (int64_t)(sqrt(variance) + 0.5) : 0;
+        out->fps = mean > 0.0 ? 1e9 / mean : 0.0;
+    }
+    if (out->window_ns > 0) {
+        out->bitrate_bps = (int64_t)((double)out->video_bytes * 8.0 * 1e9 / (double)out->window_ns);
+    }
+    if (out->capture_calls > 0) {
+        out->capture_avg_ns = capture_sum / (int64_t)out->capture_calls;
+    }
+    if (queue_samples > 0) {
+        out->queue_video_avg = (double)queue_video_sum / (double)queue_samples;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * receiver_stats.h - Rolling-window statistics of one receiver's video stream
+ *
+ * The capture path reports each video frame (arrival time and size), the duration of each
+ * capture call that returned one, the SDK queue depths (NDIlib_recv_get_queue) and the
+ * connection count. These are added to one of RECEIVER_STATS_BUCKETS time buckets, so a
+ * snapshot of frame rate, bitrate, inter-arrival jitter, queue depths and capture-call time
+ * always covers the last RECEIVER_STATS_WINDOW_NS without any per-frame history.
+ */
+
+#ifndef NDI_RECEIVER_STATS_H
+#define NDI_RECEIVER_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RECEIVER_STATS_BUCKET_NS 250000000LL
+#define RECEIVER_STATS_BUCKETS 8
+#define RECEIVER_STATS_WINDOW_NS (RECEIVER_STATS_BUCKET_NS * RECEIVER_STATS_BUCKETS)
+
+typedef struct ReceiverStatsSnapshot {
+    int64_t window_ns;           /* Time the figures cover (shorter right after a reset). */
+
+    uint64_t video_frames;       /* Frames that arrived in the window. */
+    uint64_t video_bytes;
+    double fps;                  /* From the mean inter-arrival interval; 0 below two frames. */
+    int64_t bitrate_bps;         /* Video payload bits per second over the window. */
+    int64_t interval_avg_ns;     /* Mean time between frame arrivals. */
+    int64_t interval_max_ns;
+    int64_t jitter_ns;           /* Standard deviation of the inter-arrival interval. */
+
+    uint64_t capture_calls;      /* Capture calls that returned a video frame. */
+    int64_t capture_avg_ns;      /* Their mean and longest duration, SDK wait included. */
+    int64_t capture_max_ns;
+
+    double queue_video_avg;      /* SDK queue depths over the samples in the window. */
+    int queue_video_max;
+    int queue_audio_max;
+    int queue_metadata_max;
+    int queue_video;             /* Most recent sample. */
+    int queue_audio;
+    int queue_metadata;
+
+    int connections;             /* Most recent sample, then the range seen in the window. */
+    int connections_min;
+    int connections_max;
+} ReceiverStatsSnapshot;
+
+typedef struct ReceiverStats ReceiverStats;
+
+ReceiverStats* receiver_stats_create(void);
+void receiver_stats_destroy(ReceiverStats* rs);
+
+/* Forget everything, e.g. when the receiver connects to another source. */
+void receiver_stats_reset(ReceiverStats* rs);
+
+/* A video frame of bytes payload arrived at arrival_ns (monotonic). */
+void receiver_stats_frame(ReceiverStats* rs, int64_t arrival_ns, size_t bytes);
+
+/* A capture call that returned a video frame took duration_ns, ending at now_ns. */
+void receiver_stats_capture_call(ReceiverStats* rs, int64_t duration_ns, int64_t now_ns);
+
+/* SDK queue depths sampled at now_ns. */
+void receiver_stats_queue(ReceiverStats* rs, int video, int audio, int metadata, int64_t now_ns);
+
+/* Connection count sampled at now_ns. */
+void receiver_stats_connections(ReceiverStats* rs, int connections, int64_t now_ns);
+
+/* Statistics for the window ending at now_ns. */
+void receiver_stats_get(ReceiverStats* rs, int64_t now_ns, ReceiverStatsSnapshot* out);
+
+#endif /* NDI_RECEIVER_STATS_H */
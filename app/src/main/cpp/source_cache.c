@@ -0,0 +1,295 @@
+/**
+ * source_cache.c - Persistent cache of known NDI sources and their URL addresses
+ *
+ * The file is a 64-byte header followed by SOURCE_CACHE_CAPACITY records; a record with an
+ * empty name is free. A record is rebuilt in a local copy, checksummed and stored whole, so
+ * the mapping only ever holds a half-written record if the process dies during the store.
+ */
+
+#include "source_cache.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC 0x43534E44u   /* "DNSC" */
+#define CACHE_VERSION 1u
+
+typedef struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t record_size;
+    uint8_t reserved[48];
+} CacheHeader;
+
+typedef struct CacheRecord {
+    uint32_t checksum;   /* FNV-1a of everything after this field. */
+    uint32_t reserved;
+    int64_t last_seen_ms;
+    int64_t last_success_ms;
+    char name[SOURCE_CACHE_NAME_MAX];
+    char url[SOURCE_CACHE_URL_MAX];
+} CacheRecord;
+
+typedef struct CacheFile {
+    CacheHeader header;
+    CacheRecord records[SOURCE_CACHE_CAPACITY];
+} CacheFile;
+
+_Static_assert(sizeof(CacheHeader) == 64, "cache header layout");
+_Static_assert(sizeof(CacheRecord) == 256, "cache record layout");
+
+struct SourceCache {
+    pthread_mutex_t lock;
+    CacheFile* file;   /* The mapping. */
+};
+
+/* ============================================================================
+ * Internal helpers
+ * ========================================================================== */
+
+static uint32_t record_checksum(const CacheRecord* record) {
+    const uint8_t* p = (const uint8_t*)record + sizeof(record->checksum);
+    const uint8_t* end = (const uint8_t*)record + sizeof(*record);
+    uint32_t hash = 2166136261u;
+    while (p < end) {
+        hash = (hash ^ *p++) * 16777619u;
+    }
+    return hash;
+}
+
+static bool record_valid(const CacheRecord* record) {
+    return record->checksum == record_checksum(record) &&
+           memchr(record->name, '\0', sizeof(record->name)) != NULL &&
+           memchr(record->url, '\0', sizeof(record->url)) != NULL;
+}
+
+static void store(CacheRecord* slot, CacheRecord* record) {
+    record->checksum = record_checksum(record);
+    memcpy(slot, record, sizeof(*record));
+}
+
+/* Caller holds the lock. */
+static CacheRecord* find(SourceCache* cache, const char* name) {
+    for (int i = 0; i < SOURCE_CACHE_CAPACITY; i++) {
+        CacheRecord* record = &cache->file->records[i];
+        if (record->name[0] != '\0' && strcmp(record->name, name) == 0) {
+            return record;
+        }
+    }
+    return NULL;
+}
+
+/* Earlier connections go first, then never-connected sources by when they were last seen. */
+static bool older(const CacheRecord* a, const CacheRecord* b) {
+    if (a->last_success_ms != b->last_success_ms) {
+        return a->last_success_ms < b->last_success_ms;
+    }
+    return a->last_seen_ms < b->last_seen_ms;
+}
+
+/*
+ * A free record, or the one to evict for a new source. Only sources never connected to are
+ * evicted unless evict_connected. Caller holds the lock.
+ */
+static CacheRecord* slot_for_new(SourceCache* cache, bool evict_connected) {
+    CacheRecord* victim = NULL;
+    for (int i = 0; i < SOURCE_CACHE_CAPACITY; i++) {
+        CacheRecord* record = &cache->file->records[i];
+        if (record->name[0] == '\0') {
+            return record;
+        }
+        if (!evict_connected && record->last_success_ms != 0) {
+            continue;
+        }
+        if (victim == NULL || older(record, victim)) {
+            victim = record;
+        }
+    }
+    return victim;
+}
+
+static bool fits(const char* text, size_t size) {
+    return text != NULL && strlen(text) < size;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+SourceCache* source_cache_open(const char* path) {
+    if (path == NULL) {
+        return NULL;
+    }
+    const int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    bool fresh = fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(CacheFile);
+    if (fresh && (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)sizeof(CacheFile)) != 0)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* mapping = mmap(NULL, sizeof(CacheFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+
+    SourceCache* cache = (SourceCache*)calloc(1, sizeof(SourceCache));
+    if (cache == NULL || pthread_mutex_init(&cache->lock, NULL) != 0) {
+        free(cache);
+        munmap(mapping, sizeof(CacheFile));
+        return NULL;
+    }
+    cache->file = (CacheFile*)mapping;
+
+    CacheHeader* header = &cache->file->header;
+    if (header->magic != CACHE_MAGIC || header->version != CACHE_VERSION ||
+        header->capacity != SOURCE_CACHE_CAPACITY || header->record_size != sizeof(CacheRecord)) {
+        fresh = true;
+    }
+    if (fresh) {
+        memset(cache->file, 0, sizeof(CacheFile));
+        header->magic = CACHE_MAGIC;
+        header->version = CACHE_VERSION;
+        header->capacity = SOURCE_CACHE_CAPACITY;
+        header->record_size = sizeof(CacheRecord);
+    }
+    for (int i = 0; i < SOURCE_CACHE_CAPACITY; i++) {
+        CacheRecord* record = &cache->file->records[i];
+        if (record->name[0] != '\0' && !record_valid(record)) {
+            memset(record, 0, sizeof(*record));
+        }
+    }
+    return cache;
+}
+
+void source_cache_close(SourceCache* cache) {
+    if (cache == NULL) {
+        return;
+    }
+    msync(cache->file, sizeof(CacheFile), MS_SYNC);
+    munmap(cache->file, sizeof(CacheFile));
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+bool source_cache_seen(SourceCache* cache, const char* name, const char* url, int64_t now_ms) {
+    if (!fits(name, SOURCE_CACHE_NAME_MAX) || name[0] == '\0') {
+        return false;
+    }
+    pthread_mutex_lock(&cache->lock);
+    CacheRecord* slot = find(cache, name);
+    CacheRecord record;
+    if (slot != NULL) {
+        record = *slot;
+    } else {
+        slot = slot_for_new(cache, false);
+        memset(&record, 0, sizeof(record));
+        strcpy(record.name, name);
+    }
+    if (slot != NULL) {
+        if (url != NULL && url[0] != '\0') {
+            /* A truncated URL would be a wrong one. */
+            if (fits(url, SOURCE_CACHE_URL_MAX)) {
+                strcpy(record.url, url);
+            } else {
+                record.url[0] = '\0';
+            }
+        }
+        record.last_seen_ms = now_ms;
+        store(slot, &record);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return slot != NULL;
+}
+
+bool source_cache_connected(SourceCache* cache, const char* name, int64_t now_ms) {
+    if (!fits(name, SOURCE_CACHE_NAME_MAX) || name[0] == '\0') {
+        return false;
+    }
+    pthread_mutex_lock(&cache->lock);
+    CacheRecord* slot = find(cache, name);
+    CacheRecord record;
+    if (slot != NULL) {
+        record = *slot;
+    } else {
+        slot = slot_for_new(cache, true);
+        memset(&record, 0, sizeof(record));
+        strcpy(record.name, name);
+    }
+    record.last_seen_ms = now_ms;
+    record.last_success_ms = now_ms;
+    store(slot, &record);
+    pthread_mutex_unlock(&cache->lock);
+    return true;
+}
+
+bool source_cache_url(SourceCache* cache, const char* name, char* url, size_t url_size) {
+    if (name == NULL || url == NULL || url_size < SOURCE_CACHE_URL_MAX) {
+        return false;
+    }
+    pthread_mutex_lock(&cache->lock);
+    const CacheRecord* record = find(cache, name);
+    const bool found = record != NULL && record->url[0] != '\0';
+    if (found) {
+        memcpy(url, record->url, SOURCE_CACHE_URL_MAX);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return found;
+}
+
+void source_cache_url_failed(SourceCache* cache, const char* name, const char* url) {
+    if (name == NULL || url == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&cache->lock);
+    CacheRecord* slot = find(cache, name);
+    if (slot != NULL && strcmp(slot->url, url) == 0) {
+        CacheRecord record = *slot;
+        record.url[0] = '\0';
+        store(slot, &record);
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+int source_cache_entries(SourceCache* cache, SourceCacheEntry* out, int max) {
+    int count = 0;
+    pthread_mutex_lock(&cache->lock);
+    for (int i = 0; i < SOURCE_CACHE_CAPACITY; i++) {
+        const CacheRecord* record = &cache->file->records[i];
+        if (record->name[0] == '\0') {
+            continue;
+        }
+        /* Insertion sort, newest first; there are at most SOURCE_CACHE_CAPACITY. */
+        int at = count;
+        while (at > 0 && (out[at - 1].last_success_ms < record->last_success_ms ||
+                          (out[at - 1].last_success_ms == record->last_success_ms &&
+                           out[at - 1].last_seen_ms < record->last_seen_ms))) {
+            at--;
+        }
+        if (at >= max) {
+            continue;
+        }
+        const int last = count < max ? count : max - 1;
+        memmove(&out[at + 1], &out[at], (size_t)(last - at) * sizeof(*out));
+        memcpy(out[at].name, record->name, sizeof(out[at].name));
+        memcpy(out[at].url, record->url, sizeof(out[at].url));
+        out[at].last_seen_ms = record->last_seen_ms;
+        out[at].last_success_ms = record->last_success_ms;
+        if (count < max) {
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return count;
+}
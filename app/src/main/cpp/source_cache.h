@@ -0,0 +1,67 @@
+/**
+ * source_cache.h - Persistent cache of known NDI sources and their URL addresses
+ *
+ * A small fixed-size file of 256-byte records, memory-mapped, so the sources seen by earlier
+ * runs can be listed before discovery has found anything, and a source connected before can
+ * be connected by its URL address without resolving its name again. Updates are stores into
+ * the mapping; the kernel writes them back. Every record carries a checksum, so one torn by a
+ * crash mid-update is dropped on the next open instead of being trusted.
+ *
+ * Sources that were connected to are kept before ones that were only seen: a busy Discovery
+ * Server can fill the cache with sources, but only by evicting others never connected to.
+ */
+
+#ifndef NDI_SOURCE_CACHE_H
+#define NDI_SOURCE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SOURCE_CACHE_CAPACITY 64
+#define SOURCE_CACHE_NAME_MAX 152   /* Including the terminator; longer names are not cached. */
+#define SOURCE_CACHE_URL_MAX 80     /* Including the terminator; longer URLs are stored as "". */
+
+typedef struct SourceCacheEntry {
+    char name[SOURCE_CACHE_NAME_MAX];
+    char url[SOURCE_CACHE_URL_MAX];   /* "" if unknown. */
+    int64_t last_seen_ms;             /* Wall clock; discovered or connected. */
+    int64_t last_success_ms;          /* Wall clock of the last connection that delivered video, or 0. */
+} SourceCacheEntry;
+
+typedef struct SourceCache SourceCache;
+
+/*
+ * Open or create the cache file at path. A file of another size or version is started over.
+ * Returns NULL if the file cannot be created or mapped.
+ */
+SourceCache* source_cache_open(const char* path);
+
+/* Flush and unmap. */
+void source_cache_close(SourceCache* cache);
+
+/*
+ * Discovery reported name at url (NULL or "" keeps the cached URL). Adds the source if there
+ * is room or a source never connected to can be evicted. Returns false if it was not cached.
+ */
+bool source_cache_seen(SourceCache* cache, const char* name, const char* url, int64_t now_ms);
+
+/*
+ * A connection to name delivered video. Adds the source if needed, evicting the one connected
+ * to least recently. Returns false only if name cannot be cached.
+ */
+bool source_cache_connected(SourceCache* cache, const char* name, int64_t now_ms);
+
+/* Copy name's cached URL address into url (url_size >= SOURCE_CACHE_URL_MAX). False if none. */
+bool source_cache_url(SourceCache* cache, const char* name, char* url, size_t url_size);
+
+/* Connecting to name at url failed: forget the URL, unless discovery has replaced it since. */
+void source_cache_url_failed(SourceCache* cache, const char* name, const char* url);
+
+/*
+ * Copy up to max entries into out, most recently connected first, then most recently seen.
+ * Returns the number copied.
+ */
+int source_cache_entries(SourceCache* cache, SourceCacheEntry* out, int max);
+
+#endif /* NDI_SOURCE_CACHE_H */
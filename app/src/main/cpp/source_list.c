@@ -0,0 +1,223 @@
+/**
+ * source_list.c - Snapshot of discovered NDI sources, diffed incrementally
+ *
+ * An update sorts pointers to the incoming sources and merges them with the sorted snapshot.
+ * Each entry's name and URL share one allocation; entries that left the snapshot (removed, or
+ * replaced because their URL changed) are retired rather than freed, because the changes
+ * returned by the update still point at them, and are freed by the next update. Not
+ * thread-safe: the owner serializes calls.
+ */
+
+#include "source_list.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Entry {
+    SourceInfo info;
+    char* block;   /* name '\0' url '\0'; info points into it. */
+} Entry;
+
+struct SourceList {
+    Entry* entries;   /* Sorted by name. */
+    int count;
+
+    SourceChange* changes;
+    char** retired;   /* Blocks the current changes may point into. */
+    int retired_count;
+};
+
+/* ============================================================================
+ * Internal helpers
+ * ========================================================================== */
+
+static const char* url_of(const SourceInfo* source) {
+    return source->url != NULL ? source->url : "";
+}
+
+static int compare_by_name(const void* a, const void* b) {
+    const SourceInfo* sa = *(const SourceInfo* const*)a;
+    const SourceInfo* sb = *(const SourceInfo* const*)b;
+    return strcmp(sa->name, sb->name);
+}
+
+static bool make_entry(Entry* entry, const SourceInfo* source) {
+    const char* url = url_of(source);
+    const size_t name_len = strlen(source->name);
+    const size_t url_len = strlen(url);
+    char* block = (char*)malloc(name_len + url_len + 2);
+    if (block == NULL) {
+        return false;
+    }
+    memcpy(block, source->name, name_len + 1);
+    memcpy(block + name_len + 1, url, url_len + 1);
+    entry->block = block;
+    entry->info.name = block;
+    entry->info.url = block + name_len + 1;
+    return true;
+}
+
+static void free_retired(SourceList* list) {
+    for (int i = 0; i < list->retired_count; i++) {
+        free(list->retired[i]);
+    }
+    free(list->retired);
+    list->retired = NULL;
+    list->retired_count = 0;
+    free(list->changes);
+    list->changes = NULL;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+SourceList* source_list_create(void) {
+    return (SourceList*)calloc(1, sizeof(SourceList));
+}
+
+void source_list_destroy(SourceList* list) {
+    if (list == NULL) {
+        return;
+    }
+    free_retired(list);
+    for (int i = 0; i < list->count; i++) {
+        free(list->entries[i].block);
+    }
+    free(list->entries);
+    free(list);
+}
+
+int source_list_update(SourceList* list, const SourceInfo* sources, int count,
+                       const SourceChange** changes) {
+    *changes = NULL;
+    free_retired(list);
+    if (sources == NULL || count < 0) {
+        count = 0;
+    }
+
+    const SourceInfo** sorted = (const SourceInfo**)malloc(((size_t)count + 1) * sizeof(*sorted));
+    Entry* next = (Entry*)malloc(((size_t)count + 1) * sizeof(*next));
+    SourceChange* out = (SourceChange*)malloc(((size_t)list->count + count + 1) * sizeof(*out));
+    char** retired = (char**)malloc(((size_t)list->count + 1) * sizeof(*retired));
+    if (sorted == NULL || next == NULL || out == NULL || retired == NULL) {
+        free(sorted);
+        free(next);
+        free(out);
+        free(retired);
+        return -1;
+    }
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (sources[i].name != NULL && sources[i].name[0] != '\0') {
+            sorted[n++] = &sources[i];
+        }
+    }
+    qsort(sorted, (size_t)n, sizeof(*sorted), compare_by_name);
+
+    int next_count = 0;
+    int change_count = 0;
+    int retired_count = 0;
+    int i = 0;
+    int j = 0;
+    bool ok = true;
+
+    while (ok && (i < list->count || j < n)) {
+        /* Repeated names: the first one in sorted order wins. */
+        if (j < n && next_count > 0 && strcmp(sorted[j]->name, next[next_count - 1].info.name) == 0) {
+            j++;
+            continue;
+        }
+
+        const int order = (i == list->count) ? 1
+                        : (j == n) ? -1
+                        : strcmp(list->entries[i].info.name, sorted[j]->name);
+        const Entry* old = (i < list->count) ? &list->entries[i] : NULL;
+
+        if (order < 0) {
+            out[change_count++] = (SourceChange){ SOURCE_REMOVED, old->info };
+            retired[retired_count++] = old->block;
+            i++;
+        } else if (order > 0) {
+            ok = make_entry(&next[next_count], sorted[j]);
+            if (ok) {
+                out[change_count++] = (SourceChange){ SOURCE_ADDED, next[next_count].info };
+                next_count++;
+                j++;
+            }
+        } else if (strcmp(old->info.url, url_of(sorted[j])) != 0) {
+            ok = make_entry(&next[next_count], sorted[j]);
+            if (ok) {
+                out[change_count++] = (SourceChange){ SOURCE_CHANGED, next[next_count].info };
+                retired[retired_count++] = old->block;
+                next_count++;
+                i++;
+                j++;
+            }
+        } else {
+            next[next_count++] = *old;
+            i++;
+            j++;
+        }
+    }
+
+    free(sorted);
+
+    if (!ok) {
+        /* Undo: free only the blocks this update allocated. */
+        for (int k = 0, m = 0; k < next_count; k++) {
+            while (m < list->count && strcmp(list->entries[m].info.name, next[k].info.name) < 0) {
+                m++;
+            }
+            if (m == list->count || list->entries[m].block != next[k].block) {
+                free(next[k].block);
+            }
+        }
+        free(next);
+        free(out);
+        free(retired);
+        return -1;
+    }
+
+    free(list->entries);
+    list->entries = next;
+    list->count = next_count;
+    list->changes = out;
+    list->retired = retired;
+    list->retired_count = retired_count;
+    *changes = out;
+    return change_count;
+}
+
+int source_list_count(const SourceList* list) {
+    return list->count;
+}
+
+const SourceInfo* source_list_get(const SourceList* list, int index) {
+    if (index < 0 || index >= list->count) {
+        return NULL;
+    }
+    return &list->entries[index].info;
+}
+
+const SourceInfo* source_list_find(const SourceList* list, const char* name) {
+    if (name == NULL) {
+        return NULL;
+    }
+    int lo = 0;
+    int hi = list->count - 1;
+    while (lo <= hi) {
+        const int mid = lo + (hi - lo) / 2;
+        const int order = strcmp(list->entries[mid].info.name, name);
+        if (order == 0) {
+            return &list->entries[mid].info;
+        }
+        if (order < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,52 @@
+/**
+ * source_list.h - Snapshot of discovered NDI sources, diffed incrementally
+ *
+ * The finder reports its whole source list on every change. Feeding that list here keeps a
+ * copy sorted by name and reports only the sources that were added, removed or whose URL
+ * address changed, so a change on a Discovery Server with hundreds of sources costs one small
+ * array in Java rather than the whole list. Sources that did not change keep their storage.
+ */
+
+#ifndef NDI_SOURCE_LIST_H
+#define NDI_SOURCE_LIST_H
+
+#include <stdbool.h>
+
+typedef struct SourceInfo {
+    const char* name;   /* "MACHINE (Source)", unique within a list. */
+    const char* url;    /* Never NULL; "" if the finder gave none. */
+} SourceInfo;
+
+typedef enum SourceChangeKind {
+    SOURCE_ADDED = 0,
+    SOURCE_REMOVED = 1,
+    SOURCE_CHANGED = 2   /* Same name, new URL address. */
+} SourceChangeKind;
+
+typedef struct SourceChange {
+    SourceChangeKind kind;
+    SourceInfo source;   /* For SOURCE_REMOVED, the source as it was last seen. */
+} SourceChange;
+
+typedef struct SourceList SourceList;
+
+SourceList* source_list_create(void);
+void source_list_destroy(SourceList* list);
+
+/*
+ * Replace the snapshot with sources (in any order; a NULL url counts as "", entries with no
+ * name and repeated names after the first are ignored). Returns the number of changes, in
+ * name order, stored in *changes, or -1 on allocation failure with the snapshot unchanged.
+ * The changes stay valid until the next update or destroy.
+ */
+int source_list_update(SourceList* list, const SourceInfo* sources, int count,
+                       const SourceChange** changes);
+
+/* Sources in the snapshot, sorted by name; index < source_list_count(). */
+int source_list_count(const SourceList* list);
+const SourceInfo* source_list_get(const SourceList* list, int index);
+
+/* The snapshot's entry for name, or NULL. */
+const SourceInfo* source_list_find(const SourceList* list, const char* name);
+
+#endif /* NDI_SOURCE_LIST_H */
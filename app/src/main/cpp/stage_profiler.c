@@ -0,0 +1,295 @@
+/**
+ * stage_profiler.c - Per-stage CPU and wall time over a rolling window, plus per-thread CPU
+ *
+ * Buckets are keyed by epoch (now / bucket length); a bucket whose epoch is stale is cleared
+ * when it is next written, and ignored when read.
+ */
+
+#include "stage_profiler.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct StageBucket {
+    int64_t epoch;
+    StageWindowStats stages[PIPELINE_STAGE_COUNT];
+} StageBucket;
+
+typedef struct ThreadBaseline {
+    pid_t tid;
+    int64_t total_cpu_ns;
+} ThreadBaseline;
+
+struct StageProfiler {
+    pthread_mutex_t lock;
+
+    StageBucket buckets[STAGE_PROFILER_BUCKETS];
+    bool started;
+    int64_t start_ns;
+
+    ThreadBaseline baselines[STAGE_PROFILER_MAX_THREADS];
+    int baseline_count;
+    int64_t last_sample_ns;
+    int64_t ns_per_tick;
+};
+
+static int64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+/* ============================================================================
+ * Stage windows (caller holds the lock)
+ * ========================================================================== */
+
+static void clear_locked(StageProfiler* sp) {
+    for (int i = 0; i < STAGE_PROFILER_BUCKETS; i++) {
+        memset(&sp->buckets[i], 0, sizeof(sp->buckets[i]));
+        sp->buckets[i].epoch = -1;
+    }
+    sp->started = false;
+    sp->baseline_count = 0;
+    sp->last_sample_ns = 0;
+}
+
+static void mark_started(StageProfiler* sp, int64_t now_ns) {
+    if (!sp->started) {
+        sp->started = true;
+        sp->start_ns = now_ns;
+    }
+}
+
+/* ============================================================================
+ * Thread sampling
+ * ========================================================================== */
+
+/* Parse comm, utime and stime (fields 2, 14, 15) from a /proc/<pid>/task/<tid>/stat line. */
+static bool parse_task_stat(const char* buf, char* name, size_t name_len, int64_t* ticks) {
+    const char* open = strchr(buf, '(');
+    const char* close = strrchr(buf, ')');
+    if (open == NULL || close == NULL || close < open) {
+        return false;
+    }
+    size_t len = (size_t)(close - open - 1);
+    if (len >= name_len) {
+        len = name_len - 1;
+    }
+    memcpy(name, open + 1, len);
+    name[len] = '\0';
+
+    /* Fields after the command name start at 3 (state). */
+    const char* p = close + 1;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    for (int field = 3; field <= 15; field++) {
+        while (*p == ' ') {
+            p++;
+        }
+        if (*p == '\0') {
+            return false;
+        }
+        if (field == 14) {
+            utime = strtoull(p, NULL, 10);
+        } else if (field == 15) {
+            stime = strtoull(p, NULL, 10);
+        }
+        while (*p != ' ' && *p != '\0') {
+            p++;
+        }
+    }
+    *ticks = (int64_t)(utime + stime);
+    return true;
+}
+
+static int64_t baseline_for(const ThreadBaseline* baselines, int count, pid_t tid) {
+    for (int i = 0; i < count; i++) {
+        if (baselines[i].tid == tid) {
+            return baselines[i].total_cpu_ns;
+        }
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+StageProfiler* stage_profiler_create(void) {
+    StageProfiler* sp = (StageProfiler*)calloc(1, sizeof(StageProfiler));
+    if (sp == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&sp->lock, NULL) != 0) {
+        free(sp);
+        return NULL;
+    }
+    long hz = sysconf(_SC_CLK_TCK);
+    if (hz <= 0) {
+        hz = 100;
+    }
+    sp->ns_per_tick = 1000000000LL / hz;
+    clear_locked(sp);
+    return sp;
+}
+
+void stage_profiler_destroy(StageProfiler* sp) {
+    if (sp == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&sp->lock);
+    free(sp);
+}
+
+void stage_profiler_reset(StageProfiler* sp) {
+    pthread_mutex_lock(&sp->lock);
+    clear_locked(sp);
+    pthread_mutex_unlock(&sp->lock);
+}
+
+void stage_profiler_record(StageProfiler* sp, PipelineStage stage, int64_t wall_ns, int64_t cpu_ns, int64_t now_ns) {
+    if ((int)stage < 0 || stage >= PIPELINE_STAGE_COUNT || now_ns < 0) {
+        return;
+    }
+    const int64_t epoch = now_ns / STAGE_PROFILER_BUCKET_NS;
+
+    pthread_mutex_lock(&sp->lock);
+    mark_started(sp, now_ns - wall_ns);
+    StageBucket* bucket = &sp->buckets[epoch % STAGE_PROFILER_BUCKETS];
+    if (bucket->epoch != epoch) {
+        memset(bucket->stages, 0, sizeof(bucket->stages));
+        bucket->epoch = epoch;
+    }
+    StageWindowStats* s = &bucket->stages[stage];
+    s->count++;
+    s->wall_total_ns += wall_ns;
+    s->cpu_total_ns += cpu_ns;
+    if (wall_ns > s->wall_max_ns) {
+        s->wall_max_ns = wall_ns;
+    }
+    pthread_mutex_unlock(&sp->lock);
+}
+
+void stage_profiler_get_stats(StageProfiler* sp, int64_t now_ns, StageProfilerStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    const int64_t epoch = now_ns / STAGE_PROFILER_BUCKET_NS;
+
+    pthread_mutex_lock(&sp->lock);
+    mark_started(sp, now_ns);
+    for (int i = 0; i < STAGE_PROFILER_BUCKETS; i++) {
+        const StageBucket* bucket = &sp->buckets[i];
+        if (bucket->epoch < 0 || bucket->epoch > epoch || bucket->epoch <= epoch - STAGE_PROFILER_BUCKETS) {
+            continue;
+        }
+        for (int s = 0; s < PIPELINE_STAGE_COUNT; s++) {
+            const StageWindowStats* src = &bucket->stages[s];
+            StageWindowStats* dst = &stats->stages[s];
+            dst->count += src->count;
+            dst->wall_total_ns += src->wall_total_ns;
+            dst->cpu_total_ns += src->cpu_total_ns;
+            if (src->wall_max_ns > dst->wall_max_ns) {
+                dst->wall_max_ns = src->wall_max_ns;
+            }
+        }
+    }
+
+    /* The oldest bucket starts at (epoch - BUCKETS + 1); the current one is partial. */
+    int64_t window = (now_ns - (epoch - STAGE_PROFILER_BUCKETS + 1) * STAGE_PROFILER_BUCKET_NS);
+    if (now_ns - sp->start_ns < window) {
+        window = now_ns - sp->start_ns;
+    }
+    stats->window_ns = window > 0 ? window : 0;
+    pthread_mutex_unlock(&sp->lock);
+}
+
+int stage_profiler_sample_threads(StageProfiler* sp, const char* task_dir, int64_t now_ns,
+                                  ThreadCpuUsage* out, int max, int64_t* interval_ns) {
+    DIR* dir = opendir(task_dir);
+    if (dir == NULL) {
+        *interval_ns = 0;
+        return 0;
+    }
+
+    /* Read outside the lock: /proc reads can be slow with many threads. */
+    ThreadCpuUsage current[STAGE_PROFILER_MAX_THREADS];
+    int current_count = 0;
+    struct dirent* entry;
+    char path[256];
+    char buf[512];
+    while ((entry = readdir(dir)) != NULL && current_count < STAGE_PROFILER_MAX_THREADS) {
+        char* end;
+        const long tid = strtol(entry->d_name, &end, 10);
+        if (end == entry->d_name || *end != '\0' || tid <= 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%ld/stat", task_dir, tid);
+        FILE* f = fopen(path, "r");
+        if (f == NULL) {
+            continue;  /* Exited since readdir. */
+        }
+        const size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+        fclose(f);
+        buf[n] = '\0';
+
+        ThreadCpuUsage* t = &current[current_count];
+        int64_t ticks;
+        if (!parse_task_stat(buf, t->name, sizeof(t->name), &ticks)) {
+            continue;
+        }
+        t->tid = (pid_t)tid;
+        t->total_cpu_ns = ticks * sp->ns_per_tick;
+        t->cpu_ns = 0;
+        current_count++;
+    }
+    closedir(dir);
+
+    pthread_mutex_lock(&sp->lock);
+    *interval_ns = sp->last_sample_ns > 0 ? now_ns - sp->last_sample_ns : 0;
+    for (int i = 0; i < current_count; i++) {
+        const int64_t previous = baseline_for(sp->baselines, sp->baseline_count, current[i].tid);
+        if (previous >= 0 && current[i].total_cpu_ns >= previous) {
+            current[i].cpu_ns = current[i].total_cpu_ns - previous;
+        }
+    }
+    /* Threads that exited drop out of the baseline with this replacement. */
+    for (int i = 0; i < current_count; i++) {
+        sp->baselines[i].tid = current[i].tid;
+        sp->baselines[i].total_cpu_ns = current[i].total_cpu_ns;
+    }
+    sp->baseline_count = current_count;
+    sp->last_sample_ns = now_ns;
+    pthread_mutex_unlock(&sp->lock);
+
+    /* Busiest first; thread counts are small enough for insertion sort. */
+    for (int i = 1; i < current_count; i++) {
+        const ThreadCpuUsage t = current[i];
+        int j = i;
+        while (j > 0 && (current[j - 1].cpu_ns < t.cpu_ns ||
+                         (current[j - 1].cpu_ns == t.cpu_ns && current[j - 1].total_cpu_ns < t.total_cpu_ns))) {
+            current[j] = current[j - 1];
+            j--;
+        }
+        current[j] = t;
+    }
+
+    const int count = current_count < max ? current_count : max;
+    memcpy(out, current, (size_t)count * sizeof(ThreadCpuUsage));
+    return count;
+}
+
+void stage_mark_begin(StageMark* mark) {
+    mark->wall_ns = clock_ns(CLOCK_MONOTONIC);
+    mark->cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+}
+
+void stage_mark_end(StageProfiler* sp, PipelineStage stage, const StageMark* mark) {
+    const int64_t now = clock_ns(CLOCK_MONOTONIC);
+    const int64_t cpu = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    stage_profiler_record(sp, stage, now - mark->wall_ns, cpu - mark->cpu_ns, now);
+}
@@ -0,0 +1,87 @@
+/**
+ * stage_profiler.h - Per-stage CPU and wall time over a rolling window, plus per-thread CPU
+ *
+ * Each pipeline stage (capture, convert, render, decode submit, mux) brackets its work with
+ * a StageMark; the profiler adds the wall time and the calling thread's CPU time to one of
+ * STAGE_PROFILER_BUCKETS time buckets, so statistics always cover the last
+ * STAGE_PROFILER_WINDOW_NS without any per-frame history.
+ *
+ * Per-thread CPU is sampled from /proc/self/task/<tid>/stat, which also covers threads the
+ * app does not own (NDI SDK receive threads, MediaCodec callbacks).
+ */
+
+#ifndef NDI_STAGE_PROFILER_H
+#define NDI_STAGE_PROFILER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define STAGE_PROFILER_BUCKET_NS 250000000LL
+#define STAGE_PROFILER_BUCKETS 8
+#define STAGE_PROFILER_WINDOW_NS (STAGE_PROFILER_BUCKET_NS * STAGE_PROFILER_BUCKETS)
+#define STAGE_PROFILER_MAX_THREADS 128
+#define STAGE_PROFILER_THREAD_NAME_LEN 16
+#define STAGE_PROFILER_TASK_DIR "/proc/self/task"
+
+/* Values match NdiNative.PipelineStage on the Kotlin side. */
+typedef enum PipelineStage {
+    PIPELINE_STAGE_CAPTURE = 0,        /* Frame hand-off after the SDK returns it (deinterlace, wrap for Java). */
+    PIPELINE_STAGE_CONVERT = 1,        /* Pixel format conversion for display or encoding. */
+    PIPELINE_STAGE_RENDER = 2,         /* Drawing or releasing a frame to the surface. */
+    PIPELINE_STAGE_DECODE_SUBMIT = 3,  /* Copying a compressed frame into MediaCodec. */
+    PIPELINE_STAGE_MUX = 4,            /* Writing samples to the MP4 muxer. */
+    PIPELINE_STAGE_COUNT = 5,
+} PipelineStage;
+
+typedef struct StageMark {
+    int64_t wall_ns;  /* CLOCK_MONOTONIC at begin. */
+    int64_t cpu_ns;   /* CLOCK_THREAD_CPUTIME_ID at begin. */
+} StageMark;
+
+typedef struct StageWindowStats {
+    uint64_t count;
+    int64_t wall_total_ns;
+    int64_t wall_max_ns;
+    int64_t cpu_total_ns;   /* CPU time of the threads that ran the stage. */
+} StageWindowStats;
+
+typedef struct StageProfilerStats {
+    int64_t window_ns;      /* Time the statistics cover (shorter right after a reset). */
+    StageWindowStats stages[PIPELINE_STAGE_COUNT];
+} StageProfilerStats;
+
+typedef struct ThreadCpuUsage {
+    pid_t tid;
+    char name[STAGE_PROFILER_THREAD_NAME_LEN];
+    int64_t cpu_ns;         /* CPU time used since the previous sample. */
+    int64_t total_cpu_ns;   /* CPU time since the thread started. */
+} ThreadCpuUsage;
+
+typedef struct StageProfiler StageProfiler;
+
+StageProfiler* stage_profiler_create(void);
+void stage_profiler_destroy(StageProfiler* sp);
+
+/* Forget all stage statistics and thread baselines. */
+void stage_profiler_reset(StageProfiler* sp);
+
+/* Add one execution of stage that took wall_ns and cpu_ns, ending at now_ns (monotonic). */
+void stage_profiler_record(StageProfiler* sp, PipelineStage stage, int64_t wall_ns, int64_t cpu_ns, int64_t now_ns);
+
+/* Statistics for the window ending at now_ns. */
+void stage_profiler_get_stats(StageProfiler* sp, int64_t now_ns, StageProfilerStats* stats);
+
+/*
+ * Read every thread under task_dir (normally STAGE_PROFILER_TASK_DIR) and report CPU used
+ * since the previous call, busiest first. Threads first seen by this call report 0. Returns
+ * the number of entries written; *interval_ns receives the time since the previous call
+ * (0 on the first).
+ */
+int stage_profiler_sample_threads(StageProfiler* sp, const char* task_dir, int64_t now_ns,
+                                  ThreadCpuUsage* out, int max, int64_t* interval_ns);
+
+/* Convenience for the calling thread: read both clocks at begin, record at end. */
+void stage_mark_begin(StageMark* mark);
+void stage_mark_end(StageProfiler* sp, PipelineStage stage, const StageMark* mark);
+
+#endif /* NDI_STAGE_PROFILER_H */
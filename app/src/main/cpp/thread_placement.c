@@ -0,0 +1,431 @@
+/**
+ * thread_placement.c - big.LITTLE-aware CPU affinity and priority for pipeline threads
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "thread_placement.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define NICE_MIN -20
+#define NICE_MAX 19
+
+typedef struct ThreadSlot {
+    bool active;
+    ThreadPlacementInfo info;
+} ThreadSlot;
+
+struct ThreadPlacement {
+    pthread_mutex_t lock;
+    CpuTopology topology;
+    ThreadPlacementConfig config;
+    ThreadSlot slots[THREAD_PLACEMENT_MAX_THREADS];
+};
+
+static const char* const kRoleNames[THREAD_ROLE_COUNT] = {
+    "receive", "decoder_input", "decoder_output", "recorder", "pacer",
+};
+
+/* ============================================================================
+ * Topology
+ * ========================================================================== */
+
+static bool read_long(const char* path, long* value) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        return false;
+    }
+    const bool ok = fscanf(f, "%ld", value) == 1;
+    fclose(f);
+    return ok;
+}
+
+bool cpu_topology_detect(const char* sysfs_cpu_root, CpuTopology* topology) {
+    memset(topology, 0, sizeof(*topology));
+    long capacity[THREAD_PLACEMENT_MAX_CPUS];
+    long best = 0;
+    bool have_capacity = true;
+    char path[256];
+
+    for (int cpu = 0; cpu < THREAD_PLACEMENT_MAX_CPUS; cpu++) {
+        snprintf(path, sizeof(path), "%s/cpu%d", sysfs_cpu_root, cpu);
+        if (access(path, F_OK) != 0) {
+            break;
+        }
+        /* cpu_capacity reflects micro-architecture; max frequency is the fallback. */
+        snprintf(path, sizeof(path), "%s/cpu%d/cpu_capacity", sysfs_cpu_root, cpu);
+        if (!read_long(path, &capacity[cpu])) {
+            snprintf(path, sizeof(path), "%s/cpu%d/cpufreq/cpuinfo_max_freq", sysfs_cpu_root, cpu);
+            if (!read_long(path, &capacity[cpu])) {
+                have_capacity = false;
+                capacity[cpu] = 0;
+            }
+        }
+        if (capacity[cpu] > best) {
+            best = capacity[cpu];
+        }
+        topology->all_mask |= 1ULL << cpu;
+        topology->cpu_count++;
+    }
+    if (topology->cpu_count == 0) {
+        return false;
+    }
+
+    for (int cpu = 0; cpu < topology->cpu_count; cpu++) {
+        if (have_capacity && capacity[cpu] == best) {
+            topology->big_mask |= 1ULL << cpu;
+        }
+    }
+    topology->little_mask = topology->all_mask & ~topology->big_mask;
+    if (topology->big_mask == 0 || topology->little_mask == 0) {
+        /* Homogeneous (or unknown): every core is both. */
+        topology->big_mask = topology->all_mask;
+        topology->little_mask = topology->all_mask;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Configuration
+ * ========================================================================== */
+
+static ThreadRolePolicy policy(uint64_t mask, int nice) {
+    const ThreadRolePolicy p = { .cpu_mask = mask, .set_nice = true, .nice = nice };
+    return p;
+}
+
+void thread_placement_default_config(const CpuTopology* topology, ThreadPlacementConfig* config) {
+    /* Nice values match Android's THREAD_PRIORITY_VIDEO (-10) and URGENT_DISPLAY (-8). */
+    config->roles[THREAD_ROLE_RECEIVE] = policy(topology->big_mask, -10);
+    config->roles[THREAD_ROLE_DECODER_INPUT] = policy(topology->big_mask, -8);
+    config->roles[THREAD_ROLE_DECODER_OUTPUT] = policy(topology->big_mask, -8);
+    config->roles[THREAD_ROLE_PACER] = policy(topology->big_mask, -8);
+    /* Recording tolerates queueing; let it use every core at slightly raised priority. */
+    config->roles[THREAD_ROLE_RECORDER] = policy(topology->all_mask, -2);
+}
+
+static bool parse_int(const char** p, long* value) {
+    char* end;
+    errno = 0;
+    const long v = strtol(*p, &end, 10);
+    if (end == *p || errno != 0) {
+        return false;
+    }
+    *p = end;
+    *value = v;
+    return true;
+}
+
+/* Parse cpus up to '@', ';' or the end. */
+static bool parse_cpus(const char** p, const CpuTopology* topology, uint64_t* mask) {
+    static const struct { const char* name; size_t len; } kNamed[] = {
+        { "big", 3 }, { "little", 6 }, { "all", 3 }, { "any", 3 },
+    };
+    for (size_t i = 0; i < sizeof(kNamed) / sizeof(kNamed[0]); i++) {
+        if (strncmp(*p, kNamed[i].name, kNamed[i].len) == 0) {
+            const char next = (*p)[kNamed[i].len];
+            if (next == '\0' || next == '@' || next == ';') {
+                *p += kNamed[i].len;
+                *mask = (i == 0) ? topology->big_mask
+                      : (i == 1) ? topology->little_mask
+                      : (i == 2) ? topology->all_mask
+                      : 0;
+                return true;
+            }
+        }
+    }
+
+    uint64_t m = 0;
+    for (;;) {
+        long first;
+        long last;
+        if (!parse_int(p, &first)) {
+            return false;
+        }
+        last = first;
+        if (**p == '-') {
+            (*p)++;
+            if (!parse_int(p, &last)) {
+                return false;
+            }
+        }
+        if (first < 0 || last < first || last >= THREAD_PLACEMENT_MAX_CPUS) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            m |= 1ULL << cpu;
+        }
+        if (**p != ',') {
+            break;
+        }
+        (*p)++;
+    }
+    *mask = m;
+    return m != 0;
+}
+
+bool thread_placement_parse(const char* spec, const CpuTopology* topology, ThreadPlacementConfig* config) {
+    if (spec == NULL) {
+        return true;
+    }
+    ThreadPlacementConfig result = *config;
+    const char* p = spec;
+
+    while (*p != '\0') {
+        while (*p == ' ' || *p == ';') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+
+        int role = -1;
+        for (int r = 0; r < THREAD_ROLE_COUNT; r++) {
+            const size_t len = strlen(kRoleNames[r]);
+            if (strncmp(p, kRoleNames[r], len) == 0 && p[len] == '=') {
+                role = r;
+                p += len + 1;
+                break;
+            }
+        }
+        if (role < 0) {
+            return false;
+        }
+
+        ThreadRolePolicy entry = { .cpu_mask = 0, .set_nice = false, .nice = 0 };
+        if (!parse_cpus(&p, topology, &entry.cpu_mask)) {
+            return false;
+        }
+        if (*p == '@') {
+            p++;
+            long nice;
+            if (!parse_int(&p, &nice) || nice < NICE_MIN || nice > NICE_MAX) {
+                return false;
+            }
+            entry.set_nice = true;
+            entry.nice = (int)nice;
+        }
+        if (*p != '\0' && *p != ';') {
+            return false;
+        }
+        result.roles[role] = entry;
+    }
+
+    *config = result;
+    return true;
+}
+
+/* ============================================================================
+ * Placement (caller holds the lock)
+ * ========================================================================== */
+
+static int place(ThreadPlacement* tp, ThreadSlot* slot) {
+    ThreadPlacementInfo* info = &slot->info;
+    const ThreadRolePolicy* p = &tp->config.roles[info->role];
+    int error = 0;
+
+    info->requested_mask = p->cpu_mask & tp->topology.all_mask;
+    if (info->requested_mask != 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < THREAD_PLACEMENT_MAX_CPUS; cpu++) {
+            if (info->requested_mask & (1ULL << cpu)) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        if (sched_setaffinity(info->tid, sizeof(set), &set) != 0) {
+            error = errno;
+        }
+    }
+
+    info->nice_set = p->set_nice;
+    info->requested_nice = p->nice;
+    if (p->set_nice && setpriority(PRIO_PROCESS, (id_t)info->tid, p->nice) != 0 && error == 0) {
+        error = errno;
+    }
+
+    info->error = error;
+    return error;
+}
+
+static ThreadSlot* find_slot(ThreadPlacement* tp, pid_t tid) {
+    for (int i = 0; i < THREAD_PLACEMENT_MAX_THREADS; i++) {
+        if (tp->slots[i].active && tp->slots[i].info.tid == tid) {
+            return &tp->slots[i];
+        }
+    }
+    return NULL;
+}
+
+/* CPU the thread last ran on: field 39 of /proc/self/task/<tid>/stat. */
+static int read_thread_cpu(pid_t tid) {
+    char path[64];
+    char buf[1024];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/stat", (int)tid);
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+    const size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+
+    /* The command name may contain spaces; fields are counted from the closing parenthesis. */
+    const char* p = strrchr(buf, ')');
+    if (p == NULL) {
+        return -1;
+    }
+    p++;
+    for (int field = 2; field < 39; field++) {
+        p = strchr(p + 1, ' ');
+        if (p == NULL) {
+            return -1;
+        }
+    }
+    return atoi(p + 1);
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+ThreadPlacement* thread_placement_create(const CpuTopology* topology, const ThreadPlacementConfig* config) {
+    ThreadPlacement* tp = (ThreadPlacement*)calloc(1, sizeof(ThreadPlacement));
+    if (tp == NULL) {
+        return NULL;
+    }
+    if (pthread_mutex_init(&tp->lock, NULL) != 0) {
+        free(tp);
+        return NULL;
+    }
+    tp->topology = *topology;
+    tp->config = *config;
+    return tp;
+}
+
+void thread_placement_destroy(ThreadPlacement* tp) {
+    if (tp == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&tp->lock);
+    free(tp);
+}
+
+void thread_placement_configure(ThreadPlacement* tp, const ThreadPlacementConfig* config) {
+    pthread_mutex_lock(&tp->lock);
+    tp->config = *config;
+    for (int i = 0; i < THREAD_PLACEMENT_MAX_THREADS; i++) {
+        if (tp->slots[i].active) {
+            place(tp, &tp->slots[i]);
+        }
+    }
+    pthread_mutex_unlock(&tp->lock);
+}
+
+int thread_placement_apply(ThreadPlacement* tp, ThreadRole role, pid_t tid) {
+    if ((int)role < 0 || role >= THREAD_ROLE_COUNT) {
+        return EINVAL;
+    }
+    pthread_mutex_lock(&tp->lock);
+    ThreadSlot* slot = find_slot(tp, tid);
+    for (int i = 0; slot == NULL && i < THREAD_PLACEMENT_MAX_THREADS; i++) {
+        if (!tp->slots[i].active) {
+            slot = &tp->slots[i];
+        }
+    }
+    if (slot == NULL) {
+        pthread_mutex_unlock(&tp->lock);
+        return ENOSPC;
+    }
+    if (!slot->active || slot->info.role != (int)role) {
+        memset(slot, 0, sizeof(*slot));
+        slot->active = true;
+        slot->info.role = (int)role;
+        slot->info.tid = tid;
+        slot->info.cpu = -1;
+    }
+    const int error = place(tp, slot);
+    pthread_mutex_unlock(&tp->lock);
+    return error;
+}
+
+void thread_placement_unregister(ThreadPlacement* tp, pid_t tid) {
+    pthread_mutex_lock(&tp->lock);
+    ThreadSlot* slot = find_slot(tp, tid);
+    if (slot != NULL) {
+        slot->active = false;
+    }
+    pthread_mutex_unlock(&tp->lock);
+}
+
+void thread_placement_sample(ThreadPlacement* tp) {
+    pthread_mutex_lock(&tp->lock);
+    for (int i = 0; i < THREAD_PLACEMENT_MAX_THREADS; i++) {
+        ThreadSlot* slot = &tp->slots[i];
+        if (!slot->active) {
+            continue;
+        }
+        ThreadPlacementInfo* info = &slot->info;
+        const int cpu = read_thread_cpu(info->tid);
+        if (cpu < 0) {
+            /* Exited without unregistering. */
+            slot->active = false;
+            continue;
+        }
+
+        info->samples++;
+        if (info->cpu >= 0 && cpu != info->cpu) {
+            info->migrations++;
+        }
+        info->cpu = cpu;
+        if (info->requested_mask != 0 && (cpu >= THREAD_PLACEMENT_MAX_CPUS || !(info->requested_mask & (1ULL << cpu)))) {
+            info->off_mask_samples++;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(info->tid, sizeof(set), &set) == 0) {
+            uint64_t mask = 0;
+            for (int c = 0; c < THREAD_PLACEMENT_MAX_CPUS; c++) {
+                if (CPU_ISSET(c, &set)) {
+                    mask |= 1ULL << c;
+                }
+            }
+            info->actual_mask = mask;
+        }
+
+        errno = 0;
+        const int nice = getpriority(PRIO_PROCESS, (id_t)info->tid);
+        if (errno == 0) {
+            info->nice = nice;
+        }
+    }
+    pthread_mutex_unlock(&tp->lock);
+}
+
+int thread_placement_get_threads(ThreadPlacement* tp, ThreadPlacementInfo* out, int max) {
+    int count = 0;
+    pthread_mutex_lock(&tp->lock);
+    for (int i = 0; i < THREAD_PLACEMENT_MAX_THREADS && count < max; i++) {
+        if (tp->slots[i].active) {
+            out[count++] = tp->slots[i].info;
+        }
+    }
+    pthread_mutex_unlock(&tp->lock);
+    return count;
+}
+
+pid_t thread_placement_gettid(void) {
+    return (pid_t)syscall(SYS_gettid);
+}
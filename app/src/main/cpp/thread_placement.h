@@ -0,0 +1,110 @@
+/**
+ * thread_placement.h - big.LITTLE-aware CPU affinity and priority for pipeline threads
+ *
+ * Linux only (sched_setaffinity, setpriority and procfs); it runs on any Linux host as well
+ * as on Android.
+ *
+ * Each pipeline thread registers under a role. A core map assigns every role a CPU set and a
+ * nice value; CPU sets can name the "big" or "little" cluster, detected from sysfs
+ * (cpu_capacity, else cpuinfo_max_freq), or list CPUs explicitly. Placement is verified by
+ * sampling: the CPU each thread last ran on (from /proc) and its effective affinity, which on
+ * Android may be narrowed further by the app's cpuset.
+ */
+
+#ifndef NDI_THREAD_PLACEMENT_H
+#define NDI_THREAD_PLACEMENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define THREAD_PLACEMENT_MAX_CPUS 64
+#define THREAD_PLACEMENT_MAX_THREADS 16
+#define THREAD_PLACEMENT_SYSFS_CPU "/sys/devices/system/cpu"
+
+/* Values match NdiNative.ThreadRole on the Kotlin side. */
+typedef enum ThreadRole {
+    THREAD_ROLE_RECEIVE = 0,         /* NDI-Receive-Thread: capture, deinterlace, conversion. */
+    THREAD_ROLE_DECODER_INPUT = 1,   /* Decoder-Input: feeds MediaCodec. */
+    THREAD_ROLE_DECODER_OUTPUT = 2,  /* Decoder-Output: releases decoded frames to the surface. */
+    THREAD_ROLE_RECORDER = 3,        /* VideoRecorder-Write: color conversion and muxing. */
+    THREAD_ROLE_PACER = 4,           /* NDI-Frame-Pacer: vsync-aligned presentation. */
+    THREAD_ROLE_COUNT = 5,
+} ThreadRole;
+
+typedef struct CpuTopology {
+    int cpu_count;
+    uint64_t all_mask;
+    uint64_t big_mask;     /* Highest-capacity cores; all cores on homogeneous systems. */
+    uint64_t little_mask;  /* The remaining cores; all cores on homogeneous systems. */
+} CpuTopology;
+
+typedef struct ThreadRolePolicy {
+    uint64_t cpu_mask;  /* 0 leaves affinity unchanged. */
+    bool set_nice;
+    int nice;           /* -20..19; Android THREAD_PRIORITY_* values are nice values. */
+} ThreadRolePolicy;
+
+typedef struct ThreadPlacementConfig {
+    ThreadRolePolicy roles[THREAD_ROLE_COUNT];
+} ThreadPlacementConfig;
+
+typedef struct ThreadPlacementInfo {
+    int role;
+    pid_t tid;
+    uint64_t requested_mask;   /* Policy mask limited to present CPUs (0: unchanged). */
+    uint64_t actual_mask;      /* Affinity the kernel reports. */
+    int requested_nice;
+    bool nice_set;
+    int nice;                  /* Current nice value. */
+    int cpu;                   /* CPU the thread last ran on, -1 if unknown. */
+    uint64_t samples;
+    uint64_t off_mask_samples; /* Samples that found the thread outside its requested CPUs. */
+    uint64_t migrations;       /* CPU changes between consecutive samples. */
+    int error;                 /* errno from the last failed placement call, or 0. */
+} ThreadPlacementInfo;
+
+typedef struct ThreadPlacement ThreadPlacement;
+
+/*
+ * Read the CPU topology from a sysfs cpu directory (normally THREAD_PLACEMENT_SYSFS_CPU).
+ * Returns false if no CPU was found.
+ */
+bool cpu_topology_detect(const char* sysfs_cpu_root, CpuTopology* topology);
+
+/* Default policy: latency-critical stages on the big cores at raised priority. */
+void thread_placement_default_config(const CpuTopology* topology, ThreadPlacementConfig* config);
+
+/*
+ * Apply a core map on top of config. Entries are separated by ';' and read
+ * role=cpus[@nice], where role is receive, decoder_input, decoder_output, recorder or pacer,
+ * and cpus is big, little, all, any (leave unchanged) or a list such as 4-7 or 0,2.
+ * Example: "receive=big@-10;recorder=little@0". Returns false, leaving config
+ * untouched, on a syntax error.
+ */
+bool thread_placement_parse(const char* spec, const CpuTopology* topology, ThreadPlacementConfig* config);
+
+ThreadPlacement* thread_placement_create(const CpuTopology* topology, const ThreadPlacementConfig* config);
+void thread_placement_destroy(ThreadPlacement* tp);
+
+/* Replace the policy and re-apply it to every registered thread. */
+void thread_placement_configure(ThreadPlacement* tp, const ThreadPlacementConfig* config);
+
+/*
+ * Register tid under role and apply the role's policy. Returns 0, or the errno of the first
+ * call that failed (the thread stays registered so verification still reports it).
+ */
+int thread_placement_apply(ThreadPlacement* tp, ThreadRole role, pid_t tid);
+
+void thread_placement_unregister(ThreadPlacement* tp, pid_t tid);
+
+/* Sample every registered thread's CPU and affinity; threads that exited are dropped. */
+void thread_placement_sample(ThreadPlacement* tp);
+
+/* Copy registered threads into out (up to max). Returns the number copied. */
+int thread_placement_get_threads(ThreadPlacement* tp, ThreadPlacementInfo* out, int max);
+
+/* Kernel thread id of the caller. */
+pid_t thread_placement_gettid(void);
+
+#endif /* NDI_THREAD_PLACEMENT_H */
@@ -0,0 +1,136 @@
+/**
+ * thumbnail.c - Downscaling received frames to source list preview thumbnails
+ *
+ * See thumbnail.h. Source span boundaries are computed with integer division so that adjacent
+ * destination pixels tile the source exactly and every source pixel is counted once.
+ */
+
+#include "thumbnail.h"
+
+#include <stddef.h>
+
+/* BT.709 limited range to full-range RGB, Q8. */
+#define YUV_Y_SCALE 298
+#define YUV_RV 459
+#define YUV_GU 55
+#define YUV_GV 136
+#define YUV_BU 541
+
+/* ============================================================================
+ * Internal helpers
+ * ========================================================================== */
+
+static inline uint8_t clamp_u8(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline uint32_t pack_argb(uint32_t a, uint32_t r, uint32_t g, uint32_t b) {
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+static inline uint32_t yuv_to_argb(int y, int u, int v) {
+    const int c = (y - 16) * YUV_Y_SCALE;
+    const int d = u - 128;
+    const int e = v - 128;
+    return pack_argb(0xFFu,
+                     clamp_u8((c + YUV_RV * e + 128) >> 8),
+                     clamp_u8((c - YUV_GU * d - YUV_GV * e + 128) >> 8),
+                     clamp_u8((c + YUV_BU * d + 128) >> 8));
+}
+
+/* Source span [*begin, *end) covered by destination index i of count (never empty). */
+static inline void source_span(int i, int count, int src_count, int* begin, int* end) {
+    *begin = (int)((int64_t)i * src_count / count);
+    *end = (int)((int64_t)(i + 1) * src_count / count);
+    if (*end <= *begin) {
+        *end = *begin + 1;
+    }
+}
+
+static void scale_uyvy(const uint8_t* src, int src_stride, int src_width, int src_height,
+                       uint32_t* dst, int dst_width, int dst_height) {
+    for (int dy = 0; dy < dst_height; dy++) {
+        int y0, y1;
+        source_span(dy, dst_height, src_height, &y0, &y1);
+        for (int dx = 0; dx < dst_width; dx++) {
+            int x0, x1;
+            source_span(dx, dst_width, src_width, &x0, &x1);
+            uint32_t sum_y = 0, sum_u = 0, sum_v = 0;
+            for (int y = y0; y < y1; y++) {
+                const uint8_t* row = src + (size_t)y * (size_t)src_stride;
+                for (int x = x0; x < x1; x++) {
+                    /* U Y0 V Y1: each pixel takes the chroma of its pair. */
+                    const uint8_t* pair = row + (size_t)(x & ~1) * 2;
+                    sum_u += pair[0];
+                    sum_y += pair[(x & 1) ? 3 : 1];
+                    sum_v += pair[2];
+                }
+            }
+            const uint32_t n = (uint32_t)((y1 - y0) * (x1 - x0));
+            dst[(size_t)dy * (size_t)dst_width + (size_t)dx] =
+                yuv_to_argb((int)((sum_y + n / 2) / n), (int)((sum_u + n / 2) / n), (int)((sum_v + n / 2) / n));
+        }
+    }
+}
+
+/* Four bytes per pixel; red_index is 0 for RGBA order and 2 for BGRA. */
+static void scale_rgba(const uint8_t* src, int src_stride, int src_width, int src_height,
+                       int red_index, bool opaque, uint32_t* dst, int dst_width, int dst_height) {
+    const int blue_index = 2 - red_index;
+    for (int dy = 0; dy < dst_height; dy++) {
+        int y0, y1;
+        source_span(dy, dst_height, src_height, &y0, &y1);
+        for (int dx = 0; dx < dst_width; dx++) {
+            int x0, x1;
+            source_span(dx, dst_width, src_width, &x0, &x1);
+            uint32_t sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+            for (int y = y0; y < y1; y++) {
+                const uint8_t* p = src + (size_t)y * (size_t)src_stride + (size_t)x0 * 4;
+                for (int x = x0; x < x1; x++, p += 4) {
+                    sum_r += p[red_index];
+                    sum_g += p[1];
+                    sum_b += p[blue_index];
+                    sum_a += p[3];
+                }
+            }
+            const uint32_t n = (uint32_t)((y1 - y0) * (x1 - x0));
+            dst[(size_t)dy * (size_t)dst_width + (size_t)dx] =
+                pack_argb(opaque ? 0xFFu : (sum_a + n / 2) / n, (sum_r + n / 2) / n,
+                          (sum_g + n / 2) / n, (sum_b + n / 2) / n);
+        }
+    }
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+bool thumbnail_scale(const uint8_t* src, int src_stride, int src_width, int src_height,
+                     ThumbnailFormat format, uint32_t* dst, int dst_width, int dst_height) {
+    if (src == NULL || dst == NULL || src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) {
+        return false;
+    }
+
+    switch (format) {
+        case THUMBNAIL_UYVY:
+            if ((src_width % 2) != 0 || src_stride < src_width * 2) {
+                return false;
+            }
+            scale_uyvy(src, src_stride, src_width, src_height, dst, dst_width, dst_height);
+            return true;
+        case THUMBNAIL_BGRA:
+        case THUMBNAIL_BGRX:
+        case THUMBNAIL_RGBA:
+        case THUMBNAIL_RGBX:
+            if (src_stride < src_width * 4) {
+                return false;
+            }
+            scale_rgba(src, src_stride, src_width, src_height,
+                       (format == THUMBNAIL_RGBA || format == THUMBNAIL_RGBX) ? 0 : 2,
+                       format == THUMBNAIL_BGRX || format == THUMBNAIL_RGBX,
+                       dst, dst_width, dst_height);
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,33 @@
+/**
+ * thumbnail.h - Downscaling received frames to source list preview thumbnails
+ *
+ * Thumbnails are produced by box filtering: every destination pixel is the average of the
+ * source pixels it covers, so a frame is read once however small the thumbnail is, and fine
+ * detail averages out instead of aliasing. YUV is averaged before conversion, which costs one
+ * BT.709 conversion per thumbnail pixel rather than per source pixel. The output is packed
+ * 0xAARRGGBB, the layout Android's Bitmap.setPixels takes.
+ */
+
+#ifndef NDI_THUMBNAIL_H
+#define NDI_THUMBNAIL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum ThumbnailFormat {
+    THUMBNAIL_UYVY = 0,   /* 4:2:2 limited range, BT.709. */
+    THUMBNAIL_BGRA = 1,
+    THUMBNAIL_BGRX = 2,   /* As BGRA with the fourth byte ignored. */
+    THUMBNAIL_RGBA = 3,
+    THUMBNAIL_RGBX = 4
+} ThumbnailFormat;
+
+/*
+ * Scale a whole src_width x src_height frame to dst_width x dst_height pixels (the aspect
+ * ratio is not preserved). Upscaling repeats source pixels. Returns false, writing nothing, for
+ * an unknown format, non-positive sizes, a stride too small for the width, or an odd UYVY width.
+ */
+bool thumbnail_scale(const uint8_t* src, int src_stride, int src_width, int src_height,
+                     ThumbnailFormat format, uint32_t* dst, int dst_width, int dst_height);
+
+#endif /* NDI_THUMBNAIL_H */
@@ -0,0 +1,77 @@
+/**
+ * transport_probe.c - Loss and jitter measurement for comparing NDI transports
+ */
+
+#include "transport_probe.h"
+
+#include <string.h>
+
+/* RFC 3550 smoothing: each new transit difference moves the estimate by 1/16. */
+#define JITTER_GAIN (1.0 / 16.0)
+
+void transport_probe_init(TransportProbe* probe) {
+    if (probe != NULL) {
+        memset(probe, 0, sizeof(*probe));
+    }
+}
+
+void transport_probe_add(TransportProbe* probe, int64_t timestamp_ns, int64_t arrival_ns, int64_t frame_interval_ns) {
+    if (probe == NULL) {
+        return;
+    }
+    if (probe->frames == 0) {
+        probe->frames = 1;
+        probe->last_timestamp_ns = timestamp_ns;
+        probe->last_arrival_ns = arrival_ns;
+        return;
+    }
+
+    const int64_t sent_delta = timestamp_ns - probe->last_timestamp_ns;
+    if (sent_delta <= 0) {
+        /* Duplicate or late frame: it neither fills a gap nor says anything about transit. */
+        probe->frames++;
+        probe->out_of_order++;
+        return;
+    }
+
+    probe->frames++;
+    if (frame_interval_ns > 0) {
+        const int64_t gap_frames = (sent_delta + frame_interval_ns / 2) / frame_interval_ns;
+        if (gap_frames > TRANSPORT_PROBE_MAX_GAP_FRAMES) {
+            /* The sender's timeline jumped: restart the transit baseline. */
+            probe->discontinuities++;
+            probe->last_timestamp_ns = timestamp_ns;
+            probe->last_arrival_ns = arrival_ns;
+            return;
+        }
+        if (gap_frames > 1) {
+            probe->lost += (uint64_t)(gap_frames - 1);
+        }
+    }
+
+    int64_t deviation = (arrival_ns - probe->last_arrival_ns) - sent_delta;
+    if (deviation < 0) {
+        deviation = -deviation;
+    }
+    probe->jitter_ns += ((double)deviation - probe->jitter_ns) * JITTER_GAIN;
+    if (deviation > probe->max_deviation_ns) {
+        probe->max_deviation_ns = deviation;
+    }
+    probe->last_timestamp_ns = timestamp_ns;
+    probe->last_arrival_ns = arrival_ns;
+}
+
+void transport_probe_result(const TransportProbe* probe, TransportProbeResult* result) {
+    if (probe == NULL || result == NULL) {
+        return;
+    }
+    memset(result, 0, sizeof(*result));
+    result->frames = probe->frames;
+    result->lost = probe->lost;
+    const uint64_t expected = probe->frames + probe->lost;
+    result->loss_rate = (expected > 0) ? (double)probe->lost / (double)expected : 0.0;
+    result->jitter_ns = (int64_t)(probe->jitter_ns + 0.5);
+    result->max_deviation_ns = probe->max_deviation_ns;
+    result->out_of_order = probe->out_of_order;
+    result->discontinuities = probe->discontinuities;
+}
@@ -0,0 +1,49 @@
+/**
+ * transport_probe.h - Loss and jitter measurement for comparing NDI transports
+ *
+ * Fed the sender timestamp and local arrival time of each received video frame. Loss is
+ * counted from gaps in the sender timeline (so frames the network lost and frames the SDK
+ * dropped for being late count alike), and jitter is the RFC 3550 interarrival estimate:
+ * a running average of how much each frame's transit time differs from the previous one's.
+ */
+
+#ifndef NDI_TRANSPORT_PROBE_H
+#define NDI_TRANSPORT_PROBE_H
+
+#include <stdint.h>
+
+/* Gaps longer than this many frames are a sender discontinuity (restart, source switch), not loss. */
+#define TRANSPORT_PROBE_MAX_GAP_FRAMES 120
+
+typedef struct TransportProbe {
+    uint64_t frames;
+    uint64_t lost;
+    uint64_t out_of_order;   /* Timestamps at or before the previous frame's. */
+    uint64_t discontinuities;
+    int64_t last_timestamp_ns;
+    int64_t last_arrival_ns;
+    double jitter_ns;
+    int64_t max_deviation_ns;   /* Largest single transit-time change. */
+} TransportProbe;
+
+typedef struct TransportProbeResult {
+    uint64_t frames;
+    uint64_t lost;
+    double loss_rate;        /* lost / (frames + lost). */
+    int64_t jitter_ns;
+    int64_t max_deviation_ns;
+    uint64_t out_of_order;
+    uint64_t discontinuities;
+} TransportProbeResult;
+
+void transport_probe_init(TransportProbe* probe);
+
+/*
+ * Account one received frame. frame_interval_ns is the sender's nominal frame duration; gaps
+ * are rounded to whole frames of it, so timestamp wobble within a frame is not loss.
+ */
+void transport_probe_add(TransportProbe* probe, int64_t timestamp_ns, int64_t arrival_ns, int64_t frame_interval_ns);
+
+void transport_probe_result(const TransportProbe* probe, TransportProbeResult* result);
+
+#endif /* NDI_TRANSPORT_PROBE_H */
@@ -0,0 +1,126 @@
+/**
+ * transport_profile.c - NDI transport selection through the SDK configuration file
+ */
+
+#include "transport_profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define DEFAULT_MULTICAST_PREFIX "239.255.0.0"
+#define DEFAULT_MULTICAST_MASK "255.255.0.0"
+#define DEFAULT_MULTICAST_TTL 1
+
+/* ============================================================================
+ * Internal helpers
+ * ========================================================================== */
+
+/* Parse a dotted IPv4 address. The output goes into JSON, so nothing else is accepted. */
+static bool parse_ipv4(const char* text, unsigned char octets[4]) {
+    if (text == NULL || strlen(text) >= TRANSPORT_ADDRESS_MAX) {
+        return false;
+    }
+    const char* p = text;
+    for (int i = 0; i < 4; i++) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        int value = 0;
+        int digits = 0;
+        while (*p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            p++;
+            if (++digits > 3 || value > 255) {
+                return false;
+            }
+        }
+        octets[i] = (unsigned char)value;
+        if (i < 3 && *p++ != '.') {
+            return false;
+        }
+    }
+    return *p == '\0';
+}
+
+static const char* enabled(bool on) {
+    return on ? "true" : "false";
+}
+
+/* ============================================================================
+ * Public API
+ * ========================================================================== */
+
+void transport_profile_init(TransportProfile* profile, TransportMode mode) {
+    if (profile == NULL) {
+        return;
+    }
+    memset(profile, 0, sizeof(*profile));
+    profile->mode = mode;
+    snprintf(profile->multicast_prefix, sizeof(profile->multicast_prefix), "%s", DEFAULT_MULTICAST_PREFIX);
+    snprintf(profile->multicast_mask, sizeof(profile->multicast_mask), "%s", DEFAULT_MULTICAST_MASK);
+    profile->multicast_ttl = DEFAULT_MULTICAST_TTL;
+}
+
+bool transport_profile_set_multicast(TransportProfile* profile, const char* prefix, const char* mask, int ttl) {
+    unsigned char prefix_octets[4];
+    unsigned char mask_octets[4];
+    if (profile == NULL || !parse_ipv4(prefix, prefix_octets) || !parse_ipv4(mask, mask_octets) ||
+        (prefix_octets[0] & 0xF0) != 0xE0 || ttl < 1 || ttl > TRANSPORT_MAX_TTL) {
+        return false;
+    }
+    snprintf(profile->multicast_prefix, sizeof(profile->multicast_prefix), "%s", prefix);
+    snprintf(profile->multicast_mask, sizeof(profile->multicast_mask), "%s", mask);
+    profile->multicast_ttl = ttl;
+    return true;
+}
+
+int transport_profile_to_json(const TransportProfile* profile, char* out, size_t cap) {
+    if (profile == NULL || out == NULL || cap == 0) {
+        return -1;
+    }
+
+    bool tcp = false;
+    bool rudp = false;
+    bool multicast = false;
+    switch (profile->mode) {
+        case TRANSPORT_AUTO:
+            out[0] = '\0';
+            return 0;
+        case TRANSPORT_TCP:
+            tcp = true;
+            break;
+        case TRANSPORT_RUDP:
+            rudp = true;
+            break;
+        case TRANSPORT_MULTICAST:
+            multicast = true;
+            break;
+        default:
+            return -1;
+    }
+
+    /* Stored values passed transport_profile_set_multicast (or are the defaults), but the
+     * struct is public: re-check before they are written into the file. */
+    unsigned char octets[4];
+    if (!parse_ipv4(profile->multicast_prefix, octets) || !parse_ipv4(profile->multicast_mask, octets) ||
+        profile->multicast_ttl < 1 || profile->multicast_ttl > TRANSPORT_MAX_TTL) {
+        return -1;
+    }
+
+    const int n = snprintf(
+        out, cap,
+        "{\"ndi\":{"
+        "\"tcp\":{\"recv\":{\"enable\":%s}},"
+        "\"rudp\":{\"recv\":{\"enable\":%s}},"
+        "\"unicast\":{\"recv\":{\"enable\":true}},"
+        "\"multicast\":{\"recv\":{\"enable\":%s},"
+        "\"send\":{\"enable\":%s,\"netprefix\":\"%s\",\"netmask\":\"%s\",\"ttl\":%d}}"
+        "}}",
+        enabled(tcp), enabled(rudp || multicast), enabled(multicast), enabled(multicast),
+        profile->multicast_prefix, profile->multicast_mask, profile->multicast_ttl);
+    if (n < 0 || (size_t)n >= cap) {
+        out[0] = '\0';
+        return -1;
+    }
+    return n;
+}
@@ -0,0 +1,57 @@
+/**
+ * transport_profile.h - NDI transport selection through the SDK configuration file
+ *
+ * The standard SDK takes its transport settings from ndi-config.v1.json in $NDI_CONFIG_DIR,
+ * read when the SDK is initialized; there is no per-receiver equivalent, so a profile applies
+ * to every receiver (and relay sender) created after the next initialize. A profile enables
+ * one receive transport and disables the others the SDK would otherwise negotiate; multicast
+ * additionally makes this device's relay send multicast within the given group and TTL, with
+ * unicast kept as the fallback the SDK uses when the network drops multicast.
+ */
+
+#ifndef NDI_TRANSPORT_PROFILE_H
+#define NDI_TRANSPORT_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* File name the SDK looks for in $NDI_CONFIG_DIR. */
+#define TRANSPORT_CONFIG_FILE "ndi-config.v1.json"
+#define TRANSPORT_CONFIG_DIR_ENV "NDI_CONFIG_DIR"
+
+#define TRANSPORT_ADDRESS_MAX 16   /* Dotted IPv4 with terminator. */
+#define TRANSPORT_MAX_TTL 255
+
+/* Values match Kotlin NdiNative.Transport. */
+typedef enum TransportMode {
+    TRANSPORT_AUTO = 0,        /* SDK defaults: no configuration file. */
+    TRANSPORT_TCP = 1,         /* Reliable unicast over TCP. */
+    TRANSPORT_RUDP = 2,        /* Reliable UDP (the SDK's default unicast transport). */
+    TRANSPORT_MULTICAST = 3    /* One stream per sender shared by every receiver on the subnet. */
+} TransportMode;
+
+typedef struct TransportProfile {
+    TransportMode mode;
+    char multicast_prefix[TRANSPORT_ADDRESS_MAX];   /* Group range, e.g. "239.255.0.0". */
+    char multicast_mask[TRANSPORT_ADDRESS_MAX];     /* e.g. "255.255.0.0". */
+    int multicast_ttl;                              /* 1 keeps multicast on the local subnet. */
+} TransportProfile;
+
+/* Profile for mode with the default multicast group (239.255.0.0/16) and TTL 1. */
+void transport_profile_init(TransportProfile* profile, TransportMode mode);
+
+/*
+ * Set the multicast group range and TTL. Returns false, leaving the profile unchanged, unless
+ * prefix and mask are dotted IPv4 addresses, prefix is a multicast address (224.0.0.0/4) and
+ * ttl is 1-TRANSPORT_MAX_TTL.
+ */
+bool transport_profile_set_multicast(TransportProfile* profile, const char* prefix, const char* mask, int ttl);
+
+/*
+ * Write the configuration file contents for profile into out (NUL-terminated). Returns the
+ * length, 0 for TRANSPORT_AUTO (no file: the SDK uses its defaults), or -1 if the profile is
+ * invalid or out is too small.
+ */
+int transport_profile_to_json(const TransportProfile* profile, char* out, size_t cap);
+
+#endif /* NDI_TRANSPORT_PROFILE_H */
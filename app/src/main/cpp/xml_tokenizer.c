@@ -0,0 +1,329 @@
+/**
+ * xml_tokenizer.c - Zero-allocation pull tokenizer for NDI metadata XML
+ */
+
+#include "xml_tokenizer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* ============================================================================
+ * Scanning helpers
+ * ========================================================================== */
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_name_end(char c) {
+    return is_space(c) || c == '/' || c == '>' || c == '=' || c == '<' || c == '"' || c == '\'';
+}
+
+static void skip_space(XmlTokenizer* t) {
+    while (t->p < t->end && is_space(*t->p)) {
+        t->p++;
+    }
+}
+
+static bool starts_with(const XmlTokenizer* t, const char* s) {
+    const size_t n = strlen(s);
+    return (size_t)(t->end - t->p) >= n && memcmp(t->p, s, n) == 0;
+}
+
+/* Advance past the next occurrence of s; false if it does not occur. */
+static bool skip_past(XmlTokenizer* t, const char* s) {
+    const size_t n = strlen(s);
+    while ((size_t)(t->end - t->p) >= n) {
+        if (memcmp(t->p, s, n) == 0) {
+            t->p += n;
+            return true;
+        }
+        t->p++;
+    }
+    return false;
+}
+
+static bool read_name(XmlTokenizer* t, XmlSlice* name) {
+    const char* start = t->p;
+    while (t->p < t->end && !is_name_end(*t->p)) {
+        t->p++;
+    }
+    name->data = start;
+    name->len = (size_t)(t->p - start);
+    return name->len > 0;
+}
+
+static bool fail(XmlTokenizer* t, XmlToken* token) {
+    t->failed = true;
+    token->type = XML_TOKEN_ERROR;
+    return false;
+}
+
+/* ============================================================================
+ * Tokens
+ * ========================================================================== */
+
+/* Inside a start tag: an attribute, or the tag's end. */
+static bool next_in_tag(XmlTokenizer* t, XmlToken* token) {
+    skip_space(t);
+    if (t->p >= t->end) {
+        return fail(t, token);
+    }
+    if (*t->p == '>') {
+        t->p++;
+        t->in_tag = false;
+        return xml_tokenizer_next(t, token);
+    }
+    if (*t->p == '/') {
+        if (t->p + 1 >= t->end || t->p[1] != '>') {
+            return fail(t, token);
+        }
+        t->p += 2;
+        t->in_tag = false;
+        t->depth--;
+        token->type = XML_TOKEN_ELEMENT_END;
+        token->name = t->tag_name;
+        return true;
+    }
+
+    if (!read_name(t, &token->name)) {
+        return fail(t, token);
+    }
+    skip_space(t);
+    if (t->p >= t->end || *t->p != '=') {
+        return fail(t, token);
+    }
+    t->p++;
+    skip_space(t);
+    if (t->p >= t->end || (*t->p != '"' && *t->p != '\'')) {
+        return fail(t, token);
+    }
+    const char quote = *t->p++;
+    const char* value = t->p;
+    const char* close = memchr(value, quote, (size_t)(t->end - value));
+    if (close == NULL) {
+        return fail(t, token);
+    }
+    t->p = close + 1;
+    token->type = XML_TOKEN_ATTRIBUTE;
+    token->value.data = value;
+    token->value.len = (size_t)(close - value);
+    return true;
+}
+
+void xml_tokenizer_init(XmlTokenizer* t, const char* data, size_t len) {
+    memset(t, 0, sizeof(*t));
+    t->p = data;
+    t->end = data + len;
+    /* NDI strings carry their terminator in the length. */
+    while (t->end > t->p && t->end[-1] == '\0') {
+        t->end--;
+    }
+}
+
+bool xml_tokenizer_next(XmlTokenizer* t, XmlToken* token) {
+    memset(token, 0, sizeof(*token));
+    if (t->failed) {
+        token->type = XML_TOKEN_ERROR;
+        return false;
+    }
+    if (t->in_tag) {
+        return next_in_tag(t, token);
+    }
+
+    for (;;) {
+        if (t->p >= t->end) {
+            token->type = t->depth == 0 ? XML_TOKEN_END : XML_TOKEN_ERROR;
+            t->failed = t->depth != 0;
+            return false;
+        }
+
+        if (*t->p != '<') {
+            const char* start = t->p;
+            const char* next = memchr(start, '<', (size_t)(t->end - start));
+            t->p = next != NULL ? next : t->end;
+            token->type = XML_TOKEN_TEXT;
+            token->value.data = start;
+            token->value.len = (size_t)(t->p - start);
+            return true;
+        }
+
+        if (starts_with(t, "<!--")) {
+            t->p += 4;
+            if (!skip_past(t, "-->")) {
+                return fail(t, token);
+            }
+            continue;
+        }
+        if (starts_with(t, "<![CDATA[")) {
+            t->p += 9;
+            const char* start = t->p;
+            if (!skip_past(t, "]]>")) {
+                return fail(t, token);
+            }
+            token->type = XML_TOKEN_TEXT;
+            token->raw = true;
+            token->value.data = start;
+            token->value.len = (size_t)(t->p - 3 - start);
+            return true;
+        }
+        if (starts_with(t, "<?")) {
+            t->p += 2;
+            if (!skip_past(t, "?>")) {
+                return fail(t, token);
+            }
+            continue;
+        }
+        if (starts_with(t, "<!")) {
+            t->p += 2;
+            if (!skip_past(t, ">")) {
+                return fail(t, token);
+            }
+            continue;
+        }
+
+        if (starts_with(t, "</")) {
+            t->p += 2;
+            if (t->depth == 0 || !read_name(t, &token->name)) {
+                return fail(t, token);
+            }
+            skip_space(t);
+            if (t->p >= t->end || *t->p != '>') {
+                return fail(t, token);
+            }
+            t->p++;
+            t->depth--;
+            token->type = XML_TOKEN_ELEMENT_END;
+            return true;
+        }
+
+        t->p++;
+        if (!read_name(t, &token->name)) {
+            return fail(t, token);
+        }
+        t->in_tag = true;
+        t->tag_name = token->name;
+        t->depth++;
+        token->type = XML_TOKEN_ELEMENT_START;
+        return true;
+    }
+}
+
+bool xml_slice_equals(XmlSlice slice, const char* s) {
+    const size_t n = strlen(s);
+    return slice.len == n && memcmp(slice.data, s, n) == 0;
+}
+
+/* ============================================================================
+ * Entities
+ * ========================================================================== */
+
+static size_t encode_utf8(uint32_t cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* Decode the reference at data[0] == '&'. Returns its length, or 0 if it is not one. */
+static size_t decode_entity(const char* data, size_t len, char* buf, size_t* buf_len) {
+    static const struct { const char* name; char c; } kNamed[] = {
+        { "&lt;", '<' }, { "&gt;", '>' }, { "&amp;", '&' }, { "&quot;", '"' }, { "&apos;", '\'' },
+    };
+    for (size_t i = 0; i < sizeof(kNamed) / sizeof(kNamed[0]); i++) {
+        const size_t n = strlen(kNamed[i].name);
+        if (len >= n && memcmp(data, kNamed[i].name, n) == 0) {
+            buf[0] = kNamed[i].c;
+            *buf_len = 1;
+            return n;
+        }
+    }
+
+    if (len < 4 || data[1] != '#') {
+        return 0;
+    }
+    const bool hex = data[2] == 'x' || data[2] == 'X';
+    size_t i = hex ? 3 : 2;
+    uint32_t cp = 0;
+    const size_t digits_start = i;
+    for (; i < len && data[i] != ';'; i++) {
+        const char c = data[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = (uint32_t)(c - '0');
+        } else if (hex && c >= 'a' && c <= 'f') {
+            digit = (uint32_t)(c - 'a' + 10);
+        } else if (hex && c >= 'A' && c <= 'F') {
+            digit = (uint32_t)(c - 'A' + 10);
+        } else {
+            return 0;
+        }
+        cp = cp * (hex ? 16 : 10) + digit;
+        if (cp > 0x10FFFF) {
+            return 0;
+        }
+    }
+    if (i >= len || i == digits_start || cp == 0) {
+        return 0;
+    }
+    *buf_len = encode_utf8(cp, buf);
+    return i + 1;
+}
+
+size_t xml_unescape(const char* data, size_t len, char* out, size_t cap, bool* truncated) {
+    if (cap == 0) {
+        if (truncated != NULL) {
+            *truncated = len > 0;
+        }
+        return 0;
+    }
+    size_t n = 0;
+    size_t i = 0;
+    bool cut = false;
+    while (i < len) {
+        char buf[4];
+        size_t buf_len = 1;
+        size_t consumed = 0;
+        if (data[i] == '&') {
+            consumed = decode_entity(data + i, len - i, buf, &buf_len);
+        }
+        if (consumed == 0) {
+            /* Copy a whole UTF-8 sequence so truncation never splits a character. */
+            const unsigned char c = (unsigned char)data[i];
+            buf_len = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+            if (buf_len > len - i) {
+                buf_len = len - i;
+            }
+            memcpy(buf, data + i, buf_len);
+            consumed = buf_len;
+        }
+        if (n + buf_len > cap - 1) {
+            cut = true;
+            break;
+        }
+        memcpy(out + n, buf, buf_len);
+        n += buf_len;
+        i += consumed;
+    }
+    out[n] = '\0';
+    if (truncated != NULL) {
+        *truncated = cut;
+    }
+    return n;
+}
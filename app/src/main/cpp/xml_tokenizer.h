@@ -0,0 +1,64 @@
+/**
+ * xml_tokenizer.h - Zero-allocation pull tokenizer for NDI metadata XML
+ *
+ * Tokens are slices into the caller's buffer, so tokenizing never allocates or copies;
+ * entities are left as-is until xml_unescape is asked to decode a slice into a
+ * caller-provided buffer. Comments, processing instructions and DOCTYPE declarations are
+ * skipped; CDATA sections are returned as raw text.
+ *
+ * This covers the XML NDI senders produce (flat elements with quoted attributes), not the
+ * full specification: there is no DTD, namespace or encoding handling, and end tag names are
+ * not checked against their start tags.
+ */
+
+#ifndef NDI_XML_TOKENIZER_H
+#define NDI_XML_TOKENIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum XmlTokenType {
+    XML_TOKEN_ELEMENT_START = 0,  /* name: element name; attributes follow. */
+    XML_TOKEN_ATTRIBUTE = 1,      /* name, value (without quotes, entities not decoded). */
+    XML_TOKEN_ELEMENT_END = 2,    /* name: element name (also emitted for "/>"). */
+    XML_TOKEN_TEXT = 3,           /* value: character data; raw is set for CDATA. */
+    XML_TOKEN_END = 4,            /* End of input. */
+    XML_TOKEN_ERROR = 5,          /* Malformed input; further calls keep returning it. */
+} XmlTokenType;
+
+typedef struct XmlSlice {
+    const char* data;
+    size_t len;
+} XmlSlice;
+
+typedef struct XmlToken {
+    XmlTokenType type;
+    XmlSlice name;
+    XmlSlice value;
+    bool raw;      /* TEXT from CDATA: entities must not be decoded. */
+} XmlToken;
+
+typedef struct XmlTokenizer {
+    const char* p;
+    const char* end;
+    bool in_tag;        /* Between an element's name and its '>' or "/>". */
+    bool failed;
+    XmlSlice tag_name;
+    int depth;          /* Open elements, including one whose tag is being read. */
+} XmlTokenizer;
+
+void xml_tokenizer_init(XmlTokenizer* t, const char* data, size_t len);
+
+/* Read the next token. Returns false at XML_TOKEN_END or XML_TOKEN_ERROR. */
+bool xml_tokenizer_next(XmlTokenizer* t, XmlToken* token);
+
+bool xml_slice_equals(XmlSlice slice, const char* s);
+
+/*
+ * Decode the predefined and numeric character references in data into out (always
+ * NUL-terminated when cap > 0). Returns the decoded length; *truncated is set if out was too
+ * small (the output stops at a character boundary).
+ */
+size_t xml_unescape(const char* data, size_t len, char* out, size_t cap, bool* truncated);
+
+#endif /* NDI_XML_TOKENIZER_H */
@@ -3,8 +3,14 @@ package com.example.ndireceiver
 import android.app.Application
 import android.content.Context
 import android.net.nsd.NsdManager
+import android.os.Process
+import android.os.SystemClock
 import android.util.Log
+import com.example.ndireceiver.data.SettingsRepository
 import com.example.ndireceiver.ndi.NdiManager
+import com.example.ndireceiver.ndi.NdiTransport
+import com.example.ndireceiver.ndi.NdiWarmup
+import com.example.ndireceiver.ndi.SourceCache
 
 /**
  * Application class for initializing NDI SDK at app startup.
@@ -13,10 +19,6 @@ class NdiReceiverApplication : Application() {
     companion object {
         private const val TAG = "NdiReceiverApp"
 
-        @Volatile
-        var ndiInitializationError: String? = null
-            private set
-
         // NsdManager instance - required for Android NDI operations
         var nsdManager: NsdManager? = null
             private set
@@ -34,30 +36,17 @@ class NdiReceiverApplication : Application() {
             Log.e(TAG, "Failed to initialize NsdManager", e)
         }
 
-        // Initialize NDI SDK with error handling
-        try {
-            val initialized = NdiManager.initialize()
-            if (initialized) {
-                Log.i(TAG, "NDI SDK initialized successfully")
-                ndiInitializationError = null
-            } else {
-                val errorMsg = "Failed to initialize NDI SDK - libraries not found"
-                Log.e(TAG, errorMsg)
-                ndiInitializationError = errorMsg
-            }
-        } catch (e: UnsatisfiedLinkError) {
-            val errorMsg = "NDI native library not available: ${e.message}"
-            Log.e(TAG, errorMsg, e)
-            ndiInitializationError = errorMsg
-        } catch (e: Exception) {
-            val errorMsg = "NDI initialization error: ${e.message}"
-            Log.e(TAG, errorMsg, e)
-            ndiInitializationError = errorMsg
-        }
+        // Load the NDI SDK in the background, then start discovery and a standby receiver
+        NdiTransport.configure(this, SettingsRepository.getInstance(this).getTransport().nativeMode)
+        SourceCache.open(this)
+        NdiWarmup.start()
+
+        Log.i(TAG, "Application created ${SystemClock.elapsedRealtime() - Process.getStartElapsedRealtime()} ms after process start")
     }
 
     override fun onTerminate() {
         super.onTerminate()
+        NdiWarmup.shutdown()
         NdiManager.destroy()
     }
 }
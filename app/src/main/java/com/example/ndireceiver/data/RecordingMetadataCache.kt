@@ -0,0 +1,153 @@
+package com.example.ndireceiver.data
+
+import android.content.Context
+import android.util.AtomicFile
+import android.util.Log
+import java.io.DataInputStream
+import java.io.DataOutputStream
+import java.io.File
+import java.io.IOException
+
+/**
+ * On-disk cache of recording metadata keyed by path, size and modification time, so listing
+ * recordings only probes files that are new or changed since the last listing.
+ *
+ * The cache is loaded on first use and written back by [save] when it changed. Entries for
+ * files that no longer exist are dropped by [retainOnly].
+ */
+class RecordingMetadataCache private constructor(file: File) {
+
+    /**
+     * Cached metadata of one file.
+     *
+     * @property sizeBytes file size the metadata was read at
+     * @property lastModified modification time the metadata was read at
+     */
+    data class Entry(
+        val sizeBytes: Long,
+        val lastModified: Long,
+        val durationMs: Long,
+        val width: Int,
+        val height: Int
+    )
+
+    companion object {
+        private const val TAG = "RecordingMetadataCache"
+        private const val FILE_NAME = "recording_metadata.bin"
+        private const val MAGIC = 0x524D4443   // 'RMDC'
+        private const val VERSION = 1
+
+        @Volatile
+        private var instance: RecordingMetadataCache? = null
+
+        /**
+         * Get singleton instance of RecordingMetadataCache.
+         */
+        fun getInstance(context: Context): RecordingMetadataCache {
+            return instance ?: synchronized(this) {
+                instance ?: RecordingMetadataCache(
+                    File(context.applicationContext.noBackupFilesDir, FILE_NAME)
+                ).also {
+                    instance = it
+                }
+            }
+        }
+    }
+
+    private val atomicFile = AtomicFile(file)
+    private val entries = HashMap<String, Entry>()
+    private var loaded = false
+    private var dirty = false
+
+    /**
+     * Cached metadata for [path], or null if there is none or the file changed since.
+     */
+    @Synchronized
+    fun get(path: String, sizeBytes: Long, lastModified: Long): Entry? {
+        load()
+        val entry = entries[path] ?: return null
+        return entry.takeIf { it.sizeBytes == sizeBytes && it.lastModified == lastModified }
+    }
+
+    @Synchronized
+    fun put(path: String, entry: Entry) {
+        load()
+        if (entries.put(path, entry) != entry) {
+            dirty = true
+        }
+    }
+
+    /**
+     * Drop entries for paths not in [paths].
+     */
+    @Synchronized
+    fun retainOnly(paths: Set<String>) {
+        load()
+        if (entries.keys.retainAll(paths)) {
+            dirty = true
+        }
+    }
+
+    /**
+     * Write the cache if it changed since it was loaded or last saved.
+     */
+    @Synchronized
+    fun save() {
+        if (!dirty) return
+        val stream = try {
+            atomicFile.startWrite()
+        } catch (e: IOException) {
+            Log.e(TAG, "Failed to write metadata cache", e)
+            return
+        }
+        try {
+            val out = DataOutputStream(stream.buffered())
+            out.writeInt(MAGIC)
+            out.writeInt(VERSION)
+            out.writeInt(entries.size)
+            for ((path, entry) in entries) {
+                out.writeUTF(path)
+                out.writeLong(entry.sizeBytes)
+                out.writeLong(entry.lastModified)
+                out.writeLong(entry.durationMs)
+                out.writeInt(entry.width)
+                out.writeInt(entry.height)
+            }
+            out.flush()
+            atomicFile.finishWrite(stream)
+            dirty = false
+        } catch (e: IOException) {
+            Log.e(TAG, "Failed to write metadata cache", e)
+            atomicFile.failWrite(stream)
+        }
+    }
+
+    private fun load() {
+        if (loaded) return
+        loaded = true
+        if (!atomicFile.baseFile.exists()) return
+
+        try {
+            DataInputStream(atomicFile.openRead().buffered()).use { input ->
+                if (input.readInt() != MAGIC || input.readInt() != VERSION) {
+                    Log.w(TAG, "Discarding metadata cache of another format")
+                    return
+                }
+                repeat(input.readInt()) {
+                    val path = input.readUTF()
+                    entries[path] = Entry(
+                        sizeBytes = input.readLong(),
+                        lastModified = input.readLong(),
+                        durationMs = input.readLong(),
+                        width = input.readInt(),
+                        height = input.readInt()
+                    )
+                }
+            }
+        } catch (e: IOException) {
+            // Rebuilt from the files on the next listing
+            Log.w(TAG, "Failed to read metadata cache", e)
+            entries.clear()
+        }
+    }
+}
@@ -3,6 +3,7 @@ package com.example.ndireceiver.data
 import android.content.Context
 import android.media.MediaMetadataRetriever
 import android.util.Log
+import com.example.ndireceiver.ndi.NdiNative
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.withContext
 import java.io.File
@@ -65,10 +66,14 @@ data class Recording(
 /**
  * Repository for managing recorded video files.
  *
- * Provides methods for listing, deleting, and retrieving metadata for recordings.
+ * Provides methods for listing, deleting, and retrieving metadata for recordings. Metadata is
+ * read natively from the MP4 box headers and kept in [RecordingMetadataCache], so a listing
+ * only reads files that changed since the previous one.
  */
 class RecordingRepository(private val context: Context) {
 
+    private val metadataCache = RecordingMetadataCache.getInstance(context)
+
     companion object {
         private const val TAG = "RecordingRepository"
         private const val RECORDINGS_DIR = "recordings"
@@ -99,7 +104,7 @@ class RecordingRepository(private val context: Context) {
             file.isFile && file.extension.equals("mp4", ignoreCase = true)
         } ?: emptyArray()
 
-        mp4Files
+        val recordings = mp4Files
             .mapNotNull { file ->
                 try {
                     getRecordingMetadata(file)
@@ -116,12 +121,56 @@ class RecordingRepository(private val context: Context) {
                 }
             }
             .sortedByDescending { it.dateModified }
+
+        metadataCache.retainOnly(mp4Files.mapTo(HashSet()) { it.absolutePath })
+        metadataCache.save()
+        recordings
     }
 
     /**
-     * Get metadata for a single recording file.
+     * Get metadata for a single recording file, from the cache if the file is unchanged.
      */
     private fun getRecordingMetadata(file: File): Recording {
+        val path = file.absolutePath
+        val sizeBytes = file.length()
+        val lastModified = file.lastModified()
+
+        val entry = metadataCache.get(path, sizeBytes, lastModified)
+            ?: probeMetadata(file, sizeBytes, lastModified).also { metadataCache.put(path, it) }
+
+        return Recording(
+            file = file,
+            name = file.name,
+            durationMs = entry.durationMs,
+            sizeBytes = sizeBytes,
+            dateModified = lastModified,
+            width = entry.width,
+            height = entry.height
+        )
+    }
+
+    /**
+     * Read metadata from the file's MP4 box headers, falling back to MediaMetadataRetriever
+     * for files the native reader cannot parse.
+     */
+    private fun probeMetadata(file: File, sizeBytes: Long, lastModified: Long): RecordingMetadataCache.Entry {
+        val info = try {
+            NdiNative.probeMp4(file.absolutePath)
+        } catch (e: LinkageError) {
+            // JNI wrapper could not be loaded
+            Log.w(TAG, "Native MP4 probe unavailable", e)
+            null
+        }
+        if (info != null) {
+            return RecordingMetadataCache.Entry(sizeBytes, lastModified, info.durationMs, info.width, info.height)
+        }
+        return retrieveMetadata(file, sizeBytes, lastModified)
+    }
+
+    /**
+     * Get metadata with MediaMetadataRetriever.
+     */
+    private fun retrieveMetadata(file: File, sizeBytes: Long, lastModified: Long): RecordingMetadataCache.Entry {
         var durationMs = 0L
         var width = 0
         var height = 0
@@ -158,15 +207,7 @@ class RecordingRepository(private val context: Context) {
             }
         }
 
-        return Recording(
-            file = file,
-            name = file.name,
-            durationMs = durationMs,
-            sizeBytes = file.length(),
-            dateModified = file.lastModified(),
-            width = width,
-            height = height
-        )
+        return RecordingMetadataCache.Entry(sizeBytes, lastModified, durationMs, width, height)
     }
 
     /**
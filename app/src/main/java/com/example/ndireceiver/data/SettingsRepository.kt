@@ -2,6 +2,7 @@ package com.example.ndireceiver.data
 
 import android.content.Context
 import android.content.SharedPreferences
+import com.example.ndireceiver.ndi.NdiNative
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asStateFlow
@@ -18,10 +19,40 @@ enum class AppLanguage(val code: String) {
     JAPANESE("ja")
 }
 
+/**
+ * Deinterlacing setting values, mapped to [NdiNative.DeinterlaceMode].
+ */
+enum class DeinterlaceSetting(val code: String, val nativeMode: Int) {
+    OFF("off", NdiNative.DeinterlaceMode.OFF),
+    WEAVE("weave", NdiNative.DeinterlaceMode.WEAVE),
+    BOB("bob", NdiNative.DeinterlaceMode.BOB),
+    MOTION_ADAPTIVE("motion_adaptive", NdiNative.DeinterlaceMode.MOTION_ADAPTIVE)
+}
+
+/**
+ * NDI transport for all receivers (see NdiTransport).
+ */
+enum class TransportSetting(val code: String, val nativeMode: Int) {
+    AUTO("auto", NdiNative.Transport.AUTO),
+    TCP("tcp", NdiNative.Transport.TCP),
+    RUDP("rudp", NdiNative.Transport.RUDP),
+    MULTICAST("multicast", NdiNative.Transport.MULTICAST)
+}
+
 data class AppSettings(
     val autoReconnect: Boolean = true,
     val screenAlwaysOn: Boolean = true,
     val showOsd: Boolean = true,
+    val latencyOsd: Boolean = false,
+    val record10Bit: Boolean = false,
+    val deinterlace: DeinterlaceSetting = DeinterlaceSetting.MOTION_ADAPTIVE,
+    val targetLatencyMs: Int = 100,
+    val lowLatencyMode: Boolean = false,
+    val adaptiveBandwidth: Boolean = true,
+    val frameMemoryBudgetMb: Int = 512,
+    val threadPlacement: Boolean = true,
+    val relayMode: Boolean = false,
+    val transport: TransportSetting = TransportSetting.AUTO,
     val lastConnectedSourceName: String? = null,
     val lastConnectedSourceUrl: String? = null,
     val language: AppLanguage = AppLanguage.SYSTEM
@@ -40,6 +71,16 @@ class SettingsRepository(context: Context) {
         private const val KEY_AUTO_RECONNECT = "auto_reconnect"
         private const val KEY_SCREEN_ALWAYS_ON = "screen_always_on"
         private const val KEY_SHOW_OSD = "show_osd"
+        private const val KEY_LATENCY_OSD = "latency_osd"
+        private const val KEY_RECORD_10BIT = "record_10bit"
+        private const val KEY_DEINTERLACE = "deinterlace"
+        private const val KEY_TARGET_LATENCY_MS = "target_latency_ms"
+        private const val KEY_LOW_LATENCY_MODE = "low_latency_mode"
+        private const val KEY_ADAPTIVE_BANDWIDTH = "adaptive_bandwidth"
+        private const val KEY_FRAME_MEMORY_BUDGET_MB = "frame_memory_budget_mb"
+        private const val KEY_THREAD_PLACEMENT = "thread_placement"
+        private const val KEY_RELAY_MODE = "relay_mode"
+        private const val KEY_TRANSPORT = "transport"
         private const val KEY_LAST_SOURCE_NAME = "last_source_name"
         private const val KEY_LAST_SOURCE_URL = "last_source_url"
         private const val KEY_LANGUAGE = "language"
@@ -48,6 +89,18 @@ class SettingsRepository(context: Context) {
         private const val DEFAULT_AUTO_RECONNECT = true
         private const val DEFAULT_SCREEN_ALWAYS_ON = true
         private const val DEFAULT_SHOW_OSD = true
+        private const val DEFAULT_LATENCY_OSD = false
+        private const val DEFAULT_RECORD_10BIT = false
+        // Latency budget; the jitter buffer only uses what the measured jitter needs
+        private const val DEFAULT_TARGET_LATENCY_MS = 100
+        private const val DEFAULT_LOW_LATENCY_MODE = false
+        // Fall back to the proxy stream on a poor link rather than dropping frames
+        private const val DEFAULT_ADAPTIVE_BANDWIDTH = true
+        // Shared by renderer, decoder, recorder and audio; leaves room for other apps on 8 GB devices
+        private const val DEFAULT_FRAME_MEMORY_BUDGET_MB = 512
+        // Keeps the receive/decode path off the little cores of big.LITTLE SoCs
+        private const val DEFAULT_THREAD_PLACEMENT = true
+        private const val DEFAULT_RELAY_MODE = false
 
         @Volatile
         private var instance: SettingsRepository? = null
@@ -77,6 +130,20 @@ class SettingsRepository(context: Context) {
             autoReconnect = prefs.getBoolean(KEY_AUTO_RECONNECT, DEFAULT_AUTO_RECONNECT),
             screenAlwaysOn = prefs.getBoolean(KEY_SCREEN_ALWAYS_ON, DEFAULT_SCREEN_ALWAYS_ON),
             showOsd = prefs.getBoolean(KEY_SHOW_OSD, DEFAULT_SHOW_OSD),
+            latencyOsd = prefs.getBoolean(KEY_LATENCY_OSD, DEFAULT_LATENCY_OSD),
+            record10Bit = prefs.getBoolean(KEY_RECORD_10BIT, DEFAULT_RECORD_10BIT),
+            deinterlace = DeinterlaceSetting.entries.find {
+                it.code == prefs.getString(KEY_DEINTERLACE, DeinterlaceSetting.MOTION_ADAPTIVE.code)
+            } ?: DeinterlaceSetting.MOTION_ADAPTIVE,
+            targetLatencyMs = prefs.getInt(KEY_TARGET_LATENCY_MS, DEFAULT_TARGET_LATENCY_MS),
+            lowLatencyMode = prefs.getBoolean(KEY_LOW_LATENCY_MODE, DEFAULT_LOW_LATENCY_MODE),
+            adaptiveBandwidth = prefs.getBoolean(KEY_ADAPTIVE_BANDWIDTH, DEFAULT_ADAPTIVE_BANDWIDTH),
+            frameMemoryBudgetMb = prefs.getInt(KEY_FRAME_MEMORY_BUDGET_MB, DEFAULT_FRAME_MEMORY_BUDGET_MB),
+            threadPlacement = prefs.getBoolean(KEY_THREAD_PLACEMENT, DEFAULT_THREAD_PLACEMENT),
+            relayMode = prefs.getBoolean(KEY_RELAY_MODE, DEFAULT_RELAY_MODE),
+            transport = TransportSetting.entries.find {
+                it.code == prefs.getString(KEY_TRANSPORT, TransportSetting.AUTO.code)
+            } ?: TransportSetting.AUTO,
             lastConnectedSourceName = prefs.getString(KEY_LAST_SOURCE_NAME, null),
             lastConnectedSourceUrl = prefs.getString(KEY_LAST_SOURCE_URL, null),
             language = AppLanguage.entries.find { 
@@ -112,6 +179,96 @@ class SettingsRepository(context: Context) {
         _settings.value = _settings.value.copy(showOsd = enabled)
     }
 
+    /**
+     * Set whether the OSD shows glass-to-glass latency percentiles.
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setLatencyOsd(enabled: Boolean) {
+        prefs.edit().putBoolean(KEY_LATENCY_OSD, enabled).commit()
+        _settings.value = _settings.value.copy(latencyOsd = enabled)
+    }
+
+    /**
+     * Set 10-bit recording preference.
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setRecord10Bit(enabled: Boolean) {
+        prefs.edit().putBoolean(KEY_RECORD_10BIT, enabled).commit()
+        _settings.value = _settings.value.copy(record10Bit = enabled)
+    }
+
+    /**
+     * Set deinterlacing preference.
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setDeinterlace(setting: DeinterlaceSetting) {
+        prefs.edit().putString(KEY_DEINTERLACE, setting.code).commit()
+        _settings.value = _settings.value.copy(deinterlace = setting)
+    }
+
+    /**
+     * Set video jitter buffer latency budget in milliseconds.
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setTargetLatencyMs(latencyMs: Int) {
+        prefs.edit().putInt(KEY_TARGET_LATENCY_MS, latencyMs).commit()
+        _settings.value = _settings.value.copy(targetLatencyMs = latencyMs)
+    }
+
+    /**
+     * Set low-latency (latest-frame-wins) mode.
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setLowLatencyMode(enabled: Boolean) {
+        prefs.edit().putBoolean(KEY_LOW_LATENCY_MODE, enabled).commit()
+        _settings.value = _settings.value.copy(lowLatencyMode = enabled)
+    }
+
+    /**
+     * Set adaptive bandwidth (switching between the source's full and proxy streams).
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setAdaptiveBandwidth(enabled: Boolean) {
+        prefs.edit().putBoolean(KEY_ADAPTIVE_BANDWIDTH, enabled).commit()
+        _settings.value = _settings.value.copy(adaptiveBandwidth = enabled)
+    }
+
+    /**
+     * Set frame memory budget in megabytes.
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setFrameMemoryBudgetMb(budgetMb: Int) {
+        prefs.edit().putInt(KEY_FRAME_MEMORY_BUDGET_MB, budgetMb).commit()
+        _settings.value = _settings.value.copy(frameMemoryBudgetMb = budgetMb)
+    }
+
+    /**
+     * Set pipeline thread placement (CPU affinity and priority).
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setThreadPlacement(enabled: Boolean) {
+        prefs.edit().putBoolean(KEY_THREAD_PLACEMENT, enabled).commit()
+        _settings.value = _settings.value.copy(threadPlacement = enabled)
+    }
+
+    /**
+     * Set relay mode (republish the received stream for other receivers).
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setRelayMode(enabled: Boolean) {
+        prefs.edit().putBoolean(KEY_RELAY_MODE, enabled).commit()
+        _settings.value = _settings.value.copy(relayMode = enabled)
+    }
+
+    /**
+     * Set the NDI transport.
+     * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
+     */
+    fun setTransport(setting: TransportSetting) {
+        prefs.edit().putString(KEY_TRANSPORT, setting.code).commit()
+        _settings.value = _settings.value.copy(transport = setting)
+    }
+
     /**
      * Save last connected source for auto-reconnect.
      * Uses commit() for synchronous write to ensure thread-safety with StateFlow update.
@@ -163,6 +320,56 @@ class SettingsRepository(context: Context) {
      */
     fun isOsdEnabled(): Boolean = _settings.value.showOsd
 
+    /**
+     * Check if the OSD shows glass-to-glass latency percentiles.
+     */
+    fun isLatencyOsdEnabled(): Boolean = _settings.value.latencyOsd
+
+    /**
+     * Check if high bit depth sources should be received and recorded at 10 bits.
+     */
+    fun isRecord10BitEnabled(): Boolean = _settings.value.record10Bit
+
+    /**
+     * Get current deinterlacing setting.
+     */
+    fun getDeinterlace(): DeinterlaceSetting = _settings.value.deinterlace
+
+    /**
+     * Get video jitter buffer latency budget in milliseconds.
+     */
+    fun getTargetLatencyMs(): Int = _settings.value.targetLatencyMs
+
+    /**
+     * Check if low-latency (latest-frame-wins) mode is enabled.
+     */
+    fun isLowLatencyModeEnabled(): Boolean = _settings.value.lowLatencyMode
+
+    /**
+     * Check if adaptive bandwidth is enabled.
+     */
+    fun isAdaptiveBandwidthEnabled(): Boolean = _settings.value.adaptiveBandwidth
+
+    /**
+     * Get frame memory budget in megabytes.
+     */
+    fun getFrameMemoryBudgetMb(): Int = _settings.value.frameMemoryBudgetMb
+
+    /**
+     * Check if pipeline thread placement is enabled.
+     */
+    fun isThreadPlacementEnabled(): Boolean = _settings.value.threadPlacement
+
+    /**
+     * Check if relay mode is enabled.
+     */
+    fun isRelayModeEnabled(): Boolean = _settings.value.relayMode
+
+    /**
+     * Get the NDI transport setting.
+     */
+    fun getTransport(): TransportSetting = _settings.value.transport
+
     /**
      * Get last connected source name.
      */
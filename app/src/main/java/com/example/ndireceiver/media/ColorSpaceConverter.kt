@@ -2,6 +2,7 @@ package com.example.ndireceiver.media
 
 import android.util.Log
 import com.example.ndireceiver.ndi.FourCC
+import com.example.ndireceiver.ndi.NdiNative
 import java.nio.ByteBuffer
 import kotlin.math.abs
 
@@ -9,6 +10,22 @@ class ColorSpaceConverter {
     companion object {
         private const val TAG = "ColorSpaceConverter"
 
+        /**
+         * FourCCs that [convert] can turn into NV12.
+         */
+        fun isSupported(fourCC: FourCC): Boolean = when (fourCC) {
+            FourCC.UYVY, FourCC.UYVA,
+            FourCC.BGRA, FourCC.BGRX, FourCC.RGBA, FourCC.RGBX,
+            FourCC.NV12, FourCC.I420, FourCC.YV12,
+            FourCC.P216, FourCC.PA16 -> true
+            else -> false
+        }
+
+        /**
+         * FourCCs that [convertToP010] can turn into P010 without losing precision.
+         */
+        fun isHighBitDepth(fourCC: FourCC): Boolean = fourCC == FourCC.P216 || fourCC == FourCC.PA16
+
         fun convert(
             data: ByteBuffer,
             fourCC: FourCC,
@@ -18,8 +35,15 @@ class ColorSpaceConverter {
         ): ByteArray? {
             val src = data.duplicate()
             return when (fourCC) {
-                FourCC.UYVY -> uyvyToNv12(src, width, height, lineStrideBytes)
-                FourCC.BGRA, FourCC.BGRX -> bgraOrBgrxToNv12(src, width, height, lineStrideBytes)
+                // UYVA's alpha plane follows the packed plane and is not needed for NV12.
+                FourCC.UYVY, FourCC.UYVA -> uyvyToNv12(src, width, height, lineStrideBytes)
+                FourCC.BGRA, FourCC.BGRX -> packed32ToNv12(src, width, height, lineStrideBytes, rIndex = 2, bIndex = 0)
+                FourCC.RGBA, FourCC.RGBX -> packed32ToNv12(src, width, height, lineStrideBytes, rIndex = 0, bIndex = 2)
+                FourCC.NV12, FourCC.I420, FourCC.YV12 -> yuv420ToNv12(src, fourCC, width, height, lineStrideBytes)
+                // PA16's alpha plane follows the UV plane and is ignored, as for UYVA.
+                FourCC.P216, FourCC.PA16 -> p216Convert(
+                    data, width, height, lineStrideBytes, NdiNative.P216Target.NV12_DITHERED, width * (height + (height + 1) / 2)
+                )
                 else -> {
                     Log.w(TAG, "Unsupported FourCC for conversion: $fourCC")
                     null
@@ -27,6 +51,51 @@ class ColorSpaceConverter {
             }
         }
 
+        /**
+         * Converts a high bit depth frame (see [isHighBitDepth]) to P010 for a 10-bit encoder.
+         */
+        fun convertToP010(
+            data: ByteBuffer,
+            fourCC: FourCC,
+            width: Int,
+            height: Int,
+            lineStrideBytes: Int
+        ): ByteArray? {
+            if (!isHighBitDepth(fourCC)) {
+                Log.w(TAG, "Unsupported FourCC for P010 conversion: $fourCC")
+                return null
+            }
+            return p216Convert(
+                data, width, height, lineStrideBytes, NdiNative.P216Target.P010, width * 2 * (height + (height + 1) / 2)
+            )
+        }
+
+        /**
+         * Runs the native P216 kernels. They read from the buffer's base address, so [input] must be the
+         * direct buffer handed out by the receiver, with a positive stride.
+         */
+        private fun p216Convert(
+            input: ByteBuffer,
+            width: Int,
+            height: Int,
+            lineStrideBytes: Int,
+            target: Int,
+            outputSize: Int
+        ): ByteArray? {
+            if (width <= 0 || height <= 0 || width % 2 != 0) {
+                Log.w(TAG, "Invalid dimensions for P216 conversion: ${width}x$height")
+                return null
+            }
+            if (!input.isDirect || lineStrideBytes < 0) {
+                Log.w(TAG, "P216 conversion needs a direct, top-down buffer (stride=$lineStrideBytes)")
+                return null
+            }
+
+            val strideBytes = normalizeStride(lineStrideBytes, width * 2)
+            val output = ByteArray(outputSize)
+            return if (NdiNative.convertP216(input, width, height, strideBytes, output, target)) output else null
+        }
+
         private fun uyvyToNv12(input: ByteBuffer, width: Int, height: Int, lineStrideBytes: Int): ByteArray? {
             if (width <= 0 || height <= 0) {
                 Log.w(TAG, "Invalid dimensions for UYVY conversion: ${width}x$height")
@@ -86,9 +155,19 @@ class ColorSpaceConverter {
             return nv12
         }
 
-        private fun bgraOrBgrxToNv12(input: ByteBuffer, width: Int, height: Int, lineStrideBytes: Int): ByteArray? {
+        /**
+         * Converts 32-bit packed RGB (BGRA/BGRX or RGBA/RGBX, selected by the R/B byte indices) to NV12.
+         */
+        private fun packed32ToNv12(
+            input: ByteBuffer,
+            width: Int,
+            height: Int,
+            lineStrideBytes: Int,
+            rIndex: Int,
+            bIndex: Int
+        ): ByteArray? {
             if (width <= 0 || height <= 0) {
-                Log.w(TAG, "Invalid dimensions for BGRA/BGRX conversion: ${width}x$height")
+                Log.w(TAG, "Invalid dimensions for 32-bit RGB conversion: ${width}x$height")
                 return null
             }
 
@@ -97,7 +176,7 @@ class ColorSpaceConverter {
             val absStride = abs(strideBytes)
 
             if (!validateSizes(input.remaining(), absStride, height, rowBytes)) {
-                Log.w(TAG, "BGRA/BGRX conversion failed due to invalid buffer/stride (stride=$lineStrideBytes)")
+                Log.w(TAG, "32-bit RGB conversion failed due to invalid buffer/stride (stride=$lineStrideBytes)")
                 return null
             }
 
@@ -121,9 +200,9 @@ class ColorSpaceConverter {
 
                 for (col in 0 until width) {
                     val index = col * 4
-                    val b = scratch[index].toInt() and 0xFF
+                    val r = scratch[index + rIndex].toInt() and 0xFF
                     val g = scratch[index + 1].toInt() and 0xFF
-                    val r = scratch[index + 2].toInt() and 0xFF
+                    val b = scratch[index + bIndex].toInt() and 0xFF
 
                     val y = ((66 * r + 129 * g + 25 * b + 128) shr 8) + 16
                     val u = ((-38 * r - 74 * g + 112 * b + 128) shr 8) + 128
@@ -142,6 +221,81 @@ class ColorSpaceConverter {
             return nv12
         }
 
+        /**
+         * Repacks 4:2:0 YUV into tightly packed NV12. NV12 input is only compacted (no conversion);
+         * I420 (U then V) and YV12 (V then U) planes with half the luma stride are interleaved.
+         */
+        private fun yuv420ToNv12(
+            input: ByteBuffer,
+            fourCC: FourCC,
+            width: Int,
+            height: Int,
+            lineStrideBytes: Int
+        ): ByteArray? {
+            if (width <= 0 || height <= 0) {
+                Log.w(TAG, "Invalid dimensions for ${fourCC.name} conversion: ${width}x$height")
+                return null
+            }
+
+            val isNv12 = fourCC == FourCC.NV12
+            val lumaStride = abs(normalizeStride(lineStrideBytes, width))
+            val chromaWidth = (width + 1) / 2
+            val chromaHeight = (height + 1) / 2
+            val chromaStride = if (isNv12) lumaStride else lumaStride / 2
+            val chromaRowBytes = if (isNv12) chromaWidth * 2 else chromaWidth
+            if (chromaStride < chromaRowBytes) {
+                Log.w(TAG, "Invalid chroma stride ($chromaStride) for ${fourCC.name} width $width")
+                return null
+            }
+
+            val lumaSize = lumaStride * height
+            val chromaPlaneSize = chromaStride * chromaHeight
+            val required = lumaSize.toLong() + chromaPlaneSize.toLong() * (if (isNv12) 1 else 2)
+            if (input.remaining() < required) {
+                Log.w(TAG, "Source buffer too small: remaining=${input.remaining()} required=$required")
+                return null
+            }
+
+            // NV12 output is sized for even dimensions, matching the other converters.
+            val nv12 = ByteArray(width * height * 3 / 2)
+            val uvOffset = width * height
+            val basePos = input.position()
+
+            for (row in 0 until height) {
+                input.position(basePos + row * lumaStride)
+                input.get(nv12, row * width, width)
+            }
+
+            val uvRows = height / 2
+            val uvRowBytes = (width / 2) * 2
+            if (isNv12) {
+                for (row in 0 until uvRows) {
+                    input.position(basePos + lumaSize + row * chromaStride)
+                    input.get(nv12, uvOffset + row * width, uvRowBytes)
+                }
+            } else {
+                val uPlane = basePos + lumaSize + (if (fourCC == FourCC.YV12) chromaPlaneSize else 0)
+                val vPlane = basePos + lumaSize + (if (fourCC == FourCC.YV12) 0 else chromaPlaneSize)
+                val uRow = ByteArray(chromaRowBytes)
+                val vRow = ByteArray(chromaRowBytes)
+                for (row in 0 until uvRows) {
+                    input.position(uPlane + row * chromaStride)
+                    input.get(uRow, 0, chromaRowBytes)
+                    input.position(vPlane + row * chromaStride)
+                    input.get(vRow, 0, chromaRowBytes)
+
+                    var d = uvOffset + row * width
+                    for (x in 0 until width / 2) {
+                        nv12[d] = uRow[x]
+                        nv12[d + 1] = vRow[x]
+                        d += 2
+                    }
+                }
+            }
+
+            return nv12
+        }
+
         private fun normalizeStride(strideBytes: Int, minRowBytes: Int): Int {
             if (strideBytes == 0) return minRowBytes
             val absStride = abs(strideBytes)
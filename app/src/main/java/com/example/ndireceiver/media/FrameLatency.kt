@@ -0,0 +1,33 @@
+package com.example.ndireceiver.media
+
+import com.example.ndireceiver.ndi.NdiNative
+import com.example.ndireceiver.ndi.VideoFrameData
+
+/**
+ * Kotlin entry points to native glass-to-glass latency histograms.
+ *
+ * Frames carry the CLOCK_MONOTONIC time the SDK returned them ([VideoFrameData.captureNs]);
+ * each stage calls [mark] as the frame passes it and the native side records the elapsed time
+ * in that stage's histogram, so nothing per frame is kept here.
+ */
+object FrameLatency {
+    /**
+     * Record that the frame captured at [captureNs] reached [NdiNative.LatencyStage] [stage].
+     * Frames without a capture stamp (0) are ignored.
+     */
+    fun mark(stage: Int, captureNs: Long) {
+        if (captureNs != 0L) {
+            NdiNative.latencyMark(stage, captureNs)
+        }
+    }
+
+    /**
+     * Start a new measurement, e.g. when connecting to a source.
+     */
+    fun reset() = NdiNative.latencyReset()
+
+    /**
+     * Capture-to-stage percentiles since the last [reset].
+     */
+    fun getStats(): NdiNative.LatencyStats? = NdiNative.getLatencyStats()
+}
@@ -0,0 +1,66 @@
+package com.example.ndireceiver.media
+
+import com.example.ndireceiver.ndi.NdiNative
+import java.nio.ByteBuffer
+
+/**
+ * Kotlin entry points to the native frame memory arena.
+ *
+ * Frame copies that outlive the NDI frame they came from (recorder and decoder queues) live in
+ * arena buffers; memory the JVM or the graphics stack owns (Bitmaps, conversion arrays) is
+ * charged with [reserve]. Every request counts against one budget, and a null/false result is
+ * back-pressure: the caller drops or skips the frame instead of allocating more.
+ */
+object FrameMemory {
+    private const val BYTES_PER_MB = 1024L * 1024L
+
+    /**
+     * Set the budget shared by every consumer.
+     */
+    fun setBudgetMb(budgetMb: Int) {
+        NdiNative.arenaSetBudget(budgetMb * BYTES_PER_MB)
+    }
+
+    /**
+     * Current and peak usage, globally and per [NdiNative.ArenaConsumer].
+     */
+    fun getStats(): NdiNative.ArenaStats? = NdiNative.arenaGetStats()
+
+    /**
+     * Copy [src] (from position 0 to its limit) into an arena buffer charged to [consumer].
+     *
+     * @return a flipped buffer holding the copy, or null if the budget is exhausted; release it
+     *         with [release]
+     */
+    fun copyOf(consumer: Int, src: ByteBuffer): ByteBuffer? {
+        val view = src.duplicate()
+        view.rewind()
+        if (!view.hasRemaining()) return null
+        val copy = NdiNative.arenaAlloc(consumer, view.remaining()) ?: return null
+        copy.put(view)
+        copy.flip()
+        return copy
+    }
+
+    /**
+     * Return a buffer from [copyOf].
+     */
+    fun release(buffer: ByteBuffer) {
+        NdiNative.arenaFree(buffer)
+    }
+
+    /**
+     * Charge [bytes] allocated elsewhere to [consumer]. Returns false, charging nothing, when
+     * they do not fit the budget.
+     */
+    fun reserve(consumer: Int, bytes: Long): Boolean = NdiNative.arenaReserve(consumer, bytes)
+
+    /**
+     * Undo a [reserve].
+     */
+    fun unreserve(consumer: Int, bytes: Long) {
+        if (bytes > 0) {
+            NdiNative.arenaUnreserve(consumer, bytes)
+        }
+    }
+}
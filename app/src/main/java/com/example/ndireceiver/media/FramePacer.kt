@@ -0,0 +1,178 @@
+package com.example.ndireceiver.media
+
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.Process
+import android.util.Log
+import android.view.Choreographer
+import com.example.ndireceiver.ndi.NdiNative
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * Vsync-aligned presentation of queued frames, backed by the native frame pacer.
+ *
+ * Frames are submitted with their NDI timestamps from the receive thread. A dedicated thread
+ * with its own Choreographer asks the native pacer on every vsync which frame is due, so each
+ * frame is shown at the refresh closest to its due time and drops/repeats follow a fixed rule
+ * instead of arrival jitter.
+ *
+ * Every submitted id comes back exactly once through [Listener], except ids still queued when
+ * [release] is called.
+ */
+class FramePacer(
+    private val listener: Listener,
+    capacity: Int = DEFAULT_CAPACITY
+) : Choreographer.FrameCallback {
+    companion object {
+        private const val TAG = "FramePacer"
+        const val DEFAULT_CAPACITY = 2
+        private const val THREAD_JOIN_TIMEOUT_MS = 500L
+    }
+
+    interface Listener {
+        /** Called on the pacer thread when [frameId] is due. */
+        fun onPresentFrame(frameId: Int)
+
+        /** Called when [frameId] left the queue without being presented (any thread). */
+        fun onReleaseFrame(frameId: Int)
+    }
+
+    private val pacerPtr = AtomicLong(NdiNative.pacerCreate(capacity))
+    private val dropped = IntArray(capacity)
+
+    // Serializes every native call on pacerPtr with release(), so none runs on a destroyed pacer.
+    private val lock = Any()
+
+    private var thread: HandlerThread? = null
+
+    @Volatile
+    private var running = false
+
+    // Set once by release(); start() and submit() do nothing afterwards.
+    private var released = false
+
+    /** False if the native pacer could not be created; callers should present directly. */
+    val isAvailable: Boolean
+        get() = pacerPtr.get() != 0L
+
+    /**
+     * Start receiving vsync callbacks. Idempotent, and does nothing after [release].
+     */
+    fun start() {
+        synchronized(lock) {
+            if (running || released || !isAvailable) return
+            running = true
+
+            val pacerThread = HandlerThread("NDI-Frame-Pacer", Process.THREAD_PRIORITY_DISPLAY)
+            pacerThread.start()
+            thread = pacerThread
+            // Choreographer is per-Looper: obtain it on the pacer thread so callbacks arrive there.
+            Handler(pacerThread.looper).post {
+                ThreadPlacement.apply(NdiNative.ThreadRole.PACER)
+                Choreographer.getInstance().postFrameCallback(this)
+            }
+        }
+        Log.d(TAG, "Frame pacer started")
+    }
+
+    /**
+     * Queue a frame for presentation.
+     *
+     * @param timestamp NDI timestamp of the frame (100 ns units)
+     * @param durationNs nominal frame duration (0 if unknown)
+     * @return false if the pacer is not available or released; the frame was not queued
+     */
+    fun submit(frameId: Int, timestamp: Long, durationNs: Long): Boolean {
+        val returned = synchronized(lock) {
+            val ptr = pacerPtr.get()
+            if (released || ptr == 0L) return false
+            NdiNative.pacerEnqueue(ptr, frameId, timestamp, durationNs, System.nanoTime())
+        }
+        if (returned >= 0) {
+            listener.onReleaseFrame(returned)
+        }
+        return true
+    }
+
+    /**
+     * Set the arrival-to-presentation delay that absorbs network jitter.
+     */
+    fun setDelayNs(delayNs: Long) {
+        synchronized(lock) {
+            val ptr = pacerPtr.get()
+            if (ptr != 0L) {
+                NdiNative.pacerSetDelay(ptr, delayNs)
+            }
+        }
+    }
+
+    override fun doFrame(frameTimeNanos: Long) {
+        // Listeners are called outside the lock, so a slow draw never holds up submit().
+        val present = synchronized(lock) {
+            val ptr = pacerPtr.get()
+            if (!running || ptr == 0L) return
+            // The refresh period is measured natively from successive frame times.
+            NdiNative.pacerOnVsync(ptr, frameTimeNanos, 0L, dropped)
+        }
+        for (id in dropped) {
+            if (id < 0) break
+            listener.onReleaseFrame(id)
+        }
+        if (present >= 0) {
+            listener.onPresentFrame(present)
+        }
+        if (running) {
+            Choreographer.getInstance().postFrameCallback(this)
+        }
+    }
+
+    /**
+     * Get presentation counters and the present-time error histogram.
+     */
+    fun getStats(): NdiNative.PacerStats? {
+        synchronized(lock) {
+            val ptr = pacerPtr.get()
+            if (ptr == 0L) return null
+            return NdiNative.pacerGetStats(ptr)
+        }
+    }
+
+    /**
+     * Stop the pacer thread and destroy the native pacer. Safe to call while another thread is in
+     * [submit]; that call either queues before the pacer goes or returns false.
+     */
+    fun release() {
+        val pacerThread = synchronized(lock) {
+            if (released) return
+            released = true
+            running = false
+            thread.also { thread = null }
+        }
+
+        if (pacerThread == null) {
+            destroyNative()
+            return
+        }
+        // Runs on the pacer thread after any vsync callback it is in, so the native pacer is
+        // destroyed there even if the join below times out.
+        Handler(pacerThread.looper).post {
+            ThreadPlacement.release()
+            destroyNative()
+        }
+        pacerThread.quitSafely()
+        try {
+            pacerThread.join(THREAD_JOIN_TIMEOUT_MS)
+        } catch (e: InterruptedException) {
+            Log.w(TAG, "Interrupted while waiting for pacer thread")
+        }
+    }
+
+    private fun destroyNative() {
+        synchronized(lock) {
+            val ptr = pacerPtr.getAndSet(0)
+            if (ptr != 0L) {
+                NdiNative.pacerDestroy(ptr)
+            }
+        }
+    }
+}
@@ -0,0 +1,186 @@
+package com.example.ndireceiver.media
+
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.Process
+import android.util.Log
+import android.view.Choreographer
+import android.view.Surface
+import com.example.ndireceiver.ndi.NdiNative
+import com.example.ndireceiver.ndi.VideoFrameData
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * Shows several sources as one grid (2x2, 3x3, ...) on a single Surface.
+ *
+ * Frames are scaled natively into their source's tile of one canvas as they are submitted
+ * (typically from [com.example.ndireceiver.ndi.NdiMultiReceiver.Callback.onVideoFrame]), and a
+ * dedicated thread with its own Choreographer copies only the tiles that changed to the
+ * Surface once per vsync. No Bitmap or Canvas is involved. Tiles are small, so receiving the
+ * sources that are not focused at [NdiNative.Bandwidth.LOWEST] loses little.
+ *
+ * Only uncompressed frames (UYVY, BGRA, RGBA and their variants) can be shown.
+ */
+class MultiviewRenderer(
+    val width: Int,
+    val height: Int,
+    val columns: Int,
+    val rows: Int
+) : Choreographer.FrameCallback {
+    companion object {
+        private const val TAG = "MultiviewRenderer"
+        private const val THREAD_JOIN_TIMEOUT_MS = 500L
+
+        /** Most tiles one renderer can show. */
+        const val MAX_TILES = 16
+
+        /**
+         * Smallest near-square grid for [count] sources: (columns, rows).
+         */
+        fun gridFor(count: Int): Pair<Int, Int> {
+            var columns = 1
+            while (columns * columns < count && columns < 4) {
+                columns++
+            }
+            val rows = ((count + columns - 1) / columns).coerceIn(1, columns)
+            return Pair(columns, rows)
+        }
+    }
+
+    private val multiviewPtr = AtomicLong(NdiNative.multiviewCreate(width, height, columns, rows))
+
+    private var thread: HandlerThread? = null
+
+    @Volatile
+    private var running = false
+
+    // Source name to tile index; replaced whole, never mutated.
+    @Volatile
+    private var tiles: Map<String, Int> = emptyMap()
+
+    /** False if the native compositor could not be created. */
+    val isAvailable: Boolean
+        get() = multiviewPtr.get() != 0L
+
+    /**
+     * Start presenting on every vsync. Idempotent.
+     */
+    fun start() {
+        if (running || !isAvailable) return
+        running = true
+
+        val renderThread = HandlerThread("NDI-Multiview", Process.THREAD_PRIORITY_DISPLAY)
+        renderThread.start()
+        thread = renderThread
+        // Choreographer is per-Looper: obtain it on the render thread so callbacks arrive there.
+        Handler(renderThread.looper).post {
+            ThreadPlacement.apply(NdiNative.ThreadRole.PACER)
+            Choreographer.getInstance().postFrameCallback(this)
+        }
+        Log.d(TAG, "Multiview renderer started (${columns}x$rows tiles, ${width}x$height)")
+    }
+
+    /**
+     * Present to [surface], or stop presenting with null (e.g. from surfaceDestroyed).
+     */
+    fun setSurface(surface: Surface?): Boolean {
+        val ptr = multiviewPtr.get()
+        if (ptr == 0L) return false
+        return NdiNative.multiviewSetSurface(ptr, surface)
+    }
+
+    /**
+     * Assign sources to tiles in order, left to right and top to bottom. Tiles whose source
+     * changed are cleared; sources past the last tile are not shown.
+     */
+    fun setSources(sourceNames: List<String>) {
+        val ptr = multiviewPtr.get()
+        if (ptr == 0L) return
+        val previous = tiles
+        val assigned = sourceNames.take(columns * rows).withIndex().associate { (index, name) -> name to index }
+        tiles = assigned
+        for (tile in 0 until columns * rows) {
+            val before = previous.entries.firstOrNull { it.value == tile }?.key
+            val after = sourceNames.getOrNull(tile)
+            if (before != null && before != after) {
+                NdiNative.multiviewClearTile(ptr, tile)
+            }
+        }
+    }
+
+    /**
+     * Scale a source's frame into its tile. The frame's buffer is only read during the call.
+     *
+     * @return false if the source has no tile or the frame cannot be shown
+     */
+    fun submit(sourceName: String, frame: VideoFrameData): Boolean {
+        val ptr = multiviewPtr.get()
+        if (ptr == 0L || frame.isCompressed) return false
+        val tile = tiles[sourceName] ?: return false
+        return NdiNative.multiviewSubmit(
+            ptr, tile, frame.data, frame.lineStrideBytes, frame.width, frame.height, frame.fourCC.toInt()
+        )
+    }
+
+    /**
+     * Blank a source's tile (e.g. its connection was lost).
+     */
+    fun clear(sourceName: String) {
+        val ptr = multiviewPtr.get()
+        if (ptr == 0L) return
+        val tile = tiles[sourceName] ?: return
+        NdiNative.multiviewClearTile(ptr, tile)
+    }
+
+    override fun doFrame(frameTimeNanos: Long) {
+        if (!running) return
+        val ptr = multiviewPtr.get()
+        if (ptr != 0L) {
+            NdiNative.multiviewPresent(ptr)
+        }
+        Choreographer.getInstance().postFrameCallback(this)
+    }
+
+    /**
+     * Get presentation counters.
+     */
+    fun getStats(): NdiNative.MultiviewStats? {
+        val ptr = multiviewPtr.get()
+        if (ptr == 0L) return null
+        return NdiNative.multiviewGetStats(ptr)
+    }
+
+    /**
+     * Get the freshness and compose cost of a source's tile, or null if it has none.
+     */
+    fun getTileStats(sourceName: String): NdiNative.MultiviewTileStats? {
+        val ptr = multiviewPtr.get()
+        if (ptr == 0L) return null
+        val tile = tiles[sourceName] ?: return null
+        return NdiNative.multiviewGetTileStats(ptr, tile)
+    }
+
+    /**
+     * Stop the render thread and destroy the compositor. Must not be called concurrently with
+     * [submit].
+     */
+    fun release() {
+        running = false
+        thread?.let {
+            // Runs before the looper quits, on the render thread itself.
+            Handler(it.looper).post { ThreadPlacement.release() }
+            it.quitSafely()
+            try {
+                it.join(THREAD_JOIN_TIMEOUT_MS)
+            } catch (e: InterruptedException) {
+                Log.w(TAG, "Interrupted while waiting for multiview thread")
+            }
+        }
+        thread = null
+
+        val ptr = multiviewPtr.getAndSet(0)
+        if (ptr != 0L) {
+            NdiNative.multiviewDestroy(ptr)
+        }
+    }
+}
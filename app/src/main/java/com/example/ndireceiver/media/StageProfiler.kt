@@ -0,0 +1,28 @@
+package com.example.ndireceiver.media
+
+import com.example.ndireceiver.ndi.NdiNative
+
+/**
+ * Kotlin entry points to native per-stage CPU and wall-time accounting.
+ *
+ * Stages time themselves with [measure]; the native profiler keeps rolling windows, so
+ * [getStats] can be polled at any rate (the OSD does it once a second) without history here.
+ */
+object StageProfiler {
+    /**
+     * Run [block] on the calling thread as one execution of [NdiNative.PipelineStage] [stage].
+     */
+    inline fun <T> measure(stage: Int, block: () -> T): T {
+        NdiNative.stageBegin(stage)
+        try {
+            return block()
+        } finally {
+            NdiNative.stageEnd(stage)
+        }
+    }
+
+    /**
+     * Stage timing over the rolling window and per-thread CPU since the previous call.
+     */
+    fun getStats(): NdiNative.StageStats? = NdiNative.getStageStats()
+}
@@ -0,0 +1,55 @@
+package com.example.ndireceiver.media
+
+import android.util.Log
+import com.example.ndireceiver.ndi.NdiNative
+
+/**
+ * Kotlin entry points to native pipeline thread placement.
+ *
+ * Each pipeline thread calls [apply] (or wraps its loop in [placed]) with its
+ * [NdiNative.ThreadRole]; the native side pins it to the cores the core map assigns that role
+ * and sets its nice value. On big.LITTLE devices this keeps latency-critical stages off the
+ * little cores, where the scheduler otherwise tends to park default-priority threads.
+ */
+object ThreadPlacement {
+    private const val TAG = "ThreadPlacement"
+
+    /**
+     * Enable or disable placement. [coreMap] overrides the default per-role policy; see
+     * [NdiNative.threadPlacementConfigure] for the syntax.
+     */
+    fun configure(enabled: Boolean, coreMap: String? = null) {
+        if (!NdiNative.threadPlacementConfigure(enabled, coreMap)) {
+            Log.w(TAG, "Thread placement not applied (core map: $coreMap)")
+        }
+    }
+
+    /**
+     * Place the calling thread. Returns 0, or the errno of the call that failed.
+     */
+    fun apply(role: Int): Int = NdiNative.threadPlacementApply(role)
+
+    /**
+     * Stop tracking the calling thread.
+     */
+    fun release() {
+        NdiNative.threadPlacementRelease()
+    }
+
+    /**
+     * Run [block] on the calling thread placed as [role], releasing the placement afterwards.
+     */
+    inline fun <T> placed(role: Int, block: () -> T): T {
+        apply(role)
+        try {
+            return block()
+        } finally {
+            release()
+        }
+    }
+
+    /**
+     * Sample placement of every pipeline thread.
+     */
+    fun getStats(): NdiNative.ThreadPlacementStats? = NdiNative.threadPlacementGetStats()
+}
@@ -2,9 +2,11 @@ package com.example.ndireceiver.media
 
 import android.media.MediaCodec
 import android.media.MediaCodecInfo
+import android.media.MediaCodecList
 import android.media.MediaFormat
 import android.media.MediaMuxer
 import android.util.Log
+import com.example.ndireceiver.ndi.NdiNative
 import java.io.File
 import java.nio.ByteBuffer
 
@@ -15,9 +17,57 @@ data class VideoFormatConfig(
     val colorFormat: Int,
     val bitRate: Int,
     val frameRate: Int,
-    val iFrameIntervalSeconds: Int
+    val iFrameIntervalSeconds: Int,
+    val profile: Int? = null
 )
 
+/**
+ * Codec, input layout and profile used to encode uncompressed frames.
+ *
+ * @property inputBytesPerSample 1 for 8-bit NV12 input, 2 for 16-bit P010 input
+ */
+enum class EncoderProfile(
+    val mimeType: String,
+    val colorFormat: Int,
+    val codecProfile: Int?,
+    val inputBytesPerSample: Int,
+    val label: String
+) {
+    H264_8BIT(
+        MediaFormat.MIMETYPE_VIDEO_AVC,
+        MediaCodecInfo.CodecCapabilities.COLOR_FormatYUV420SemiPlanar, // NV12
+        null,
+        1,
+        "H264"
+    ),
+    HEVC_MAIN10(
+        MediaFormat.MIMETYPE_VIDEO_HEVC,
+        MediaCodecInfo.CodecCapabilities.COLOR_FormatYUVP010,
+        MediaCodecInfo.CodecProfileLevel.HEVCProfileMain10,
+        2,
+        "H265Main10"
+    );
+
+    val isTenBit: Boolean
+        get() = inputBytesPerSample == 2
+
+    /**
+     * Whether an encoder on this device accepts [colorFormat] and [codecProfile] for [mimeType].
+     */
+    fun isSupported(): Boolean = try {
+        MediaCodecList(MediaCodecList.REGULAR_CODECS).codecInfos.any { info ->
+            info.isEncoder && info.supportedTypes.any { it.equals(mimeType, ignoreCase = true) } &&
+                info.getCapabilitiesForType(mimeType).let { caps ->
+                    colorFormat in caps.colorFormats &&
+                        (codecProfile == null || caps.profileLevels.any { it.profile == codecProfile })
+                }
+        }
+    } catch (e: Exception) {
+        Log.w("EncoderProfile", "Codec capability query failed for $name", e)
+        false
+    }
+}
+
 interface EncoderCodec {
     fun configure(config: VideoFormatConfig)
     fun start()
@@ -55,6 +105,7 @@ private class AndroidEncoderCodec(private val codec: MediaCodec) : EncoderCodec
             setInteger(MediaFormat.KEY_BIT_RATE, config.bitRate)
             setInteger(MediaFormat.KEY_FRAME_RATE, config.frameRate)
             setInteger(MediaFormat.KEY_I_FRAME_INTERVAL, config.iFrameIntervalSeconds)
+            config.profile?.let { setInteger(MediaFormat.KEY_PROFILE, it) }
         }
         codec.configure(format, null, null, MediaCodec.CONFIGURE_FLAG_ENCODE)
     }
@@ -98,12 +149,12 @@ class UncompressedVideoEncoder(
     height: Int,
     bitRate: Int,
     outputFile: File,
+    private val profile: EncoderProfile = EncoderProfile.H264_8BIT,
     private val codecFactory: EncoderCodecFactory = androidCodecFactory,
     private val muxerFactory: EncoderMuxerFactory = androidMuxerFactory
 ) : VideoEncoder {
 
     private val TAG = "UncompressedVideoEncoder"
-    private val MIME_TYPE = "video/avc" // H.264
     private val FRAME_RATE = 30
     private val I_FRAME_INTERVAL = 1 // seconds
     private val TIMEOUT_USEC = 10_000L
@@ -120,17 +171,18 @@ class UncompressedVideoEncoder(
     private val bufferInfo: MediaCodec.BufferInfo = MediaCodec.BufferInfo()
 
     init {
-        mediaCodec = codecFactory.createEncoderByType(MIME_TYPE)
+        mediaCodec = codecFactory.createEncoderByType(profile.mimeType)
         mediaMuxer = muxerFactory.create(outputFile.absolutePath, MediaMuxer.OutputFormat.MUXER_OUTPUT_MPEG_4)
 
         val config = VideoFormatConfig(
-            mimeType = MIME_TYPE,
+            mimeType = profile.mimeType,
             width = width,
             height = height,
-            colorFormat = MediaCodecInfo.CodecCapabilities.COLOR_FormatYUV420SemiPlanar, // NV12
+            colorFormat = profile.colorFormat,
             bitRate = bitRate,
             frameRate = FRAME_RATE,
-            iFrameIntervalSeconds = I_FRAME_INTERVAL
+            iFrameIntervalSeconds = I_FRAME_INTERVAL,
+            profile = profile.codecProfile
         )
 
         mediaCodec.configure(config)
@@ -221,7 +273,9 @@ class UncompressedVideoEncoder(
                         encodedData.position(bufferInfo.offset)
                         encodedData.limit(bufferInfo.offset + bufferInfo.size)
                         try {
-                            mediaMuxer.writeSampleData(trackIndex, encodedData, bufferInfo)
+                            StageProfiler.measure(NdiNative.PipelineStage.MUX) {
+                                mediaMuxer.writeSampleData(trackIndex, encodedData, bufferInfo)
+                            }
                         } catch (e: Exception) {
                             Log.e(TAG, "writeSampleData failed", e)
                         }
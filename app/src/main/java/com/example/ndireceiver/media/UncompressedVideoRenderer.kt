@@ -7,6 +7,7 @@ import android.util.Log
 import android.view.Surface
 import com.example.ndireceiver.ndi.FourCC
 import com.example.ndireceiver.ndi.NdiNative
+import com.example.ndireceiver.ndi.TimeToFirstFrame
 import com.example.ndireceiver.ndi.VideoFrameData
 import java.nio.ByteBuffer
 import kotlin.math.abs
@@ -14,32 +15,75 @@ import kotlin.math.max
 import kotlin.math.min
 
 /**
- * Renders uncompressed NDI video frames (BGRA/BGRX/RGBA/RGBX/UYVY) onto an Android Surface.
+ * Renders uncompressed NDI video frames (BGRA/BGRX/RGBA/RGBX/UYVY/UYVA/NV12/I420/YV12/P216/PA16)
+ * onto an Android Surface.
  *
  * Notes:
  * - NDI SDK v6 can deliver already-decoded (uncompressed) frames; these must NOT be sent to MediaCodec.
  * - The incoming frame ByteBuffer is backed by native memory and is only valid until the caller frees it.
  *   This renderer copies/converts the frame synchronously during [render].
  * - Bitmap.Config.ARGB_8888 with copyPixelsFromBuffer() expects RGBA byte order.
+ * - 16-bit P216/PA16 is dithered down to NV12 natively (the display is 8-bit) and drawn via the NV12 path.
+ * - UYVY/BGRA/BGRX/RGBA/RGBX are converted natively (NEON), and a frame larger than the surface (e.g. 4K
+ *   on a 1080p panel) is scaled down to exactly the surface size in the same pass, so neither the
+ *   conversion nor the Canvas touches pixels that cannot be shown. See [setSurfaceSize].
+ * - With pacing enabled, converted frames wait in bitmap slots and are drawn by [FramePacer] at the
+ *   vsync closest to their NDI timestamp; otherwise they are drawn immediately.
+ * - Conversion buffers and slot bitmaps are charged to the frame memory budget ([FrameMemory]);
+ *   a frame that would exceed it is skipped.
  */
-class UncompressedVideoRenderer {
+class UncompressedVideoRenderer(pacingEnabled: Boolean = true) : FramePacer.Listener {
     companion object {
         private const val TAG = "UncompressedVideoRenderer"
+        // One slot being written, one being drawn, the rest queued in the pacer.
+        private const val SLOT_COUNT = 4
     }
 
+    private class Slot {
+        var bitmap: Bitmap? = null
+        var busy = false
+        var reservedBytes = 0L
+        var captureNs = 0L
+    }
+
+    // Conversion buffers; held by the thread calling render().
     private val renderLock = Any()
+    // Surface and drawing; held by whichever thread presents.
+    private val drawLock = Any()
 
     @Volatile
     private var surface: Surface? = null
 
-    private var bitmap: Bitmap? = null
-    private var bitmapWidth = 0
-    private var bitmapHeight = 0
+    // Guarded by synchronized(slots). A busy slot belongs to the render thread, the pacer queue or a draw.
+    private val slots = Array(SLOT_COUNT) { Slot() }
+
+    // Read by render() under renderLock; release() detaches it there before releasing it.
+    @Volatile
+    private var pacer: FramePacer? = if (pacingEnabled) {
+        FramePacer(this, SLOT_COUNT - 2).takeIf { it.isAvailable }
+    } else null
+
+    private var bufferWidth = 0
+    private var bufferHeight = 0
+    // rgbaBuffer is a direct buffer written by the native scaler (and rgbaBytes is unused).
+    private var bufferDirect = false
+
+    // Native convert+scale handle; created on first use, 0 if that failed.
+    private var scalerPtr = 0L
+    private var scalerCreated = false
+
+    @Volatile
+    private var surfaceWidth = 0
+    @Volatile
+    private var surfaceHeight = 0
 
     // RGBA format for Bitmap.Config.ARGB_8888
     private var rgbaBytes: ByteArray? = null
     private var rgbaBuffer: ByteBuffer? = null
     private var rowScratch: ByteArray? = null
+    private var nv12Scratch: ByteArray? = null
+    // Frame memory budget charged for the buffers above.
+    private var reservedBufferBytes = 0L
 
     private val paint = Paint().apply {
         // Enable filtering for better scaling quality
@@ -51,103 +95,303 @@ class UncompressedVideoRenderer {
     private val dstRect = Rect()
 
     fun setSurface(surface: Surface?) {
-        synchronized(renderLock) {
+        synchronized(drawLock) {
             this.surface = surface
         }
     }
 
+    /**
+     * Size of the surface in pixels (from SurfaceHolder.Callback.surfaceChanged). Frames larger
+     * than this are scaled down to it natively; until it is known the size of the last drawn
+     * canvas is used.
+     */
+    fun setSurfaceSize(width: Int, height: Int) {
+        surfaceWidth = width
+        surfaceHeight = height
+    }
+
     fun release() {
+        // Detach the pacer first, so a render() in progress finishes with it and later ones
+        // present directly, then stop its vsync callbacks before the bitmaps are recycled.
+        val detached = synchronized(renderLock) {
+            pacer.also { pacer = null }
+        }
+        detached?.release()
         synchronized(renderLock) {
-            surface = null
-            bitmap?.recycle()
-            bitmap = null
-            bitmapWidth = 0
-            bitmapHeight = 0
-            rgbaBytes = null
-            rgbaBuffer = null
-            rowScratch = null
+            synchronized(drawLock) {
+                surface = null
+                synchronized(slots) {
+                    for (slot in slots) {
+                        slot.bitmap?.recycle()
+                        slot.bitmap = null
+                        slot.busy = false
+                        FrameMemory.unreserve(NdiNative.ArenaConsumer.RENDERER, slot.reservedBytes)
+                        slot.reservedBytes = 0
+                    }
+                }
+                releaseBuffers()
+            }
+            if (scalerPtr != 0L) {
+                NdiNative.scalerDestroy(scalerPtr)
+                scalerPtr = 0L
+            }
+            scalerCreated = false
         }
     }
 
+    /**
+     * Presentation statistics, or null when frames are drawn without pacing.
+     */
+    fun getPacerStats(): NdiNative.PacerStats? = pacer?.getStats()
+
     fun render(frame: VideoFrameData) {
         synchronized(renderLock) {
-            val currentSurface = surface ?: return
+            if (surface == null) return
             if (frame.width <= 0 || frame.height <= 0) return
+            FrameLatency.mark(NdiNative.LatencyStage.DEQUEUE, frame.captureNs)
 
-            ensureBuffers(frame.width, frame.height)
+            val nativeSize = nativeOutputSize(frame)
+            val outWidth = nativeSize?.first ?: frame.width
+            val outHeight = nativeSize?.second ?: frame.height
+            if (!ensureBuffers(outWidth, outHeight, direct = nativeSize != null)) return
 
-            val pixels = rgbaBytes ?: return
+            val pixels = rgbaBytes
             val bufferView = rgbaBuffer ?: return
 
             // All copy/convert functions output RGBA for Bitmap.Config.ARGB_8888
-            val ok = when (frame.fourCC) {
-                FourCC.BGRA -> copyBgraToRgba(frame, pixels, forceOpaque = false)
-                FourCC.BGRX -> copyBgraToRgba(frame, pixels, forceOpaque = true)
-                FourCC.RGBA -> copyRgba(frame, pixels, forceOpaque = false)
-                FourCC.RGBX -> copyRgba(frame, pixels, forceOpaque = true)
-                FourCC.UYVY -> convertUyvyToRgba(frame, pixels)
-                else -> {
-                    Log.w(TAG, "Unsupported FourCC for uncompressed render: ${frame.fourCC.name}")
+            val ok = StageProfiler.measure(NdiNative.PipelineStage.CONVERT) {
+                if (nativeSize != null) {
+                    scaleNative(frame, bufferView, outWidth, outHeight)
+                } else if (pixels == null) {
                     false
+                } else when (frame.fourCC) {
+                    FourCC.BGRA -> copyBgraToRgba(frame, pixels, forceOpaque = false)
+                    FourCC.BGRX -> copyBgraToRgba(frame, pixels, forceOpaque = true)
+                    FourCC.RGBA -> copyRgba(frame, pixels, forceOpaque = false)
+                    FourCC.RGBX -> copyRgba(frame, pixels, forceOpaque = true)
+                    FourCC.UYVY -> convertUyvyToRgba(frame, pixels, hasAlphaPlane = false)
+                    FourCC.UYVA -> convertUyvyToRgba(frame, pixels, hasAlphaPlane = true)
+                    FourCC.NV12, FourCC.I420, FourCC.YV12 -> convertYuv420ToRgba(frame, pixels)
+                    FourCC.P216, FourCC.PA16 -> convertP216ToRgba(frame, pixels)
+                    else -> {
+                        Log.w(TAG, "Unsupported FourCC for uncompressed render: ${frame.fourCC.name}")
+                        false
+                    }
                 }
             }
 
             if (!ok) return
 
-            val bmp = bitmap ?: return
+            // All slots busy means presentation is behind; the pacer would drop this frame anyway.
+            val slotIndex = acquireSlot() ?: return
+            val bmp = ensureSlotBitmap(slots[slotIndex], outWidth, outHeight)
+            if (bmp == null) {
+                onReleaseFrame(slotIndex)
+                return
+            }
             try {
                 bufferView.rewind()
                 bmp.copyPixelsFromBuffer(bufferView)
             } catch (e: Exception) {
                 Log.e(TAG, "Failed to copy pixels into Bitmap", e)
+                onReleaseFrame(slotIndex)
                 return
             }
 
-            val canvas = try {
-                currentSurface.lockCanvas(null)
-            } catch (e: Exception) {
-                Log.e(TAG, "Surface.lockCanvas failed", e)
-                return
+            synchronized(slots) { slots[slotIndex].captureNs = frame.captureNs }
+            FrameLatency.mark(NdiNative.LatencyStage.SUBMIT, frame.captureNs)
+
+            val activePacer = pacer
+            if (activePacer != null) {
+                activePacer.start()
+                if (activePacer.submit(slotIndex, frame.timestamp, frameDurationNs(frame))) return
             }
+            onPresentFrame(slotIndex)
+        }
+    }
 
-            // DEBUG: Investigate right edge pixel cutoff
-            Log.d(TAG, "Canvas: ${canvas.width}x${canvas.height}, Bitmap: ${bmp.width}x${bmp.height}")
-            Log.d(TAG, "srcRect: $srcRect, dstRect: $dstRect")
+    override fun onPresentFrame(frameId: Int) {
+        try {
+            synchronized(drawLock) {
+                val (bmp, captureNs) = synchronized(slots) { slots[frameId].let { it.bitmap to it.captureNs } }
+                if (bmp != null && !bmp.isRecycled) {
+                    StageProfiler.measure(NdiNative.PipelineStage.RENDER) { draw(bmp) }
+                    FrameLatency.mark(NdiNative.LatencyStage.PRESENT, captureNs)
+                    TimeToFirstFrame.mark(TimeToFirstFrame.Phase.FIRST_DISPLAY)
+                }
+            }
+        } finally {
+            onReleaseFrame(frameId)
+        }
+    }
+
+    override fun onReleaseFrame(frameId: Int) {
+        synchronized(slots) {
+            slots[frameId].busy = false
+        }
+    }
 
+    private fun draw(bmp: Bitmap) {
+        val currentSurface = surface ?: return
+        val canvas = try {
+            currentSurface.lockCanvas(null)
+        } catch (e: Exception) {
+            Log.e(TAG, "Surface.lockCanvas failed", e)
+            return
+        }
+
+        if (surfaceWidth <= 0 || surfaceHeight <= 0) {
+            setSurfaceSize(canvas.width, canvas.height)
+        }
+
+        // DEBUG: Investigate right edge pixel cutoff
+        Log.d(TAG, "Canvas: ${canvas.width}x${canvas.height}, Bitmap: ${bmp.width}x${bmp.height}")
+        Log.d(TAG, "srcRect: $srcRect, dstRect: $dstRect")
+
+        try {
+            // Explicitly map entire bitmap (e.g. 1920x1080) to canvas size
+            srcRect.set(0, 0, bmp.width, bmp.height)
+            dstRect.set(0, 0, canvas.width, canvas.height)
+            canvas.drawBitmap(bmp, srcRect, dstRect, paint)
+        } catch (e: Exception) {
+            Log.e(TAG, "Canvas draw failed", e)
+        } finally {
             try {
-                // Explicitly map entire bitmap (e.g. 1920x1080) to canvas size
-                srcRect.set(0, 0, bmp.width, bmp.height)
-                dstRect.set(0, 0, canvas.width, canvas.height)
-                canvas.drawBitmap(bmp, srcRect, dstRect, paint)
+                currentSurface.unlockCanvasAndPost(canvas)
             } catch (e: Exception) {
-                Log.e(TAG, "Canvas draw failed", e)
-            } finally {
-                try {
-                    currentSurface.unlockCanvasAndPost(canvas)
-                } catch (e: Exception) {
-                    Log.w(TAG, "Surface.unlockCanvasAndPost failed", e)
+                Log.w(TAG, "Surface.unlockCanvasAndPost failed", e)
+            }
+        }
+    }
+
+    private fun acquireSlot(): Int? {
+        synchronized(slots) {
+            for (i in slots.indices) {
+                if (!slots[i].busy) {
+                    slots[i].busy = true
+                    return i
                 }
             }
         }
+        return null
     }
 
-    private fun ensureBuffers(width: Int, height: Int) {
-        val existing = bitmap
-        if (existing != null && !existing.isRecycled && bitmapWidth == width && bitmapHeight == height) {
-            return
+    /**
+     * Slot bitmaps are resized lazily when acquired, so queued frames of the old size still draw.
+     * Returns null when the new bitmap does not fit the frame memory budget.
+     */
+    private fun ensureSlotBitmap(slot: Slot, width: Int, height: Int): Bitmap? {
+        val existing = slot.bitmap
+        if (existing != null && !existing.isRecycled && existing.width == width && existing.height == height) {
+            return existing
+        }
+        existing?.recycle()
+        FrameMemory.unreserve(NdiNative.ArenaConsumer.RENDERER, slot.reservedBytes)
+        slot.reservedBytes = 0
+        synchronized(slots) {
+            slot.bitmap = null
         }
 
-        bitmap?.recycle()
-        bitmap = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888).apply {
+        val bytes = width.toLong() * height * 4
+        if (!FrameMemory.reserve(NdiNative.ArenaConsumer.RENDERER, bytes)) return null
+        slot.reservedBytes = bytes
+        val bmp = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888).apply {
             setHasAlpha(true)
         }
-        bitmapWidth = width
-        bitmapHeight = height
+        synchronized(slots) {
+            slot.bitmap = bmp
+        }
+        return bmp
+    }
+
+    private fun frameDurationNs(frame: VideoFrameData): Long {
+        if (frame.frameRateN <= 0 || frame.frameRateD <= 0) return 0L
+        return 1_000_000_000L * frame.frameRateD / frame.frameRateN
+    }
+
+    /**
+     * Output size when the native scaler handles [frame]: the surface size if the frame is larger
+     * in either dimension, else the frame size. Null for formats and layouts it cannot read (UYVA
+     * stays on the Kotlin path, which applies its alpha plane).
+     */
+    private fun nativeOutputSize(frame: VideoFrameData): Pair<Int, Int>? {
+        val supported = when (frame.fourCC) {
+            FourCC.UYVY -> frame.width % 2 == 0
+            FourCC.BGRA, FourCC.BGRX, FourCC.RGBA, FourCC.RGBX -> true
+            else -> false
+        }
+        if (!supported || frame.lineStrideBytes < 0 || !frame.data.isDirect) return null
+
+        if (!scalerCreated) {
+            scalerCreated = true
+            scalerPtr = NdiNative.scalerCreate()
+        }
+        if (scalerPtr == 0L) return null
+
+        val width = surfaceWidth
+        val height = surfaceHeight
+        return if (width > 0 && height > 0 && (frame.width > width || frame.height > height)) {
+            Pair(width, height)
+        } else {
+            Pair(frame.width, frame.height)
+        }
+    }
+
+    /**
+     * Converts (and scales, area-filtered when shrinking) a frame into [dst] in one native pass.
+     */
+    private fun scaleNative(frame: VideoFrameData, dst: ByteBuffer, width: Int, height: Int): Boolean {
+        val bytesPerPixel = if (frame.fourCC == FourCC.UYVY) 2 else 4
+        val strideBytes = normalizeStride(frame.lineStrideBytes, frame.width * bytesPerPixel)
+        return NdiNative.scalerScale(
+            scalerPtr,
+            frame.data, strideBytes, frame.width, frame.height, frame.fourCC.toInt(),
+            dst, width * 4, width, height,
+            NdiNative.ScaleFilter.AUTO
+        )
+    }
+
+    /**
+     * Returns false when buffers for this size do not fit the frame memory budget. A direct buffer
+     * (for the native scaler) needs no conversion scratch.
+     */
+    private fun ensureBuffers(width: Int, height: Int, direct: Boolean): Boolean {
+        if (rgbaBuffer != null && bufferWidth == width && bufferHeight == height && bufferDirect == direct) {
+            return true
+        }
+
+        releaseBuffers()
+        val rgbaSize = width * height * 4
+        val scratchSize = if (direct) 0 else max(width * 4, width * 2)
+        val reserved = rgbaSize.toLong() + scratchSize
+        if (!FrameMemory.reserve(NdiNative.ArenaConsumer.RENDERER, reserved)) return false
+        reservedBufferBytes = reserved
+
+        bufferWidth = width
+        bufferHeight = height
+        bufferDirect = direct
+
+        if (direct) {
+            rgbaBuffer = ByteBuffer.allocateDirect(rgbaSize)
+        } else {
+            val bytes = ByteArray(rgbaSize)
+            rgbaBytes = bytes
+            rgbaBuffer = ByteBuffer.wrap(bytes)
+            rowScratch = ByteArray(scratchSize)
+        }
+        return true
+    }
 
-        val bytes = ByteArray(width * height * 4)
-        rgbaBytes = bytes
-        rgbaBuffer = ByteBuffer.wrap(bytes)
-        rowScratch = ByteArray(max(width * 4, width * 2))
+    private fun releaseBuffers() {
+        FrameMemory.unreserve(NdiNative.ArenaConsumer.RENDERER, reservedBufferBytes)
+        reservedBufferBytes = 0
+        bufferWidth = 0
+        bufferHeight = 0
+        bufferDirect = false
+        rgbaBytes = null
+        rgbaBuffer = null
+        rowScratch = null
+        nv12Scratch = null
     }
 
     /**
@@ -237,8 +481,9 @@ class UncompressedVideoRenderer {
 
     /**
      * Converts UYVY source to RGBA destination.
+     * UYVA frames carry an 8-bit alpha plane (width bytes per line) after the packed UYVY plane.
      */
-    private fun convertUyvyToRgba(frame: VideoFrameData, dstRgba: ByteArray): Boolean {
+    private fun convertUyvyToRgba(frame: VideoFrameData, dstRgba: ByteArray, hasAlphaPlane: Boolean): Boolean {
         val width = frame.width
         val height = frame.height
         val rowBytesSrc = width * 2
@@ -254,6 +499,12 @@ class UncompressedVideoRenderer {
 
         if (!validateSizes(src.remaining(), absStride, height, rowBytesSrc)) return false
 
+        val alphaPlaneOffset = absStride * height
+        if (hasAlphaPlane && src.remaining().toLong() < alphaPlaneOffset.toLong() + width.toLong() * height) {
+            Log.w(TAG, "UYVA buffer too small for alpha plane: remaining=${src.remaining()}")
+            return false
+        }
+
         var dstOffset = 0
         for (row in 0 until height) {
             val srcRowOffset = if (strideBytes >= 0) row * absStride else (height - 1 - row) * absStride
@@ -276,12 +527,134 @@ class UncompressedVideoRenderer {
                 d += 8
             }
 
+            if (hasAlphaPlane) {
+                val alphaRow = if (strideBytes >= 0) row else height - 1 - row
+                src.position(basePos + alphaPlaneOffset + alphaRow * width)
+                src.get(scratch, 0, width)
+                for (x in 0 until width) {
+                    dstRgba[dstOffset + x * 4 + 3] = scratch[x]
+                }
+            }
+
             dstOffset += rowBytesDst
         }
 
         return true
     }
 
+    /**
+     * Converts 16-bit 4:2:2 (P216, or PA16 with its alpha plane ignored) to RGBA by dithering it to
+     * NV12 in native code and reusing [convertYuv420ToRgba].
+     */
+    private fun convertP216ToRgba(frame: VideoFrameData, dstRgba: ByteArray): Boolean {
+        val width = frame.width
+        val height = frame.height
+        if (width % 2 != 0 || frame.lineStrideBytes < 0 || !frame.data.isDirect) {
+            Log.w(TAG, "Unsupported P216 layout: ${width}x$height stride=${frame.lineStrideBytes}")
+            return false
+        }
+
+        val nv12Size = width * (height + (height + 1) / 2)
+        // Sized with the other buffers: releaseBuffers() drops it whenever the frame size changes.
+        val nv12 = nv12Scratch ?: run {
+            if (!FrameMemory.reserve(NdiNative.ArenaConsumer.RENDERER, nv12Size.toLong())) return false
+            reservedBufferBytes += nv12Size
+            ByteArray(nv12Size).also { nv12Scratch = it }
+        }
+        val strideBytes = normalizeStride(frame.lineStrideBytes, width * 2)
+        if (!NdiNative.convertP216(frame.data, width, height, strideBytes, nv12, NdiNative.P216Target.NV12_DITHERED)) {
+            return false
+        }
+
+        val nv12Frame = frame.copy(data = ByteBuffer.wrap(nv12), lineStrideBytes = width, fourCC = FourCC.NV12)
+        return convertYuv420ToRgba(nv12Frame, dstRgba)
+    }
+
+    /**
+     * Converts 4:2:0 YUV (NV12/I420/YV12) source to RGBA destination.
+     * Chroma follows the luma plane: NV12 has one interleaved UV plane with the luma stride,
+     * I420 (U then V) and YV12 (V then U) have two planes with half the luma stride.
+     */
+    private fun convertYuv420ToRgba(frame: VideoFrameData, dstRgba: ByteArray): Boolean {
+        val width = frame.width
+        val height = frame.height
+        val isNv12 = frame.fourCC == FourCC.NV12
+        // Planar chroma cannot be addressed bottom-up, so only the stride magnitude is used.
+        val lumaStride = abs(normalizeStride(frame.lineStrideBytes, width))
+        val chromaWidth = (width + 1) / 2
+        val chromaHeight = (height + 1) / 2
+        val chromaStride = if (isNv12) lumaStride else lumaStride / 2
+        val chromaRowBytes = if (isNv12) chromaWidth * 2 else chromaWidth
+        if (chromaStride < chromaRowBytes) {
+            Log.w(TAG, "Invalid chroma stride ($chromaStride) for ${frame.fourCC.name} width $width")
+            return false
+        }
+
+        val scratch = rowScratch ?: return false
+        // Luma row, then one interleaved or two planar chroma rows.
+        if (scratch.size < width + chromaRowBytes * 2) return false
+
+        val src = frame.data.duplicate()
+        val basePos = src.position()
+
+        val lumaSize = lumaStride * height
+        val chromaPlaneSize = chromaStride * chromaHeight
+        val chromaPlanes = if (isNv12) 1 else 2
+        val needed = lumaSize.toLong() + chromaPlaneSize.toLong() * chromaPlanes
+        if (src.remaining() < needed) {
+            Log.w(TAG, "Source buffer too small: remaining=${src.remaining()} needed=$needed (${frame.fourCC.name})")
+            return false
+        }
+
+        // Offsets of the U and V planes (I420/YV12) relative to the chroma start.
+        val uPlane = if (frame.fourCC == FourCC.YV12) chromaPlaneSize else 0
+        val vPlane = if (frame.fourCC == FourCC.YV12) 0 else chromaPlaneSize
+
+        val uOffset = width
+        val vOffset = width + chromaRowBytes
+        var loadedChromaRow = -1
+        var dstOffset = 0
+        for (row in 0 until height) {
+            src.position(basePos + row * lumaStride)
+            src.get(scratch, 0, width)
+
+            val chromaRow = row / 2
+            if (chromaRow != loadedChromaRow) {
+                val chromaBase = basePos + lumaSize + chromaRow * chromaStride
+                if (isNv12) {
+                    src.position(chromaBase)
+                    src.get(scratch, uOffset, chromaRowBytes)
+                } else {
+                    src.position(chromaBase + uPlane)
+                    src.get(scratch, uOffset, chromaRowBytes)
+                    src.position(chromaBase + vPlane)
+                    src.get(scratch, vOffset, chromaRowBytes)
+                }
+                loadedChromaRow = chromaRow
+            }
+
+            var d = dstOffset
+            for (x in 0 until width) {
+                val y = scratch[x].toInt() and 0xFF
+                val u: Int
+                val v: Int
+                if (isNv12) {
+                    u = scratch[uOffset + (x and 1.inv())].toInt() and 0xFF
+                    v = scratch[uOffset + (x and 1.inv()) + 1].toInt() and 0xFF
+                } else {
+                    u = scratch[uOffset + (x shr 1)].toInt() and 0xFF
+                    v = scratch[vOffset + (x shr 1)].toInt() and 0xFF
+                }
+                writeYuvToRgba(dstRgba, d, y, u, v)
+                d += 4
+            }
+
+            dstOffset += width * 4
+        }
+
+        return true
+    }
+
     /**
      * Converts a single YUV pixel to RGBA and writes it to the destination array.
      * Uses BT.601 limited-range conversion.
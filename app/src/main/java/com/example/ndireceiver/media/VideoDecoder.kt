@@ -5,6 +5,8 @@ import android.media.MediaCodecInfo
 import android.media.MediaFormat
 import android.util.Log
 import android.view.Surface
+import com.example.ndireceiver.ndi.NdiNative
+import com.example.ndireceiver.ndi.TimeToFirstFrame
 import com.example.ndireceiver.ndi.VideoFrameData
 import java.nio.ByteBuffer
 import java.util.concurrent.LinkedBlockingQueue
@@ -19,6 +21,7 @@ class VideoDecoder {
         private const val TAG = "VideoDecoder"
         private const val TIMEOUT_US = 10000L
         private const val MAX_QUEUE_SIZE = 5
+        private const val MAX_PENDING_STAMPS = 32
 
         // MIME types
         const val MIME_H264 = "video/avc"
@@ -35,6 +38,13 @@ class VideoDecoder {
 
     private val frameQueue = LinkedBlockingQueue<VideoFrameData>(MAX_QUEUE_SIZE)
 
+    // Capture stamps of frames inside MediaCodec by presentation time, for latency on output.
+    // Bounded: frames the codec drops never come out.
+    private val captureStamps = object : LinkedHashMap<Long, Long>() {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<Long, Long>?): Boolean =
+            size > MAX_PENDING_STAMPS
+    }
+
     private var currentWidth = 0
     private var currentHeight = 0
     private var currentMimeType = MIME_H265
@@ -101,11 +111,11 @@ class VideoDecoder {
         isRunning = true
 
         inputThread = Thread({
-            processInputBuffers()
+            ThreadPlacement.placed(NdiNative.ThreadRole.DECODER_INPUT) { processInputBuffers() }
         }, "Decoder-Input").apply { start() }
 
         outputThread = Thread({
-            processOutputBuffers()
+            ThreadPlacement.placed(NdiNative.ThreadRole.DECODER_OUTPUT) { processOutputBuffers() }
         }, "Decoder-Output").apply { start() }
 
         Log.d(TAG, "Decoder started")
@@ -120,13 +130,22 @@ class VideoDecoder {
         lastFrameRateN = frame.frameRateN
         lastFrameRateD = frame.frameRateD
 
+        // The NDI buffer is freed once this returns: queue a copy in frame memory.
+        val data = FrameMemory.copyOf(NdiNative.ArenaConsumer.DECODER, frame.data)
+        if (data == null) {
+            Log.w(TAG, "Frame memory budget reached, dropping frame")
+            return
+        }
+
         // Drop oldest frame if queue is full
         if (frameQueue.remainingCapacity() == 0) {
-            frameQueue.poll()
+            frameQueue.poll()?.let { FrameMemory.release(it.data) }
             Log.w(TAG, "Frame queue full, dropping frame")
         }
 
-        frameQueue.offer(frame)
+        if (!frameQueue.offer(frame.copy(data = data))) {
+            FrameMemory.release(data)
+        }
     }
 
     /**
@@ -136,25 +155,37 @@ class VideoDecoder {
         while (isRunning) {
             try {
                 val frame = frameQueue.poll(100, TimeUnit.MILLISECONDS) ?: continue
-
-                val inputIndex = decoder?.dequeueInputBuffer(TIMEOUT_US) ?: -1
-                if (inputIndex >= 0) {
-                    val inputBuffer = decoder?.getInputBuffer(inputIndex) ?: continue
-
-                    inputBuffer.clear()
-
-                    // Copy frame data
-                    val data = frame.data
-                    data.rewind()
-                    inputBuffer.put(data)
-
-                    decoder?.queueInputBuffer(
-                        inputIndex,
-                        0,
-                        data.limit(),
-                        frame.timestamp,
-                        0
-                    )
+                FrameLatency.mark(NdiNative.LatencyStage.DEQUEUE, frame.captureNs)
+
+                try {
+                    // Timed after the input buffer is available: waiting for MediaCodec is not work.
+                    val inputIndex = decoder?.dequeueInputBuffer(TIMEOUT_US) ?: -1
+                    if (inputIndex >= 0) {
+                        val inputBuffer = decoder?.getInputBuffer(inputIndex) ?: continue
+
+                        StageProfiler.measure(NdiNative.PipelineStage.DECODE_SUBMIT) {
+                            inputBuffer.clear()
+
+                            // Copy frame data
+                            val data = frame.data
+                            data.rewind()
+                            inputBuffer.put(data)
+
+                            if (frame.captureNs != 0L) {
+                                synchronized(captureStamps) { captureStamps[frame.timestamp] = frame.captureNs }
+                            }
+                            decoder?.queueInputBuffer(
+                                inputIndex,
+                                0,
+                                data.limit(),
+                                frame.timestamp,
+                                0
+                            )
+                        }
+                        FrameLatency.mark(NdiNative.LatencyStage.SUBMIT, frame.captureNs)
+                    }
+                } finally {
+                    FrameMemory.release(frame.data)
                 }
             } catch (e: Exception) {
                 if (isRunning) {
@@ -176,8 +207,17 @@ class VideoDecoder {
 
                 when {
                     outputIndex >= 0 -> {
+                        val captureNs = synchronized(captureStamps) {
+                            captureStamps.remove(bufferInfo.presentationTimeUs)
+                        } ?: 0L
+                        FrameLatency.mark(NdiNative.LatencyStage.DECODED, captureNs)
+
                         // Release buffer to surface for rendering
-                        decoder?.releaseOutputBuffer(outputIndex, true)
+                        StageProfiler.measure(NdiNative.PipelineStage.RENDER) {
+                            decoder?.releaseOutputBuffer(outputIndex, true)
+                        }
+                        FrameLatency.mark(NdiNative.LatencyStage.PRESENT, captureNs)
+                        TimeToFirstFrame.mark(TimeToFirstFrame.Phase.FIRST_DISPLAY)
                         decodedFrameCount++
                     }
                     outputIndex == MediaCodec.INFO_OUTPUT_FORMAT_CHANGED -> {
@@ -218,6 +258,11 @@ class VideoDecoder {
         }
     }
 
+    /**
+     * Frames submitted and not yet taken by the codec.
+     */
+    fun getBacklog(): Int = frameQueue.size
+
     /**
      * Get current frame statistics.
      */
@@ -262,7 +307,11 @@ class VideoDecoder {
         inputThread = null
         outputThread = null
 
-        frameQueue.clear()
+        while (true) {
+            val frame = frameQueue.poll() ?: break
+            FrameMemory.release(frame.data)
+        }
+        synchronized(captureStamps) { captureStamps.clear() }
 
         Log.d(TAG, "Decoder stopped")
     }
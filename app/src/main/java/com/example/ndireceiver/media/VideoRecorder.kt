@@ -5,6 +5,7 @@ import android.media.MediaFormat
 import android.media.MediaMuxer
 import android.util.Log
 import com.example.ndireceiver.ndi.FourCC
+import com.example.ndireceiver.ndi.NdiNative
 import com.example.ndireceiver.ndi.VideoFrameData
 import java.io.File
 import java.nio.ByteBuffer
@@ -24,8 +25,8 @@ import java.util.concurrent.atomic.AtomicLong
  * directly to an MP4 container with minimal overhead.
  *
  * For uncompressed frames, it implements a full encoding pipeline:
- * 1. Color space conversion (e.g., UYVY to NV12) using `ColorSpaceConverter`.
- * 2. Real-time H.264 encoding via `UncompressedVideoEncoder`.
+ * 1. Color space conversion (e.g., UYVY to NV12, or P216 to P010) using `ColorSpaceConverter`.
+ * 2. Real-time H.264 encoding (or HEVC Main10 for high bit depth sources) via `UncompressedVideoEncoder`.
  * 3. Muxing the encoded frames into an MP4 file.
  *
  * All I/O, conversion, and encoding operations are performed on a dedicated
@@ -33,8 +34,9 @@ import java.util.concurrent.atomic.AtomicLong
  */
 class VideoRecorder(
     private val outputDir: File,
-    private val encoderFactory: (width: Int, height: Int, bitRate: Int, outputFile: File) -> VideoEncoder =
-        { width, height, bitRate, outputFile -> UncompressedVideoEncoder(width, height, bitRate, outputFile) }
+    private val encoderFactory: (width: Int, height: Int, bitRate: Int, outputFile: File, profile: EncoderProfile) -> VideoEncoder =
+        { width, height, bitRate, outputFile, profile -> UncompressedVideoEncoder(width, height, bitRate, outputFile, profile) },
+    private val isProfileSupported: (EncoderProfile) -> Boolean = { it.isSupported() }
 ) {
 
     companion object {
@@ -87,6 +89,7 @@ class VideoRecorder(
 
     // Uncompressed stream properties
     private var frameFourCC: FourCC = FourCC.UNKNOWN
+    private var encoderProfile = EncoderProfile.H264_8BIT
 
     // Background processing
     private var writeThread: Thread? = null
@@ -114,10 +117,25 @@ class VideoRecorder(
 
     /**
      * Start recording for uncompressed video streams.
+     *
+     * @param preferTenBit encode high bit depth sources (P216/PA16) as HEVC Main10 from P010 when the
+     *                     device has such an encoder; other sources are always encoded as 8-bit H.264
      */
-    fun startRecording(width: Int, height: Int, fourCC: FourCC): File {
+    fun startRecording(width: Int, height: Int, fourCC: FourCC, preferTenBit: Boolean = false): File {
         this.isEncoding = true
         this.frameFourCC = fourCC
+        this.encoderProfile = if (
+            preferTenBit &&
+            ColorSpaceConverter.isHighBitDepth(fourCC) &&
+            isProfileSupported(EncoderProfile.HEVC_MAIN10)
+        ) {
+            EncoderProfile.HEVC_MAIN10
+        } else {
+            if (preferTenBit && ColorSpaceConverter.isHighBitDepth(fourCC)) {
+                Log.w(TAG, "No HEVC Main10 encoder with P010 input; recording ${fourCC.name} as 8-bit")
+            }
+            EncoderProfile.H264_8BIT
+        }
         return commonStart(width, height)
     }
 
@@ -131,7 +149,7 @@ class VideoRecorder(
         }
 
         val timestamp = SimpleDateFormat("yyyyMMdd_HHmmss", Locale.getDefault()).format(Date())
-        val codec = if (isEncoding) "H264_from_${frameFourCC.name}" else if (isHevc) "H265" else "H264"
+        val codec = if (isEncoding) "${encoderProfile.label}_from_${frameFourCC.name}" else if (isHevc) "H265" else "H264"
         outputFile = File(outputDir, "NDI_${timestamp}_${width}x${height}_${codec}.mp4")
 
         this.videoWidth = width
@@ -140,7 +158,7 @@ class VideoRecorder(
 
         if (isEncoding) {
             // Setup for encoding uncompressed frames
-            uncompressedEncoder = encoderFactory(width, height, BITRATE_1080P, outputFile!!)
+            uncompressedEncoder = encoderFactory(width, height, BITRATE_1080P, outputFile!!, encoderProfile)
         } else {
             // Setup for passthrough of compressed frames
             this.videoTrackIndex = -1
@@ -152,7 +170,9 @@ class VideoRecorder(
         }
 
         recordingStartTime.set(System.currentTimeMillis())
-        writeThread = Thread({ writeLoop() }, "VideoRecorder-Write").apply { start() }
+        writeThread = Thread({
+            ThreadPlacement.placed(NdiNative.ThreadRole.RECORDER) { writeLoop() }
+        }, "VideoRecorder-Write").apply { start() }
 
         Log.i(TAG, "Recording started: ${outputFile?.absolutePath}")
         return outputFile!!
@@ -161,23 +181,18 @@ class VideoRecorder(
     fun writeFrame(frame: VideoFrameData) {
         if (!isRecordingFlag.get()) return
 
-        // For uncompressed streams, the data will be processed on the write thread.
-        // For compressed streams, we copy the data to avoid issues with the buffer being reused.
-        val dataCopy = if (!isEncoding) {
-            val originalData = frame.data
-            val dataDuplicate = originalData.duplicate()
-            dataDuplicate.rewind()
-            val bytes = ByteArray(dataDuplicate.remaining())
-            dataDuplicate.get(bytes)
-            ByteBuffer.wrap(bytes)
-        } else {
-            frame.data // Pass original buffer, will be converted on write thread
+        // The NDI buffer is freed once this returns: copy it into frame memory for the write thread.
+        val dataCopy = FrameMemory.copyOf(NdiNative.ArenaConsumer.RECORDER, frame.data)
+        if (dataCopy == null) {
+            Log.w(TAG, "Frame memory budget reached, dropping frame")
+            return
         }
 
         val frameToWrite = frame.copy(data = dataCopy)
 
         if (!writeQueue.offer(frameToWrite, 200, TimeUnit.MILLISECONDS)) {
             Log.w(TAG, "Write queue full, dropping frame")
+            FrameMemory.release(dataCopy)
         }
     }
 
@@ -192,10 +207,14 @@ class VideoRecorder(
                 }
                 val presentationTimeUs = frame.timestamp - startTimeUs
 
-                if (isEncoding) {
-                    processFrameForEncoding(frame, presentationTimeUs)
-                } else {
-                    processFrameForPassthrough(frame, presentationTimeUs)
+                try {
+                    if (isEncoding) {
+                        processFrameForEncoding(frame, presentationTimeUs)
+                    } else {
+                        processFrameForPassthrough(frame, presentationTimeUs)
+                    }
+                } finally {
+                    FrameMemory.release(frame.data)
                 }
             } catch (e: InterruptedException) {
                 Thread.currentThread().interrupt()
@@ -208,22 +227,34 @@ class VideoRecorder(
     }
 
     private fun processFrameForEncoding(frame: VideoFrameData, presentationTimeUs: Long) {
-        val nv12Bytes = ColorSpaceConverter.convert(
-            frame.data,
-            frameFourCC,
-            videoWidth,
-            videoHeight,
-            frame.lineStrideBytes
-        )
-
-        if (nv12Bytes != null) {
-            try {
-                uncompressedEncoder?.encodeFrame(nv12Bytes, presentationTimeUs)
-            } catch (e: Exception) {
-                Log.e(TAG, "Encoding failed for frame at $presentationTimeUs", e)
+        // Encoder input: NV12 (1.5 bytes/pixel) or P010 (3 bytes/pixel), charged while it is alive.
+        val pixels = videoWidth.toLong() * videoHeight
+        val converterBytes = if (encoderProfile.isTenBit) pixels * 3 else pixels * 3 / 2
+        if (!FrameMemory.reserve(NdiNative.ArenaConsumer.CONVERTER, converterBytes)) {
+            Log.w(TAG, "Frame memory budget reached, skipping conversion")
+            return
+        }
+
+        try {
+            val inputBytes = StageProfiler.measure(NdiNative.PipelineStage.CONVERT) {
+                if (encoderProfile.isTenBit) {
+                    ColorSpaceConverter.convertToP010(frame.data, frameFourCC, videoWidth, videoHeight, frame.lineStrideBytes)
+                } else {
+                    ColorSpaceConverter.convert(frame.data, frameFourCC, videoWidth, videoHeight, frame.lineStrideBytes)
+                }
             }
-        } else {
-            Log.w(TAG, "Color conversion failed for frame. FourCC: $frameFourCC")
+
+            if (inputBytes != null) {
+                try {
+                    uncompressedEncoder?.encodeFrame(inputBytes, presentationTimeUs)
+                } catch (e: Exception) {
+                    Log.e(TAG, "Encoding failed for frame at $presentationTimeUs", e)
+                }
+            } else {
+                Log.w(TAG, "Color conversion failed for frame. FourCC: $frameFourCC")
+            }
+        } finally {
+            FrameMemory.unreserve(NdiNative.ArenaConsumer.CONVERTER, converterBytes)
         }
     }
 
@@ -259,7 +290,9 @@ class VideoRecorder(
         }
 
         try {
-            passthroughMuxer?.writeSampleData(videoTrackIndex, ByteBuffer.wrap(data), bufferInfo)
+            StageProfiler.measure(NdiNative.PipelineStage.MUX) {
+                passthroughMuxer?.writeSampleData(videoTrackIndex, ByteBuffer.wrap(data), bufferInfo)
+            }
         } catch (e: Exception) {
             Log.e(TAG, "Error writing passthrough sample data", e)
         }
@@ -411,7 +444,10 @@ class VideoRecorder(
 
         videoTrackIndex = -1
         recordingStartTime.set(0)
-        writeQueue.clear()
+        while (true) {
+            val frame = writeQueue.poll() ?: break
+            FrameMemory.release(frame.data)
+        }
         sps = null
         pps = null
         vps = null
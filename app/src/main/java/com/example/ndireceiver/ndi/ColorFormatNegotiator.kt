@@ -0,0 +1,105 @@
+package com.example.ndireceiver.ndi
+
+/**
+ * Consumers of uncompressed frames, each with the pixel layout it ingests without conversion.
+ */
+enum class FrameConsumer {
+    /** UncompressedVideoRenderer: Bitmap.Config.ARGB_8888, i.e. RGBA byte order. */
+    DISPLAY,
+
+    /** UncompressedVideoEncoder via ColorSpaceConverter: NV12 (COLOR_FormatYUV420SemiPlanar). */
+    ENCODER
+}
+
+/**
+ * Outcome of a receive color format negotiation.
+ *
+ * @property colorFormat [NdiNative.ColorFormat] value to pass to receiverCreate
+ * @property expectedFourCC FourCC the SDK delivers for opaque sources in that mode
+ * @property conversionCost summed conversion cost across the negotiated consumers
+ */
+data class ColorFormatChoice(
+    val colorFormat: Int,
+    val expectedFourCC: FourCC,
+    val conversionCost: Int
+) {
+    val label: String
+        get() = "${NdiNative.ColorFormat.name(colorFormat)} (cost $conversionCost)"
+}
+
+/**
+ * Picks the receive color format that needs the fewest conversions for the active consumers.
+ *
+ * Costs per consumer are counted in passes over the frame:
+ * - 0: consumed as delivered (plain copy with stride handling)
+ * - 1: repack or swizzle without a color matrix (BGRA -> RGBA, UYVY -> NV12, I420 -> NV12)
+ * - 2: YUV <-> RGB matrix conversion
+ * - 3: 16-bit P216/PA16 dithered to 8 bits, then matrix converted for display
+ *
+ * NV12, I420, YV12 and UYVA cannot be requested from the receiver, but the SDK delivers them for
+ * some senders (and in FASTEST mode), so [conversionCost] also covers them; an NV12 frame goes
+ * straight into the encoder.
+ */
+object ColorFormatNegotiator {
+
+    private const val COST_DIRECT = 0
+    private const val COST_REPACK = 1
+    private const val COST_MATRIX = 2
+    private const val COST_DITHER_MATRIX = 3
+
+    /**
+     * Requestable modes with the FourCC they deliver for sources without alpha. Order breaks ties:
+     * UYVY_RGBA before UYVY_BGRA so that alpha sources arrive as RGBA, which the display copies as-is.
+     */
+    private val candidates = listOf(
+        NdiNative.ColorFormat.RGBX_RGBA to FourCC.RGBX,
+        NdiNative.ColorFormat.UYVY_RGBA to FourCC.UYVY,
+        NdiNative.ColorFormat.BGRX_BGRA to FourCC.BGRX,
+        NdiNative.ColorFormat.UYVY_BGRA to FourCC.UYVY
+    )
+
+    /**
+     * Choose the receive color format for [consumers]. An empty set falls back to [FrameConsumer.DISPLAY].
+     *
+     * With [preserveHighBitDepth] the receiver asks for [NdiNative.ColorFormat.BEST] regardless of cost,
+     * so that 10/16-bit senders arrive as P216/PA16 and can be recorded at 10 bits; 8-bit senders still
+     * arrive as UYVY/UYVA in that mode.
+     */
+    fun negotiate(consumers: Set<FrameConsumer>, preserveHighBitDepth: Boolean = false): ColorFormatChoice {
+        val active = consumers.ifEmpty { setOf(FrameConsumer.DISPLAY) }
+        if (preserveHighBitDepth) {
+            return ColorFormatChoice(NdiNative.ColorFormat.BEST, FourCC.P216, totalCost(FourCC.P216, active))
+        }
+        return candidates
+            .map { (colorFormat, fourCC) -> ColorFormatChoice(colorFormat, fourCC, totalCost(fourCC, active)) }
+            .minBy { it.conversionCost }
+    }
+
+    /**
+     * Summed conversion cost of delivering [fourCC] to every consumer in [consumers]
+     * ([Int.MAX_VALUE] if any of them cannot take it).
+     */
+    fun totalCost(fourCC: FourCC, consumers: Set<FrameConsumer>): Int =
+        consumers.sumOf { conversionCost(fourCC, it).toLong() }
+            .coerceAtMost(Int.MAX_VALUE.toLong())
+            .toInt()
+
+    /**
+     * Conversion cost of feeding a [fourCC] frame to [consumer], or [Int.MAX_VALUE] if unsupported.
+     */
+    fun conversionCost(fourCC: FourCC, consumer: FrameConsumer): Int = when (consumer) {
+        FrameConsumer.DISPLAY -> when (fourCC) {
+            FourCC.RGBA, FourCC.RGBX -> COST_DIRECT
+            FourCC.BGRA, FourCC.BGRX -> COST_REPACK
+            FourCC.UYVY, FourCC.UYVA, FourCC.NV12, FourCC.I420, FourCC.YV12 -> COST_MATRIX
+            FourCC.P216, FourCC.PA16 -> COST_DITHER_MATRIX
+            else -> Int.MAX_VALUE
+        }
+        FrameConsumer.ENCODER -> when (fourCC) {
+            FourCC.NV12 -> COST_DIRECT
+            FourCC.I420, FourCC.YV12, FourCC.UYVY, FourCC.UYVA, FourCC.P216, FourCC.PA16 -> COST_REPACK
+            FourCC.BGRA, FourCC.BGRX, FourCC.RGBA, FourCC.RGBX -> COST_MATRIX
+            else -> Int.MAX_VALUE
+        }
+    }
+}
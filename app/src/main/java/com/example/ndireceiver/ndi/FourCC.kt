@@ -2,26 +2,56 @@ package com.example.ndireceiver.ndi
 
 enum class FourCC {
     UYVY,
+    UYVA,
     BGRA,
     BGRX,
     RGBA,
     RGBX,
     NV12,
     I420,
+    YV12,
+    P216,
+    PA16,
     H264,
     HEVC,
     UNKNOWN;
 
+    /**
+     * The NDI FourCC code (see [NdiNative.FourCC]), or 0 for [UNKNOWN].
+     */
+    fun toInt(): Int {
+        return when (this) {
+            UYVY -> NdiNative.FourCC.UYVY
+            UYVA -> NdiNative.FourCC.UYVA
+            BGRA -> NdiNative.FourCC.BGRA
+            BGRX -> NdiNative.FourCC.BGRX
+            RGBA -> NdiNative.FourCC.RGBA
+            RGBX -> NdiNative.FourCC.RGBX
+            NV12 -> NdiNative.FourCC.NV12
+            I420 -> NdiNative.FourCC.I420
+            YV12 -> NdiNative.FourCC.YV12
+            P216 -> NdiNative.FourCC.P216
+            PA16 -> NdiNative.FourCC.PA16
+            H264 -> NdiNative.FourCC.H264
+            HEVC -> NdiNative.FourCC.HEVC
+            UNKNOWN -> 0
+        }
+    }
+
     companion object {
         fun fromInt(value: Int): FourCC {
             return when (value) {
                 NdiNative.FourCC.UYVY -> UYVY
+                NdiNative.FourCC.UYVA -> UYVA
                 NdiNative.FourCC.BGRA -> BGRA
                 NdiNative.FourCC.BGRX -> BGRX
                 NdiNative.FourCC.RGBA -> RGBA
                 NdiNative.FourCC.RGBX -> RGBX
                 NdiNative.FourCC.NV12 -> NV12
                 NdiNative.FourCC.I420 -> I420
+                NdiNative.FourCC.YV12 -> YV12
+                NdiNative.FourCC.P216 -> P216
+                NdiNative.FourCC.PA16 -> PA16
                 NdiNative.FourCC.H264 -> H264
                 NdiNative.FourCC.HEVC -> HEVC
                 else -> UNKNOWN
@@ -1,5 +1,6 @@
 package com.example.ndireceiver.ndi
 
+import android.os.SystemClock
 import android.util.Log
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.channels.awaitClose
@@ -14,6 +15,10 @@ import java.util.concurrent.atomic.AtomicBoolean
  * NDI source discovery service using Kotlin Flow.
  * Discovers NDI sources on the network using mDNS/Bonjour.
  * Uses the native JNI wrapper (NdiNative) for NDI operations.
+ *
+ * The native finder diffs the source list itself and only returns what was added, removed or
+ * moved to a new URL address, so large Discovery Server deployments do not rebuild the list
+ * in the JVM on every announcement.
  * 
  * Thread safety:
  * - finderPtr is managed with AtomicLong to prevent race conditions
@@ -23,6 +28,10 @@ class NdiFinder {
     companion object {
         private const val TAG = "NdiFinder"
         private const val DISCOVERY_TIMEOUT_MS = 1000
+
+        // Without any source by then, an empty list is reported once, so cached sources that
+        // are gone do not stay listed
+        private const val SETTLE_MS = 3000L
     }
 
     // Use AtomicLong for thread-safe access to finder pointer
@@ -65,7 +74,10 @@ class NdiFinder {
 
             Log.d(TAG, "NDI Finder created, starting discovery")
 
-            var lastSourceNames = emptySet<String>()
+            // Applied in arrival order, so sources keep their place in the list as others come and go
+            val known = LinkedHashMap<String, NdiSource>()
+            val startMs = SystemClock.elapsedRealtime()
+            var reported = false
 
             while (isActive && isDiscovering) {
                 val ptr = finderPtrAtomic.get()
@@ -75,26 +87,27 @@ class NdiFinder {
                 }
                 
                 try {
-                    // Wait for source changes with timeout
-                    val changed = NdiNative.finderWaitForSources(ptr, DISCOVERY_TIMEOUT_MS)
-
-                    // Get current sources - check pointer again
-                    val currentPtr = finderPtrAtomic.get()
-                    if (currentPtr == 0L) break
-                    
-                    val sourceNames = NdiNative.finderGetSources(currentPtr)
-                    val sources = sourceNames.map { name ->
-                        NdiSource(name = name)
+                    // Blocks natively until the source list really differs; null on timeout
+                    val changes = NdiNative.finderWaitForChanges(ptr, DISCOVERY_TIMEOUT_MS)
+                    if (changes == null) {
+                        if (!reported && SystemClock.elapsedRealtime() - startMs >= SETTLE_MS) {
+                            Log.d(TAG, "No NDI sources found")
+                            trySend(emptyList())
+                            reported = true
+                        }
+                        continue
                     }
 
-                    val currentSourceNames = sources.map { it.name }.toSet()
-
-                    // Only emit if sources actually changed or on first iteration
-                    if (changed || lastSourceNames != currentSourceNames) {
-                        Log.d(TAG, "Found ${sources.size} NDI sources")
-                        trySend(sources)
-                        lastSourceNames = currentSourceNames
+                    for (change in changes) {
+                        when (change.kind) {
+                            NdiNative.SourceChangeKind.REMOVED -> known.remove(change.name)
+                            else -> known[change.name] = NdiSource(name = change.name, url = change.url)
+                        }
                     }
+
+                    Log.d(TAG, "Found ${known.size} NDI sources (${changes.size} changed)")
+                    trySend(known.values.toList())
+                    reported = true
                 } catch (e: Exception) {
                     Log.e(TAG, "Error during source discovery", e)
                 }
@@ -1,10 +1,15 @@
 package com.example.ndireceiver.ndi
 
+import android.os.SystemClock
 import android.util.Log
+import kotlinx.coroutines.CompletableDeferred
 
 /**
  * Singleton manager for NDI SDK initialization and lifecycle.
  * Uses the native JNI wrapper (NdiNative) instead of Devolay.
+ *
+ * libndi.so is loaded by initialization rather than with the wrapper, so the app starts with
+ * [initializeAsync] and callers that need the SDK wait in [awaitInitialized].
  */
 object NdiManager {
     private const val TAG = "NdiManager"
@@ -19,6 +24,17 @@ object NdiManager {
     var lastError: String? = null
         private set
 
+    /**
+     * Wall time of the last successful [initialize] in milliseconds, including loading the JNI
+     * wrapper and libndi.so (-1 until then). Logged for cold-start comparisons.
+     */
+    @Volatile
+    var initializeTimeMs: Long = -1L
+        private set
+
+    private val ready = CompletableDeferred<Boolean>()
+    private var loadThread: Thread? = null
+
     /**
      * Initialize the NDI SDK. Must be called before using any NDI functionality.
      * @return true if initialization succeeded, false otherwise
@@ -30,8 +46,9 @@ object NdiManager {
             return true
         }
 
+        val startNs = SystemClock.elapsedRealtimeNanos()
         return try {
-            // First, try to load the native libraries
+            // First, try to load the JNI wrapper
             if (!nativeLibraryLoaded) {
                 try {
                     // This triggers NdiNative's static initializer which loads the libraries
@@ -45,13 +62,21 @@ object NdiManager {
                 }
             }
 
-            // Initialize NDI SDK via native wrapper
+            // The SDK reads its transport configuration while initializing
+            NdiTransport.applyConfigured()
+
+            // Load libndi.so and initialize the SDK via the native wrapper
+            val wrapperNs = SystemClock.elapsedRealtimeNanos()
             initialized = NdiNative.initialize()
 
             if (initialized) {
+                val doneNs = SystemClock.elapsedRealtimeNanos()
+                initializeTimeMs = (doneNs - startNs) / 1_000_000
                 val version = NdiNative.getVersion()
-                Log.i(TAG, "NDI SDK initialized successfully (version: $version)")
+                Log.i(TAG, "NDI SDK initialized successfully (version: $version) in $initializeTimeMs ms " +
+                    "(wrapper ${(wrapperNs - startNs) / 1_000_000} ms, SDK ${(doneNs - wrapperNs) / 1_000_000} ms)")
                 lastError = null
+                ready.complete(true)
             } else {
                 lastError = "NDI SDK initialization failed"
                 Log.e(TAG, lastError!!)
@@ -64,6 +89,35 @@ object NdiManager {
         }
     }
 
+    /**
+     * Initialize the SDK on a background thread, so loading libndi.so stays off app startup.
+     * Only the first call starts loading; use [awaitInitialized] for the result.
+     */
+    @Synchronized
+    fun initializeAsync() {
+        if (loadThread != null || ready.isCompleted) return
+        loadThread = Thread({
+            val result = try {
+                initialize()
+            } catch (e: Throwable) {
+                // ExceptionInInitializerError when the wrapper itself is missing
+                lastError = "NDI native library not available: ${e.message}"
+                Log.e(TAG, lastError!!, e)
+                false
+            }
+            ready.complete(result)
+        }, "NDI-Runtime-Load").apply { start() }
+    }
+
+    /**
+     * Wait for initialization started by [initializeAsync] (started here if it was not).
+     * @return true if the SDK is ready; see [lastError] otherwise
+     */
+    suspend fun awaitInitialized(): Boolean {
+        initializeAsync()
+        return ready.await()
+    }
+
     /**
      * Check if NDI SDK is initialized.
      */
@@ -85,18 +139,25 @@ object NdiManager {
     }
 
     /**
-     * Cleanup NDI resources. Call when the app is being destroyed.
+     * Cleanup NDI resources. Call when the app is being destroyed, after every finder and
+     * receiver has been closed.
+     *
+     * @return false if the SDK is still in use and stays initialized
      */
     @Synchronized
-    fun destroy() {
+    fun destroy(): Boolean {
         if (initialized) {
             try {
-                NdiNative.destroy()
+                if (!NdiNative.destroy()) {
+                    Log.w(TAG, "NDI SDK still in use, not destroyed")
+                    return false
+                }
                 Log.i(TAG, "NDI SDK destroyed")
             } catch (e: Exception) {
                 Log.e(TAG, "Error destroying NDI SDK", e)
             }
             initialized = false
         }
+        return true
     }
 }
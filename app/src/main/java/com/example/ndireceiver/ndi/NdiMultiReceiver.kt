@@ -0,0 +1,332 @@
+package com.example.ndireceiver.ndi
+
+import android.os.SystemClock
+import android.util.Log
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.withContext
+
+/**
+ * Receives several NDI sources at once (e.g. 2-4 cameras on one tablet).
+ *
+ * Every source has its own native receiver, so its own jitter buffer, bandwidth and stats, but
+ * none has a thread: a native capture scheduler's small worker pool captures for all of them
+ * and a single delivery thread hands frames to [Callback] as they come due. The focused source
+ * (see [setFocus]) is captured and delivered ahead of the others.
+ *
+ * Video and metadata only; audio is not captured for scheduled sources.
+ *
+ * Thread safety: sources are added and removed under [lock], which the delivery thread also
+ * holds while it uses a receiver, so a receiver is never destroyed mid-frame.
+ */
+class NdiMultiReceiver(
+    private val targetLatencyMs: Int = 0,
+    private val lowLatency: Boolean = false
+) {
+    companion object {
+        private const val TAG = "NdiMultiReceiver"
+        private const val WAIT_TIMEOUT_MS = 200
+        private const val CONNECTION_CHECK_INTERVAL_MS = 1000L
+        private const val CONNECTION_LOST_MS = 5000L
+        private const val THREAD_JOIN_TIMEOUT_MS = 3000L
+
+        /** Receivers one native scheduler can serve. */
+        const val MAX_SOURCES = 8
+    }
+
+    /**
+     * Frames and events of every source, called on the delivery thread. Callbacks must not add
+     * or remove sources (post that to another thread).
+     */
+    interface Callback {
+        /** The frame's buffer is only valid during the call. */
+        fun onVideoFrame(sourceName: String, frame: VideoFrameData)
+        fun onConnectionLost(sourceName: String) {}
+        fun onMetadata(sourceName: String, event: NdiNative.MetadataEvent) {}
+    }
+
+    private class Source(val name: String, val ptr: Long, val bandwidth: Int) {
+        var hasReceivedFrame = false
+        var lastFrameMs = 0L
+        var lostReported = false
+    }
+
+    private val lock = Any()
+    private val sources = LinkedHashMap<Long, Source>()   // By receiver pointer, under lock
+    private var schedulerPtr = 0L                        // Under lock
+
+    // Cleared to stop the loop; a thread that is no longer the delivery thread ends.
+    @Volatile
+    private var deliveryThread: Thread? = null
+
+    @Volatile
+    private var callback: Callback? = null
+
+    /**
+     * Source delivered and captured first, or null.
+     */
+    @Volatile
+    var focusedSource: String? = null
+        private set
+
+    fun setCallback(callback: Callback?) {
+        this.callback = callback
+    }
+
+    /**
+     * Names of the sources being received, in the order they were added.
+     */
+    fun getSourceNames(): List<String> = synchronized(lock) { sources.values.map { it.name } }
+
+    /**
+     * Start receiving [source] at [bandwidth]. Starts the scheduler with the first source.
+     *
+     * @return false if the source is already added, [MAX_SOURCES] are, or the receiver failed
+     */
+    suspend fun addSource(
+        source: NdiSource,
+        bandwidth: Int = NdiNative.Bandwidth.HIGHEST
+    ): Boolean = withContext(Dispatchers.IO) {
+        if (!NdiManager.awaitInitialized()) {
+            Log.e(TAG, "NDI SDK not initialized")
+            return@withContext false
+        }
+        createSource(source.name, bandwidth)
+    }
+
+    /**
+     * Stop receiving a source. Stops the scheduler with the last one.
+     */
+    suspend fun removeSource(sourceName: String) = withContext(Dispatchers.IO) {
+        val stopped = synchronized(lock) {
+            val entry = sources.values.firstOrNull { it.name == sourceName } ?: return@synchronized null
+            destroySourceLocked(entry)
+            if (sources.isEmpty()) detachLocked() else null
+        }
+        stopped?.let { stop(it) }
+    }
+
+    /**
+     * Receive a source at another bandwidth; its receiver is replaced, so delivery pauses until
+     * the new stream starts.
+     */
+    suspend fun setBandwidth(sourceName: String, bandwidth: Int): Boolean = withContext(Dispatchers.IO) {
+        synchronized(lock) {
+            val entry = sources.values.firstOrNull { it.name == sourceName } ?: return@synchronized false
+            if (entry.bandwidth == bandwidth) {
+                return@synchronized true
+            }
+            destroySourceLocked(entry)
+            createSource(sourceName, bandwidth)
+        }
+    }
+
+    /**
+     * Give a source priority over the others (null for none), e.g. the one shown full screen.
+     */
+    fun setFocus(sourceName: String?) {
+        synchronized(lock) {
+            focusedSource = sourceName
+            applyFocusLocked()
+        }
+    }
+
+    /**
+     * How the scheduler has served a source, or null if it is not being received.
+     */
+    fun getSchedulerStats(sourceName: String): NdiNative.SchedulerSourceStats? = synchronized(lock) {
+        val entry = sources.values.firstOrNull { it.name == sourceName } ?: return@synchronized null
+        NdiNative.schedulerGetSourceStats(schedulerPtr, entry.ptr)
+    }
+
+    /**
+     * Rolling stream statistics of a source, or null if it is not being received.
+     */
+    fun getStats(sourceName: String): NdiNative.ReceiverStats? = synchronized(lock) {
+        val entry = sources.values.firstOrNull { it.name == sourceName } ?: return@synchronized null
+        NdiNative.receiverGetStats(entry.ptr)
+    }
+
+    /**
+     * Stop receiving every source.
+     */
+    fun release() {
+        val stopped = synchronized(lock) {
+            for (entry in sources.values.toList()) {
+                destroySourceLocked(entry)
+            }
+            detachLocked()
+        }
+        stop(stopped)
+    }
+
+    private fun createSource(sourceName: String, bandwidth: Int): Boolean = synchronized(lock) {
+        if (sources.values.any { it.name == sourceName } || sources.size >= MAX_SOURCES) {
+            Log.w(TAG, "Cannot add $sourceName (${sources.size} sources)")
+            return@synchronized false
+        }
+        if (schedulerPtr == 0L) {
+            schedulerPtr = NdiNative.schedulerCreate(0)
+            if (schedulerPtr == 0L) {
+                return@synchronized false
+            }
+        }
+
+        val colorFormat = ColorFormatNegotiator.negotiate(setOf(FrameConsumer.DISPLAY)).colorFormat
+        val ptr = NdiReceiver.createNativeReceiver(colorFormat, bandwidth)
+        if (ptr == 0L) {
+            Log.e(TAG, "Failed to create receiver for $sourceName")
+            return@synchronized false
+        }
+        NdiNative.receiverSetTargetLatency(ptr, targetLatencyMs)
+        NdiNative.receiverSetLowLatency(ptr, lowLatency)
+        NdiNative.receiverSetMetadataSubscriptions(ptr, NdiReceiver.DEFAULT_METADATA_SUBSCRIPTIONS.toTypedArray())
+        if (!NdiNative.schedulerAdd(schedulerPtr, ptr)) {
+            NdiNative.receiverDestroy(ptr)
+            return@synchronized false
+        }
+        NdiNative.receiverConnect(ptr, sourceName)
+
+        sources[ptr] = Source(sourceName, ptr, bandwidth)
+        applyFocusLocked()
+        startDeliveryLocked()
+        Log.i(TAG, "Receiving $sourceName (bandwidth $bandwidth, ${sources.size} sources)")
+        true
+    }
+
+    private fun destroySourceLocked(entry: Source) {
+        sources.remove(entry.ptr)
+        NdiNative.schedulerRemove(schedulerPtr, entry.ptr)
+        NdiNative.receiverDestroy(entry.ptr)
+        Log.i(TAG, "Stopped receiving ${entry.name}")
+    }
+
+    private fun applyFocusLocked() {
+        if (schedulerPtr == 0L) return
+        val focused = sources.values.firstOrNull { it.name == focusedSource }
+        NdiNative.schedulerSetFocus(schedulerPtr, focused?.ptr ?: 0L)
+    }
+
+    private fun startDeliveryLocked() {
+        if (deliveryThread != null) return
+        val ptr = schedulerPtr
+        val thread = Thread({ deliveryLoop(ptr) }, "NDI-Multi-Delivery")
+        deliveryThread = thread
+        thread.start()
+    }
+
+    /**
+     * Take the delivery thread and the scheduler for [stop] once no source is left; a source
+     * added meanwhile starts new ones.
+     */
+    private fun detachLocked(): Pair<Thread?, Long> {
+        val detached = Pair(deliveryThread, schedulerPtr)
+        deliveryThread = null
+        schedulerPtr = 0L
+        return detached
+    }
+
+    /**
+     * Join the delivery thread (outside the lock, which it needs to finish a frame), then destroy
+     * the scheduler it was waiting on.
+     */
+    private fun stop(detached: Pair<Thread?, Long>) {
+        val (thread, scheduler) = detached
+        if (thread != null) {
+            try {
+                thread.join(THREAD_JOIN_TIMEOUT_MS)
+            } catch (e: InterruptedException) {
+                Thread.currentThread().interrupt()
+            }
+            if (thread.isAlive) {
+                Log.w(TAG, "Delivery thread did not stop; leaking the scheduler")
+                return
+            }
+        }
+        if (scheduler != 0L) {
+            NdiNative.schedulerDestroy(scheduler)
+        }
+    }
+
+    private fun deliveryLoop(schedulerPtr: Long) {
+        Log.d(TAG, "Delivery loop started")
+        NdiNative.threadPlacementApply(NdiNative.ThreadRole.RECEIVE)
+        var nextConnectionCheckMs = SystemClock.elapsedRealtime() + CONNECTION_CHECK_INTERVAL_MS
+
+        while (deliveryThread === Thread.currentThread()) {
+            try {
+                val ready = NdiNative.schedulerWaitReady(schedulerPtr, WAIT_TIMEOUT_MS)
+                if (ready != 0L) {
+                    synchronized(lock) {
+                        sources[ready]?.let { deliver(it) }
+                    }
+                }
+                val nowMs = SystemClock.elapsedRealtime()
+                if (nowMs >= nextConnectionCheckMs) {
+                    nextConnectionCheckMs = nowMs + CONNECTION_CHECK_INTERVAL_MS
+                    checkConnections(nowMs)
+                }
+            } catch (e: Exception) {
+                if (deliveryThread === Thread.currentThread()) {
+                    Log.e(TAG, "Error in delivery loop", e)
+                }
+            }
+        }
+
+        NdiNative.threadPlacementRelease()
+        Log.d(TAG, "Delivery loop ended")
+    }
+
+    /**
+     * Hand every due frame of one source to the callback. Delivery thread, under [lock].
+     */
+    private fun deliver(entry: Source) {
+        while (true) {
+            val videoFrame = NdiNative.receiverCaptureVideo(entry.ptr, 0) ?: break
+            entry.hasReceivedFrame = true
+            entry.lastFrameMs = SystemClock.elapsedRealtime()
+            entry.lostReported = false
+
+            val fourCC = FourCC.fromInt(videoFrame.fourCC)
+            val frameData = VideoFrameData(
+                width = videoFrame.width,
+                height = videoFrame.height,
+                frameRateN = videoFrame.frameRateN,
+                frameRateD = videoFrame.frameRateD,
+                data = videoFrame.data,
+                lineStrideBytes = videoFrame.lineStrideBytes,
+                timestamp = videoFrame.timestamp,
+                fourCC = fourCC,
+                isCompressed = fourCC == FourCC.H264 || fourCC == FourCC.HEVC,
+                captureNs = videoFrame.captureNs
+            )
+            try {
+                callback?.onVideoFrame(entry.name, frameData)
+            } finally {
+                NdiNative.receiverFreeVideo(entry.ptr, videoFrame.nativePtr)
+            }
+        }
+
+        val events = NdiNative.receiverPollMetadata(entry.ptr) ?: return
+        val callback = callback ?: return
+        for (event in events) {
+            callback.onMetadata(entry.name, event)
+        }
+    }
+
+    /**
+     * Report sources that stopped delivering and that the SDK no longer sees connected.
+     */
+    private fun checkConnections(nowMs: Long) {
+        val lost = synchronized(lock) {
+            sources.values.filter {
+                it.hasReceivedFrame && !it.lostReported &&
+                    nowMs - it.lastFrameMs >= CONNECTION_LOST_MS &&
+                    !NdiNative.receiverIsConnected(it.ptr)
+            }.onEach { it.lostReported = true }.map { it.name }
+        }
+        for (name in lost) {
+            Log.w(TAG, "Connection lost: $name")
+            callback?.onConnectionLost(name)
+        }
+    }
+}
@@ -7,12 +7,16 @@ import java.nio.ByteBuffer
  * JNI interface for the official NDI SDK.
  *
  * This class provides Kotlin bindings to the native NDI SDK functions
- * through JNI. The native implementation is in ndi_wrapper.cpp.
+ * through JNI. The native implementation is in ndi_wrapper.c.
  *
  * Usage:
  * 1. Download the official NDI SDK from https://ndi.video/
  * 2. Place libndi.so in app/src/main/jniLibs/arm64-v8a/ and/or armeabi-v7a/
- * 3. Call NdiNative.initialize() before using any other functions
+ * 3. Call NdiNative.initialize() before using any other NDI functions
+ *
+ * Loading this object only loads the small JNI wrapper. libndi.so is opened by initialize()
+ * (see NdiManager.initializeAsync, which does so off the main thread); the
+ * debug.ndi.runtime_path system property can point it at another build or a stub.
  *
  * Thread Safety:
  * - initialize() and destroy() must be called from the main thread
@@ -22,19 +26,14 @@ import java.nio.ByteBuffer
 object NdiNative {
 
     /**
-     * Load the native libraries.
-     * Must be called before any other native method.
+     * Load the JNI wrapper. The NDI SDK itself is loaded by [initialize].
      */
     init {
         try {
-            // Load the NDI SDK library first (dependency)
-            System.loadLibrary("ndi")
-            // Load our JNI wrapper
             System.loadLibrary("ndi_wrapper")
         } catch (e: UnsatisfiedLinkError) {
             throw RuntimeException(
-                "Failed to load NDI native libraries. " +
-                "Make sure libndi.so is placed in jniLibs/arm64-v8a/ or jniLibs/armeabi-v7a/",
+                "Failed to load the NDI JNI wrapper (libndi_wrapper.so)",
                 e
             )
         }
@@ -45,18 +44,23 @@ object NdiNative {
     // ============================================================
 
     /**
-     * Initialize the NDI SDK.
+     * Initialize the NDI SDK, loading libndi.so first if needed. Loading runs the SDK's static
+     * initializers and can take a noticeable time, so call this off the main thread.
      * Must be called once before any other NDI operations.
      *
-     * @return true if initialization was successful, false otherwise
+     * @return true if initialization was successful, false otherwise (including when the SDK
+     *         library could not be loaded)
      */
     external fun initialize(): Boolean
 
     /**
      * Destroy/cleanup the NDI SDK.
-     * Call this when the app is shutting down.
+     * Call this when the app is shutting down, after destroying every finder, receiver and
+     * preview receiver.
+     *
+     * @return false, leaving the SDK initialized, while any of those still exist
      */
-    external fun destroy()
+    external fun destroy(): Boolean
 
     /**
      * Check if the NDI SDK is initialized.
@@ -68,7 +72,7 @@ object NdiNative {
     /**
      * Get the NDI SDK version string.
      *
-     * @return version string (e.g., "5.6.0")
+     * @return version string (e.g., "5.6.0"), or "not loaded" before [initialize]
      */
     external fun getVersion(): String
 
@@ -115,6 +119,41 @@ object NdiNative {
      */
     external fun finderGetSources(finderPtr: Long): Array<String>
 
+    /**
+     * Wait until the discovered sources actually differ from what this finder last reported,
+     * and return only the differences. The native finder keeps the last reported list, so
+     * rediscovering identical sources costs nothing on the Java side. The first call reports
+     * every source already found as [SourceChangeKind.ADDED].
+     *
+     * @param finderPtr native pointer from finderCreate()
+     * @param timeoutMs longest time to wait for a change
+     * @return changes in name order, or null on timeout or error
+     */
+    external fun finderWaitForChanges(finderPtr: Long, timeoutMs: Int): Array<SourceChange>?
+
+    // ============================================================
+    // Source Cache
+    // ============================================================
+
+    /**
+     * Open (or create) the persistent source cache. Once open, discovery records the sources
+     * it finds with their URL addresses, receivers record the sources they got video from, and
+     * [receiverConnect] connects a cached source at its URL address instead of resolving its
+     * name, falling back to the name if that address does not connect within a few seconds.
+     * Later calls do nothing.
+     *
+     * @param path cache file, created if missing
+     * @return false if the file cannot be created or mapped
+     */
+    external fun sourceCacheOpen(path: String): Boolean
+
+    /**
+     * Get the cached sources, most recently connected first, then most recently seen.
+     *
+     * @return cached sources, or null if the cache is not open
+     */
+    external fun sourceCacheGetSources(): Array<CachedSource>?
+
     // ============================================================
     // NDI Receiver
     // ============================================================
@@ -124,7 +163,8 @@ object NdiNative {
      *
      * @param receiverName name to identify this receiver on the network
      * @param bandwidth bandwidth mode: 0=metadata only, 1=audio only, 2=lowest, 3=highest
-     * @param colorFormat color format: 0=BGRX/BGRA, 1=UYVY/BGRA, 2=RGBX/RGBA, 3=UYVY/RGBA
+     * @param colorFormat color format: 0=BGRX/BGRA, 1=UYVY/BGRA, 2=RGBX/RGBA, 3=UYVY/RGBA,
+     *                    100=fastest, 101=best (see [ColorFormatNegotiator])
      * @param allowVideoFields whether to allow interlaced video
      * @return native pointer to receiver instance, or 0 on failure
      */
@@ -143,7 +183,8 @@ object NdiNative {
     external fun receiverDestroy(receiverPtr: Long)
 
     /**
-     * Connect the receiver to an NDI source.
+     * Connect the receiver to an NDI source. A source in the source cache is connected at its
+     * cached URL address (see [sourceCacheOpen]).
      *
      * @param receiverPtr native pointer from receiverCreate()
      * @param sourceName source name (from finderGetSources)
@@ -162,7 +203,8 @@ object NdiNative {
      * Capture a video frame from the connected source.
      *
      * @param receiverPtr native pointer from receiverCreate()
-     * @param timeoutMs timeout in milliseconds
+     * @param timeoutMs timeout in milliseconds; ignored for a receiver added to a scheduler,
+     *                  which only returns a frame that is already due
      * @return VideoFrame object with frame data, or null if no frame/timeout
      */
     external fun receiverCaptureVideo(receiverPtr: Long, timeoutMs: Int): VideoFrame?
@@ -201,6 +243,82 @@ object NdiNative {
      */
     external fun receiverGetPerformance(receiverPtr: Long): ReceiverPerformance?
 
+    /**
+     * Get stream statistics over the last two seconds: frame rate, bitrate, arrival jitter,
+     * SDK queue depths, capture-call time and connection count. All of it is kept natively
+     * as frames are captured, so polling this (e.g. once a second) is all a caller needs.
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @return ReceiverStats for the window, or null on error
+     */
+    external fun receiverGetStats(receiverPtr: Long): ReceiverStats?
+
+    /**
+     * Capture on a newly connected receiver until it holds a frame its stream can start on
+     * (any uncompressed frame, or a random access point of compressed video; earlier frames
+     * are released). The frame is returned by the next [receiverCaptureVideo], so the caller
+     * can switch to this receiver without a gap.
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @param timeoutMs how long to wait for frames (0 to only look at frames already queued)
+     * @return true once such a frame is held
+     */
+    external fun receiverPreroll(receiverPtr: Long, timeoutMs: Int): Boolean
+
+    /**
+     * Select how interlaced and single-field frames are deinterlaced in receiverCaptureVideo.
+     * Deinterlaced frames are reported as progressive (single fields at full frame height);
+     * the per-frame cost is reported in [ReceiverPerformance].
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @param mode [DeinterlaceMode] value
+     */
+    external fun receiverSetDeinterlaceMode(receiverPtr: Long, mode: Int)
+
+    /**
+     * Set the latency budget of the receiver's video jitter buffer. Captured frames are held in
+     * timestamp order and released by receiverCaptureVideo at their playout time; the buffer only
+     * uses as much of the budget as the measured arrival jitter needs. 0 hands frames out as they
+     * arrive. Counters are reported in [ReceiverPerformance].
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @param latencyMs budget in milliseconds (0-[MAX_TARGET_LATENCY_MS])
+     */
+    external fun receiverSetTargetLatency(receiverPtr: Long, latencyMs: Int)
+
+    /**
+     * Enable latest-frame-wins capture. After each capture the SDK queue depth is checked
+     * (NDIlib_recv_get_queue) and queued video is drained: only the newest frame is kept for
+     * uncompressed video, and everything from the newest random access point for compressed
+     * video. The jitter buffer does not hold frames while this is on; the target latency is
+     * restored when it is turned off.
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @param enabled true to skip stale frames
+     */
+    external fun receiverSetLowLatency(receiverPtr: Long, enabled: Boolean)
+
+    /**
+     * Select the metadata elements delivered by [receiverPollMetadata]. Metadata frames are
+     * captured by receiverCaptureVideo alongside video and tokenized natively; only elements
+     * named here are kept. A name ending in '*' matches by prefix. Replaces the previous list;
+     * an empty array turns delivery off.
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @param elements element names (at most [MAX_METADATA_SUBSCRIPTIONS])
+     * @return false if the list was rejected (too many or invalid names)
+     */
+    external fun receiverSetMetadataSubscriptions(receiverPtr: Long, elements: Array<String>): Boolean
+
+    /**
+     * Take the oldest queued metadata events (up to 16 per call). Events that are not polled
+     * are dropped oldest first once 64 are queued; see [ReceiverPerformance.metadataDropped].
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @return events oldest first, or null if none are queued
+     */
+    external fun receiverPollMetadata(receiverPtr: Long): Array<MetadataEvent>?
+
     /**
      * Check if receiver is currently connected to a source.
      *
@@ -223,10 +341,534 @@ object NdiNative {
      */
     external fun receiverSetSurface(receiverPtr: Long, surface: Surface?): Boolean
 
+    // ============================================================
+    // Relay
+    // ============================================================
+
+    /**
+     * Republish everything this receiver captures as a local NDI source, so other receivers
+     * can pull from this device instead of the original sender. Uncompressed video is sent
+     * without a copy (the SDK compresses it again); compressed (HX) video cannot go through
+     * the send API, so the source is only advertised from the first uncompressed frame and is
+     * withdrawn while compressed frames arrive (see [RelayStats.compressed]). Nothing is sent
+     * while no receiver is connected. Replaces a relay already running.
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @param sourceName NDI name to advertise the relay under
+     * @return false if the runtime lacks send support
+     */
+    external fun receiverStartRelay(receiverPtr: Long, sourceName: String): Boolean
+
+    /**
+     * Stop relaying and withdraw the relay source.
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     */
+    external fun receiverStopRelay(receiverPtr: Long)
+
+    /**
+     * Get relay counters and the number of receivers currently connected to it.
+     *
+     * @param receiverPtr native pointer from receiverCreate()
+     * @return stats, or null if the receiver is not relaying
+     */
+    external fun receiverGetRelayStats(receiverPtr: Long): RelayStats?
+
+    // ============================================================
+    // Transport
+    // ============================================================
+
+    /**
+     * Select the transport every receiver uses, by writing the SDK configuration file into
+     * [configDir] and pointing NDI_CONFIG_DIR at it. The SDK reads it in [initialize], so it
+     * applies from the next initialization. The multicast group and TTL also apply to the
+     * relay sender (see [receiverStartRelay]).
+     *
+     * NDI_CONFIG_DIR is set only by the first call, which has to come before the first
+     * [initialize]; later calls write into that directory whatever [configDir] is.
+     *
+     * @param configDir existing directory for ndi-config.v1.json
+     * @param mode [Transport] value ([Transport.AUTO] removes the file)
+     * @param multicastPrefix multicast group range, e.g. "239.255.0.0"
+     * @param multicastMask group range mask, e.g. "255.255.0.0"
+     * @param multicastTtl multicast TTL (1-255; 1 stays on the local subnet)
+     * @return false if the settings are invalid or the file could not be written
+     */
+    external fun setTransportProfile(
+        configDir: String,
+        mode: Int,
+        multicastPrefix: String,
+        multicastMask: String,
+        multicastTtl: Int
+    ): Boolean
+
+    /**
+     * Receive a source for [durationMs] (after its first frame, waited for up to 5 s) and
+     * measure loss and arrival jitter with the current transport. Blocks the calling thread.
+     *
+     * @param sourceName source to probe, or null for a loopback source created for the probe
+     * @param durationMs measuring time
+     * @return measurements, or null if the SDK is not initialized or the probe could not start
+     */
+    external fun transportProbe(sourceName: String?, durationMs: Int): TransportProbeResult?
+
+    // ============================================================
+    // Source Preview
+    // ============================================================
+
+    /**
+     * Create a receiver for a source's lowest-bandwidth (proxy) stream, for list thumbnails.
+     * It is separate from playback receivers and takes nothing from the frame memory budget.
+     *
+     * @param sourceName NDI source name
+     * @return native preview pointer, or 0 on failure
+     */
+    external fun previewCreate(sourceName: String): Long
+
+    /**
+     * Destroy a preview receiver.
+     *
+     * @param previewPtr native pointer from previewCreate()
+     */
+    external fun previewDestroy(previewPtr: Long)
+
+    /**
+     * Scale the newest received frame into [pixels] as ARGB (box filtered, ready for
+     * Bitmap.setPixels). Frames queued before it are dropped.
+     *
+     * @param previewPtr native pointer from previewCreate()
+     * @param pixels destination of at least width * height entries
+     * @param width thumbnail width
+     * @param height thumbnail height
+     * @param timeoutMs how long to wait if no frame is queued
+     * @return true if a frame was written
+     */
+    external fun previewCapture(previewPtr: Long, pixels: IntArray, width: Int, height: Int, timeoutMs: Int): Boolean
+
+    // ============================================================
+    // Pixel Conversion
+    // ============================================================
+
+    /**
+     * Convert a P216 (or PA16, whose alpha plane is ignored) frame with the native kernels.
+     *
+     * @param src direct ByteBuffer holding the 16-bit Y plane followed by the full-height UV plane
+     * @param width frame width in pixels (must be even)
+     * @param height frame height in pixels
+     * @param strideBytes bytes per line of both source planes
+     * @param dst output array sized for [target] (P010: width*2*(height + (height+1)/2),
+     *            NV12: width*(height + (height+1)/2))
+     * @param target [P216Target] value
+     * @return true if [dst] was written
+     */
+    external fun convertP216(
+        src: ByteBuffer,
+        width: Int,
+        height: Int,
+        strideBytes: Int,
+        dst: ByteArray,
+        target: Int
+    ): Boolean
+
+    /**
+     * Create a reusable scaler for [scalerScale]; it keeps filter tables between same-sized frames.
+     *
+     * @return native pointer to the scaler, or 0 on failure
+     */
+    external fun scalerCreate(): Long
+
+    external fun scalerDestroy(scalerPtr: Long)
+
+    /**
+     * Convert and scale an uncompressed frame to RGBA in one pass with the native (NEON) kernels.
+     *
+     * @param src direct ByteBuffer holding the frame; the alpha plane of UYVA is ignored
+     * @param fourCC [FourCC] code; UYVY, UYVA, BGRA, BGRX, RGBA and RGBX are supported
+     * @param dst direct ByteBuffer of at least dstStrideBytes * dstHeight bytes
+     * @param filter [ScaleFilter] value
+     * @return true if [dst] was written
+     */
+    external fun scalerScale(
+        scalerPtr: Long,
+        src: ByteBuffer,
+        srcStrideBytes: Int,
+        srcWidth: Int,
+        srcHeight: Int,
+        fourCC: Int,
+        dst: ByteBuffer,
+        dstStrideBytes: Int,
+        dstWidth: Int,
+        dstHeight: Int,
+        filter: Int
+    ): Boolean
+
+    // ============================================================
+    // Recording Metadata
+    // ============================================================
+
+    /**
+     * Read an MP4's duration and picture size from its box headers (mvhd, tkhd, stsd, and the
+     * moof boxes of fragmented files) with a few small reads, without parsing sample tables.
+     * Does not need the NDI SDK.
+     *
+     * @param path MP4 file
+     * @return metadata, or null if the file has no complete moov (e.g. an unfinished recording)
+     */
+    external fun probeMp4(path: String): Mp4Info?
+
+    // ============================================================
+    // Frame Pacing
+    // ============================================================
+
+    /**
+     * Create a vsync presentation scheduler. Frames are identified by caller-chosen ids
+     * (e.g. buffer slot indices); every id handed in comes back exactly once, either presented
+     * by [pacerOnVsync], dropped, or returned by [pacerEnqueue].
+     *
+     * @param capacity maximum queued frames (1-16)
+     * @return native pointer to the pacer, or 0 on failure
+     */
+    external fun pacerCreate(capacity: Int): Long
+
+    /**
+     * Destroy a pacer created with pacerCreate().
+     */
+    external fun pacerDestroy(pacerPtr: Long)
+
+    /**
+     * Forget queued frames and the timeline anchor (e.g. after a format change). Statistics are kept.
+     */
+    external fun pacerReset(pacerPtr: Long)
+
+    /**
+     * Set the delay between a frame's arrival and its presentation, which absorbs network jitter.
+     */
+    external fun pacerSetDelay(pacerPtr: Long, delayNs: Long)
+
+    /**
+     * Queue a frame for presentation.
+     *
+     * @param frameId caller id for the frame
+     * @param timestamp NDI timestamp (100 ns units), or Long.MAX_VALUE if undefined
+     * @param durationNs nominal frame duration from the frame rate (0 if unknown)
+     * @param nowNs arrival time on the System.nanoTime() clock
+     * @return id of a frame handed back unqueued (evicted when full, or this one if its
+     *         timestamp went backwards), or -1
+     */
+    external fun pacerEnqueue(pacerPtr: Long, frameId: Int, timestamp: Long, durationNs: Long, nowNs: Long): Int
+
+    /**
+     * Decide what to show at a vsync.
+     *
+     * @param vsyncNs Choreographer frame time (System.nanoTime() clock)
+     * @param periodNs display refresh period, or 0 to use the interval measured between calls
+     * @param dropped receives the ids of frames dropped by this decision, terminated by -1
+     *                when shorter than the array; should hold at least the pacer capacity
+     * @return id of the frame to present now, or -1 to keep the current picture
+     */
+    external fun pacerOnVsync(pacerPtr: Long, vsyncNs: Long, periodNs: Long, dropped: IntArray): Int
+
+    /**
+     * Get presentation counters and the present-time error histogram.
+     */
+    external fun pacerGetStats(pacerPtr: Long): PacerStats?
+
+    // ============================================================
+    // Frame Memory Arena
+    // ============================================================
+
+    /**
+     * Set the process-wide frame memory budget. Lowering it releases cached blocks; memory in
+     * use stays valid until freed, but new requests are refused until usage drops below it.
+     */
+    external fun arenaSetBudget(budgetBytes: Long)
+
+    /**
+     * Allocate a frame buffer from the arena.
+     *
+     * @param consumer [ArenaConsumer] the memory is charged to
+     * @param size bytes needed; the buffer's capacity is exactly this
+     * @return direct buffer backed by arena memory, or null when the budget is exhausted
+     *         (back-pressure: drop or skip the frame); must be returned with [arenaFree]
+     */
+    external fun arenaAlloc(consumer: Int, size: Int): ByteBuffer?
+
+    /**
+     * Return a buffer obtained from [arenaAlloc]. The buffer must not be used afterwards.
+     */
+    external fun arenaFree(buffer: ByteBuffer)
+
+    /**
+     * Charge memory allocated elsewhere (Bitmaps, Java arrays) to the budget.
+     *
+     * @return false if it does not fit; nothing is charged
+     */
+    external fun arenaReserve(consumer: Int, bytes: Long): Boolean
+
+    /**
+     * Undo an [arenaReserve].
+     */
+    external fun arenaUnreserve(consumer: Int, bytes: Long)
+
+    /**
+     * Release cached free blocks (e.g. on disconnect or memory pressure).
+     */
+    external fun arenaTrim()
+
+    /**
+     * Get arena usage, globally and per [ArenaConsumer].
+     */
+    external fun arenaGetStats(): ArenaStats?
+
+    // ============================================================
+    // Thread Placement
+    // ============================================================
+
+    /**
+     * Enable or disable CPU affinity and priority for pipeline threads.
+     *
+     * @param coreMap per-role placement, e.g. "receive=big@-10;recorder=little@0"; roles not
+     *        listed use the default (latency-critical stages on the big cores). Null or empty
+     *        falls back to the debug.ndi.core_map system property, then to the defaults.
+     * @return false if the core map is invalid (the previous placement is kept)
+     */
+    external fun threadPlacementConfigure(enabled: Boolean, coreMap: String?): Boolean
+
+    /**
+     * Place the calling thread according to its [ThreadRole]. Call at the start of the
+     * thread's run loop; a no-op while placement is disabled.
+     *
+     * @return 0, or the errno of the affinity/priority call that failed
+     */
+    external fun threadPlacementApply(role: Int): Int
+
+    /**
+     * Stop tracking the calling thread. Call before the thread exits.
+     */
+    external fun threadPlacementRelease()
+
+    /**
+     * Sample every placed thread and return its verified placement.
+     */
+    external fun threadPlacementGetStats(): ThreadPlacementStats?
+
+    // ============================================================
+    // Stage Profiling
+    // ============================================================
+
+    /**
+     * Start timing [PipelineStage] [stage] on the calling thread. Pair with [stageEnd] on the
+     * same thread; nesting different stages is allowed, nesting the same stage is not.
+     */
+    external fun stageBegin(stage: Int)
+
+    /**
+     * Finish timing [stage] on the calling thread and add its wall and thread CPU time.
+     */
+    external fun stageEnd(stage: Int)
+
+    /**
+     * Per-stage timing over the last [StageStats.windowNs], plus the busiest threads of the
+     * process since the previous call.
+     */
+    external fun getStageStats(): StageStats?
+
+    // ============================================================
+    // Latency
+    // ============================================================
+
+    /**
+     * Record that the frame captured at [captureNs] ([VideoFrame.captureNs]) reached
+     * [LatencyStage] [stage] now.
+     */
+    external fun latencyMark(stage: Int, captureNs: Long)
+
+    /**
+     * Forget all latency recordings, e.g. before connecting to another source.
+     */
+    external fun latencyReset()
+
+    /**
+     * Capture-to-stage latency percentiles since the last [latencyReset].
+     */
+    external fun getLatencyStats(): LatencyStats?
+
+    // ============================================================
+    // Adaptive Bandwidth
+    // ============================================================
+
+    /**
+     * Create a controller that chooses between a source's highest and lowest streams. It
+     * starts at [Bandwidth.HIGHEST].
+     *
+     * @return native pointer to the controller, or 0 on failure
+     */
+    external fun bandwidthCreate(): Long
+
+    /**
+     * Destroy a controller created with bandwidthCreate().
+     */
+    external fun bandwidthDestroy(controllerPtr: Long)
+
+    /**
+     * Feed one sample, about once a second. After a returned switch, samples are ignored until
+     * [bandwidthSwitched] reports how it went.
+     *
+     * @param frames video frames received since the previous sample
+     * @param dropped video frames dropped since the previous sample
+     * @param queueMax deepest SDK video queue since the previous sample
+     * @param backlog frames waiting in the decoder or renderer
+     * @param nowNs sample time on the System.nanoTime() clock
+     * @return [Bandwidth] value to switch to, or -1 to stay
+     */
+    external fun bandwidthUpdate(controllerPtr: Long, frames: Long, dropped: Long, queueMax: Int, backlog: Int, nowNs: Long): Int
+
+    /**
+     * Report whether the switch returned by [bandwidthUpdate] completed.
+     */
+    external fun bandwidthSwitched(controllerPtr: Long, ok: Boolean, nowNs: Long)
+
+    /**
+     * Get the current level and the decisions made so far.
+     */
+    external fun bandwidthGetStats(controllerPtr: Long): BandwidthStats?
+
+    // ============================================================
+    // Capture Scheduler
+    // ============================================================
+
+    /**
+     * Start a worker pool that captures for many receivers at once.
+     *
+     * @param workers worker threads, or 0 for a quarter of the CPUs (at least 1, at most 4)
+     * @return native pointer to the scheduler, or 0 on failure
+     */
+    external fun schedulerCreate(workers: Int): Long
+
+    /**
+     * Stop the workers. Remove (or destroy) every receiver added to it first.
+     */
+    external fun schedulerDestroy(schedulerPtr: Long)
+
+    /**
+     * Capture for a receiver on the scheduler's workers from now on, so its
+     * [receiverCaptureVideo] only takes frames that are due. At most 8 receivers.
+     */
+    external fun schedulerAdd(schedulerPtr: Long, receiverPtr: Long): Boolean
+
+    /**
+     * Stop capturing for a receiver, waiting for a capture in progress.
+     */
+    external fun schedulerRemove(schedulerPtr: Long, receiverPtr: Long)
+
+    /**
+     * Capture for a receiver ahead of the others (0 for none).
+     */
+    external fun schedulerSetFocus(schedulerPtr: Long, receiverPtr: Long)
+
+    /**
+     * Wait for a receiver with a video frame due, the focused one first.
+     *
+     * @return the receiver's pointer (take the frame with [receiverCaptureVideo]), or 0 on timeout
+     */
+    external fun schedulerWaitReady(schedulerPtr: Long, timeoutMs: Int): Long
+
+    /**
+     * Get how the scheduler has served a receiver, or null if it is not added.
+     */
+    external fun schedulerGetSourceStats(schedulerPtr: Long, receiverPtr: Long): SchedulerSourceStats?
+
+    // ============================================================
+    // Multiview
+    // ============================================================
+
+    /**
+     * Create a compositor that scales several sources into a grid of tiles of one canvas.
+     *
+     * @param width canvas width in pixels (also the surface buffer width)
+     * @param height canvas height in pixels
+     * @param columns tiles across; columns * rows is at most 16
+     * @param rows tiles down
+     * @return native pointer to the compositor, or 0 on failure
+     */
+    external fun multiviewCreate(width: Int, height: Int, columns: Int, rows: Int): Long
+
+    external fun multiviewDestroy(multiviewPtr: Long)
+
+    /**
+     * Present to [surface] (null to stop presenting). Its buffers are set to the canvas size.
+     */
+    external fun multiviewSetSurface(multiviewPtr: Long, surface: Surface?): Boolean
+
+    /**
+     * Scale an uncompressed frame into a tile, letterboxed. Any thread; the frame is not kept.
+     *
+     * @param data direct buffer holding the frame
+     * @param fourCC [FourCC] code; UYVY, UYVA, BGRA, BGRX, RGBA and RGBX are supported
+     * @return false if the tile, buffer or format is not usable
+     */
+    external fun multiviewSubmit(
+        multiviewPtr: Long,
+        tile: Int,
+        data: ByteBuffer,
+        strideBytes: Int,
+        width: Int,
+        height: Int,
+        fourCC: Int
+    ): Boolean
+
+    /**
+     * Fill a tile with black.
+     */
+    external fun multiviewClearTile(multiviewPtr: Long, tile: Int)
+
+    /**
+     * Copy the tiles that changed to the surface. Call once per vsync.
+     *
+     * @return true if a buffer was posted
+     */
+    external fun multiviewPresent(multiviewPtr: Long): Boolean
+
+    external fun multiviewGetStats(multiviewPtr: Long): MultiviewStats?
+
+    /**
+     * Get a tile's freshness and compose cost, or null for a tile out of range.
+     */
+    external fun multiviewGetTileStats(multiviewPtr: Long, tile: Int): MultiviewTileStats?
+
     // ============================================================
     // Data Classes for JNI Return Types
     // ============================================================
 
+    /**
+     * A source from the persistent source cache (see [sourceCacheOpen]).
+     *
+     * @property name source name in format "SourceName (MachineName)"
+     * @property url last known URL address, empty if unknown
+     * @property lastSeenMs wall clock (System.currentTimeMillis) when last discovered or connected
+     * @property lastSuccessMs wall clock of the last connection that delivered video, or 0
+     */
+    data class CachedSource(
+        val name: String,
+        val url: String,
+        val lastSeenMs: Long,
+        val lastSuccessMs: Long
+    )
+
+    /**
+     * One difference in a finder's source list (see [finderWaitForChanges]).
+     *
+     * @property kind one of [SourceChangeKind]
+     * @property name source name in format "SourceName (MachineName)"
+     * @property url the source's URL address (p_url_address), empty if the SDK gave none;
+     *           for [SourceChangeKind.REMOVED], the last one seen
+     */
+    data class SourceChange(
+        val kind: Int,
+        val name: String,
+        val url: String
+    )
+
     /**
      * Video frame data from NDI source.
      *
@@ -240,6 +882,7 @@ object NdiNative {
      * @property timestamp NDI timestamp
      * @property data pixel data buffer (direct ByteBuffer)
      * @property isProgressive true if progressive, false if interlaced
+     * @property captureNs CLOCK_MONOTONIC (System.nanoTime) when the SDK returned the frame
      */
     data class VideoFrame(
         val nativePtr: Long,
@@ -251,7 +894,8 @@ object NdiNative {
         val fourCC: Int,
         val timestamp: Long,
         val data: ByteBuffer,
-        val isProgressive: Boolean
+        val isProgressive: Boolean,
+        val captureNs: Long
     ) {
         val frameRate: Float
             get() = if (frameRateD != 0) frameRateN.toFloat() / frameRateD else 0f
@@ -288,6 +932,24 @@ object NdiNative {
      * @property audioFramesDropped audio frames dropped
      * @property metadataFramesTotal total metadata frames received
      * @property quality connection quality (0-100)
+     * @property colorFormat [ColorFormat] the receiver was created with
+     * @property videoFourCC FourCC of the most recently captured video frame (0 if none yet)
+     * @property deinterlaceMode [DeinterlaceMode] currently applied
+     * @property deinterlacedFrames frames that went through the deinterlacer
+     * @property deinterlaceLastNs wall time spent deinterlacing the most recent frame
+     * @property deinterlaceAvgNs average wall time per deinterlaced frame
+     * @property targetLatencyMs jitter buffer latency budget
+     * @property jitterDelayNs buffering currently applied by the jitter buffer (at most the budget)
+     * @property arrivalJitterNs measured peak-to-peak arrival jitter
+     * @property lateFrames frames that arrived after their playout time
+     * @property earlyFrames frames that arrived faster than any recent frame
+     * @property jitterDroppedFrames frames the jitter buffer discarded (stale, duplicate or overflow)
+     * @property jitterDepth frames currently held by the jitter buffer
+     * @property lowLatency latest-frame-wins capture is enabled
+     * @property skippedFrames stale frames discarded by latest-frame-wins capture
+     * @property queueDepth video frames queued in the SDK after the most recent capture
+     * @property metadataEvents subscribed metadata elements extracted
+     * @property metadataDropped metadata events discarded because they were not polled in time
      */
     data class ReceiverPerformance(
         val videoFramesTotal: Long,
@@ -295,7 +957,25 @@ object NdiNative {
         val audioFramesTotal: Long,
         val audioFramesDropped: Long,
         val metadataFramesTotal: Long,
-        val quality: Int
+        val quality: Int,
+        val colorFormat: Int,
+        val videoFourCC: Int,
+        val deinterlaceMode: Int,
+        val deinterlacedFrames: Long,
+        val deinterlaceLastNs: Long,
+        val deinterlaceAvgNs: Long,
+        val targetLatencyMs: Int,
+        val jitterDelayNs: Long,
+        val arrivalJitterNs: Long,
+        val lateFrames: Long,
+        val earlyFrames: Long,
+        val jitterDroppedFrames: Long,
+        val jitterDepth: Int,
+        val lowLatency: Boolean,
+        val skippedFrames: Long,
+        val queueDepth: Int,
+        val metadataEvents: Long,
+        val metadataDropped: Long
     ) {
         val videoDropRate: Float
             get() = if (videoFramesTotal > 0) {
@@ -303,10 +983,494 @@ object NdiNative {
             } else 0f
     }
 
+    /**
+     * Rolling-window stream statistics (see [receiverGetStats]). Reset when the receiver connects.
+     *
+     * @property windowNs time the figures cover (up to 2 s; less right after connecting)
+     * @property videoFrames video frames that arrived in the window
+     * @property videoBytes video payload bytes that arrived in the window
+     * @property fps frame rate from the mean arrival interval (0 below two frames)
+     * @property bitrateBps video payload bits per second
+     * @property intervalAvgNs mean time between frame arrivals
+     * @property intervalMaxNs longest time between frame arrivals
+     * @property jitterNs standard deviation of the arrival interval
+     * @property captureCalls capture calls that returned a video frame
+     * @property captureAvgNs mean duration of those calls, time spent waiting included
+     * @property captureMaxNs longest of those calls
+     * @property queueVideoAvg mean SDK video queue depth sampled after each capture
+     * @property queueVideoMax deepest SDK video queue
+     * @property queueAudioMax deepest SDK audio queue
+     * @property queueMetadataMax deepest SDK metadata queue
+     * @property queueVideo SDK video queue depth after the most recent capture
+     * @property queueAudio SDK audio queue depth after the most recent capture
+     * @property queueMetadata SDK metadata queue depth after the most recent capture
+     * @property connections current connection count
+     * @property connectionsMin fewest connections seen in the window
+     * @property connectionsMax most connections seen in the window
+     */
+    data class ReceiverStats(
+        val windowNs: Long,
+        val videoFrames: Long,
+        val videoBytes: Long,
+        val fps: Double,
+        val bitrateBps: Long,
+        val intervalAvgNs: Long,
+        val intervalMaxNs: Long,
+        val jitterNs: Long,
+        val captureCalls: Long,
+        val captureAvgNs: Long,
+        val captureMaxNs: Long,
+        val queueVideoAvg: Double,
+        val queueVideoMax: Int,
+        val queueAudioMax: Int,
+        val queueMetadataMax: Int,
+        val queueVideo: Int,
+        val queueAudio: Int,
+        val queueMetadata: Int,
+        val connections: Int,
+        val connectionsMin: Int,
+        val connectionsMax: Int
+    )
+
+    /**
+     * One subscribed element from a metadata frame (see [receiverSetMetadataSubscriptions]).
+     *
+     * @property element element name
+     * @property attributes attribute names and values, alternating, entities decoded
+     * @property text direct text content, entities decoded and trimmed (child elements excluded)
+     * @property timecode timecode of the metadata frame (100 ns units)
+     * @property truncated a name, value, the text or the attribute list exceeded the native limits
+     */
+    data class MetadataEvent(
+        val element: String,
+        val attributes: Array<String>,
+        val text: String,
+        val timecode: Long,
+        val truncated: Boolean
+    ) {
+        /** Value of attribute [name], or null if the element does not have it. */
+        fun attribute(name: String): String? {
+            for (i in 0 until attributes.size - 1 step 2) {
+                if (attributes[i] == name) return attributes[i + 1]
+            }
+            return null
+        }
+
+        override fun equals(other: Any?): Boolean {
+            if (this === other) return true
+            if (other !is MetadataEvent) return false
+            return element == other.element &&
+                attributes.contentEquals(other.attributes) &&
+                text == other.text &&
+                timecode == other.timecode &&
+                truncated == other.truncated
+        }
+
+        override fun hashCode(): Int = element.hashCode() * 31 + attributes.contentHashCode()
+    }
+
+    /**
+     * Relay counters (see [receiverStartRelay]).
+     *
+     * @property videoSent video frames republished
+     * @property videoSkipped compressed video frames the send API cannot carry
+     * @property videoUnwatched video frames not sent because no receiver was connected
+     * @property audioSent audio frames republished
+     * @property connections receivers currently connected to the relay
+     * @property advertising whether the relay source currently exists on the network
+     * @property compressed the stream is compressed, so the relay is unavailable
+     */
+    data class RelayStats(
+        val videoSent: Long,
+        val videoSkipped: Long,
+        val videoUnwatched: Long,
+        val audioSent: Long,
+        val connections: Int,
+        val advertising: Boolean,
+        val compressed: Boolean
+    )
+
+    /**
+     * Result of [transportProbe].
+     *
+     * @property frames video frames received while measuring
+     * @property lost frames missing from the sender's timeline (network loss and SDK drops)
+     * @property lossRate lost / (frames + lost)
+     * @property jitterNs RFC 3550 interarrival jitter estimate
+     * @property maxDeviationNs largest change in transit time between consecutive frames
+     * @property connectMs time to the first frame, or -1 if none arrived
+     */
+    data class TransportProbeResult(
+        val frames: Long,
+        val lost: Long,
+        val lossRate: Double,
+        val jitterNs: Long,
+        val maxDeviationNs: Long,
+        val connectMs: Long
+    )
+
+    /**
+     * Result of [probeMp4].
+     *
+     * @property durationMs movie duration; for fragmented files the end of the last fragment
+     * @property width coded video width, or 0 without a video track
+     * @property height coded video height, or 0 without a video track
+     * @property videoCodec video sample entry type as a big-endian FourCC (e.g. 'avc1'), or 0
+     * @property fragmented whether samples are described by moof boxes
+     */
+    data class Mp4Info(
+        val durationMs: Long,
+        val width: Int,
+        val height: Int,
+        val videoCodec: Int,
+        val fragmented: Boolean
+    )
+
+    /**
+     * Frame pacer statistics. Present-time error is the vsync time a frame was shown at minus
+     * the time it was due; positive values are late.
+     *
+     * @property enqueued frames queued for presentation
+     * @property presented frames shown
+     * @property dropped frames skipped because a newer one was due, or evicted from a full queue
+     * @property repeated vsyncs that kept the previous picture because the next frame was late
+     * @property rejected frames handed back because their timestamp went backwards
+     * @property resyncs times the sender timeline was re-anchored to the local clock
+     * @property queueDepth frames currently queued
+     * @property vsyncPeriodNs measured display refresh period (0 until measured)
+     * @property errorMinNs smallest present-time error
+     * @property errorMaxNs largest present-time error
+     * @property errorMeanNs mean present-time error
+     * @property errorP50Ns median present-time error (bucket resolution)
+     * @property errorP99Ns 99th percentile present-time error (bucket resolution)
+     * @property histogramBucketNs width of each histogram bucket
+     * @property histogram present counts per error bucket, starting at [HISTOGRAM_ORIGIN_NS];
+     *                     the first and last buckets also hold everything beyond them
+     */
+    data class PacerStats(
+        val enqueued: Long,
+        val presented: Long,
+        val dropped: Long,
+        val repeated: Long,
+        val rejected: Long,
+        val resyncs: Long,
+        val queueDepth: Int,
+        val vsyncPeriodNs: Long,
+        val errorMinNs: Long,
+        val errorMaxNs: Long,
+        val errorMeanNs: Long,
+        val errorP50Ns: Long,
+        val errorP99Ns: Long,
+        val histogramBucketNs: Long,
+        val histogram: LongArray
+    ) {
+        companion object {
+            const val HISTOGRAM_ORIGIN_NS = -16_000_000L
+        }
+
+        override fun equals(other: Any?): Boolean {
+            if (this === other) return true
+            if (other !is PacerStats) return false
+            return presented == other.presented &&
+                dropped == other.dropped &&
+                repeated == other.repeated &&
+                enqueued == other.enqueued &&
+                histogram.contentEquals(other.histogram)
+        }
+
+        override fun hashCode(): Int = histogram.contentHashCode() * 31 + presented.hashCode()
+    }
+
+    /**
+     * Frame memory arena usage. Per-consumer arrays are indexed by [ArenaConsumer] values.
+     *
+     * @property budgetBytes configured budget
+     * @property usedBytes memory charged to consumers (block sizes and reservations)
+     * @property cachedBytes free blocks kept for reuse
+     * @property peakUsedBytes highest [usedBytes] seen
+     * @property allocs successful allocations and reservations
+     * @property reuses allocations served from cached blocks
+     * @property rejected requests refused by the budget
+     * @property consumerBytes memory currently charged to each consumer
+     * @property consumerPeakBytes highest memory charged to each consumer
+     * @property consumerRejected requests refused for each consumer
+     */
+    data class ArenaStats(
+        val budgetBytes: Long,
+        val usedBytes: Long,
+        val cachedBytes: Long,
+        val peakUsedBytes: Long,
+        val allocs: Long,
+        val reuses: Long,
+        val rejected: Long,
+        val consumerBytes: LongArray,
+        val consumerPeakBytes: LongArray,
+        val consumerRejected: LongArray
+    ) {
+        override fun equals(other: Any?): Boolean {
+            if (this === other) return true
+            if (other !is ArenaStats) return false
+            return budgetBytes == other.budgetBytes &&
+                usedBytes == other.usedBytes &&
+                cachedBytes == other.cachedBytes &&
+                rejected == other.rejected &&
+                consumerBytes.contentEquals(other.consumerBytes) &&
+                consumerRejected.contentEquals(other.consumerRejected)
+        }
+
+        override fun hashCode(): Int = consumerBytes.contentHashCode() * 31 + usedBytes.hashCode()
+    }
+
+    /**
+     * Placement of one pipeline thread as last sampled. CPU masks have bit n set for CPU n.
+     *
+     * @property role [ThreadRole] the thread registered as
+     * @property tid kernel thread id
+     * @property requestedMask CPUs the core map asked for (0: affinity left unchanged)
+     * @property actualMask affinity the kernel reports
+     * @property requestedNice nice value the core map asked for (the current one if unchanged)
+     * @property nice current nice value
+     * @property cpu CPU the thread last ran on, or -1
+     * @property samples verification samples taken
+     * @property offMaskSamples samples that found the thread outside [requestedMask]
+     * @property migrations CPU changes between consecutive samples
+     * @property error errno of the last failed placement call, or 0
+     */
+    data class PlacedThread(
+        val role: Int,
+        val tid: Int,
+        val requestedMask: Long,
+        val actualMask: Long,
+        val requestedNice: Int,
+        val nice: Int,
+        val cpu: Int,
+        val samples: Long,
+        val offMaskSamples: Long,
+        val migrations: Long,
+        val error: Int
+    ) {
+        /** True when the thread runs where and at the priority it was asked to. */
+        val isPlaced: Boolean
+            get() = error == 0 && nice == requestedNice &&
+                (requestedMask == 0L || (actualMask and requestedMask.inv()) == 0L)
+    }
+
+    /**
+     * Thread placement state and the detected CPU topology.
+     *
+     * @property enabled whether placement is applied to new threads
+     * @property cpuCount CPUs present
+     * @property bigMask highest-capacity cores (all cores on homogeneous devices)
+     * @property littleMask remaining cores (all cores on homogeneous devices)
+     * @property threads registered pipeline threads
+     */
+    data class ThreadPlacementStats(
+        val enabled: Boolean,
+        val cpuCount: Int,
+        val bigMask: Long,
+        val littleMask: Long,
+        val threads: Array<PlacedThread>
+    ) {
+        override fun equals(other: Any?): Boolean {
+            if (this === other) return true
+            if (other !is ThreadPlacementStats) return false
+            return enabled == other.enabled &&
+                cpuCount == other.cpuCount &&
+                bigMask == other.bigMask &&
+                littleMask == other.littleMask &&
+                threads.contentEquals(other.threads)
+        }
+
+        override fun hashCode(): Int = threads.contentHashCode() * 31 + bigMask.hashCode()
+    }
+
+    /**
+     * CPU use of one thread of the process.
+     *
+     * @property tid kernel thread id
+     * @property name thread name (truncated to 15 characters by the kernel)
+     * @property cpuNs CPU time since the previous [getStageStats] call
+     * @property totalCpuNs CPU time since the thread started
+     */
+    data class ThreadCpu(
+        val tid: Int,
+        val name: String,
+        val cpuNs: Long,
+        val totalCpuNs: Long
+    )
+
+    /**
+     * Pipeline stage timing. Per-stage arrays are indexed by [PipelineStage] values.
+     *
+     * @property windowNs time the per-stage figures cover (up to 2 s)
+     * @property threadIntervalNs time [threads] CPU figures cover (0 on the first call)
+     * @property count executions of each stage
+     * @property wallTotalNs wall time spent in each stage
+     * @property wallMaxNs longest single execution of each stage
+     * @property cpuTotalNs CPU time of the threads while they ran each stage
+     * @property threads busiest threads first
+     */
+    data class StageStats(
+        val windowNs: Long,
+        val threadIntervalNs: Long,
+        val count: LongArray,
+        val wallTotalNs: LongArray,
+        val wallMaxNs: LongArray,
+        val cpuTotalNs: LongArray,
+        val threads: Array<ThreadCpu>
+    ) {
+        /** Mean wall time of one execution of [stage], in nanoseconds. */
+        fun wallAvgNs(stage: Int): Long = if (count[stage] > 0) wallTotalNs[stage] / count[stage] else 0L
+
+        /** CPU time of [stage] as a percentage of one core over the window. */
+        fun cpuPercent(stage: Int): Double = if (windowNs > 0) cpuTotalNs[stage] * 100.0 / windowNs else 0.0
+
+        override fun equals(other: Any?): Boolean {
+            if (this === other) return true
+            if (other !is StageStats) return false
+            return windowNs == other.windowNs &&
+                count.contentEquals(other.count) &&
+                wallTotalNs.contentEquals(other.wallTotalNs) &&
+                cpuTotalNs.contentEquals(other.cpuTotalNs) &&
+                threads.contentEquals(other.threads)
+        }
+
+        override fun hashCode(): Int = count.contentHashCode() * 31 + windowNs.hashCode()
+    }
+
+    /**
+     * Glass-to-glass latency from capture to each stage. Per-stage arrays are indexed by
+     * [LatencyStage] values; percentiles are within about 3% of the true value.
+     *
+     * @property elapsedNs time the figures cover, from the first frame after the last reset
+     * @property count frames that reached each stage
+     * @property p50Ns median capture-to-stage latency
+     * @property p95Ns 95th percentile capture-to-stage latency
+     * @property p99Ns 99th percentile capture-to-stage latency
+     * @property maxNs largest capture-to-stage latency
+     */
+    data class LatencyStats(
+        val elapsedNs: Long,
+        val count: LongArray,
+        val p50Ns: LongArray,
+        val p95Ns: LongArray,
+        val p99Ns: LongArray,
+        val maxNs: LongArray
+    ) {
+        override fun equals(other: Any?): Boolean {
+            if (this === other) return true
+            if (other !is LatencyStats) return false
+            return elapsedNs == other.elapsedNs &&
+                count.contentEquals(other.count) &&
+                p50Ns.contentEquals(other.p50Ns) &&
+                p95Ns.contentEquals(other.p95Ns) &&
+                p99Ns.contentEquals(other.p99Ns) &&
+                maxNs.contentEquals(other.maxNs)
+        }
+
+        override fun hashCode(): Int = count.contentHashCode() * 31 + elapsedNs.hashCode()
+    }
+
+    /**
+     * Adaptive bandwidth decisions (see [bandwidthUpdate]).
+     *
+     * @property bandwidth [Bandwidth] currently received
+     * @property pending a switch to [pendingBandwidth] is in progress
+     * @property pendingBandwidth [Bandwidth] being switched to
+     * @property lastReason [BandwidthReason] of the last switch requested
+     * @property samples samples fed
+     * @property degradedSamples samples past a degraded threshold (drops, queue or backlog)
+     * @property downgrades completed switches to the lowest stream
+     * @property upgrades completed switches back to the highest stream
+     * @property failedSwitches switches abandoned because the new stream did not start
+     * @property recoverHoldNs healthy time the next upgrade needs (grows when switching flaps)
+     * @property lastSwitchNs System.nanoTime() of the last completed switch, or 0
+     * @property lastDropRatio dropped / offered frames in the last sample
+     */
+    data class BandwidthStats(
+        val bandwidth: Int,
+        val pending: Boolean,
+        val pendingBandwidth: Int,
+        val lastReason: Int,
+        val samples: Long,
+        val degradedSamples: Long,
+        val downgrades: Long,
+        val upgrades: Long,
+        val failedSwitches: Long,
+        val recoverHoldNs: Long,
+        val lastSwitchNs: Long,
+        val lastDropRatio: Double
+    )
+
+    /**
+     * How the capture scheduler served one receiver (see [schedulerAdd]).
+     *
+     * @property focused the receiver has priority
+     * @property services captures run for it
+     * @property idleServices captures that found nothing queued
+     * @property frames video frames captured
+     * @property lagAvgNs average time it waited for a worker once due
+     * @property lagMaxNs longest such wait
+     */
+    data class SchedulerSourceStats(
+        val focused: Boolean,
+        val services: Long,
+        val idleServices: Long,
+        val frames: Long,
+        val lagAvgNs: Long,
+        val lagMaxNs: Long
+    )
+
+    /**
+     * Multiview presentation counters (see [multiviewPresent]).
+     *
+     * @property presents buffers posted
+     * @property idlePresents vsyncs when no tile had changed
+     * @property dirtyTilesAvg tiles copied per posted buffer
+     * @property presentAvgNs average time to copy the changed tiles
+     * @property presentMaxNs longest such copy
+     */
+    data class MultiviewStats(
+        val presents: Long,
+        val idlePresents: Long,
+        val dirtyTilesAvg: Double,
+        val presentAvgNs: Long,
+        val presentMaxNs: Long
+    )
+
+    /**
+     * One multiview tile (see [multiviewSubmit]).
+     *
+     * @property hasFrame a frame is shown (not cleared)
+     * @property srcWidth width of the last submitted frame
+     * @property srcHeight height of the last submitted frame
+     * @property frames frames scaled into the tile
+     * @property superseded frames replaced before any present showed them
+     * @property ageNs time since the tile last changed (0 without a frame)
+     * @property composeAvgNs average time to scale a frame into the tile
+     * @property composeMaxNs longest such scale
+     */
+    data class MultiviewTileStats(
+        val hasFrame: Boolean,
+        val srcWidth: Int,
+        val srcHeight: Int,
+        val frames: Long,
+        val superseded: Long,
+        val ageNs: Long,
+        val composeAvgNs: Long,
+        val composeMaxNs: Long
+    )
+
     // ============================================================
     // Constants
     // ============================================================
 
+    /** Upper bound for [receiverSetTargetLatency]. */
+    const val MAX_TARGET_LATENCY_MS = 500
+
+    /** Upper bound for the number of names passed to [receiverSetMetadataSubscriptions]. */
+    const val MAX_METADATA_SUBSCRIPTIONS = 16
+
     object Bandwidth {
         const val METADATA_ONLY = 0
         const val AUDIO_ONLY = 1
@@ -321,16 +1485,110 @@ object NdiNative {
         const val UYVY_RGBA = 3
         const val FASTEST = 100  // Let NDI choose fastest format
         const val BEST = 101     // Let NDI choose best quality format
+
+        fun name(colorFormat: Int): String = when (colorFormat) {
+            BGRX_BGRA -> "BGRX_BGRA"
+            UYVY_BGRA -> "UYVY_BGRA"
+            RGBX_RGBA -> "RGBX_RGBA"
+            UYVY_RGBA -> "UYVY_RGBA"
+            FASTEST -> "FASTEST"
+            BEST -> "BEST"
+            else -> "UNKNOWN($colorFormat)"
+        }
+    }
+
+    object DeinterlaceMode {
+        const val OFF = 0
+        const val WEAVE = 1            // Keep both fields (single fields are still combined)
+        const val BOB = 2              // Keep one field, interpolate the other
+        const val MOTION_ADAPTIVE = 3  // Weave static areas, bob moving ones
+    }
+
+    object ArenaConsumer {
+        const val RENDERER = 0   // Uncompressed renderer conversion buffer and bitmaps
+        const val RECORDER = 1   // Frames queued for recording
+        const val CONVERTER = 2  // Encoder input from color conversion
+        const val DECODER = 3    // Compressed frames queued for MediaCodec
+        const val AUDIO = 4      // Interleaved audio from receiverCaptureAudio
+
+        val NAMES = listOf("render", "record", "convert", "decode", "audio")
+    }
+
+    object ThreadRole {
+        const val RECEIVE = 0         // NDI-Receive-Thread
+        const val DECODER_INPUT = 1   // Decoder-Input
+        const val DECODER_OUTPUT = 2  // Decoder-Output
+        const val RECORDER = 3        // VideoRecorder-Write
+        const val PACER = 4           // NDI-Frame-Pacer
+
+        val NAMES = listOf("receive", "dec-in", "dec-out", "record", "pacer")
+    }
+
+    object PipelineStage {
+        const val CAPTURE = 0        // Frame hand-off from the SDK (native, receive thread)
+        const val CONVERT = 1        // Pixel conversion for display or encoding
+        const val RENDER = 2         // Canvas draw or MediaCodec release to the surface
+        const val DECODE_SUBMIT = 3  // Copying compressed frames into MediaCodec
+        const val MUX = 4            // MP4 muxer writes
+
+        val NAMES = listOf("cap", "conv", "rend", "dec", "mux")
+    }
+
+    object LatencyStage {
+        const val DEQUEUE = 0   // Consumer took the frame (decoder input thread or renderer)
+        const val SUBMIT = 1    // Queued to MediaCodec, or converted and handed to the pacer
+        const val DECODED = 2   // MediaCodec output (compressed video only)
+        const val PRESENT = 3   // Posted to the surface
+
+        val NAMES = listOf("deq", "sub", "dec", "pres")
+    }
+
+    object BandwidthReason {
+        const val NONE = 0
+        const val DROPS = 1       // SDK dropped frames
+        const val QUEUE = 2       // Frames queued in the SDK faster than captured
+        const val BACKLOG = 3     // Frames waiting in the decoder or renderer
+        const val RECOVERED = 4   // Healthy long enough to try the highest stream again
+
+        val NAMES = listOf("none", "drops", "queue", "backlog", "recovered")
+    }
+
+    object Transport {
+        const val AUTO = 0       // SDK defaults
+        const val TCP = 1        // Reliable unicast over TCP
+        const val RUDP = 2       // Reliable UDP unicast
+        const val MULTICAST = 3  // Shared multicast stream, unicast fallback
+    }
+
+    object P216Target {
+        const val P010 = 0            // 10-bit MSB-aligned 4:2:0 (COLOR_FormatYUVP010)
+        const val NV12_DITHERED = 1   // 8-bit 4:2:0 with ordered dither
+    }
+
+    object ScaleFilter {
+        const val AUTO = 0       // AREA when shrinking, BILINEAR when enlarging (per axis)
+        const val AREA = 1
+        const val BILINEAR = 2
+    }
+
+    object SourceChangeKind {
+        const val ADDED = 0
+        const val REMOVED = 1
+        const val CHANGED = 2   // Same name, new URL address
     }
 
     object FourCC {
         const val UYVY = 0x59565955  // 'UYVY' - YUV 4:2:2
+        const val UYVA = 0x41565955  // 'UYVA' - YUV 4:2:2 followed by an alpha plane
         const val BGRA = 0x41524742  // 'BGRA' - 32-bit BGRA
         const val BGRX = 0x58524742  // 'BGRX' - 32-bit BGR (no alpha)
         const val RGBA = 0x41424752  // 'RGBA' - 32-bit RGBA
         const val RGBX = 0x58424752  // 'RGBX' - 32-bit RGB (no alpha)
         const val NV12 = 0x3231564E  // 'NV12' - YUV 4:2:0 planar
         const val I420 = 0x30323449  // 'I420' - YUV 4:2:0 planar
+        const val YV12 = 0x32315659  // 'YV12' - YUV 4:2:0 planar (V plane before U)
+        const val P216 = 0x36313250  // 'P216' - 16-bit YUV 4:2:2 semi-planar
+        const val PA16 = 0x36314150  // 'PA16' - P216 followed by a 16-bit alpha plane
         const val H264 = 0x34363248  // 'H264' - Compressed H.264
         const val HEVC = 0x43564548  // 'HEVC' - Compressed H.265
     }
@@ -1,5 +1,6 @@
 package com.example.ndireceiver.ndi
 
+import android.os.SystemClock
 import android.util.Log
 import android.view.Surface
 import kotlinx.coroutines.Dispatchers
@@ -23,6 +24,9 @@ sealed class ConnectionState {
 
 /**
  * Video frame data received from NDI source.
+ *
+ * [timestamp] is the sender's clock; [captureNs] is this device's CLOCK_MONOTONIC
+ * (System.nanoTime) when the SDK returned the frame, or 0 if unknown.
  */
 data class VideoFrameData(
     val width: Int,
@@ -33,7 +37,8 @@ data class VideoFrameData(
     val lineStrideBytes: Int,
     val timestamp: Long,
     val fourCC: FourCC,
-    val isCompressed: Boolean = false
+    val isCompressed: Boolean = false,
+    val captureNs: Long = 0L
 )
 
 /**
@@ -42,6 +47,12 @@ data class VideoFrameData(
 interface NdiFrameCallback {
     fun onVideoFrame(frame: VideoFrameData)
     fun onConnectionLost()
+
+    /**
+     * A subscribed metadata element arrived (see [NdiReceiver.setMetadataSubscriptions]).
+     * Called on the receive thread, after the video frame captured with it.
+     */
+    fun onMetadata(event: NdiNative.MetadataEvent) {}
 }
 
 /**
@@ -60,6 +71,37 @@ class NdiReceiver {
         private const val THREAD_JOIN_TIMEOUT_MS = 3000L
         private const val SYNC_JOIN_TIMEOUT_MS = 500L // Short timeout for sync disconnect
         private const val CONNECTION_LOST_THRESHOLD = 5
+        private const val STATS_LOG_INTERVAL_MS = 10_000L
+        private const val BANDWIDTH_SAMPLE_INTERVAL_MS = 1000L
+        private const val PREROLL_TIMEOUT_MS = 5000L
+
+        private const val RECEIVER_NAME = "Android NDI Receiver"
+
+        /** Tally echo, sender capabilities and PTZ feedback. */
+        val DEFAULT_METADATA_SUBSCRIPTIONS = listOf("ndi_tally_echo", "ndi_capabilities", "ntk_ptz*")
+
+        /**
+         * Create an unconnected native receiver the way [connect] does (also used for the
+         * [NdiWarmup] standby). Returns 0 on failure.
+         */
+        internal fun createNativeReceiver(
+            colorFormat: Int,
+            bandwidth: Int = NdiNative.Bandwidth.HIGHEST
+        ): Long = NdiNative.receiverCreate(
+            receiverName = RECEIVER_NAME,
+            bandwidth = bandwidth,
+            colorFormat = colorFormat,
+            allowVideoFields = true
+        )
+
+        /**
+         * NDI name a relay of [sourceName] is advertised under: the stream part of
+         * "MACHINE (stream)" plus " relay". The SDK prefixes it with this device's name.
+         */
+        fun relaySourceName(sourceName: String): String {
+            val stream = sourceName.substringAfter(" (", "").removeSuffix(")").ifEmpty { sourceName }
+            return "$stream relay"
+        }
     }
 
     // Use AtomicLong for thread-safe access to receiver pointer
@@ -74,6 +116,17 @@ class NdiReceiver {
     // Prevent concurrent cleanup operations
     private val cleanupInProgress = AtomicBoolean(false)
 
+    // Adaptive bandwidth: the controller, the receiver being pre-rolled for a switch and the one
+    // a switch replaced (destroyed a sample later, once calls other threads made on it are done).
+    // Switching runs on the receive thread; cleanup() may take any of them from another thread.
+    private val bandwidthPtrAtomic = AtomicLong(0)
+    private val prerollPtrAtomic = AtomicLong(0)
+    private val retiredPtrAtomic = AtomicLong(0)
+    private var prerollBandwidth = NdiNative.Bandwidth.HIGHEST
+    private var prerollDeadlineMs = 0L
+    private var lastVideoFramesTotal = 0L
+    private var lastVideoFramesDropped = 0L
+
     // Tracking for connection lost detection - prevents false positives
     @Volatile
     private var hasReceivedFrame = false
@@ -86,6 +139,64 @@ class NdiReceiver {
     private var frameCallback: NdiFrameCallback? = null
     private var connectedSourceName: String? = null
 
+    /**
+     * Receive color format negotiated for the current connection.
+     */
+    @Volatile
+    var colorFormatChoice: ColorFormatChoice? = null
+        private set
+
+    /**
+     * [NdiNative.DeinterlaceMode] applied to every receiver this instance creates.
+     */
+    @Volatile
+    var deinterlaceMode: Int = NdiNative.DeinterlaceMode.MOTION_ADAPTIVE
+        private set
+
+    /**
+     * Jitter buffer latency budget applied to every receiver this instance creates.
+     */
+    @Volatile
+    var targetLatencyMs: Int = 0
+        private set
+
+    /**
+     * Latest-frame-wins capture applied to every receiver this instance creates.
+     */
+    @Volatile
+    var lowLatency: Boolean = false
+        private set
+
+    /**
+     * Metadata elements delivered to [NdiFrameCallback.onMetadata] for every receiver this
+     * instance creates.
+     */
+    @Volatile
+    var metadataSubscriptions: List<String> = DEFAULT_METADATA_SUBSCRIPTIONS
+        private set
+
+    /**
+     * Switch between the source's highest and lowest streams as the link and the decoder keep up
+     * (see [setAdaptiveBandwidth]).
+     */
+    @Volatile
+    var adaptiveBandwidth: Boolean = true
+        private set
+
+    /**
+     * Frames waiting downstream of the receiver (decoder input queue or renderer), sampled by
+     * the adaptive bandwidth controller.
+     */
+    @Volatile
+    private var backlogProvider: (() -> Int)? = null
+
+    /**
+     * Republish the connected stream for other receivers (see [setRelayEnabled]).
+     */
+    @Volatile
+    var relayEnabled: Boolean = false
+        private set
+
     /**
      * Set the callback for receiving video frames.
      */
@@ -95,9 +206,18 @@ class NdiReceiver {
 
     /**
      * Connect to an NDI source and start receiving frames.
+     *
+     * @param consumers frame consumers active for this connection; used to negotiate the
+     *                  receive color format that needs the fewest conversions
+     * @param preserveHighBitDepth request 16-bit P216/PA16 from high bit depth senders (for 10-bit recording)
      */
-    suspend fun connect(source: NdiSource) = withContext(Dispatchers.IO) {
-        if (!NdiManager.isInitialized()) {
+    suspend fun connect(
+        source: NdiSource,
+        consumers: Set<FrameConsumer> = setOf(FrameConsumer.DISPLAY),
+        preserveHighBitDepth: Boolean = false
+    ) = withContext(Dispatchers.IO) {
+        // The SDK may still be loading in the background right after app start
+        if (!NdiManager.awaitInitialized()) {
             _connectionState.value = ConnectionState.Error("NDI SDK not initialized")
             return@withContext
         }
@@ -114,28 +234,40 @@ class NdiReceiver {
         consecutiveNullFrames = 0
 
         try {
-            // Create receiver
-            val newPtr = NdiNative.receiverCreate(
-                receiverName = "Android NDI Receiver",
-                bandwidth = NdiNative.Bandwidth.HIGHEST,
-                colorFormat = NdiNative.ColorFormat.BGRX_BGRA,
-                allowVideoFields = true
-            )
+            val choice = ColorFormatNegotiator.negotiate(consumers, preserveHighBitDepth)
+            colorFormatChoice = choice
+            Log.d(TAG, "Negotiated color format for $consumers: ${choice.label}")
+
+            // Use the warm standby receiver when its format fits, so only the connect remains
+            val standbyPtr = NdiWarmup.takeStandbyReceiver(choice.colorFormat)
+            val newPtr = if (standbyPtr != 0L) standbyPtr else createNativeReceiver(choice.colorFormat)
 
             if (newPtr == 0L) {
                 _connectionState.value = ConnectionState.Error("Failed to create receiver")
                 return@withContext
             }
-            
+            TimeToFirstFrame.setWarmReceiver(standbyPtr != 0L)
+            TimeToFirstFrame.mark(TimeToFirstFrame.Phase.RECEIVER_READY)
+
             receiverPtrAtomic.set(newPtr)
+            applyReceiverSettings(newPtr)
+            lastVideoFramesTotal = 0
+            lastVideoFramesDropped = 0
+            if (adaptiveBandwidth) {
+                bandwidthPtrAtomic.set(NdiNative.bandwidthCreate())
+            }
 
             // Connect to the source
             val connected = NdiNative.receiverConnect(newPtr, source.name)
             if (!connected) {
                 Log.w(TAG, "receiverConnect returned false, continuing anyway")
             }
+            TimeToFirstFrame.mark(TimeToFirstFrame.Phase.CONNECTED)
 
             connectedSourceName = source.name
+            if (relayEnabled) {
+                startRelay(newPtr, source.name)
+            }
             _connectionState.value = ConnectionState.Connected(source)
             Log.i(TAG, "Connected to NDI source: ${source.name}")
 
@@ -156,6 +288,9 @@ class NdiReceiver {
 
         receiveThread = Thread({
             Log.d(TAG, "Receive loop started")
+            NdiNative.threadPlacementApply(NdiNative.ThreadRole.RECEIVE)
+            var nextStatsLogMs = SystemClock.elapsedRealtime() + STATS_LOG_INTERVAL_MS
+            var nextBandwidthSampleMs = SystemClock.elapsedRealtime() + BANDWIDTH_SAMPLE_INTERVAL_MS
 
             while (isReceiving) {
                 val ptr = receiverPtrAtomic.get()
@@ -169,6 +304,9 @@ class NdiReceiver {
                     val videoFrame = NdiNative.receiverCaptureVideo(ptr, RECEIVE_TIMEOUT_MS)
 
                     if (videoFrame != null) {
+                        if (!hasReceivedFrame) {
+                            TimeToFirstFrame.mark(TimeToFirstFrame.Phase.FIRST_CAPTURE)
+                        }
                         // Reset connection lost tracking - we're receiving frames
                         hasReceivedFrame = true
                         consecutiveNullFrames = 0
@@ -187,7 +325,8 @@ class NdiReceiver {
                             lineStrideBytes = videoFrame.lineStrideBytes,
                             timestamp = videoFrame.timestamp,
                             fourCC = fourCC,
-                            isCompressed = isCompressed
+                            isCompressed = isCompressed,
+                            captureNs = videoFrame.captureNs
                         )
 
                         frameCallback?.onVideoFrame(frameData)
@@ -216,6 +355,21 @@ class NdiReceiver {
                         }
                     }
 
+                    // Metadata was captured natively with the video; deliver what it queued.
+                    dispatchMetadata()
+
+                    val nowMs = SystemClock.elapsedRealtime()
+                    if (nowMs >= nextStatsLogMs) {
+                        nextStatsLogMs = nowMs + STATS_LOG_INTERVAL_MS
+                        NdiNative.receiverGetStats(ptr)?.let { logStats(it, getBandwidthStats()) }
+                    }
+                    if (prerollPtrAtomic.get() != 0L) {
+                        continuePreroll(ptr, nowMs)
+                    } else if (nowMs >= nextBandwidthSampleMs) {
+                        nextBandwidthSampleMs = nowMs + BANDWIDTH_SAMPLE_INTERVAL_MS
+                        sampleBandwidth(ptr, nowMs)
+                    }
+
                 } catch (e: Exception) {
                     if (isReceiving) {
                         Log.e(TAG, "Error in receive loop", e)
@@ -223,12 +377,122 @@ class NdiReceiver {
                 }
             }
 
+            NdiNative.threadPlacementRelease()
             Log.d(TAG, "Receive loop ended")
         }, "NDI-Receive-Thread")
 
         receiveThread?.start()
     }
 
+    /**
+     * Apply the settings kept by this instance to a native receiver it created.
+     */
+    private fun applyReceiverSettings(ptr: Long) {
+        NdiNative.receiverSetDeinterlaceMode(ptr, deinterlaceMode)
+        NdiNative.receiverSetTargetLatency(ptr, targetLatencyMs)
+        NdiNative.receiverSetLowLatency(ptr, lowLatency)
+        NdiNative.receiverSetMetadataSubscriptions(ptr, metadataSubscriptions.toTypedArray())
+    }
+
+    /**
+     * Feed the bandwidth controller one sample of the current receiver, and start pre-rolling
+     * the other stream when it asks for a switch. Receive thread only.
+     */
+    private fun sampleBandwidth(ptr: Long, nowMs: Long) {
+        // The receiver replaced by the last switch has had a whole interval to finish its calls
+        retiredPtrAtomic.getAndSet(0).takeIf { it != 0L }?.let { NdiNative.receiverDestroy(it) }
+
+        val controller = bandwidthPtrAtomic.get()
+        if (controller == 0L) return
+        val performance = NdiNative.receiverGetPerformance(ptr) ?: return
+        val queueMax = NdiNative.receiverGetStats(ptr)?.queueVideoMax ?: 0
+        val frames = performance.videoFramesTotal - lastVideoFramesTotal
+        val dropped = performance.videoFramesDropped - lastVideoFramesDropped
+        lastVideoFramesTotal = performance.videoFramesTotal
+        lastVideoFramesDropped = performance.videoFramesDropped
+
+        val backlog = backlogProvider?.invoke() ?: 0
+        val target = NdiNative.bandwidthUpdate(controller, frames, dropped, queueMax, backlog, System.nanoTime())
+        if (target >= 0) {
+            startPreroll(controller, target, nowMs)
+        }
+    }
+
+    /**
+     * Connect a second receiver to the current source at [bandwidth]. It replaces the current
+     * one once it holds a frame to start on (see [continuePreroll]).
+     */
+    private fun startPreroll(controller: Long, bandwidth: Int, nowMs: Long) {
+        val sourceName = connectedSourceName
+        val colorFormat = colorFormatChoice?.colorFormat
+        val newPtr = if (sourceName != null && colorFormat != null) {
+            createNativeReceiver(colorFormat, bandwidth)
+        } else 0L
+        if (sourceName == null || newPtr == 0L) {
+            Log.w(TAG, "Bandwidth switch abandoned: could not create receiver")
+            NdiNative.bandwidthSwitched(controller, false, System.nanoTime())
+            return
+        }
+        applyReceiverSettings(newPtr)
+        NdiNative.receiverConnect(newPtr, sourceName)
+        prerollBandwidth = bandwidth
+        prerollDeadlineMs = nowMs + PREROLL_TIMEOUT_MS
+        prerollPtrAtomic.set(newPtr)
+        Log.i(TAG, "Pre-rolling ${bandwidthName(bandwidth)} stream of $sourceName")
+    }
+
+    /**
+     * Swap in the pre-rolled receiver once it holds a frame to start on, so the next capture
+     * comes from the new stream without a gap; give up at the deadline. Receive thread only.
+     */
+    private fun continuePreroll(currentPtr: Long, nowMs: Long) {
+        val newPtr = prerollPtrAtomic.get()
+        val controller = bandwidthPtrAtomic.get()
+        if (newPtr == 0L || controller == 0L) return
+
+        if (!NdiNative.receiverPreroll(newPtr, 0)) {
+            if (nowMs >= prerollDeadlineMs && prerollPtrAtomic.compareAndSet(newPtr, 0)) {
+                NdiNative.receiverDestroy(newPtr)
+                NdiNative.bandwidthSwitched(controller, false, System.nanoTime())
+                Log.w(TAG, "Bandwidth switch abandoned: ${bandwidthName(prerollBandwidth)} stream did not start in time")
+            }
+            return
+        }
+
+        if (!prerollPtrAtomic.compareAndSet(newPtr, 0)) return   // Taken by cleanup()
+        if (!receiverPtrAtomic.compareAndSet(currentPtr, newPtr)) {
+            // Disconnected meanwhile
+            NdiNative.receiverDestroy(newPtr)
+            return
+        }
+        if (relayEnabled) {
+            NdiNative.receiverStopRelay(currentPtr)
+            connectedSourceName?.let { startRelay(newPtr, it) }
+        }
+        NdiNative.receiverDisconnect(currentPtr)
+        retiredPtrAtomic.getAndSet(currentPtr).takeIf { it != 0L }?.let { NdiNative.receiverDestroy(it) }
+        lastVideoFramesTotal = 0
+        lastVideoFramesDropped = 0
+        NdiNative.bandwidthSwitched(controller, true, System.nanoTime())
+        Log.i(TAG, "Switched to ${bandwidthName(prerollBandwidth)} stream")
+    }
+
+    private fun bandwidthName(bandwidth: Int): String =
+        if (bandwidth == NdiNative.Bandwidth.LOWEST) "lowest" else "highest"
+
+    /**
+     * Deliver the metadata events queued by the native receiver to the frame callback.
+     */
+    private fun dispatchMetadata() {
+        val ptr = receiverPtrAtomic.get()
+        if (ptr == 0L) return
+        val events = NdiNative.receiverPollMetadata(ptr) ?: return
+        val callback = frameCallback ?: return
+        for (event in events) {
+            callback.onMetadata(event)
+        }
+    }
+
     /**
      * Set an Android Surface for hardware-accelerated video rendering.
      */
@@ -312,11 +576,19 @@ class NdiReceiver {
         }
         
         try {
+            // Receivers of a bandwidth switch in progress or just completed go first
+            prerollPtrAtomic.getAndSet(0).takeIf { it != 0L }?.let { NdiNative.receiverDestroy(it) }
+            retiredPtrAtomic.getAndSet(0).takeIf { it != 0L }?.let { NdiNative.receiverDestroy(it) }
+            bandwidthPtrAtomic.getAndSet(0).takeIf { it != 0L }?.let { NdiNative.bandwidthDestroy(it) }
+
             // Atomically get and clear the pointer
             val ptr = receiverPtrAtomic.getAndSet(0)
             if (ptr != 0L) {
                 Log.d(TAG, "Destroying NDI receiver")
                 NdiNative.receiverDestroy(ptr)
+                // Give cached frame buffers back while nothing is streaming.
+                NdiNative.arenaTrim()
+                NdiWarmup.onReceiverReleased()
             }
         } catch (e: Exception) {
             Log.e(TAG, "Error during cleanup", e)
@@ -325,6 +597,169 @@ class NdiReceiver {
         }
     }
 
+    /**
+     * Select the [NdiNative.DeinterlaceMode] for interlaced sources. Applies immediately when
+     * connected and is kept for later connections.
+     */
+    fun setDeinterlaceMode(mode: Int) {
+        deinterlaceMode = mode
+        val ptr = receiverPtrAtomic.get()
+        if (ptr != 0L) {
+            NdiNative.receiverSetDeinterlaceMode(ptr, mode)
+        }
+    }
+
+    /**
+     * Set the video jitter buffer latency budget (0-[NdiNative.MAX_TARGET_LATENCY_MS] ms). Applies
+     * immediately when connected and is kept for later connections.
+     */
+    fun setTargetLatency(latencyMs: Int) {
+        targetLatencyMs = latencyMs.coerceIn(0, NdiNative.MAX_TARGET_LATENCY_MS)
+        val ptr = receiverPtrAtomic.get()
+        if (ptr != 0L) {
+            NdiNative.receiverSetTargetLatency(ptr, targetLatencyMs)
+        }
+    }
+
+    /**
+     * Enable latest-frame-wins capture: when frames queue up in the SDK, stale ones are
+     * skipped instead of all being shown late. Applies immediately when connected and is kept
+     * for later connections.
+     */
+    fun setLowLatency(enabled: Boolean) {
+        lowLatency = enabled
+        val ptr = receiverPtrAtomic.get()
+        if (ptr != 0L) {
+            NdiNative.receiverSetLowLatency(ptr, enabled)
+        }
+    }
+
+    /**
+     * Select the metadata elements delivered to [NdiFrameCallback.onMetadata] (names ending in
+     * '*' match by prefix). Applies immediately when connected and is kept for later connections.
+     *
+     * @return false if the native receiver rejected the list
+     */
+    fun setMetadataSubscriptions(elements: List<String>): Boolean {
+        metadataSubscriptions = elements.take(NdiNative.MAX_METADATA_SUBSCRIPTIONS)
+        val ptr = receiverPtrAtomic.get()
+        if (ptr != 0L) {
+            return NdiNative.receiverSetMetadataSubscriptions(ptr, metadataSubscriptions.toTypedArray())
+        }
+        return true
+    }
+
+    /**
+     * Republish the connected stream as a local NDI source named after it (see
+     * [relaySourceName]), so other devices can receive it from here instead of loading the
+     * sender's link. Applies immediately when connected and is kept for later connections.
+     * The source only appears once the stream delivers uncompressed video: compressed (HX)
+     * streams cannot be relayed (see [NdiNative.RelayStats.compressed]).
+     */
+    fun setRelayEnabled(enabled: Boolean) {
+        relayEnabled = enabled
+        val ptr = receiverPtrAtomic.get()
+        val sourceName = connectedSourceName
+        if (ptr != 0L && sourceName != null) {
+            if (enabled) {
+                startRelay(ptr, sourceName)
+            } else {
+                NdiNative.receiverStopRelay(ptr)
+            }
+        }
+    }
+
+    /**
+     * Let the receiver switch between the source's highest and lowest streams: down when frames
+     * are dropped or back up in the SDK queue or downstream, up again once the link has been
+     * healthy for a while. Applies from the next connection, which starts at the highest stream.
+     */
+    fun setAdaptiveBandwidth(enabled: Boolean) {
+        adaptiveBandwidth = enabled
+    }
+
+    /**
+     * Set where the adaptive bandwidth controller reads the number of frames waiting
+     * downstream (decoder input queue or renderer). Called on the receive thread.
+     */
+    fun setBacklogProvider(provider: (() -> Int)?) {
+        backlogProvider = provider
+    }
+
+    /**
+     * Get the adaptive bandwidth level and decisions, or null when it is not enabled.
+     */
+    fun getBandwidthStats(): NdiNative.BandwidthStats? {
+        val ptr = bandwidthPtrAtomic.get()
+        if (ptr == 0L) return null
+        return NdiNative.bandwidthGetStats(ptr)
+    }
+
+    private fun startRelay(ptr: Long, sourceName: String) {
+        val relayName = relaySourceName(sourceName)
+        if (NdiNative.receiverStartRelay(ptr, relayName)) {
+            Log.i(TAG, "Relaying $sourceName as $relayName once it sends uncompressed video")
+        } else {
+            Log.w(TAG, "Failed to start relay for $sourceName")
+        }
+    }
+
+    /**
+     * Get relay counters, or null when not relaying.
+     */
+    fun getRelayStats(): NdiNative.RelayStats? {
+        val ptr = receiverPtrAtomic.get()
+        if (ptr == 0L) return null
+        return NdiNative.receiverGetRelayStats(ptr)
+    }
+
+    /**
+     * Get rolling-window stream statistics (frame rate, bitrate, jitter, queue depths).
+     */
+    fun getStats(): NdiNative.ReceiverStats? {
+        val ptr = receiverPtrAtomic.get()
+        if (ptr == 0L) return null
+        return NdiNative.receiverGetStats(ptr)
+    }
+
+    private fun logStats(stats: NdiNative.ReceiverStats, bandwidth: NdiNative.BandwidthStats?) {
+        val bandwidthStr = bandwidth
+            ?.let {
+                ", bandwidth %s (down %d, up %d, failed %d, last %s)".format(
+                    bandwidthName(it.bandwidth), it.downgrades, it.upgrades, it.failedSwitches,
+                    NdiNative.BandwidthReason.NAMES.getOrElse(it.lastReason) { "?" }
+                )
+            }
+            ?: ""
+        Log.d(
+            TAG,
+            "Stream: %.2f fps, %d kbps, interval %.1f/%.1f ms (jitter %.1f ms), capture %.1f/%.1f ms, queue v%d/%d a%d m%d, connections %d%s".format(
+                stats.fps,
+                stats.bitrateBps / 1000,
+                stats.intervalAvgNs / 1e6,
+                stats.intervalMaxNs / 1e6,
+                stats.jitterNs / 1e6,
+                stats.captureAvgNs / 1e6,
+                stats.captureMaxNs / 1e6,
+                stats.queueVideo,
+                stats.queueVideoMax,
+                stats.queueAudioMax,
+                stats.queueMetadataMax,
+                stats.connections,
+                bandwidthStr
+            )
+        )
+    }
+
+    /**
+     * Get receiver performance counters, including the negotiated color format and last FourCC.
+     */
+    fun getPerformance(): NdiNative.ReceiverPerformance? {
+        val ptr = receiverPtrAtomic.get()
+        if (ptr == 0L) return null
+        return NdiNative.receiverGetPerformance(ptr)
+    }
+
     /**
      * Check if currently connected.
      */
@@ -9,7 +9,7 @@ object NdiSourceRepository {
 
     /**
      * Currently discovered NDI sources.
-     * Updated by MainViewModel when discovery finds sources.
+     * Updated by NdiWarmup when discovery finds sources.
      */
     private var discoveredSources: List<NdiSource> = emptyList()
 
@@ -0,0 +1,156 @@
+package com.example.ndireceiver.ndi
+
+import android.content.Context
+import android.util.Log
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withContext
+import java.io.File
+
+/**
+ * Transport selection (TCP, RUDP or multicast) and benchmarking.
+ *
+ * The SDK reads its transport settings from a configuration file when it initializes, for all
+ * receivers at once, so the selected [NdiNative.Transport] is written by [NdiManager] just
+ * before initialization. [benchmark] re-initializes the SDK once per transport to probe it and
+ * restores the selection afterwards; run it from settings, not while playing. The SDK cannot be
+ * destroyed while a receiver is open, so the benchmark stops when it finds one.
+ */
+object NdiTransport {
+    private const val TAG = "NdiTransport"
+    private const val CONFIG_DIR = "ndi"
+
+    const val DEFAULT_MULTICAST_PREFIX = "239.255.0.0"
+    const val DEFAULT_MULTICAST_MASK = "255.255.0.0"
+    const val DEFAULT_MULTICAST_TTL = 1
+
+    /** Measuring time per transport in [benchmark]. */
+    const val PROBE_DURATION_MS = 5000
+
+    /** Share of lost frames up to which a transport counts as reliable in [recommend]. */
+    const val MAX_RELIABLE_LOSS_RATE = 0.001
+
+    /** Transports [benchmark] probes, least airtime per receiver first. */
+    val BENCHMARK_ORDER = listOf(
+        NdiNative.Transport.MULTICAST,
+        NdiNative.Transport.RUDP,
+        NdiNative.Transport.TCP
+    )
+
+    /**
+     * One transport's probe.
+     *
+     * @property mode [NdiNative.Transport] value
+     * @property result measurements, or null if the SDK or probe failed with this transport
+     */
+    data class BenchmarkEntry(
+        val mode: Int,
+        val result: NdiNative.TransportProbeResult?
+    )
+
+    @Volatile
+    private var configDir: File? = null
+
+    @Volatile
+    private var mode = NdiNative.Transport.AUTO
+
+    /** Transport being probed by [benchmark], applied instead of [mode]. */
+    @Volatile
+    private var probing: Int? = null
+
+    private val benchmarkMutex = Mutex()
+
+    /**
+     * Select the transport used from the next SDK initialization on. Call before
+     * [NdiWarmup.start] at application start, and again when the setting changes.
+     */
+    fun configure(context: Context, transport: Int) {
+        configDir = File(context.filesDir, CONFIG_DIR)
+        mode = transport
+        // Before initialization NdiManager writes it; afterwards it applies from the next one
+        if (NdiManager.isInitialized()) {
+            apply(transport)
+        }
+    }
+
+    /**
+     * Write the configured transport for the SDK. Called by [NdiManager] before initializing.
+     */
+    internal fun applyConfigured(): Boolean = configDir == null || apply(probing ?: mode)
+
+    private fun apply(transport: Int): Boolean {
+        val dir = configDir ?: return false
+        if (!dir.isDirectory && !dir.mkdirs()) {
+            Log.e(TAG, "Cannot create ${dir.path}")
+            return false
+        }
+        val ok = NdiNative.setTransportProfile(
+            dir.path,
+            transport,
+            DEFAULT_MULTICAST_PREFIX,
+            DEFAULT_MULTICAST_MASK,
+            DEFAULT_MULTICAST_TTL
+        )
+        if (!ok) {
+            Log.e(TAG, "Failed to apply transport $transport")
+        }
+        return ok
+    }
+
+    /**
+     * Probe each transport in [BENCHMARK_ORDER] for [durationMs] against [sourceName] (null for
+     * a loopback source on this device, which only exercises the local stack). Discovery, the
+     * standby receiver and source previews are stopped meanwhile, and the SDK is left
+     * initialized with the configured transport.
+     *
+     * @return one entry per transport probed, which stops early (with none at all if it could
+     *         not start) when another receiver keeps the SDK from being destroyed
+     */
+    suspend fun benchmark(
+        sourceName: String?,
+        durationMs: Int = PROBE_DURATION_MS
+    ): List<BenchmarkEntry> = withContext(Dispatchers.IO) {
+        benchmarkMutex.withLock {
+            NdiWarmup.shutdownAndJoin()
+            SourcePreviews.stopAndJoin()
+            try {
+                val entries = mutableListOf<BenchmarkEntry>()
+                if (!NdiManager.destroy()) {
+                    Log.w(TAG, "NDI SDK in use, benchmark not run")
+                    return@withLock entries
+                }
+                for (candidate in BENCHMARK_ORDER) {
+                    probing = candidate
+                    val result = if (NdiManager.initialize()) {
+                        NdiNative.transportProbe(sourceName, durationMs)
+                    } else {
+                        null
+                    }
+                    Log.i(TAG, "Transport $candidate: $result")
+                    entries += BenchmarkEntry(candidate, result)
+                    if (!NdiManager.destroy()) {
+                        Log.w(TAG, "NDI SDK in use, benchmark stopped after transport $candidate")
+                        break
+                    }
+                }
+                entries
+            } finally {
+                probing = null
+                NdiManager.initialize()
+                NdiWarmup.start()
+            }
+        }
+    }
+
+    /**
+     * The cheapest reliable transport in [entries]: the first (in [BENCHMARK_ORDER]) that
+     * received frames and lost at most [MAX_RELIABLE_LOSS_RATE] of them, else the one that
+     * lost the fewest. Null if none received anything.
+     */
+    fun recommend(entries: List<BenchmarkEntry>): Int? {
+        val measured = entries.filter { (it.result?.frames ?: 0L) > 0L }
+        return (measured.firstOrNull { it.result!!.lossRate <= MAX_RELIABLE_LOSS_RATE }
+            ?: measured.minByOrNull { it.result!!.lossRate })?.mode
+    }
+}
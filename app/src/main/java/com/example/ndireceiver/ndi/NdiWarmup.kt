@@ -0,0 +1,194 @@
+package com.example.ndireceiver.ndi
+
+import android.os.SystemClock
+import android.util.Log
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.flow.catch
+import kotlinx.coroutines.launch
+
+/**
+ * Warms the NDI pipeline up from process start so the first connection is fast.
+ *
+ * [start] initializes the SDK off the main thread, then starts source discovery, which keeps
+ * running for the life of the process, and creates a standby receiver that is not yet
+ * connected. [NdiReceiver.connect] takes the standby with [takeStandbyReceiver], so selecting a
+ * source only has to connect it. A new standby is prepared when a connection's receiver is
+ * released, not while it is streaming.
+ */
+object NdiWarmup {
+    private const val TAG = "NdiWarmup"
+
+    private val scope = CoroutineScope(SupervisorJob() + Dispatchers.IO)
+
+    private val _sources = MutableStateFlow<List<NdiSource>?>(null)
+
+    /**
+     * Sources found by the warm-up finder; before the first discovery result, the cached ones
+     * (see [SourceCache]), or null if there are none.
+     */
+    val sources: StateFlow<List<NdiSource>?> = _sources.asStateFlow()
+
+    private val _error = MutableStateFlow<String?>(null)
+
+    /** Why the SDK or discovery is unavailable, or null. */
+    val error: StateFlow<String?> = _error.asStateFlow()
+
+    private var finder: NdiFinder? = null
+    private var discoveryJob: Job? = null
+
+    private val standbyLock = Any()
+    private var standbyPtr = 0L
+    private var standbyColorFormat = 0
+    private var standbyPreparing = false
+
+    @Volatile
+    private var started = false
+
+    /**
+     * Start warming up. Call once at application start; later calls do nothing.
+     */
+    @Synchronized
+    fun start() {
+        if (started) return
+        started = true
+
+        // Sources from earlier runs, listed until discovery reports what is there now
+        val cached = SourceCache.sources()
+        if (cached.isNotEmpty()) {
+            NdiSourceRepository.updateDiscoveredSources(cached)
+            _sources.value = cached
+        }
+
+        NdiManager.initializeAsync()
+        scope.launch {
+            if (!NdiManager.awaitInitialized()) {
+                _error.value = "NDI unavailable: ${NdiManager.lastError ?: "NDI SDK not initialized"}"
+                return@launch
+            }
+            startDiscovery()
+            prepareStandby()
+        }
+    }
+
+    /**
+     * Restart discovery from scratch (the user asked for a refresh).
+     */
+    @Synchronized
+    fun restartDiscovery() {
+        if (!NdiManager.isInitialized()) return
+        stopDiscovery()
+        _sources.value = null
+        startDiscovery()
+    }
+
+    /**
+     * Hand over the standby receiver if it was created with [colorFormat]. The caller owns the
+     * returned pointer.
+     *
+     * @return native receiver pointer, or 0 if no matching standby is ready
+     */
+    fun takeStandbyReceiver(colorFormat: Int): Long {
+        synchronized(standbyLock) {
+            if (standbyPtr == 0L || standbyColorFormat != colorFormat) return 0L
+            val ptr = standbyPtr
+            standbyPtr = 0L
+            return ptr
+        }
+    }
+
+    /**
+     * A connection's receiver was destroyed: prepare the standby for the next one.
+     */
+    fun onReceiverReleased() {
+        if (!started) return
+        scope.launch { prepareStandby() }
+    }
+
+    /**
+     * Stop discovery and destroy the standby receiver. Call before [NdiManager.destroy].
+     */
+    @Synchronized
+    fun shutdown() {
+        stopDiscovery()
+        val ptr = synchronized(standbyLock) {
+            standbyPtr.also { standbyPtr = 0L }
+        }
+        if (ptr != 0L) {
+            NdiNative.receiverDestroy(ptr)
+        }
+        started = false
+    }
+
+    /**
+     * [shutdown], and wait until discovery and standby preparation in progress have finished,
+     * so none of their finders or receivers is left.
+     */
+    suspend fun shutdownAndJoin() {
+        shutdown()
+        scope.coroutineContext[Job]?.children?.forEach { it.join() }
+    }
+
+    @Synchronized
+    private fun startDiscovery() {
+        val newFinder = NdiFinder()
+        finder = newFinder
+        discoveryJob = scope.launch {
+            newFinder.startDiscovery()
+                .catch { e -> _error.value = e.message ?: "Discovery failed" }
+                .collect { found ->
+                    // Kept in the repository so PlayerFragment can resolve sources by name
+                    NdiSourceRepository.updateDiscoveredSources(found)
+                    _error.value = null
+                    _sources.value = found
+                }
+        }
+    }
+
+    @Synchronized
+    private fun stopDiscovery() {
+        discoveryJob?.cancel()
+        discoveryJob = null
+        finder?.stopDiscovery()
+        finder = null
+    }
+
+    /**
+     * Create the standby receiver if there is none. It uses the format a display-only
+     * connection negotiates, which is what connections use unless recording is on.
+     */
+    private fun prepareStandby() {
+        if (!NdiManager.isInitialized()) return
+        synchronized(standbyLock) {
+            if (standbyPtr != 0L || standbyPreparing) return
+            standbyPreparing = true
+        }
+
+        val colorFormat = ColorFormatNegotiator.negotiate(setOf(FrameConsumer.DISPLAY)).colorFormat
+        val startNs = SystemClock.elapsedRealtimeNanos()
+        var ptr = NdiReceiver.createNativeReceiver(colorFormat)
+        val elapsedMs = (SystemClock.elapsedRealtimeNanos() - startNs) / 1_000_000
+
+        synchronized(standbyLock) {
+            standbyPreparing = false
+            if (ptr != 0L && started && standbyPtr == 0L) {
+                standbyPtr = ptr
+                standbyColorFormat = colorFormat
+                ptr = 0L
+            }
+        }
+        if (ptr != 0L) {
+            // Shut down while it was being created
+            NdiNative.receiverDestroy(ptr)
+        } else if (standbyPtr != 0L) {
+            Log.d(TAG, "Standby receiver ready in $elapsedMs ms")
+        } else {
+            Log.w(TAG, "Failed to create standby receiver")
+        }
+    }
+}
@@ -0,0 +1,43 @@
+package com.example.ndireceiver.ndi
+
+import android.content.Context
+import android.util.Log
+import java.io.File
+
+/**
+ * Sources seen or connected to by earlier runs, kept in a small memory-mapped file in the
+ * app's files directory (see [NdiNative.sourceCacheOpen]).
+ *
+ * The list can be shown before discovery has found anything, and [NdiNative.receiverConnect]
+ * uses a cached source's URL address so reconnecting skips name resolution. Discovery and
+ * receivers keep the file current natively; nothing here writes to it.
+ */
+object SourceCache {
+    private const val TAG = "SourceCache"
+    private const val FILE_NAME = "ndi_sources.cache"
+
+    @Volatile
+    private var opened = false
+
+    /**
+     * Open the cache. Call at application start, before [NdiWarmup.start].
+     */
+    fun open(context: Context): Boolean {
+        if (opened) return true
+        opened = NdiNative.sourceCacheOpen(File(context.filesDir, FILE_NAME).path)
+        if (!opened) {
+            Log.w(TAG, "Source cache unavailable; sources will be listed once discovered")
+        }
+        return opened
+    }
+
+    /**
+     * Cached sources, most recently connected first; empty if the cache is not open.
+     */
+    fun sources(): List<NdiSource> {
+        if (!opened) return emptyList()
+        return NdiNative.sourceCacheGetSources()
+            ?.map { NdiSource(name = it.name, url = it.url) }
+            ?: emptyList()
+    }
+}
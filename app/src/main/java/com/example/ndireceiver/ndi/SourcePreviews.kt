@@ -0,0 +1,187 @@
+package com.example.ndireceiver.ndi
+
+import android.graphics.Bitmap
+import android.os.Process
+import android.os.SystemClock
+import android.util.Log
+import android.util.LruCache
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.asCoroutineDispatcher
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import java.util.concurrent.Executors
+
+/**
+ * Live preview thumbnails for the source list.
+ *
+ * The sources on screen ([setVisibleSources]) are previewed from their lowest-bandwidth stream
+ * by one background-priority worker thread, which scales frames natively to
+ * [THUMBNAIL_WIDTH] x [THUMBNAIL_HEIGHT]. At most [MAX_CONNECTIONS] preview receivers are
+ * connected at once, and each thumbnail is refreshed at most every [REFRESH_INTERVAL_MS]. When
+ * more sources are visible than there are connections, a receiver is closed once its thumbnail
+ * is fresh and the connection goes to the source that has waited longest. Thumbnails are cached
+ * by source name, so a source scrolled back into view shows its last one at once.
+ *
+ * The worker only runs between [start] and [stop], while the source list is on screen, so
+ * previews never compete with a playing stream.
+ */
+object SourcePreviews {
+    private const val TAG = "SourcePreviews"
+
+    const val THUMBNAIL_WIDTH = 160
+    const val THUMBNAIL_HEIGHT = 90
+
+    /** Preview receivers connected at the same time. */
+    const val MAX_CONNECTIONS = 3
+
+    /** Minimum time between refreshes of one thumbnail. */
+    const val REFRESH_INTERVAL_MS = 2000L
+
+    /** A preview that shows nothing for this long gives its connection to the next source. */
+    private const val CONNECT_TIMEOUT_MS = 5000L
+
+    private const val CAPTURE_TIMEOUT_MS = 20
+    private const val TICK_MS = 250L
+    private const val CACHE_SIZE = 32
+
+    private val dispatcher = Executors.newSingleThreadExecutor { runnable ->
+        Thread({
+            Process.setThreadPriority(Process.THREAD_PRIORITY_BACKGROUND)
+            runnable.run()
+        }, "NDI-Preview")
+    }.asCoroutineDispatcher()
+
+    private val scope = CoroutineScope(SupervisorJob() + dispatcher)
+
+    private val cache = LruCache<String, Bitmap>(CACHE_SIZE)
+
+    private val _thumbnails = MutableStateFlow<Map<String, Bitmap>>(emptyMap())
+
+    /** Latest thumbnail per source name. */
+    val thumbnails: StateFlow<Map<String, Bitmap>> = _thumbnails.asStateFlow()
+
+    @Volatile
+    private var visibleSources: List<String> = emptyList()
+
+    private var job: Job? = null
+
+    // Worker thread only
+    private class Preview(val ptr: Long, val openedAt: Long)
+
+    private val previews = mutableMapOf<String, Preview>()
+    private val lastRefresh = mutableMapOf<String, Long>()
+    private val pixels = IntArray(THUMBNAIL_WIDTH * THUMBNAIL_HEIGHT)
+
+    /**
+     * Set the sources currently on screen, in list order. Previews of other sources close.
+     */
+    fun setVisibleSources(names: List<String>) {
+        visibleSources = names
+    }
+
+    /**
+     * Start previewing. Call when the source list comes on screen.
+     */
+    @Synchronized
+    fun start() {
+        if (job?.isActive == true) return
+        val previous = job
+        job = scope.launch {
+            // A worker being stopped closes its receivers first
+            previous?.join()
+            try {
+                while (isActive) {
+                    refresh()
+                    delay(TICK_MS)
+                }
+            } finally {
+                closeAll()
+            }
+        }
+    }
+
+    /**
+     * Stop previewing and close every preview receiver. Cached thumbnails are kept.
+     */
+    @Synchronized
+    fun stop() {
+        job?.cancel()
+    }
+
+    /**
+     * [stop], and wait until the worker has closed the preview receivers.
+     */
+    suspend fun stopAndJoin() {
+        val running = synchronized(this) { job?.also { it.cancel() } }
+        running?.join()
+    }
+
+    private fun refresh() {
+        if (!NdiManager.isInitialized()) {
+            closeAll()
+            return
+        }
+
+        val visible = visibleSources
+        previews.keys.filter { it !in visible }.forEach { close(it) }
+        lastRefresh.keys.retainAll(visible.toSet())
+
+        val now = SystemClock.elapsedRealtime()
+        for ((name, preview) in previews.toList()) {
+            if (!isDue(name, now)) continue
+            if (NdiNative.previewCapture(
+                    preview.ptr, pixels, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, CAPTURE_TIMEOUT_MS
+                )) {
+                lastRefresh[name] = now
+                publish(name)
+            } else if (name !in lastRefresh && now - preview.openedAt >= CONNECT_TIMEOUT_MS) {
+                // Offline or unreachable: let the others have the connection, retry later
+                Log.d(TAG, "No preview from $name")
+                lastRefresh[name] = now
+                close(name)
+            }
+        }
+
+        val waiting = visible
+            .filter { it !in previews && isDue(it, now) }
+            .sortedBy { lastRefresh[it] ?: 0L }
+        for (name in waiting) {
+            if (previews.size >= MAX_CONNECTIONS) {
+                // Rotate: free a connection whose thumbnail is fresh
+                val fresh = previews.keys.firstOrNull { !isDue(it, now) } ?: break
+                close(fresh)
+            }
+            val ptr = NdiNative.previewCreate(name)
+            if (ptr == 0L) {
+                lastRefresh[name] = now
+                continue
+            }
+            previews[name] = Preview(ptr, now)
+        }
+    }
+
+    private fun isDue(name: String, now: Long): Boolean {
+        val last = lastRefresh[name] ?: return true
+        return now - last >= REFRESH_INTERVAL_MS
+    }
+
+    private fun publish(name: String) {
+        val bitmap = Bitmap.createBitmap(pixels, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, Bitmap.Config.ARGB_8888)
+        cache.put(name, bitmap)
+        _thumbnails.value = cache.snapshot()
+    }
+
+    private fun close(name: String) {
+        previews.remove(name)?.let { NdiNative.previewDestroy(it.ptr) }
+    }
+
+    private fun closeAll() {
+        previews.keys.toList().forEach { close(it) }
+    }
+}
@@ -0,0 +1,122 @@
+package com.example.ndireceiver.ndi
+
+import android.os.SystemClock
+import android.util.Log
+
+/**
+ * Time-to-first-frame instrumentation, from selecting a source to its first frame on screen.
+ *
+ * An attempt starts at [begin] (the tap) and each [Phase] is stamped the first time it is
+ * [mark]ed; the attempt closes at [Phase.FIRST_DISPLAY], when the result is logged and kept for
+ * the OSD. [mark] is a single volatile read once the attempt is closed, so per-frame call sites
+ * cost nothing after the first frame.
+ */
+object TimeToFirstFrame {
+    private const val TAG = "TimeToFirstFrame"
+
+    /** An attempt left open this long (e.g. the user backed out) is replaced by [ensureBegun]. */
+    private const val STALE_ATTEMPT_NS = 10_000_000_000L
+
+    object Phase {
+        const val TAP = 0
+        const val RECEIVER_READY = 1
+        const val CONNECTED = 2
+        const val FIRST_CAPTURE = 3
+        const val FIRST_DISPLAY = 4
+        const val COUNT = 5
+
+        val NAMES = arrayOf("tap", "recv", "conn", "cap", "disp")
+    }
+
+    /**
+     * One completed attempt.
+     *
+     * @property phaseMs time from the tap to each [Phase] (-1 if a phase was not seen)
+     * @property warmReceiver the connection used the standby receiver from [NdiWarmup]
+     */
+    data class Result(
+        val phaseMs: LongArray,
+        val warmReceiver: Boolean
+    ) {
+        val totalMs: Long
+            get() = phaseMs[Phase.FIRST_DISPLAY]
+
+        override fun equals(other: Any?): Boolean {
+            if (this === other) return true
+            if (other !is Result) return false
+            return phaseMs.contentEquals(other.phaseMs) && warmReceiver == other.warmReceiver
+        }
+
+        override fun hashCode(): Int = phaseMs.contentHashCode() * 31 + warmReceiver.hashCode()
+    }
+
+    private val marksNs = LongArray(Phase.COUNT)
+    private var warmReceiver = false
+
+    @Volatile
+    private var open = false
+
+    @Volatile
+    private var last: Result? = null
+
+    /**
+     * Start a new attempt now (the user selected a source).
+     */
+    @Synchronized
+    fun begin() {
+        marksNs.fill(0L)
+        marksNs[Phase.TAP] = SystemClock.elapsedRealtimeNanos()
+        warmReceiver = false
+        open = true
+    }
+
+    /**
+     * Start an attempt unless a recent one is still open, for connections not started by a tap
+     * (retry, auto-reconnect).
+     */
+    @Synchronized
+    fun ensureBegun() {
+        if (!open || SystemClock.elapsedRealtimeNanos() - marksNs[Phase.TAP] > STALE_ATTEMPT_NS) {
+            begin()
+        }
+    }
+
+    /**
+     * Record whether the receiver for this attempt came from the warm standby.
+     */
+    @Synchronized
+    fun setWarmReceiver(warm: Boolean) {
+        if (open) warmReceiver = warm
+    }
+
+    /**
+     * Stamp [phase] of the open attempt, if not already stamped.
+     */
+    fun mark(phase: Int) {
+        if (!open) return
+        synchronized(this) {
+            if (!open || marksNs[phase] != 0L) return
+            marksNs[phase] = SystemClock.elapsedRealtimeNanos()
+            if (phase == Phase.FIRST_DISPLAY) {
+                finish()
+            }
+        }
+    }
+
+    /**
+     * The most recent completed attempt, or null if none has completed.
+     */
+    fun getLast(): Result? = last
+
+    private fun finish() {
+        open = false
+        val start = marksNs[Phase.TAP]
+        val phaseMs = LongArray(Phase.COUNT) { i ->
+            if (marksNs[i] != 0L) (marksNs[i] - start) / 1_000_000 else -1L
+        }
+        val result = Result(phaseMs, warmReceiver)
+        last = result
+        Log.i(TAG, "Time to first frame ${result.totalMs} ms (${if (warmReceiver) "warm" else "cold"} receiver): " +
+            Phase.NAMES.indices.drop(1).joinToString(" ") { "${Phase.NAMES[it]} ${phaseMs[it]}" })
+    }
+}
@@ -20,6 +20,8 @@ import androidx.recyclerview.widget.RecyclerView
 import com.example.ndireceiver.R
 import com.example.ndireceiver.ndi.NdiSource
 import com.example.ndireceiver.ndi.NdiSourceRepository
+import com.example.ndireceiver.ndi.TimeToFirstFrame
+import com.example.ndireceiver.ui.multiview.MultiviewFragment
 import com.example.ndireceiver.ui.player.PlayerFragment
 import com.example.ndireceiver.ui.recordings.RecordingsFragment
 import com.example.ndireceiver.ui.settings.SettingsFragment
@@ -38,6 +40,7 @@ class MainFragment : Fragment() {
     private lateinit var statusText: TextView
     private lateinit var progressBar: ProgressBar
     private lateinit var btnRefresh: Button
+    private lateinit var btnMultiview: Button
     private lateinit var btnRecordings: Button
     private lateinit var btnSettings: ImageButton
 
@@ -58,6 +61,7 @@ class MainFragment : Fragment() {
         statusText = view.findViewById(R.id.status_text)
         progressBar = view.findViewById(R.id.progress)
         btnRefresh = view.findViewById(R.id.btn_refresh)
+        btnMultiview = view.findViewById(R.id.btn_multiview)
         btnRecordings = view.findViewById(R.id.btn_recordings)
         btnSettings = view.findViewById(R.id.btn_settings)
 
@@ -74,7 +78,28 @@ class MainFragment : Fragment() {
         sourceList.apply {
             layoutManager = LinearLayoutManager(requireContext())
             adapter = this@MainFragment.adapter
+            // Also called when a layout pass changes which items are visible
+            addOnScrollListener(object : RecyclerView.OnScrollListener() {
+                override fun onScrolled(recyclerView: RecyclerView, dx: Int, dy: Int) {
+                    updateVisibleSources()
+                }
+            })
+        }
+    }
+
+    /**
+     * Tell the view model which sources are on screen so only those are previewed.
+     */
+    private fun updateVisibleSources() {
+        val layoutManager = sourceList.layoutManager as? LinearLayoutManager ?: return
+        val first = layoutManager.findFirstVisibleItemPosition()
+        val last = layoutManager.findLastVisibleItemPosition()
+        val visible = if (first == RecyclerView.NO_POSITION || first >= adapter.itemCount || !sourceList.isVisible) {
+            emptyList()
+        } else {
+            adapter.currentList.subList(first, minOf(last + 1, adapter.itemCount))
         }
+        viewModel.setVisibleSources(visible)
     }
 
     private fun setupButtons() {
@@ -82,6 +107,10 @@ class MainFragment : Fragment() {
             viewModel.refresh()
         }
 
+        btnMultiview.setOnClickListener {
+            navigateToMultiview(viewModel.uiState.value.sources)
+        }
+
         btnRecordings.setOnClickListener {
             navigateToRecordings()
         }
@@ -94,8 +123,15 @@ class MainFragment : Fragment() {
     private fun observeUiState() {
         viewLifecycleOwner.lifecycleScope.launch {
             viewLifecycleOwner.repeatOnLifecycle(Lifecycle.State.STARTED) {
-                viewModel.uiState.collect { state ->
-                    updateUi(state)
+                launch {
+                    viewModel.uiState.collect { state ->
+                        updateUi(state)
+                    }
+                }
+                launch {
+                    viewModel.thumbnails.collect { thumbnails ->
+                        adapter.setThumbnails(thumbnails)
+                    }
                 }
             }
         }
@@ -103,17 +139,20 @@ class MainFragment : Fragment() {
 
     private fun updateUi(state: MainUiState) {
         progressBar.isVisible = state.isLoading && state.sources.isEmpty()
+        btnMultiview.isEnabled = state.error == null && state.sources.size >= 2
 
         when {
             state.error != null -> {
                 statusText.text = state.error
                 emptyText.isVisible = true
                 sourceList.isVisible = false
+                updateVisibleSources()
             }
             state.sources.isEmpty() && !state.isLoading -> {
                 statusText.text = getString(R.string.no_sources_found)
                 emptyText.isVisible = true
                 sourceList.isVisible = false
+                updateVisibleSources()
             }
             else -> {
                 statusText.text = if (state.isLoading) {
@@ -123,7 +162,9 @@ class MainFragment : Fragment() {
                 }
                 emptyText.isVisible = false
                 sourceList.isVisible = true
-                adapter.submitList(state.sources)
+                adapter.submitList(state.sources) {
+                    sourceList.post { updateVisibleSources() }
+                }
             }
         }
     }
@@ -132,6 +173,8 @@ class MainFragment : Fragment() {
         // Store the selected source in repository so PlayerFragment can access it
         // with the full DevolaySource reference
         NdiSourceRepository.setSelectedSource(source)
+        // Time to first frame is measured from here
+        TimeToFirstFrame.begin()
 
         parentFragmentManager.commit {
             replace(R.id.fragment_container, PlayerFragment.newInstance(source))
@@ -139,6 +182,16 @@ class MainFragment : Fragment() {
         }
     }
 
+    /**
+     * Show the sources of the list side by side, as many as the multiview takes.
+     */
+    private fun navigateToMultiview(sources: List<NdiSource>) {
+        parentFragmentManager.commit {
+            replace(R.id.fragment_container, MultiviewFragment.newInstance(sources))
+            addToBackStack(null)
+        }
+    }
+
     private fun navigateToRecordings() {
         parentFragmentManager.commit {
             replace(R.id.fragment_container, RecordingsFragment.newInstance())
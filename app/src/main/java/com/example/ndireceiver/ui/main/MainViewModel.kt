@@ -1,17 +1,16 @@
 package com.example.ndireceiver.ui.main
 
+import android.graphics.Bitmap
 import androidx.lifecycle.ViewModel
 import androidx.lifecycle.viewModelScope
-import com.example.ndireceiver.NdiReceiverApplication
-import com.example.ndireceiver.ndi.NdiFinder
-import com.example.ndireceiver.ndi.NdiManager
 import com.example.ndireceiver.ndi.NdiSource
-import com.example.ndireceiver.ndi.NdiSourceRepository
+import com.example.ndireceiver.ndi.NdiWarmup
+import com.example.ndireceiver.ndi.SourcePreviews
 import kotlinx.coroutines.Job
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asStateFlow
-import kotlinx.coroutines.flow.catch
+import kotlinx.coroutines.flow.combine
 import kotlinx.coroutines.launch
 
 /**
@@ -24,81 +23,65 @@ data class MainUiState(
 )
 
 /**
- * ViewModel for the main screen - handles NDI source discovery.
+ * ViewModel for the main screen - shows the sources found by the discovery that
+ * [NdiWarmup] runs from application start, with [SourcePreviews] thumbnails.
  */
 class MainViewModel : ViewModel() {
-    private var ndiFinder: NdiFinder? = null
-
     private val _uiState = MutableStateFlow(MainUiState())
     val uiState: StateFlow<MainUiState> = _uiState.asStateFlow()
 
+    /** Preview thumbnails by source name. */
+    val thumbnails: StateFlow<Map<String, Bitmap>> = SourcePreviews.thumbnails
+
     private var discoveryJob: Job? = null
 
     init {
-        // Check for NDI initialization error first
-        val initError = NdiReceiverApplication.ndiInitializationError
-        if (initError != null) {
-            _uiState.value = MainUiState(
-                isLoading = false,
-                error = "NDI unavailable: $initError"
-            )
-        } else if (NdiManager.isInitialized()) {
-            ndiFinder = NdiFinder()
-            startDiscovery()
-        } else {
-            _uiState.value = MainUiState(
-                isLoading = false,
-                error = "NDI SDK not initialized"
-            )
-        }
+        startDiscovery()
     }
 
     /**
-     * Start NDI source discovery.
+     * Start following NDI source discovery and previewing the visible sources.
      */
     fun startDiscovery() {
-        val finder = ndiFinder ?: return
-
         if (discoveryJob?.isActive == true) return
 
-        _uiState.value = _uiState.value.copy(isLoading = true, error = null)
+        SourcePreviews.start()
 
         discoveryJob = viewModelScope.launch {
-            finder.startDiscovery()
-                .catch { e ->
-                    _uiState.value = _uiState.value.copy(
-                        isLoading = false,
-                        error = e.message ?: "Discovery failed"
-                    )
-                }
-                .collect { sources ->
-                    // Store in repository so PlayerFragment can access with DevolaySource
-                    NdiSourceRepository.updateDiscoveredSources(sources)
-
-                    _uiState.value = _uiState.value.copy(
-                        isLoading = false,
-                        sources = sources,
-                        error = null
-                    )
+            combine(NdiWarmup.sources, NdiWarmup.error) { sources, error -> sources to error }
+                .collect { (sources, error) ->
+                    _uiState.value = when {
+                        error != null -> _uiState.value.copy(isLoading = false, error = error)
+                        sources == null -> _uiState.value.copy(isLoading = true, error = null)
+                        else -> _uiState.value.copy(isLoading = false, sources = sources, error = null)
+                    }
                 }
         }
     }
 
+    /**
+     * Set the sources on screen, which are the ones previewed.
+     */
+    fun setVisibleSources(sources: List<NdiSource>) {
+        SourcePreviews.setVisibleSources(sources.map { it.name })
+    }
+
     /**
      * Refresh the source list.
      */
     fun refresh() {
-        stopDiscovery()
-        startDiscovery()
+        NdiWarmup.restartDiscovery()
     }
 
     /**
-     * Stop NDI source discovery.
+     * Stop following discovery while the screen is hidden. Discovery itself keeps running so
+     * the list is current when the screen returns; previews stop so they never compete with
+     * playback.
      */
     fun stopDiscovery() {
+        SourcePreviews.stop()
         discoveryJob?.cancel()
         discoveryJob = null
-        ndiFinder?.stopDiscovery()
     }
 
     override fun onCleared() {
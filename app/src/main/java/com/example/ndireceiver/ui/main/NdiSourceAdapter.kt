@@ -1,5 +1,7 @@
 package com.example.ndireceiver.ui.main
 
+import android.content.res.ColorStateList
+import android.graphics.Bitmap
 import android.graphics.drawable.GradientDrawable
 import android.view.LayoutInflater
 import android.view.View
@@ -7,6 +9,7 @@ import android.view.ViewGroup
 import android.widget.ImageView
 import android.widget.TextView
 import androidx.core.content.ContextCompat
+import androidx.core.widget.ImageViewCompat
 import androidx.recyclerview.widget.DiffUtil
 import androidx.recyclerview.widget.ListAdapter
 import androidx.recyclerview.widget.RecyclerView
@@ -14,13 +17,15 @@ import com.example.ndireceiver.R
 import com.example.ndireceiver.ndi.NdiSource
 
 /**
- * Adapter for displaying NDI sources in a RecyclerView.
+ * Adapter for displaying NDI sources in a RecyclerView, with a live preview thumbnail where
+ * one is available.
  */
 class NdiSourceAdapter(
     private val onSourceClick: (NdiSource) -> Unit
 ) : ListAdapter<NdiSource, NdiSourceAdapter.SourceViewHolder>(SourceDiffCallback()) {
 
     private var connectedSource: NdiSource? = null
+    private var thumbnails: Map<String, Bitmap> = emptyMap()
 
     override fun onCreateViewHolder(parent: ViewGroup, viewType: Int): SourceViewHolder {
         val view = LayoutInflater.from(parent.context)
@@ -30,7 +35,21 @@ class NdiSourceAdapter(
 
     override fun onBindViewHolder(holder: SourceViewHolder, position: Int) {
         val source = getItem(position)
-        holder.bind(source, source == connectedSource, onSourceClick)
+        holder.bind(source, source == connectedSource, thumbnails[source.name], onSourceClick)
+    }
+
+    /**
+     * Update preview thumbnails (by source name), rebinding only items whose thumbnail changed.
+     */
+    fun setThumbnails(newThumbnails: Map<String, Bitmap>) {
+        val previous = thumbnails
+        thumbnails = newThumbnails
+
+        currentList.forEachIndexed { index, item ->
+            if (previous[item.name] !== newThumbnails[item.name]) {
+                notifyItemChanged(index)
+            }
+        }
     }
 
     /**
@@ -54,10 +73,24 @@ class NdiSourceAdapter(
         private val infoView: TextView = itemView.findViewById(R.id.source_info)
         private val statusIndicator: View = itemView.findViewById(R.id.status_indicator)
 
-        fun bind(source: NdiSource, isConnected: Boolean, onClick: (NdiSource) -> Unit) {
+        fun bind(source: NdiSource, isConnected: Boolean, thumbnail: Bitmap?, onClick: (NdiSource) -> Unit) {
             nameView.text = source.displayName
             infoView.text = source.machineName
 
+            // Preview thumbnail, or the camera icon until there is one
+            if (thumbnail != null) {
+                iconView.setImageBitmap(thumbnail)
+                iconView.scaleType = ImageView.ScaleType.CENTER_CROP
+                ImageViewCompat.setImageTintList(iconView, null)
+            } else {
+                iconView.setImageResource(android.R.drawable.ic_menu_camera)
+                iconView.scaleType = ImageView.ScaleType.FIT_CENTER
+                ImageViewCompat.setImageTintList(
+                    iconView,
+                    ColorStateList.valueOf(ContextCompat.getColor(itemView.context, R.color.primary))
+                )
+            }
+
             // Update status indicator color
             val indicatorColor = if (isConnected) {
                 ContextCompat.getColor(itemView.context, R.color.connected_green)
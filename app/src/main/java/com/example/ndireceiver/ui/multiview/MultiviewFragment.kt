@@ -0,0 +1,151 @@
+package com.example.ndireceiver.ui.multiview
+
+import android.os.Bundle
+import android.view.LayoutInflater
+import android.view.SurfaceHolder
+import android.view.SurfaceView
+import android.view.View
+import android.view.ViewGroup
+import android.widget.GridLayout
+import android.widget.ImageButton
+import android.widget.TextView
+import androidx.core.view.isVisible
+import androidx.fragment.app.Fragment
+import androidx.fragment.app.viewModels
+import androidx.lifecycle.Lifecycle
+import androidx.lifecycle.lifecycleScope
+import androidx.lifecycle.repeatOnLifecycle
+import com.example.ndireceiver.R
+import com.example.ndireceiver.ndi.NdiSource
+import com.example.ndireceiver.ndi.NdiSourceRepository
+import kotlinx.coroutines.launch
+import java.util.Locale
+
+/**
+ * Fragment showing several NDI sources at once, one grid cell each. The video of all of them
+ * is drawn on one SurfaceView, with each cell's label and outline over its tile. Tapping a
+ * cell focuses its source.
+ */
+class MultiviewFragment : Fragment() {
+
+    companion object {
+        private const val ARG_SOURCE_NAMES = "source_names"
+
+        fun newInstance(sources: List<NdiSource>): MultiviewFragment {
+            return MultiviewFragment().apply {
+                arguments = Bundle().apply {
+                    putStringArrayList(ARG_SOURCE_NAMES, ArrayList(sources.map { it.name }))
+                }
+            }
+        }
+    }
+
+    private val viewModel: MultiviewViewModel by viewModels()
+
+    private lateinit var surfaceView: SurfaceView
+    private lateinit var tileGrid: GridLayout
+    private lateinit var errorText: TextView
+    private lateinit var btnBack: ImageButton
+
+    // Cells of tileGrid by source name, rebuilt when the tiles change
+    private var cells: Map<String, View> = emptyMap()
+
+    override fun onCreate(savedInstanceState: Bundle?) {
+        super.onCreate(savedInstanceState)
+
+        val names = arguments?.getStringArrayList(ARG_SOURCE_NAMES).orEmpty()
+        viewModel.start(names.map { NdiSourceRepository.findSourceByName(it) ?: NdiSource(it) })
+    }
+
+    override fun onCreateView(
+        inflater: LayoutInflater,
+        container: ViewGroup?,
+        savedInstanceState: Bundle?
+    ): View {
+        return inflater.inflate(R.layout.fragment_multiview, container, false)
+    }
+
+    override fun onViewCreated(view: View, savedInstanceState: Bundle?) {
+        super.onViewCreated(view, savedInstanceState)
+
+        surfaceView = view.findViewById(R.id.surface_view)
+        tileGrid = view.findViewById(R.id.tile_grid)
+        errorText = view.findViewById(R.id.error_text)
+        btnBack = view.findViewById(R.id.btn_back)
+        cells = emptyMap()
+
+        btnBack.setOnClickListener {
+            parentFragmentManager.popBackStack()
+        }
+
+        surfaceView.holder.addCallback(object : SurfaceHolder.Callback {
+            override fun surfaceCreated(holder: SurfaceHolder) {}
+
+            override fun surfaceChanged(holder: SurfaceHolder, format: Int, width: Int, height: Int) {
+                viewModel.setSurface(holder.surface, width, height)
+            }
+
+            override fun surfaceDestroyed(holder: SurfaceHolder) {
+                viewModel.setSurface(null, 0, 0)
+            }
+        })
+
+        viewLifecycleOwner.lifecycleScope.launch {
+            viewLifecycleOwner.repeatOnLifecycle(Lifecycle.State.STARTED) {
+                viewModel.uiState.collect { state ->
+                    updateUi(state)
+                }
+            }
+        }
+    }
+
+    private fun updateUi(state: MultiviewUiState) {
+        if (cells.keys.toList() != state.tiles.map { it.sourceName }) {
+            buildGrid(state)
+        }
+        for (tile in state.tiles) {
+            val cell = cells[tile.sourceName] ?: continue
+            cell.isSelected = tile.focused
+            cell.findViewById<TextView>(R.id.tile_label).text = formatTile(tile)
+        }
+        errorText.text = state.error
+        errorText.isVisible = state.error != null
+    }
+
+    private fun buildGrid(state: MultiviewUiState) {
+        tileGrid.removeAllViews()
+        tileGrid.columnCount = state.columns
+        tileGrid.rowCount = state.rows
+
+        val inflater = LayoutInflater.from(requireContext())
+        val built = LinkedHashMap<String, View>()
+        for ((index, tile) in state.tiles.withIndex()) {
+            val cell = inflater.inflate(R.layout.item_multiview_tile, tileGrid, false)
+            cell.layoutParams = GridLayout.LayoutParams(
+                GridLayout.spec(index / state.columns, 1f),
+                GridLayout.spec(index % state.columns, 1f)
+            ).apply {
+                width = 0
+                height = 0
+            }
+            cell.setOnClickListener { viewModel.setFocus(tile.sourceName) }
+            tileGrid.addView(cell)
+            built[tile.sourceName] = cell
+        }
+        cells = built
+    }
+
+    private fun formatTile(tile: MultiviewTile): String {
+        val name = NdiSource(tile.sourceName).displayName
+        if (!tile.receiving) {
+            return "$name\n${getString(R.string.connecting)}"
+        }
+        val kbps = tile.bitrateBps / 1000.0
+        val bitrate = if (kbps >= 1000) {
+            String.format(Locale.US, "%.1f Mbps", kbps / 1000.0)
+        } else {
+            String.format(Locale.US, "%.0f Kbps", kbps)
+        }
+        return "$name\n" + String.format(Locale.US, "%.1f fps | %s", tile.fps, bitrate)
+    }
+}
@@ -0,0 +1,210 @@
+package com.example.ndireceiver.ui.multiview
+
+import android.app.Application
+import android.view.Surface
+import androidx.lifecycle.AndroidViewModel
+import androidx.lifecycle.viewModelScope
+import com.example.ndireceiver.data.SettingsRepository
+import com.example.ndireceiver.media.MultiviewRenderer
+import com.example.ndireceiver.ndi.NdiMultiReceiver
+import com.example.ndireceiver.ndi.NdiNative
+import com.example.ndireceiver.ndi.NdiSource
+import com.example.ndireceiver.ndi.VideoFrameData
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import java.util.concurrent.ConcurrentHashMap
+
+/**
+ * One source of the multiview and its latest receive statistics.
+ *
+ * @property receiving a frame arrived and the connection has not been lost since
+ */
+data class MultiviewTile(
+    val sourceName: String,
+    val focused: Boolean = false,
+    val receiving: Boolean = false,
+    val fps: Double = 0.0,
+    val bitrateBps: Long = 0L
+)
+
+/**
+ * UI state for the multiview screen. Tiles are laid out [columns] x [rows] in order.
+ */
+data class MultiviewUiState(
+    val tiles: List<MultiviewTile> = emptyList(),
+    val columns: Int = 1,
+    val rows: Int = 1,
+    val error: String? = null
+)
+
+/**
+ * ViewModel for the multiview screen: receives up to [MAX_SOURCES] sources at once with an
+ * [NdiMultiReceiver] and shows them as one grid through a [MultiviewRenderer]. The focused
+ * source is received at full bandwidth, the others at the lowest, since they only fill a tile.
+ */
+class MultiviewViewModel internal constructor(
+    application: Application,
+    private val receiver: NdiMultiReceiver
+) : AndroidViewModel(application), NdiMultiReceiver.Callback {
+
+    constructor(application: Application) : this(application, createReceiver(application))
+
+    companion object {
+        /** Sources shown at once (a 2x2 grid). */
+        const val MAX_SOURCES = 4
+
+        private const val STATS_INTERVAL_MS = 1000L
+
+        private fun createReceiver(application: Application): NdiMultiReceiver {
+            val settings = SettingsRepository.getInstance(application)
+            return NdiMultiReceiver(settings.getTargetLatencyMs(), settings.isLowLatencyModeEnabled())
+        }
+    }
+
+    private val _uiState = MutableStateFlow(MultiviewUiState())
+    val uiState: StateFlow<MultiviewUiState> = _uiState.asStateFlow()
+
+    // Written on the delivery thread, read when the statistics are refreshed
+    private val lostSources = ConcurrentHashMap.newKeySet<String>()
+
+    private var statsJob: Job? = null
+
+    // Replaced from the main thread and used on the delivery thread, so both hold the lock
+    private val rendererLock = Any()
+    private var renderer: MultiviewRenderer? = null
+
+    init {
+        receiver.setCallback(this)
+    }
+
+    /**
+     * Start receiving the first [MAX_SOURCES] of [sources], focusing the first. Later calls
+     * do nothing.
+     */
+    fun start(sources: List<NdiSource>) {
+        if (_uiState.value.tiles.isNotEmpty()) return
+        val shown = sources.take(MAX_SOURCES)
+        val (columns, rows) = MultiviewRenderer.gridFor(shown.size)
+        val focused = shown.firstOrNull()?.name
+        _uiState.value = MultiviewUiState(
+            tiles = shown.map { MultiviewTile(it.name, focused = it.name == focused) },
+            columns = columns,
+            rows = rows
+        )
+
+        viewModelScope.launch {
+            receiver.setFocus(focused)
+            val failed = shown.filterNot { source ->
+                receiver.addSource(source, bandwidthFor(source.name == focused))
+            }
+            if (failed.isNotEmpty()) {
+                _uiState.value = _uiState.value.copy(
+                    error = "Cannot receive ${failed.joinToString { it.displayName }}"
+                )
+            }
+        }
+        startStatsUpdates()
+    }
+
+    /**
+     * Receive [sourceName] at full bandwidth and ahead of the others.
+     */
+    fun setFocus(sourceName: String) {
+        val previous = receiver.focusedSource
+        if (previous == sourceName) return
+        receiver.setFocus(sourceName)
+        _uiState.value = _uiState.value.copy(
+            tiles = _uiState.value.tiles.map { it.copy(focused = it.sourceName == sourceName) }
+        )
+        viewModelScope.launch {
+            previous?.let { receiver.setBandwidth(it, bandwidthFor(false)) }
+            receiver.setBandwidth(sourceName, bandwidthFor(true))
+        }
+    }
+
+    /**
+     * Show the sources on [surface] of [width] x [height], or stop showing them with null
+     * (from surfaceDestroyed). A new size creates a new renderer.
+     */
+    fun setSurface(surface: Surface?, width: Int, height: Int) {
+        val state = _uiState.value
+        synchronized(rendererLock) {
+            val current = renderer
+            if (surface != null && current != null && current.width == width && current.height == height) {
+                current.setSurface(surface)
+                return
+            }
+            current?.release()
+            renderer = null
+            if (surface == null || width <= 0 || height <= 0) return
+
+            val created = MultiviewRenderer(width, height, state.columns, state.rows)
+            if (!created.isAvailable) {
+                _uiState.value = state.copy(error = "Multiview not available")
+                return
+            }
+            created.setSources(state.tiles.map { it.sourceName })
+            created.setSurface(surface)
+            created.start()
+            renderer = created
+        }
+    }
+
+    private fun bandwidthFor(focused: Boolean): Int =
+        if (focused) NdiNative.Bandwidth.HIGHEST else NdiNative.Bandwidth.LOWEST
+
+    private fun startStatsUpdates() {
+        statsJob?.cancel()
+        statsJob = viewModelScope.launch {
+            while (isActive) {
+                delay(STATS_INTERVAL_MS)
+                updateStats()
+            }
+        }
+    }
+
+    private fun updateStats() {
+        _uiState.value = _uiState.value.copy(
+            tiles = _uiState.value.tiles.map { tile ->
+                val stats = receiver.getStats(tile.sourceName)
+                tile.copy(
+                    receiving = stats != null && stats.videoFrames > 0 && tile.sourceName !in lostSources,
+                    fps = stats?.fps ?: 0.0,
+                    bitrateBps = stats?.bitrateBps ?: 0L
+                )
+            }
+        )
+    }
+
+    // ========== NdiMultiReceiver.Callback (delivery thread) ==========
+
+    override fun onVideoFrame(sourceName: String, frame: VideoFrameData) {
+        lostSources.remove(sourceName)
+        synchronized(rendererLock) {
+            renderer?.submit(sourceName, frame)
+        }
+    }
+
+    override fun onConnectionLost(sourceName: String) {
+        lostSources.add(sourceName)
+        synchronized(rendererLock) {
+            renderer?.clear(sourceName)
+        }
+    }
+
+    override fun onCleared() {
+        super.onCleared()
+        statsJob?.cancel()
+        receiver.setCallback(null)
+        receiver.release()
+        synchronized(rendererLock) {
+            renderer?.release()
+            renderer = null
+        }
+    }
+}
@@ -28,6 +28,7 @@ import androidx.lifecycle.lifecycleScope
 import androidx.lifecycle.repeatOnLifecycle
 import com.example.ndireceiver.R
 import com.example.ndireceiver.ndi.ConnectionState
+import com.example.ndireceiver.ndi.NdiNative
 import com.example.ndireceiver.ndi.NdiSource
 import com.example.ndireceiver.ndi.NdiSourceRepository
 import com.example.ndireceiver.ui.recordings.RecordingsFragment
@@ -69,7 +70,7 @@ class PlayerFragment : Fragment() {
     private lateinit var sourceName: TextView
     private lateinit var connectingText: TextView
     private lateinit var osdInfo: TextView
-    private lateinit var osdBitrate: TextView
+    private lateinit var osdStats: TextView
     private lateinit var recordingIndicator: TextView
     private lateinit var errorText: TextView
     private lateinit var autoReconnectText: TextView
@@ -208,7 +209,7 @@ class PlayerFragment : Fragment() {
         sourceName = view.findViewById(R.id.source_name)
         connectingText = view.findViewById(R.id.connecting_text)
         osdInfo = view.findViewById(R.id.osd_info)
-        osdBitrate = view.findViewById(R.id.osd_bitrate)
+        osdStats = view.findViewById(R.id.osd_stats)
         recordingIndicator = view.findViewById(R.id.recording_indicator)
         errorText = view.findViewById(R.id.error_text)
         autoReconnectText = view.findViewById(R.id.auto_reconnect_text)
@@ -233,7 +234,7 @@ class PlayerFragment : Fragment() {
             }
 
             override fun surfaceChanged(holder: SurfaceHolder, format: Int, width: Int, height: Int) {
-                // Surface dimensions changed - could reconfigure decoder here if needed
+                viewModel.setSurfaceSize(width, height)
             }
 
             override fun surfaceDestroyed(holder: SurfaceHolder) {
@@ -354,15 +355,16 @@ class PlayerFragment : Fragment() {
 
         // Update OSD visibility based on settings
         val osdVisible = state.showOsd && state.connectionState is ConnectionState.Connected
+        val statsText = formatOsdStats(state.osdStats)
         osdInfo.isVisible = osdVisible && state.videoInfo.isNotEmpty()
-        osdBitrate.isVisible = osdVisible && state.bitrateInfo.isNotEmpty()
+        osdStats.isVisible = osdVisible && statsText.isNotEmpty()
 
         // Update OSD content
         if (state.videoInfo.isNotEmpty()) {
             osdInfo.text = state.videoInfo
         }
-        if (state.bitrateInfo.isNotEmpty()) {
-            osdBitrate.text = state.bitrateInfo
+        if (statsText.isNotEmpty()) {
+            osdStats.text = statsText
         }
 
         // Update aspect ratio when video dimensions change
@@ -374,6 +376,110 @@ class PlayerFragment : Fragment() {
         updateRecordingUi(state.recordingState)
     }
 
+    /**
+     * OSD statistics, one line per topic: the stream as received, playout, this device on the
+     * network, resources, and glass-to-glass latency. Items with nothing to report are left out.
+     */
+    private fun formatOsdStats(stats: OsdStats): String {
+        val stream = listOfNotNull(
+            stats.stream?.let {
+                val kbps = it.bitrateBps / 1000.0
+                val rate = if (kbps >= 1000) String.format("%.1f Mbps", kbps / 1000.0) else String.format("%.0f Kbps", kbps)
+                String.format("%s %.1f fps jit %.1f ms q %d", rate, it.fps, it.jitterNs / 1_000_000.0, it.queueVideoMax)
+            },
+            // Adaptive bandwidth: stream received and switches so far, once it has had to switch
+            stats.bandwidth
+                ?.takeIf { it.bandwidth == NdiNative.Bandwidth.LOWEST || it.downgrades > 0 || it.pending }
+                ?.let {
+                    val level = if (it.bandwidth == NdiNative.Bandwidth.LOWEST) "low" else "high"
+                    String.format("bw %s%s dn %d up %d", level, if (it.pending) "*" else "", it.downgrades, it.upgrades)
+                }
+        )
+        val playout = listOfNotNull(
+            // Deinterlacing cost, once the deinterlacer has processed frames
+            stats.performance
+                ?.takeIf { it.deinterlacedFrames > 0 }
+                ?.let { String.format("deint %.2f ms", it.deinterlaceAvgNs / 1_000_000.0) },
+            // Jitter buffer: delay in use against the latency budget, and frames that missed it
+            stats.performance
+                ?.takeIf { it.targetLatencyMs > 0 }
+                ?.let { String.format("jb %.0f/%d ms late %d", it.jitterDelayNs / 1_000_000.0, it.targetLatencyMs, it.lateFrames) },
+            // Latest-frame-wins: stale frames skipped
+            stats.performance
+                ?.takeIf { it.lowLatency }
+                ?.let { String.format("skip %d", it.skippedFrames) },
+            // Vsync pacing of uncompressed frames: p99 present-time error, drops and repeats
+            stats.pacing
+                ?.takeIf { it.presented > 0 }
+                ?.let { String.format("pace p99 %.1f ms drop %d rep %d", it.errorP99Ns / 1_000_000.0, it.dropped, it.repeated) }
+        )
+        val network = listOfNotNull(
+            stats.tally?.let { tally ->
+                val states = listOfNotNull("PGM".takeIf { tally.onProgram }, "PVW".takeIf { tally.onPreview })
+                "tally " + states.joinToString("+").ifEmpty { "off" }
+            },
+            // Relay: receivers pulling from this device, frames republished and compressed ones it could not carry
+            stats.relay?.let {
+                when {
+                    it.compressed -> "relay unavailable for compressed streams"
+                    !it.advertising -> "relay waiting for video"
+                    it.videoSkipped > 0 -> String.format("relay %d rx sent %d skip %d", it.connections, it.videoSent, it.videoSkipped)
+                    else -> String.format("relay %d rx sent %d", it.connections, it.videoSent)
+                }
+            },
+            // Time from selecting the source to its first frame on screen
+            stats.timeToFirstFrame?.let { String.format("ttff %d ms%s", it.totalMs, if (it.warmReceiver) "" else " cold") }
+        )
+        val resources = listOfNotNull(
+            // Frame memory: usage against the budget, and requests refused by it
+            stats.memory?.let {
+                val usedMb = it.usedBytes / (1024 * 1024)
+                val budgetMb = it.budgetBytes / (1024 * 1024)
+                if (it.rejected > 0) {
+                    String.format("mem %d/%d MB rej %d", usedMb, budgetMb, it.rejected)
+                } else {
+                    String.format("mem %d/%d MB", usedMb, budgetMb)
+                }
+            },
+            // Thread placement: threads running where the core map put them, and CPU migrations seen
+            stats.placement
+                ?.takeIf { it.enabled && it.threads.isNotEmpty() }
+                ?.let { placement ->
+                    val placed = placement.threads.count { it.isPlaced }
+                    String.format("place %d/%d mig %d", placed, placement.threads.size, placement.threads.sumOf { it.migrations })
+                },
+            // Per-stage cost: mean wall time per execution and CPU share of one core, then the busiest thread
+            stats.stages?.let { profile ->
+                val stages = NdiNative.PipelineStage.NAMES.indices
+                    .filter { profile.count[it] > 0 }
+                    .joinToString(" ") {
+                        String.format("%s %.1fms/%.0f%%", NdiNative.PipelineStage.NAMES[it], profile.wallAvgNs(it) / 1_000_000.0, profile.cpuPercent(it))
+                    }
+                val top = profile.threads.firstOrNull()
+                    ?.takeIf { profile.threadIntervalNs > 0 }
+                    ?.let { String.format("top %s %.0f%%", it.name, it.cpuNs * 100.0 / profile.threadIntervalNs) }
+                listOfNotNull(stages.ifEmpty { null }, top)
+                    .takeIf { it.isNotEmpty() }
+                    ?.joinToString(" ", prefix = "cpu ")
+            }
+        )
+        // Glass-to-glass latency from capture to each stage reached: p50/p95/p99
+        val latency = listOfNotNull(
+            stats.latency?.let { latency ->
+                NdiNative.LatencyStage.NAMES.indices
+                    .filter { latency.count[it] > 0 }
+                    .takeIf { it.isNotEmpty() }
+                    ?.joinToString(" ", prefix = "g2g ", postfix = " ms") {
+                        String.format("%s %.0f/%.0f/%.0f", NdiNative.LatencyStage.NAMES[it],
+                            latency.p50Ns[it] / 1_000_000.0, latency.p95Ns[it] / 1_000_000.0, latency.p99Ns[it] / 1_000_000.0)
+                    }
+            }
+        )
+        return listOf(stream, playout, network, resources, latency)
+            .filter { it.isNotEmpty() }
+            .joinToString("\n") { it.joinToString(" | ") }
+    }
+
     /**
      * Update SurfaceView dimensions to maintain video aspect ratio.
      * Centers the video and adds letterbox/pillarbox as needed.
@@ -6,14 +6,22 @@ import android.view.Surface
 import androidx.lifecycle.AndroidViewModel
 import androidx.lifecycle.viewModelScope
 import com.example.ndireceiver.data.SettingsRepository
+import com.example.ndireceiver.media.ColorSpaceConverter
+import com.example.ndireceiver.media.FrameLatency
+import com.example.ndireceiver.media.FrameMemory
+import com.example.ndireceiver.media.StageProfiler
+import com.example.ndireceiver.media.ThreadPlacement
 import com.example.ndireceiver.media.UncompressedVideoRenderer
 import com.example.ndireceiver.media.VideoDecoder
 import com.example.ndireceiver.media.VideoRecorder
 import com.example.ndireceiver.ndi.ConnectionState
 import com.example.ndireceiver.ndi.FourCC
+import com.example.ndireceiver.ndi.FrameConsumer
 import com.example.ndireceiver.ndi.NdiFrameCallback
+import com.example.ndireceiver.ndi.NdiNative
 import com.example.ndireceiver.ndi.NdiReceiver
 import com.example.ndireceiver.ndi.NdiSource
+import com.example.ndireceiver.ndi.TimeToFirstFrame
 import com.example.ndireceiver.ndi.VideoFrameData
 import kotlinx.coroutines.Job
 import kotlinx.coroutines.delay
@@ -35,6 +43,33 @@ sealed class RecordingState {
     data class Error(val message: String) : RecordingState()
 }
 
+/**
+ * Tally echoed by the sender in ndi_tally_echo metadata.
+ */
+data class Tally(
+    val onProgram: Boolean,
+    val onPreview: Boolean
+)
+
+/**
+ * Statistics shown on the OSD, collected once a second. Each is null while its source has
+ * none (or, for [latency], while the latency OSD is off); [PlayerFragment] decides which to
+ * show and lays them out.
+ */
+data class OsdStats(
+    val stream: NdiNative.ReceiverStats? = null,
+    val performance: NdiNative.ReceiverPerformance? = null,
+    val bandwidth: NdiNative.BandwidthStats? = null,
+    val tally: Tally? = null,
+    val relay: NdiNative.RelayStats? = null,
+    val timeToFirstFrame: TimeToFirstFrame.Result? = null,
+    val memory: NdiNative.ArenaStats? = null,
+    val placement: NdiNative.ThreadPlacementStats? = null,
+    val stages: NdiNative.StageStats? = null,
+    val pacing: NdiNative.PacerStats? = null,
+    val latency: NdiNative.LatencyStats? = null
+)
+
 /**
  * UI state for the player screen.
  */
@@ -44,7 +79,7 @@ data class PlayerUiState(
     val showControls: Boolean = true,
     val showOsd: Boolean = true,
     val videoInfo: String = "",
-    val bitrateInfo: String = "",
+    val osdStats: OsdStats = OsdStats(),
     val retryCount: Int = 0,
     val isAutoReconnecting: Boolean = false,
     val videoWidth: Int = 0,
@@ -61,6 +96,8 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
     private var uncompressedRenderer: UncompressedVideoRenderer? = null
     private var recorder: VideoRecorder? = null
     @Volatile private var surface: Surface? = null
+    private var surfaceWidth = 0
+    private var surfaceHeight = 0
     @Volatile private var isDisconnecting = false
     private var currentSource: NdiSource? = null
 
@@ -86,19 +123,24 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
     @Volatile private var currentVideoHeight = 0
     @Volatile private var currentIsHevc = false
 
+    // Tally echoed by the sender in ndi_tally_echo metadata (null until one arrives)
+    @Volatile private var tallyOnProgram: Boolean? = null
+    @Volatile private var tallyOnPreview = false
+
     // Auto-reconnect state
     private var autoReconnectAttempts = 0
     private val maxAutoReconnectAttempts = 5
     private val autoReconnectDelayMs = 3000L
     private var autoReconnectJob: Job? = null
 
-    // Bitrate tracking
-    private var lastBitrateUpdateTime = 0L
-    private var bytesReceivedSinceLastUpdate = 0L
-    private var currentBitrateKbps = 0.0
+    // OSD refresh (the stream statistics themselves are kept natively)
+    private var lastOsdUpdateTime = 0L
 
     init {
         receiver.setFrameCallback(this)
+        receiver.setBacklogProvider {
+            decoder?.getBacklog() ?: uncompressedRenderer?.getPacerStats()?.queueDepth ?: 0
+        }
 
         // Load initial OSD setting
         _uiState.value = _uiState.value.copy(showOsd = settingsRepository.isOsdEnabled())
@@ -157,7 +199,7 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
         autoReconnectJob = viewModelScope.launch {
             delay(autoReconnectDelayMs)
             currentSource?.let { source ->
-                receiver.connect(source)
+                receiver.connect(source, activeConsumers(), settingsRepository.isRecord10BitEnabled())
             }
         }
     }
@@ -183,6 +225,9 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
                 uncompressedRenderer = UncompressedVideoRenderer()
             }
             uncompressedRenderer?.setSurface(surface)
+            if (surfaceWidth > 0 && surfaceHeight > 0) {
+                uncompressedRenderer?.setSurfaceSize(surfaceWidth, surfaceHeight)
+            }
 
             if (decoder == null) {
                 decoder = VideoDecoder()
@@ -193,15 +238,46 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
         }
     }
 
+    /**
+     * Set the surface's size in pixels; uncompressed frames larger than it are scaled down to it.
+     */
+    fun setSurfaceSize(width: Int, height: Int) {
+        surfaceWidth = width
+        surfaceHeight = height
+        uncompressedRenderer?.setSurfaceSize(width, height)
+    }
+
     /**
      * Connect to an NDI source.
      */
     fun connect(source: NdiSource) {
         currentSource = source
+        tallyOnProgram = null
+        TimeToFirstFrame.ensureBegun()
+        FrameLatency.reset()
+        receiver.setDeinterlaceMode(settingsRepository.getDeinterlace().nativeMode)
+        receiver.setTargetLatency(settingsRepository.getTargetLatencyMs())
+        receiver.setLowLatency(settingsRepository.isLowLatencyModeEnabled())
+        receiver.setAdaptiveBandwidth(settingsRepository.isAdaptiveBandwidthEnabled())
+        receiver.setRelayEnabled(settingsRepository.isRelayModeEnabled())
+        FrameMemory.setBudgetMb(settingsRepository.getFrameMemoryBudgetMb())
+        // Before connecting: pipeline threads place themselves as they start
+        ThreadPlacement.configure(settingsRepository.isThreadPlacementEnabled())
 
         viewModelScope.launch {
-            receiver.connect(source)
+            receiver.connect(source, activeConsumers(), settingsRepository.isRecord10BitEnabled())
+        }
+    }
+
+    /**
+     * Frame consumers that will be fed by the next connection, used for color format negotiation.
+     */
+    private fun activeConsumers(): Set<FrameConsumer> {
+        val consumers = mutableSetOf(FrameConsumer.DISPLAY)
+        if (isRecordingEnabled) {
+            consumers.add(FrameConsumer.ENCODER)
         }
+        return consumers
     }
 
     /**
@@ -318,8 +394,13 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
                 rec.startRecording(currentVideoWidth, currentVideoHeight, currentIsHevc)
             } else {
                 // It's an uncompressed format that we can encode
-                if (lastInfoFourCC == FourCC.UYVY || lastInfoFourCC == FourCC.BGRA || lastInfoFourCC == FourCC.BGRX) {
-                    rec.startRecording(currentVideoWidth, currentVideoHeight, lastInfoFourCC)
+                if (ColorSpaceConverter.isSupported(lastInfoFourCC)) {
+                    rec.startRecording(
+                        currentVideoWidth,
+                        currentVideoHeight,
+                        lastInfoFourCC,
+                        preferTenBit = settingsRepository.isRecord10BitEnabled()
+                    )
                 } else {
                     _uiState.value = _uiState.value.copy(
                         recordingState = RecordingState.Error("Unsupported format for recording: ${lastInfoFourCC.name}")
@@ -428,10 +509,15 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
                         decoderInitialized = true
                     }
                 }
+            } else {
+                // A bandwidth switch changes the resolution; the new stream starts at a random access point
+                synchronized(decoderLock) {
+                    decoder?.reconfigure(frame.width, frame.height, mimeType)
+                }
             }
             decoder?.submitFrame(frame)
         }
-        updateBitrateInfo(frame.data.remaining())
+        updateStreamInfo()
     }
 
     override fun onConnectionLost() {
@@ -447,6 +533,13 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
         }
     }
 
+    override fun onMetadata(event: NdiNative.MetadataEvent) {
+        if (event.element == "ndi_tally_echo") {
+            tallyOnProgram = event.attribute("on_program") == "true"
+            tallyOnPreview = event.attribute("on_preview") == "true"
+        }
+    }
+
     private fun maybeUpdateVideoInfo(frame: VideoFrameData) {
         val shouldUpdate = frame.width != lastInfoWidth ||
             frame.height != lastInfoHeight ||
@@ -477,7 +570,8 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
                 else -> "Compressed (${frame.fourCC.name})"
             }
         } else {
-            "Raw ${frame.fourCC.name}"
+            val negotiated = receiver.colorFormatChoice?.let { " via ${it.label}" } ?: ""
+            "Raw ${frame.fourCC.name}$negotiated"
         }
 
         val info = "${frame.width}x${frame.height} @ ${String.format("%.1f", fps)}fps | $label"
@@ -497,26 +591,29 @@ class PlayerViewModel(application: Application) : AndroidViewModel(application),
     }
 
     /**
-     * Update bitrate information based on received data.
+     * Refresh the stream information line, at most once a second. Rate, bitrate, arrival
+     * jitter and SDK queue depth come from the receiver's native rolling window.
      */
-    private fun updateBitrateInfo(frameBytes: Int) {
+    private fun updateStreamInfo() {
         val currentTime = System.currentTimeMillis()
-        bytesReceivedSinceLastUpdate += frameBytes
 
-        // Update bitrate every second
-        if (currentTime - lastBitrateUpdateTime >= 1000) {
-            val elapsedSeconds = (currentTime - lastBitrateUpdateTime) / 1000.0
-            if (elapsedSeconds > 0) {
-                currentBitrateKbps = (bytesReceivedSinceLastUpdate * 8.0) / (elapsedSeconds * 1000.0)
-            }
-            bytesReceivedSinceLastUpdate = 0
-            lastBitrateUpdateTime = currentTime
-
-            val bitrateStr = when {
-                currentBitrateKbps >= 1000 -> String.format("%.1f Mbps", currentBitrateKbps / 1000.0)
-                else -> String.format("%.0f Kbps", currentBitrateKbps)
-            }
-            _uiState.value = _uiState.value.copy(bitrateInfo = bitrateStr)
+        if (currentTime - lastOsdUpdateTime >= 1000) {
+            lastOsdUpdateTime = currentTime
+
+            val osdStats = OsdStats(
+                stream = receiver.getStats(),
+                performance = receiver.getPerformance(),
+                bandwidth = receiver.getBandwidthStats(),
+                tally = tallyOnProgram?.let { Tally(onProgram = it, onPreview = tallyOnPreview) },
+                relay = receiver.getRelayStats(),
+                timeToFirstFrame = TimeToFirstFrame.getLast(),
+                memory = FrameMemory.getStats(),
+                placement = ThreadPlacement.getStats(),
+                stages = StageProfiler.getStats(),
+                pacing = uncompressedRenderer?.getPacerStats(),
+                latency = FrameLatency.takeIf { settingsRepository.isLatencyOsdEnabled() }?.getStats()
+            )
+            _uiState.value = _uiState.value.copy(osdStats = osdStats)
         }
     }
 
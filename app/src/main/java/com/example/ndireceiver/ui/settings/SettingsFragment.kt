@@ -19,6 +19,9 @@ import androidx.lifecycle.lifecycleScope
 import androidx.lifecycle.repeatOnLifecycle
 import com.example.ndireceiver.R
 import com.example.ndireceiver.data.AppLanguage
+import com.example.ndireceiver.data.DeinterlaceSetting
+import com.example.ndireceiver.data.TransportSetting
+import com.example.ndireceiver.ndi.NdiTransport
 import com.example.ndireceiver.util.LocaleHelper
 import com.google.android.material.switchmaterial.SwitchMaterial
 import kotlinx.coroutines.launch
@@ -41,6 +44,18 @@ class SettingsFragment : Fragment() {
     private lateinit var switchAutoReconnect: SwitchMaterial
     private lateinit var switchScreenAlwaysOn: SwitchMaterial
     private lateinit var switchShowOsd: SwitchMaterial
+    private lateinit var switchLatencyOsd: SwitchMaterial
+    private lateinit var switchRecord10Bit: SwitchMaterial
+    private lateinit var spinnerDeinterlace: Spinner
+    private lateinit var spinnerTargetLatency: Spinner
+    private lateinit var switchLowLatency: SwitchMaterial
+    private lateinit var switchAdaptiveBandwidth: SwitchMaterial
+    private lateinit var spinnerFrameMemory: Spinner
+    private lateinit var switchThreadPlacement: SwitchMaterial
+    private lateinit var switchRelayMode: SwitchMaterial
+    private lateinit var spinnerTransport: Spinner
+    private lateinit var transportBenchmarkResult: TextView
+    private lateinit var btnTransportBenchmark: Button
     private lateinit var lastSourceContainer: LinearLayout
     private lateinit var lastSourceName: TextView
     private lateinit var btnClearLastSource: Button
@@ -52,6 +67,28 @@ class SettingsFragment : Fragment() {
     // Flag to prevent switch/spinner listener triggering during initialization
     private var isInitializing = true
     
+    // Deinterlace options
+    private val deinterlaceOptions = listOf(
+        DeinterlaceSetting.MOTION_ADAPTIVE,
+        DeinterlaceSetting.BOB,
+        DeinterlaceSetting.WEAVE,
+        DeinterlaceSetting.OFF
+    )
+
+    // Jitter buffer latency budget options (ms); 0 disables buffering
+    private val targetLatencyOptions = listOf(0, 20, 50, 100, 200, 500)
+
+    // Frame memory budget options (MB)
+    private val frameMemoryOptions = listOf(256, 512, 1024, 2048)
+
+    // Transport options
+    private val transportOptions = listOf(
+        TransportSetting.AUTO,
+        TransportSetting.TCP,
+        TransportSetting.RUDP,
+        TransportSetting.MULTICAST
+    )
+
     // Language options
     private val languageOptions = listOf(
         AppLanguage.SYSTEM,
@@ -72,6 +109,10 @@ class SettingsFragment : Fragment() {
 
         initializeViews(view)
         setupLanguageSpinner()
+        setupDeinterlaceSpinner()
+        setupTargetLatencySpinner()
+        setupFrameMemorySpinner()
+        setupTransportSpinner()
         setupListeners()
         observeUiState()
 
@@ -84,6 +125,18 @@ class SettingsFragment : Fragment() {
         switchAutoReconnect = view.findViewById(R.id.switch_auto_reconnect)
         switchScreenAlwaysOn = view.findViewById(R.id.switch_screen_always_on)
         switchShowOsd = view.findViewById(R.id.switch_show_osd)
+        switchLatencyOsd = view.findViewById(R.id.switch_latency_osd)
+        switchRecord10Bit = view.findViewById(R.id.switch_record_10bit)
+        spinnerDeinterlace = view.findViewById(R.id.spinner_deinterlace)
+        spinnerTargetLatency = view.findViewById(R.id.spinner_target_latency)
+        switchLowLatency = view.findViewById(R.id.switch_low_latency)
+        switchAdaptiveBandwidth = view.findViewById(R.id.switch_adaptive_bandwidth)
+        spinnerFrameMemory = view.findViewById(R.id.spinner_frame_memory)
+        switchThreadPlacement = view.findViewById(R.id.switch_thread_placement)
+        switchRelayMode = view.findViewById(R.id.switch_relay_mode)
+        spinnerTransport = view.findViewById(R.id.spinner_transport)
+        transportBenchmarkResult = view.findViewById(R.id.transport_benchmark_result)
+        btnTransportBenchmark = view.findViewById(R.id.btn_transport_benchmark)
         lastSourceContainer = view.findViewById(R.id.last_source_container)
         lastSourceName = view.findViewById(R.id.last_source_name)
         btnClearLastSource = view.findViewById(R.id.btn_clear_last_source)
@@ -124,6 +177,158 @@ class SettingsFragment : Fragment() {
         }
     }
 
+    private fun setupDeinterlaceSpinner() {
+        val displayNames = deinterlaceOptions.map { setting ->
+            getString(
+                when (setting) {
+                    DeinterlaceSetting.OFF -> R.string.settings_deinterlace_off
+                    DeinterlaceSetting.WEAVE -> R.string.settings_deinterlace_weave
+                    DeinterlaceSetting.BOB -> R.string.settings_deinterlace_bob
+                    DeinterlaceSetting.MOTION_ADAPTIVE -> R.string.settings_deinterlace_motion_adaptive
+                }
+            )
+        }
+
+        spinnerDeinterlace.adapter = ArrayAdapter(
+            requireContext(),
+            android.R.layout.simple_spinner_item,
+            displayNames
+        ).apply {
+            setDropDownViewResource(android.R.layout.simple_spinner_dropdown_item)
+        }
+
+        spinnerDeinterlace.onItemSelectedListener = object : AdapterView.OnItemSelectedListener {
+            override fun onItemSelected(parent: AdapterView<*>?, view: View?, position: Int, id: Long) {
+                if (!isInitializing) {
+                    viewModel.setDeinterlace(deinterlaceOptions[position])
+                }
+            }
+
+            override fun onNothingSelected(parent: AdapterView<*>?) {
+                // Do nothing
+            }
+        }
+    }
+
+    private fun setupTransportSpinner() {
+        val displayNames = transportOptions.map { getString(transportNameRes(it)) }
+
+        spinnerTransport.adapter = ArrayAdapter(
+            requireContext(),
+            android.R.layout.simple_spinner_item,
+            displayNames
+        ).apply {
+            setDropDownViewResource(android.R.layout.simple_spinner_dropdown_item)
+        }
+
+        spinnerTransport.onItemSelectedListener = object : AdapterView.OnItemSelectedListener {
+            override fun onItemSelected(parent: AdapterView<*>?, view: View?, position: Int, id: Long) {
+                if (!isInitializing) {
+                    viewModel.setTransport(transportOptions[position])
+                }
+            }
+
+            override fun onNothingSelected(parent: AdapterView<*>?) {
+                // Do nothing
+            }
+        }
+    }
+
+    private fun transportNameRes(setting: TransportSetting): Int = when (setting) {
+        TransportSetting.AUTO -> R.string.settings_transport_auto
+        TransportSetting.TCP -> R.string.settings_transport_tcp
+        TransportSetting.RUDP -> R.string.settings_transport_rudp
+        TransportSetting.MULTICAST -> R.string.settings_transport_multicast
+    }
+
+    /**
+     * One line per probed transport, then the one selected from them.
+     */
+    private fun formatTransportBenchmark(entries: List<NdiTransport.BenchmarkEntry>): String {
+        if (entries.isEmpty()) {
+            return getString(R.string.settings_transport_benchmark_busy)
+        }
+
+        fun name(mode: Int): String {
+            val setting = TransportSetting.entries.find { it.nativeMode == mode } ?: TransportSetting.AUTO
+            return getString(transportNameRes(setting))
+        }
+
+        val lines = entries.map { entry ->
+            val result = entry.result
+            if (result == null || result.frames == 0L) {
+                getString(R.string.settings_transport_benchmark_no_frames, name(entry.mode))
+            } else {
+                getString(
+                    R.string.settings_transport_benchmark_entry,
+                    name(entry.mode),
+                    result.lossRate * 100.0,
+                    result.jitterNs / 1_000_000.0
+                )
+            }
+        }
+        val recommended = NdiTransport.recommend(entries)?.let {
+            getString(R.string.settings_transport_benchmark_recommended, name(it))
+        }
+        return (lines + listOfNotNull(recommended)).joinToString("\n")
+    }
+
+    private fun setupTargetLatencySpinner() {
+        val displayNames = targetLatencyOptions.map { latencyMs ->
+            if (latencyMs == 0) {
+                getString(R.string.settings_target_latency_off)
+            } else {
+                getString(R.string.settings_target_latency_ms, latencyMs)
+            }
+        }
+
+        spinnerTargetLatency.adapter = ArrayAdapter(
+            requireContext(),
+            android.R.layout.simple_spinner_item,
+            displayNames
+        ).apply {
+            setDropDownViewResource(android.R.layout.simple_spinner_dropdown_item)
+        }
+
+        spinnerTargetLatency.onItemSelectedListener = object : AdapterView.OnItemSelectedListener {
+            override fun onItemSelected(parent: AdapterView<*>?, view: View?, position: Int, id: Long) {
+                if (!isInitializing) {
+                    viewModel.setTargetLatencyMs(targetLatencyOptions[position])
+                }
+            }
+
+            override fun onNothingSelected(parent: AdapterView<*>?) {
+                // Do nothing
+            }
+        }
+    }
+
+    private fun setupFrameMemorySpinner() {
+        val displayNames = frameMemoryOptions.map { budgetMb ->
+            getString(R.string.settings_frame_memory_mb, budgetMb)
+        }
+
+        spinnerFrameMemory.adapter = ArrayAdapter(
+            requireContext(),
+            android.R.layout.simple_spinner_item,
+            displayNames
+        ).apply {
+            setDropDownViewResource(android.R.layout.simple_spinner_dropdown_item)
+        }
+
+        spinnerFrameMemory.onItemSelectedListener = object : AdapterView.OnItemSelectedListener {
+            override fun onItemSelected(parent: AdapterView<*>?, view: View?, position: Int, id: Long) {
+                if (!isInitializing) {
+                    viewModel.setFrameMemoryBudgetMb(frameMemoryOptions[position])
+                }
+            }
+
+            override fun onNothingSelected(parent: AdapterView<*>?) {
+                // Do nothing
+            }
+        }
+    }
+
     private fun setupListeners() {
         btnBack.setOnClickListener {
             parentFragmentManager.popBackStack()
@@ -147,6 +352,46 @@ class SettingsFragment : Fragment() {
             }
         }
 
+        switchLatencyOsd.setOnCheckedChangeListener { _, isChecked ->
+            if (!isInitializing) {
+                viewModel.setLatencyOsd(isChecked)
+            }
+        }
+
+        switchRecord10Bit.setOnCheckedChangeListener { _, isChecked ->
+            if (!isInitializing) {
+                viewModel.setRecord10Bit(isChecked)
+            }
+        }
+
+        switchLowLatency.setOnCheckedChangeListener { _, isChecked ->
+            if (!isInitializing) {
+                viewModel.setLowLatencyMode(isChecked)
+            }
+        }
+
+        switchAdaptiveBandwidth.setOnCheckedChangeListener { _, isChecked ->
+            if (!isInitializing) {
+                viewModel.setAdaptiveBandwidth(isChecked)
+            }
+        }
+
+        switchThreadPlacement.setOnCheckedChangeListener { _, isChecked ->
+            if (!isInitializing) {
+                viewModel.setThreadPlacement(isChecked)
+            }
+        }
+
+        switchRelayMode.setOnCheckedChangeListener { _, isChecked ->
+            if (!isInitializing) {
+                viewModel.setRelayMode(isChecked)
+            }
+        }
+
+        btnTransportBenchmark.setOnClickListener {
+            viewModel.runTransportBenchmark()
+        }
+
         btnClearLastSource.setOnClickListener {
             viewModel.clearLastConnectedSource()
         }
@@ -169,6 +414,12 @@ class SettingsFragment : Fragment() {
         switchAutoReconnect.isChecked = state.settings.autoReconnect
         switchScreenAlwaysOn.isChecked = state.settings.screenAlwaysOn
         switchShowOsd.isChecked = state.settings.showOsd
+        switchLatencyOsd.isChecked = state.settings.latencyOsd
+        switchRecord10Bit.isChecked = state.settings.record10Bit
+        switchLowLatency.isChecked = state.settings.lowLatencyMode
+        switchAdaptiveBandwidth.isChecked = state.settings.adaptiveBandwidth
+        switchThreadPlacement.isChecked = state.settings.threadPlacement
+        switchRelayMode.isChecked = state.settings.relayMode
 
         // Update last connected source
         val hasLastSource = state.settings.lastConnectedSourceName != null
@@ -177,6 +428,42 @@ class SettingsFragment : Fragment() {
             lastSourceName.text = state.settings.lastConnectedSourceName
         }
 
+        // Update deinterlace spinner
+        val deinterlaceIndex = deinterlaceOptions.indexOf(state.settings.deinterlace)
+        if (deinterlaceIndex >= 0) {
+            spinnerDeinterlace.setSelection(deinterlaceIndex)
+        }
+
+        // Update target latency spinner
+        val targetLatencyIndex = targetLatencyOptions.indexOf(state.settings.targetLatencyMs)
+        if (targetLatencyIndex >= 0) {
+            spinnerTargetLatency.setSelection(targetLatencyIndex)
+        }
+
+        // Update frame memory spinner
+        val frameMemoryIndex = frameMemoryOptions.indexOf(state.settings.frameMemoryBudgetMb)
+        if (frameMemoryIndex >= 0) {
+            spinnerFrameMemory.setSelection(frameMemoryIndex)
+        }
+
+        // Update transport spinner and benchmark
+        val transportIndex = transportOptions.indexOf(state.settings.transport)
+        if (transportIndex >= 0) {
+            spinnerTransport.setSelection(transportIndex)
+        }
+        btnTransportBenchmark.isEnabled = !state.transportBenchmarkRunning
+        btnTransportBenchmark.setText(
+            if (state.transportBenchmarkRunning) {
+                R.string.settings_transport_benchmark_running
+            } else {
+                R.string.settings_transport_benchmark_run
+            }
+        )
+        state.transportBenchmark?.let {
+            transportBenchmarkResult.text = formatTransportBenchmark(it)
+        }
+        transportBenchmarkResult.isVisible = state.transportBenchmark != null
+
         // Update language spinner
         val languageIndex = languageOptions.indexOf(state.settings.language)
         if (languageIndex >= 0) {
@@ -8,6 +8,8 @@ import androidx.lifecycle.viewModelScope
 import com.example.ndireceiver.data.AppSettings
 import com.example.ndireceiver.data.RecordingRepository
 import com.example.ndireceiver.data.SettingsRepository
+import com.example.ndireceiver.data.TransportSetting
+import com.example.ndireceiver.ndi.NdiTransport
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asStateFlow
@@ -21,7 +23,9 @@ data class SettingsUiState(
     val settings: AppSettings = AppSettings(),
     val storageLocation: String = "",
     val storageInfo: String = "",
-    val versionInfo: String = "1.0"
+    val versionInfo: String = "1.0",
+    val transportBenchmarkRunning: Boolean = false,
+    val transportBenchmark: List<NdiTransport.BenchmarkEntry>? = null
 )
 
 /**
@@ -127,6 +131,96 @@ class SettingsViewModel(application: Application) : AndroidViewModel(application
         settingsRepository.setShowOsd(enabled)
     }
 
+    /**
+     * Set whether the OSD shows glass-to-glass latency percentiles.
+     */
+    fun setLatencyOsd(enabled: Boolean) {
+        settingsRepository.setLatencyOsd(enabled)
+    }
+
+    /**
+     * Set 10-bit recording preference.
+     */
+    fun setRecord10Bit(enabled: Boolean) {
+        settingsRepository.setRecord10Bit(enabled)
+    }
+
+    /**
+     * Set deinterlacing preference.
+     */
+    fun setDeinterlace(setting: com.example.ndireceiver.data.DeinterlaceSetting) {
+        settingsRepository.setDeinterlace(setting)
+    }
+
+    /**
+     * Set video jitter buffer latency budget.
+     */
+    fun setTargetLatencyMs(latencyMs: Int) {
+        settingsRepository.setTargetLatencyMs(latencyMs)
+    }
+
+    /**
+     * Set low-latency (latest-frame-wins) mode.
+     */
+    fun setLowLatencyMode(enabled: Boolean) {
+        settingsRepository.setLowLatencyMode(enabled)
+    }
+
+    /**
+     * Set adaptive bandwidth.
+     */
+    fun setAdaptiveBandwidth(enabled: Boolean) {
+        settingsRepository.setAdaptiveBandwidth(enabled)
+    }
+
+    /**
+     * Set frame memory budget.
+     */
+    fun setFrameMemoryBudgetMb(budgetMb: Int) {
+        settingsRepository.setFrameMemoryBudgetMb(budgetMb)
+    }
+
+    /**
+     * Set pipeline thread placement.
+     */
+    fun setThreadPlacement(enabled: Boolean) {
+        settingsRepository.setThreadPlacement(enabled)
+    }
+
+    /**
+     * Set relay mode.
+     */
+    fun setRelayMode(enabled: Boolean) {
+        settingsRepository.setRelayMode(enabled)
+    }
+
+    /**
+     * Set the NDI transport. Written for the SDK now, used from its next initialization.
+     */
+    fun setTransport(setting: TransportSetting) {
+        settingsRepository.setTransport(setting)
+        NdiTransport.configure(getApplication(), setting.nativeMode)
+    }
+
+    /**
+     * Probe each transport against the last connected source (a loopback source on this
+     * device if there is none) and select the cheapest reliable one.
+     */
+    fun runTransportBenchmark() {
+        if (_uiState.value.transportBenchmarkRunning) return
+        _uiState.value = _uiState.value.copy(transportBenchmarkRunning = true)
+        viewModelScope.launch {
+            val entries = NdiTransport.benchmark(settingsRepository.getLastConnectedSourceName())
+            NdiTransport.recommend(entries)?.let { mode ->
+                TransportSetting.entries.find { it.nativeMode == mode }?.let { setTransport(it) }
+            }
+            _uiState.value = _uiState.value.copy(
+                transportBenchmarkRunning = false,
+                transportBenchmark = entries
+            )
+        }
+    }
+
     /**
      * Clear last connected source.
      */
@@ -0,0 +1,202 @@
+/**
+ * bandwidth_controller_test.c - Host tests for bandwidth_controller.c
+ *
+ * Samples are fed once a simulated second.
+ */
+
+#include "bandwidth_controller.h"
+#include "test_util.h"
+
+#define SEC(x) ((int64_t)(x) * 1000000000LL)
+
+static const BandwidthSample kHealthy = { 60, 0, 0, 0 };
+static const BandwidthSample kDropping = { 50, 10, 0, 0 };   /* 16.7% dropped */
+static const BandwidthSample kMarginal = { 60, 1, 2, 0 };    /* Neither degraded nor healthy. */
+
+/* Feed sample every second from *t until a switch is requested or max_samples are fed. */
+static int feed(BandwidthController* bc, const BandwidthSample* sample, int64_t* t, int max_samples) {
+    for (int i = 0; i < max_samples; i++) {
+        *t += SEC(1);
+        const int target = bandwidth_controller_update(bc, sample, *t);
+        if (target >= 0) {
+            return target;
+        }
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * Decisions
+ * ========================================================================== */
+
+static void test_healthy_stream_stays_highest(void) {
+    BandwidthController* bc = bandwidth_controller_create();
+    int64_t t = 0;
+    CHECK_EQ_INT(feed(bc, &kHealthy, &t, 100), -1);
+
+    BandwidthControllerStats stats;
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK_EQ_INT(stats.level, BANDWIDTH_LEVEL_HIGHEST);
+    CHECK_EQ_INT(stats.samples, 100);
+    CHECK_EQ_INT(stats.degraded_samples, 0);
+    bandwidth_controller_destroy(bc);
+}
+
+static void test_sustained_drops_downgrade_after_hold(void) {
+    BandwidthController* bc = bandwidth_controller_create();
+    int64_t t = 0;
+    /* The first degraded sample starts the streak; the hold is measured from it. */
+    CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    CHECK_EQ_INT(t, SEC(1) + BANDWIDTH_DEGRADE_HOLD_NS);
+
+    BandwidthControllerStats stats;
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK(stats.pending);
+    CHECK_EQ_INT(stats.pending_level, BANDWIDTH_LEVEL_LOWEST);
+    CHECK_EQ_INT(stats.last_reason, BANDWIDTH_REASON_DROPS);
+    CHECK_EQ_INT(stats.level, BANDWIDTH_LEVEL_HIGHEST);
+
+    /* Nothing more is requested while the switch is pending. */
+    CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), -1);
+
+    bandwidth_controller_switched(bc, true, t);
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK(!stats.pending);
+    CHECK_EQ_INT(stats.level, BANDWIDTH_LEVEL_LOWEST);
+    CHECK_EQ_INT(stats.downgrades, 1);
+    CHECK_EQ_INT(stats.last_switch_ns, t);
+    bandwidth_controller_destroy(bc);
+}
+
+static void test_brief_trouble_is_ignored(void) {
+    BandwidthController* bc = bandwidth_controller_create();
+    int64_t t = 0;
+    for (int i = 0; i < 10; i++) {
+        /* Two degraded seconds, then a marginal one ends the streak. */
+        CHECK_EQ_INT(feed(bc, &kDropping, &t, 2), -1);
+        CHECK_EQ_INT(feed(bc, &kMarginal, &t, 1), -1);
+    }
+    bandwidth_controller_destroy(bc);
+}
+
+static void test_queue_and_backlog_reasons(void) {
+    const BandwidthSample queued = { 60, 0, BANDWIDTH_DEGRADED_QUEUE, 0 };
+    const BandwidthSample backlogged = { 60, 0, 0, BANDWIDTH_DEGRADED_BACKLOG };
+    BandwidthControllerStats stats;
+    int64_t t = 0;
+
+    BandwidthController* bc = bandwidth_controller_create();
+    CHECK_EQ_INT(feed(bc, &queued, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK_EQ_INT(stats.last_reason, BANDWIDTH_REASON_QUEUE);
+    bandwidth_controller_destroy(bc);
+
+    bc = bandwidth_controller_create();
+    CHECK_EQ_INT(feed(bc, &backlogged, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK_EQ_INT(stats.last_reason, BANDWIDTH_REASON_BACKLOG);
+    CHECK_EQ_INT(bandwidth_reason_name(stats.last_reason)[0], 'b');
+    bandwidth_controller_destroy(bc);
+}
+
+static void test_too_few_frames_do_not_count_as_drops(void) {
+    const BandwidthSample sparse = { 2, 2, 0, 0 };
+    BandwidthController* bc = bandwidth_controller_create();
+    int64_t t = 0;
+    CHECK_EQ_INT(feed(bc, &sparse, &t, 20), -1);
+
+    /* Nor as healthy: a stalled stream does not earn an upgrade. */
+    CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    bandwidth_controller_switched(bc, true, t);
+    CHECK_EQ_INT(feed(bc, &sparse, &t, 100), -1);
+    bandwidth_controller_destroy(bc);
+}
+
+/* ============================================================================
+ * Recovery and Flapping
+ * ========================================================================== */
+
+static void test_recovers_after_healthy_hold(void) {
+    BandwidthController* bc = bandwidth_controller_create();
+    int64_t t = 0;
+    CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    bandwidth_controller_switched(bc, true, t);
+
+    const int64_t healthy_from = t + SEC(1);
+    CHECK_EQ_INT(feed(bc, &kHealthy, &t, 100), BANDWIDTH_LEVEL_HIGHEST);
+    CHECK_EQ_INT(t - healthy_from, BANDWIDTH_RECOVER_HOLD_NS);
+    bandwidth_controller_switched(bc, true, t);
+
+    BandwidthControllerStats stats;
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK_EQ_INT(stats.level, BANDWIDTH_LEVEL_HIGHEST);
+    CHECK_EQ_INT(stats.last_reason, BANDWIDTH_REASON_RECOVERED);
+    CHECK_EQ_INT(stats.upgrades, 1);
+    bandwidth_controller_destroy(bc);
+}
+
+static void test_flapping_backs_off(void) {
+    BandwidthController* bc = bandwidth_controller_create();
+    BandwidthControllerStats stats;
+    int64_t t = 0;
+    int64_t expected_hold = BANDWIDTH_RECOVER_HOLD_NS;
+
+    for (int round = 0; round < 8; round++) {
+        /* The full stream fails right after every upgrade. */
+        CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+        bandwidth_controller_switched(bc, true, t);
+        bandwidth_controller_get_stats(bc, &stats);
+        CHECK_EQ_INT(stats.recover_hold_ns, expected_hold);
+
+        const int64_t healthy_from = t + SEC(1);
+        CHECK_EQ_INT(feed(bc, &kHealthy, &t, 1000), BANDWIDTH_LEVEL_HIGHEST);
+        CHECK_EQ_INT(t - healthy_from, expected_hold);
+        bandwidth_controller_switched(bc, true, t);
+
+        expected_hold *= 2;
+        if (expected_hold > BANDWIDTH_RECOVER_HOLD_MAX_NS) {
+            expected_hold = BANDWIDTH_RECOVER_HOLD_MAX_NS;
+        }
+    }
+
+    /* A long stable stretch at full bandwidth forgives the history. */
+    CHECK_EQ_INT(feed(bc, &kHealthy, &t, 400), -1);
+    CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    bandwidth_controller_switched(bc, true, t);
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK_EQ_INT(stats.recover_hold_ns, BANDWIDTH_RECOVER_HOLD_NS);
+    CHECK_EQ_INT(stats.downgrades, 9);
+    CHECK_EQ_INT(stats.upgrades, 8);
+    bandwidth_controller_destroy(bc);
+}
+
+static void test_failed_switch_keeps_level_and_retries(void) {
+    BandwidthController* bc = bandwidth_controller_create();
+    int64_t t = 0;
+    CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    bandwidth_controller_switched(bc, false, t);
+
+    BandwidthControllerStats stats;
+    bandwidth_controller_get_stats(bc, &stats);
+    CHECK(!stats.pending);
+    CHECK_EQ_INT(stats.level, BANDWIDTH_LEVEL_HIGHEST);
+    CHECK_EQ_INT(stats.failed_switches, 1);
+
+    /* The streak starts over. */
+    const int64_t retry_from = t + SEC(1);
+    CHECK_EQ_INT(feed(bc, &kDropping, &t, 10), BANDWIDTH_LEVEL_LOWEST);
+    CHECK_EQ_INT(t - retry_from, BANDWIDTH_DEGRADE_HOLD_NS);
+    bandwidth_controller_destroy(bc);
+}
+
+int main(void) {
+    RUN_TEST(test_healthy_stream_stays_highest);
+    RUN_TEST(test_sustained_drops_downgrade_after_hold);
+    RUN_TEST(test_brief_trouble_is_ignored);
+    RUN_TEST(test_queue_and_backlog_reasons);
+    RUN_TEST(test_too_few_frames_do_not_count_as_drops);
+    RUN_TEST(test_recovers_after_healthy_hold);
+    RUN_TEST(test_flapping_backs_off);
+    RUN_TEST(test_failed_switch_keeps_level_and_retries);
+    return TEST_EXIT_CODE();
+}
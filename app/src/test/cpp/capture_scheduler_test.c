@@ -0,0 +1,254 @@
+/**
+ * capture_scheduler_test.c - Host tests for capture_scheduler.c
+ *
+ * Runs real worker threads against fake sources; bounds on timing are kept loose.
+ */
+
+#include "capture_scheduler.h"
+#include "test_util.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MS(x) ((int64_t)(x) * 1000000LL)
+
+typedef struct FakeSource {
+    pthread_mutex_t lock;
+    int pending;          /* Frames the next service captures; -1 captures one every time. */
+    int in_service;
+    int overlaps;         /* Services that found another one running. */
+    int64_t service_ns;   /* How long a service takes. */
+    int64_t ready_at_ns;  /* Reported by the due callback. */
+} FakeSource;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+
+static void sleep_ms(int ms) {
+    usleep((useconds_t)ms * 1000);
+}
+
+static void fake_init(FakeSource* f, int pending) {
+    pthread_mutex_init(&f->lock, NULL);
+    f->pending = pending;
+    f->in_service = 0;
+    f->overlaps = 0;
+    f->service_ns = 0;
+    f->ready_at_ns = INT64_MAX;
+}
+
+static int fake_service(void* context) {
+    FakeSource* f = (FakeSource*)context;
+    pthread_mutex_lock(&f->lock);
+    if (f->in_service > 0) {
+        f->overlaps++;
+    }
+    f->in_service++;
+    const int frames = (f->pending < 0) ? 1 : f->pending;
+    if (f->pending > 0) {
+        f->pending = 0;
+    }
+    const int64_t service_ns = f->service_ns;
+    pthread_mutex_unlock(&f->lock);
+
+    if (service_ns > 0) {
+        usleep((useconds_t)(service_ns / 1000));
+    }
+
+    pthread_mutex_lock(&f->lock);
+    f->in_service--;
+    pthread_mutex_unlock(&f->lock);
+    return frames;
+}
+
+static int64_t fake_due(void* context) {
+    FakeSource* f = (FakeSource*)context;
+    pthread_mutex_lock(&f->lock);
+    const int64_t due = f->ready_at_ns;
+    pthread_mutex_unlock(&f->lock);
+    return due;
+}
+
+static uint64_t frames_of(CaptureScheduler* cs, FakeSource* f) {
+    CaptureSourceStats stats;
+    capture_scheduler_get_stats(cs, f, &stats);
+    return stats.frames;
+}
+
+/* ============================================================================
+ * Servicing
+ * ========================================================================== */
+
+static void test_default_workers(void) {
+    CHECK_EQ_INT(capture_scheduler_default_workers(1), 1);
+    CHECK_EQ_INT(capture_scheduler_default_workers(8), 2);
+    CHECK_EQ_INT(capture_scheduler_default_workers(64), CAPTURE_SCHEDULER_MAX_WORKERS);
+}
+
+static void test_one_worker_services_every_source(void) {
+    enum { SOURCES = 6 };
+    FakeSource fakes[SOURCES];
+    CaptureScheduler* cs = capture_scheduler_create(1, NULL, NULL);
+    CHECK_EQ_INT(capture_scheduler_worker_count(cs), 1);
+    for (int i = 0; i < SOURCES; i++) {
+        fake_init(&fakes[i], 10 + i);
+        CHECK(capture_scheduler_add(cs, &fakes[i], fake_service, fake_due));
+    }
+    CHECK(!capture_scheduler_add(cs, &fakes[0], fake_service, fake_due));
+
+    sleep_ms(50);
+    for (int i = 0; i < SOURCES; i++) {
+        CHECK_EQ_INT(frames_of(cs, &fakes[i]), 10 + i);
+    }
+    capture_scheduler_destroy(cs);
+}
+
+static void test_source_never_serviced_concurrently(void) {
+    FakeSource busy;
+    fake_init(&busy, -1);
+    busy.service_ns = MS(1);
+    CaptureScheduler* cs = capture_scheduler_create(CAPTURE_SCHEDULER_MAX_WORKERS, NULL, NULL);
+    capture_scheduler_add(cs, &busy, fake_service, fake_due);
+    sleep_ms(50);
+    capture_scheduler_destroy(cs);
+    CHECK_EQ_INT(busy.overlaps, 0);
+}
+
+static void test_idle_source_backs_off(void) {
+    FakeSource idle;
+    fake_init(&idle, 0);
+    CaptureScheduler* cs = capture_scheduler_create(1, NULL, NULL);
+    capture_scheduler_add(cs, &idle, fake_service, fake_due);
+    sleep_ms(200);
+
+    CaptureSourceStats stats;
+    capture_scheduler_get_stats(cs, &idle, &stats);
+    /* 1 + 2 + 4 ms, then every 8 ms: about 25 services, never a spin. */
+    CHECK(stats.services >= 5);
+    CHECK(stats.services <= 40);
+    CHECK_EQ_INT(stats.idle_services, stats.services);
+
+    /* Frames make it due again at once. */
+    pthread_mutex_lock(&idle.lock);
+    idle.pending = 3;
+    pthread_mutex_unlock(&idle.lock);
+    sleep_ms(30);
+    CHECK_EQ_INT(frames_of(cs, &idle), 3);
+    capture_scheduler_destroy(cs);
+}
+
+/* ============================================================================
+ * Focus
+ * ========================================================================== */
+
+static void test_focus_share(void) {
+    enum { SOURCES = 3 };
+    FakeSource fakes[SOURCES];
+    CaptureScheduler* cs = capture_scheduler_create(1, NULL, NULL);
+    for (int i = 0; i < SOURCES; i++) {
+        fake_init(&fakes[i], -1);
+        fakes[i].service_ns = MS(1);
+        capture_scheduler_add(cs, &fakes[i], fake_service, fake_due);
+    }
+    capture_scheduler_set_focus(cs, &fakes[1]);
+    sleep_ms(150);
+
+    CaptureSourceStats stats[SOURCES];
+    for (int i = 0; i < SOURCES; i++) {
+        capture_scheduler_get_stats(cs, &fakes[i], &stats[i]);
+    }
+    capture_scheduler_destroy(cs);
+
+    /* Each focused burst is followed by one service of the longest waiting other source. */
+    CHECK(stats[1].focused);
+    CHECK(!stats[0].focused);
+    CHECK(stats[0].services > 0);
+    CHECK(stats[2].services > 0);
+    CHECK(stats[1].services >= 3 * stats[0].services);
+    CHECK(stats[1].services >= 3 * stats[2].services);
+}
+
+/* ============================================================================
+ * Consumer Side and Removal
+ * ========================================================================== */
+
+static void test_wait_ready_returns_due_source(void) {
+    FakeSource a;
+    FakeSource b;
+    fake_init(&a, 0);
+    fake_init(&b, 0);
+    CaptureScheduler* cs = capture_scheduler_create(1, NULL, NULL);
+    capture_scheduler_add(cs, &a, fake_service, fake_due);
+    capture_scheduler_add(cs, &b, fake_service, fake_due);
+
+    /* Nothing due: times out. */
+    int64_t start = now_ns();
+    CHECK(capture_scheduler_wait_ready(cs, MS(20)) == NULL);
+    CHECK(now_ns() - start >= MS(20));
+
+    /* A frame coming due wakes the consumer at its playout time. */
+    start = now_ns();
+    a.ready_at_ns = start + MS(30);
+    CHECK(capture_scheduler_wait_ready(cs, MS(1000)) == &a);
+    CHECK(now_ns() - start >= MS(30));
+    CHECK(now_ns() - start < MS(500));
+
+    /* With both due the focused one comes first, else the earliest. */
+    b.ready_at_ns = a.ready_at_ns - MS(5);
+    CHECK(capture_scheduler_wait_ready(cs, 0) == &b);
+    capture_scheduler_set_focus(cs, &a);
+    CHECK(capture_scheduler_wait_ready(cs, 0) == &a);
+    capture_scheduler_destroy(cs);
+}
+
+static void test_remove_waits_for_service(void) {
+    FakeSource slow;
+    fake_init(&slow, -1);
+    slow.service_ns = MS(40);
+    CaptureScheduler* cs = capture_scheduler_create(2, NULL, NULL);
+    capture_scheduler_add(cs, &slow, fake_service, fake_due);
+    capture_scheduler_set_focus(cs, &slow);
+    sleep_ms(10);
+
+    CHECK(capture_scheduler_remove(cs, &slow));
+    CHECK_EQ_INT(slow.in_service, 0);
+    CHECK(!capture_scheduler_remove(cs, &slow));
+
+    CaptureSourceStats stats;
+    CHECK(!capture_scheduler_get_stats(cs, &slow, &stats));
+    /* The slot is free again and the focus went with the source. */
+    CHECK(capture_scheduler_add(cs, &slow, fake_service, fake_due));
+    CHECK(capture_scheduler_get_stats(cs, &slow, &stats));
+    CHECK(!stats.focused);
+    capture_scheduler_destroy(cs);
+}
+
+static void worker_started(int worker, void* context) {
+    int* started = (int*)context;
+    __atomic_fetch_or(started, 1 << worker, __ATOMIC_SEQ_CST);
+}
+
+static void test_worker_start_hook(void) {
+    int started = 0;
+    CaptureScheduler* cs = capture_scheduler_create(3, worker_started, &started);
+    sleep_ms(20);
+    capture_scheduler_destroy(cs);
+    CHECK_EQ_INT(started, 7);
+}
+
+int main(void) {
+    RUN_TEST(test_default_workers);
+    RUN_TEST(test_one_worker_services_every_source);
+    RUN_TEST(test_source_never_serviced_concurrently);
+    RUN_TEST(test_idle_source_backs_off);
+    RUN_TEST(test_focus_share);
+    RUN_TEST(test_wait_ready_returns_due_source);
+    RUN_TEST(test_remove_waits_for_service);
+    RUN_TEST(test_worker_start_hook);
+    return TEST_EXIT_CODE();
+}
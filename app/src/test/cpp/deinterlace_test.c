@@ -0,0 +1,276 @@
+/**
+ * deinterlace_test.c - Host tests for deinterlace.c
+ *
+ * A synthetic NV12 scene (vertical luma ramp with a box moving two pixels per field) is
+ * interlaced and run through each mode. Outputs are compared against golden images in
+ * golden/ (argv[1]) and checked for the properties each mode guarantees.
+ */
+
+#include "deinterlace.h"
+#include "golden_image.h"
+#include "test_util.h"
+
+#include <string.h>
+
+#define FOURCC_NV12 0x3231564Eu
+#define FOURCC_P216 0x36313250u
+
+#define W 16
+#define H 12
+#define STRIDE 20                     /* Padded so that stride handling is exercised. */
+#define FRAME_SIZE (STRIDE * (H + H / 2))
+
+static const char* g_golden_dir = "golden";
+
+static int box_left(int field_time) {
+    return 2 + (field_time * 2);
+}
+
+static uint8_t scene_luma(int field_time, int x, int y) {
+    const int left = box_left(field_time);
+    if (x >= left && x < left + 4 && y >= 3 && y < 9) {
+        return 220;
+    }
+    return (uint8_t)(40 + (y * 8));
+}
+
+/* Chroma sample (cx, cy) covers luma pixels (2cx..2cx+1, 2cy..2cy+1). */
+static void scene_chroma(int field_time, int cx, int cy, uint8_t* u, uint8_t* v) {
+    const bool in_box = scene_luma(field_time, cx * 2, cy * 2) == 220;
+    *u = in_box ? 90 : 128;
+    *v = in_box ? 200 : 128;
+}
+
+/* Interleaved frame n: even lines from field time 2n, odd lines from field time 2n+1. */
+static void make_interleaved(int n, uint8_t* frame) {
+    memset(frame, 0xEE, FRAME_SIZE);
+    for (int y = 0; y < H; y++) {
+        const int t = (2 * n) + (y & 1);
+        for (int x = 0; x < W; x++) {
+            frame[(y * STRIDE) + x] = scene_luma(t, x, y);
+        }
+    }
+    uint8_t* uv = frame + (STRIDE * H);
+    for (int cy = 0; cy < H / 2; cy++) {
+        const int t = (2 * n) + (cy & 1);
+        for (int cx = 0; cx < W / 2; cx++) {
+            scene_chroma(t, cx, cy, &uv[(cy * STRIDE) + (cx * 2)], &uv[(cy * STRIDE) + (cx * 2) + 1]);
+        }
+    }
+}
+
+/* Field k: parity k & 1, sampled at field time k. Holds H/2 luma and H/4 chroma lines. */
+static void make_field(int k, uint8_t* field) {
+    const int parity = k & 1;
+    memset(field, 0xEE, FRAME_SIZE);
+    for (int i = 0; i < H / 2; i++) {
+        for (int x = 0; x < W; x++) {
+            field[(i * STRIDE) + x] = scene_luma(k, x, (2 * i) + parity);
+        }
+    }
+    uint8_t* uv = field + (STRIDE * (H / 2));
+    for (int i = 0; i < H / 4; i++) {
+        for (int cx = 0; cx < W / 2; cx++) {
+            scene_chroma(k, cx, (2 * i) + parity, &uv[(i * STRIDE) + (cx * 2)], &uv[(i * STRIDE) + (cx * 2) + 1]);
+        }
+    }
+}
+
+static DeinterlaceInput interleaved_input(const uint8_t* frame) {
+    const DeinterlaceInput in = {
+        .data = frame, .fourcc = FOURCC_NV12, .width = W, .height = H, .stride = STRIDE,
+        .field = DEINTERLACE_INTERLEAVED,
+    };
+    return in;
+}
+
+static DeinterlaceInput field_input(const uint8_t* field, int k) {
+    const DeinterlaceInput in = {
+        .data = field, .fourcc = FOURCC_NV12, .width = W, .height = H / 2, .stride = STRIDE,
+        .field = (k & 1) ? DEINTERLACE_FIELD_1 : DEINTERLACE_FIELD_0,
+    };
+    return in;
+}
+
+static bool rows_equal(const uint8_t* a, const uint8_t* b, int row) {
+    return memcmp(a + (row * STRIDE), b + (row * STRIDE), W) == 0;
+}
+
+static void check_golden(const char* name, const DeinterlaceOutput* out) {
+    CHECK(golden_image_matches(g_golden_dir, name, out->data, W, out->height + (out->height / 2), out->stride));
+}
+
+/* ============================================================================
+ * Tests
+ * ========================================================================== */
+
+static void test_passthrough_cases(void) {
+    uint8_t frame[FRAME_SIZE];
+    make_interleaved(0, frame);
+    Deinterlacer* d = deinterlacer_create();
+    DeinterlaceOutput out;
+
+    DeinterlaceInput in = interleaved_input(frame);
+    CHECK(!deinterlacer_process(d, &in, &out));  /* OFF by default */
+
+    deinterlacer_set_mode(d, DEINTERLACE_WEAVE);
+    CHECK(!deinterlacer_process(d, &in, &out));  /* weaving an interleaved frame is a no-op */
+
+    deinterlacer_set_mode(d, DEINTERLACE_BOB);
+    in.fourcc = FOURCC_P216;
+    CHECK(!deinterlacer_process(d, &in, &out));
+    CHECK(!deinterlace_supports_fourcc(FOURCC_P216));
+    CHECK(deinterlace_supports_fourcc(FOURCC_NV12));
+
+    DeinterlaceStats stats;
+    deinterlacer_get_stats(d, &stats);
+    CHECK_EQ_INT(stats.frames, 0);
+    deinterlacer_destroy(d);
+}
+
+static void test_bob_interleaved(void) {
+    uint8_t frame[FRAME_SIZE];
+    make_interleaved(0, frame);
+    Deinterlacer* d = deinterlacer_create();
+    deinterlacer_set_mode(d, DEINTERLACE_BOB);
+
+    const DeinterlaceInput in = interleaved_input(frame);
+    DeinterlaceOutput out;
+    CHECK(deinterlacer_process(d, &in, &out));
+    CHECK_EQ_INT(out.height, H);
+    CHECK_EQ_INT(out.size, FRAME_SIZE);
+
+    /* Field 1 lines are kept as delivered, in both planes. */
+    for (int row = 1; row < H + (H / 2); row += 2) {
+        CHECK(rows_equal(out.data, frame, row));
+    }
+    /* The ramp is linear, so bob rebuilds interior background samples exactly. */
+    CHECK_EQ_INT(out.data[(4 * STRIDE) + 15], scene_luma(0, 15, 4));
+
+    check_golden("bob_interleaved", &out);
+    deinterlacer_destroy(d);
+}
+
+static void test_motion_adaptive_static_scene_is_woven(void) {
+    uint8_t frame[FRAME_SIZE];
+    make_interleaved(0, frame);
+    Deinterlacer* d = deinterlacer_create();
+    deinterlacer_set_mode(d, DEINTERLACE_MOTION_ADAPTIVE);
+
+    const DeinterlaceInput in = interleaved_input(frame);
+    DeinterlaceOutput out;
+    CHECK(deinterlacer_process(d, &in, &out));  /* no history yet: bob */
+    CHECK(deinterlacer_process(d, &in, &out));  /* identical input: nothing moved */
+    for (int row = 0; row < H + (H / 2); row++) {
+        CHECK(rows_equal(out.data, frame, row));
+    }
+    deinterlacer_destroy(d);
+}
+
+static void test_motion_adaptive_interleaved(void) {
+    uint8_t frame0[FRAME_SIZE];
+    uint8_t frame1[FRAME_SIZE];
+    make_interleaved(0, frame0);
+    make_interleaved(1, frame1);
+    Deinterlacer* d = deinterlacer_create();
+    deinterlacer_set_mode(d, DEINTERLACE_MOTION_ADAPTIVE);
+
+    DeinterlaceInput in = interleaved_input(frame0);
+    DeinterlaceOutput first;
+    CHECK(deinterlacer_process(d, &in, &first));
+
+    in = interleaved_input(frame1);
+    DeinterlaceOutput second;
+    CHECK(deinterlacer_process(d, &in, &second));
+    CHECK(first.data != second.data);  /* the previous output stays valid */
+
+    /* Rows away from the box are woven from the source... */
+    CHECK(rows_equal(second.data, frame1, 10));
+    /* ...while around the moving box line 4 is interpolated from field 1 instead of combing:
+     * x=10 is box in field 1 but background in field 0, x=6 the other way round. */
+    CHECK_EQ_INT(frame1[(4 * STRIDE) + 10], 72);
+    CHECK_EQ_INT(second.data[(4 * STRIDE) + 10], 220);
+    CHECK_EQ_INT(frame1[(4 * STRIDE) + 6], 220);
+    CHECK_EQ_INT(second.data[(4 * STRIDE) + 6], (64 + 80 + 1) / 2);
+
+    check_golden("motion_adaptive_interleaved", &second);
+
+    DeinterlaceStats stats;
+    deinterlacer_get_stats(d, &stats);
+    CHECK_EQ_INT(stats.frames, 2);
+    CHECK(stats.total_ns >= stats.last_ns);
+    deinterlacer_destroy(d);
+}
+
+/* Feeds fields 0..count-1 and returns the output for the last one. */
+static void run_fields(Deinterlacer* d, int count, uint8_t* field, DeinterlaceOutput* out) {
+    for (int k = 0; k < count; k++) {
+        make_field(k, field);
+        const DeinterlaceInput in = field_input(field, k);
+        CHECK(deinterlacer_process(d, &in, out));
+        CHECK_EQ_INT(out->height, H);
+    }
+}
+
+static void test_single_fields(void) {
+    uint8_t field[FRAME_SIZE];
+    DeinterlaceOutput out;
+
+    Deinterlacer* d = deinterlacer_create();
+    deinterlacer_set_mode(d, DEINTERLACE_WEAVE);
+    run_fields(d, 2, field, &out);
+    /* Weaving fields 0 and 1 gives back interleaved frame 0. */
+    uint8_t frame0[FRAME_SIZE];
+    make_interleaved(0, frame0);
+    for (int row = 0; row < H + (H / 2); row++) {
+        CHECK(rows_equal(out.data, frame0, row));
+    }
+    check_golden("weave_fields", &out);
+    deinterlacer_destroy(d);
+
+    d = deinterlacer_create();
+    deinterlacer_set_mode(d, DEINTERLACE_BOB);
+    run_fields(d, 3, field, &out);
+    check_golden("bob_fields", &out);
+    deinterlacer_destroy(d);
+
+    d = deinterlacer_create();
+    deinterlacer_set_mode(d, DEINTERLACE_MOTION_ADAPTIVE);
+    run_fields(d, 4, field, &out);
+    check_golden("motion_adaptive_fields", &out);
+    deinterlacer_destroy(d);
+}
+
+static void test_plane_edges(void) {
+    const uint8_t src[3 * 4] = {
+        10, 20, 30, 40,
+        50, 60, 70, 80,
+        90, 100, 110, 120,
+    };
+    uint8_t dst[3 * 4];
+
+    /* Keep even lines: the middle line averages its neighbours. */
+    deinterlace_plane(src, NULL, dst, 4, 4, 3, 0, DEINTERLACE_BOB, 0);
+    CHECK_EQ_INT(dst[4], 50);
+    CHECK_EQ_INT(dst[7], 80);
+    CHECK(memcmp(dst + 8, src + 8, 4) == 0);
+
+    /* Keep odd lines: the first and last lines mirror their only neighbour. */
+    deinterlace_plane(src, NULL, dst, 4, 4, 3, 1, DEINTERLACE_BOB, 0);
+    CHECK(memcmp(dst, src + 4, 4) == 0);
+    CHECK(memcmp(dst + 8, src + 4, 4) == 0);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        g_golden_dir = argv[1];
+    }
+
+    RUN_TEST(test_passthrough_cases);
+    RUN_TEST(test_bob_interleaved);
+    RUN_TEST(test_motion_adaptive_static_scene_is_woven);
+    RUN_TEST(test_motion_adaptive_interleaved);
+    RUN_TEST(test_single_fields);
+    RUN_TEST(test_plane_edges);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,186 @@
+/**
+ * frame_arena_test.c - Host tests for frame_arena.c
+ */
+
+#include "frame_arena.h"
+#include "test_util.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define MIB (1024LL * 1024LL)
+
+static void test_size_classes(void) {
+    CHECK_EQ_INT(frame_arena_block_size(1), 64 * 1024);
+    CHECK_EQ_INT(frame_arena_block_size(1280 * 720 * 4), 4 * MIB);
+    CHECK_EQ_INT(frame_arena_block_size(1920 * 1080 * 4), 8 * MIB);
+    CHECK_EQ_INT(frame_arena_block_size(3840 * 2160 * 4), 32 * MIB);
+    /* Beyond the largest class: rounded to 4 KiB. */
+    CHECK_EQ_INT(frame_arena_block_size((size_t)(32 * MIB) + 1), 32 * MIB + 4096);
+}
+
+static void test_alloc_is_aligned_and_writable(void) {
+    FrameArena* arena = frame_arena_create(64 * MIB);
+    uint8_t* a = (uint8_t*)frame_arena_alloc(arena, FRAME_ARENA_AUDIO, 1000);
+    uint8_t* b = (uint8_t*)frame_arena_alloc(arena, FRAME_ARENA_RECORDER, 1920 * 1080 * 2);
+    CHECK(a != NULL && b != NULL);
+    CHECK_EQ_INT((uintptr_t)a % FRAME_ARENA_ALIGNMENT, 0);
+    CHECK_EQ_INT((uintptr_t)b % FRAME_ARENA_ALIGNMENT, 0);
+    memset(a, 0xAB, 64 * 1024);
+    memset(b, 0xCD, 1920 * 1080 * 2);
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.used_bytes, 64 * 1024 + 4 * MIB);
+    CHECK_EQ_INT(stats.consumers[FRAME_ARENA_AUDIO].current_bytes, 64 * 1024);
+    CHECK_EQ_INT(stats.consumers[FRAME_ARENA_RECORDER].current_bytes, 4 * MIB);
+
+    frame_arena_free(arena, a);
+    frame_arena_free(arena, b);
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.used_bytes, 0);
+    CHECK_EQ_INT(stats.consumers[FRAME_ARENA_RECORDER].peak_bytes, 4 * MIB);
+    frame_arena_destroy(arena);
+}
+
+static void test_free_blocks_are_reused(void) {
+    FrameArena* arena = frame_arena_create(64 * MIB);
+    void* first = frame_arena_alloc(arena, FRAME_ARENA_DECODER, 200 * 1024);
+    frame_arena_free(arena, first);
+    void* second = frame_arena_alloc(arena, FRAME_ARENA_DECODER, 100 * 1024);
+    CHECK(second == first);
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.reuses, 1);
+    CHECK_EQ_INT(stats.cached_bytes, 0);
+    frame_arena_free(arena, second);
+
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.cached_bytes, 256 * 1024);
+    frame_arena_trim(arena);
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.cached_bytes, 0);
+    frame_arena_destroy(arena);
+}
+
+static void test_budget_applies_back_pressure(void) {
+    FrameArena* arena = frame_arena_create(20 * MIB);
+    void* blocks[3];
+    blocks[0] = frame_arena_alloc(arena, FRAME_ARENA_RECORDER, 8 * MIB);
+    blocks[1] = frame_arena_alloc(arena, FRAME_ARENA_RECORDER, 8 * MIB);
+    CHECK(blocks[0] != NULL && blocks[1] != NULL);
+
+    /* The third 8 MiB frame does not fit: the producer is refused, not grown. */
+    blocks[2] = frame_arena_alloc(arena, FRAME_ARENA_RECORDER, 8 * MIB);
+    CHECK(blocks[2] == NULL);
+    /* A smaller request from another consumer still fits. */
+    void* audio = frame_arena_alloc(arena, FRAME_ARENA_AUDIO, 16 * 1024);
+    CHECK(audio != NULL);
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.rejected, 1);
+    CHECK_EQ_INT(stats.consumers[FRAME_ARENA_RECORDER].rejected, 1);
+    CHECK_EQ_INT(stats.consumers[FRAME_ARENA_AUDIO].rejected, 0);
+
+    /* Once the consumer catches up, allocation succeeds again. */
+    frame_arena_free(arena, blocks[0]);
+    blocks[2] = frame_arena_alloc(arena, FRAME_ARENA_RECORDER, 8 * MIB);
+    CHECK(blocks[2] != NULL);
+
+    frame_arena_free(arena, blocks[1]);
+    frame_arena_free(arena, blocks[2]);
+    frame_arena_free(arena, audio);
+    frame_arena_destroy(arena);
+}
+
+static void test_cached_blocks_yield_to_new_classes(void) {
+    FrameArena* arena = frame_arena_create(10 * MIB);
+    void* big = frame_arena_alloc(arena, FRAME_ARENA_RENDERER, 8 * MIB);
+    frame_arena_free(arena, big);
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.cached_bytes, 8 * MIB);
+
+    /* A 4 MiB block would push held memory past the budget: the cached 8 MiB block goes. */
+    void* small = frame_arena_alloc(arena, FRAME_ARENA_RENDERER, 4 * MIB);
+    CHECK(small != NULL);
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.cached_bytes, 0);
+    CHECK(stats.used_bytes + stats.cached_bytes <= stats.budget_bytes);
+
+    frame_arena_free(arena, small);
+    frame_arena_destroy(arena);
+}
+
+static void test_reservations_share_the_budget(void) {
+    FrameArena* arena = frame_arena_create(16 * MIB);
+    CHECK(frame_arena_reserve(arena, FRAME_ARENA_RENDERER, 10 * MIB));
+    CHECK(!frame_arena_reserve(arena, FRAME_ARENA_CONVERTER, 8 * MIB));
+    CHECK(frame_arena_alloc(arena, FRAME_ARENA_RECORDER, 8 * MIB) == NULL);
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.used_bytes, 10 * MIB);
+    CHECK_EQ_INT(stats.consumers[FRAME_ARENA_CONVERTER].current_bytes, 0);
+    CHECK_EQ_INT(stats.consumers[FRAME_ARENA_CONVERTER].rejected, 1);
+
+    frame_arena_unreserve(arena, FRAME_ARENA_RENDERER, 10 * MIB);
+    CHECK(frame_arena_reserve(arena, FRAME_ARENA_CONVERTER, 8 * MIB));
+    frame_arena_unreserve(arena, FRAME_ARENA_CONVERTER, 8 * MIB);
+
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.used_bytes, 0);
+    CHECK_EQ_INT(stats.peak_used_bytes, 10 * MIB);
+    frame_arena_destroy(arena);
+}
+
+static void test_lowering_budget_trims_cache(void) {
+    FrameArena* arena = frame_arena_create(64 * MIB);
+    void* blocks[4];
+    for (int i = 0; i < 4; i++) {
+        blocks[i] = frame_arena_alloc(arena, FRAME_ARENA_DECODER, 1 * MIB);
+    }
+    for (int i = 0; i < 4; i++) {
+        frame_arena_free(arena, blocks[i]);
+    }
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.cached_bytes, 4 * MIB);
+
+    frame_arena_set_budget(arena, 2 * MIB);
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.budget_bytes, 2 * MIB);
+    CHECK(stats.cached_bytes <= 2 * MIB);
+    frame_arena_destroy(arena);
+}
+
+static void test_invalid_requests(void) {
+    FrameArena* arena = frame_arena_create(8 * MIB);
+    CHECK(frame_arena_alloc(arena, -1, 1024) == NULL);
+    CHECK(frame_arena_alloc(arena, FRAME_ARENA_MAX_CONSUMERS, 1024) == NULL);
+    CHECK(frame_arena_alloc(arena, FRAME_ARENA_AUDIO, 0) == NULL);
+    CHECK(!frame_arena_reserve(arena, FRAME_ARENA_AUDIO, -5));
+    frame_arena_free(arena, NULL);
+
+    FrameArenaStats stats;
+    frame_arena_get_stats(arena, &stats);
+    CHECK_EQ_INT(stats.used_bytes, 0);
+    CHECK_EQ_INT(stats.allocs, 0);
+    frame_arena_destroy(arena);
+}
+
+int main(void) {
+    RUN_TEST(test_size_classes);
+    RUN_TEST(test_alloc_is_aligned_and_writable);
+    RUN_TEST(test_free_blocks_are_reused);
+    RUN_TEST(test_budget_applies_back_pressure);
+    RUN_TEST(test_cached_blocks_yield_to_new_classes);
+    RUN_TEST(test_reservations_share_the_budget);
+    RUN_TEST(test_lowering_budget_trims_cache);
+    RUN_TEST(test_invalid_requests);
+    return TEST_EXIT_CODE();
+}
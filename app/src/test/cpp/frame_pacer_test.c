@@ -0,0 +1,309 @@
+/**
+ * frame_pacer_test.c - Host tests for frame_pacer.c
+ *
+ * A fake clock interleaves frame arrivals and vsync callbacks in time order, the way the
+ * receive thread and Choreographer drive the pacer on device. Cadence, drop, repeat and
+ * resync counts are exact because nothing depends on the real clock.
+ */
+
+#include "frame_pacer.h"
+#include "test_util.h"
+
+#include <string.h>
+
+#define MAX_FRAMES 4096
+#define VSYNC_60HZ_NS 16666667LL
+#define VSYNC_59_94HZ_NS 16683350LL
+
+typedef struct FakeClock {
+    int64_t now_ns;
+} FakeClock;
+
+typedef struct Scenario {
+    int frames;
+    int rate_n;                 /* Sender frame rate rate_n / rate_d. */
+    int rate_d;
+    int64_t vsync_period_ns;
+    int64_t vsync_phase_ns;     /* First vsync time. */
+    int64_t max_jitter_ns;      /* Arrival delay added per frame, 0..max. */
+    int lost_first;             /* Frames [lost_first, lost_first + lost_count) never arrive. */
+    int lost_count;
+} Scenario;
+
+typedef struct Result {
+    FramePacerStats stats;
+    int presented;
+    int present_vsync[MAX_FRAMES];   /* Vsync index each frame was shown at, or -1. */
+    bool in_order;
+} Result;
+
+static const int64_t kBase = 5000000000LL;  /* Arbitrary CLOCK_MONOTONIC origin. */
+
+static int64_t frame_timestamp_100ns(const Scenario* s, int k) {
+    return ((int64_t)k * 10000000LL * s->rate_d) / s->rate_n;
+}
+
+static int64_t frame_duration_ns(const Scenario* s) {
+    return (1000000000LL * s->rate_d) / s->rate_n;
+}
+
+/* Deterministic arrival jitter (LCG), so runs are reproducible. */
+static int64_t jitter_ns(const Scenario* s, int k) {
+    if (s->max_jitter_ns <= 0) {
+        return 0;
+    }
+    const uint32_t x = ((uint32_t)k * 1103515245u) + 12345u;
+    return (int64_t)((x >> 8) % (uint32_t)(s->max_jitter_ns + 1));
+}
+
+static bool is_lost(const Scenario* s, int k) {
+    return k >= s->lost_first && k < s->lost_first + s->lost_count;
+}
+
+/* Runs until the last frame is shown, so the end of the stream does not count as repeats. */
+static void simulate(const Scenario* s, Result* r) {
+    FramePacer* pacer = frame_pacer_create(4);
+    FakeClock clock = { .now_ns = kBase };
+    memset(r, 0, sizeof(*r));
+    r->in_order = true;
+    for (int k = 0; k < MAX_FRAMES; k++) {
+        r->present_vsync[k] = -1;
+    }
+
+    int next_frame = 0;
+    int vsync_index = 0;
+    int64_t last_presented = -1;
+    const int64_t end_ns = kBase + (frame_timestamp_100ns(s, s->frames) * 100) + 200000000LL;
+
+    while (clock.now_ns < end_ns && last_presented != s->frames - 1) {
+        while (next_frame < s->frames && is_lost(s, next_frame)) {
+            next_frame++;
+        }
+        const int64_t arrival = next_frame < s->frames
+            ? kBase + (frame_timestamp_100ns(s, next_frame) * 100) + jitter_ns(s, next_frame)
+            : INT64_MAX;
+        const int64_t vsync = kBase + s->vsync_phase_ns + (vsync_index * s->vsync_period_ns);
+
+        if (arrival <= vsync) {
+            clock.now_ns = arrival;
+            const int64_t back = frame_pacer_enqueue(
+                pacer, next_frame, frame_timestamp_100ns(s, next_frame), frame_duration_ns(s), clock.now_ns);
+            CHECK_EQ_INT(back, -1);
+            next_frame++;
+        } else {
+            clock.now_ns = vsync;
+            int64_t dropped[4];
+            int dropped_count = 0;
+            const int64_t id = frame_pacer_on_vsync(pacer, clock.now_ns, s->vsync_period_ns, dropped, 4, &dropped_count);
+            if (id >= 0) {
+                r->in_order = r->in_order && id > last_presented;
+                last_presented = id;
+                r->present_vsync[id] = vsync_index;
+                r->presented++;
+            }
+            vsync_index++;
+        }
+    }
+
+    frame_pacer_get_stats(pacer, &r->stats);
+    frame_pacer_destroy(pacer);
+}
+
+static uint64_t histogram_total(const FramePacerStats* stats) {
+    uint64_t total = 0;
+    for (int i = 0; i < FRAME_PACER_HISTOGRAM_BUCKETS; i++) {
+        total += stats->histogram[i];
+    }
+    return total;
+}
+
+/* ============================================================================
+ * Tests
+ * ========================================================================== */
+
+static void test_30fps_on_60hz_shows_every_frame_twice(void) {
+    const Scenario s = { .frames = 300, .rate_n = 30, .rate_d = 1,
+                         .vsync_period_ns = VSYNC_60HZ_NS, .vsync_phase_ns = 1000000 };
+    static Result r;
+    simulate(&s, &r);
+
+    CHECK_EQ_INT(r.presented, 300);
+    CHECK_EQ_INT(r.stats.dropped, 0);
+    CHECK_EQ_INT(r.stats.repeated, 0);
+    CHECK(r.in_order);
+    for (int k = 1; k < 300; k++) {
+        CHECK_EQ_INT(r.present_vsync[k] - r.present_vsync[k - 1], 2);
+    }
+    /* Every present lands at the refresh closest to its due time. */
+    CHECK(r.stats.error_min_ns > -(VSYNC_60HZ_NS / 2));
+    CHECK(r.stats.error_max_ns <= VSYNC_60HZ_NS / 2);
+    CHECK_EQ_INT(histogram_total(&r.stats), r.stats.presented);
+}
+
+static void test_24fps_on_60hz_uses_3_2_cadence(void) {
+    const Scenario s = { .frames = 240, .rate_n = 24, .rate_d = 1,
+                         .vsync_period_ns = VSYNC_60HZ_NS, .vsync_phase_ns = 3000000 };
+    static Result r;
+    simulate(&s, &r);
+
+    CHECK_EQ_INT(r.presented, 240);
+    CHECK_EQ_INT(r.stats.dropped, 0);
+    CHECK_EQ_INT(r.stats.repeated, 0);
+    int threes = 0;
+    int twos = 0;
+    for (int k = 1; k < 240; k++) {
+        const int gap = r.present_vsync[k] - r.present_vsync[k - 1];
+        CHECK(gap == 2 || gap == 3);
+        threes += gap == 3;
+        twos += gap == 2;
+    }
+    CHECK(threes - twos <= 1 && twos - threes <= 1);
+}
+
+static void test_60fps_on_59_94hz_drops_deterministically(void) {
+    /* The display is 0.1% slower, so one frame in a thousand cannot be shown. */
+    const Scenario s = { .frames = 3600, .rate_n = 60, .rate_d = 1,
+                         .vsync_period_ns = VSYNC_59_94HZ_NS, .vsync_phase_ns = 4000000 };
+    static Result a;
+    static Result b;
+    simulate(&s, &a);
+    simulate(&s, &b);
+
+    CHECK(a.in_order);
+    CHECK(a.stats.dropped >= 3 && a.stats.dropped <= 4);
+    CHECK_EQ_INT(a.stats.repeated, 0);
+    CHECK_EQ_INT(a.stats.enqueued, a.stats.presented + a.stats.dropped + (uint64_t)a.stats.queue_depth);
+    CHECK(memcmp(&a.stats, &b.stats, sizeof(a.stats)) == 0);
+    CHECK(memcmp(a.present_vsync, b.present_vsync, sizeof(a.present_vsync)) == 0);
+}
+
+static void test_lost_frames_count_as_repeats(void) {
+    const Scenario s = { .frames = 60, .rate_n = 30, .rate_d = 1,
+                         .vsync_period_ns = VSYNC_60HZ_NS, .vsync_phase_ns = 1000000,
+                         .lost_first = 10, .lost_count = 3 };
+    static Result r;
+    simulate(&s, &r);
+
+    CHECK_EQ_INT(r.presented, 57);
+    CHECK_EQ_INT(r.stats.repeated, 3);
+    CHECK_EQ_INT(r.stats.dropped, 0);
+    /* The frame after the gap still shows on its own refresh. */
+    CHECK_EQ_INT(r.present_vsync[13] - r.present_vsync[9], 8);
+}
+
+static void test_arrival_jitter_is_absorbed(void) {
+    const Scenario s = { .frames = 600, .rate_n = 60000, .rate_d = 1001,
+                         .vsync_period_ns = VSYNC_60HZ_NS, .vsync_phase_ns = 2000000,
+                         .max_jitter_ns = 8000000 };
+    static Result r;
+    simulate(&s, &r);
+
+    CHECK(r.in_order);
+    CHECK_EQ_INT(r.stats.repeated, 0);
+    CHECK(r.stats.dropped <= 1);
+    CHECK_EQ_INT(r.stats.resyncs, 0);
+    CHECK_EQ_INT(histogram_total(&r.stats), r.stats.presented);
+    CHECK(frame_pacer_error_percentile_ns(&r.stats, 99.0) <= VSYNC_60HZ_NS / 2);
+    CHECK(frame_pacer_error_percentile_ns(&r.stats, 1.0) >= -(VSYNC_60HZ_NS / 2));
+}
+
+static void test_timestamp_jump_resyncs(void) {
+    FramePacer* pacer = frame_pacer_create(4);
+    FakeClock clock = { .now_ns = kBase };
+    int64_t dropped[4];
+    int dropped_count = 0;
+
+    CHECK_EQ_INT(frame_pacer_enqueue(pacer, 0, 1000000, 0, clock.now_ns), -1);
+    clock.now_ns += FRAME_PACER_DEFAULT_DELAY_NS;
+    CHECK_EQ_INT(frame_pacer_on_vsync(pacer, clock.now_ns, VSYNC_60HZ_NS, dropped, 4, &dropped_count), 0);
+
+    /* Duplicate timestamp: handed straight back. */
+    CHECK_EQ_INT(frame_pacer_enqueue(pacer, 1, 1000000, 0, clock.now_ns), 1);
+
+    /* Sender timestamps jump ten seconds ahead: re-anchored instead of waiting ten seconds. */
+    CHECK_EQ_INT(frame_pacer_enqueue(pacer, 2, 1000000 + 100000000, 0, clock.now_ns), -1);
+    clock.now_ns += FRAME_PACER_DEFAULT_DELAY_NS;
+    CHECK_EQ_INT(frame_pacer_on_vsync(pacer, clock.now_ns, VSYNC_60HZ_NS, dropped, 4, &dropped_count), 2);
+
+    /* Undefined timestamps fall back to arrival time. */
+    CHECK_EQ_INT(frame_pacer_enqueue(pacer, 3, FRAME_PACER_TIMESTAMP_UNDEFINED, 0, clock.now_ns), -1);
+
+    FramePacerStats stats;
+    frame_pacer_get_stats(pacer, &stats);
+    CHECK_EQ_INT(stats.rejected, 1);
+    CHECK(stats.resyncs >= 1);
+    CHECK_EQ_INT(stats.presented, 2);
+    CHECK_EQ_INT(stats.queue_depth, 1);
+    frame_pacer_destroy(pacer);
+}
+
+static void test_full_queue_evicts_oldest(void) {
+    FramePacer* pacer = frame_pacer_create(2);
+    CHECK_EQ_INT(frame_pacer_enqueue(pacer, 10, 0, 0, kBase), -1);
+    CHECK_EQ_INT(frame_pacer_enqueue(pacer, 11, 166667, 0, kBase + 16666700), -1);
+    CHECK_EQ_INT(frame_pacer_enqueue(pacer, 12, 333334, 0, kBase + 33333400), 10);
+
+    /* Both remaining frames are overdue: the older one comes back as dropped. */
+    int64_t dropped[2];
+    int dropped_count = 0;
+    CHECK_EQ_INT(frame_pacer_on_vsync(pacer, kBase + 100000000, VSYNC_60HZ_NS, dropped, 2, &dropped_count), 12);
+    CHECK_EQ_INT(dropped_count, 1);
+    CHECK_EQ_INT(dropped[0], 11);
+
+    FramePacerStats stats;
+    frame_pacer_get_stats(pacer, &stats);
+    CHECK_EQ_INT(stats.dropped, 2);
+    CHECK_EQ_INT(stats.queue_depth, 0);
+
+    frame_pacer_reset(pacer);
+    CHECK_EQ_INT(frame_pacer_on_vsync(pacer, kBase + 200000000, VSYNC_60HZ_NS, dropped, 2, &dropped_count), -1);
+    frame_pacer_destroy(pacer);
+}
+
+static void test_vsync_period_is_measured(void) {
+    FramePacer* pacer = frame_pacer_create(2);
+    for (int i = 0; i < 50; i++) {
+        /* Skip one callback in the middle; that interval must not skew the estimate. */
+        if (i == 20) {
+            continue;
+        }
+        frame_pacer_on_vsync(pacer, kBase + (i * 8333333LL), 0, NULL, 0, NULL);
+    }
+    FramePacerStats stats;
+    frame_pacer_get_stats(pacer, &stats);
+    CHECK_EQ_INT(stats.vsync_period_ns, 8333333);
+    frame_pacer_destroy(pacer);
+}
+
+static void test_error_percentiles(void) {
+    FramePacerStats stats;
+    memset(&stats, 0, sizeof(stats));
+    CHECK_EQ_INT(frame_pacer_error_percentile_ns(&stats, 50.0), 0);
+
+    /* 90 presents 0.5 ms late, 10 presents 5.5 ms late. */
+    const int on_time = (int)((500000 - FRAME_PACER_HISTOGRAM_ORIGIN_NS) / FRAME_PACER_HISTOGRAM_BUCKET_NS);
+    const int late = (int)((5500000 - FRAME_PACER_HISTOGRAM_ORIGIN_NS) / FRAME_PACER_HISTOGRAM_BUCKET_NS);
+    stats.histogram[on_time] = 90;
+    stats.histogram[late] = 10;
+    stats.presented = 100;
+    stats.error_min_ns = 500000;
+    stats.error_max_ns = 5500000;
+
+    CHECK_EQ_INT(frame_pacer_error_percentile_ns(&stats, 50.0), 1000000);
+    CHECK_EQ_INT(frame_pacer_error_percentile_ns(&stats, 90.0), 1000000);
+    CHECK_EQ_INT(frame_pacer_error_percentile_ns(&stats, 95.0), 5500000);
+    CHECK_EQ_INT(frame_pacer_error_percentile_ns(&stats, 100.0), 5500000);
+}
+
+int main(void) {
+    RUN_TEST(test_30fps_on_60hz_shows_every_frame_twice);
+    RUN_TEST(test_24fps_on_60hz_uses_3_2_cadence);
+    RUN_TEST(test_60fps_on_59_94hz_drops_deterministically);
+    RUN_TEST(test_lost_frames_count_as_repeats);
+    RUN_TEST(test_arrival_jitter_is_absorbed);
+    RUN_TEST(test_timestamp_jump_resyncs);
+    RUN_TEST(test_full_queue_evicts_oldest);
+    RUN_TEST(test_vsync_period_is_measured);
+    RUN_TEST(test_error_percentiles);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,95 @@
+/**
+ * frame_scaler_bench.c - Host throughput benchmark for frame_scaler.c
+ *
+ * Usage: frame_scaler_bench [iterations]
+ *
+ * Times the renderer's and the multiview's cases and prints milliseconds per frame and source
+ * megapixels per second. ctest runs it with a couple of iterations as a smoke test; run it by
+ * hand (or on a device through adb) with more for numbers. On an x86 host this measures the
+ * scalar code.
+ */
+
+#include "frame_scaler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct BenchCase {
+    const char* name;
+    ScalerFormat format;
+    int src_width;
+    int src_height;
+    int dst_width;
+    int dst_height;
+    ScalerFilter filter;
+} BenchCase;
+
+static const BenchCase kCases[] = {
+    { "UYVY 3840x2160 -> 1920x1080 area", SCALER_UYVY, 3840, 2160, 1920, 1080, SCALER_FILTER_AREA },
+    { "UYVY 3840x2160 -> 1920x1080 bilinear", SCALER_UYVY, 3840, 2160, 1920, 1080, SCALER_FILTER_BILINEAR },
+    { "BGRA 3840x2160 -> 1920x1080 area", SCALER_BGRA, 3840, 2160, 1920, 1080, SCALER_FILTER_AREA },
+    { "UYVY 3840x2160 -> 2560x1600 area", SCALER_UYVY, 3840, 2160, 2560, 1600, SCALER_FILTER_AREA },
+    { "UYVY 1920x1080 -> 1920x1080 convert", SCALER_UYVY, 1920, 1080, 1920, 1080, SCALER_FILTER_AUTO },
+    { "UYVY 1920x1080 -> 640x360 area (3x3 tile)", SCALER_UYVY, 1920, 1080, 640, 360, SCALER_FILTER_AREA },
+    { "BGRA 1280x720 -> 1920x1080 bilinear", SCALER_BGRA, 1280, 720, 1920, 1080, SCALER_FILTER_BILINEAR },
+};
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+}
+
+static bool run_case(const BenchCase* c, int iterations) {
+    const int bytes_per_pixel = (c->format == SCALER_UYVY) ? 2 : 4;
+    const int src_stride = c->src_width * bytes_per_pixel;
+    const int dst_stride = c->dst_width * 4;
+    uint8_t* src = (uint8_t*)malloc((size_t)src_stride * (size_t)c->src_height);
+    uint8_t* dst = (uint8_t*)malloc((size_t)dst_stride * (size_t)c->dst_height);
+    FrameScaler* fs = frame_scaler_create();
+    if (src == NULL || dst == NULL || fs == NULL) {
+        fprintf(stderr, "%s: out of memory\n", c->name);
+        free(src);
+        free(dst);
+        frame_scaler_destroy(fs);
+        return false;
+    }
+    for (size_t i = 0; i < (size_t)src_stride * (size_t)c->src_height; i++) {
+        src[i] = (uint8_t)(i * 131 + (i >> 12));
+    }
+
+    /* The first call builds the filter tables; it is not timed. */
+    bool ok = frame_scaler_scale(fs, src, src_stride, c->src_width, c->src_height, c->format,
+                                 dst, dst_stride, c->dst_width, c->dst_height, c->filter);
+    const int64_t start_ns = monotonic_ns();
+    for (int i = 0; ok && i < iterations; i++) {
+        ok = frame_scaler_scale(fs, src, src_stride, c->src_width, c->src_height, c->format,
+                                dst, dst_stride, c->dst_width, c->dst_height, c->filter);
+    }
+    const int64_t elapsed_ns = monotonic_ns() - start_ns;
+
+    if (ok) {
+        const double ms = (double)elapsed_ns / 1e6 / iterations;
+        const double mpix = (double)c->src_width * c->src_height / 1e6;
+        printf("%-44s %8.2f ms/frame %9.1f Mpix/s\n", c->name, ms, mpix / (ms / 1000.0));
+    } else {
+        fprintf(stderr, "%s: scale failed\n", c->name);
+    }
+    free(src);
+    free(dst);
+    frame_scaler_destroy(fs);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 20;
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); i++) {
+        ok = run_case(&kCases[i], iterations) && ok;
+    }
+    return ok ? 0 : 1;
+}
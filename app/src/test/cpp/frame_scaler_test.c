@@ -0,0 +1,306 @@
+/**
+ * frame_scaler_test.c - Host tests for frame_scaler.c
+ *
+ * On an x86 host this runs the scalar code, which the NEON paths match bit for bit.
+ */
+
+#include "frame_scaler.h"
+#include "test_util.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void fill_pixels(uint8_t* p, int width, int height, int stride, uint8_t c0, uint8_t c1, uint8_t c2,
+                        uint8_t c3) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* px = p + (size_t)y * (size_t)stride + (size_t)x * 4;
+            px[0] = c0;
+            px[1] = c1;
+            px[2] = c2;
+            px[3] = c3;
+        }
+    }
+}
+
+static void fill_uyvy(uint8_t* p, int width, int height, uint8_t y, uint8_t u, uint8_t v) {
+    for (int i = 0; i < width * height / 2; i++) {
+        p[i * 4 + 0] = u;
+        p[i * 4 + 1] = y;
+        p[i * 4 + 2] = v;
+        p[i * 4 + 3] = y;
+    }
+}
+
+static bool all_pixels_are(const uint8_t* p, int width, int height, int stride, uint8_t r, uint8_t g, uint8_t b,
+                           uint8_t a) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t* px = p + (size_t)y * (size_t)stride + (size_t)x * 4;
+            if (px[0] != r || px[1] != g || px[2] != b || px[3] != a) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Filters
+ * ========================================================================== */
+
+static void test_flat_color_stays_flat(void) {
+    static const int sizes[][4] = {
+        { 1920, 1080, 640, 360 },   /* Whole-ratio area */
+        { 1920, 1080, 701, 333 },   /* Fractional area */
+        { 37, 21, 101, 64 },        /* Bilinear up */
+        { 64, 48, 64, 48 }          /* Same size */
+    };
+    FrameScaler* fs = frame_scaler_create();
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        const int sw = sizes[i][0];
+        const int sh = sizes[i][1];
+        const int dw = sizes[i][2];
+        const int dh = sizes[i][3];
+        uint8_t* src = (uint8_t*)malloc((size_t)sw * (size_t)sh * 4);
+        uint8_t* dst = (uint8_t*)malloc((size_t)dw * (size_t)dh * 4);
+        fill_pixels(src, sw, sh, sw * 4, 10, 200, 77, 255);
+        CHECK(frame_scaler_scale(fs, src, sw * 4, sw, sh, SCALER_RGBA, dst, dw * 4, dw, dh, SCALER_FILTER_AUTO));
+        CHECK(all_pixels_are(dst, dw, dh, dw * 4, 10, 200, 77, 255));
+        free(src);
+        free(dst);
+    }
+    frame_scaler_destroy(fs);
+}
+
+static void test_area_halving_averages(void) {
+    /* 4x2 BGRA -> 2x1: each output pixel is the mean of a 2x2 block. */
+    uint8_t src[2 * 4 * 4];
+    for (int i = 0; i < 8; i++) {
+        src[i * 4 + 0] = (uint8_t)(i * 10);        /* B */
+        src[i * 4 + 1] = (uint8_t)(100 + i);       /* G */
+        src[i * 4 + 2] = (uint8_t)(255 - i * 20);  /* R */
+        src[i * 4 + 3] = 255;
+    }
+    uint8_t dst[2 * 4];
+    FrameScaler* fs = frame_scaler_create();
+    CHECK(frame_scaler_scale(fs, src, 16, 4, 2, SCALER_BGRA, dst, 8, 2, 1, SCALER_FILTER_AREA));
+    /* Left block is pixels 0, 1, 4, 5; right block 2, 3, 6, 7 (rounded half up). */
+    CHECK_EQ_INT(dst[0], 255 - 50);
+    CHECK_EQ_INT(dst[1], 103);
+    CHECK_EQ_INT(dst[2], 25);
+    CHECK_EQ_INT(dst[3], 255);
+    CHECK_EQ_INT(dst[4], 255 - 90);
+    CHECK_EQ_INT(dst[5], 105);
+    CHECK_EQ_INT(dst[6], 45);
+    frame_scaler_destroy(fs);
+}
+
+static void test_same_size_is_exact(void) {
+    enum { W = 19, H = 7 };
+    uint8_t src[W * H * 4];
+    uint8_t dst[W * H * 4];
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 37 + 11);
+    }
+    FrameScaler* fs = frame_scaler_create();
+    CHECK(frame_scaler_scale(fs, src, W * 4, W, H, SCALER_RGBA, dst, W * 4, W, H, SCALER_FILTER_BILINEAR));
+    CHECK(memcmp(src, dst, sizeof(src)) == 0);
+    CHECK(frame_scaler_scale(fs, src, W * 4, W, H, SCALER_RGBA, dst, W * 4, W, H, SCALER_FILTER_AREA));
+    CHECK(memcmp(src, dst, sizeof(src)) == 0);
+    frame_scaler_destroy(fs);
+}
+
+/* Box-filter reference in doubles: fixed point must stay within one step of it. */
+static void test_area_matches_reference(void) {
+    enum { SW = 53, SH = 29, DW = 17, DH = 11 };
+    static uint8_t src[SW * SH * 4];
+    uint8_t dst[DW * DH * 4];
+    unsigned seed = 12345;
+    for (size_t i = 0; i < sizeof(src); i++) {
+        seed = seed * 1103515245u + 12345u;
+        src[i] = (uint8_t)(seed >> 16);
+    }
+    FrameScaler* fs = frame_scaler_create();
+    CHECK(frame_scaler_scale(fs, src, SW * 4, SW, SH, SCALER_RGBA, dst, DW * 4, DW, DH, SCALER_FILTER_AREA));
+
+    int worst = 0;
+    for (int dy = 0; dy < DH; dy++) {
+        for (int dx = 0; dx < DW; dx++) {
+            const double x0 = (double)dx * SW / DW;
+            const double x1 = (double)(dx + 1) * SW / DW;
+            const double y0 = (double)dy * SH / DH;
+            const double y1 = (double)(dy + 1) * SH / DH;
+            for (int c = 0; c < 4; c++) {
+                double sum = 0.0;
+                for (int sy = (int)y0; sy < SH && sy < y1; sy++) {
+                    const double wy = fmin(y1, sy + 1) - fmax(y0, sy);
+                    for (int sx = (int)x0; sx < SW && sx < x1; sx++) {
+                        const double wx = fmin(x1, sx + 1) - fmax(x0, sx);
+                        sum += wx * wy * src[(sy * SW + sx) * 4 + c];
+                    }
+                }
+                const double expected = sum / ((x1 - x0) * (y1 - y0));
+                const int diff = abs(dst[(dy * DW + dx) * 4 + c] - (int)lround(expected));
+                worst = (diff > worst) ? diff : worst;
+            }
+        }
+    }
+    CHECK(worst <= 1);
+    frame_scaler_destroy(fs);
+}
+
+/* The renderer's main case: a 4K frame shown on a 1080p surface, exactly 2:1. */
+static void test_uhd_to_hd_is_block_average(void) {
+    enum { SW = 3840, SH = 2160, DW = 1920, DH = 1080 };
+    uint8_t* src = (uint8_t*)malloc((size_t)SW * SH * 4);
+    uint8_t* dst = (uint8_t*)malloc((size_t)DW * DH * 4);
+    for (int y = 0; y < SH; y++) {
+        for (int x = 0; x < SW; x++) {
+            uint8_t* p = src + ((size_t)y * SW + (size_t)x) * 4;
+            p[0] = (uint8_t)(x * 7 + y);
+            p[1] = (uint8_t)(x ^ y);
+            p[2] = (uint8_t)(y * 3);
+            p[3] = 255;
+        }
+    }
+    FrameScaler* fs = frame_scaler_create();
+    CHECK(frame_scaler_scale(fs, src, SW * 4, SW, SH, SCALER_BGRA, dst, DW * 4, DW, DH, SCALER_FILTER_AUTO));
+
+    int mismatches = 0;
+    for (int y = 0; y < DH; y++) {
+        for (int x = 0; x < DW; x++) {
+            for (int c = 0; c < 3; c++) {
+                int sum = 0;
+                for (int k = 0; k < 4; k++) {
+                    sum += src[((size_t)(2 * y + k / 2) * SW + (size_t)(2 * x + k % 2)) * 4 + (size_t)(2 - c)];
+                }
+                /* Halves are exact in the Q8 intermediates: only the final rounding is left. */
+                mismatches += (dst[((size_t)y * DW + (size_t)x) * 4 + (size_t)c] != (sum + 2) / 4);
+            }
+        }
+    }
+    CHECK_EQ_INT(mismatches, 0);
+    free(src);
+    free(dst);
+    frame_scaler_destroy(fs);
+}
+
+static void test_bilinear_midpoint(void) {
+    /* Two pixels stretched to four: the inner two blend 3:1 and 1:3. */
+    const uint8_t src[8] = { 0, 0, 0, 255, 200, 100, 40, 255 };
+    uint8_t dst[16];
+    FrameScaler* fs = frame_scaler_create();
+    CHECK(frame_scaler_scale(fs, src, 8, 2, 1, SCALER_RGBX, dst, 16, 4, 1, SCALER_FILTER_BILINEAR));
+    CHECK_EQ_INT(dst[0], 0);
+    CHECK_EQ_INT(dst[4], 50);
+    CHECK_EQ_INT(dst[5], 25);
+    CHECK_EQ_INT(dst[8], 150);
+    CHECK_EQ_INT(dst[9], 75);
+    CHECK_EQ_INT(dst[10], 30);
+    CHECK_EQ_INT(dst[12], 200);
+    CHECK_EQ_INT(dst[15], 255);
+    frame_scaler_destroy(fs);
+}
+
+/* ============================================================================
+ * Formats and Layout
+ * ========================================================================== */
+
+static void test_formats(void) {
+    uint8_t src[64 * 4 * 4];
+    uint8_t dst[32 * 2 * 4];
+    FrameScaler* fs = frame_scaler_create();
+
+    /* BGRX: channels swapped, padding byte ignored. */
+    fill_pixels(src, 64, 4, 256, 30, 60, 90, 7);
+    CHECK(frame_scaler_scale(fs, src, 256, 64, 4, SCALER_BGRX, dst, 128, 32, 2, SCALER_FILTER_AUTO));
+    CHECK(all_pixels_are(dst, 32, 2, 128, 90, 60, 30, 255));
+
+    /* BGRA keeps its alpha. */
+    CHECK(frame_scaler_scale(fs, src, 256, 64, 4, SCALER_BGRA, dst, 128, 32, 2, SCALER_FILTER_AUTO));
+    CHECK(all_pixels_are(dst, 32, 2, 128, 90, 60, 30, 7));
+
+    /* UYVY: BT.709 limited range white, black and red. */
+    fill_uyvy(src, 64, 4, 235, 128, 128);
+    CHECK(frame_scaler_scale(fs, src, 128, 64, 4, SCALER_UYVY, dst, 128, 32, 2, SCALER_FILTER_AUTO));
+    CHECK(all_pixels_are(dst, 32, 2, 128, 255, 255, 255, 255));
+    fill_uyvy(src, 64, 4, 16, 128, 128);
+    CHECK(frame_scaler_scale(fs, src, 128, 64, 4, SCALER_UYVY, dst, 128, 32, 2, SCALER_FILTER_AUTO));
+    CHECK(all_pixels_are(dst, 32, 2, 128, 0, 0, 0, 255));
+    fill_uyvy(src, 64, 4, 63, 102, 240);
+    CHECK(frame_scaler_scale(fs, src, 128, 64, 4, SCALER_UYVY, dst, 128, 32, 2, SCALER_FILTER_AUTO));
+    CHECK(dst[0] >= 253 && dst[1] <= 2 && dst[2] <= 2);
+    frame_scaler_destroy(fs);
+}
+
+static void test_uyvy_pairs_keep_their_luma(void) {
+    /* Alternating luma within each pair survives a same-size scale. */
+    uint8_t src[8 * 2];
+    for (int i = 0; i < 4; i++) {
+        src[i * 4 + 0] = 128;
+        src[i * 4 + 1] = 16;
+        src[i * 4 + 2] = 128;
+        src[i * 4 + 3] = 235;
+    }
+    uint8_t dst[8 * 4];
+    FrameScaler* fs = frame_scaler_create();
+    CHECK(frame_scaler_scale(fs, src, 16, 8, 1, SCALER_UYVY, dst, 32, 8, 1, SCALER_FILTER_AUTO));
+    for (int x = 0; x < 8; x++) {
+        CHECK_EQ_INT(dst[x * 4], (x & 1) ? 255 : 0);
+    }
+    frame_scaler_destroy(fs);
+}
+
+static void test_writes_only_its_region(void) {
+    enum { CW = 40, CH = 20 };
+    uint8_t canvas[CW * CH * 4];
+    uint8_t src[16 * 16 * 4];
+    memset(canvas, 0xAB, sizeof(canvas));
+    fill_pixels(src, 16, 16, 64, 1, 2, 3, 4);
+
+    FrameScaler* fs = frame_scaler_create();
+    uint8_t* region = canvas + (5 * CW + 7) * 4;
+    CHECK(frame_scaler_scale(fs, src, 64, 16, 16, SCALER_RGBA, region, CW * 4, 10, 8, SCALER_FILTER_AUTO));
+    CHECK(all_pixels_are(region, 10, 8, CW * 4, 1, 2, 3, 4));
+
+    int touched = 0;
+    for (int i = 0; i < CW * CH * 4; i++) {
+        touched += (canvas[i] != 0xAB);
+    }
+    CHECK_EQ_INT(touched, 10 * 8 * 4);
+    frame_scaler_destroy(fs);
+}
+
+static void test_rejects_bad_input(void) {
+    uint8_t src[8 * 8 * 4];
+    uint8_t dst[8 * 8 * 4];
+    memset(dst, 0x5A, sizeof(dst));
+    FrameScaler* fs = frame_scaler_create();
+    CHECK(!frame_scaler_scale(fs, src, 14, 7, 2, SCALER_UYVY, dst, 32, 8, 8, SCALER_FILTER_AUTO));
+    CHECK(!frame_scaler_scale(fs, src, 28, 8, 8, SCALER_RGBA, dst, 32, 8, 8, SCALER_FILTER_AUTO));
+    CHECK(!frame_scaler_scale(fs, src, 32, 8, 8, SCALER_RGBA, dst, 28, 8, 8, SCALER_FILTER_AUTO));
+    CHECK(!frame_scaler_scale(fs, src, 32, 8, 0, SCALER_RGBA, dst, 32, 8, 8, SCALER_FILTER_AUTO));
+    CHECK(!frame_scaler_scale(fs, src, 32, 8, 8, (ScalerFormat)9, dst, 32, 8, 8, SCALER_FILTER_AUTO));
+    CHECK(!frame_scaler_scale(fs, src, 32, 8, 8, SCALER_RGBA, dst, 32, 8, 8, (ScalerFilter)9));
+    CHECK(!frame_scaler_scale(NULL, src, 32, 8, 8, SCALER_RGBA, dst, 32, 8, 8, SCALER_FILTER_AUTO));
+    for (size_t i = 0; i < sizeof(dst); i++) {
+        CHECK(dst[i] == 0x5A);
+    }
+    frame_scaler_destroy(fs);
+}
+
+int main(void) {
+    RUN_TEST(test_flat_color_stays_flat);
+    RUN_TEST(test_area_halving_averages);
+    RUN_TEST(test_same_size_is_exact);
+    RUN_TEST(test_area_matches_reference);
+    RUN_TEST(test_uhd_to_hd_is_block_average);
+    RUN_TEST(test_bilinear_midpoint);
+    RUN_TEST(test_formats);
+    RUN_TEST(test_uyvy_pairs_keep_their_luma);
+    RUN_TEST(test_writes_only_its_region);
+    RUN_TEST(test_rejects_bad_input);
+    return TEST_EXIT_CODE();
+}
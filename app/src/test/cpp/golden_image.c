@@ -0,0 +1,97 @@
+/**
+ * golden_image.c - Golden image comparison for the host unit tests
+ */
+
+#include "golden_image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool write_pgm(const char* path, const uint8_t* pixels, int width, int height, int stride) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        fprintf(stderr, "golden: cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "P2\n%d %d\n255\n", width, height);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = pixels + ((size_t)y * (size_t)stride);
+        for (int x = 0; x < width; x++) {
+            fprintf(f, (x + 1 < width) ? "%3u " : "%3u\n", row[x]);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static uint8_t* read_pgm(const char* path, int* width, int* height) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        return NULL;
+    }
+    int maxval = 0;
+    if (fscanf(f, "P2 %d %d %d", width, height, &maxval) != 3 || *width <= 0 || *height <= 0 || maxval != 255) {
+        fclose(f);
+        return NULL;
+    }
+    uint8_t* pixels = (uint8_t*)malloc((size_t)(*width) * (size_t)(*height));
+    if (pixels == NULL) {
+        fclose(f);
+        return NULL;
+    }
+    for (int i = 0; i < (*width) * (*height); i++) {
+        unsigned v = 0;
+        if (fscanf(f, "%u", &v) != 1 || v > 255) {
+            free(pixels);
+            fclose(f);
+            return NULL;
+        }
+        pixels[i] = (uint8_t)v;
+    }
+    fclose(f);
+    return pixels;
+}
+
+bool golden_image_matches(const char* dir, const char* name, const uint8_t* pixels, int width, int height, int stride) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s.pgm", dir, name);
+
+    const char* update = getenv("NDI_UPDATE_GOLDEN");
+    if (update != NULL && strcmp(update, "1") == 0) {
+        printf("golden: updating %s\n", path);
+        return write_pgm(path, pixels, width, height, stride);
+    }
+
+    int golden_width = 0;
+    int golden_height = 0;
+    uint8_t* golden = read_pgm(path, &golden_width, &golden_height);
+    if (golden == NULL) {
+        fprintf(stderr, "golden: cannot read %s\n", path);
+        return false;
+    }
+
+    bool match = (golden_width == width && golden_height == height);
+    if (!match) {
+        fprintf(stderr, "golden: %s is %dx%d, output is %dx%d\n", name, golden_width, golden_height, width, height);
+    }
+    for (int y = 0; match && y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t expected = golden[(size_t)y * (size_t)width + (size_t)x];
+            const uint8_t actual = pixels[(size_t)y * (size_t)stride + (size_t)x];
+            if (expected != actual) {
+                fprintf(stderr, "golden: %s differs at (%d,%d): expected %u, got %u\n", name, x, y, expected, actual);
+                match = false;
+                break;
+            }
+        }
+    }
+    free(golden);
+
+    if (!match) {
+        char actual_path[1024];
+        snprintf(actual_path, sizeof(actual_path), "%s.actual.pgm", name);
+        write_pgm(actual_path, pixels, width, height, stride);
+    }
+    return match;
+}
@@ -0,0 +1,20 @@
+/**
+ * golden_image.h - Golden image comparison for the host unit tests
+ *
+ * Goldens are 8-bit ASCII PGM (P2) files so that changes show up readably in diffs.
+ * Set NDI_UPDATE_GOLDEN=1 to rewrite them from the current output instead of comparing.
+ */
+
+#ifndef NDI_GOLDEN_IMAGE_H
+#define NDI_GOLDEN_IMAGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Compare width x height bytes (stride bytes per line) against <dir>/<name>.pgm.
+ * On mismatch the actual image is written to <name>.actual.pgm in the working directory.
+ */
+bool golden_image_matches(const char* dir, const char* name, const uint8_t* pixels, int width, int height, int stride);
+
+#endif /* NDI_GOLDEN_IMAGE_H */
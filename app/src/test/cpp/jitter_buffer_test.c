@@ -0,0 +1,345 @@
+/**
+ * jitter_buffer_test.c - Host tests for jitter_buffer.c
+ *
+ * Frames are pushed at simulated arrival times (sender timestamp plus a deterministic network
+ * delay) and popped on a 0.5 ms fake-clock tick, which is how the capture loop polls it.
+ */
+
+#include "jitter_buffer.h"
+#include "test_util.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define MAX_FRAMES 1024
+#define FRAME_100NS 166833LL          /* 59.94 fps */
+#define TICK_NS 500000LL
+#define MS(x) ((int64_t)(x) * 1000000LL)
+
+typedef struct FakeClock {
+    int64_t now_ns;
+} FakeClock;
+
+typedef struct Run {
+    int frames;
+    int64_t target_ns;
+    int64_t base_delay_ns;       /* Network floor. */
+    int64_t max_jitter_ns;       /* Extra per-frame delay, 0..max. */
+} Run;
+
+typedef struct RunResult {
+    JitterBufferStats stats;
+    int released;
+    int64_t release_ns[MAX_FRAMES];
+    int order[MAX_FRAMES];
+    int64_t max_hold_ns;         /* Longest time any frame spent in the buffer. */
+    int returned;                /* Pushes handed straight back. */
+} RunResult;
+
+static int g_ids[MAX_FRAMES];
+static const int64_t kBase = 1000000000LL;
+
+static int64_t jitter_ns(const Run* r, int k) {
+    if (r->max_jitter_ns <= 0) {
+        return 0;
+    }
+    const uint32_t x = ((uint32_t)k * 2654435761u) ^ 0x5bd1e995u;
+    return (int64_t)((x >> 4) % (uint32_t)(r->max_jitter_ns + 1));
+}
+
+static int64_t arrival_ns(const Run* r, int k) {
+    return kBase + (k * FRAME_100NS * 100) + r->base_delay_ns + jitter_ns(r, k);
+}
+
+/* Push an uncompressed frame, which costs at most one discard. */
+static void* push(JitterBuffer* jb, void* item, int64_t timestamp_100ns, int64_t now_ns) {
+    void* discarded[JITTER_BUFFER_MAX_DISCARDS];
+    const int count = jitter_buffer_push(jb, item, JITTER_FRAME_INDEPENDENT, timestamp_100ns, now_ns, discarded);
+    CHECK(count <= 1);
+    return count > 0 ? discarded[0] : NULL;
+}
+
+static void run(const Run* r, RunResult* out) {
+    JitterBuffer* jb = jitter_buffer_create(JITTER_BUFFER_MAX_CAPACITY);
+    jitter_buffer_set_target(jb, r->target_ns);
+    FakeClock clock = { .now_ns = kBase };
+    memset(out, 0, sizeof(*out));
+
+    /* Arrival order follows arrival time, so jittered frames can overtake each other. */
+    int order[MAX_FRAMES];
+    for (int k = 0; k < r->frames; k++) {
+        order[k] = k;
+    }
+    for (int i = 1; i < r->frames; i++) {
+        for (int j = i; j > 0 && arrival_ns(r, order[j]) < arrival_ns(r, order[j - 1]); j--) {
+            const int t = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = t;
+        }
+    }
+
+    int64_t pushed_at[MAX_FRAMES];
+    int next = 0;
+    while (out->released + out->returned < r->frames && clock.now_ns < kBase + MS(30000)) {
+        while (next < r->frames && arrival_ns(r, order[next]) <= clock.now_ns) {
+            const int k = order[next++];
+            g_ids[k] = k;
+            pushed_at[k] = clock.now_ns;
+            if (push(jb, &g_ids[k], k * FRAME_100NS, clock.now_ns) != NULL) {
+                out->returned++;
+            }
+        }
+        int* item;
+        while ((item = (int*)jitter_buffer_pop(jb, clock.now_ns)) != NULL) {
+            const int64_t hold = clock.now_ns - pushed_at[*item];
+            if (hold > out->max_hold_ns) {
+                out->max_hold_ns = hold;
+            }
+            out->order[out->released] = *item;
+            out->release_ns[out->released] = clock.now_ns;
+            out->released++;
+        }
+        clock.now_ns += TICK_NS;
+    }
+
+    jitter_buffer_get_stats(jb, &out->stats);
+    jitter_buffer_destroy(jb);
+}
+
+static bool in_order(const RunResult* res) {
+    for (int i = 1; i < res->released; i++) {
+        if (res->order[i] <= res->order[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Tests
+ * ========================================================================== */
+
+static void test_zero_target_passes_through(void) {
+    const Run r = { .frames = 120, .target_ns = 0, .base_delay_ns = MS(3) };
+    static RunResult res;
+    run(&r, &res);
+
+    CHECK_EQ_INT(res.released, 120);
+    CHECK_EQ_INT(res.returned, 0);
+    CHECK_EQ_INT(res.max_hold_ns, 0);
+    CHECK_EQ_INT(res.stats.delay_ns, 0);
+    CHECK_EQ_INT(res.stats.late, 0);
+    CHECK_EQ_INT(res.stats.dropped, 0);
+    CHECK(in_order(&res));
+}
+
+static void test_adapts_depth_to_jitter(void) {
+    /* 12 ms of jitter with a 100 ms budget: the buffer should use ~14 ms, not 100. */
+    const Run r = { .frames = 600, .target_ns = MS(100), .base_delay_ns = MS(2), .max_jitter_ns = MS(12) };
+    static RunResult res;
+    run(&r, &res);
+
+    CHECK_EQ_INT(res.released, 600);
+    CHECK(in_order(&res));
+    CHECK_EQ_INT(res.stats.dropped, 0);
+    CHECK(res.stats.jitter_ns <= MS(12) + TICK_NS && res.stats.jitter_ns >= MS(10));  /* plus tick rounding */
+    CHECK_EQ_INT(res.stats.delay_ns, res.stats.jitter_ns + JITTER_BUFFER_MARGIN_NS);
+    CHECK(res.max_hold_ns <= MS(100));
+    /* Only the warm-up, before the window has seen the spread, can be late. */
+    CHECK(res.stats.late <= 10);
+
+    /* Once settled, playout is smooth: release intervals stay within a tick of the frame period. */
+    for (int i = 300; i < 600; i++) {
+        const int64_t interval = res.release_ns[i] - res.release_ns[i - 1];
+        CHECK(interval >= (FRAME_100NS * 100) - TICK_NS - MS(1) && interval <= (FRAME_100NS * 100) + TICK_NS + MS(1));
+    }
+}
+
+static void test_target_caps_delay(void) {
+    /* 40 ms of jitter with a 20 ms budget: latency wins, frames beyond it are late. */
+    const Run r = { .frames = 300, .target_ns = MS(20), .base_delay_ns = MS(2), .max_jitter_ns = MS(40) };
+    static RunResult res;
+    run(&r, &res);
+
+    CHECK_EQ_INT(res.stats.delay_ns, MS(20));
+    CHECK(res.stats.late > 50);
+    CHECK(res.max_hold_ns <= MS(20));
+    CHECK(in_order(&res));
+    /* Late frames that lost their slot to a newer one are dropped, never released out of order. */
+    CHECK_EQ_INT(res.returned, res.stats.dropped);
+    CHECK_EQ_INT(res.released + res.returned, 300);
+}
+
+static void test_reorders_by_timestamp(void) {
+    JitterBuffer* jb = jitter_buffer_create(8);
+    jitter_buffer_set_target(jb, MS(50));
+    int ids[4] = { 0, 1, 2, 3 };
+
+    /* Frames 0..3 are sent 10 ms apart; 2 arrives before 1. */
+    CHECK(push(jb, &ids[0], 0, kBase + MS(5)) == NULL);
+    CHECK(push(jb, &ids[2], 200000, kBase + MS(25)) == NULL);
+    CHECK(push(jb, &ids[1], 100000, kBase + MS(27)) == NULL);
+    CHECK(push(jb, &ids[3], 300000, kBase + MS(35)) == NULL);
+
+    int released = 0;
+    for (int64_t t = kBase; t < kBase + MS(200); t += TICK_NS) {
+        int* item;
+        while ((item = (int*)jitter_buffer_pop(jb, t)) != NULL) {
+            CHECK_EQ_INT(*item, released);
+            released++;
+        }
+    }
+    CHECK_EQ_INT(released, 4);
+
+    /* A straggler older than what was already released is handed back. */
+    int straggler = 9;
+    CHECK(push(jb, &straggler, 250000, kBase + MS(210)) == &straggler);
+    /* So is a duplicate of a frame still held. */
+    CHECK(push(jb, &ids[0], 400000, kBase + MS(211)) == NULL);
+    CHECK(push(jb, &ids[1], 400000, kBase + MS(212)) == &ids[1]);
+
+    JitterBufferStats stats;
+    jitter_buffer_get_stats(jb, &stats);
+    CHECK_EQ_INT(stats.dropped, 2);
+    CHECK_EQ_INT(stats.depth, 1);
+    CHECK(jitter_buffer_drain(jb) == &ids[0]);
+    CHECK(jitter_buffer_drain(jb) == NULL);
+    CHECK(jitter_buffer_next_due_ns(jb) == INT64_MAX);
+    jitter_buffer_destroy(jb);
+}
+
+static void test_full_buffer_evicts_oldest(void) {
+    JitterBuffer* jb = jitter_buffer_create(2);
+    jitter_buffer_set_target(jb, MS(500));
+    int ids[3] = { 0, 1, 2 };
+
+    /* Wide jitter keeps everything held. */
+    CHECK(push(jb, &ids[0], 0, kBase) == NULL);
+    CHECK(push(jb, &ids[1], 100000, kBase + MS(200)) == NULL);
+    CHECK(push(jb, &ids[2], 200000, kBase + MS(201)) == &ids[0]);
+
+    JitterBufferStats stats;
+    jitter_buffer_get_stats(jb, &stats);
+    CHECK_EQ_INT(stats.dropped, 1);
+    CHECK_EQ_INT(stats.depth, 2);
+    jitter_buffer_destroy(jb);
+}
+
+/* Push compressed frame ids[k] (a key if is_key) at timestamp k; returns the number discarded. */
+static int push_coded(JitterBuffer* jb, int* ids, int k, bool is_key, void** discarded) {
+    return jitter_buffer_push(jb, &ids[k], is_key ? JITTER_FRAME_KEY : JITTER_FRAME_DELTA,
+                              k * 100000LL, kBase + MS(k), discarded);
+}
+
+static void test_full_buffer_evicts_compressed_frame(void) {
+    JitterBuffer* jb = jitter_buffer_create(3);
+    jitter_buffer_set_target(jb, MS(500));
+    int ids[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    void* discarded[JITTER_BUFFER_MAX_DISCARDS];
+
+    CHECK_EQ_INT(push_coded(jb, ids, 0, true, discarded), 0);
+    CHECK_EQ_INT(push_coded(jb, ids, 1, false, discarded), 0);
+    CHECK_EQ_INT(push_coded(jb, ids, 2, false, discarded), 0);
+
+    /* Evicting the key orphans the held deltas and the new one. */
+    CHECK_EQ_INT(push_coded(jb, ids, 3, false, discarded), 4);
+    CHECK(discarded[0] == &ids[0]);
+    CHECK(discarded[1] == &ids[1]);
+    CHECK(discarded[2] == &ids[2]);
+    CHECK(discarded[3] == &ids[3]);
+
+    /* Later deltas are dropped until the next key. */
+    CHECK_EQ_INT(push_coded(jb, ids, 4, false, discarded), 1);
+    CHECK(discarded[0] == &ids[4]);
+    CHECK_EQ_INT(push_coded(jb, ids, 5, true, discarded), 0);
+    CHECK_EQ_INT(push_coded(jb, ids, 6, false, discarded), 0);
+
+    JitterBufferStats stats;
+    jitter_buffer_get_stats(jb, &stats);
+    CHECK_EQ_INT(stats.dropped, 5);
+    CHECK_EQ_INT(stats.depth, 2);
+    CHECK(jitter_buffer_drain(jb) == &ids[5]);
+    CHECK(jitter_buffer_drain(jb) == &ids[6]);
+    jitter_buffer_destroy(jb);
+
+    /* A held key stops the loss there: only the deltas before it go. */
+    jb = jitter_buffer_create(3);
+    jitter_buffer_set_target(jb, MS(500));
+    push_coded(jb, ids, 0, true, discarded);
+    push_coded(jb, ids, 1, false, discarded);
+    push_coded(jb, ids, 2, true, discarded);
+    CHECK_EQ_INT(push_coded(jb, ids, 3, false, discarded), 2);
+    CHECK(discarded[0] == &ids[0]);
+    CHECK(discarded[1] == &ids[1]);
+    CHECK(jitter_buffer_drain(jb) == &ids[2]);
+    CHECK(jitter_buffer_drain(jb) == &ids[3]);
+    jitter_buffer_destroy(jb);
+}
+
+static void test_stale_compressed_frame_waits_for_key(void) {
+    JitterBuffer* jb = jitter_buffer_create(8);
+    int ids[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    void* discarded[JITTER_BUFFER_MAX_DISCARDS];
+
+    push_coded(jb, ids, 0, true, discarded);
+    push_coded(jb, ids, 2, false, discarded);
+    CHECK(jitter_buffer_pop(jb, kBase + MS(2)) == &ids[0]);
+    CHECK(jitter_buffer_pop(jb, kBase + MS(2)) == &ids[2]);
+    push_coded(jb, ids, 3, false, discarded);
+
+    /* Frame 1 arrives after frame 2 went out: 3 referenced it, and so do 4 until key 5. */
+    CHECK_EQ_INT(push_coded(jb, ids, 1, false, discarded), 2);
+    CHECK(discarded[0] == &ids[1]);
+    CHECK(discarded[1] == &ids[3]);
+    CHECK_EQ_INT(push_coded(jb, ids, 4, false, discarded), 1);
+
+    /* A switch to uncompressed video needs no key. */
+    CHECK_EQ_INT(jitter_buffer_push(jb, &ids[5], JITTER_FRAME_INDEPENDENT, 500000, kBase + MS(5), discarded), 0);
+    CHECK(jitter_buffer_drain(jb) == &ids[5]);
+    jitter_buffer_destroy(jb);
+}
+
+static void test_early_and_resync(void) {
+    JitterBuffer* jb = jitter_buffer_create(8);
+    jitter_buffer_set_target(jb, MS(100));
+    int ids[4] = { 0, 1, 2, 3 };
+
+    CHECK(push(jb, &ids[0], 0, kBase + MS(20)) == NULL);
+    /* The network floor drops by 15 ms: early. */
+    CHECK(push(jb, &ids[1], 100000, kBase + MS(15)) == NULL);
+
+    /* The sender's clock steps back a minute: a new timeline, not stragglers. */
+    jitter_buffer_pop(jb, kBase + MS(200));
+    jitter_buffer_pop(jb, kBase + MS(200));
+    CHECK(push(jb, &ids[2], -600000000LL, kBase + MS(210)) == NULL);
+    CHECK(jitter_buffer_pop(jb, kBase + MS(210) + JITTER_BUFFER_MARGIN_NS) == &ids[2]);
+
+    JitterBufferStats stats;
+    jitter_buffer_get_stats(jb, &stats);
+    CHECK_EQ_INT(stats.early, 1);
+    CHECK_EQ_INT(stats.resyncs, 1);
+    CHECK_EQ_INT(stats.released, 3);
+    jitter_buffer_destroy(jb);
+}
+
+static void test_target_is_clamped(void) {
+    JitterBuffer* jb = jitter_buffer_create(4);
+    jitter_buffer_set_target(jb, MS(900));
+    CHECK_EQ_INT(jitter_buffer_get_target(jb), JITTER_BUFFER_MAX_TARGET_NS);
+    jitter_buffer_set_target(jb, -5);
+    CHECK_EQ_INT(jitter_buffer_get_target(jb), 0);
+    jitter_buffer_destroy(jb);
+}
+
+int main(void) {
+    RUN_TEST(test_zero_target_passes_through);
+    RUN_TEST(test_adapts_depth_to_jitter);
+    RUN_TEST(test_target_caps_delay);
+    RUN_TEST(test_reorders_by_timestamp);
+    RUN_TEST(test_full_buffer_evicts_oldest);
+    RUN_TEST(test_full_buffer_evicts_compressed_frame);
+    RUN_TEST(test_stale_compressed_frame_waits_for_key);
+    RUN_TEST(test_early_and_resync);
+    RUN_TEST(test_target_is_clamped);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,139 @@
+/**
+ * latency_histogram_test.c - Host tests for latency_histogram.c
+ */
+
+#include "latency_histogram.h"
+#include "test_util.h"
+
+#include <stdlib.h>
+
+#define US(x) ((int64_t)(x) * 1000LL)
+#define MS(x) ((int64_t)(x) * 1000000LL)
+
+static LatencyHistogram g_histogram;
+
+static LatencyHistogram* new_histogram(void) {
+    latency_histogram_reset(&g_histogram);
+    return &g_histogram;
+}
+
+/* True if value is within the histogram's precision of expected. */
+static int close_to(int64_t value, int64_t expected) {
+    const int64_t error = llabs(value - expected);
+    return error <= (expected / LATENCY_HISTOGRAM_SUB_BUCKETS) + US(1);
+}
+
+/* ============================================================================
+ * Histogram Tests
+ * ========================================================================== */
+
+static void test_empty_histogram(void) {
+    LatencyHistogram* h = new_histogram();
+    CHECK_EQ_INT(latency_histogram_percentile(h, 50.0), 0);
+    CHECK_EQ_INT(latency_histogram_percentile(h, 99.0), 0);
+}
+
+static void test_small_values_are_exact(void) {
+    LatencyHistogram* h = new_histogram();
+    for (int i = 1; i <= 50; i++) {
+        latency_histogram_record(h, US(i));
+    }
+    CHECK_EQ_INT(h->total, 50);
+    CHECK_EQ_INT(latency_histogram_percentile(h, 50.0), US(25));
+    CHECK_EQ_INT(latency_histogram_percentile(h, 100.0), US(50));
+    CHECK_EQ_INT(latency_histogram_percentile(h, 0.0), US(1));
+}
+
+static void test_percentiles_of_uniform_distribution(void) {
+    /* 1 to 100 ms in 10 us steps. */
+    LatencyHistogram* h = new_histogram();
+    for (int64_t v = US(1000); v <= US(100000); v += US(10)) {
+        latency_histogram_record(h, v);
+    }
+    CHECK(close_to(latency_histogram_percentile(h, 50.0), MS(50)));
+    CHECK(close_to(latency_histogram_percentile(h, 95.0), MS(95)));
+    CHECK(close_to(latency_histogram_percentile(h, 99.0), MS(99)));
+    /* Never above the largest value recorded. */
+    CHECK_EQ_INT(latency_histogram_percentile(h, 100.0), MS(100));
+}
+
+static void test_tail_is_not_hidden(void) {
+    /* 98% at 16 ms, 2% at 250 ms: p95 stays low, p99 shows the spikes. */
+    LatencyHistogram* h = new_histogram();
+    for (int i = 0; i < 980; i++) {
+        latency_histogram_record(h, MS(16));
+    }
+    for (int i = 0; i < 20; i++) {
+        latency_histogram_record(h, MS(250));
+    }
+    CHECK(close_to(latency_histogram_percentile(h, 50.0), MS(16)));
+    CHECK(close_to(latency_histogram_percentile(h, 95.0), MS(16)));
+    CHECK(close_to(latency_histogram_percentile(h, 99.0), MS(250)));
+}
+
+static void test_bucket_boundaries(void) {
+    /* Each value must read back within precision, across every power of two. */
+    for (int64_t v = 1; v <= LATENCY_HISTOGRAM_MAX_US; v = v * 3 / 2 + 1) {
+        LatencyHistogram* h = new_histogram();
+        latency_histogram_record(h, US(v));
+        latency_histogram_record(h, US(v));
+        const int64_t p = latency_histogram_percentile(h, 50.0);
+        CHECK(p <= US(v));
+        CHECK(close_to(p, US(v)));
+    }
+}
+
+static void test_out_of_range_values_are_clamped(void) {
+    LatencyHistogram* h = new_histogram();
+    latency_histogram_record(h, -MS(5));
+    latency_histogram_record(h, MS(3600000));
+    CHECK_EQ_INT(h->total, 2);
+    CHECK_EQ_INT(latency_histogram_percentile(h, 0.0), 0);
+    CHECK_EQ_INT(latency_histogram_percentile(h, 100.0), US(LATENCY_HISTOGRAM_MAX_US));
+}
+
+/* ============================================================================
+ * Tracker Tests
+ * ========================================================================== */
+
+static void test_tracker_records_per_stage(void) {
+    LatencyTracker* lt = latency_tracker_create();
+    const int64_t base = MS(500000);
+    for (int i = 0; i < 100; i++) {
+        const int64_t capture = base + MS(16) * i;
+        latency_tracker_record(lt, LATENCY_STAGE_DEQUEUE, capture, capture + MS(2));
+        latency_tracker_record(lt, LATENCY_STAGE_SUBMIT, capture, capture + MS(8));
+        latency_tracker_record(lt, LATENCY_STAGE_PRESENT, capture, capture + MS(30 + (i % 10)));
+    }
+    /* Frames without a capture stamp are not counted. */
+    latency_tracker_record(lt, LATENCY_STAGE_PRESENT, 0, base);
+
+    LatencyStats stats;
+    latency_tracker_get_stats(lt, base + MS(2000), &stats);
+    CHECK_EQ_INT(stats.elapsed_ns, MS(2000) - MS(2));
+    CHECK_EQ_INT(stats.stages[LATENCY_STAGE_DEQUEUE].count, 100);
+    CHECK(close_to(stats.stages[LATENCY_STAGE_DEQUEUE].p99_ns, MS(2)));
+    CHECK(close_to(stats.stages[LATENCY_STAGE_SUBMIT].p50_ns, MS(8)));
+    CHECK_EQ_INT(stats.stages[LATENCY_STAGE_DECODED].count, 0);
+    CHECK_EQ_INT(stats.stages[LATENCY_STAGE_PRESENT].count, 100);
+    CHECK(close_to(stats.stages[LATENCY_STAGE_PRESENT].p50_ns, MS(34)));
+    CHECK(close_to(stats.stages[LATENCY_STAGE_PRESENT].p95_ns, MS(39)));
+    CHECK_EQ_INT(stats.stages[LATENCY_STAGE_PRESENT].max_ns, MS(39));
+
+    latency_tracker_reset(lt);
+    latency_tracker_get_stats(lt, base + MS(3000), &stats);
+    CHECK_EQ_INT(stats.elapsed_ns, 0);
+    CHECK_EQ_INT(stats.stages[LATENCY_STAGE_PRESENT].count, 0);
+    latency_tracker_destroy(lt);
+}
+
+int main(void) {
+    RUN_TEST(test_empty_histogram);
+    RUN_TEST(test_small_values_are_exact);
+    RUN_TEST(test_percentiles_of_uniform_distribution);
+    RUN_TEST(test_tail_is_not_hidden);
+    RUN_TEST(test_bucket_boundaries);
+    RUN_TEST(test_out_of_range_values_are_clamped);
+    RUN_TEST(test_tracker_records_per_stage);
+    return TEST_EXIT_CODE();
+}
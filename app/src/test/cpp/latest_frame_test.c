@@ -0,0 +1,102 @@
+/**
+ * latest_frame_test.c - Host tests for latest_frame.c
+ */
+
+#include "latest_frame.h"
+#include "test_util.h"
+
+#include <stdbool.h>
+
+/* ============================================================================
+ * Random access detection
+ * ========================================================================== */
+
+static void test_h264_idr_after_parameter_sets(void) {
+    /* SPS, PPS, IDR slice with 4-byte and 3-byte start codes. */
+    static const uint8_t au[] = {
+        0, 0, 0, 1, 0x67, 0x42, 0x00, 0x1f,
+        0, 0, 0, 1, 0x68, 0xce, 0x3c, 0x80,
+        0, 0, 1, 0x65, 0x88, 0x84, 0x00,
+    };
+    CHECK(latest_frame_is_random_access(au, sizeof(au), false));
+}
+
+static void test_h264_non_idr_slice(void) {
+    /* SEI then a non-IDR slice; a later IDR NAL in the same buffer is never reached. */
+    static const uint8_t au[] = {
+        0, 0, 1, 0x06, 0x05, 0x01, 0x80,
+        0, 0, 1, 0x41, 0x9a, 0x00,
+        0, 0, 1, 0x65, 0x88,
+    };
+    CHECK(!latest_frame_is_random_access(au, sizeof(au), false));
+}
+
+static void test_hevc_irap_types(void) {
+    /* VPS, SPS, PPS, then the slice under test. nal_unit_type sits in bits 1..6 of the first byte. */
+    uint8_t au[] = {
+        0, 0, 0, 1, 0x40, 0x01, 0x0c,
+        0, 0, 0, 1, 0x42, 0x01, 0x01,
+        0, 0, 0, 1, 0x44, 0x01, 0xc1,
+        0, 0, 0, 1, 0x00, 0x01, 0xaf,
+    };
+    const size_t slice = sizeof(au) - 3;
+    for (int type = 0; type <= 31; type++) {
+        au[slice] = (uint8_t)(type << 1);
+        const bool expected = (type >= 16 && type <= 21);
+        CHECK(latest_frame_is_random_access(au, sizeof(au), true) == expected);
+    }
+}
+
+static void test_malformed_input(void) {
+    static const uint8_t no_start_code[] = { 0x65, 0x88, 0x84, 0x00 };
+    static const uint8_t truncated[] = { 0, 0, 1 };
+    static const uint8_t only_sps[] = { 0, 0, 1, 0x67, 0x42 };
+    CHECK(!latest_frame_is_random_access(no_start_code, sizeof(no_start_code), false));
+    CHECK(!latest_frame_is_random_access(truncated, sizeof(truncated), false));
+    CHECK(!latest_frame_is_random_access(only_sps, sizeof(only_sps), false));
+    CHECK(!latest_frame_is_random_access(NULL, 0, true));
+}
+
+/* ============================================================================
+ * Drain plans
+ * ========================================================================== */
+
+static void test_uncompressed_keeps_newest(void) {
+    const LatestFramePlan one = latest_frame_plan(NULL, 1, false);
+    CHECK_EQ_INT(one.first_kept, 0);
+    CHECK(one.flush_held);
+
+    const LatestFramePlan many = latest_frame_plan(NULL, 5, false);
+    CHECK_EQ_INT(many.first_kept, 4);
+    CHECK(many.flush_held);
+}
+
+static void test_compressed_keeps_from_newest_random_access(void) {
+    const bool gop[] = { false, true, false, false, true, false };
+    const LatestFramePlan plan = latest_frame_plan(gop, 6, true);
+    CHECK_EQ_INT(plan.first_kept, 4);
+    CHECK(plan.flush_held);
+
+    const bool key_first[] = { true, false, false };
+    const LatestFramePlan first = latest_frame_plan(key_first, 3, true);
+    CHECK_EQ_INT(first.first_kept, 0);
+    CHECK(first.flush_held);
+}
+
+static void test_compressed_without_random_access_keeps_all(void) {
+    const bool deltas[] = { false, false, false };
+    const LatestFramePlan plan = latest_frame_plan(deltas, 3, true);
+    CHECK_EQ_INT(plan.first_kept, 0);
+    CHECK(!plan.flush_held);
+}
+
+int main(void) {
+    RUN_TEST(test_h264_idr_after_parameter_sets);
+    RUN_TEST(test_h264_non_idr_slice);
+    RUN_TEST(test_hevc_irap_types);
+    RUN_TEST(test_malformed_input);
+    RUN_TEST(test_uncompressed_keeps_newest);
+    RUN_TEST(test_compressed_keeps_from_newest_random_access);
+    RUN_TEST(test_compressed_without_random_access_keeps_all);
+    return TEST_EXIT_CODE();
+}
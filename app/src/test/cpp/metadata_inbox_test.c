@@ -0,0 +1,140 @@
+/**
+ * metadata_inbox_test.c - Host tests for metadata_inbox.c
+ */
+
+#include "metadata_inbox.h"
+#include "test_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static MetadataInbox* create_subscribed(void) {
+    static const char* const kSubscriptions[] = { "ndi_tally_echo", "ntk_ptz*" };
+    MetadataInbox* inbox = metadata_inbox_create();
+    CHECK(inbox != NULL);
+    CHECK(metadata_inbox_subscribe(inbox, kSubscriptions, 2));
+    return inbox;
+}
+
+static int feed(MetadataInbox* inbox, const char* xml, int64_t timecode) {
+    return metadata_inbox_feed(inbox, xml, strlen(xml) + 1, timecode);
+}
+
+/* ============================================================================
+ * Extraction
+ * ========================================================================== */
+
+static void test_extracts_subscribed_elements_only(void) {
+    MetadataInbox* inbox = create_subscribed();
+    CHECK_EQ_INT(feed(inbox, "<ndi_tally_echo on_program=\"true\" on_preview=\"false\"/>", 42), 1);
+    CHECK_EQ_INT(feed(inbox, "<ndi_capabilities web_control=\"http://x/\"/>", 43), 0);
+
+    MetadataEvent ev;
+    CHECK(metadata_inbox_pop(inbox, &ev));
+    CHECK(strcmp(ev.element, "ndi_tally_echo") == 0);
+    CHECK_EQ_INT(ev.attribute_count, 2);
+    CHECK(strcmp(ev.attribute_names[0], "on_program") == 0);
+    CHECK(strcmp(ev.attribute_values[0], "true") == 0);
+    CHECK(strcmp(ev.attribute_names[1], "on_preview") == 0);
+    CHECK(strcmp(ev.attribute_values[1], "false") == 0);
+    CHECK_EQ_INT(ev.timecode, 42);
+    CHECK(!ev.truncated);
+    CHECK(!metadata_inbox_pop(inbox, &ev));
+    metadata_inbox_destroy(inbox);
+}
+
+static void test_prefix_match_inside_wrapper_with_text(void) {
+    MetadataInbox* inbox = create_subscribed();
+    CHECK_EQ_INT(feed(inbox,
+                      "<ndi_metadata_group>"
+                      "<ntk_ptz_zoom zoom=\"0.5\"/>"
+                      "<ntk_ptz_preset name=\"wide\">  Stage &amp; <b>ignored</b>left  </ntk_ptz_preset>"
+                      "</ndi_metadata_group>", 7), 2);
+
+    MetadataEvent ev;
+    CHECK(metadata_inbox_pop(inbox, &ev));
+    CHECK(strcmp(ev.element, "ntk_ptz_zoom") == 0);
+    CHECK(strcmp(ev.attribute_values[0], "0.5") == 0);
+    CHECK(metadata_inbox_pop(inbox, &ev));
+    CHECK(strcmp(ev.element, "ntk_ptz_preset") == 0);
+    CHECK(strcmp(ev.attribute_values[0], "wide") == 0);
+    CHECK(strcmp(ev.text, "Stage & left") == 0);
+    metadata_inbox_destroy(inbox);
+}
+
+static void test_limits_mark_event_truncated(void) {
+    MetadataInbox* inbox = create_subscribed();
+    char xml[1024];
+    int n = snprintf(xml, sizeof(xml), "<ndi_tally_echo");
+    for (int i = 0; i < METADATA_MAX_ATTRIBUTES + 2; i++) {
+        n += snprintf(xml + n, sizeof(xml) - (size_t)n, " a%d=\"%d\"", i, i);
+    }
+    snprintf(xml + n, sizeof(xml) - (size_t)n, "/>");
+    CHECK_EQ_INT(feed(inbox, xml, 0), 1);
+
+    MetadataEvent ev;
+    CHECK(metadata_inbox_pop(inbox, &ev));
+    CHECK_EQ_INT(ev.attribute_count, METADATA_MAX_ATTRIBUTES);
+    CHECK(ev.truncated);
+    metadata_inbox_destroy(inbox);
+}
+
+static void test_malformed_frame_keeps_completed_events(void) {
+    MetadataInbox* inbox = create_subscribed();
+    CHECK_EQ_INT(feed(inbox, "<ndi_tally_echo on_program=\"true\"/><ntk_ptz_pan pan=", 0), 1);
+
+    MetadataInboxStats stats;
+    metadata_inbox_get_stats(inbox, &stats);
+    CHECK_EQ_INT(stats.frames, 1);
+    CHECK_EQ_INT(stats.malformed, 1);
+    CHECK_EQ_INT(stats.events, 1);
+    CHECK_EQ_INT(stats.queued, 1);
+    metadata_inbox_destroy(inbox);
+}
+
+/* ============================================================================
+ * Queue and subscriptions
+ * ========================================================================== */
+
+static void test_full_queue_drops_oldest(void) {
+    MetadataInbox* inbox = create_subscribed();
+    for (int i = 0; i < METADATA_INBOX_CAPACITY + 5; i++) {
+        feed(inbox, "<ndi_tally_echo on_program=\"true\"/>", i);
+    }
+
+    MetadataInboxStats stats;
+    metadata_inbox_get_stats(inbox, &stats);
+    CHECK_EQ_INT(stats.dropped, 5);
+    CHECK_EQ_INT(stats.queued, METADATA_INBOX_CAPACITY);
+
+    MetadataEvent ev;
+    CHECK(metadata_inbox_pop(inbox, &ev));
+    CHECK_EQ_INT(ev.timecode, 5);
+    metadata_inbox_destroy(inbox);
+}
+
+static void test_invalid_subscriptions_rejected(void) {
+    MetadataInbox* inbox = create_subscribed();
+    static const char* const kEmpty[] = { "" };
+    static const char* const kWildcard[] = { "*" };
+    CHECK(!metadata_inbox_subscribe(inbox, kEmpty, 1));
+    CHECK(!metadata_inbox_subscribe(inbox, kWildcard, 1));
+    CHECK(!metadata_inbox_subscribe(inbox, kEmpty, METADATA_MAX_SUBSCRIPTIONS + 1));
+
+    /* The previous subscriptions still apply. */
+    CHECK_EQ_INT(feed(inbox, "<ntk_ptz_focus/>", 0), 1);
+
+    CHECK(metadata_inbox_subscribe(inbox, NULL, 0));
+    CHECK_EQ_INT(feed(inbox, "<ntk_ptz_focus/>", 0), 0);
+    metadata_inbox_destroy(inbox);
+}
+
+int main(void) {
+    RUN_TEST(test_extracts_subscribed_elements_only);
+    RUN_TEST(test_prefix_match_inside_wrapper_with_text);
+    RUN_TEST(test_limits_mark_event_truncated);
+    RUN_TEST(test_malformed_frame_keeps_completed_events);
+    RUN_TEST(test_full_queue_drops_oldest);
+    RUN_TEST(test_invalid_subscriptions_rejected);
+    return TEST_EXIT_CODE();
+}
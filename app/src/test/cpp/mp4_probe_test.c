@@ -0,0 +1,368 @@
+/**
+ * mp4_probe_test.c - Host tests for mp4_probe.c against MP4 files built in memory
+ */
+
+#include "mp4_probe.h"
+#include "test_util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * MP4 builder
+ * ========================================================================== */
+
+#define BUILDER_CAPACITY 65536
+#define BUILDER_DEPTH 8
+
+typedef struct Builder {
+    uint8_t data[BUILDER_CAPACITY];
+    size_t length;
+    size_t open[BUILDER_DEPTH];   /* Offsets of boxes whose size is not yet written. */
+    int depth;
+} Builder;
+
+static void put8(Builder* b, uint8_t v) {
+    b->data[b->length++] = v;
+}
+
+static void put16(Builder* b, uint16_t v) {
+    put8(b, (uint8_t)(v >> 8));
+    put8(b, (uint8_t)v);
+}
+
+static void put32(Builder* b, uint32_t v) {
+    put16(b, (uint16_t)(v >> 16));
+    put16(b, (uint16_t)v);
+}
+
+static void put64(Builder* b, uint64_t v) {
+    put32(b, (uint32_t)(v >> 32));
+    put32(b, (uint32_t)v);
+}
+
+static void zeros(Builder* b, size_t count) {
+    memset(b->data + b->length, 0, count);
+    b->length += count;
+}
+
+static void begin(Builder* b, const char* type) {
+    b->open[b->depth++] = b->length;
+    put32(b, 0);
+    put32(b, MP4_FOURCC(type[0], type[1], type[2], type[3]));
+}
+
+static void end(Builder* b) {
+    const size_t start = b->open[--b->depth];
+    const uint32_t size = (uint32_t)(b->length - start);
+    b->data[start] = (uint8_t)(size >> 24);
+    b->data[start + 1] = (uint8_t)(size >> 16);
+    b->data[start + 2] = (uint8_t)(size >> 8);
+    b->data[start + 3] = (uint8_t)size;
+}
+
+static void full(Builder* b, const char* type, uint8_t version, uint32_t flags) {
+    begin(b, type);
+    put32(b, ((uint32_t)version << 24) | flags);
+}
+
+static void ftyp(Builder* b) {
+    begin(b, "ftyp");
+    put32(b, MP4_FOURCC('i', 's', 'o', 'm'));
+    put32(b, 0);
+    end(b);
+}
+
+static void mdat(Builder* b, size_t payload) {
+    begin(b, "mdat");
+    zeros(b, payload);
+    end(b);
+}
+
+static void mvhd(Builder* b, uint8_t version, uint32_t timescale, uint64_t duration) {
+    full(b, "mvhd", version, 0);
+    if (version == 1) {
+        zeros(b, 16);
+        put32(b, timescale);
+        put64(b, duration);
+    } else {
+        zeros(b, 8);
+        put32(b, timescale);
+        put32(b, (uint32_t)duration);
+    }
+    zeros(b, 80);
+    end(b);
+}
+
+static void trak(Builder* b, uint32_t id, const char* handler, const char* codec, int width, int height,
+                 uint32_t timescale) {
+    begin(b, "trak");
+
+    full(b, "tkhd", 0, 3);
+    zeros(b, 8);
+    put32(b, id);
+    zeros(b, 4 + 4 + 8 + 8 + 36);
+    put32(b, (uint32_t)width << 16);
+    put32(b, (uint32_t)height << 16);
+    end(b);
+
+    begin(b, "mdia");
+    full(b, "mdhd", 0, 0);
+    zeros(b, 8);
+    put32(b, timescale);
+    put32(b, 0);
+    zeros(b, 4);
+    end(b);
+    full(b, "hdlr", 0, 0);
+    put32(b, 0);
+    put32(b, MP4_FOURCC(handler[0], handler[1], handler[2], handler[3]));
+    zeros(b, 13);
+    end(b);
+    begin(b, "minf");
+    begin(b, "stbl");
+    full(b, "stsd", 0, 0);
+    put32(b, 1);
+    begin(b, codec);
+    zeros(b, 6);
+    put16(b, 1);
+    zeros(b, 16);
+    put16(b, (uint16_t)width);
+    put16(b, (uint16_t)height);
+    zeros(b, 50);
+    end(b);
+    end(b);
+    /* A sample table the probe must skip over without reading. */
+    full(b, "stsz", 0, 0);
+    zeros(b, 4000);
+    end(b);
+    end(b);
+    end(b);
+    end(b);
+
+    end(b);
+}
+
+static void moof(Builder* b, uint32_t track_id, int64_t decode_time, uint32_t default_duration,
+                 const uint32_t* durations, uint32_t count) {
+    begin(b, "moof");
+    full(b, "mfhd", 0, 0);
+    put32(b, 1);
+    end(b);
+    begin(b, "traf");
+    full(b, "tfhd", 0, default_duration ? 0x08u : 0u);
+    put32(b, track_id);
+    if (default_duration) {
+        put32(b, default_duration);
+    }
+    end(b);
+    if (decode_time >= 0) {
+        full(b, "tfdt", 1, 0);
+        put64(b, (uint64_t)decode_time);
+        end(b);
+    }
+    /* Sizes are always present, durations only when given. */
+    full(b, "trun", 0, 0x000001u | 0x000200u | (durations ? 0x000100u : 0u));
+    put32(b, count);
+    put32(b, 0);
+    for (uint32_t i = 0; i < count; i++) {
+        if (durations) {
+            put32(b, durations[i]);
+        }
+        put32(b, 100);
+    }
+    end(b);
+    end(b);
+    end(b);
+}
+
+/* Write the builder to a temporary file and probe it. */
+static bool probe(const Builder* b, Mp4Info* info) {
+    char path[] = "/tmp/mp4_probe_testXXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        return false;
+    }
+    unlink(path);
+    const bool written = write(fd, b->data, b->length) == (ssize_t)b->length;
+    const bool ok = written && mp4_probe_fd(fd, info);
+    close(fd);
+    return ok;
+}
+
+static Builder g_builder;
+
+static Builder* new_file(void) {
+    memset(&g_builder, 0, sizeof(g_builder));
+    ftyp(&g_builder);
+    return &g_builder;
+}
+
+/* ============================================================================
+ * Progressive files
+ * ========================================================================== */
+
+static void test_moov_after_mdat(void) {
+    /* MediaMuxer layout: the moov follows the media data. */
+    Builder* b = new_file();
+    mdat(b, 20000);
+    begin(b, "moov");
+    mvhd(b, 0, 1000, 12345);
+    trak(b, 1, "soun", "mp4a", 0, 0, 48000);
+    trak(b, 2, "vide", "avc1", 1920, 1080, 90000);
+    end(b);
+
+    Mp4Info info;
+    CHECK(probe(b, &info));
+    CHECK_EQ_INT(info.duration_ms, 12345);
+    CHECK_EQ_INT(info.width, 1920);
+    CHECK_EQ_INT(info.height, 1080);
+    CHECK_EQ_INT(info.video_codec, MP4_FOURCC('a', 'v', 'c', '1'));
+    CHECK(!info.fragmented);
+    /* Headers and a few fields, never the media data or sample tables. */
+    CHECK(info.reads < 40);
+}
+
+static void test_version1_mvhd_and_large_mdat(void) {
+    Builder* b = new_file();
+    /* 64-bit size header on the mdat. */
+    put32(b, 1);
+    put32(b, MP4_FOURCC('m', 'd', 'a', 't'));
+    put64(b, 16 + 64);
+    zeros(b, 64);
+    begin(b, "moov");
+    mvhd(b, 1, 90000, 90000ULL * 3600 * 5 + 45000);   /* 5 h 0.5 s */
+    trak(b, 1, "vide", "hvc1", 3840, 2160, 90000);
+    end(b);
+
+    Mp4Info info;
+    CHECK(probe(b, &info));
+    CHECK_EQ_INT(info.duration_ms, 3600LL * 5 * 1000 + 500);
+    CHECK_EQ_INT(info.width, 3840);
+    CHECK_EQ_INT(info.video_codec, MP4_FOURCC('h', 'v', 'c', '1'));
+}
+
+static void test_audio_only_has_no_size(void) {
+    Builder* b = new_file();
+    begin(b, "moov");
+    mvhd(b, 0, 44100, 44100 * 2);
+    trak(b, 1, "soun", "mp4a", 0, 0, 44100);
+    end(b);
+
+    Mp4Info info;
+    CHECK(probe(b, &info));
+    CHECK_EQ_INT(info.duration_ms, 2000);
+    CHECK_EQ_INT(info.width, 0);
+    CHECK_EQ_INT(info.video_codec, 0);
+}
+
+/* ============================================================================
+ * Fragmented files
+ * ========================================================================== */
+
+static void test_fragmented_with_mehd(void) {
+    Builder* b = new_file();
+    begin(b, "moov");
+    mvhd(b, 0, 1000, 0);
+    trak(b, 1, "vide", "avc1", 1280, 720, 30000);
+    begin(b, "mvex");
+    full(b, "mehd", 0, 0);
+    put32(b, 7500);
+    end(b);
+    end(b);
+    end(b);
+
+    Mp4Info info;
+    CHECK(probe(b, &info));
+    CHECK(info.fragmented);
+    CHECK_EQ_INT(info.duration_ms, 7500);
+    CHECK_EQ_INT(info.width, 1280);
+}
+
+static void test_fragmented_duration_from_moofs(void) {
+    /* 30 fps at timescale 30000: trex default 1000, or per-sample durations. */
+    Builder* b = new_file();
+    begin(b, "moov");
+    mvhd(b, 0, 1000, 0);
+    trak(b, 1, "vide", "avc1", 1280, 720, 30000);
+    trak(b, 2, "soun", "mp4a", 0, 0, 48000);
+    begin(b, "mvex");
+    full(b, "trex", 0, 0);
+    put32(b, 1);
+    put32(b, 1);
+    put32(b, 1000);
+    put32(b, 0);
+    put32(b, 0);
+    end(b);
+    end(b);
+    end(b);
+
+    /* Fragment 1: no tfdt, 30 samples at the trex default (1 s). */
+    moof(b, 1, -1, 0, NULL, 30);
+    mdat(b, 3000);
+    /* Audio fragment: ignored, it is not the video track. */
+    moof(b, 2, 0, 1024, NULL, 1000);
+    mdat(b, 100);
+    /* Fragment 2: continues without tfdt, tfhd default 2000 (2 s). */
+    moof(b, 1, -1, 2000, NULL, 30);
+    mdat(b, 3000);
+    /* Fragment 3: tfdt at 3 s plus per-sample durations totalling 0.5 s. */
+    const uint32_t durations[3] = {5000, 5000, 5000};
+    moof(b, 1, 90000, 0, durations, 3);
+    mdat(b, 300);
+
+    Mp4Info info;
+    CHECK(probe(b, &info));
+    CHECK(info.fragmented);
+    CHECK_EQ_INT(info.duration_ms, 3500);
+}
+
+/* ============================================================================
+ * Invalid files
+ * ========================================================================== */
+
+static void test_unfinalized_recording_fails(void) {
+    /* Recording interrupted before the moov was written. */
+    Builder* b = new_file();
+    mdat(b, 1000);
+    Mp4Info info;
+    CHECK(!probe(b, &info));
+}
+
+static void test_truncated_moov_fails(void) {
+    Builder* b = new_file();
+    begin(b, "moov");
+    mvhd(b, 0, 1000, 5000);
+    trak(b, 1, "vide", "avc1", 640, 480, 30000);
+    end(b);
+    b->length -= 100;
+
+    Mp4Info info;
+    CHECK(!probe(b, &info));
+}
+
+static void test_garbage_and_missing_files_fail(void) {
+    Builder* b = new_file();
+    b->length = 0;
+    for (int i = 0; i < 256; i++) {
+        put8(b, (uint8_t)(i * 37 + 11));
+    }
+    Mp4Info info;
+    CHECK(!probe(b, &info));
+    CHECK(!mp4_probe_path("/nonexistent/recording.mp4", &info));
+    CHECK(!mp4_probe_fd(-1, &info));
+}
+
+int main(void) {
+    RUN_TEST(test_moov_after_mdat);
+    RUN_TEST(test_version1_mvhd_and_large_mdat);
+    RUN_TEST(test_audio_only_has_no_size);
+    RUN_TEST(test_fragmented_with_mehd);
+    RUN_TEST(test_fragmented_duration_from_moofs);
+    RUN_TEST(test_unfinalized_recording_fails);
+    RUN_TEST(test_truncated_moov_fails);
+    RUN_TEST(test_garbage_and_missing_files_fail);
+    return TEST_EXIT_CODE();
+}
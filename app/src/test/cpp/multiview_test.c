@@ -0,0 +1,206 @@
+/**
+ * multiview_test.c - Host tests for multiview.c
+ */
+
+#include "multiview.h"
+#include "test_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum { W = 120, H = 60 };
+
+static uint8_t g_frame[32 * 18 * 4];
+
+static const uint8_t* solid_frame(uint8_t r, uint8_t g, uint8_t b) {
+    for (int i = 0; i < 32 * 18; i++) {
+        g_frame[i * 4 + 0] = r;
+        g_frame[i * 4 + 1] = g;
+        g_frame[i * 4 + 2] = b;
+        g_frame[i * 4 + 3] = 255;
+    }
+    return g_frame;
+}
+
+static const uint8_t* pixel(const uint8_t* p, int x, int y) {
+    return p + ((size_t)y * W + (size_t)x) * 4;
+}
+
+static bool rect_is(const MultiviewRect* r, int left, int top, int right, int bottom) {
+    return r->left == left && r->top == top && r->right == right && r->bottom == bottom;
+}
+
+static void present_all(Multiview* mv, uint8_t* out) {
+    MultiviewRect dirty;
+    while (multiview_begin_present(mv, &dirty)) {
+        multiview_present(mv, out, W * 4, &dirty);
+    }
+}
+
+/* ============================================================================
+ * Layout
+ * ========================================================================== */
+
+static void test_create_limits(void) {
+    CHECK(multiview_create(W, H, 0, 1) == NULL);
+    CHECK(multiview_create(W, H, 5, 4) == NULL);
+    CHECK(multiview_create(2, 2, 3, 1) == NULL);
+    Multiview* mv = multiview_create(W, H, 4, 4);
+    CHECK(mv != NULL);
+    CHECK_EQ_INT(multiview_tile_count(mv), 16);
+    multiview_destroy(mv);
+}
+
+static void test_tiles_partition_the_canvas(void) {
+    Multiview* mv = multiview_create(100, 50, 3, 3);
+    MultiviewRect r;
+    CHECK(multiview_tile_rect(mv, 0, &r));
+    CHECK(rect_is(&r, 0, 0, 33, 16));
+    CHECK(multiview_tile_rect(mv, 4, &r));
+    CHECK(rect_is(&r, 33, 16, 66, 33));
+    CHECK(multiview_tile_rect(mv, 8, &r));
+    CHECK(rect_is(&r, 66, 33, 100, 50));
+    CHECK(!multiview_tile_rect(mv, 9, &r));
+    multiview_destroy(mv);
+}
+
+/* ============================================================================
+ * Dirty Tracking
+ * ========================================================================== */
+
+static void test_only_changed_tiles_present(void) {
+    uint8_t* out = (uint8_t*)calloc(W * H, 4);
+    Multiview* mv = multiview_create(W, H, 2, 2);
+    MultiviewRect dirty;
+
+    /* A new canvas is all dirty and black. */
+    CHECK(multiview_begin_present(mv, &dirty));
+    CHECK(rect_is(&dirty, 0, 0, W, H));
+    multiview_present(mv, out, W * 4, &dirty);
+    CHECK_EQ_INT(pixel(out, 5, 5)[3], 255);
+    CHECK(!multiview_begin_present(mv, &dirty));
+
+    /* One submit dirties one tile; the rest of the output is left alone. */
+    memset(out, 0x11, (size_t)W * H * 4);
+    CHECK(multiview_submit(mv, 3, solid_frame(200, 0, 0), 32 * 4, 32, 18, SCALER_RGBA));
+    CHECK(multiview_begin_present(mv, &dirty));
+    CHECK(rect_is(&dirty, 60, 30, 120, 60));
+    multiview_present(mv, out, W * 4, &dirty);
+    CHECK_EQ_INT(pixel(out, 90, 45)[0], 200);
+    CHECK_EQ_INT(pixel(out, 10, 10)[0], 0x11);
+    CHECK(!multiview_begin_present(mv, &dirty));
+
+    /* Two tiles: their bounding box. */
+    multiview_submit(mv, 0, solid_frame(0, 200, 0), 32 * 4, 32, 18, SCALER_RGBA);
+    multiview_submit(mv, 1, solid_frame(0, 0, 200), 32 * 4, 32, 18, SCALER_RGBA);
+    CHECK(multiview_begin_present(mv, &dirty));
+    CHECK(rect_is(&dirty, 0, 0, 120, 30));
+
+    /* A present narrower than a dirty tile leaves it dirty. */
+    const MultiviewRect left_half = { 0, 0, 30, 30 };
+    multiview_present(mv, out, W * 4, &left_half);
+    CHECK(multiview_begin_present(mv, &dirty));
+    CHECK(rect_is(&dirty, 0, 0, 120, 30));
+    present_all(mv, out);
+
+    multiview_invalidate(mv);
+    CHECK(multiview_begin_present(mv, &dirty));
+    CHECK(rect_is(&dirty, 0, 0, W, H));
+
+    MultiviewStats stats;
+    multiview_get_stats(mv, &stats);
+    CHECK_EQ_INT(stats.presents, 4);
+    CHECK_EQ_INT(stats.idle_presents, 3);
+    multiview_destroy(mv);
+    free(out);
+}
+
+/* ============================================================================
+ * Composing
+ * ========================================================================== */
+
+static void test_letterbox(void) {
+    uint8_t* out = (uint8_t*)calloc(W * H, 4);
+    Multiview* mv = multiview_create(W, H, 2, 1);
+    /* 16:9 into a 60x60 tile: 60x33 centred, bars above and below. */
+    CHECK(multiview_submit(mv, 0, solid_frame(255, 255, 255), 32 * 4, 32, 18, SCALER_RGBA));
+    present_all(mv, out);
+    CHECK_EQ_INT(pixel(out, 30, 30)[0], 255);
+    CHECK_EQ_INT(pixel(out, 0, 13)[0], 255);
+    CHECK_EQ_INT(pixel(out, 30, 12)[0], 0);
+    CHECK_EQ_INT(pixel(out, 30, 46)[0], 0);
+    CHECK_EQ_INT(pixel(out, 30, 46)[3], 255);
+
+    /* Portrait into the same tile: the old picture's edges become bars. */
+    static uint8_t tall[18 * 32 * 4];
+    memset(tall, 0x80, sizeof(tall));
+    CHECK(multiview_submit(mv, 0, tall, 18 * 4, 18, 32, SCALER_RGBX));
+    present_all(mv, out);
+    CHECK_EQ_INT(pixel(out, 30, 30)[0], 0x80);
+    CHECK_EQ_INT(pixel(out, 30, 0)[0], 0x80);
+    CHECK_EQ_INT(pixel(out, 5, 30)[0], 0);
+
+    /* Nothing spilled into the other tile. */
+    CHECK_EQ_INT(pixel(out, 90, 30)[0], 0);
+    multiview_destroy(mv);
+    free(out);
+}
+
+static void test_clear_tile(void) {
+    uint8_t* out = (uint8_t*)calloc(W * H, 4);
+    Multiview* mv = multiview_create(W, H, 2, 1);
+    multiview_submit(mv, 1, solid_frame(9, 9, 9), 32 * 4, 32, 18, SCALER_RGBA);
+    present_all(mv, out);
+    CHECK_EQ_INT(pixel(out, 90, 30)[0], 9);
+
+    multiview_clear_tile(mv, 1);
+    present_all(mv, out);
+    CHECK_EQ_INT(pixel(out, 90, 30)[0], 0);
+    MultiviewTileStats stats;
+    CHECK(multiview_get_tile_stats(mv, 1, &stats));
+    CHECK(!stats.has_frame);
+    CHECK_EQ_INT(stats.age_ns, 0);
+    multiview_destroy(mv);
+    free(out);
+}
+
+static void test_tile_stats(void) {
+    uint8_t* out = (uint8_t*)calloc(W * H, 4);
+    Multiview* mv = multiview_create(W, H, 2, 2);
+    MultiviewTileStats stats;
+    CHECK(multiview_get_tile_stats(mv, 2, &stats));
+    CHECK(!stats.has_frame);
+    CHECK_EQ_INT(stats.frames, 0);
+
+    /* Three frames before one present: two of them were never shown. */
+    for (int i = 0; i < 3; i++) {
+        CHECK(multiview_submit(mv, 2, solid_frame(1, 2, 3), 32 * 4, 32, 18, SCALER_BGRA));
+    }
+    present_all(mv, out);
+    CHECK(multiview_submit(mv, 2, solid_frame(1, 2, 3), 32 * 4, 32, 18, SCALER_BGRA));
+    CHECK(!multiview_submit(mv, 2, solid_frame(1, 2, 3), 4, 32, 18, SCALER_BGRA));
+    CHECK(!multiview_submit(mv, 4, solid_frame(1, 2, 3), 32 * 4, 32, 18, SCALER_BGRA));
+
+    CHECK(multiview_get_tile_stats(mv, 2, &stats));
+    CHECK(stats.has_frame);
+    CHECK_EQ_INT(stats.src_width, 32);
+    CHECK_EQ_INT(stats.src_height, 18);
+    CHECK_EQ_INT(stats.frames, 4);
+    CHECK_EQ_INT(stats.superseded, 2);
+    CHECK(stats.age_ns >= 0);
+    CHECK(stats.compose_avg_ns > 0);
+    CHECK(stats.compose_max_ns >= stats.compose_avg_ns);
+    CHECK(!multiview_get_tile_stats(mv, 4, &stats));
+    multiview_destroy(mv);
+    free(out);
+}
+
+int main(void) {
+    RUN_TEST(test_create_limits);
+    RUN_TEST(test_tiles_partition_the_canvas);
+    RUN_TEST(test_only_changed_tiles_present);
+    RUN_TEST(test_letterbox);
+    RUN_TEST(test_clear_tile);
+    RUN_TEST(test_tile_stats);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,275 @@
+/**
+ * ndi_relay_test.c - Host tests for ndi_relay.c against the stub SDK's loopback (ndi_stub.c)
+ *
+ * Usage: ndi_relay_test <stub library>
+ */
+
+#include "ndi_relay.h"
+#include "ndi_runtime.h"
+#include "test_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define RELAY_NAME "Relay Test"
+
+static const NDIlib_v6* g_api;
+
+/* Owners handed back through the release callback, in order. */
+static int g_released[8];
+static int g_released_count;
+
+static void record_release(void* owner, void* context) {
+    (void)context;
+    if (g_released_count < (int)(sizeof(g_released) / sizeof(g_released[0]))) {
+        g_released[g_released_count] = *(const int*)owner;
+    }
+    g_released_count++;
+}
+
+static NdiRelay* create_relay(void) {
+    g_released_count = 0;
+    return ndi_relay_create(g_api, RELAY_NAME, record_release, NULL);
+}
+
+static NDIlib_recv_instance_t connect_receiver(void) {
+    NDIlib_recv_create_v3_t settings;
+    memset(&settings, 0, sizeof(settings));
+    settings.source_to_connect_to.p_ndi_name = RELAY_NAME;
+    return g_api->recv_create_v3(&settings);
+}
+
+static NDIlib_video_frame_v2_t make_frame(uint8_t* data, NDIlib_FourCC_video_type_e fourcc) {
+    NDIlib_video_frame_v2_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.xres = 4;
+    frame.yres = 2;
+    frame.FourCC = fourcc;
+    frame.frame_rate_N = 30000;
+    frame.frame_rate_D = 1001;
+    frame.frame_format_type = NDIlib_frame_format_type_progressive;
+    frame.timecode = 1234;
+    frame.p_data = data;
+    frame.line_stride_in_bytes = 8;
+    return frame;
+}
+
+static uint32_t advertised_count(void) {
+    uint32_t count = 0;
+    g_api->find_get_current_sources(NULL, &count);
+    return count;
+}
+
+/* Send a frame nobody is watching yet, which makes the relay advertise itself. */
+static void advertise(NdiRelay* relay) {
+    uint8_t pixels[16] = {0};
+    int owner = 0;
+    NDIlib_video_frame_v2_t frame = make_frame(pixels, NDIlib_FourCC_video_type_UYVY);
+    CHECK(!ndi_relay_send_video(relay, &frame, &owner));
+}
+
+/* ============================================================================
+ * Loopback
+ * ========================================================================== */
+
+static void test_receiver_gets_relayed_frame_without_copy(void) {
+    NdiRelay* relay = create_relay();
+    CHECK(relay != NULL);
+    if (relay == NULL) {
+        return;
+    }
+
+    /* Nothing is advertised before there is a frame to send. */
+    NdiRelayStats stats;
+    ndi_relay_get_stats(relay, &stats);
+    CHECK(!stats.advertising);
+    CHECK_EQ_INT(advertised_count(), 0);
+
+    /* Then the relay is discoverable under its name. */
+    advertise(relay);
+    uint32_t count = 0;
+    const NDIlib_source_t* sources = g_api->find_get_current_sources(NULL, &count);
+    CHECK_EQ_INT(count, 1);
+    CHECK(sources != NULL && strcmp(sources[0].p_ndi_name, RELAY_NAME) == 0);
+
+    NDIlib_recv_instance_t recv = connect_receiver();
+    ndi_relay_get_stats(relay, &stats);
+    CHECK(stats.advertising);
+    CHECK_EQ_INT(stats.connections, 1);
+
+    uint8_t pixels[16] = {0};
+    int owner = 1;
+    NDIlib_video_frame_v2_t frame = make_frame(pixels, NDIlib_FourCC_video_type_UYVY);
+    CHECK(ndi_relay_send_video(relay, &frame, &owner));
+
+    NDIlib_video_frame_v2_t received;
+    CHECK(g_api->recv_capture_v2(recv, &received, NULL, NULL, 0) == NDIlib_frame_type_video);
+    CHECK(received.p_data == pixels);
+    CHECK_EQ_INT(received.xres, 4);
+    CHECK_EQ_INT(received.yres, 2);
+    CHECK_EQ_INT(received.timecode, 1234);
+    CHECK(g_api->recv_capture_v2(recv, &received, NULL, NULL, 0) == NDIlib_frame_type_none);
+
+    ndi_relay_get_stats(relay, &stats);
+    CHECK_EQ_INT(stats.video_sent, 1);
+
+    g_api->recv_destroy(recv);
+    ndi_relay_destroy(relay);
+}
+
+static void test_frame_held_until_next_send(void) {
+    NdiRelay* relay = create_relay();
+    advertise(relay);
+    NDIlib_recv_instance_t recv = connect_receiver();
+
+    uint8_t pixels[16] = {0};
+    int first = 1;
+    int second = 2;
+    NDIlib_video_frame_v2_t frame = make_frame(pixels, NDIlib_FourCC_video_type_UYVY);
+
+    CHECK(ndi_relay_send_video(relay, &frame, &first));
+    CHECK_EQ_INT(g_released_count, 0);
+    CHECK(ndi_relay_send_video(relay, &frame, &second));
+    CHECK_EQ_INT(g_released_count, 1);
+    CHECK_EQ_INT(g_released[0], 1);
+
+    /* Destroying flushes the frame still in flight. */
+    ndi_relay_destroy(relay);
+    CHECK_EQ_INT(g_released_count, 2);
+    CHECK_EQ_INT(g_released[1], 2);
+    g_api->recv_destroy(recv);
+}
+
+static void test_unwatched_frames_not_sent_or_held(void) {
+    NdiRelay* relay = create_relay();
+    uint8_t pixels[16] = {0};
+    int first = 1;
+    int second = 2;
+    NDIlib_video_frame_v2_t frame = make_frame(pixels, NDIlib_FourCC_video_type_UYVY);
+
+    CHECK(!ndi_relay_send_video(relay, &frame, &first));
+    CHECK_EQ_INT(g_released_count, 0);
+
+    /* When the last receiver leaves, the frame in flight is released at the next send. */
+    NDIlib_recv_instance_t recv = connect_receiver();
+    CHECK(ndi_relay_send_video(relay, &frame, &first));
+    g_api->recv_destroy(recv);
+    CHECK(!ndi_relay_send_video(relay, &frame, &second));
+    CHECK_EQ_INT(g_released_count, 1);
+    CHECK_EQ_INT(g_released[0], 1);
+
+    NdiRelayStats stats;
+    ndi_relay_get_stats(relay, &stats);
+    CHECK_EQ_INT(stats.video_sent, 1);
+    CHECK_EQ_INT(stats.video_unwatched, 2);
+    CHECK_EQ_INT(stats.connections, 0);
+
+    ndi_relay_destroy(relay);
+    CHECK_EQ_INT(g_released_count, 1);
+}
+
+/* ============================================================================
+ * Formats and audio
+ * ========================================================================== */
+
+static void test_compressed_stream_not_advertised(void) {
+    NdiRelay* relay = create_relay();
+    uint8_t payload[16] = {0};
+    int first = 1;
+    int second = 2;
+    NDIlib_video_frame_v2_t h264 =
+        make_frame(payload, (NDIlib_FourCC_video_type_e)NDI_LIB_FOURCC('H', '2', '6', '4'));
+    NDIlib_video_frame_v2_t uyvy = make_frame(payload, NDIlib_FourCC_video_type_UYVY);
+
+    /* An HX stream never becomes a (black) source. */
+    CHECK(!ndi_relay_send_video(relay, &h264, &first));
+    CHECK_EQ_INT(advertised_count(), 0);
+    NdiRelayStats stats;
+    ndi_relay_get_stats(relay, &stats);
+    CHECK_EQ_INT(stats.video_skipped, 1);
+    CHECK_EQ_INT(stats.video_sent, 0);
+    CHECK(stats.compressed);
+    CHECK(!stats.advertising);
+
+    /* The sender switching to uncompressed video brings the relay up... */
+    advertise(relay);
+    NDIlib_recv_instance_t recv = connect_receiver();
+    CHECK(ndi_relay_send_video(relay, &uyvy, &first));
+    ndi_relay_get_stats(relay, &stats);
+    CHECK(!stats.compressed);
+    CHECK(stats.advertising);
+
+    /* ...and back to compressed withdraws it, releasing the frame in flight. */
+    CHECK(!ndi_relay_send_video(relay, &h264, &second));
+    CHECK_EQ_INT(g_released_count, 1);
+    CHECK_EQ_INT(g_released[0], 1);
+    CHECK_EQ_INT(advertised_count(), 0);
+    ndi_relay_get_stats(relay, &stats);
+    CHECK(stats.compressed);
+    CHECK(!stats.advertising);
+    CHECK_EQ_INT(stats.connections, 0);
+
+    g_api->recv_destroy(recv);
+    ndi_relay_destroy(relay);
+    CHECK_EQ_INT(g_released_count, 1);
+}
+
+static void test_audio_sent_only_when_watched(void) {
+    NdiRelay* relay = create_relay();
+    float samples[8] = {0};
+    NDIlib_audio_frame_v2_t audio;
+    memset(&audio, 0, sizeof(audio));
+    audio.sample_rate = 48000;
+    audio.no_channels = 2;
+    audio.no_samples = 4;
+    audio.channel_stride_in_bytes = 4 * (int)sizeof(float);
+    audio.p_data = samples;
+
+    /* Not advertised yet, then advertised but unwatched. */
+    CHECK(!ndi_relay_send_audio(relay, &audio));
+    advertise(relay);
+    CHECK(!ndi_relay_send_audio(relay, &audio));
+    NDIlib_recv_instance_t recv = connect_receiver();
+    CHECK(ndi_relay_send_audio(relay, &audio));
+
+    NdiRelayStats stats;
+    ndi_relay_get_stats(relay, &stats);
+    CHECK_EQ_INT(stats.audio_sent, 1);
+
+    g_api->recv_destroy(recv);
+    ndi_relay_destroy(relay);
+}
+
+static void test_requires_send_entries(void) {
+    NDIlib_v6 empty;
+    memset(&empty, 0, sizeof(empty));
+    CHECK(!ndi_relay_supported(&empty));
+    CHECK(ndi_relay_create(&empty, RELAY_NAME, record_release, NULL) == NULL);
+    CHECK(ndi_relay_supported(g_api));
+    CHECK(ndi_relay_create(g_api, "", record_release, NULL) == NULL);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <stub library>\n", argv[0]);
+        return 2;
+    }
+
+    NdiRuntime rt;
+    char error[256] = "";
+    if (!ndi_runtime_open(&rt, argv[1], error, sizeof(error))) {
+        fprintf(stderr, "cannot load stub: %s\n", error);
+        return 1;
+    }
+    g_api = rt.api;
+
+    RUN_TEST(test_receiver_gets_relayed_frame_without_copy);
+    RUN_TEST(test_frame_held_until_next_send);
+    RUN_TEST(test_unwatched_frames_not_sent_or_held);
+    RUN_TEST(test_compressed_stream_not_advertised);
+    RUN_TEST(test_audio_sent_only_when_watched);
+    RUN_TEST(test_requires_send_entries);
+
+    ndi_runtime_close(&rt);
+    return TEST_EXIT_CODE();
+}
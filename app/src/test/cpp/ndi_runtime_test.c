@@ -0,0 +1,92 @@
+/**
+ * ndi_runtime_test.c - Host tests for ndi_runtime.c against the stub SDK (ndi_stub.c)
+ *
+ * Usage: ndi_runtime_test <stub library> <incomplete stub library>
+ */
+
+#include "ndi_runtime.h"
+#include "test_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char* g_stub_path;
+static const char* g_incomplete_stub_path;
+
+/* ============================================================================
+ * Loading
+ * ========================================================================== */
+
+static void test_opens_stub_and_dispatches_through_table(void) {
+    NdiRuntime rt;
+    char error[256] = "";
+    CHECK(ndi_runtime_open(&rt, g_stub_path, error, sizeof(error)));
+    CHECK(rt.handle != NULL && rt.api != NULL);
+    if (rt.api == NULL) {
+        return;
+    }
+    CHECK(rt.open_ns >= 0 && rt.resolve_ns >= 0);
+    CHECK(rt.api->initialize());
+    CHECK(strcmp(rt.api->version(), "NDI stub") == 0);
+
+    NDIlib_video_frame_v2_t video;
+    NDIlib_metadata_frame_t metadata;
+    NDIlib_recv_instance_t recv = rt.api->recv_create_v3(NULL);
+    CHECK(rt.api->recv_capture_v2(recv, &video, NULL, &metadata, 0) == NDIlib_frame_type_none);
+    rt.api->recv_destroy(recv);
+
+    rt.api->destroy();
+    ndi_runtime_close(&rt);
+    CHECK(rt.handle == NULL && rt.api == NULL);
+}
+
+static void test_missing_library_reports_error(void) {
+    NdiRuntime rt;
+    char error[256] = "";
+    CHECK(!ndi_runtime_open(&rt, "/nonexistent/libndi.so", error, sizeof(error)));
+    CHECK(rt.handle == NULL && rt.api == NULL);
+    CHECK(strncmp(error, "dlopen failed", 13) == 0);
+}
+
+static void test_incomplete_table_rejected(void) {
+    NdiRuntime rt;
+    char error[256] = "";
+    CHECK(!ndi_runtime_open(&rt, g_incomplete_stub_path, error, sizeof(error)));
+    CHECK(rt.api == NULL);
+    CHECK(strstr(error, "recv_capture_v2") != NULL);
+}
+
+/* ============================================================================
+ * Path resolution
+ * ========================================================================== */
+
+static void test_path_resolution_order(void) {
+    unsetenv(NDI_RUNTIME_PATH_ENV);
+    CHECK(strcmp(ndi_runtime_resolve_path(NULL), NDI_RUNTIME_DEFAULT_LIBRARY) == 0);
+    CHECK(strcmp(ndi_runtime_resolve_path(""), NDI_RUNTIME_DEFAULT_LIBRARY) == 0);
+
+    setenv(NDI_RUNTIME_PATH_ENV, g_stub_path, 1);
+    CHECK(strcmp(ndi_runtime_resolve_path(NULL), g_stub_path) == 0);
+    CHECK(strcmp(ndi_runtime_resolve_path("explicit.so"), "explicit.so") == 0);
+
+    /* The environment override is what ndi_runtime_open uses when no path is given. */
+    NdiRuntime rt;
+    CHECK(ndi_runtime_open(&rt, NULL, NULL, 0));
+    ndi_runtime_close(&rt);
+    unsetenv(NDI_RUNTIME_PATH_ENV);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <stub library> <incomplete stub library>\n", argv[0]);
+        return 2;
+    }
+    g_stub_path = argv[1];
+    g_incomplete_stub_path = argv[2];
+
+    RUN_TEST(test_opens_stub_and_dispatches_through_table);
+    RUN_TEST(test_missing_library_reports_error);
+    RUN_TEST(test_incomplete_table_rejected);
+    RUN_TEST(test_path_resolution_order);
+    return TEST_EXIT_CODE();
+}
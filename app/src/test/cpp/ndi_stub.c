@@ -0,0 +1,228 @@
+/**
+ * ndi_stub.c - Stand-in for libndi on the host
+ *
+ * Exports NDIlib_v6_load with a function table that runs senders and receivers in loopback:
+ * a sender is found under its own name, and a receiver connected to it captures the last video
+ * frame it sent (sharing the sender's buffer, as the async send contract allows). Nothing else
+ * is ever captured, so the runtime loader and anything built on it can be exercised without
+ * the SDK. Single-threaded use only. Built a second time with NDI_STUB_INCOMPLETE, leaving
+ * recv_capture_v2 out of the table, to test the loader's table validation. Point
+ * NDI_RUNTIME_PATH at the built library to use it in place of the SDK.
+ */
+
+#include "Processing.NDI.Lib.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STUB_MAX_SENDERS 4
+
+typedef struct StubSender {
+    bool used;
+    char name[128];
+    int connections;
+    NDIlib_video_frame_v2_t video;   /* Last frame sent; p_data is the caller's buffer. */
+    uint64_t video_sequence;
+} StubSender;
+
+typedef struct StubReceiver {
+    StubSender* source;
+    uint64_t seen_sequence;
+} StubReceiver;
+
+static StubSender g_senders[STUB_MAX_SENDERS];
+static NDIlib_source_t g_sources[STUB_MAX_SENDERS];
+
+static bool stub_initialize(void) { return true; }
+static void stub_destroy(void) {}
+static const char* stub_version(void) { return "NDI stub"; }
+
+static NDIlib_find_instance_t stub_find_create_v2(const NDIlib_find_create_t* settings) {
+    (void)settings;
+    static int finder;
+    return (NDIlib_find_instance_t)&finder;
+}
+
+static void stub_find_destroy(NDIlib_find_instance_t finder) { (void)finder; }
+
+static const NDIlib_source_t* stub_find_get_current_sources(NDIlib_find_instance_t finder, uint32_t* count) {
+    (void)finder;
+    uint32_t found = 0;
+    for (int i = 0; i < STUB_MAX_SENDERS; i++) {
+        if (g_senders[i].used) {
+            memset(&g_sources[found], 0, sizeof(g_sources[found]));
+            g_sources[found].p_ndi_name = g_senders[i].name;
+            found++;
+        }
+    }
+    if (count != NULL) {
+        *count = found;
+    }
+    return found > 0 ? g_sources : NULL;
+}
+
+static bool stub_find_wait_for_sources(NDIlib_find_instance_t finder, uint32_t timeout_ms) {
+    (void)finder;
+    (void)timeout_ms;
+    return false;
+}
+
+static void stub_recv_connect(NDIlib_recv_instance_t recv, const NDIlib_source_t* source) {
+    StubReceiver* receiver = (StubReceiver*)recv;
+    if (receiver->source != NULL) {
+        receiver->source->connections--;
+        receiver->source = NULL;
+    }
+    if (source == NULL || source->p_ndi_name == NULL) {
+        return;
+    }
+    for (int i = 0; i < STUB_MAX_SENDERS; i++) {
+        if (g_senders[i].used && strcmp(g_senders[i].name, source->p_ndi_name) == 0) {
+            receiver->source = &g_senders[i];
+            receiver->seen_sequence = g_senders[i].video_sequence;
+            g_senders[i].connections++;
+            return;
+        }
+    }
+}
+
+static NDIlib_recv_instance_t stub_recv_create_v3(const NDIlib_recv_create_v3_t* settings) {
+    StubReceiver* receiver = (StubReceiver*)calloc(1, sizeof(StubReceiver));
+    if (receiver != NULL && settings != NULL) {
+        stub_recv_connect((NDIlib_recv_instance_t)receiver, &settings->source_to_connect_to);
+    }
+    return (NDIlib_recv_instance_t)receiver;
+}
+
+static void stub_recv_destroy(NDIlib_recv_instance_t recv) {
+    stub_recv_connect(recv, NULL);
+    free(recv);
+}
+
+static NDIlib_frame_type_e stub_recv_capture_v2(NDIlib_recv_instance_t recv, NDIlib_video_frame_v2_t* video,
+                                                NDIlib_audio_frame_v2_t* audio, NDIlib_metadata_frame_t* metadata,
+                                                uint32_t timeout_ms) {
+    (void)audio;
+    (void)metadata;
+    (void)timeout_ms;
+    StubReceiver* receiver = (StubReceiver*)recv;
+    StubSender* source = receiver->source;
+    if (video != NULL && source != NULL && source->video_sequence > receiver->seen_sequence) {
+        *video = source->video;
+        receiver->seen_sequence = source->video_sequence;
+        return NDIlib_frame_type_video;
+    }
+    return NDIlib_frame_type_none;
+}
+
+static void stub_recv_free_video_v2(NDIlib_recv_instance_t recv, const NDIlib_video_frame_v2_t* video) {
+    (void)recv;
+    (void)video;
+}
+
+static void stub_recv_free_audio_v2(NDIlib_recv_instance_t recv, const NDIlib_audio_frame_v2_t* audio) {
+    (void)recv;
+    (void)audio;
+}
+
+static void stub_recv_free_metadata(NDIlib_recv_instance_t recv, const NDIlib_metadata_frame_t* metadata) {
+    (void)recv;
+    (void)metadata;
+}
+
+static void stub_recv_get_performance(NDIlib_recv_instance_t recv, NDIlib_recv_performance_t* total,
+                                      NDIlib_recv_performance_t* dropped) {
+    (void)recv;
+    if (total != NULL) {
+        memset(total, 0, sizeof(*total));
+    }
+    if (dropped != NULL) {
+        memset(dropped, 0, sizeof(*dropped));
+    }
+}
+
+static void stub_recv_get_queue(NDIlib_recv_instance_t recv, NDIlib_recv_queue_t* queue) {
+    (void)recv;
+    if (queue != NULL) {
+        memset(queue, 0, sizeof(*queue));
+    }
+}
+
+static int stub_recv_get_no_connections(NDIlib_recv_instance_t recv) {
+    return ((StubReceiver*)recv)->source != NULL ? 1 : 0;
+}
+
+static NDIlib_send_instance_t stub_send_create(const NDIlib_send_create_t* settings) {
+    if (settings == NULL || settings->p_ndi_name == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < STUB_MAX_SENDERS; i++) {
+        if (!g_senders[i].used) {
+            memset(&g_senders[i], 0, sizeof(g_senders[i]));
+            g_senders[i].used = true;
+            snprintf(g_senders[i].name, sizeof(g_senders[i].name), "%s", settings->p_ndi_name);
+            return (NDIlib_send_instance_t)&g_senders[i];
+        }
+    }
+    return NULL;
+}
+
+static void stub_send_destroy(NDIlib_send_instance_t send) {
+    ((StubSender*)send)->used = false;
+}
+
+static void stub_send_send_video_async_v2(NDIlib_send_instance_t send, const NDIlib_video_frame_v2_t* video) {
+    StubSender* sender = (StubSender*)send;
+    if (video != NULL) {
+        sender->video = *video;
+        sender->video_sequence++;
+    }
+}
+
+static void stub_send_send_audio_v2(NDIlib_send_instance_t send, const NDIlib_audio_frame_v2_t* audio) {
+    (void)send;
+    (void)audio;
+}
+
+static int stub_send_get_no_connections(NDIlib_send_instance_t send, uint32_t timeout_ms) {
+    (void)timeout_ms;
+    return ((StubSender*)send)->connections;
+}
+
+PROCESSINGNDILIB_API
+const NDIlib_v6* NDIlib_v6_load(void) {
+    static NDIlib_v6 table;
+    static bool filled;
+    if (!filled) {
+        table.initialize = stub_initialize;
+        table.destroy = stub_destroy;
+        table.version = stub_version;
+        table.find_create_v2 = stub_find_create_v2;
+        table.find_destroy = stub_find_destroy;
+        table.find_get_current_sources = stub_find_get_current_sources;
+        table.find_wait_for_sources = stub_find_wait_for_sources;
+        table.recv_create_v3 = stub_recv_create_v3;
+        table.recv_destroy = stub_recv_destroy;
+        table.recv_connect = stub_recv_connect;
+#ifndef NDI_STUB_INCOMPLETE
+        table.recv_capture_v2 = stub_recv_capture_v2;
+#else
+        (void)stub_recv_capture_v2;
+#endif
+        table.recv_free_video_v2 = stub_recv_free_video_v2;
+        table.recv_free_audio_v2 = stub_recv_free_audio_v2;
+        table.recv_free_metadata = stub_recv_free_metadata;
+        table.recv_get_performance = stub_recv_get_performance;
+        table.recv_get_queue = stub_recv_get_queue;
+        table.recv_get_no_connections = stub_recv_get_no_connections;
+        table.send_create = stub_send_create;
+        table.send_destroy = stub_send_destroy;
+        table.send_send_video_async_v2 = stub_send_send_video_async_v2;
+        table.send_send_audio_v2 = stub_send_send_audio_v2;
+        table.send_get_no_connections = stub_send_get_no_connections;
+        filled = true;
+    }
+    return &table;
+}
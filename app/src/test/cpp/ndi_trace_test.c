@@ -0,0 +1,189 @@
+/**
+ * ndi_trace_test.c - Host tests for ndi_trace.c
+ *
+ * This file compiles the trace macros in whatever the build configuration; the pure modules
+ * in ndi_core only have them when configured with -DNDI_TRACE=ON, which is checked as well.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#if defined(NDI_TRACE)
+#define CORE_TRACED 1
+#else
+#define CORE_TRACED 0
+#define NDI_TRACE 1
+#endif
+
+#include "jitter_buffer.h"
+#include "ndi_trace.h"
+#include "test_util.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WORKER_THREADS 4
+#define WORKER_SECTIONS 1000
+
+/* Write the trace to a temporary file and read it back. Caller frees. */
+static char* dump(void) {
+    char path[] = "/tmp/ndi_trace_testXXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        return NULL;
+    }
+    close(fd);
+    char* json = NULL;
+    if (ndi_trace_write_json(path)) {
+        FILE* f = fopen(path, "r");
+        if (f != NULL) {
+            fseek(f, 0, SEEK_END);
+            const long size = ftell(f);
+            fseek(f, 0, SEEK_SET);
+            json = (char*)calloc(1, (size_t)size + 1);
+            if (json != NULL && fread(json, 1, (size_t)size, f) != (size_t)size) {
+                free(json);
+                json = NULL;
+            }
+            fclose(f);
+        }
+    }
+    unlink(path);
+    return json;
+}
+
+static int occurrences(const char* haystack, const char* needle) {
+    int count = 0;
+    for (const char* p = strstr(haystack, needle); p != NULL; p = strstr(p + 1, needle)) {
+        count++;
+    }
+    return count;
+}
+
+/* ============================================================================
+ * Recording
+ * ========================================================================== */
+
+static void test_sections_instants_and_counters(void) {
+    ndi_trace_reset();
+    NDI_TRACE_BEGIN("outer");
+    NDI_TRACE_BEGIN("inner");
+    NDI_TRACE_INSTANT("marker");
+    NDI_TRACE_END();
+    NDI_TRACE_COUNTER("depth", 7);
+    NDI_TRACE_END();
+    CHECK_EQ_INT(ndi_trace_event_count(), 6);
+
+    char* json = dump();
+    CHECK(json != NULL);
+    if (json == NULL) {
+        return;
+    }
+    CHECK(strncmp(json, "{\"traceEvents\":[", 16) == 0);
+    CHECK(strstr(json, "\"displayTimeUnit\":\"ms\"}") != NULL);
+    CHECK_EQ_INT(occurrences(json, "\"ph\":\"B\""), 2);
+    CHECK_EQ_INT(occurrences(json, "\"ph\":\"E\""), 2);
+    CHECK(strstr(json, "\"ph\":\"i\"") != NULL && strstr(json, "\"name\":\"marker\",\"s\":\"t\"") != NULL);
+    CHECK(strstr(json, "\"name\":\"depth\",\"args\":{\"value\":7}") != NULL);
+    /* Events are written in order: outer opens before inner. */
+    CHECK(strstr(json, "\"name\":\"outer\"") < strstr(json, "\"name\":\"inner\""));
+    free(json);
+}
+
+static void* worker(void* arg) {
+    (void)arg;
+    for (int i = 0; i < WORKER_SECTIONS; i++) {
+        NDI_TRACE_BEGIN("work");
+        NDI_TRACE_END();
+    }
+    return NULL;
+}
+
+static void test_threads_record_without_locks(void) {
+    ndi_trace_reset();
+    pthread_t threads[WORKER_THREADS];
+    for (int i = 0; i < WORKER_THREADS; i++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < WORKER_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    /* Buffers of finished threads are kept for the dump. */
+    CHECK_EQ_INT(ndi_trace_event_count(), WORKER_THREADS * WORKER_SECTIONS * 2);
+    CHECK_EQ_INT(ndi_trace_dropped_count(), 0);
+
+    char* json = dump();
+    CHECK(json != NULL);
+    if (json != NULL) {
+        CHECK_EQ_INT(occurrences(json, "\"name\":\"work\""), WORKER_THREADS * WORKER_SECTIONS);
+        free(json);
+    }
+}
+
+static void test_full_buffer_drops(void) {
+    ndi_trace_reset();
+    for (int i = 0; i < NDI_TRACE_BUFFER_EVENTS + 10; i++) {
+        NDI_TRACE_INSTANT("flood");
+    }
+    CHECK_EQ_INT(ndi_trace_event_count(), NDI_TRACE_BUFFER_EVENTS);
+    CHECK_EQ_INT(ndi_trace_dropped_count(), 10);
+    ndi_trace_reset();
+    CHECK_EQ_INT(ndi_trace_event_count(), 0);
+}
+
+static void* named_worker(void* arg) {
+    (void)arg;
+    pthread_setname_np(pthread_self(), "q\"t\\1");
+    NDI_TRACE_INSTANT("say \"hi\"\\\n");
+    return NULL;
+}
+
+static void test_names_are_escaped(void) {
+    ndi_trace_reset();
+    pthread_t thread;
+    pthread_create(&thread, NULL, named_worker, NULL);
+    pthread_join(thread, NULL);
+
+    char* json = dump();
+    CHECK(json != NULL);
+    if (json != NULL) {
+        CHECK(strstr(json, "\"name\":\"say \\\"hi\\\"\\\\\\u000a\"") != NULL);
+        CHECK(strstr(json, "\"args\":{\"name\":\"q\\\"t\\\\1\"}") != NULL);
+        free(json);
+    }
+}
+
+static void test_write_to_bad_path_fails(void) {
+    CHECK(!ndi_trace_write_json("/nonexistent/dir/trace.json"));
+}
+
+/* ============================================================================
+ * Pipeline trace points
+ * ========================================================================== */
+
+static void test_core_trace_points_follow_build_option(void) {
+    ndi_trace_reset();
+    JitterBuffer* jb = jitter_buffer_create(4);
+    int frame = 0;
+    void* discarded[JITTER_BUFFER_MAX_DISCARDS];
+    CHECK_EQ_INT(jitter_buffer_push(jb, &frame, JITTER_FRAME_INDEPENDENT, 100000, 1000000000LL, discarded), 0);
+    CHECK(jitter_buffer_pop(jb, 2000000000LL) == &frame);
+    jitter_buffer_destroy(jb);
+
+    /* Push and pop each leave an instant and a depth counter, or nothing when compiled out. */
+    CHECK_EQ_INT(ndi_trace_event_count(), CORE_TRACED ? 4 : 0);
+}
+
+int main(void) {
+    RUN_TEST(test_sections_instants_and_counters);
+    RUN_TEST(test_threads_record_without_locks);
+    RUN_TEST(test_full_buffer_drops);
+    RUN_TEST(test_names_are_escaped);
+    RUN_TEST(test_write_to_bad_path_fails);
+    RUN_TEST(test_core_trace_points_follow_build_option);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,267 @@
+/**
+ * pixel_convert_test.c - Host tests for pixel_convert.c
+ *
+ * Both kernels are checked against straightforward per-sample reference loops. The width is
+ * not a multiple of the vector block and the source stride is padded, so on ARM the NEON
+ * bodies, the scalar tails and stride handling are all exercised.
+ */
+
+#include "pixel_convert.h"
+#include "test_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define W 38
+#define SRC_STRIDE (W * 2 + 12)   /* Bytes; padded. */
+#define GUARD 16
+#define GUARD_BYTE 0x5A
+
+static const int k_bayer[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+static uint32_t g_seed = 12345;
+
+static uint16_t next_sample(void) {
+    g_seed = g_seed * 1103515245u + 12345u;
+    const uint16_t v = (uint16_t)(g_seed >> 8);
+    /* Keep the saturating range well represented. */
+    return ((g_seed >> 28) == 0) ? (uint16_t)(0xFFE0 | (v & 0x1F)) : v;
+}
+
+/* P216 frame: height luma rows, then height interleaved UV rows, SRC_STRIDE bytes each. */
+static uint8_t* make_p216(int height) {
+    uint8_t* src = (uint8_t*)malloc((size_t)SRC_STRIDE * (size_t)height * 2);
+    memset(src, 0xCC, (size_t)SRC_STRIDE * (size_t)height * 2);   /* Padding stays garbage. */
+    for (int y = 0; y < height * 2; y++) {
+        uint16_t* row = (uint16_t*)(src + (size_t)y * SRC_STRIDE);
+        for (int x = 0; x < W; x++) {
+            row[x] = next_sample();
+        }
+    }
+    return src;
+}
+
+static uint16_t sample_at(const uint8_t* src, int plane_row, int x) {
+    return ((const uint16_t*)(src + (size_t)plane_row * SRC_STRIDE))[x];
+}
+
+static uint8_t* alloc_guarded(size_t size) {
+    uint8_t* dst = (uint8_t*)malloc(size + GUARD);
+    memset(dst, GUARD_BYTE, size + GUARD);
+    return dst;
+}
+
+static bool guard_intact(const uint8_t* dst, size_t size) {
+    for (size_t i = 0; i < GUARD; i++) {
+        if (dst[size + i] != GUARD_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint16_t ref_p010(uint32_t v) {
+    v += 32;
+    if (v > 0xFFFF) {
+        v = 0xFFFF;
+    }
+    return (uint16_t)(v & 0xFFC0);
+}
+
+static uint8_t ref_dither(uint32_t v, int row, int col) {
+    v += (uint32_t)(k_bayer[row & 3][col & 3] * 16 + 8);
+    if (v > 0xFFFF) {
+        v = 0xFFFF;
+    }
+    return (uint8_t)(v >> 8);
+}
+
+/* Chroma row cy averages full-height UV rows 2cy and 2cy+1 (the last one alone if height is odd). */
+static uint32_t ref_chroma_avg(const uint8_t* src, int height, int cy, int x) {
+    const int y0 = cy * 2;
+    const int y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+    return ((uint32_t)sample_at(src, height + y0, x) + sample_at(src, height + y1, x) + 1) >> 1;
+}
+
+/* ============================================================================
+ * P216 -> P010
+ * ========================================================================== */
+
+static void check_p010_against_reference(int height) {
+    uint8_t* src = make_p216(height);
+    const size_t size = pixel_p010_size(W, height);
+    uint8_t* dst = alloc_guarded(size);
+    CHECK(pixel_p216_to_p010(src, SRC_STRIDE, W, height, dst));
+
+    const uint16_t* y_plane = (const uint16_t*)dst;
+    const uint16_t* uv_plane = y_plane + (size_t)W * height;
+    int mismatches = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < W; x++) {
+            mismatches += y_plane[y * W + x] != ref_p010(sample_at(src, y, x));
+        }
+    }
+    for (int cy = 0; cy < (height + 1) / 2; cy++) {
+        for (int x = 0; x < W; x++) {
+            mismatches += uv_plane[cy * W + x] != ref_p010(ref_chroma_avg(src, height, cy, x));
+        }
+    }
+    CHECK_EQ_INT(mismatches, 0);
+    CHECK(guard_intact(dst, size));
+    free(dst);
+    free(src);
+}
+
+static void test_p010_matches_reference(void) {
+    check_p010_against_reference(8);
+    check_p010_against_reference(7);
+    check_p010_against_reference(1);
+}
+
+static void test_p010_rounding_and_saturation(void) {
+    static const uint16_t in[8] = { 0x0000, 0x001F, 0x0020, 0x1234, 0xFFA0, 0xFFE0, 0xFFF0, 0xFFFF };
+    static const uint16_t out[8] = { 0x0000, 0x0000, 0x0040, 0x1240, 0xFFC0, 0xFFC0, 0xFFC0, 0xFFC0 };
+
+    /* 8x2 frame, luma and both chroma rows set to the same values. */
+    uint16_t src[4][8];
+    for (int r = 0; r < 4; r++) {
+        memcpy(src[r], in, sizeof(in));
+    }
+    uint16_t dst[8 * 2 + 8];
+    CHECK(pixel_p216_to_p010((const uint8_t*)src, 16, 8, 2, (uint8_t*)dst));
+    for (int i = 0; i < 8; i++) {
+        CHECK_EQ_INT(dst[i], out[i]);
+        CHECK_EQ_INT(dst[16 + i], out[i]);
+    }
+
+    /* Chroma rows are averaged with rounding before the 10-bit rounding. */
+    for (int i = 0; i < 8; i++) {
+        src[2][i] = 0xFFFF;
+        src[3][i] = 0xFFE0;
+    }
+    src[2][0] = 0x0000;
+    src[3][0] = 0x0041;   /* Average 0x0021 rounds up to 0x0040. */
+    CHECK(pixel_p216_to_p010((const uint8_t*)src, 16, 8, 2, (uint8_t*)dst));
+    CHECK_EQ_INT(dst[16], 0x0040);
+    CHECK_EQ_INT(dst[17], 0xFFC0);
+}
+
+/* ============================================================================
+ * P216 -> NV12 (ordered dither)
+ * ========================================================================== */
+
+static void check_nv12_against_reference(int height) {
+    uint8_t* src = make_p216(height);
+    const size_t size = pixel_nv12_size(W, height);
+    uint8_t* dst = alloc_guarded(size);
+    CHECK(pixel_p216_to_nv12_dithered(src, SRC_STRIDE, W, height, dst));
+
+    const uint8_t* uv_plane = dst + (size_t)W * height;
+    int mismatches = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < W; x++) {
+            mismatches += dst[y * W + x] != ref_dither(sample_at(src, y, x), y, x);
+        }
+    }
+    for (int cy = 0; cy < (height + 1) / 2; cy++) {
+        for (int x = 0; x < W; x++) {
+            mismatches += uv_plane[cy * W + x] != ref_dither(ref_chroma_avg(src, height, cy, x), cy, x / 2);
+        }
+    }
+    CHECK_EQ_INT(mismatches, 0);
+    CHECK(guard_intact(dst, size));
+    free(dst);
+    free(src);
+}
+
+static void test_nv12_matches_reference(void) {
+    check_nv12_against_reference(8);
+    check_nv12_against_reference(7);
+    check_nv12_against_reference(1);
+}
+
+static void test_nv12_bayer_cells(void) {
+    /* 127.5 in 8-bit terms: a cell rounds up exactly when its Bayer value is 8 or more. */
+    enum { CW = 16, CH = 8 };
+    static uint16_t src[CH * 2][CW];
+    for (int r = 0; r < CH * 2; r++) {
+        for (int x = 0; x < CW; x++) {
+            src[r][x] = 0x7F80;
+        }
+    }
+    uint8_t dst[CW * CH + CW * CH / 2];
+    CHECK(pixel_p216_to_nv12_dithered((const uint8_t*)src, CW * 2, CW, CH, dst));
+
+    int sum = 0;
+    for (int y = 0; y < CH; y++) {
+        for (int x = 0; x < CW; x++) {
+            CHECK_EQ_INT(dst[y * CW + x], k_bayer[y & 3][x & 3] >= 8 ? 128 : 127);
+            sum += dst[y * CW + x];
+        }
+    }
+    /* Each 4x4 cell averages to the input. */
+    CHECK_EQ_INT(sum * 2, 255 * CW * CH);
+
+    /* U and V of a chroma pair share their column's cell. */
+    const uint8_t* uv = dst + CW * CH;
+    for (int cy = 0; cy < CH / 2; cy++) {
+        for (int x = 0; x < CW; x++) {
+            CHECK_EQ_INT(uv[cy * CW + x], k_bayer[cy & 3][(x / 2) & 3] >= 8 ? 128 : 127);
+        }
+    }
+
+    /* Full scale stays at 255 instead of wrapping. */
+    for (int r = 0; r < CH * 2; r++) {
+        for (int x = 0; x < CW; x++) {
+            src[r][x] = 0xFFFF;
+        }
+    }
+    CHECK(pixel_p216_to_nv12_dithered((const uint8_t*)src, CW * 2, CW, CH, dst));
+    for (size_t i = 0; i < sizeof(dst); i++) {
+        CHECK_EQ_INT(dst[i], 255);
+    }
+}
+
+/* ============================================================================
+ * Sizes and argument checks
+ * ========================================================================== */
+
+static void test_sizes(void) {
+    CHECK_EQ_INT(pixel_p010_size(4, 5), 4 * 2 * 5 + 4 * 2 * 3);
+    CHECK_EQ_INT(pixel_nv12_size(4, 5), 4 * 5 + 4 * 3);
+    CHECK_EQ_INT(pixel_p010_size(1920, 1080), 1920 * 2 * 1080 * 3 / 2);
+    CHECK_EQ_INT(pixel_p010_size(0, 4), 0);
+    CHECK_EQ_INT(pixel_nv12_size(4, -1), 0);
+}
+
+static void test_rejects_invalid_arguments(void) {
+    uint8_t src[64 * 4] = { 0 };
+    uint8_t dst[64 * 4];
+    CHECK(pixel_p216_to_p010(src, 16, 8, 2, dst));
+    CHECK(!pixel_p216_to_p010(src, 16, 7, 2, dst));          /* Odd width. */
+    CHECK(!pixel_p216_to_p010(NULL, 16, 8, 2, dst));
+    CHECK(!pixel_p216_to_p010(src, 16, 8, 2, NULL));
+    CHECK(!pixel_p216_to_p010(src, 14, 8, 2, dst));          /* Stride shorter than a row. */
+    CHECK(!pixel_p216_to_p010(src, 17, 8, 2, dst));          /* Stride not whole samples. */
+    CHECK(!pixel_p216_to_p010(src, 16, 8, 0, dst));
+    CHECK(pixel_p216_to_nv12_dithered(src, 16, 8, 2, dst));
+    CHECK(!pixel_p216_to_nv12_dithered(src, 16, 7, 2, dst));
+    CHECK(!pixel_p216_to_nv12_dithered(NULL, 16, 8, 2, dst));
+    CHECK(!pixel_p216_to_nv12_dithered(src, 16, 8, 2, NULL));
+    CHECK(!pixel_p216_to_nv12_dithered(src, 16, 0, 2, dst));
+}
+
+int main(void) {
+    RUN_TEST(test_p010_matches_reference);
+    RUN_TEST(test_p010_rounding_and_saturation);
+    RUN_TEST(test_nv12_matches_reference);
+    RUN_TEST(test_nv12_bayer_cells);
+    RUN_TEST(test_sizes);
+    RUN_TEST(test_rejects_invalid_arguments);
+    return TEST_EXIT_CODE();
+}
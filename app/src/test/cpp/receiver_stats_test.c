@@ -0,0 +1,159 @@
+/**
+ * receiver_stats_test.c - Host tests for receiver_stats.c
+ *
+ * All windows are driven with explicit timestamps.
+ */
+
+#include "receiver_stats.h"
+#include "test_util.h"
+
+#define MS(x) ((int64_t)(x) * 1000000LL)
+
+static const int64_t kBase = 1000LL * RECEIVER_STATS_BUCKET_NS;
+
+/* ============================================================================
+ * Frame Rate, Bitrate and Jitter
+ * ========================================================================== */
+
+static void test_steady_stream(void) {
+    ReceiverStats* rs = receiver_stats_create();
+    /* 50 fps of 10 000 byte frames for one second. */
+    for (int i = 0; i <= 50; i++) {
+        receiver_stats_frame(rs, kBase + MS(20 * i), 10000);
+    }
+
+    ReceiverStatsSnapshot s;
+    receiver_stats_get(rs, kBase + MS(1000), &s);
+    CHECK_EQ_INT(s.window_ns, MS(1000));
+    CHECK_EQ_INT(s.video_frames, 51);
+    CHECK_EQ_INT(s.interval_avg_ns, MS(20));
+    CHECK_EQ_INT(s.interval_max_ns, MS(20));
+    CHECK_EQ_INT(s.jitter_ns, 0);
+    CHECK(s.fps > 49.99 && s.fps < 50.01);
+    CHECK_EQ_INT(s.bitrate_bps, 51LL * 10000 * 8);
+    receiver_stats_destroy(rs);
+}
+
+static void test_jitter_is_interval_stddev(void) {
+    ReceiverStats* rs = receiver_stats_create();
+    /* Intervals alternate 10 ms and 30 ms: mean 20 ms, standard deviation 10 ms. */
+    int64_t t = kBase;
+    for (int i = 0; i < 20; i++) {
+        receiver_stats_frame(rs, t, 1000);
+        t += (i % 2 == 0) ? MS(10) : MS(30);
+    }
+    receiver_stats_frame(rs, t, 1000);
+
+    ReceiverStatsSnapshot s;
+    receiver_stats_get(rs, t, &s);
+    CHECK_EQ_INT(s.interval_avg_ns, MS(20));
+    CHECK_EQ_INT(s.interval_max_ns, MS(30));
+    CHECK_EQ_INT(s.jitter_ns, MS(10));
+    receiver_stats_destroy(rs);
+}
+
+static void test_old_buckets_expire(void) {
+    ReceiverStats* rs = receiver_stats_create();
+    /* A burst at the start, then one frame much later. */
+    for (int i = 0; i < 10; i++) {
+        receiver_stats_frame(rs, kBase + MS(i), 5000);
+    }
+    receiver_stats_frame(rs, kBase + MS(5000), 5000);
+
+    ReceiverStatsSnapshot s;
+    receiver_stats_get(rs, kBase + MS(5100), &s);
+    CHECK_EQ_INT(s.window_ns, RECEIVER_STATS_WINDOW_NS - MS(150));
+    CHECK_EQ_INT(s.video_frames, 1);
+    CHECK_EQ_INT(s.video_bytes, 5000);
+    /* The gap before the late frame is still an interval of the window. */
+    CHECK_EQ_INT(s.interval_max_ns, MS(4991));
+
+    receiver_stats_get(rs, kBase + MS(9000), &s);
+    CHECK_EQ_INT(s.video_frames, 0);
+    CHECK_EQ_INT(s.bitrate_bps, 0);
+    CHECK(s.fps == 0.0);
+    receiver_stats_destroy(rs);
+}
+
+/* ============================================================================
+ * Capture Calls, Queue Depths and Connections
+ * ========================================================================== */
+
+static void test_capture_calls(void) {
+    ReceiverStats* rs = receiver_stats_create();
+    receiver_stats_capture_call(rs, MS(2), kBase + MS(10));
+    receiver_stats_capture_call(rs, MS(6), kBase + MS(30));
+    receiver_stats_capture_call(rs, -5, kBase + MS(50));
+
+    ReceiverStatsSnapshot s;
+    receiver_stats_get(rs, kBase + MS(100), &s);
+    CHECK_EQ_INT(s.capture_calls, 3);
+    CHECK_EQ_INT(s.capture_avg_ns, MS(8) / 3);
+    CHECK_EQ_INT(s.capture_max_ns, MS(6));
+    receiver_stats_destroy(rs);
+}
+
+static void test_queue_depths(void) {
+    ReceiverStats* rs = receiver_stats_create();
+    receiver_stats_queue(rs, 1, 4, 0, kBase + MS(10));
+    receiver_stats_queue(rs, 3, 2, 1, kBase + MS(300));
+    receiver_stats_queue(rs, 2, 0, 0, kBase + MS(600));
+
+    ReceiverStatsSnapshot s;
+    receiver_stats_get(rs, kBase + MS(700), &s);
+    CHECK(s.queue_video_avg > 1.99 && s.queue_video_avg < 2.01);
+    CHECK_EQ_INT(s.queue_video_max, 3);
+    CHECK_EQ_INT(s.queue_audio_max, 4);
+    CHECK_EQ_INT(s.queue_metadata_max, 1);
+    CHECK_EQ_INT(s.queue_video, 2);
+    CHECK_EQ_INT(s.queue_audio, 0);
+    receiver_stats_destroy(rs);
+}
+
+static void test_connection_range(void) {
+    ReceiverStats* rs = receiver_stats_create();
+    receiver_stats_connections(rs, 1, kBase + MS(10));
+    receiver_stats_connections(rs, 0, kBase + MS(400));
+    receiver_stats_connections(rs, 2, kBase + MS(800));
+    receiver_stats_connections(rs, 1, kBase + MS(900));
+
+    ReceiverStatsSnapshot s;
+    receiver_stats_get(rs, kBase + MS(1000), &s);
+    CHECK_EQ_INT(s.connections, 1);
+    CHECK_EQ_INT(s.connections_min, 0);
+    CHECK_EQ_INT(s.connections_max, 2);
+    receiver_stats_destroy(rs);
+}
+
+static void test_reset(void) {
+    ReceiverStats* rs = receiver_stats_create();
+    receiver_stats_frame(rs, kBase + MS(10), 1000);
+    receiver_stats_queue(rs, 5, 0, 0, kBase + MS(10));
+    receiver_stats_connections(rs, 1, kBase + MS(10));
+    receiver_stats_reset(rs);
+
+    ReceiverStatsSnapshot s;
+    receiver_stats_get(rs, kBase + MS(20), &s);
+    CHECK_EQ_INT(s.window_ns, 0);
+    CHECK_EQ_INT(s.video_frames, 0);
+    CHECK_EQ_INT(s.queue_video, 0);
+    CHECK_EQ_INT(s.connections, 0);
+
+    /* The first frame after a reset has no interval to the frames before it. */
+    receiver_stats_frame(rs, kBase + MS(30), 1000);
+    receiver_stats_get(rs, kBase + MS(40), &s);
+    CHECK_EQ_INT(s.video_frames, 1);
+    CHECK_EQ_INT(s.interval_max_ns, 0);
+    receiver_stats_destroy(rs);
+}
+
+int main(void) {
+    RUN_TEST(test_steady_stream);
+    RUN_TEST(test_jitter_is_interval_stddev);
+    RUN_TEST(test_old_buckets_expire);
+    RUN_TEST(test_capture_calls);
+    RUN_TEST(test_queue_depths);
+    RUN_TEST(test_connection_range);
+    RUN_TEST(test_reset);
+    return TEST_EXIT_CODE();
+}
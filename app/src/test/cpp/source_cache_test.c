@@ -0,0 +1,148 @@
+/**
+ * source_cache_test.c - Host tests for source_cache.c
+ */
+
+#include "source_cache.h"
+#include "test_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char g_path[64];
+
+static void fresh_path(void) {
+    snprintf(g_path, sizeof(g_path), "/tmp/source_cache_test_%d.bin", (int)getpid());
+    unlink(g_path);
+}
+
+static void test_survives_reopen(void) {
+    fresh_path();
+    SourceCache* cache = source_cache_open(g_path);
+    CHECK(cache != NULL);
+    CHECK(source_cache_seen(cache, "A (Cam 1)", "10.0.0.1:5961", 1000));
+    CHECK(source_cache_seen(cache, "B (Cam 2)", NULL, 1000));
+    CHECK(source_cache_connected(cache, "B (Cam 2)", 2000));
+    source_cache_close(cache);
+
+    cache = source_cache_open(g_path);
+    char url[SOURCE_CACHE_URL_MAX];
+    CHECK(source_cache_url(cache, "A (Cam 1)", url, sizeof(url)));
+    CHECK(strcmp(url, "10.0.0.1:5961") == 0);
+    CHECK(!source_cache_url(cache, "B (Cam 2)", url, sizeof(url)));
+    CHECK(!source_cache_url(cache, "C (Cam 3)", url, sizeof(url)));
+
+    SourceCacheEntry entries[4];
+    CHECK_EQ_INT(source_cache_entries(cache, entries, 4), 2);
+    CHECK(strcmp(entries[0].name, "B (Cam 2)") == 0);
+    CHECK_EQ_INT(entries[0].last_success_ms, 2000);
+    CHECK(strcmp(entries[1].name, "A (Cam 1)") == 0);
+    CHECK_EQ_INT(entries[1].last_success_ms, 0);
+    CHECK_EQ_INT(entries[1].last_seen_ms, 1000);
+    source_cache_close(cache);
+    unlink(g_path);
+}
+
+static void test_url_updates_and_failures(void) {
+    fresh_path();
+    SourceCache* cache = source_cache_open(g_path);
+    char url[SOURCE_CACHE_URL_MAX];
+    source_cache_seen(cache, "A (Cam 1)", "10.0.0.1:5961", 1);
+
+    /* Seen without a URL keeps the known one; a new URL replaces it. */
+    source_cache_seen(cache, "A (Cam 1)", "", 2);
+    CHECK(source_cache_url(cache, "A (Cam 1)", url, sizeof(url)));
+    CHECK(strcmp(url, "10.0.0.1:5961") == 0);
+    source_cache_seen(cache, "A (Cam 1)", "10.0.0.7:5961", 3);
+
+    /* A failure of the old URL does not drop the new one. */
+    source_cache_url_failed(cache, "A (Cam 1)", "10.0.0.1:5961");
+    CHECK(source_cache_url(cache, "A (Cam 1)", url, sizeof(url)));
+    CHECK(strcmp(url, "10.0.0.7:5961") == 0);
+    source_cache_url_failed(cache, "A (Cam 1)", "10.0.0.7:5961");
+    CHECK(!source_cache_url(cache, "A (Cam 1)", url, sizeof(url)));
+
+    /* Too long to store whole: stored as unknown. */
+    char long_url[SOURCE_CACHE_URL_MAX + 8];
+    memset(long_url, '1', sizeof(long_url) - 1);
+    long_url[sizeof(long_url) - 1] = '\0';
+    source_cache_seen(cache, "A (Cam 1)", long_url, 4);
+    CHECK(!source_cache_url(cache, "A (Cam 1)", url, sizeof(url)));
+
+    char long_name[SOURCE_CACHE_NAME_MAX + 1];
+    memset(long_name, 'x', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    CHECK(!source_cache_seen(cache, long_name, NULL, 5));
+    CHECK(!source_cache_connected(cache, long_name, 5));
+    source_cache_close(cache);
+    unlink(g_path);
+}
+
+static void test_eviction_keeps_connected_sources(void) {
+    fresh_path();
+    SourceCache* cache = source_cache_open(g_path);
+    char name[32];
+    for (int i = 0; i < SOURCE_CACHE_CAPACITY; i++) {
+        snprintf(name, sizeof(name), "HOST%02d (Out)", i);
+        CHECK(source_cache_seen(cache, name, "", 100 + i));
+        CHECK(source_cache_connected(cache, name, 1000 + i));
+    }
+
+    /* Full of connected sources: discovery cannot displace them. */
+    CHECK(!source_cache_seen(cache, "NEW (Out)", "10.0.0.9:5961", 5000));
+
+    /* A connection can, and evicts the one connected to longest ago. */
+    CHECK(source_cache_connected(cache, "NEW (Out)", 5000));
+    SourceCacheEntry entries[SOURCE_CACHE_CAPACITY];
+    CHECK_EQ_INT(source_cache_entries(cache, entries, SOURCE_CACHE_CAPACITY), SOURCE_CACHE_CAPACITY);
+    CHECK(strcmp(entries[0].name, "NEW (Out)") == 0);
+    CHECK(strcmp(entries[SOURCE_CACHE_CAPACITY - 1].name, "HOST01 (Out)") == 0);
+
+    /* A short output keeps the newest. */
+    CHECK_EQ_INT(source_cache_entries(cache, entries, 2), 2);
+    CHECK(strcmp(entries[1].name, "HOST63 (Out)") == 0);
+    source_cache_close(cache);
+    unlink(g_path);
+}
+
+static void test_corrupt_records_are_dropped(void) {
+    fresh_path();
+    SourceCache* cache = source_cache_open(g_path);
+    source_cache_seen(cache, "A (Cam 1)", "10.0.0.1:5961", 1);
+    source_cache_seen(cache, "B (Cam 2)", "10.0.0.2:5961", 2);
+    source_cache_close(cache);
+
+    /* Flip a byte of the first record's URL, as a torn store would leave it. */
+    FILE* f = fopen(g_path, "r+b");
+    CHECK(f != NULL);
+    fseek(f, 64 + 24 + SOURCE_CACHE_NAME_MAX, SEEK_SET);
+    fputc('9', f);
+    fclose(f);
+
+    cache = source_cache_open(g_path);
+    SourceCacheEntry entries[4];
+    CHECK_EQ_INT(source_cache_entries(cache, entries, 4), 1);
+    CHECK(strcmp(entries[0].name, "B (Cam 2)") == 0);
+    source_cache_close(cache);
+
+    /* A file of the wrong size is started over. */
+    f = fopen(g_path, "wb");
+    fputs("not a cache", f);
+    fclose(f);
+    cache = source_cache_open(g_path);
+    CHECK(cache != NULL);
+    CHECK_EQ_INT(source_cache_entries(cache, entries, 4), 0);
+    source_cache_close(cache);
+
+    CHECK(source_cache_open("/nonexistent/dir/cache.bin") == NULL);
+    unlink(g_path);
+}
+
+int main(void) {
+    RUN_TEST(test_survives_reopen);
+    RUN_TEST(test_url_updates_and_failures);
+    RUN_TEST(test_eviction_keeps_connected_sources);
+    RUN_TEST(test_corrupt_records_are_dropped);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,117 @@
+/**
+ * source_list_test.c - Host tests for source_list.c
+ */
+
+#include "source_list.h"
+#include "test_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool change_is(const SourceChange* c, SourceChangeKind kind, const char* name, const char* url) {
+    return c->kind == kind && strcmp(c->source.name, name) == 0 && strcmp(c->source.url, url) == 0;
+}
+
+static void test_first_update_adds_everything_sorted(void) {
+    SourceList* list = source_list_create();
+    const SourceInfo sources[] = {
+        { "B (Cam 2)", "10.0.0.2:5961" },
+        { "A (Cam 1)", NULL },
+        { "", "10.0.0.9:5961" },
+        { NULL, NULL },
+    };
+    const SourceChange* changes;
+    CHECK_EQ_INT(source_list_update(list, sources, 4, &changes), 2);
+    CHECK(change_is(&changes[0], SOURCE_ADDED, "A (Cam 1)", ""));
+    CHECK(change_is(&changes[1], SOURCE_ADDED, "B (Cam 2)", "10.0.0.2:5961"));
+    CHECK_EQ_INT(source_list_count(list), 2);
+    CHECK(strcmp(source_list_get(list, 1)->name, "B (Cam 2)") == 0);
+    CHECK(source_list_get(list, 2) == NULL);
+
+    /* Entries are copies: the caller's strings can go away. */
+    CHECK(source_list_get(list, 1)->name != sources[0].name);
+    source_list_destroy(list);
+}
+
+static void test_only_differences_are_reported(void) {
+    SourceList* list = source_list_create();
+    const SourceChange* changes;
+    const SourceInfo before[] = {
+        { "A (Cam 1)", "10.0.0.1:5961" },
+        { "B (Cam 2)", "10.0.0.2:5961" },
+        { "C (Cam 3)", "10.0.0.3:5961" },
+    };
+    source_list_update(list, before, 3, &changes);
+    const char* kept = source_list_find(list, "C (Cam 3)")->name;
+
+    /* Same sources in another order: nothing to report. */
+    const SourceInfo shuffled[] = { before[2], before[0], before[1] };
+    CHECK_EQ_INT(source_list_update(list, shuffled, 3, &changes), 0);
+
+    const SourceInfo after[] = {
+        { "D (Cam 4)", "10.0.0.4:5961" },
+        { "C (Cam 3)", "10.0.0.3:5961" },
+        { "B (Cam 2)", "10.0.0.22:5961" },
+    };
+    CHECK_EQ_INT(source_list_update(list, after, 3, &changes), 3);
+    CHECK(change_is(&changes[0], SOURCE_REMOVED, "A (Cam 1)", "10.0.0.1:5961"));
+    CHECK(change_is(&changes[1], SOURCE_CHANGED, "B (Cam 2)", "10.0.0.22:5961"));
+    CHECK(change_is(&changes[2], SOURCE_ADDED, "D (Cam 4)", "10.0.0.4:5961"));
+
+    /* An unchanged source keeps its storage. */
+    CHECK(source_list_find(list, "C (Cam 3)")->name == kept);
+    CHECK(source_list_find(list, "A (Cam 1)") == NULL);
+
+    CHECK_EQ_INT(source_list_update(list, NULL, 0, &changes), 3);
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ_INT(changes[i].kind, SOURCE_REMOVED);
+    }
+    CHECK_EQ_INT(source_list_count(list), 0);
+    source_list_destroy(list);
+}
+
+static void test_repeated_names_count_once(void) {
+    SourceList* list = source_list_create();
+    const SourceChange* changes;
+    const SourceInfo sources[] = {
+        { "A (Cam 1)", "10.0.0.1:5961" },
+        { "A (Cam 1)", "10.0.0.1:5961" },
+        { "B (Cam 2)", "" },
+    };
+    CHECK_EQ_INT(source_list_update(list, sources, 3, &changes), 2);
+    CHECK_EQ_INT(source_list_count(list), 2);
+    CHECK_EQ_INT(source_list_update(list, sources, 3, &changes), 0);
+    source_list_destroy(list);
+}
+
+static void test_large_list(void) {
+    enum { N = 500 };
+    static char names[N][32];
+    static SourceInfo sources[N];
+    for (int i = 0; i < N; i++) {
+        snprintf(names[i], sizeof(names[i]), "HOST%03d (Output)", (i * 7) % N);
+        sources[i] = (SourceInfo){ names[i], "" };
+    }
+    SourceList* list = source_list_create();
+    const SourceChange* changes;
+    CHECK_EQ_INT(source_list_update(list, sources, N, &changes), N);
+
+    /* Drop one from the middle. */
+    sources[123] = sources[N - 1];
+    CHECK_EQ_INT(source_list_update(list, sources, N - 1, &changes), 1);
+    CHECK_EQ_INT(changes[0].kind, SOURCE_REMOVED);
+    CHECK(source_list_find(list, changes[0].source.name) == NULL);
+    for (int i = 1; i < source_list_count(list); i++) {
+        CHECK(strcmp(source_list_get(list, i - 1)->name, source_list_get(list, i)->name) < 0);
+    }
+    source_list_destroy(list);
+}
+
+int main(void) {
+    RUN_TEST(test_first_update_adds_everything_sorted);
+    RUN_TEST(test_only_differences_are_reported);
+    RUN_TEST(test_repeated_names_count_once);
+    RUN_TEST(test_large_list);
+    return TEST_EXIT_CODE();
+}
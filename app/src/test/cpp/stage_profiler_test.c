@@ -0,0 +1,249 @@
+/**
+ * stage_profiler_test.c - Host tests for stage_profiler.c
+ *
+ * Stage windows are driven with explicit timestamps. Thread sampling runs against a fake
+ * task directory for parsing, and against this process's own /proc entry with a spinning
+ * thread for the real thing.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "stage_profiler.h"
+#include "test_util.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MS(x) ((int64_t)(x) * 1000000LL)
+
+static const int64_t kBase = 1000LL * STAGE_PROFILER_BUCKET_NS;
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+/* ============================================================================
+ * Stage Window Tests
+ * ========================================================================== */
+
+static void test_aggregates_within_window(void) {
+    StageProfiler* sp = stage_profiler_create();
+    stage_profiler_record(sp, PIPELINE_STAGE_CONVERT, MS(4), MS(3), kBase + MS(10));
+    stage_profiler_record(sp, PIPELINE_STAGE_CONVERT, MS(6), MS(5), kBase + MS(300));
+    stage_profiler_record(sp, PIPELINE_STAGE_MUX, MS(1), MS(1), kBase + MS(400));
+
+    StageProfilerStats stats;
+    stage_profiler_get_stats(sp, kBase + MS(500), &stats);
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_CONVERT].count, 2);
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_CONVERT].wall_total_ns, MS(10));
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_CONVERT].wall_max_ns, MS(6));
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_CONVERT].cpu_total_ns, MS(8));
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_MUX].count, 1);
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_CAPTURE].count, 0);
+    /* Only 494 ms of history so far: from the start of the first recorded execution. */
+    CHECK_EQ_INT(stats.window_ns, MS(494));
+    stage_profiler_destroy(sp);
+}
+
+static void test_old_buckets_expire(void) {
+    StageProfiler* sp = stage_profiler_create();
+    for (int i = 0; i < 40; i++) {
+        /* One 2 ms render every 100 ms for 4 s. */
+        stage_profiler_record(sp, PIPELINE_STAGE_RENDER, MS(2), MS(1), kBase + MS(100) * i);
+    }
+
+    StageProfilerStats stats;
+    const int64_t now = kBase + MS(3950);
+    stage_profiler_get_stats(sp, now, &stats);
+    /* Window: the 7 full buckets before the current one, plus 200 ms of it. */
+    CHECK_EQ_INT(stats.window_ns, STAGE_PROFILER_WINDOW_NS - MS(50));
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_RENDER].count, 20);
+
+    /* Long after the last record, nothing is left. */
+    stage_profiler_get_stats(sp, now + STAGE_PROFILER_WINDOW_NS, &stats);
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_RENDER].count, 0);
+
+    /* A bucket slot reused by a later epoch starts from zero. */
+    stage_profiler_record(sp, PIPELINE_STAGE_RENDER, MS(7), MS(7), now + STAGE_PROFILER_WINDOW_NS);
+    stage_profiler_get_stats(sp, now + STAGE_PROFILER_WINDOW_NS, &stats);
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_RENDER].count, 1);
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_RENDER].wall_max_ns, MS(7));
+    stage_profiler_destroy(sp);
+}
+
+static void test_reset_and_bad_stage(void) {
+    StageProfiler* sp = stage_profiler_create();
+    stage_profiler_record(sp, PIPELINE_STAGE_COUNT, MS(1), MS(1), kBase);
+    stage_profiler_record(sp, (PipelineStage)-1, MS(1), MS(1), kBase);
+    stage_profiler_record(sp, PIPELINE_STAGE_CAPTURE, MS(1), MS(1), kBase);
+
+    StageProfilerStats stats;
+    stage_profiler_get_stats(sp, kBase + MS(1), &stats);
+    uint64_t total = 0;
+    for (int s = 0; s < PIPELINE_STAGE_COUNT; s++) {
+        total += stats.stages[s].count;
+    }
+    CHECK_EQ_INT(total, 1);
+
+    stage_profiler_reset(sp);
+    stage_profiler_get_stats(sp, kBase + MS(2), &stats);
+    CHECK_EQ_INT(stats.stages[PIPELINE_STAGE_CAPTURE].count, 0);
+    CHECK_EQ_INT(stats.window_ns, 0);
+    stage_profiler_destroy(sp);
+}
+
+static void test_marks_measure_this_thread(void) {
+    StageProfiler* sp = stage_profiler_create();
+    StageMark mark;
+
+    /* Sleeping costs wall time but no CPU. */
+    stage_mark_begin(&mark);
+    usleep(20000);
+    stage_mark_end(sp, PIPELINE_STAGE_DECODE_SUBMIT, &mark);
+
+    /* Spinning costs both. */
+    stage_mark_begin(&mark);
+    const int64_t until = monotonic_ns() + MS(20);
+    volatile uint64_t sink = 0;
+    while (monotonic_ns() < until) {
+        sink++;
+    }
+    stage_mark_end(sp, PIPELINE_STAGE_CONVERT, &mark);
+
+    StageProfilerStats stats;
+    stage_profiler_get_stats(sp, monotonic_ns(), &stats);
+    const StageWindowStats* sleep = &stats.stages[PIPELINE_STAGE_DECODE_SUBMIT];
+    const StageWindowStats* spin = &stats.stages[PIPELINE_STAGE_CONVERT];
+    CHECK_EQ_INT(sleep->count, 1);
+    CHECK(sleep->wall_total_ns >= MS(20));
+    CHECK(sleep->cpu_total_ns < MS(5));
+    CHECK_EQ_INT(spin->count, 1);
+    CHECK(spin->wall_total_ns >= MS(20));
+    CHECK(spin->cpu_total_ns > MS(10));
+    CHECK(stats.window_ns >= MS(40));
+    stage_profiler_destroy(sp);
+}
+
+/* ============================================================================
+ * Thread Sampling Tests
+ * ========================================================================== */
+
+static void write_stat(const char* root, int tid, const char* comm, long utime, long stime) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%d", root, tid);
+    mkdir(path, 0700);
+    snprintf(path, sizeof(path), "%s/%d/stat", root, tid);
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        return;
+    }
+    fprintf(f, "%d (%s) S 1 1 0 0 -1 4194368 100 0 0 0 %ld %ld 0 0 20 0 12 0 1000 0 0\n", tid, comm, utime, stime);
+    fclose(f);
+}
+
+static void test_samples_fake_task_dir(void) {
+    char root[] = "/tmp/ndi_sp_XXXXXX";
+    CHECK(mkdtemp(root) != NULL);
+    const int64_t tick = 1000000000LL / sysconf(_SC_CLK_TCK);
+
+    write_stat(root, 101, "NDI-Receive-Thread", 10, 5);
+    write_stat(root, 102, "Decoder) (Input", 3, 0);  /* Parentheses in the name. */
+    write_stat(root, 103, "idle", 0, 0);
+
+    StageProfiler* sp = stage_profiler_create();
+    ThreadCpuUsage out[8];
+    int64_t interval;
+    CHECK_EQ_INT(stage_profiler_sample_threads(sp, root, kBase, out, 8, &interval), 3);
+    CHECK_EQ_INT(interval, 0);
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ_INT(out[i].cpu_ns, 0);  /* No baseline yet. */
+    }
+    /* Ties are ordered by lifetime CPU. */
+    CHECK_EQ_INT(out[0].tid, 101);
+    CHECK_EQ_INT(out[0].total_cpu_ns, 15 * tick);
+
+    write_stat(root, 101, "NDI-Receive-Thread", 12, 6);
+    write_stat(root, 102, "Decoder) (Input", 20, 4);
+    write_stat(root, 104, "new", 50, 0);
+    char path[256];
+    snprintf(path, sizeof(path), "%s/103/stat", root);
+    unlink(path);
+
+    CHECK_EQ_INT(stage_profiler_sample_threads(sp, root, kBase + MS(1000), out, 8, &interval), 3);
+    CHECK_EQ_INT(interval, MS(1000));
+    CHECK_EQ_INT(out[0].tid, 102);
+    CHECK(strcmp(out[0].name, "Decoder) (Input") == 0);
+    CHECK_EQ_INT(out[0].cpu_ns, 21 * tick);
+    CHECK_EQ_INT(out[1].tid, 101);
+    CHECK_EQ_INT(out[1].cpu_ns, 3 * tick);
+    CHECK_EQ_INT(out[2].tid, 104);
+    CHECK_EQ_INT(out[2].cpu_ns, 0);
+
+    /* max limits the output to the busiest. */
+    CHECK_EQ_INT(stage_profiler_sample_threads(sp, root, kBase + MS(2000), out, 1, &interval), 1);
+
+    stage_profiler_destroy(sp);
+    char cmd[64];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", root);
+    CHECK(system(cmd) == 0);
+
+    /* A missing directory reports nothing. */
+    sp = stage_profiler_create();
+    CHECK_EQ_INT(stage_profiler_sample_threads(sp, "/nonexistent/ndi/task", kBase, out, 8, &interval), 0);
+    stage_profiler_destroy(sp);
+}
+
+static volatile int g_stop_spin = 0;
+
+static void* spin_main(void* arg) {
+    (void)arg;
+    volatile uint64_t sink = 0;
+    while (!g_stop_spin) {
+        sink++;
+    }
+    return NULL;
+}
+
+static void test_samples_own_threads(void) {
+    StageProfiler* sp = stage_profiler_create();
+    ThreadCpuUsage out[STAGE_PROFILER_MAX_THREADS];
+    int64_t interval;
+
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, spin_main, NULL) == 0);
+    pthread_setname_np(thread, "spinner");
+    usleep(10000);
+    CHECK(stage_profiler_sample_threads(sp, STAGE_PROFILER_TASK_DIR, monotonic_ns(), out, STAGE_PROFILER_MAX_THREADS, &interval) >= 2);
+
+    usleep(300000);
+    const int count = stage_profiler_sample_threads(sp, STAGE_PROFILER_TASK_DIR, monotonic_ns(), out,
+                                                    STAGE_PROFILER_MAX_THREADS, &interval);
+    g_stop_spin = 1;
+    pthread_join(thread, NULL);
+
+    CHECK(count >= 2);
+    CHECK(interval >= MS(300));
+    /* The spinner had the CPU to itself while the main thread slept. */
+    CHECK(strcmp(out[0].name, "spinner") == 0);
+    CHECK(out[0].cpu_ns >= MS(150));
+    stage_profiler_destroy(sp);
+}
+
+int main(void) {
+    RUN_TEST(test_aggregates_within_window);
+    RUN_TEST(test_old_buckets_expire);
+    RUN_TEST(test_reset_and_bad_stage);
+    RUN_TEST(test_marks_measure_this_thread);
+    RUN_TEST(test_samples_fake_task_dir);
+    RUN_TEST(test_samples_own_threads);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,40 @@
+/**
+ * test_util.h - Minimal assertion helpers for the host unit tests
+ */
+
+#ifndef NDI_TEST_UTIL_H
+#define NDI_TEST_UTIL_H
+
+#include <stdio.h>
+
+static int g_test_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_test_failures++;                                                   \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ_INT(actual, expected)                                           \
+    do {                                                                         \
+        const long long a_ = (long long)(actual);                                \
+        const long long e_ = (long long)(expected);                              \
+        if (a_ != e_) {                                                          \
+            fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n",                \
+                    __FILE__, __LINE__, #actual, a_, e_);                        \
+            g_test_failures++;                                                   \
+        }                                                                        \
+    } while (0)
+
+#define RUN_TEST(fn)                                                             \
+    do {                                                                         \
+        const int before_ = g_test_failures;                                     \
+        fn();                                                                    \
+        printf("%s %s\n", (g_test_failures == before_) ? "PASS" : "FAIL", #fn);  \
+    } while (0)
+
+#define TEST_EXIT_CODE() ((g_test_failures == 0) ? 0 : 1)
+
+#endif /* NDI_TEST_UTIL_H */
@@ -0,0 +1,303 @@
+/**
+ * thread_placement_test.c - Host tests for thread_placement.c
+ *
+ * Topology detection runs against fake sysfs trees in a temporary directory. Placement runs on
+ * real threads of this process, restricted to CPUs the host allows and to nice increases, so
+ * it needs no privileges and passes on single-CPU machines.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "thread_placement.h"
+#include "test_util.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char g_root[64];
+
+static void write_file(const char* path, long value) {
+    FILE* f = fopen(path, "w");
+    if (f != NULL) {
+        fprintf(f, "%ld\n", value);
+        fclose(f);
+    }
+}
+
+/* Build <root>/cpuN with whichever of cpu_capacity and cpuinfo_max_freq are given. */
+static void make_sysfs(const long* capacity, const long* max_freq, int count) {
+    char path[256];
+    snprintf(g_root, sizeof(g_root), "/tmp/ndi_tp_XXXXXX");
+    if (mkdtemp(g_root) == NULL) {
+        g_root[0] = '\0';
+        return;
+    }
+    for (int cpu = 0; cpu < count; cpu++) {
+        snprintf(path, sizeof(path), "%s/cpu%d", g_root, cpu);
+        mkdir(path, 0700);
+        if (capacity != NULL) {
+            snprintf(path, sizeof(path), "%s/cpu%d/cpu_capacity", g_root, cpu);
+            write_file(path, capacity[cpu]);
+        }
+        if (max_freq != NULL) {
+            snprintf(path, sizeof(path), "%s/cpu%d/cpufreq", g_root, cpu);
+            mkdir(path, 0700);
+            snprintf(path, sizeof(path), "%s/cpu%d/cpufreq/cpuinfo_max_freq", g_root, cpu);
+            write_file(path, max_freq[cpu]);
+        }
+    }
+}
+
+static void remove_sysfs(void) {
+    char cmd[128];
+    if (g_root[0] != '\0') {
+        snprintf(cmd, sizeof(cmd), "rm -rf %s", g_root);
+        if (system(cmd) != 0) {
+            fprintf(stderr, "could not remove %s\n", g_root);
+        }
+    }
+}
+
+/* 4x A53 (capacity 485) followed by 4x A72 (1024), as on the RK3576. */
+static const CpuTopology kBigLittle = {
+    .cpu_count = 8, .all_mask = 0xFF, .big_mask = 0xF0, .little_mask = 0x0F,
+};
+
+/* ============================================================================
+ * Topology Tests
+ * ========================================================================== */
+
+static void test_detects_big_little_from_capacity(void) {
+    const long capacity[8] = { 485, 485, 485, 485, 1024, 1024, 1024, 1024 };
+    make_sysfs(capacity, NULL, 8);
+
+    CpuTopology t;
+    CHECK(cpu_topology_detect(g_root, &t));
+    CHECK_EQ_INT(t.cpu_count, 8);
+    CHECK_EQ_INT(t.all_mask, 0xFF);
+    CHECK_EQ_INT(t.big_mask, 0xF0);
+    CHECK_EQ_INT(t.little_mask, 0x0F);
+    remove_sysfs();
+}
+
+static void test_falls_back_to_max_freq(void) {
+    const long freq[4] = { 2208000, 2208000, 1416000, 1416000 };
+    make_sysfs(NULL, freq, 4);
+
+    CpuTopology t;
+    CHECK(cpu_topology_detect(g_root, &t));
+    CHECK_EQ_INT(t.cpu_count, 4);
+    CHECK_EQ_INT(t.big_mask, 0x3);
+    CHECK_EQ_INT(t.little_mask, 0xC);
+    remove_sysfs();
+}
+
+static void test_homogeneous_and_missing(void) {
+    const long capacity[4] = { 1024, 1024, 1024, 1024 };
+    make_sysfs(capacity, NULL, 4);
+
+    CpuTopology t;
+    CHECK(cpu_topology_detect(g_root, &t));
+    CHECK_EQ_INT(t.big_mask, 0xF);
+    CHECK_EQ_INT(t.little_mask, 0xF);
+    remove_sysfs();
+
+    /* No capacity information at all: treated as homogeneous. */
+    make_sysfs(NULL, NULL, 2);
+    CHECK(cpu_topology_detect(g_root, &t));
+    CHECK_EQ_INT(t.big_mask, 0x3);
+    CHECK_EQ_INT(t.little_mask, 0x3);
+    remove_sysfs();
+
+    CHECK(!cpu_topology_detect("/nonexistent/ndi/cpu", &t));
+}
+
+/* ============================================================================
+ * Core Map Tests
+ * ========================================================================== */
+
+static void test_default_config(void) {
+    ThreadPlacementConfig c;
+    thread_placement_default_config(&kBigLittle, &c);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_RECEIVE].cpu_mask, 0xF0);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_RECEIVE].nice, -10);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_DECODER_OUTPUT].cpu_mask, 0xF0);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_RECORDER].cpu_mask, 0xFF);
+    CHECK(c.roles[THREAD_ROLE_PACER].set_nice);
+}
+
+static void test_parse_core_map(void) {
+    ThreadPlacementConfig c;
+    thread_placement_default_config(&kBigLittle, &c);
+
+    CHECK(thread_placement_parse("receive=4-5,7@-12; recorder=little;decoder_input=any@5;", &kBigLittle, &c));
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_RECEIVE].cpu_mask, 0xB0);
+    CHECK(c.roles[THREAD_ROLE_RECEIVE].set_nice);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_RECEIVE].nice, -12);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_RECORDER].cpu_mask, 0x0F);
+    CHECK(!c.roles[THREAD_ROLE_RECORDER].set_nice);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_DECODER_INPUT].cpu_mask, 0);
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_DECODER_INPUT].nice, 5);
+    /* Roles not mentioned keep their previous policy. */
+    CHECK_EQ_INT(c.roles[THREAD_ROLE_PACER].cpu_mask, 0xF0);
+
+    CHECK(thread_placement_parse("", &kBigLittle, &c));
+    CHECK(thread_placement_parse(NULL, &kBigLittle, &c));
+}
+
+static void test_parse_rejects_bad_specs(void) {
+    static const char* const kBad[] = {
+        "render=big", "receive", "receive=", "receive=bigger", "receive=big@", "receive=big@-21",
+        "receive=big@20", "receive=7-4", "receive=64", "receive=1,", "receive=big;pacer=2x",
+    };
+    ThreadPlacementConfig c;
+    ThreadPlacementConfig before;
+    thread_placement_default_config(&kBigLittle, &c);
+    before = c;
+    for (size_t i = 0; i < sizeof(kBad) / sizeof(kBad[0]); i++) {
+        const bool ok = thread_placement_parse(kBad[i], &kBigLittle, &c);
+        if (ok) {
+            fprintf(stderr, "accepted: %s\n", kBad[i]);
+        }
+        CHECK(!ok);
+    }
+    /* A partially valid spec leaves the config untouched. */
+    CHECK(memcmp(&c, &before, sizeof(c)) == 0);
+}
+
+/* ============================================================================
+ * Placement Tests
+ * ========================================================================== */
+
+typedef struct Worker {
+    ThreadPlacement* tp;
+    pid_t tid;
+    int apply_result;
+    volatile int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int ready;
+} Worker;
+
+static void* worker_main(void* arg) {
+    Worker* w = (Worker*)arg;
+    pthread_mutex_lock(&w->lock);
+    w->tid = thread_placement_gettid();
+    w->apply_result = thread_placement_apply(w->tp, THREAD_ROLE_RECEIVE, w->tid);
+    w->ready = 1;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+    while (!w->stop) {
+        usleep(1000);
+    }
+    return NULL;
+}
+
+static void test_apply_and_verify(void) {
+    CpuTopology t;
+    CHECK(cpu_topology_detect(THREAD_PLACEMENT_SYSFS_CPU, &t));
+
+    /* Pin to the CPU this process is running on, which the host certainly allows. */
+    const int cpu = sched_getcpu();
+    CHECK(cpu >= 0 && cpu < THREAD_PLACEMENT_MAX_CPUS);
+    ThreadPlacementConfig c;
+    thread_placement_default_config(&t, &c);
+    c.roles[THREAD_ROLE_RECEIVE].cpu_mask = 1ULL << cpu;
+    c.roles[THREAD_ROLE_RECEIVE].set_nice = true;
+    c.roles[THREAD_ROLE_RECEIVE].nice = 3;
+
+    ThreadPlacement* tp = thread_placement_create(&t, &c);
+    Worker w = { .tp = tp };
+    pthread_mutex_init(&w.lock, NULL);
+    pthread_cond_init(&w.cond, NULL);
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, worker_main, &w) == 0);
+    pthread_mutex_lock(&w.lock);
+    while (!w.ready) {
+        pthread_cond_wait(&w.cond, &w.lock);
+    }
+    pthread_mutex_unlock(&w.lock);
+    CHECK_EQ_INT(w.apply_result, 0);
+
+    /* Only the worker changed: priority is per thread. */
+    CHECK_EQ_INT(getpriority(PRIO_PROCESS, (id_t)thread_placement_gettid()), 0);
+
+    for (int i = 0; i < 5; i++) {
+        thread_placement_sample(tp);
+        usleep(2000);
+    }
+    ThreadPlacementInfo info[THREAD_PLACEMENT_MAX_THREADS];
+    CHECK_EQ_INT(thread_placement_get_threads(tp, info, THREAD_PLACEMENT_MAX_THREADS), 1);
+    CHECK_EQ_INT(info[0].tid, w.tid);
+    CHECK_EQ_INT(info[0].role, THREAD_ROLE_RECEIVE);
+    CHECK_EQ_INT(info[0].requested_mask, 1ULL << cpu);
+    CHECK_EQ_INT(info[0].actual_mask, 1ULL << cpu);
+    CHECK_EQ_INT(info[0].nice, 3);
+    CHECK_EQ_INT(info[0].cpu, cpu);
+    CHECK_EQ_INT(info[0].samples, 5);
+    CHECK_EQ_INT(info[0].off_mask_samples, 0);
+    CHECK_EQ_INT(info[0].migrations, 0);
+    CHECK_EQ_INT(info[0].error, 0);
+
+    /* Reconfiguring re-applies to registered threads. */
+    c.roles[THREAD_ROLE_RECEIVE].nice = 6;
+    thread_placement_configure(tp, &c);
+    thread_placement_sample(tp);
+    thread_placement_get_threads(tp, info, THREAD_PLACEMENT_MAX_THREADS);
+    CHECK_EQ_INT(info[0].nice, 6);
+
+    /* A thread that exits without unregistering is dropped at the next sample. */
+    w.stop = 1;
+    pthread_join(thread, NULL);
+    thread_placement_sample(tp);
+    CHECK_EQ_INT(thread_placement_get_threads(tp, info, THREAD_PLACEMENT_MAX_THREADS), 0);
+
+    pthread_cond_destroy(&w.cond);
+    pthread_mutex_destroy(&w.lock);
+    thread_placement_destroy(tp);
+}
+
+static void test_apply_reports_errors(void) {
+    ThreadPlacementConfig c;
+    thread_placement_default_config(&kBigLittle, &c);
+    c.roles[THREAD_ROLE_PACER].cpu_mask = 0;
+    ThreadPlacement* tp = thread_placement_create(&kBigLittle, &c);
+
+    CHECK_EQ_INT(thread_placement_apply(tp, THREAD_ROLE_COUNT, thread_placement_gettid()), EINVAL);
+    /* pid_max is at most 2^22, so this tid cannot exist. */
+    CHECK_EQ_INT(thread_placement_apply(tp, THREAD_ROLE_PACER, 0x7FFFFFF0), ESRCH);
+
+    ThreadPlacementInfo info[THREAD_PLACEMENT_MAX_THREADS];
+    CHECK_EQ_INT(thread_placement_get_threads(tp, info, THREAD_PLACEMENT_MAX_THREADS), 1);
+    CHECK_EQ_INT(info[0].error, ESRCH);
+    thread_placement_unregister(tp, 0x7FFFFFF0);
+    CHECK_EQ_INT(thread_placement_get_threads(tp, info, THREAD_PLACEMENT_MAX_THREADS), 0);
+
+    /* The registry is bounded. */
+    for (int i = 0; i < THREAD_PLACEMENT_MAX_THREADS; i++) {
+        thread_placement_apply(tp, THREAD_ROLE_PACER, 0x7FFFFF00 + i);
+    }
+    CHECK_EQ_INT(thread_placement_apply(tp, THREAD_ROLE_PACER, 0x7FFFFFF0), ENOSPC);
+    thread_placement_destroy(tp);
+}
+
+int main(void) {
+    RUN_TEST(test_detects_big_little_from_capacity);
+    RUN_TEST(test_falls_back_to_max_freq);
+    RUN_TEST(test_homogeneous_and_missing);
+    RUN_TEST(test_default_config);
+    RUN_TEST(test_parse_core_map);
+    RUN_TEST(test_parse_rejects_bad_specs);
+    RUN_TEST(test_apply_and_verify);
+    RUN_TEST(test_apply_reports_errors);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,150 @@
+/**
+ * thumbnail_test.c - Host tests for thumbnail.c
+ */
+
+#include "thumbnail.h"
+#include "test_util.h"
+
+#include <string.h>
+
+#define BLACK 0xFF000000u
+#define WHITE 0xFFFFFFFFu
+
+/* Fill width x height UYVY pixels with one colour. */
+static void fill_uyvy(uint8_t* frame, int stride, int width, int height, uint8_t y, uint8_t u, uint8_t v) {
+    for (int row = 0; row < height; row++) {
+        uint8_t* p = frame + row * stride;
+        for (int x = 0; x < width; x += 2, p += 4) {
+            p[0] = u;
+            p[1] = y;
+            p[2] = v;
+            p[3] = y;
+        }
+    }
+}
+
+/* ============================================================================
+ * UYVY
+ * ========================================================================== */
+
+static void test_uyvy_limited_range_extremes(void) {
+    uint8_t frame[8 * 4 * 2];
+    uint32_t thumb[4];
+
+    fill_uyvy(frame, 16, 8, 4, 16, 128, 128);
+    CHECK(thumbnail_scale(frame, 16, 8, 4, THUMBNAIL_UYVY, thumb, 2, 2));
+    CHECK_EQ_INT(thumb[0], BLACK);
+    CHECK_EQ_INT(thumb[3], BLACK);
+
+    fill_uyvy(frame, 16, 8, 4, 235, 128, 128);
+    CHECK(thumbnail_scale(frame, 16, 8, 4, THUMBNAIL_UYVY, thumb, 2, 2));
+    CHECK_EQ_INT(thumb[0], WHITE);
+    CHECK_EQ_INT(thumb[3], WHITE);
+}
+
+static void test_uyvy_bt709_primaries(void) {
+    /* BT.709 limited-range red, green and blue. */
+    static const uint8_t yuv[3][3] = {{63, 102, 240}, {173, 42, 26}, {32, 240, 118}};
+    static const uint32_t rgb[3] = {0xFFFF0000u, 0xFF00FF00u, 0xFF0000FFu};
+    uint8_t frame[4 * 2 * 2];
+    uint32_t thumb[1];
+
+    for (int i = 0; i < 3; i++) {
+        fill_uyvy(frame, 8, 4, 2, yuv[i][0], yuv[i][1], yuv[i][2]);
+        CHECK(thumbnail_scale(frame, 8, 4, 2, THUMBNAIL_UYVY, thumb, 1, 1));
+        for (int c = 0; c < 3; c++) {
+            const int actual = (int)((thumb[0] >> (c * 8)) & 0xFFu);
+            const int expected = (int)((rgb[i] >> (c * 8)) & 0xFFu);
+            CHECK(actual >= expected - 2 && actual <= expected + 2);
+        }
+    }
+}
+
+static void test_uyvy_box_filter_averages_covered_pixels(void) {
+    /* Left half black, right half white: halving keeps the edge, quartering averages it. */
+    uint8_t frame[8 * 2 * 2];
+    fill_uyvy(frame, 16, 8, 2, 16, 128, 128);
+    for (int row = 0; row < 2; row++) {
+        for (int x = 4; x < 8; x++) {
+            frame[row * 16 + x * 2 + 1] = 235;
+        }
+    }
+
+    uint32_t thumb[2];
+    CHECK(thumbnail_scale(frame, 16, 8, 2, THUMBNAIL_UYVY, thumb, 2, 1));
+    CHECK_EQ_INT(thumb[0], BLACK);
+    CHECK_EQ_INT(thumb[1], WHITE);
+
+    CHECK(thumbnail_scale(frame, 16, 8, 2, THUMBNAIL_UYVY, thumb, 1, 1));
+    const int grey = (int)(thumb[0] & 0xFFu);
+    CHECK(grey >= 126 && grey <= 129);
+    CHECK_EQ_INT(thumb[0] >> 24, 0xFF);
+}
+
+static void test_uyvy_honours_stride(void) {
+    /* Padding bytes past the width hold white and must not be read. */
+    uint8_t frame[2 * 12];
+    memset(frame, 235, sizeof(frame));
+    fill_uyvy(frame, 12, 4, 2, 16, 128, 128);
+    uint32_t thumb[1];
+    CHECK(thumbnail_scale(frame, 12, 4, 2, THUMBNAIL_UYVY, thumb, 1, 1));
+    CHECK_EQ_INT(thumb[0], BLACK);
+}
+
+/* ============================================================================
+ * RGB
+ * ========================================================================== */
+
+static void test_bgra_and_rgba_channel_order(void) {
+    const uint8_t pixel[4] = {0x10, 0x20, 0x30, 0x80};
+    uint32_t thumb[1];
+
+    CHECK(thumbnail_scale(pixel, 4, 1, 1, THUMBNAIL_BGRA, thumb, 1, 1));
+    CHECK_EQ_INT(thumb[0], 0x80302010u);
+    CHECK(thumbnail_scale(pixel, 4, 1, 1, THUMBNAIL_RGBA, thumb, 1, 1));
+    CHECK_EQ_INT(thumb[0], 0x80102030u);
+    CHECK(thumbnail_scale(pixel, 4, 1, 1, THUMBNAIL_BGRX, thumb, 1, 1));
+    CHECK_EQ_INT(thumb[0], 0xFF302010u);
+    CHECK(thumbnail_scale(pixel, 4, 1, 1, THUMBNAIL_RGBX, thumb, 1, 1));
+    CHECK_EQ_INT(thumb[0], 0xFF102030u);
+}
+
+static void test_upscale_repeats_pixels(void) {
+    const uint8_t pixels[8] = {0, 0, 0, 255, 255, 255, 255, 255};
+    uint32_t thumb[4];
+    CHECK(thumbnail_scale(pixels, 8, 2, 1, THUMBNAIL_BGRA, thumb, 4, 1));
+    CHECK_EQ_INT(thumb[0], BLACK);
+    CHECK_EQ_INT(thumb[1], BLACK);
+    CHECK_EQ_INT(thumb[2], WHITE);
+    CHECK_EQ_INT(thumb[3], WHITE);
+}
+
+/* ============================================================================
+ * Validation
+ * ========================================================================== */
+
+static void test_rejects_invalid_arguments(void) {
+    uint8_t frame[64] = {0};
+    uint32_t thumb[4] = {1, 2, 3, 4};
+
+    CHECK(!thumbnail_scale(NULL, 8, 4, 2, THUMBNAIL_UYVY, thumb, 2, 2));
+    CHECK(!thumbnail_scale(frame, 8, 4, 2, THUMBNAIL_UYVY, NULL, 2, 2));
+    CHECK(!thumbnail_scale(frame, 8, 3, 2, THUMBNAIL_UYVY, thumb, 2, 2));   /* odd UYVY width */
+    CHECK(!thumbnail_scale(frame, 6, 4, 2, THUMBNAIL_UYVY, thumb, 2, 2));   /* stride too small */
+    CHECK(!thumbnail_scale(frame, 12, 4, 2, THUMBNAIL_BGRA, thumb, 2, 2));
+    CHECK(!thumbnail_scale(frame, 16, 4, 2, THUMBNAIL_BGRA, thumb, 0, 2));
+    CHECK(!thumbnail_scale(frame, 16, 4, 2, (ThumbnailFormat)99, thumb, 2, 2));
+    CHECK_EQ_INT(thumb[0], 1);
+    CHECK_EQ_INT(thumb[3], 4);
+}
+
+int main(void) {
+    RUN_TEST(test_uyvy_limited_range_extremes);
+    RUN_TEST(test_uyvy_bt709_primaries);
+    RUN_TEST(test_uyvy_box_filter_averages_covered_pixels);
+    RUN_TEST(test_uyvy_honours_stride);
+    RUN_TEST(test_bgra_and_rgba_channel_order);
+    RUN_TEST(test_upscale_repeats_pixels);
+    RUN_TEST(test_rejects_invalid_arguments);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,120 @@
+/**
+ * transport_probe_test.c - Host tests for transport_probe.c
+ */
+
+#include "transport_probe.h"
+#include "test_util.h"
+
+#define FRAME_NS 33366667LL   /* 29.97 fps */
+#define LATENCY_NS 5000000LL
+
+/* ============================================================================
+ * Loss
+ * ========================================================================== */
+
+static void test_steady_stream_has_no_loss_or_jitter(void) {
+    TransportProbe probe;
+    transport_probe_init(&probe);
+    for (int i = 0; i < 100; i++) {
+        transport_probe_add(&probe, i * FRAME_NS, i * FRAME_NS + LATENCY_NS, FRAME_NS);
+    }
+    TransportProbeResult result;
+    transport_probe_result(&probe, &result);
+    CHECK_EQ_INT(result.frames, 100);
+    CHECK_EQ_INT(result.lost, 0);
+    CHECK(result.loss_rate == 0.0);
+    CHECK_EQ_INT(result.jitter_ns, 0);
+    CHECK_EQ_INT(result.max_deviation_ns, 0);
+}
+
+static void test_gaps_count_as_lost_frames(void) {
+    TransportProbe probe;
+    transport_probe_init(&probe);
+    /* Frames 0-9 and 13-19 arrive; 10-12 are missing. Timestamps wobble by a millisecond. */
+    for (int i = 0; i < 20; i++) {
+        if (i >= 10 && i <= 12) {
+            continue;
+        }
+        const int64_t ts = i * FRAME_NS + ((i % 2) ? 1000000LL : 0);
+        transport_probe_add(&probe, ts, ts + LATENCY_NS, FRAME_NS);
+    }
+    TransportProbeResult result;
+    transport_probe_result(&probe, &result);
+    CHECK_EQ_INT(result.frames, 17);
+    CHECK_EQ_INT(result.lost, 3);
+    CHECK(result.loss_rate > 0.149 && result.loss_rate < 0.151);
+}
+
+static void test_discontinuity_is_not_loss(void) {
+    TransportProbe probe;
+    transport_probe_init(&probe);
+    transport_probe_add(&probe, 0, LATENCY_NS, FRAME_NS);
+    transport_probe_add(&probe, FRAME_NS, FRAME_NS + LATENCY_NS, FRAME_NS);
+    /* Sender restarted with a timeline an hour ahead. */
+    const int64_t restart = 3600LL * 1000000000LL;
+    transport_probe_add(&probe, restart, 2 * FRAME_NS + LATENCY_NS, FRAME_NS);
+    transport_probe_add(&probe, restart + FRAME_NS, 3 * FRAME_NS + LATENCY_NS, FRAME_NS);
+
+    TransportProbeResult result;
+    transport_probe_result(&probe, &result);
+    CHECK_EQ_INT(result.lost, 0);
+    CHECK_EQ_INT(result.discontinuities, 1);
+    CHECK_EQ_INT(result.jitter_ns, 0);
+}
+
+static void test_out_of_order_frames_counted_separately(void) {
+    TransportProbe probe;
+    transport_probe_init(&probe);
+    transport_probe_add(&probe, 0, LATENCY_NS, FRAME_NS);
+    transport_probe_add(&probe, 2 * FRAME_NS, 2 * FRAME_NS + LATENCY_NS, FRAME_NS);
+    transport_probe_add(&probe, FRAME_NS, 2 * FRAME_NS + LATENCY_NS + 1, FRAME_NS);
+    transport_probe_add(&probe, 3 * FRAME_NS, 3 * FRAME_NS + LATENCY_NS, FRAME_NS);
+
+    TransportProbeResult result;
+    transport_probe_result(&probe, &result);
+    CHECK_EQ_INT(result.frames, 4);
+    CHECK_EQ_INT(result.out_of_order, 1);
+    /* The late frame did arrive, but the gap it left was already counted. */
+    CHECK_EQ_INT(result.lost, 1);
+}
+
+/* ============================================================================
+ * Jitter
+ * ========================================================================== */
+
+static void test_alternating_delay_converges_to_its_swing(void) {
+    TransportProbe probe;
+    transport_probe_init(&probe);
+    /* Transit alternates between 5 and 9 ms: every frame's transit differs by 4 ms. */
+    for (int i = 0; i < 200; i++) {
+        const int64_t transit = (i % 2) ? LATENCY_NS + 4000000LL : LATENCY_NS;
+        transport_probe_add(&probe, i * FRAME_NS, i * FRAME_NS + transit, FRAME_NS);
+    }
+    TransportProbeResult result;
+    transport_probe_result(&probe, &result);
+    CHECK(result.jitter_ns > 3900000LL && result.jitter_ns <= 4000000LL);
+    CHECK_EQ_INT(result.max_deviation_ns, 4000000LL);
+}
+
+static void test_single_spike_decays(void) {
+    TransportProbe probe;
+    transport_probe_init(&probe);
+    for (int i = 0; i < 100; i++) {
+        const int64_t transit = (i == 10) ? LATENCY_NS + 16000000LL : LATENCY_NS;
+        transport_probe_add(&probe, i * FRAME_NS, i * FRAME_NS + transit, FRAME_NS);
+    }
+    TransportProbeResult result;
+    transport_probe_result(&probe, &result);
+    CHECK_EQ_INT(result.max_deviation_ns, 16000000LL);
+    CHECK(result.jitter_ns < 100000LL);
+}
+
+int main(void) {
+    RUN_TEST(test_steady_stream_has_no_loss_or_jitter);
+    RUN_TEST(test_gaps_count_as_lost_frames);
+    RUN_TEST(test_discontinuity_is_not_loss);
+    RUN_TEST(test_out_of_order_frames_counted_separately);
+    RUN_TEST(test_alternating_delay_converges_to_its_swing);
+    RUN_TEST(test_single_spike_decays);
+    return TEST_EXIT_CODE();
+}
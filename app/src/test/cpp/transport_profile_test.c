@@ -0,0 +1,99 @@
+/**
+ * transport_profile_test.c - Host tests for transport_profile.c
+ */
+
+#include "transport_profile.h"
+#include "test_util.h"
+
+#include <string.h>
+
+/* ============================================================================
+ * Configuration file
+ * ========================================================================== */
+
+static void test_auto_writes_no_config(void) {
+    TransportProfile profile;
+    transport_profile_init(&profile, TRANSPORT_AUTO);
+    char json[512] = "stale";
+    CHECK_EQ_INT(transport_profile_to_json(&profile, json, sizeof(json)), 0);
+    CHECK(json[0] == '\0');
+}
+
+static void test_tcp_enables_only_tcp(void) {
+    TransportProfile profile;
+    transport_profile_init(&profile, TRANSPORT_TCP);
+    char json[512];
+    const int n = transport_profile_to_json(&profile, json, sizeof(json));
+    CHECK(n > 0);
+    CHECK_EQ_INT(n, (int)strlen(json));
+    CHECK(strstr(json, "\"tcp\":{\"recv\":{\"enable\":true}}") != NULL);
+    CHECK(strstr(json, "\"rudp\":{\"recv\":{\"enable\":false}}") != NULL);
+    CHECK(strstr(json, "\"multicast\":{\"recv\":{\"enable\":false}") != NULL);
+    CHECK(strstr(json, "\"send\":{\"enable\":false") != NULL);
+}
+
+static void test_rudp_enables_only_rudp(void) {
+    TransportProfile profile;
+    transport_profile_init(&profile, TRANSPORT_RUDP);
+    char json[512];
+    CHECK(transport_profile_to_json(&profile, json, sizeof(json)) > 0);
+    CHECK(strstr(json, "\"tcp\":{\"recv\":{\"enable\":false}}") != NULL);
+    CHECK(strstr(json, "\"rudp\":{\"recv\":{\"enable\":true}}") != NULL);
+    CHECK(strstr(json, "\"multicast\":{\"recv\":{\"enable\":false}") != NULL);
+}
+
+static void test_multicast_carries_group_and_ttl(void) {
+    TransportProfile profile;
+    transport_profile_init(&profile, TRANSPORT_MULTICAST);
+    CHECK(transport_profile_set_multicast(&profile, "239.10.0.0", "255.255.255.0", 4));
+    char json[512];
+    CHECK(transport_profile_to_json(&profile, json, sizeof(json)) > 0);
+    CHECK(strstr(json, "\"multicast\":{\"recv\":{\"enable\":true}") != NULL);
+    CHECK(strstr(json, "\"send\":{\"enable\":true,\"netprefix\":\"239.10.0.0\","
+                       "\"netmask\":\"255.255.255.0\",\"ttl\":4}") != NULL);
+    /* Unicast (RUDP) stays available as the fallback when multicast does not get through. */
+    CHECK(strstr(json, "\"rudp\":{\"recv\":{\"enable\":true}}") != NULL);
+}
+
+static void test_small_buffer_rejected(void) {
+    TransportProfile profile;
+    transport_profile_init(&profile, TRANSPORT_MULTICAST);
+    char json[32];
+    CHECK_EQ_INT(transport_profile_to_json(&profile, json, sizeof(json)), -1);
+    CHECK(json[0] == '\0');
+}
+
+/* ============================================================================
+ * Validation
+ * ========================================================================== */
+
+static void test_invalid_multicast_settings_rejected(void) {
+    TransportProfile profile;
+    transport_profile_init(&profile, TRANSPORT_MULTICAST);
+    CHECK(!transport_profile_set_multicast(&profile, "192.168.0.0", "255.255.0.0", 1));   /* Not multicast. */
+    CHECK(!transport_profile_set_multicast(&profile, "239.255.0", "255.255.0.0", 1));
+    CHECK(!transport_profile_set_multicast(&profile, "239.255.0.256", "255.255.0.0", 1));
+    CHECK(!transport_profile_set_multicast(&profile, "239.255.0.0\",\"x", "255.255.0.0", 1));
+    CHECK(!transport_profile_set_multicast(&profile, "239.255.0.0", "255.255.0.0", 0));
+    CHECK(!transport_profile_set_multicast(&profile, "239.255.0.0", "255.255.0.0", 256));
+    CHECK(!transport_profile_set_multicast(&profile, "239.255.0.0", NULL, 1));
+    CHECK(strcmp(profile.multicast_prefix, "239.255.0.0") == 0);
+    CHECK_EQ_INT(profile.multicast_ttl, 1);
+
+    /* A tampered struct is caught before it reaches the file. */
+    strcpy(profile.multicast_mask, "\"}");
+    char json[512];
+    CHECK_EQ_INT(transport_profile_to_json(&profile, json, sizeof(json)), -1);
+    profile.mode = (TransportMode)42;
+    CHECK_EQ_INT(transport_profile_to_json(&profile, json, sizeof(json)), -1);
+}
+
+int main(void) {
+    RUN_TEST(test_auto_writes_no_config);
+    RUN_TEST(test_tcp_enables_only_tcp);
+    RUN_TEST(test_rudp_enables_only_rudp);
+    RUN_TEST(test_multicast_carries_group_and_ttl);
+    RUN_TEST(test_small_buffer_rejected);
+    RUN_TEST(test_invalid_multicast_settings_rejected);
+    return TEST_EXIT_CODE();
+}
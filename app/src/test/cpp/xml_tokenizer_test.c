@@ -0,0 +1,124 @@
+/**
+ * xml_tokenizer_test.c - Host tests for xml_tokenizer.c
+ */
+
+#include "xml_tokenizer.h"
+#include "test_util.h"
+
+#include <string.h>
+
+static bool next_is(XmlTokenizer* t, XmlTokenType type, const char* name, const char* value) {
+    XmlToken token;
+    xml_tokenizer_next(t, &token);
+    if (token.type != type) {
+        return false;
+    }
+    if (name != NULL && !xml_slice_equals(token.name, name)) {
+        return false;
+    }
+    return value == NULL || xml_slice_equals(token.value, value);
+}
+
+static void tokenize(XmlTokenizer* t, const char* xml) {
+    xml_tokenizer_init(t, xml, strlen(xml));
+}
+
+/* ============================================================================
+ * Tokenizer
+ * ========================================================================== */
+
+static void test_self_closing_with_attributes(void) {
+    XmlTokenizer t;
+    tokenize(&t, "<ndi_tally_echo on_program=\"true\" on_preview='false'/>");
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_START, "ndi_tally_echo", NULL));
+    CHECK(next_is(&t, XML_TOKEN_ATTRIBUTE, "on_program", "true"));
+    CHECK(next_is(&t, XML_TOKEN_ATTRIBUTE, "on_preview", "false"));
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_END, "ndi_tally_echo", NULL));
+    CHECK(next_is(&t, XML_TOKEN_END, NULL, NULL));
+    CHECK_EQ_INT(t.depth, 0);
+}
+
+static void test_nested_text_and_depth(void) {
+    XmlTokenizer t;
+    tokenize(&t, "<a x = \"1\" ><b>hi &amp; bye</b></a>");
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_START, "a", NULL));
+    CHECK(next_is(&t, XML_TOKEN_ATTRIBUTE, "x", "1"));
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_START, "b", NULL));
+    CHECK_EQ_INT(t.depth, 2);
+    CHECK(next_is(&t, XML_TOKEN_TEXT, NULL, "hi &amp; bye"));
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_END, "b", NULL));
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_END, "a", NULL));
+    CHECK(next_is(&t, XML_TOKEN_END, NULL, NULL));
+}
+
+static void test_skips_prolog_comments_and_returns_cdata(void) {
+    XmlTokenizer t;
+    tokenize(&t, "<?xml version=\"1.0\"?><!DOCTYPE x><!-- <no/> --><x><![CDATA[a<b>&]]></x>");
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_START, "x", NULL));
+    XmlToken token;
+    CHECK(xml_tokenizer_next(&t, &token));
+    CHECK(token.type == XML_TOKEN_TEXT && token.raw);
+    CHECK(xml_slice_equals(token.value, "a<b>&"));
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_END, "x", NULL));
+    CHECK(next_is(&t, XML_TOKEN_END, NULL, NULL));
+}
+
+static void test_trailing_nul_is_ignored(void) {
+    /* NDI metadata lengths include the terminator. */
+    static const char xml[] = "<a/>";
+    XmlTokenizer t;
+    xml_tokenizer_init(&t, xml, sizeof(xml));
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_START, "a", NULL));
+    CHECK(next_is(&t, XML_TOKEN_ELEMENT_END, "a", NULL));
+    CHECK(next_is(&t, XML_TOKEN_END, NULL, NULL));
+}
+
+static void test_malformed_input(void) {
+    static const char* const kBad[] = {
+        "<a b=1/>", "<a b=\"1/>", "<a", "<a>", "</a>", "<>", "<a/ >", "<!-- open",
+    };
+    for (size_t i = 0; i < sizeof(kBad) / sizeof(kBad[0]); i++) {
+        XmlTokenizer t;
+        XmlToken token;
+        tokenize(&t, kBad[i]);
+        while (xml_tokenizer_next(&t, &token)) {
+        }
+        CHECK(token.type == XML_TOKEN_ERROR);
+        /* Errors are sticky. */
+        CHECK(!xml_tokenizer_next(&t, &token) && token.type == XML_TOKEN_ERROR);
+    }
+}
+
+/* ============================================================================
+ * Unescaping
+ * ========================================================================== */
+
+static void test_unescape_entities(void) {
+    static const char in[] = "&lt;a&gt; &amp; &quot;q&quot; &apos; &#65;&#x42; &#xE9; &bogus; &#;";
+    char out[64];
+    bool cut = true;
+    const size_t n = xml_unescape(in, strlen(in), out, sizeof(out), &cut);
+    CHECK(!cut);
+    CHECK(strcmp(out, "<a> & \"q\" ' AB \xC3\xA9 &bogus; &#;") == 0);
+    CHECK_EQ_INT(n, strlen(out));
+}
+
+static void test_unescape_truncates_on_character_boundary(void) {
+    static const char in[] = "ab\xC3\xA9";
+    char out[4];
+    bool cut = false;
+    CHECK_EQ_INT(xml_unescape(in, strlen(in), out, sizeof(out), &cut), 2);
+    CHECK(cut);
+    CHECK(strcmp(out, "ab") == 0);
+}
+
+int main(void) {
+    RUN_TEST(test_self_closing_with_attributes);
+    RUN_TEST(test_nested_text_and_depth);
+    RUN_TEST(test_skips_prolog_comments_and_returns_cdata);
+    RUN_TEST(test_trailing_nul_is_ignored);
+    RUN_TEST(test_malformed_input);
+    RUN_TEST(test_unescape_entities);
+    RUN_TEST(test_unescape_truncates_on_character_boundary);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,185 @@
+package com.example.ndireceiver.ui.multiview
+
+import android.app.Application
+import com.example.ndireceiver.ndi.FourCC
+import com.example.ndireceiver.ndi.NdiMultiReceiver
+import com.example.ndireceiver.ndi.NdiNative
+import com.example.ndireceiver.ndi.NdiSource
+import com.example.ndireceiver.ndi.VideoFrameData
+import io.mockk.*
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.test.*
+import org.junit.After
+import org.junit.Assert.*
+import org.junit.Before
+import org.junit.Test
+import java.nio.ByteBuffer
+
+/**
+ * Unit tests for MultiviewViewModel.
+ * The multi-receiver engine is mocked: tests cover which sources it is asked to receive, at
+ * what bandwidth, and how its statistics and events reach the tiles.
+ */
+@OptIn(ExperimentalCoroutinesApi::class)
+class MultiviewViewModelTest {
+
+    private val testDispatcher = StandardTestDispatcher()
+
+    private lateinit var receiver: NdiMultiReceiver
+    private lateinit var viewModel: MultiviewViewModel
+    private var focus: String? = null
+
+    private val sources = listOf(
+        NdiSource("CAM1 (Camera 1)"),
+        NdiSource("CAM2 (Camera 2)"),
+        NdiSource("CAM3 (Camera 3)")
+    )
+
+    @Before
+    fun setUp() {
+        Dispatchers.setMain(testDispatcher)
+
+        receiver = mockk(relaxed = true)
+        coEvery { receiver.addSource(any(), any()) } returns true
+        coEvery { receiver.setBandwidth(any(), any()) } returns true
+        every { receiver.setFocus(any()) } answers { focus = firstArg() }
+        every { receiver.focusedSource } answers { focus }
+        every { receiver.getStats(any()) } returns null
+
+        viewModel = MultiviewViewModel(mockk(relaxed = true), receiver)
+    }
+
+    @After
+    fun tearDown() {
+        Dispatchers.resetMain()
+    }
+
+    private fun stats(frames: Long, fps: Double, bitrateBps: Long) = NdiNative.ReceiverStats(
+        windowNs = 1_000_000_000L, videoFrames = frames, videoBytes = 0L, fps = fps,
+        bitrateBps = bitrateBps, intervalAvgNs = 0L, intervalMaxNs = 0L, jitterNs = 0L,
+        captureCalls = 0L, captureAvgNs = 0L, captureMaxNs = 0L, queueVideoAvg = 0.0,
+        queueVideoMax = 0, queueAudioMax = 0, queueMetadataMax = 0, queueVideo = 0,
+        queueAudio = 0, queueMetadata = 0, connections = 1, connectionsMin = 1, connectionsMax = 1
+    )
+
+    private fun tile(name: String) = viewModel.uiState.value.tiles.first { it.sourceName == name }
+
+    // ========== Starting ==========
+
+    @Test
+    fun `start receives the first source at highest bandwidth and the others at lowest`() {
+        viewModel.start(sources)
+        testDispatcher.scheduler.runCurrent()
+
+        coVerifyOrder {
+            receiver.setFocus("CAM1 (Camera 1)")
+            receiver.addSource(sources[0], NdiNative.Bandwidth.HIGHEST)
+            receiver.addSource(sources[1], NdiNative.Bandwidth.LOWEST)
+            receiver.addSource(sources[2], NdiNative.Bandwidth.LOWEST)
+        }
+        val state = viewModel.uiState.value
+        assertEquals(sources.map { it.name }, state.tiles.map { it.sourceName })
+        assertEquals(listOf(true, false, false), state.tiles.map { it.focused })
+        assertEquals(2, state.columns)
+        assertEquals(2, state.rows)
+        assertNull(state.error)
+    }
+
+    @Test
+    fun `start shows at most MAX_SOURCES sources`() {
+        val many = (1..6).map { NdiSource("CAM$it") }
+        viewModel.start(many)
+        testDispatcher.scheduler.runCurrent()
+
+        assertEquals(MultiviewViewModel.MAX_SOURCES, viewModel.uiState.value.tiles.size)
+        coVerify(exactly = MultiviewViewModel.MAX_SOURCES) { receiver.addSource(any(), any()) }
+    }
+
+    @Test
+    fun `start again does nothing`() {
+        viewModel.start(sources)
+        viewModel.start(listOf(NdiSource("OTHER")))
+        testDispatcher.scheduler.runCurrent()
+
+        coVerify(exactly = sources.size) { receiver.addSource(any(), any()) }
+    }
+
+    @Test
+    fun `sources that cannot be received are reported`() {
+        coEvery { receiver.addSource(sources[1], any()) } returns false
+        viewModel.start(sources)
+        testDispatcher.scheduler.runCurrent()
+
+        val error = viewModel.uiState.value.error
+        assertNotNull(error)
+        assertTrue(error!!.contains("CAM2"))
+        assertFalse(error.contains("CAM1"))
+    }
+
+    // ========== Focus ==========
+
+    @Test
+    fun `setFocus moves the highest bandwidth to the focused source`() {
+        viewModel.start(sources)
+        testDispatcher.scheduler.runCurrent()
+
+        viewModel.setFocus("CAM3 (Camera 3)")
+        testDispatcher.scheduler.runCurrent()
+
+        coVerify { receiver.setBandwidth("CAM1 (Camera 1)", NdiNative.Bandwidth.LOWEST) }
+        coVerify { receiver.setBandwidth("CAM3 (Camera 3)", NdiNative.Bandwidth.HIGHEST) }
+        assertEquals(listOf(false, false, true), viewModel.uiState.value.tiles.map { it.focused })
+    }
+
+    @Test
+    fun `setFocus on the focused source does nothing`() {
+        viewModel.start(sources)
+        testDispatcher.scheduler.runCurrent()
+
+        viewModel.setFocus("CAM1 (Camera 1)")
+        testDispatcher.scheduler.runCurrent()
+
+        coVerify(exactly = 0) { receiver.setBandwidth(any(), any()) }
+    }
+
+    // ========== Statistics ==========
+
+    @Test
+    fun `tiles show each source's statistics`() {
+        every { receiver.getStats("CAM1 (Camera 1)") } returns stats(30, 29.97, 5_000_000)
+        viewModel.start(sources)
+        testDispatcher.scheduler.advanceTimeBy(1001)
+
+        assertTrue(tile("CAM1 (Camera 1)").receiving)
+        assertEquals(29.97, tile("CAM1 (Camera 1)").fps, 0.001)
+        assertEquals(5_000_000L, tile("CAM1 (Camera 1)").bitrateBps)
+        assertFalse(tile("CAM2 (Camera 2)").receiving)
+    }
+
+    @Test
+    fun `lost connection stops a tile receiving until frames return`() {
+        every { receiver.getStats("CAM1 (Camera 1)") } returns stats(30, 30.0, 5_000_000)
+        viewModel.start(sources)
+        testDispatcher.scheduler.advanceTimeBy(1001)
+        assertTrue(tile("CAM1 (Camera 1)").receiving)
+
+        viewModel.onConnectionLost("CAM1 (Camera 1)")
+        testDispatcher.scheduler.advanceTimeBy(1000)
+        assertFalse(tile("CAM1 (Camera 1)").receiving)
+
+        val frame = VideoFrameData(
+            width = 640,
+            height = 360,
+            frameRateN = 30000,
+            frameRateD = 1001,
+            data = ByteBuffer.allocate(16),
+            lineStrideBytes = 640 * 2,
+            timestamp = 0L,
+            fourCC = FourCC.UYVY
+        )
+        viewModel.onVideoFrame("CAM1 (Camera 1)", frame)
+        testDispatcher.scheduler.advanceTimeBy(1000)
+        assertTrue(tile("CAM1 (Camera 1)").receiving)
+    }
+}
@@ -92,7 +92,7 @@ class PlayerViewModelTest {
         assertTrue(state.showControls)
         assertTrue(state.showOsd)
         assertEquals("", state.videoInfo)
-        assertEquals("", state.bitrateInfo)
+        assertEquals(OsdStats(), state.osdStats)
         assertEquals(0, state.retryCount)
         assertFalse(state.isAutoReconnecting)
     }
@@ -104,7 +104,7 @@ class PlayerViewModelTest {
             showControls = false,
             showOsd = false,
             videoInfo = "1920x1080",
-            bitrateInfo = "10 Mbps",
+            osdStats = OsdStats(tally = Tally(onProgram = true, onPreview = false)),
             retryCount = 3,
             isAutoReconnecting = true
         )
@@ -112,7 +112,8 @@ class PlayerViewModelTest {
         assertFalse(modified.showControls)
         assertFalse(modified.showOsd)
         assertEquals("1920x1080", modified.videoInfo)
-        assertEquals("10 Mbps", modified.bitrateInfo)
+        assertEquals(Tally(onProgram = true, onPreview = false), modified.osdStats.tally)
+        assertNull(modified.osdStats.stream)
         assertEquals(3, modified.retryCount)
         assertTrue(modified.isAutoReconnecting)
     }